@@ -1011,10 +1011,28 @@ static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* co
 		cb = (cache->colors[0] >> 16) & 0xff;
 		ca = (cache->colors[0] >> 24) & 0xff;
 
+		if (ca == 0) return;
+
 		for (i = 0; i < count; i++) {
-			int r,g,b;
-			int a = nsvg__div255((int)cover[0] * ca);
-			int ia = 255 - a;
+			int r,g,b,a,ia;
+			/* Uncovered and fully covered pixels dominate a scanline;
+			   handle both without the blend arithmetic. */
+			if (cover[0] == 0) {
+				cover++;
+				dst += 4;
+				continue;
+			}
+			if (cover[0] == 255 && ca == 255) {
+				dst[0] = (unsigned char)cr;
+				dst[1] = (unsigned char)cg;
+				dst[2] = (unsigned char)cb;
+				dst[3] = 255;
+				cover++;
+				dst += 4;
+				continue;
+			}
+			a = nsvg__div255((int)cover[0] * ca);
+			ia = 255 - a;
 			/* Premultiply */
 			r = nsvg__div255(cr * a);
 			g = nsvg__div255(cg * a);
@@ -1037,7 +1055,7 @@ static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* co
 	} else if (cache->type == NSVG_PAINT_LINEAR_GRADIENT) {
 		/* TODO: spread modes. */
 		/* TODO: plenty of opportunities to optimize. */
-		float fx, fy, dx, gy;
+		float fx, fy, dx, gy, dgy;
 		float* t = cache->xform;
 		int i, cr, cg, cb, ca;
 		unsigned int c;
@@ -1046,9 +1064,19 @@ static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* co
 		fy = ((float)y - ty) / scale;
 		dx = 1.0f / scale;
 
+		/* The gradient coordinate is affine in x, so step it instead of
+		   re-evaluating the transform per pixel. */
+		gy = fx*t[1] + fy*t[3] + t[5];
+		dgy = dx*t[1];
+
 		for (i = 0; i < count; i++) {
 			int r,g,b,a,ia;
-			gy = fx*t[1] + fy*t[3] + t[5];
+			if (cover[0] == 0) {
+				cover++;
+				dst += 4;
+				gy += dgy;
+				continue;
+			}
 			c = cache->colors[(int)nsvg__clampf(gy*255.0f, 0, 255.0f)];
 			cr = (c) & 0xff;
 			cg = (c >> 8) & 0xff;
@@ -1076,7 +1104,7 @@ static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* co
 
 			cover++;
 			dst += 4;
-			fx += dx;
+			gy += dgy;
 		}
 	} else if (cache->type == NSVG_PAINT_RADIAL_GRADIENT) {
 		/* TODO: spread modes. */
@@ -1093,6 +1121,12 @@ static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* co
 
 		for (i = 0; i < count; i++) {
 			int r,g,b,a,ia;
+			if (cover[0] == 0) {
+				cover++;
+				dst += 4;
+				fx += dx;
+				continue;
+			}
 			gx = fx*t[0] + fy*t[2] + t[4];
 			gy = fx*t[1] + fy*t[3] + t[5];
 			gd = sqrtf(gx*gx + gy*gy);
@@ -1131,13 +1165,30 @@ static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* co
 static void nsvg__rasterizeSortedEdges(NSVGrasterizer *r, float tx, float ty, float scale, NSVGcachedPaint* cache, char fillRule)
 {
 	NSVGactiveEdge *active = NULL;
-	int y, s;
+	int y, s, i;
 	int e = 0;
 	int maxWeight = (255 / NSVG__SUBSAMPLES);  /* weight per vertical scanline */
 	int xmin, xmax;
+	int ybegin = 0, yend = r->height - 1;
+
+	/* Restrict the traversal to the vertical band actually covered by the
+	   edges, so that a shape much smaller than the canvas does not pay for
+	   the full image height.  The edges are sorted by y0, so the band
+	   start comes from the first edge. */
+	if (r->nedges > 0) {
+		float emax = r->edges[0].y1;
+		for (i = 1; i < r->nedges; i++) {
+			if (r->edges[i].y1 > emax) emax = r->edges[i].y1;
+		}
+		ybegin = (int)(r->edges[0].y0 / NSVG__SUBSAMPLES);
+		yend = (int)(emax / NSVG__SUBSAMPLES);
+		if (ybegin < 0) ybegin = 0;
+		if (yend > r->height-1) yend = r->height-1;
+	}
+
+	memset(r->scanline, 0, r->width);
 
-	for (y = 0; y < r->height; y++) {
-		memset(r->scanline, 0, r->width);
+	for (y = ybegin; y <= yend; y++) {
 		xmin = r->width;
 		xmax = 0;
 		for (s = 0; s < NSVG__SUBSAMPLES; ++s) {
@@ -1206,11 +1257,13 @@ static void nsvg__rasterizeSortedEdges(NSVGrasterizer *r, float tx, float ty, fl
 			if (active != NULL)
 				nsvg__fillActiveEdges(r->scanline, r->width, active, maxWeight, &xmin, &xmax, fillRule);
 		}
-		/* Blit */
+		/* Blit, then clear only the touched span for the next row;
+		   nsvg__fillScanline clips all stores to [0, width-1]. */
 		if (xmin < 0) xmin = 0;
 		if (xmax > r->width-1) xmax = r->width-1;
 		if (xmin <= xmax) {
 			nsvg__scanlineSolid(&r->bitmap[y * r->stride] + xmin*4, xmax-xmin+1, &r->scanline[xmin], xmin, y, tx,ty, scale, cache);
+			memset(&r->scanline[xmin], 0, xmax-xmin+1);
 		}
 	}
 
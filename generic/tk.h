@@ -928,6 +928,10 @@ typedef struct Tk_FakeWin {
  *                              Used on macOS to indicate that key events can be
  *                              processed with the NSTextInputClient protocol.
  *                              Not currently accessible through the public API.
+ * TK_DEFERRED_GEOMETRY		1 means that a geometry request for this
+ *				window was deferred by an open
+ *				"tk batchgeometry" script and is waiting on
+ *				the deferred-request list in tkGeometry.c.
  */
 
 #define TK_MAPPED		1
@@ -951,6 +955,7 @@ typedef struct Tk_FakeWin {
 #define TK_PROP_PROPCHANGE	0x40000
 #define TK_WM_MANAGEABLE	0x80000
 #define TK_CAN_INPUT_TEXT       0x100000
+#define TK_DEFERRED_GEOMETRY	0x200000
 
 /*
  *----------------------------------------------------------------------
@@ -1095,6 +1100,12 @@ typedef void	(Tk_ItemScaleProc)(Tk_Canvas canvas, Tk_Item *itemPtr,
 		    double scaleY);
 typedef void	(Tk_ItemTranslateProc)(Tk_Canvas canvas, Tk_Item *itemPtr,
 		    double deltaX, double deltaY);
+typedef void	(Tk_ItemDisplayManyProc)(Tk_Canvas canvas,
+		    Tk_Item *const *itemPtrs, int numItems, Display *display,
+		    Drawable dst, int x, int y, int width, int height);
+typedef void	(Tk_ItemTranslateManyProc)(Tk_Canvas canvas,
+		    Tk_Item *const *itemPtrs, int numItems, double deltaX,
+		    double deltaY);
 #if TCL_MAJOR_VERSION > 8
 typedef void	(Tk_ItemCursorProc)(Tk_Canvas canvas, Tk_Item *itemPtr,
 		    size_t index);
@@ -1171,9 +1182,18 @@ typedef struct Tk_ItemType {
     Tk_ItemRotateProc *rotateProc;
 				/* Procedure to rotate an item's coordinates
 				 * about a point. */
-    int reserved2;		/* Carefully compatible with */
-    char *reserved3;		/* Jan Nijtmans dash patch */
-    char *reserved4;
+    int reserved2;		/* Carefully compatible with Jan Nijtmans
+				 * dash patch. */
+    Tk_ItemDisplayManyProc *displayManyProc;
+				/* If non-NULL, procedure to display a run of
+				 * consecutive items of this type with a
+				 * single call; the canvas uses it instead of
+				 * displayProc when several adjacent items in
+				 * display order share the type. */
+    Tk_ItemTranslateManyProc *translateManyProc;
+				/* If non-NULL, procedure to translate a
+				 * batch of items of this type by the same
+				 * delta with a single call. */
 } Tk_ItemType;
 
 /*
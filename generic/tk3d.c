@@ -611,7 +611,7 @@ Tk_SetBackgroundFromBorder(
  *	unless "interp" is NULL.
  *
  * Side effects:
- *	The object gets converted by Tcl_GetIndexFromObj.
+ *	The object gets converted by TkGetEnumFromObj.
  *
  *----------------------------------------------------------------------
  */
@@ -623,8 +623,8 @@ Tk_GetReliefFromObj(
 				 * from. */
     int *resultPtr)		/* Where to place the answer. */
 {
-    return Tcl_GetIndexFromObjStruct(interp, objPtr, reliefStrings,
-	    sizeof(char *), "relief", 0, resultPtr);
+    return TkGetEnumFromObj(interp, objPtr, reliefStrings, "relief",
+	    resultPtr);
 }
 
 /*
@@ -47,6 +47,25 @@ static const char *const atomNameArray[] = {
     NULL
 };
 
+/*
+ * The following atoms are not predefined by the protocol but are interned by
+ * the selection, clipboard, and window manager code, often in the middle of
+ * a user interaction.  They are all fetched with a single round trip when
+ * the atom cache for a display is initialized, so that the code paths that
+ * need them never block on an individual XInternAtom call.
+ */
+
+static const char *const prefetchAtomNames[] = {
+    "ATOM_PAIR",	"CLIPBOARD",		"COMPOUND_TEXT",
+    "INCR",		"MULTIPLE",		"TARGETS",
+    "TEXT",		"TIMESTAMP",		"TK_APPLICATION",
+    "TK_WINDOW",	"UTF8_STRING",		"WM_DELETE_WINDOW",
+    "WM_PROTOCOLS",	"WM_TAKE_FOCUS",	"_NET_WM_PING",
+    "_NET_WM_STATE",	"_NET_WM_STATE_ABOVE",	"_NET_WM_STATE_FULLSCREEN",
+    "_NET_WM_STATE_MAXIMIZED_HORZ",		"_NET_WM_STATE_MAXIMIZED_VERT",
+    NULL
+};
+
 /*
  * Forward references to functions defined in this file:
  */
@@ -204,6 +223,42 @@ AtomInit(
 	hPtr = Tcl_CreateHashEntry(&dispPtr->atomTable, INT2PTR(atom), &isNew);
 	Tcl_SetHashValue(hPtr, (char *)name);
     }
+
+#if !(defined(_WIN32) || defined(MAC_OSX_TK)) /* X11 */
+    /*
+     * Fetch the commonly used non-predefined atoms with a single request, so
+     * that later Tk_InternAtom calls for them hit the cache instead of each
+     * paying a round trip to the server.  On the other platforms interning
+     * is a local operation, so there is nothing to prefetch.
+     */
+
+    {
+	char *names[sizeof(prefetchAtomNames)/sizeof(prefetchAtomNames[0])];
+	Atom atoms[sizeof(prefetchAtomNames)/sizeof(prefetchAtomNames[0])];
+	int i, count;
+
+	for (count = 0; prefetchAtomNames[count] != NULL; count++) {
+	    names[count] = (char *)prefetchAtomNames[count];
+	}
+	if (XInternAtoms(dispPtr->display, names, count, False, atoms)) {
+	    for (i = 0; i < count; i++) {
+		const char *name;
+		int isNew;
+
+		hPtr = Tcl_CreateHashEntry(&dispPtr->nameTable, names[i],
+			&isNew);
+		if (!isNew) {
+		    continue;
+		}
+		Tcl_SetHashValue(hPtr, INT2PTR(atoms[i]));
+		name = (const char *)Tcl_GetHashKey(&dispPtr->nameTable, hPtr);
+		hPtr = Tcl_CreateHashEntry(&dispPtr->atomTable,
+			INT2PTR(atoms[i]), &isNew);
+		Tcl_SetHashValue(hPtr, (char *)name);
+	    }
+	}
+    }
+#endif
 }
 
 /*
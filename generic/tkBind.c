@@ -173,6 +173,17 @@ typedef struct {
     Tcl_HashTable listTable;	/* Keys are PatternTableKey structs, values are (PSList *). */
     PSList entryPool;		/* Contains free (unused) list items. */
     unsigned number;		/* Needed for enumeration of pattern sequences. */
+    unsigned eventTypeCount[TK_LASTEVENT];
+    				/* Number of entries in listTable per leading event type. Lets
+				 * the dispatcher skip the hash probes for event types without
+				 * any binding, the most frequent case for high-rate events
+				 * like MotionNotify. */
+    unsigned eventTypeCountDetailed[TK_LASTEVENT];
+    				/* Of eventTypeCount, how many entries carry a detail (button
+				 * number, keysym, or virtual event name). The dispatcher probes
+				 * listTable once with and once without the detail for every
+				 * event; these counts let it skip whichever of the two probes
+				 * cannot find anything. */
 } LookupTables;
 
 /*
@@ -1184,17 +1195,23 @@ ClearLookupTable(
 
     for (hPtr = Tcl_FirstHashEntry(&lookupTables->listTable, &search); hPtr; hPtr = nextPtr) {
 	PSList *psList;
+	const PatternTableKey *key =
+		(const PatternTableKey *)Tcl_GetHashKey(&lookupTables->listTable, hPtr);
 
 	nextPtr = Tcl_NextHashEntry(&search);
 
-	if (object) {
-	    const PatternTableKey *key = (const PatternTableKey *)Tcl_GetHashKey(&lookupTables->listTable, hPtr);
-	    if (key->object != object) {
-		continue;
-	    }
+	if (object && key->object != object) {
+	    continue;
 	}
 
 	psList = (PSList *)Tcl_GetHashValue(hPtr);
+	assert(key->type < TK_LASTEVENT);
+	assert(lookupTables->eventTypeCount[key->type] >= PSList_Size(psList));
+	lookupTables->eventTypeCount[key->type] -= PSList_Size(psList);
+	if (key->detail.name) {
+	    assert(lookupTables->eventTypeCountDetailed[key->type] >= PSList_Size(psList));
+	    lookupTables->eventTypeCountDetailed[key->type] -= PSList_Size(psList);
+	}
 	PSList_Move(pool, psList);
 	ckfree(psList);
 	DEBUG(countListItems -= 1;)
@@ -1618,6 +1635,11 @@ InsertPatSeq(
 	psEntry = MakeListEntry(&lookupTables->entryPool, psPtr, 0);
 	PSList_Append(psList, psEntry);
 	psPtr->added = 1;
+	assert(key.type < TK_LASTEVENT);
+	lookupTables->eventTypeCount[key.type] += 1;
+	if (key.detail.name) {
+	    lookupTables->eventTypeCountDetailed[key.type] += 1;
+	}
     }
 }
 /*
@@ -1919,6 +1941,13 @@ RemovePatSeqFromLookup(
 	    if (psEntry->psPtr == psPtr) {
 		psPtr->added = 0;
 		RemoveListEntry(&lookupTables->entryPool, psEntry);
+		assert(key.type < TK_LASTEVENT);
+		assert(lookupTables->eventTypeCount[key.type] > 0);
+		lookupTables->eventTypeCount[key.type] -= 1;
+		if (key.detail.name) {
+		    assert(lookupTables->eventTypeCountDetailed[key.type] > 0);
+		    lookupTables->eventTypeCountDetailed[key.type] -= 1;
+		}
 		return;
 	    }
 	}
@@ -2190,6 +2219,8 @@ Tk_BindEvent(
     PatSeq *matchPtrBuf[32];
     PatSeq **matchPtrArr = matchPtrBuf;
     PSList *psl[2];
+    PSList *virtPsl[2] = { NULL, NULL };
+    int virtLookupDone = 0;
     Tcl_DString scripts;
     const char *p;
     const char *end;
@@ -2433,8 +2464,22 @@ Tk_BindEvent(
 	PSList *psSuccList = PromArr_First(bindPtr->promArr);
 	PatSeq *bestPtr;
 
-	psl[0] = GetLookupForEvent(physTables, curEvent, (Tcl_Obj *)objArr[k], 1);
-	psl[1] = GetLookupForEvent(physTables, curEvent, (Tcl_Obj *)objArr[k], 0);
+	if (physTables->eventTypeCount[eventPtr->type] > 0) {
+	    /*
+	     * Probe the detailed and the detail-less candidate list only if
+	     * any binding of that kind leads with this event type.
+	     */
+	    psl[0] = (physTables->eventTypeCountDetailed[eventPtr->type] > 0)
+		    ? GetLookupForEvent(physTables, curEvent, (Tcl_Obj *)objArr[k], 1)
+		    : NULL;
+	    psl[1] = (physTables->eventTypeCount[eventPtr->type]
+			    > physTables->eventTypeCountDetailed[eventPtr->type])
+		    ? GetLookupForEvent(physTables, curEvent, (Tcl_Obj *)objArr[k], 0)
+		    : NULL;
+	} else {
+	    /* No binding in this table starts with this event type. */
+	    psl[0] = psl[1] = NULL;
+	}
 
 	assert(psl[0] == NULL || psl[0] != psl[1]);
 
@@ -2468,17 +2513,32 @@ Tk_BindEvent(
 
 	    matchPtrArr[k] = bestPtr;
 
-	    if (eventPtr->type != VirtualEvent) {
-		LookupTables *virtTables = &bindInfoPtr->virtualEventTable.lookupTables;
+	    if (eventPtr->type != VirtualEvent
+		    && physTables->eventTypeCount[VirtualEvent] > 0
+		    && bindInfoPtr->virtualEventTable.lookupTables.eventTypeCount[
+			    eventPtr->type] > 0) {
 		PatSeq *matchPtr = matchPtrArr[k];
 		PatSeq *mPtr;
 
 		/*
-		 * Note that virtual events cannot promote.
+		 * Note that virtual events cannot promote. The candidate lists do not
+		 * depend on the object, so they are looked up only once.
 		 */
 
-		psl[0] = GetLookupForEvent(virtTables, curEvent, NULL, 1);
-		psl[1] = GetLookupForEvent(virtTables, curEvent, NULL, 0);
+		if (!virtLookupDone) {
+		    LookupTables *virtTables = &bindInfoPtr->virtualEventTable.lookupTables;
+
+		    virtPsl[0] = (virtTables->eventTypeCountDetailed[eventPtr->type] > 0)
+			    ? GetLookupForEvent(virtTables, curEvent, NULL, 1)
+			    : NULL;
+		    virtPsl[1] = (virtTables->eventTypeCount[eventPtr->type]
+				    > virtTables->eventTypeCountDetailed[eventPtr->type])
+			    ? GetLookupForEvent(virtTables, curEvent, NULL, 0)
+			    : NULL;
+		    virtLookupDone = 1;
+		}
+		psl[0] = virtPsl[0];
+		psl[1] = virtPsl[1];
 
 		assert(psl[0] == NULL || psl[0] != psl[1]);
 
@@ -2503,7 +2563,12 @@ Tk_BindEvent(
     PromArr_SetSize(bindPtr->promArr, arraySize);
 
     /*
-     * Remove expired pattern sequences.
+     * Remove expired pattern sequences. Note that expiration is driven
+     * entirely by the timestamps of incoming events: entries are flagged as
+     * expired while matching above and collected here, so no timer handlers
+     * are ever allocated for pending sequences, and the entries themselves
+     * are recycled through the entry pool. This keeps high-rate event
+     * injection free of timer and allocator churn.
      */
 
     for (i = 0, newArraySize = 0; i < arraySize; ++i) {
@@ -100,11 +100,52 @@ typedef struct {
 } ThreadSpecificData;
 static Tcl_ThreadDataKey dataKey;
 
+/*
+ * One of the following structures is created by "tk resourcecache warm" to
+ * keep track of a batch of predefined bitmaps and standard cursors being
+ * resolved during idle time. The resolved resources stay referenced until
+ * the application's main window is destroyed, so their cache entries remain
+ * warm for later Tk_GetBitmap and Tk_GetCursor calls.
+ */
+
+typedef struct ResourceWarmer {
+    Tcl_Interp *interp;		/* Interpreter in which the warm-up was
+				 * requested. */
+    Tk_Window tkwin;		/* Main window of the application whose
+				 * resource caches are being warmed. */
+    int numNames;		/* Total number of entries in the names
+				 * array. */
+    int numBitmaps;		/* The first numBitmaps entries of names are
+				 * bitmap names; the rest are cursor names. */
+    int nextName;		/* Index of the next name to resolve. */
+    char **names;		/* Malloc-ed array of malloc-ed resource
+				 * names still to be resolved. */
+    Pixmap *bitmaps;		/* Malloc-ed array of bitmaps resolved so
+				 * far; entries may be None if resolution
+				 * failed. */
+    Tk_Cursor *cursors;		/* Malloc-ed array of cursors resolved so
+				 * far; entries may be NULL if resolution
+				 * failed. */
+} ResourceWarmer;
+
+/*
+ * The cursor font entries that the core widgets and library scripts use;
+ * these are the cursors worth resolving ahead of first use.
+ */
+
+static const char *const standardCursorNames[] = {
+    "arrow", "crosshair", "fleur", "hand2", "left_ptr",
+    "sb_h_double_arrow", "sb_v_double_arrow", "watch", "xterm", NULL
+};
+
 /*
  * Forward declarations for functions defined in this file:
  */
 
 static void		BitmapInit(TkDisplay *dispPtr);
+static void		ResourceWarmEventProc(ClientData clientData,
+			    XEvent *eventPtr);
+static void		ResourceWarmIdleProc(ClientData clientData);
 static void		DupBitmapObjProc(Tcl_Obj *srcObjPtr,
 			    Tcl_Obj *dupObjPtr);
 static void		FreeBitmap(TkBitmap *bitmapPtr);
@@ -1193,6 +1234,218 @@ TkGetBitmapPredefTable(void)
 
     return &tsdPtr->predefBitmapTable;
 }
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkResourcecacheObjCmd --
+ *
+ *	This function is invoked to process the "tk resourcecache" Tcl
+ *	command. The "warm" option resolves the predefined bitmaps and the
+ *	standard cursors one at a time during idle periods, so that the first
+ *	widget to actually use one of them does not pay for the resolution
+ *	during its initial display.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Schedules idle callbacks that populate the bitmap and cursor caches.
+ *	The warmed resources stay referenced until the main window is
+ *	destroyed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkResourcecacheObjCmd(
+    ClientData clientData,	/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    Tk_Window tkwin = (Tk_Window)clientData;
+    static const char *const optionStrings[] = {
+	"warm", NULL
+    };
+    enum options {
+	RESOURCECACHE_WARM
+    };
+    int index;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (objc != 2) {
+	Tcl_WrongNumArgs(interp, 1, objv, "option");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[1], optionStrings, "option", 0,
+	    &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    switch ((enum options) index) {
+    case RESOURCECACHE_WARM: {
+	ResourceWarmer *warmerPtr;
+	Tcl_HashEntry *hashPtr;
+	Tcl_HashSearch search;
+	const char *name;
+	int i, count, numCursors;
+	size_t length;
+
+	if (!tsdPtr->initialized) {
+	    BitmapInit(NULL);
+	}
+	count = tsdPtr->predefBitmapTable.numEntries;
+	for (numCursors = 0; standardCursorNames[numCursors] != NULL;
+		numCursors++) {
+	    /* Empty loop body: just count the cursors. */
+	}
+
+	warmerPtr = (ResourceWarmer *)ckalloc(sizeof(ResourceWarmer));
+	warmerPtr->interp = interp;
+	warmerPtr->tkwin = tkwin;
+	warmerPtr->numNames = count + numCursors;
+	warmerPtr->numBitmaps = count;
+	warmerPtr->nextName = 0;
+	warmerPtr->names = (char **)
+		ckalloc(warmerPtr->numNames * sizeof(char *));
+	warmerPtr->bitmaps = (Pixmap *)ckalloc(count * sizeof(Pixmap));
+	warmerPtr->cursors = (Tk_Cursor *)
+		ckalloc(numCursors * sizeof(Tk_Cursor));
+	for (hashPtr = Tcl_FirstHashEntry(&tsdPtr->predefBitmapTable,
+		&search), i = 0; hashPtr != NULL;
+		hashPtr = Tcl_NextHashEntry(&search), i++) {
+	    name = (const char *)
+		    Tcl_GetHashKey(&tsdPtr->predefBitmapTable, hashPtr);
+	    length = strlen(name);
+	    warmerPtr->names[i] = (char *)ckalloc(length + 1);
+	    memcpy(warmerPtr->names[i], name, length + 1);
+	}
+	for (i = 0; i < numCursors; i++) {
+	    name = standardCursorNames[i];
+	    length = strlen(name);
+	    warmerPtr->names[count + i] = (char *)ckalloc(length + 1);
+	    memcpy(warmerPtr->names[count + i], name, length + 1);
+	}
+
+	/*
+	 * The event handler cleans up the warmer (and releases the warmed
+	 * resources) when the main window goes away; this happens before the
+	 * display's bitmap and cursor tables are torn down.
+	 */
+
+	Tk_CreateEventHandler(tkwin, StructureNotifyMask,
+		ResourceWarmEventProc, warmerPtr);
+	Tcl_DoWhenIdle(ResourceWarmIdleProc, warmerPtr);
+	break;
+    }
+    }
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ResourceWarmIdleProc --
+ *
+ *	This function is invoked at idle time to resolve the next resource in
+ *	a warm-up batch. Only one resource is resolved per callback so that
+ *	warming never delays a pending redraw by more than one resource's
+ *	worth of work.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Resolves a bitmap or cursor, creating an entry in the corresponding
+ *	per-display cache. Reschedules itself while resources remain to be
+ *	resolved.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ResourceWarmIdleProc(
+    ClientData clientData)	/* Pointer to ResourceWarmer record. */
+{
+    ResourceWarmer *warmerPtr = (ResourceWarmer *)clientData;
+    int i = warmerPtr->nextName;
+    Tk_Uid nameUid = Tk_GetUid(warmerPtr->names[i]);
+
+    if (i < warmerPtr->numBitmaps) {
+	warmerPtr->bitmaps[i] = Tk_GetBitmap(NULL, warmerPtr->tkwin, nameUid);
+    } else {
+	Tk_Cursor cursor = Tk_GetCursor(warmerPtr->interp, warmerPtr->tkwin,
+		nameUid);
+
+	if (cursor == NULL) {
+	    /*
+	     * Warming is best effort: ignore names that do not resolve and
+	     * don't leave an error message lying around in the interpreter.
+	     */
+
+	    Tcl_ResetResult(warmerPtr->interp);
+	}
+	warmerPtr->cursors[i - warmerPtr->numBitmaps] = cursor;
+    }
+    warmerPtr->nextName++;
+    if (warmerPtr->nextName < warmerPtr->numNames) {
+	Tcl_DoWhenIdle(ResourceWarmIdleProc, warmerPtr);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ResourceWarmEventProc --
+ *
+ *	This function is invoked when the main window of an application with
+ *	a pending or completed resource warm-up is destroyed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Releases the warmed resources and frees the ResourceWarmer record.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ResourceWarmEventProc(
+    ClientData clientData,	/* Pointer to ResourceWarmer record. */
+    XEvent *eventPtr)		/* Information about event. */
+{
+    ResourceWarmer *warmerPtr = (ResourceWarmer *)clientData;
+    Display *display = Tk_Display(warmerPtr->tkwin);
+    int i;
+
+    if (eventPtr->type != DestroyNotify) {
+	return;
+    }
+    if (warmerPtr->nextName < warmerPtr->numNames) {
+	Tcl_CancelIdleCall(ResourceWarmIdleProc, warmerPtr);
+    }
+    for (i = 0; i < warmerPtr->nextName; i++) {
+	if (i < warmerPtr->numBitmaps) {
+	    if (warmerPtr->bitmaps[i] != None) {
+		Tk_FreeBitmap(display, warmerPtr->bitmaps[i]);
+	    }
+	} else if (warmerPtr->cursors[i - warmerPtr->numBitmaps] != NULL) {
+	    Tk_FreeCursor(display,
+		    warmerPtr->cursors[i - warmerPtr->numBitmaps]);
+	}
+    }
+    for (i = 0; i < warmerPtr->numNames; i++) {
+	ckfree(warmerPtr->names[i]);
+    }
+    ckfree(warmerPtr->names);
+    ckfree(warmerPtr->bitmaps);
+    ckfree(warmerPtr->cursors);
+    ckfree(warmerPtr);
+}
+
 
 /*
  * Local Variables:
@@ -290,13 +290,15 @@ RefWinEventProc(
 	    if (busyPtr->tkBusy != NULL) {
 		Tk_MoveResizeWindow(busyPtr->tkBusy, x, y, busyPtr->width,
 			busyPtr->height);
-		TkpShowBusyWindow(busyPtr);
+		if (busyPtr->active) {
+		    TkpShowBusyWindow(busyPtr);
+		}
 	    }
 	}
 	break;
 
     case MapNotify:
-	if (busyPtr->tkParent != busyPtr->tkRef) {
+	if (busyPtr->active && (busyPtr->tkParent != busyPtr->tkRef)) {
 	    TkpShowBusyWindow(busyPtr);
 	}
 	break;
@@ -567,6 +569,7 @@ CreateBusy(
     busyPtr->height = Tk_Height(tkRef);
     busyPtr->x = Tk_X(tkRef);
     busyPtr->y = Tk_Y(tkRef);
+    busyPtr->active = 0;
     busyPtr->cursor = NULL;
     Tk_SetClass(tkBusy, "Busy");
     busyPtr->optionTable = Tk_CreateOptionTable(interp, busyOptionSpecs);
@@ -580,10 +583,16 @@ CreateBusy(
 
     TkpCreateBusy(winPtr, tkRef, &parent, tkParent, busyPtr);
 
-    MakeTransparentWindowExist(tkBusy, parent);
+    /*
+     * Record the busy window's geometry before the window exists, so that it
+     * is created in place with a single request instead of being created and
+     * then separately moved and resized.
+     */
 
     Tk_MoveResizeWindow(tkBusy, x, y, busyPtr->width, busyPtr->height);
 
+    MakeTransparentWindowExist(tkBusy, parent);
+
     /*
      * Only worry if the busy window is destroyed.
      */
@@ -687,14 +696,23 @@ GetBusy(
 	return NULL;
     }
     hPtr = Tcl_FindHashEntry(busyTablePtr, tkwin);
-    if (hPtr == NULL) {
-	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
-		"can't find busy window \"%s\"", Tcl_GetString(windowObj)));
-	Tcl_SetErrorCode(interp, "TK", "LOOKUP", "BUSY",
-		Tcl_GetString(windowObj), NULL);
-	return NULL;
+    if (hPtr != NULL) {
+	Busy *busyPtr = (Busy *)Tcl_GetHashValue(hPtr);
+
+	/*
+	 * Records pooled by "tk busy forget" stay in the table so the busy
+	 * window can be reused, but must behave as if they did not exist.
+	 */
+
+	if (busyPtr->active) {
+	    return busyPtr;
+	}
     }
-    return (Busy *)Tcl_GetHashValue(hPtr);
+    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+	    "can't find busy window \"%s\"", Tcl_GetString(windowObj)));
+    Tcl_SetErrorCode(interp, "TK", "LOOKUP", "BUSY",
+	    Tcl_GetString(windowObj), NULL);
+    return NULL;
 }
 
 /*
@@ -739,14 +757,35 @@ HoldBusy(
     if (isNew) {
 	busyPtr = CreateBusy(interp, tkwin);
 	if (busyPtr == NULL) {
+	    Tcl_DeleteHashEntry(hPtr);
 	    return TCL_ERROR;
 	}
 	Tcl_SetHashValue(hPtr, busyPtr);
 	busyPtr->hashPtr = hPtr;
     } else {
 	busyPtr = (Busy *)Tcl_GetHashValue(hPtr);
+	if (!busyPtr->active) {
+	    /*
+	     * Reusing the busy window pooled by an earlier "tk busy forget":
+	     * restore the option defaults so that this behaves exactly like
+	     * a freshly created hold.
+	     */
+
+	    Tk_FreeConfigOptions((char *) busyPtr, busyPtr->optionTable,
+		    busyPtr->tkBusy);
+	    if (Tk_InitOptions(interp, busyPtr, busyPtr->optionTable,
+		    busyPtr->tkBusy) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    if (busyPtr->cursor != NULL) {
+		Tk_DefineCursor(busyPtr->tkBusy, busyPtr->cursor);
+	    } else {
+		Tk_UndefineCursor(busyPtr->tkBusy);
+	    }
+	}
     }
 
+    busyPtr->active = 1;
     busyPtr->tablePtr = busyTablePtr;
     result = ConfigureBusy(interp, busyPtr, configObjc, configObjv);
 
@@ -893,8 +932,8 @@ Tk_BusyObjCmd(
 	for (hPtr = Tcl_FirstHashEntry(busyTablePtr, &cursor); hPtr != NULL;
 		hPtr = Tcl_NextHashEntry(&cursor)) {
 	    busyPtr = (Busy *)Tcl_GetHashValue(hPtr);
-	    if (pattern == NULL ||
-		    Tcl_StringCaseMatch(Tk_PathName(busyPtr->tkRef), pattern, 0)) {
+	    if (busyPtr->active && (pattern == NULL ||
+		    Tcl_StringCaseMatch(Tk_PathName(busyPtr->tkRef), pattern, 0))) {
 		Tcl_ListObjAppendElement(interp, objPtr,
 			Tk_NewWindowObj(busyPtr->tkRef));
 	    }
@@ -912,8 +951,15 @@ Tk_BusyObjCmd(
 	if (busyPtr == NULL) {
 	    return TCL_ERROR;
 	}
+	/*
+	 * Hide the busy window but keep it and its record pooled, so that a
+	 * later hold on the same window reuses the existing InputOnly window
+	 * instead of going through creation and destruction again. The
+	 * record is really destroyed when the reference window goes away.
+	 */
+
 	TkpHideBusyWindow(busyPtr);
-	Tcl_EventuallyFree(busyPtr, (Tcl_FreeProc *)DestroyBusy);
+	busyPtr->active = 0;
 	return TCL_OK;
 
     case BUSY_HOLD:
@@ -33,6 +33,12 @@ typedef struct Busy {
 				 * know if the reference window has been
 				 * reconfigured to a new size. */
     int menuBar;		/* Menu bar flag. */
+    int active;			/* Non-zero while the busy window is held.
+				 * Zero after "tk busy forget"; the record and
+				 * its InputOnly window are then kept pooled
+				 * so that a later hold on the same reference
+				 * window can reuse them instead of paying for
+				 * another round of window creation. */
     Tk_Cursor cursor;		/* Cursor for the busy window. */
     Tcl_HashEntry *hashPtr;	/* Used the delete the busy window entry out
 				 * of the global hash table. */
@@ -206,6 +206,28 @@ typedef struct {
     int indicatorSpace;		/* Horizontal space (in pixels) allocated for
 				 * display of indicator. */
     int indicatorDiameter;	/* Diameter of indicator, in pixels. */
+
+    /*
+     * Cached placement of the button's content (text and image/bitmap),
+     * computed by the display procedure. The placement only depends on the
+     * window size and the effective relief (the relief shifts the content),
+     * so state-only redraws such as mouse-over highlighting can reuse it.
+     * placeValid is cleared whenever the button's geometry inputs change.
+     */
+
+    int placeValid;		/* Non-zero means the fields below match the
+				 * current window size and relief. */
+    int placeWidth, placeHeight;/* Window dimensions the placement was
+				 * computed for. */
+    int placeRelief;		/* Effective relief the placement was
+				 * computed for. */
+    int placeX, placeY;		/* Upper-left corner of the content area. */
+    int placeTextX, placeTextY;	/* Where to draw the text layout. */
+    int placeImageX, placeImageY;
+				/* Where to draw the image or bitmap. */
+    int placeImageDrawW, placeImageDrawH;
+				/* Image dimensions to draw, clipped to the
+				 * window if necessary. */
     enum defaultState defaultState;
 				/* Value of -default option, such as
 				 * DEFAULT_NORMAL: specifies state of default
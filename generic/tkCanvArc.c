@@ -65,6 +65,23 @@ typedef struct ArcItem {
 				 * start (see ComputeArcOutline). */
     double center2[2];		/* Coordinates of center of arc outline at
 				 * start+extent (see ComputeArcOutline). */
+    double relOutline[26];	/* Memoized copy of outlinePtr with the
+				 * center of the bounding box subtracted
+				 * out. The outline polygon depends on the
+				 * item's position only through that center,
+				 * so a pure move can reuse these points
+				 * instead of redoing the trigonometry in
+				 * ComputeArcOutline. */
+    double relCenter1[2];	/* Memoized center1, relative likewise. */
+    double relCenter2[2];	/* Memoized center2, relative likewise. */
+    double cacheBoxWidth;	/* Bounding box width the memoized outline */
+    double cacheBoxHeight;	/* and height it was computed for. */
+    double cacheStart;		/* Start angle it was computed for. */
+    double cacheExtent;		/* Extent it was computed for. */
+    double cacheWidth;		/* Effective outline width ditto. */
+    int cacheStyle;		/* Style ditto. */
+    int outlineCacheValid;	/* Non-zero means the memoized fields above
+				 * are usable. */
     double height;              /* Distance from the arc's chord to its
 				 * mid-point. */
     double startPoint[2];       /* Start point of arc used when specifying
@@ -307,6 +324,7 @@ CreateArc(
     arcPtr->style = PIESLICE_STYLE;
     arcPtr->fillGC = NULL;
     arcPtr->height = 0;
+    arcPtr->outlineCacheValid = 0;
 
     /*
      * Process the arguments to fill in the item record.
@@ -1623,6 +1641,7 @@ ComputeArcOutline(
     double boxWidth, boxHeight;
     double vertex[2], corner1[2], corner2[2];
     double *outlinePtr;
+    int i;
     Tk_State state = arcPtr->header.state;
 
     /*
@@ -1633,6 +1652,7 @@ ComputeArcOutline(
     if (arcPtr->numOutlinePoints == 0) {
 	arcPtr->outlinePtr = (double *)ckalloc(26 * sizeof(double));
 	arcPtr->numOutlinePoints = 22;
+	memset(arcPtr->outlinePtr, 0, 26 * sizeof(double));
     }
     outlinePtr = arcPtr->outlinePtr;
 
@@ -1640,6 +1660,45 @@ ComputeArcOutline(
 	state = Canvas(canvas)->canvas_state;
     }
 
+    /*
+     * The entire outline is a rigid translation of a shape that depends
+     * only on the size of the bounding box, the angles, the style and the
+     * effective outline width, so check the memoized copy before redoing
+     * the trigonometry below. This makes pure moves cheap.
+     */
+
+    boxWidth = arcPtr->bbox[2] - arcPtr->bbox[0];
+    boxHeight = arcPtr->bbox[3] - arcPtr->bbox[1];
+    vertex[0] = (arcPtr->bbox[0] + arcPtr->bbox[2])/2.0;
+    vertex[1] = (arcPtr->bbox[1] + arcPtr->bbox[3])/2.0;
+    width = arcPtr->outline.width;
+    if (Canvas(canvas)->currentItemPtr == (Tk_Item *) arcPtr) {
+	if (arcPtr->outline.activeWidth>arcPtr->outline.width) {
+	    width = arcPtr->outline.activeWidth;
+	}
+    } else if (state == TK_STATE_DISABLED) {
+	if (arcPtr->outline.disabledWidth>arcPtr->outline.width) {
+	    width = arcPtr->outline.disabledWidth;
+	}
+    }
+    if (arcPtr->outlineCacheValid
+	    && (boxWidth == arcPtr->cacheBoxWidth)
+	    && (boxHeight == arcPtr->cacheBoxHeight)
+	    && (arcPtr->start == arcPtr->cacheStart)
+	    && (arcPtr->extent == arcPtr->cacheExtent)
+	    && (width == arcPtr->cacheWidth)
+	    && ((int) arcPtr->style == arcPtr->cacheStyle)) {
+	for (i = 0; i < 13; i++) {
+	    outlinePtr[2*i] = arcPtr->relOutline[2*i] + vertex[0];
+	    outlinePtr[2*i+1] = arcPtr->relOutline[2*i+1] + vertex[1];
+	}
+	arcPtr->center1[0] = arcPtr->relCenter1[0] + vertex[0];
+	arcPtr->center1[1] = arcPtr->relCenter1[1] + vertex[1];
+	arcPtr->center2[0] = arcPtr->relCenter2[0] + vertex[0];
+	arcPtr->center2[1] = arcPtr->relCenter2[1] + vertex[1];
+	return;
+    }
+
     /*
      * First compute the two points that lie at the centers of the ends of the
      * curved arc segment, which are marked with X's in the figure below:
@@ -1661,16 +1720,12 @@ ComputeArcOutline(
      * negate the angles in all the computations.
      */
 
-    boxWidth = arcPtr->bbox[2] - arcPtr->bbox[0];
-    boxHeight = arcPtr->bbox[3] - arcPtr->bbox[1];
     angle = -arcPtr->start*PI/180.0;
     sin1 = sin(angle);
     cos1 = cos(angle);
     angle -= arcPtr->extent*PI/180.0;
     sin2 = sin(angle);
     cos2 = cos(angle);
-    vertex[0] = (arcPtr->bbox[0] + arcPtr->bbox[2])/2.0;
-    vertex[1] = (arcPtr->bbox[1] + arcPtr->bbox[3])/2.0;
     arcPtr->center1[0] = vertex[0] + cos1*boxWidth/2.0;
     arcPtr->center1[1] = vertex[1] + sin1*boxHeight/2.0;
     arcPtr->center2[0] = vertex[0] + cos2*boxWidth/2.0;
@@ -1694,16 +1749,6 @@ ComputeArcOutline(
      * corner2. These formulas can be computed from the formula for the oval.
      */
 
-    width = arcPtr->outline.width;
-    if (Canvas(canvas)->currentItemPtr == (Tk_Item *) arcPtr) {
-	if (arcPtr->outline.activeWidth>arcPtr->outline.width) {
-	    width = arcPtr->outline.activeWidth;
-	}
-    } else if (state == TK_STATE_DISABLED) {
-	if (arcPtr->outline.disabledWidth>arcPtr->outline.width) {
-	    width = arcPtr->outline.disabledWidth;
-	}
-    }
     halfWidth = width/2.0;
 
     if (((boxWidth*sin1) == 0.0) && ((boxHeight*cos1) == 0.0)) {
@@ -1804,6 +1849,27 @@ ComputeArcOutline(
 	outlinePtr[24] = outlinePtr[12];
 	outlinePtr[25] = outlinePtr[13];
     }
+
+    /*
+     * Memoize the freshly computed outline, relative to the center of the
+     * bounding box, together with the inputs it was computed from.
+     */
+
+    for (i = 0; i < 13; i++) {
+	arcPtr->relOutline[2*i] = outlinePtr[2*i] - vertex[0];
+	arcPtr->relOutline[2*i+1] = outlinePtr[2*i+1] - vertex[1];
+    }
+    arcPtr->relCenter1[0] = arcPtr->center1[0] - vertex[0];
+    arcPtr->relCenter1[1] = arcPtr->center1[1] - vertex[1];
+    arcPtr->relCenter2[0] = arcPtr->center2[0] - vertex[0];
+    arcPtr->relCenter2[1] = arcPtr->center2[1] - vertex[1];
+    arcPtr->cacheBoxWidth = boxWidth;
+    arcPtr->cacheBoxHeight = boxHeight;
+    arcPtr->cacheStart = arcPtr->start;
+    arcPtr->cacheExtent = arcPtr->extent;
+    arcPtr->cacheWidth = width;
+    arcPtr->cacheStyle = (int) arcPtr->style;
+    arcPtr->outlineCacheValid = 1;
 }
 
 /*
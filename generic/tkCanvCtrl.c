@@ -0,0 +1,1001 @@
+/*
+ * tkCanvCtrl.c --
+ *
+ *	This file implements control items for canvas widgets: lightweight,
+ *	window-less renderings of push buttons and checkboxes. Unlike window
+ *	items, which require one X window per control, control items are
+ *	drawn straight into the canvas pixmap and hit-tested through the
+ *	ordinary canvas binding mechanism, so thousands of them cost no
+ *	server resources beyond the canvas itself and share its damage
+ *	pipeline.
+ *
+ * Copyright © 1992-1994 The Regents of the University of California.
+ * Copyright © 1994-1997 Sun Microsystems, Inc.
+ *
+ * See the file "license.terms" for information on usage and redistribution of
+ * this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ */
+
+#include "tkInt.h"
+#include "tkCanvas.h"
+#include "default.h"
+
+/*
+ * The variants of control that can be rendered.
+ */
+
+typedef enum {
+    CTRL_BUTTON, CTRL_CHECKBOX
+} ControlVariant;
+
+/*
+ * The structure below defines the record for each control item.
+ */
+
+typedef struct ControlItem {
+    Tk_Item header;		/* Generic stuff that's the same for all
+				 * types. MUST BE FIRST IN STRUCTURE. */
+    double x, y;		/* Coordinates of positioning point for
+				 * control. */
+    Tk_Anchor anchor;		/* Where to anchor control relative to
+				 * (x,y). */
+    ControlVariant variant;	/* Which kind of control to render. */
+    char *text;			/* Label to display (malloc-ed). */
+    Tk_Font tkfont;		/* Font for drawing the label. */
+    Tk_3DBorder border;		/* Face color and 3-D relief shades. */
+    XColor *fgColor;		/* Color for the label and check mark. */
+    XColor *disabledFgColor;	/* Label color when the item is disabled. */
+    XColor *indicatorColor;	/* Fill color of the checkbox indicator. */
+    int borderWidth;		/* Width of the 3-D relief. */
+    int width;			/* Overall width, or 0 to size to the
+				 * label. */
+    int height;			/* Overall height, or 0 to size to the
+				 * label. */
+    int pressed;		/* Non-zero means render the button pushed
+				 * in. */
+    int selected;		/* Non-zero means render the checkbox
+				 * checked. */
+    GC gc;			/* Graphics context for the label. */
+    GC disabledGC;		/* Graphics context for the label when
+				 * disabled. */
+    GC indicatorGC;		/* Graphics context for the indicator fill. */
+    Tk_TextLayout textLayout;	/* Cached layout of the label. */
+    int layoutWidth;		/* Size of the cached layout. */
+    int layoutHeight;
+} ControlItem;
+
+/*
+ * Geometry constants: the size of the checkbox indicator and the padding
+ * between the parts of a control.
+ */
+
+#define INDICATOR_SIZE	13
+#define CONTROL_PAD	4
+
+/*
+ * Information used for parsing configuration specs:
+ */
+
+static int		VariantParseProc(ClientData clientData,
+			    Tcl_Interp *interp, Tk_Window tkwin,
+			    const char *value, char *widgRec, TkSizeT offset);
+static const char *	VariantPrintProc(ClientData clientData,
+			    Tk_Window tkwin, char *widgRec, TkSizeT offset,
+			    Tcl_FreeProc **freeProcPtr);
+
+static const Tk_CustomOption stateOption = {
+    TkStateParseProc, TkStatePrintProc, INT2PTR(2)
+};
+static const Tk_CustomOption tagsOption = {
+    TkCanvasTagsParseProc, TkCanvasTagsPrintProc, NULL
+};
+static const Tk_CustomOption variantOption = {
+    VariantParseProc, VariantPrintProc, NULL
+};
+
+static const Tk_ConfigSpec configSpecs[] = {
+    {TK_CONFIG_ANCHOR, "-anchor", NULL, NULL,
+	"center", offsetof(ControlItem, anchor),
+	TK_CONFIG_DONT_SET_DEFAULT, NULL},
+    {TK_CONFIG_BORDER, "-background", NULL, NULL,
+	NORMAL_BG, offsetof(ControlItem, border), 0, NULL},
+    {TK_CONFIG_PIXELS, "-borderwidth", NULL, NULL,
+	"2", offsetof(ControlItem, borderWidth), 0, NULL},
+    {TK_CONFIG_COLOR, "-disabledforeground", NULL, NULL,
+	DISABLED, offsetof(ControlItem, disabledFgColor),
+	TK_CONFIG_NULL_OK, NULL},
+    {TK_CONFIG_FONT, "-font", NULL, NULL,
+	DEF_CANVTEXT_FONT, offsetof(ControlItem, tkfont), 0, NULL},
+    {TK_CONFIG_COLOR, "-foreground", NULL, NULL,
+	BLACK, offsetof(ControlItem, fgColor), 0, NULL},
+    {TK_CONFIG_PIXELS, "-height", NULL, NULL,
+	"0", offsetof(ControlItem, height), 0, NULL},
+    {TK_CONFIG_COLOR, "-indicatorcolor", NULL, NULL,
+	WHITE, offsetof(ControlItem, indicatorColor), 0, NULL},
+    {TK_CONFIG_BOOLEAN, "-pressed", NULL, NULL,
+	"0", offsetof(ControlItem, pressed), 0, NULL},
+    {TK_CONFIG_BOOLEAN, "-selected", NULL, NULL,
+	"0", offsetof(ControlItem, selected), 0, NULL},
+    {TK_CONFIG_CUSTOM, "-state", NULL, NULL,
+	NULL, offsetof(Tk_Item, state), TK_CONFIG_NULL_OK,
+	&stateOption},
+    {TK_CONFIG_CUSTOM, "-tags", NULL, NULL,
+	NULL, 0, TK_CONFIG_NULL_OK, &tagsOption},
+    {TK_CONFIG_STRING, "-text", NULL, NULL,
+	"", offsetof(ControlItem, text), 0, NULL},
+    {TK_CONFIG_CUSTOM, "-variant", NULL, NULL,
+	"button", offsetof(ControlItem, variant), TK_CONFIG_DONT_SET_DEFAULT,
+	&variantOption},
+    {TK_CONFIG_PIXELS, "-width", NULL, NULL,
+	"0", offsetof(ControlItem, width), 0, NULL},
+    {TK_CONFIG_END, NULL, NULL, NULL, NULL, 0, 0, NULL}
+};
+
+/*
+ * Prototypes for functions defined in this file:
+ */
+
+static void		ComputeControlBbox(Tk_Canvas canvas,
+			    ControlItem *ctrlPtr);
+static int		ConfigureControl(Tcl_Interp *interp,
+			    Tk_Canvas canvas, Tk_Item *itemPtr, int objc,
+			    Tcl_Obj *const objv[], int flags);
+static int		ControlCoords(Tcl_Interp *interp,
+			    Tk_Canvas canvas, Tk_Item *itemPtr, int objc,
+			    Tcl_Obj *const objv[]);
+static int		ControlToArea(Tk_Canvas canvas,
+			    Tk_Item *itemPtr, double *rectPtr);
+static double		ControlToPoint(Tk_Canvas canvas,
+			    Tk_Item *itemPtr, double *coordPtr);
+static int		CreateControl(Tcl_Interp *interp,
+			    Tk_Canvas canvas, struct Tk_Item *itemPtr,
+			    int objc, Tcl_Obj *const objv[]);
+static void		DeleteControl(Tk_Canvas canvas,
+			    Tk_Item *itemPtr, Display *display);
+static void		DisplayControl(Tk_Canvas canvas,
+			    Tk_Item *itemPtr, Display *display, Drawable dst,
+			    int x, int y, int width, int height);
+static void		RotateControl(Tk_Canvas canvas, Tk_Item *itemPtr,
+			    double originX, double originY, double angleRad);
+static void		ScaleControl(Tk_Canvas canvas,
+			    Tk_Item *itemPtr, double originX, double originY,
+			    double scaleX, double scaleY);
+static void		TranslateControl(Tk_Canvas canvas, Tk_Item *itemPtr,
+			    double deltaX, double deltaY);
+
+/*
+ * The structure below defines the control item type in terms of functions
+ * that can be invoked by generic item code.
+ */
+
+Tk_ItemType tkControlType = {
+    "control",			/* name */
+    sizeof(ControlItem),	/* itemSize */
+    CreateControl,		/* createProc */
+    configSpecs,		/* configSpecs */
+    ConfigureControl,		/* configureProc */
+    ControlCoords,		/* coordProc */
+    DeleteControl,		/* deleteProc */
+    DisplayControl,		/* displayProc */
+    TK_CONFIG_OBJS,		/* flags */
+    ControlToPoint,		/* pointProc */
+    ControlToArea,		/* areaProc */
+    NULL,			/* postscriptProc */
+    ScaleControl,		/* scaleProc */
+    TranslateControl,		/* translateProc */
+    NULL,			/* indexProc */
+    NULL,			/* icursorProc */
+    NULL,			/* selectionProc */
+    NULL,			/* insertProc */
+    NULL,			/* dTextProc */
+    NULL,			/* nextPtr */
+    RotateControl,		/* rotateProc */
+    0, NULL, NULL
+};
+
+/*
+ *--------------------------------------------------------------
+ *
+ * VariantParseProc --
+ *
+ *	This function is invoked during option processing to handle the
+ *	"-variant" option.
+ *
+ * Results:
+ *	A standard Tcl return value.
+ *
+ * Side effects:
+ *	The variant for a given item gets replaced by the variant indicated
+ *	in the value argument.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+VariantParseProc(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,		/* Used for reporting errors. */
+    TCL_UNUSED(Tk_Window),	/* Window containing canvas widget. */
+    const char *value,		/* Value of option. */
+    char *widgRec,		/* Pointer to record for item. */
+    TkSizeT offset)		/* Offset into item. */
+{
+    int c;
+    size_t length;
+    ControlVariant *variantPtr = (ControlVariant *) (widgRec + offset);
+
+    if (value == NULL || *value == 0) {
+	*variantPtr = CTRL_BUTTON;
+	return TCL_OK;
+    }
+
+    c = value[0];
+    length = strlen(value);
+
+    if ((c == 'b') && (strncmp(value, "button", length) == 0)) {
+	*variantPtr = CTRL_BUTTON;
+	return TCL_OK;
+    }
+    if ((c == 'c') && (strncmp(value, "checkbox", length) == 0)) {
+	*variantPtr = CTRL_CHECKBOX;
+	return TCL_OK;
+    }
+
+    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+	    "bad -variant option \"%s\": must be button or checkbox",
+	    value));
+    Tcl_SetErrorCode(interp, "TK", "CANVAS", "CONTROL_VARIANT", NULL);
+    *variantPtr = CTRL_BUTTON;
+    return TCL_ERROR;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * VariantPrintProc --
+ *
+ *	This function is invoked by the Tk configuration code to produce a
+ *	printable string for the "-variant" configuration option.
+ *
+ * Results:
+ *	The return value is a string describing the variant for the item
+ *	referred to by "widgRec".
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static const char *
+VariantPrintProc(
+    TCL_UNUSED(void *),		/* Ignored. */
+    TCL_UNUSED(Tk_Window),	/* Ignored. */
+    char *widgRec,		/* Pointer to record for item. */
+    TkSizeT offset,		/* Offset into item. */
+    TCL_UNUSED(Tcl_FreeProc **))
+				/* Pointer to variable to fill in with
+				 * information about how to reclaim storage
+				 * for return string. */
+{
+    ControlVariant *variantPtr = (ControlVariant *) (widgRec + offset);
+
+    if (*variantPtr == CTRL_CHECKBOX) {
+	return "checkbox";
+    }
+    return "button";
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * CreateControl --
+ *
+ *	This function is invoked to create a new control item in a canvas.
+ *
+ * Results:
+ *	A standard Tcl return value. If an error occurred in creating the
+ *	item, then an error message is left in the interp's result; in this
+ *	case itemPtr is left uninitialized, so it can be safely freed by the
+ *	caller.
+ *
+ * Side effects:
+ *	A new control item is created.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+CreateControl(
+    Tcl_Interp *interp,		/* Interpreter for error reporting. */
+    Tk_Canvas canvas,		/* Canvas to hold new item. */
+    Tk_Item *itemPtr,		/* Record to hold new item; header has been
+				 * initialized by caller. */
+    int objc,			/* Number of arguments in objv. */
+    Tcl_Obj *const objv[])	/* Arguments describing item. */
+{
+    ControlItem *ctrlPtr = (ControlItem *) itemPtr;
+    int i;
+
+    if (objc == 0) {
+	Tcl_Panic("canvas did not pass any coords");
+    }
+
+    /*
+     * Initialize item's record.
+     */
+
+    ctrlPtr->anchor = TK_ANCHOR_CENTER;
+    ctrlPtr->variant = CTRL_BUTTON;
+    ctrlPtr->text = NULL;
+    ctrlPtr->tkfont = NULL;
+    ctrlPtr->border = NULL;
+    ctrlPtr->fgColor = NULL;
+    ctrlPtr->disabledFgColor = NULL;
+    ctrlPtr->indicatorColor = NULL;
+    ctrlPtr->borderWidth = 0;
+    ctrlPtr->width = 0;
+    ctrlPtr->height = 0;
+    ctrlPtr->pressed = 0;
+    ctrlPtr->selected = 0;
+    ctrlPtr->gc = NULL;
+    ctrlPtr->disabledGC = NULL;
+    ctrlPtr->indicatorGC = NULL;
+    ctrlPtr->textLayout = NULL;
+    ctrlPtr->layoutWidth = 0;
+    ctrlPtr->layoutHeight = 0;
+
+    /*
+     * Process the arguments to fill in the item record. Only 1 (list) or 2 (x
+     * y) coords are allowed.
+     */
+
+    if (objc == 1) {
+	i = 1;
+    } else {
+	const char *arg = Tcl_GetString(objv[1]);
+	i = 2;
+	if ((arg[0] == '-') && (arg[1] >= 'a') && (arg[1] <= 'z')) {
+	    i = 1;
+	}
+    }
+    if (ControlCoords(interp, canvas, itemPtr, i, objv) != TCL_OK) {
+	goto error;
+    }
+    if (ConfigureControl(interp, canvas, itemPtr, objc-i, objv+i, 0)
+	    == TCL_OK) {
+	return TCL_OK;
+    }
+
+  error:
+    DeleteControl(canvas, itemPtr, Tk_Display(Tk_CanvasTkwin(canvas)));
+    return TCL_ERROR;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * ControlCoords --
+ *
+ *	This function is invoked to process the "coords" widget command on
+ *	control items. See the user documentation for details on what it
+ *	does.
+ *
+ * Results:
+ *	Returns TCL_OK or TCL_ERROR, and sets the interp's result.
+ *
+ * Side effects:
+ *	The coordinates for the given item may be changed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+ControlCoords(
+    Tcl_Interp *interp,		/* Used for error reporting. */
+    Tk_Canvas canvas,		/* Canvas containing item. */
+    Tk_Item *itemPtr,		/* Item whose coordinates are to be read or
+				 * modified. */
+    int objc,			/* Number of coordinates supplied in objv. */
+    Tcl_Obj *const objv[])	/* Array of coordinates: x1, y1, x2, y2, ... */
+{
+    ControlItem *ctrlPtr = (ControlItem *) itemPtr;
+
+    if (objc == 0) {
+	Tcl_Obj *obj = Tcl_NewObj();
+
+	Tcl_ListObjAppendElement(NULL, obj, Tcl_NewDoubleObj(ctrlPtr->x));
+	Tcl_ListObjAppendElement(NULL, obj, Tcl_NewDoubleObj(ctrlPtr->y));
+	Tcl_SetObjResult(interp, obj);
+    } else if (objc < 3) {
+	if (objc == 1) {
+	    if (Tcl_ListObjGetElements(interp, objv[0], &objc,
+		    (Tcl_Obj ***) &objv) != TCL_OK) {
+		return TCL_ERROR;
+	    } else if (objc != 2) {
+		Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+			"wrong # coordinates: expected 2, got %d", objc));
+		Tcl_SetErrorCode(interp, "TK", "CANVAS", "COORDS", "CONTROL",
+			NULL);
+		return TCL_ERROR;
+	    }
+	}
+	if ((Tk_CanvasGetCoordFromObj(interp, canvas, objv[0],
+		&ctrlPtr->x) != TCL_OK)
+		|| (Tk_CanvasGetCoordFromObj(interp, canvas, objv[1],
+			&ctrlPtr->y) != TCL_OK)) {
+	    return TCL_ERROR;
+	}
+	ComputeControlBbox(canvas, ctrlPtr);
+    } else {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"wrong # coordinates: expected 0 or 2, got %d", objc));
+	Tcl_SetErrorCode(interp, "TK", "CANVAS", "COORDS", "CONTROL", NULL);
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * ConfigureControl --
+ *
+ *	This function is invoked to configure various aspects of a control
+ *	item, such as its label and colors.
+ *
+ * Results:
+ *	A standard Tcl result code. If an error occurs, then an error message
+ *	is left in the interp's result.
+ *
+ * Side effects:
+ *	Configuration information may be set for itemPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+ConfigureControl(
+    Tcl_Interp *interp,		/* Used for error reporting. */
+    Tk_Canvas canvas,		/* Canvas containing itemPtr. */
+    Tk_Item *itemPtr,		/* Control item to reconfigure. */
+    int objc,			/* Number of elements in objv. */
+    Tcl_Obj *const objv[],	/* Arguments describing things to configure. */
+    int flags)			/* Flags to pass to Tk_ConfigureWidget. */
+{
+    ControlItem *ctrlPtr = (ControlItem *) itemPtr;
+    XGCValues gcValues;
+    GC newGC;
+    Tk_Window tkwin;
+    unsigned long mask;
+
+    tkwin = Tk_CanvasTkwin(canvas);
+    if (TCL_OK != Tk_ConfigureWidget(interp, tkwin, configSpecs, objc,
+	    (const char **) objv, (char *) ctrlPtr, flags|TK_CONFIG_OBJS)) {
+	return TCL_ERROR;
+    }
+
+    /*
+     * Rebuild the graphics contexts and the cached label layout; all of the
+     * rendering in DisplayControl works from these.
+     */
+
+    gcValues.font = Tk_FontId(ctrlPtr->tkfont);
+    gcValues.foreground = ctrlPtr->fgColor->pixel;
+    mask = GCFont|GCForeground;
+    newGC = Tk_GetGC(tkwin, mask, &gcValues);
+    if (ctrlPtr->gc != NULL) {
+	Tk_FreeGC(Tk_Display(tkwin), ctrlPtr->gc);
+    }
+    ctrlPtr->gc = newGC;
+
+    if (ctrlPtr->disabledFgColor != NULL) {
+	gcValues.foreground = ctrlPtr->disabledFgColor->pixel;
+	newGC = Tk_GetGC(tkwin, mask, &gcValues);
+    } else {
+	newGC = NULL;
+    }
+    if (ctrlPtr->disabledGC != NULL) {
+	Tk_FreeGC(Tk_Display(tkwin), ctrlPtr->disabledGC);
+    }
+    ctrlPtr->disabledGC = newGC;
+
+    gcValues.foreground = ctrlPtr->indicatorColor->pixel;
+    newGC = Tk_GetGC(tkwin, GCForeground, &gcValues);
+    if (ctrlPtr->indicatorGC != NULL) {
+	Tk_FreeGC(Tk_Display(tkwin), ctrlPtr->indicatorGC);
+    }
+    ctrlPtr->indicatorGC = newGC;
+
+    if (ctrlPtr->textLayout != NULL) {
+	Tk_FreeTextLayout(ctrlPtr->textLayout);
+    }
+    ctrlPtr->textLayout = Tk_ComputeTextLayout(ctrlPtr->tkfont,
+	    ctrlPtr->text, -1, 0, TK_JUSTIFY_CENTER, 0,
+	    &ctrlPtr->layoutWidth, &ctrlPtr->layoutHeight);
+
+    ComputeControlBbox(canvas, ctrlPtr);
+    return TCL_OK;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * DeleteControl --
+ *
+ *	This function is called to clean up the data structure associated
+ *	with a control item.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Resources associated with itemPtr are released.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+DeleteControl(
+    Tk_Canvas canvas,		/* Info about overall canvas widget. */
+    Tk_Item *itemPtr,		/* Item that is being deleted. */
+    Display *display)		/* Display containing window for canvas. */
+{
+    ControlItem *ctrlPtr = (ControlItem *) itemPtr;
+    (void)canvas;
+
+    if (ctrlPtr->text != NULL) {
+	ckfree(ctrlPtr->text);
+    }
+    if (ctrlPtr->tkfont != NULL) {
+	Tk_FreeFont(ctrlPtr->tkfont);
+    }
+    if (ctrlPtr->border != NULL) {
+	Tk_Free3DBorder(ctrlPtr->border);
+    }
+    if (ctrlPtr->fgColor != NULL) {
+	Tk_FreeColor(ctrlPtr->fgColor);
+    }
+    if (ctrlPtr->disabledFgColor != NULL) {
+	Tk_FreeColor(ctrlPtr->disabledFgColor);
+    }
+    if (ctrlPtr->indicatorColor != NULL) {
+	Tk_FreeColor(ctrlPtr->indicatorColor);
+    }
+    if (ctrlPtr->gc != NULL) {
+	Tk_FreeGC(display, ctrlPtr->gc);
+    }
+    if (ctrlPtr->disabledGC != NULL) {
+	Tk_FreeGC(display, ctrlPtr->disabledGC);
+    }
+    if (ctrlPtr->indicatorGC != NULL) {
+	Tk_FreeGC(display, ctrlPtr->indicatorGC);
+    }
+    if (ctrlPtr->textLayout != NULL) {
+	Tk_FreeTextLayout(ctrlPtr->textLayout);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * ComputeControlBbox --
+ *
+ *	This function is invoked to compute the bounding box of all the
+ *	pixels that may be drawn as part of a control item.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The fields x1, y1, x2, and y2 are updated in the header for itemPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+ComputeControlBbox(
+    Tk_Canvas canvas,		/* Canvas that contains item. */
+    ControlItem *ctrlPtr)	/* Item whose bbox is to be recomputed. */
+{
+    int width, height;
+    int x, y;
+    Tk_State state = ctrlPtr->header.state;
+
+    if (state == TK_STATE_NULL) {
+	state = Canvas(canvas)->canvas_state;
+    }
+
+    x = (int) (ctrlPtr->x + ((ctrlPtr->x >= 0) ? 0.5 : - 0.5));
+    y = (int) (ctrlPtr->y + ((ctrlPtr->y >= 0) ? 0.5 : - 0.5));
+
+    if (state == TK_STATE_HIDDEN) {
+	ctrlPtr->header.x1 = ctrlPtr->header.x2 = x;
+	ctrlPtr->header.y1 = ctrlPtr->header.y2 = y;
+	return;
+    }
+
+    /*
+     * Compute the natural size of the control from its label, unless an
+     * explicit size was configured.
+     */
+
+    if (ctrlPtr->variant == CTRL_CHECKBOX) {
+	width = INDICATOR_SIZE + 2*CONTROL_PAD;
+	if (ctrlPtr->layoutWidth > 0) {
+	    width += CONTROL_PAD + ctrlPtr->layoutWidth;
+	}
+	height = ctrlPtr->layoutHeight;
+	if (height < INDICATOR_SIZE) {
+	    height = INDICATOR_SIZE;
+	}
+	height += 2*CONTROL_PAD;
+    } else {
+	width = ctrlPtr->layoutWidth
+		+ 2*(ctrlPtr->borderWidth + 2*CONTROL_PAD);
+	height = ctrlPtr->layoutHeight
+		+ 2*(ctrlPtr->borderWidth + CONTROL_PAD);
+    }
+    if (ctrlPtr->width > 0) {
+	width = ctrlPtr->width;
+    }
+    if (ctrlPtr->height > 0) {
+	height = ctrlPtr->height;
+    }
+
+    switch (ctrlPtr->anchor) {
+    case TK_ANCHOR_N:
+	x -= width/2;
+	break;
+    case TK_ANCHOR_NE:
+	x -= width;
+	break;
+    case TK_ANCHOR_E:
+	x -= width;
+	y -= height/2;
+	break;
+    case TK_ANCHOR_SE:
+	x -= width;
+	y -= height;
+	break;
+    case TK_ANCHOR_S:
+	x -= width/2;
+	y -= height;
+	break;
+    case TK_ANCHOR_SW:
+	y -= height;
+	break;
+    case TK_ANCHOR_W:
+	y -= height/2;
+	break;
+    case TK_ANCHOR_NW:
+	break;
+    case TK_ANCHOR_CENTER:
+	x -= width/2;
+	y -= height/2;
+	break;
+    }
+
+    /*
+     * Store the information in the item header.
+     */
+
+    ctrlPtr->header.x1 = x;
+    ctrlPtr->header.y1 = y;
+    ctrlPtr->header.x2 = x + width;
+    ctrlPtr->header.y2 = y + height;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * DisplayControl --
+ *
+ *	This function is invoked to draw a control item in a given drawable.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	ItemPtr is drawn in drawable using the transformation information in
+ *	canvas.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+DisplayControl(
+    Tk_Canvas canvas,		/* Canvas that contains item. */
+    Tk_Item *itemPtr,		/* Item to be displayed. */
+    Display *display,		/* Display on which to draw item. */
+    Drawable drawable,		/* Pixmap or window in which to draw item. */
+    int x, int y, int width, int height)
+				/* Describes region of canvas that must be
+				 * redisplayed (not used). */
+{
+    ControlItem *ctrlPtr = (ControlItem *) itemPtr;
+    Tk_Window tkwin = Tk_CanvasTkwin(canvas);
+    short drawableX, drawableY;
+    int itemWidth, itemHeight, textX, textY, offset;
+    GC labelGC;
+    Tk_State state = itemPtr->state;
+    (void)x;
+    (void)y;
+    (void)width;
+    (void)height;
+
+    if (state == TK_STATE_NULL) {
+	state = Canvas(canvas)->canvas_state;
+    }
+    labelGC = ctrlPtr->gc;
+    if ((state == TK_STATE_DISABLED) && (ctrlPtr->disabledGC != NULL)) {
+	labelGC = ctrlPtr->disabledGC;
+    }
+
+    Tk_CanvasDrawableCoords(canvas, (double) ctrlPtr->header.x1,
+	    (double) ctrlPtr->header.y1, &drawableX, &drawableY);
+    itemWidth = ctrlPtr->header.x2 - ctrlPtr->header.x1;
+    itemHeight = ctrlPtr->header.y2 - ctrlPtr->header.y1;
+
+    if (ctrlPtr->variant == CTRL_CHECKBOX) {
+	int boxX = drawableX + CONTROL_PAD;
+	int boxY = drawableY + (itemHeight - INDICATOR_SIZE)/2;
+
+	/*
+	 * Flat face, a sunken indicator well, and a check mark when the
+	 * checkbox is selected.
+	 */
+
+	Tk_Fill3DRectangle(tkwin, drawable, ctrlPtr->border, drawableX,
+		drawableY, itemWidth, itemHeight, 0, TK_RELIEF_FLAT);
+	Tk_Fill3DRectangle(tkwin, drawable, ctrlPtr->border, boxX, boxY,
+		INDICATOR_SIZE, INDICATOR_SIZE, 1, TK_RELIEF_SUNKEN);
+	XFillRectangle(display, drawable, ctrlPtr->indicatorGC,
+		boxX + 2, boxY + 2, INDICATOR_SIZE - 4, INDICATOR_SIZE - 4);
+	if (ctrlPtr->selected) {
+	    XPoint points[3];
+
+	    points[0].x = boxX + 3;
+	    points[0].y = boxY + 6;
+	    points[1].x = boxX + 5;
+	    points[1].y = boxY + 9;
+	    points[2].x = boxX + 9;
+	    points[2].y = boxY + 3;
+	    XDrawLines(display, drawable, labelGC, points, 3,
+		    CoordModeOrigin);
+	    points[0].y++;
+	    points[1].y++;
+	    points[2].y++;
+	    XDrawLines(display, drawable, labelGC, points, 3,
+		    CoordModeOrigin);
+	}
+
+	textX = drawableX + CONTROL_PAD + INDICATOR_SIZE + CONTROL_PAD;
+	textY = drawableY + (itemHeight - ctrlPtr->layoutHeight)/2;
+    } else {
+	/*
+	 * A raised face that sinks - and nudges its label - while pressed.
+	 */
+
+	Tk_Fill3DRectangle(tkwin, drawable, ctrlPtr->border, drawableX,
+		drawableY, itemWidth, itemHeight, ctrlPtr->borderWidth,
+		ctrlPtr->pressed ? TK_RELIEF_SUNKEN : TK_RELIEF_RAISED);
+	offset = ctrlPtr->pressed ? 1 : 0;
+	textX = drawableX + (itemWidth - ctrlPtr->layoutWidth)/2 + offset;
+	textY = drawableY + (itemHeight - ctrlPtr->layoutHeight)/2 + offset;
+    }
+
+    if (ctrlPtr->layoutWidth > 0) {
+	Tk_DrawTextLayout(display, drawable, labelGC, ctrlPtr->textLayout,
+		textX, textY, 0, -1);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * ControlToPoint --
+ *
+ *	Computes the distance from a given point to a given control item, in
+ *	canvas units.
+ *
+ * Results:
+ *	The return value is 0 if the point whose x and y coordinates are
+ *	coordPtr[0] and coordPtr[1] is inside the control. If the point isn't
+ *	inside the control then the return value is the distance from the
+ *	point to the control.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static double
+ControlToPoint(
+    Tk_Canvas canvas,		/* Canvas containing item. */
+    Tk_Item *itemPtr,		/* Item to check against point. */
+    double *coordPtr)		/* Pointer to x and y coordinates. */
+{
+    ControlItem *ctrlPtr = (ControlItem *) itemPtr;
+    double x1, x2, y1, y2, xDiff, yDiff;
+    (void)canvas;
+
+    x1 = ctrlPtr->header.x1;
+    y1 = ctrlPtr->header.y1;
+    x2 = ctrlPtr->header.x2;
+    y2 = ctrlPtr->header.y2;
+
+    /*
+     * Point is outside rectangle.
+     */
+
+    if (coordPtr[0] < x1) {
+	xDiff = x1 - coordPtr[0];
+    } else if (coordPtr[0] > x2)  {
+	xDiff = coordPtr[0] - x2;
+    } else {
+	xDiff = 0;
+    }
+
+    if (coordPtr[1] < y1) {
+	yDiff = y1 - coordPtr[1];
+    } else if (coordPtr[1] > y2)  {
+	yDiff = coordPtr[1] - y2;
+    } else {
+	yDiff = 0;
+    }
+
+    return hypot(xDiff, yDiff);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * ControlToArea --
+ *
+ *	This function is called to determine whether an item lies entirely
+ *	inside, entirely outside, or overlapping a given rectangle.
+ *
+ * Results:
+ *	-1 is returned if the item is entirely outside the area given by
+ *	rectPtr, 0 if it overlaps, and 1 if it is entirely inside the given
+ *	area.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+ControlToArea(
+    Tk_Canvas canvas,		/* Canvas containing item. */
+    Tk_Item *itemPtr,		/* Item to check against rectangle. */
+    double *rectPtr)		/* Pointer to array of four coordinates
+				 * (x1,y1,x2,y2) describing rectangular
+				 * area. */
+{
+    ControlItem *ctrlPtr = (ControlItem *) itemPtr;
+    (void)canvas;
+
+    if ((rectPtr[2] <= ctrlPtr->header.x1)
+	    || (rectPtr[0] >= ctrlPtr->header.x2)
+	    || (rectPtr[3] <= ctrlPtr->header.y1)
+	    || (rectPtr[1] >= ctrlPtr->header.y2)) {
+	return -1;
+    }
+    if ((rectPtr[0] <= ctrlPtr->header.x1)
+	    && (rectPtr[1] <= ctrlPtr->header.y1)
+	    && (rectPtr[2] >= ctrlPtr->header.x2)
+	    && (rectPtr[3] >= ctrlPtr->header.y2)) {
+	return 1;
+    }
+    return 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * ScaleControl --
+ *
+ *	This function is invoked to rescale a control item. The position of
+ *	the item is scaled, but a control keeps its configured size: it is a
+ *	piece of user interface, not a drawing.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The item referred to by itemPtr is moved.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+ScaleControl(
+    Tk_Canvas canvas,		/* Canvas containing item. */
+    Tk_Item *itemPtr,		/* Item to be scaled. */
+    double originX, double originY,
+				/* Origin about which to scale item. */
+    double scaleX,		/* Amount to scale in X direction. */
+    double scaleY)		/* Amount to scale in Y direction. */
+{
+    ControlItem *ctrlPtr = (ControlItem *) itemPtr;
+
+    ctrlPtr->x = originX + scaleX*(ctrlPtr->x - originX);
+    ctrlPtr->y = originY + scaleY*(ctrlPtr->y - originY);
+    ComputeControlBbox(canvas, ctrlPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * RotateControl --
+ *
+ *	This function is invoked to rotate a control item's positioning
+ *	point. The control itself stays axis-aligned.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The position of the item is rotated about (originX, originY), and the
+ *	bounding box is updated in the generic part of the item structure.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+RotateControl(
+    Tk_Canvas canvas,
+    Tk_Item *itemPtr,
+    double originX,
+    double originY,
+    double angleRad)
+{
+    ControlItem *ctrlPtr = (ControlItem *) itemPtr;
+
+    TkRotatePoint(originX, originY, sin(angleRad), cos(angleRad),
+	    &ctrlPtr->x, &ctrlPtr->y);
+    ComputeControlBbox(canvas, ctrlPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TranslateControl --
+ *
+ *	This function is called to move a control item by a given amount.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The position of the control is offset by (xDelta, yDelta), and the
+ *	bounding box is updated in the generic part of the item structure.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+TranslateControl(
+    Tk_Canvas canvas,		/* Canvas containing item. */
+    Tk_Item *itemPtr,		/* Item that is being moved. */
+    double deltaX,		/* Amount by which item is to be moved. */
+    double deltaY)
+{
+    ControlItem *ctrlPtr = (ControlItem *) itemPtr;
+
+    ctrlPtr->x += deltaX;
+    ctrlPtr->y += deltaY;
+    ComputeControlBbox(canvas, ctrlPtr);
+}
+
+/*
+ * Local Variables:
+ * mode: c
+ * c-basic-offset: 4
+ * fill-column: 78
+ * End:
+ */
@@ -894,6 +894,8 @@ ImageChangedProc(
 {
     ImageItem *imgPtr = (ImageItem *)clientData;
 
+    TkCanvasStaticDamageItem(imgPtr->canvas, &imgPtr->header);
+
     /*
      * If the image's size changed and it's not anchored at its northwest
      * corner then just redisplay the entire area of the image. This is a bit
@@ -30,6 +30,10 @@ typedef struct LineItem {
     Tk_Canvas canvas;		/* Canvas containing item. Needed for parsing
 				 * arrow shapes. */
     int numPoints;		/* Number of points in line (always >= 0). */
+    int coordSpace;		/* Number of points that coordPtr has room
+				 * for; may exceed numPoints so repeated
+				 * coords/insert calls don't reallocate on
+				 * every change. */
     double *coordPtr;		/* Pointer to malloc-ed array containing x-
 				 * and y-coords of all points in line.
 				 * X-coords are even-valued indices, y-coords
@@ -62,6 +66,18 @@ typedef struct LineItem {
     const Tk_SmoothMethod *smooth; /* Non-zero means draw line smoothed (i.e.
 				 * with Bezier splines). */
     int splineSteps;		/* Number of steps in each spline segment. */
+    double *splinePtr;		/* Cached flattened curve points (x- and
+				 * y-coords, like coordPtr) for the standard
+				 * bezier smoothing method, or NULL. Only
+				 * meaningful while splineCount > 0. */
+    int splineCount;		/* Number of points at splinePtr; 0 means the
+				 * cache is invalid. */
+    int splineStable;		/* Number of leading points at splinePtr that
+				 * remain valid when further input points are
+				 * appended; the rest were generated with the
+				 * end-of-curve control points and must be
+				 * regenerated on append. */
+    int splineSpace;		/* Number of points splinePtr has room for. */
 } LineItem;
 
 /*
@@ -90,6 +106,8 @@ static void		DeleteLine(Tk_Canvas canvas,
 static void		DisplayLine(Tk_Canvas canvas,
 			    Tk_Item *itemPtr, Display *display, Drawable dst,
 			    int x, int y, int width, int height);
+static void		ExtendLineBbox(Tk_Canvas canvas, LineItem *linePtr,
+			    int oldNumPoints);
 static int		GetLineIndex(Tcl_Interp *interp,
 			    Tk_Canvas canvas, Tk_Item *itemPtr,
 			    Tcl_Obj *obj, TkSizeT *indexPtr);
@@ -100,6 +118,8 @@ static void		LineDeleteCoords(Tk_Canvas canvas,
 			    Tk_Item *itemPtr, TkSizeT first, TkSizeT last);
 static void		LineInsert(Tk_Canvas canvas,
 			    Tk_Item *itemPtr, TkSizeT beforeThis, Tcl_Obj *obj);
+static int		LineSplineAppend(LineItem *linePtr, int oldNumPoints);
+static int		LineSplineEnsure(LineItem *linePtr);
 static int		LineToArea(Tk_Canvas canvas,
 			    Tk_Item *itemPtr, double *rectPtr);
 static double		LineToPoint(Tk_Canvas canvas,
@@ -297,6 +317,7 @@ CreateLine(
     Tk_CreateOutline(&linePtr->outline);
     linePtr->canvas = canvas;
     linePtr->numPoints = 0;
+    linePtr->coordSpace = 0;
     linePtr->coordPtr = NULL;
     linePtr->capStyle = CapButt;
     linePtr->joinStyle = JoinRound;
@@ -309,6 +330,10 @@ CreateLine(
     linePtr->lastArrowPtr = NULL;
     linePtr->smooth = NULL;
     linePtr->splineSteps = 12;
+    linePtr->splinePtr = NULL;
+    linePtr->splineCount = 0;
+    linePtr->splineStable = 0;
+    linePtr->splineSpace = 0;
 
     /*
      * Count the number of points and then parse them into a point array.
@@ -362,7 +387,7 @@ LineCoords(
     Tcl_Obj *const objv[])	/* Array of coordinates: x1, y1, x2, y2, ... */
 {
     LineItem *linePtr = (LineItem *) itemPtr;
-    int i, numPoints;
+    int i, numPoints, oldNumPoints, appendOnly;
     double *coordPtr;
 
     if (objc == 0) {
@@ -408,20 +433,56 @@ LineCoords(
     }
 
     numPoints = objc/2;
-    if (linePtr->numPoints != numPoints) {
-	coordPtr = (double *)ckalloc(sizeof(double) * objc);
-	if (linePtr->coordPtr != NULL) {
-	    ckfree(linePtr->coordPtr);
+    oldNumPoints = linePtr->numPoints;
+    if (oldNumPoints != numPoints) {
+	/*
+	 * Keep the existing array when it's big enough; grow with headroom
+	 * so a stream of coords calls with varying point counts doesn't
+	 * reallocate on every call. The old contents are preserved so that
+	 * append-only updates can be recognized below.
+	 */
+
+	if (numPoints > linePtr->coordSpace) {
+	    int space = 2*linePtr->coordSpace;
+
+	    if (space < numPoints) {
+		space = numPoints;
+	    }
+	    coordPtr = (double *)ckalloc(sizeof(double) * 2*space);
+	    if (linePtr->coordPtr != NULL) {
+		memcpy(coordPtr, linePtr->coordPtr,
+			sizeof(double) * 2*oldNumPoints);
+		ckfree(linePtr->coordPtr);
+	    }
+	    linePtr->coordPtr = coordPtr;
+	    linePtr->coordSpace = space;
 	}
-	linePtr->coordPtr = coordPtr;
 	linePtr->numPoints = numPoints;
     }
+
+    /*
+     * Parse the new coordinates, watching for the common live-trace case of
+     * points being appended to a smoothed line: if all of the existing
+     * points are unchanged and the cached flattened curve is valid, only
+     * the trailing spline segments and the bounding box additions need to
+     * be recomputed instead of the whole curve.
+     */
+
+    appendOnly = (linePtr->splineCount > 0) && (numPoints > oldNumPoints)
+	    && (linePtr->arrow == ARROWS_NONE);
     coordPtr = linePtr->coordPtr;
     for (i = 0; i < objc ; i++) {
+	double coord;
+
 	if (Tk_CanvasGetCoordFromObj(interp, canvas, objv[i],
-		coordPtr++) != TCL_OK) {
+		&coord) != TCL_OK) {
+	    linePtr->splineCount = 0;
 	    return TCL_ERROR;
 	}
+	if (appendOnly && (i < 2*oldNumPoints) && (coord != coordPtr[i])) {
+	    appendOnly = 0;
+	}
+	coordPtr[i] = coord;
     }
 
     /*
@@ -440,7 +501,12 @@ LineCoords(
     if (linePtr->arrow != ARROWS_NONE) {
 	ConfigureArrows(canvas, linePtr);
     }
-    ComputeLineBbox(canvas, linePtr);
+    if (appendOnly && LineSplineAppend(linePtr, oldNumPoints)) {
+	ExtendLineBbox(canvas, linePtr, oldNumPoints);
+    } else {
+	linePtr->splineCount = 0;
+	ComputeLineBbox(canvas, linePtr);
+    }
     return TCL_OK;
 }
 
@@ -485,6 +551,13 @@ ConfigureLine(
 	return TCL_ERROR;
     }
 
+    /*
+     * The smoothing method or step count may have changed, so any cached
+     * flattened curve can no longer be trusted.
+     */
+
+    linePtr->splineCount = 0;
+
     /*
      * A few of the options require additional processing, such as graphics
      * contexts.
@@ -615,6 +688,9 @@ DeleteLine(
     if (linePtr->coordPtr != NULL) {
 	ckfree(linePtr->coordPtr);
     }
+    if (linePtr->splinePtr != NULL) {
+	ckfree(linePtr->splinePtr);
+    }
     if (linePtr->arrowGC != NULL) {
 	Tk_FreeGC(display, linePtr->arrowGC);
     }
@@ -810,6 +886,253 @@ ComputeLineBbox(
     linePtr->header.y2 += 1;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * LineSplineEnsure --
+ *
+ *	Make sure the cached flattened curve for a line smoothed with the
+ *	standard bezier method is up to date, building it if necessary. The
+ *	cache holds the same canvas-coordinate points that the smoothing
+ *	method's coordProc would produce, so redisplays can convert them to
+ *	screen coordinates directly and append-only coords updates can
+ *	regenerate just the trailing spline units.
+ *
+ * Results:
+ *	Returns 1 if the cache is valid on return, 0 if the curve cannot be
+ *	cached (it is closed, which involves wrap-around spline units).
+ *
+ * Side effects:
+ *	May allocate or fill in the cache storage.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+LineSplineEnsure(
+    LineItem *linePtr)		/* Line whose spline cache is needed. */
+{
+    int numPoints = linePtr->numPoints;
+    int numCoords = 2*numPoints;
+    int steps, need, lastSize;
+
+    if (linePtr->splineCount > 0) {
+	return 1;
+    }
+    if ((linePtr->coordPtr[0] == linePtr->coordPtr[numCoords-2])
+	    && (linePtr->coordPtr[1] == linePtr->coordPtr[numCoords-1])) {
+	return 0;
+    }
+    steps = linePtr->splineSteps;
+    if (steps < 1) {
+	steps = 1;
+    }
+    need = 1 + numPoints*steps;
+    if (need > linePtr->splineSpace) {
+	if (linePtr->splinePtr != NULL) {
+	    ckfree(linePtr->splinePtr);
+	}
+	linePtr->splinePtr = (double *)ckalloc(sizeof(double) * 2*need);
+	linePtr->splineSpace = need;
+    }
+    linePtr->splinePtr[0] = linePtr->coordPtr[0];
+    linePtr->splinePtr[1] = linePtr->coordPtr[1];
+    linePtr->splineCount = 1 + TkMakeBezierCurveSegments(linePtr->coordPtr,
+	    numPoints, 2, linePtr->splineSteps, linePtr->splinePtr + 2,
+	    &lastSize);
+    linePtr->splineStable = linePtr->splineCount - lastSize;
+    return 1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * LineSplineAppend --
+ *
+ *	Extend the cached flattened curve of a smoothed line after new points
+ *	have been appended to it, regenerating only the trailing spline units
+ *	that depend on the appended points.
+ *
+ * Results:
+ *	Returns 1 if the cache was extended in place; 0 if the curve has
+ *	become closed and the cache must be rebuilt from scratch instead.
+ *
+ * Side effects:
+ *	The cached curve and its bookkeeping are updated; its storage may be
+ *	reallocated.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+LineSplineAppend(
+    LineItem *linePtr,		/* Line whose spline cache is to be grown. */
+    int oldNumPoints)		/* Number of input points the cache currently
+				 * covers. */
+{
+    int numPoints = linePtr->numPoints;
+    int numCoords = 2*numPoints;
+    int steps, need, tailPoints, lastSize;
+
+    if ((linePtr->coordPtr[0] == linePtr->coordPtr[numCoords-2])
+	    && (linePtr->coordPtr[1] == linePtr->coordPtr[numCoords-1])) {
+	return 0;
+    }
+
+    /*
+     * Spline units oldNumPoints-1 through numPoints-1 must be regenerated:
+     * the old final unit was built with the end-of-curve control points and
+     * is now interior, and each appended point adds one unit.
+     */
+
+    steps = linePtr->splineSteps;
+    if (steps < 1) {
+	steps = 1;
+    }
+    need = linePtr->splineStable + (numPoints - oldNumPoints + 1)*steps;
+    if (need > linePtr->splineSpace) {
+	int space = 2*linePtr->splineSpace;
+	double *newPtr;
+
+	if (space < need) {
+	    space = need;
+	}
+	newPtr = (double *)ckalloc(sizeof(double) * 2*space);
+	memcpy(newPtr, linePtr->splinePtr,
+		sizeof(double) * 2*linePtr->splineStable);
+	ckfree(linePtr->splinePtr);
+	linePtr->splinePtr = newPtr;
+	linePtr->splineSpace = space;
+    }
+    tailPoints = TkMakeBezierCurveSegments(linePtr->coordPtr, numPoints,
+	    oldNumPoints - 1, linePtr->splineSteps,
+	    linePtr->splinePtr + 2*linePtr->splineStable, &lastSize);
+    linePtr->splineCount = linePtr->splineStable + tailPoints;
+    linePtr->splineStable = linePtr->splineCount - lastSize;
+    return 1;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * ExtendLineBbox --
+ *
+ *	Grow the bounding box of a line to cover points that have just been
+ *	appended to it, without rescanning all of the older points. Only the
+ *	appended points and the joins around the old endpoint can add new
+ *	area; the margins applied match those of ComputeLineBbox, so the
+ *	result covers everything that function would include (it may keep a
+ *	little extra slack from features, such as end caps, that have moved).
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The fields x1, y1, x2, and y2 may be updated in the header for
+ *	linePtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+ExtendLineBbox(
+    Tk_Canvas canvas,		/* Canvas that contains item. */
+    LineItem *linePtr,		/* Item whose bbox is to be extended. */
+    int oldNumPoints)		/* Number of points already covered by the
+				 * current bbox. */
+{
+    double *coordPtr;
+    double width;
+    int i, intWidth, margin, first;
+    Tk_State state = linePtr->header.state;
+
+    if (state == TK_STATE_NULL) {
+	state = Canvas(canvas)->canvas_state;
+    }
+
+    /*
+     * Fall back to the full computation for the cases it special-cases:
+     * hidden items have an empty bbox, and stipple offsets depend on the
+     * overall extent.
+     */
+
+    if ((state == TK_STATE_HIDDEN) || (linePtr->outline.tsoffset.flags != 0)
+	    || (linePtr->arrow != ARROWS_NONE)) {
+	ComputeLineBbox(canvas, linePtr);
+	return;
+    }
+
+    width = linePtr->outline.width;
+    if (width < 1.0) {
+	width = 1.0;
+    }
+    intWidth = (int) (width + 0.5);
+    margin = intWidth + 1;	/* Line width plus the one-pixel fudge factor
+				 * that ComputeLineBbox applies. */
+
+    /*
+     * Include the appended points and the old endpoint, which has acquired
+     * a join. Unlike ComputeLineBbox, the margin is applied per point since
+     * the older points already carry it.
+     */
+
+    first = oldNumPoints - 2;
+    if (first < 0) {
+	first = 0;
+    }
+    for (i = first, coordPtr = linePtr->coordPtr + 2*first;
+	    i < linePtr->numPoints; i++, coordPtr += 2) {
+	if ((int) coordPtr[0] - margin < linePtr->header.x1) {
+	    linePtr->header.x1 = (int) coordPtr[0] - margin;
+	}
+	if ((int) coordPtr[0] + margin > linePtr->header.x2) {
+	    linePtr->header.x2 = (int) coordPtr[0] + margin;
+	}
+	if ((int) coordPtr[1] - margin < linePtr->header.y1) {
+	    linePtr->header.y1 = (int) coordPtr[1] - margin;
+	}
+	if ((int) coordPtr[1] + margin > linePtr->header.y2) {
+	    linePtr->header.y2 = (int) coordPtr[1] + margin;
+	}
+    }
+
+    /*
+     * Mitered joins at or beyond the old endpoint may stick out further;
+     * include their vertex points with the same one-pixel fudge used by
+     * ComputeLineBbox.
+     */
+
+    if ((linePtr->joinStyle == JoinMiter) && (linePtr->numPoints >= 3)) {
+	first = oldNumPoints - 3;
+	if (first < 0) {
+	    first = 0;
+	}
+	for (i = first, coordPtr = linePtr->coordPtr + 2*first;
+		i + 2 < linePtr->numPoints; i++, coordPtr += 2) {
+	    double miter[4];
+	    int j;
+
+	    if (TkGetMiterPoints(coordPtr, coordPtr+2, coordPtr+4,
+		    width, miter, miter+2)) {
+		for (j = 0; j < 4; j += 2) {
+		    if ((int) miter[j] - 1 < linePtr->header.x1) {
+			linePtr->header.x1 = (int) miter[j] - 1;
+		    }
+		    if ((int) miter[j] + 1 > linePtr->header.x2) {
+			linePtr->header.x2 = (int) miter[j] + 1;
+		    }
+		    if ((int) miter[j+1] - 1 < linePtr->header.y1) {
+			linePtr->header.y1 = (int) miter[j+1] - 1;
+		    }
+		    if ((int) miter[j+1] + 1 > linePtr->header.y2) {
+			linePtr->header.y2 = (int) miter[j+1] + 1;
+		    }
+		}
+	    }
+	}
+    }
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -842,7 +1165,7 @@ DisplayLine(
     XPoint staticPoints[MAX_STATIC_POINTS*3];
     XPoint *pointPtr;
     double linewidth;
-    int numPoints;
+    int numPoints, useSpline;
     Tk_State state = itemPtr->state;
 
     if (!linePtr->numPoints || (linePtr->outline.gc == NULL)) {
@@ -865,13 +1188,23 @@ DisplayLine(
     /*
      * Build up an array of points in screen coordinates. Use a static array
      * unless the line has an enormous number of points; in this case,
-     * dynamically allocate an array. For smoothed lines, generate the curve
-     * points on each redisplay.
+     * dynamically allocate an array. For lines smoothed with the standard
+     * bezier method the flattened curve is cached in canvas coordinates, so
+     * redisplays just convert it to screen coordinates; other smoothing
+     * methods generate the curve points on each redisplay.
      */
 
+    useSpline = 0;
     if ((linePtr->smooth) && (linePtr->numPoints > 2)) {
-	numPoints = linePtr->smooth->coordProc(canvas, NULL,
-		linePtr->numPoints, linePtr->splineSteps, NULL, NULL);
+	if (linePtr->smooth == &tkBezierSmoothMethod) {
+	    useSpline = LineSplineEnsure(linePtr);
+	}
+	if (useSpline) {
+	    numPoints = linePtr->splineCount;
+	} else {
+	    numPoints = linePtr->smooth->coordProc(canvas, NULL,
+		    linePtr->numPoints, linePtr->splineSteps, NULL, NULL);
+	}
     } else {
 	numPoints = linePtr->numPoints;
     }
@@ -882,7 +1215,15 @@ DisplayLine(
 	pointPtr = (XPoint *)ckalloc(numPoints * 3 * sizeof(XPoint));
     }
 
-    if ((linePtr->smooth) && (linePtr->numPoints > 2)) {
+    if (useSpline) {
+	int i;
+	double *splinePtr = linePtr->splinePtr;
+
+	for (i = 0; i < numPoints; i++, splinePtr += 2) {
+	    Tk_CanvasDrawableCoords(canvas, splinePtr[0], splinePtr[1],
+		    &pointPtr[i].x, &pointPtr[i].y);
+	}
+    } else if ((linePtr->smooth) && (linePtr->numPoints > 2)) {
 	numPoints = linePtr->smooth->coordProc(canvas, linePtr->coordPtr,
 		linePtr->numPoints, linePtr->splineSteps, pointPtr, NULL);
     } else {
@@ -973,6 +1314,8 @@ LineInsert(
 	    || !objc || objc&1) {
 	return;
     }
+    TkCanvasStaticDamageItem(canvas, itemPtr);
+    linePtr->splineCount = 0;
     length = 2*linePtr->numPoints;
     if (beforeThis == TCL_INDEX_NONE) {
 	beforeThis = 0;
@@ -988,26 +1331,49 @@ LineInsert(
 	linePtr->coordPtr[length-2] = linePtr->lastArrowPtr[0];
 	linePtr->coordPtr[length-1] = linePtr->lastArrowPtr[1];
     }
-    newCoordPtr = (double *)ckalloc(sizeof(double) * (length + objc));
-    for (i=0; i<(int)beforeThis; i++) {
-	newCoordPtr[i] = linePtr->coordPtr[i];
-    }
-    for (i=0; i<objc; i++) {
-	if (Tcl_GetDoubleFromObj(NULL, objv[i],
-		&newCoordPtr[i + beforeThis]) != TCL_OK) {
-	    Tcl_ResetResult(Canvas(canvas)->interp);
-	    ckfree(newCoordPtr);
-	    return;
+    if (((int)beforeThis == length)
+	    && (length + objc <= 2*linePtr->coordSpace)) {
+	/*
+	 * Appending at the end within the existing capacity (the common
+	 * streaming case): parse straight into the spare space. On a parse
+	 * error the item is untouched because numPoints hasn't moved yet.
+	 */
+
+	for (i=0; i<objc; i++) {
+	    if (Tcl_GetDoubleFromObj(NULL, objv[i],
+		    &linePtr->coordPtr[length + i]) != TCL_OK) {
+		Tcl_ResetResult(Canvas(canvas)->interp);
+		return;
+	    }
 	}
-    }
+    } else {
+	int space = 2*linePtr->coordSpace;
 
-    for (i=beforeThis; i<length; i++) {
-	newCoordPtr[i+objc] = linePtr->coordPtr[i];
-    }
-    if (linePtr->coordPtr) {
-        ckfree(linePtr->coordPtr);
+	if (space < (length + objc + 1)/2) {
+	    space = (length + objc + 1)/2;
+	}
+	newCoordPtr = (double *)ckalloc(sizeof(double) * 2*space);
+	for (i=0; i<(int)beforeThis; i++) {
+	    newCoordPtr[i] = linePtr->coordPtr[i];
+	}
+	for (i=0; i<objc; i++) {
+	    if (Tcl_GetDoubleFromObj(NULL, objv[i],
+		    &newCoordPtr[i + beforeThis]) != TCL_OK) {
+		Tcl_ResetResult(Canvas(canvas)->interp);
+		ckfree(newCoordPtr);
+		return;
+	    }
+	}
+
+	for (i=beforeThis; i<length; i++) {
+	    newCoordPtr[i+objc] = linePtr->coordPtr[i];
+	}
+	if (linePtr->coordPtr) {
+	    ckfree(linePtr->coordPtr);
+	}
+	linePtr->coordPtr = newCoordPtr;
+	linePtr->coordSpace = space;
     }
-    linePtr->coordPtr = newCoordPtr;
     length += objc ;
     linePtr->numPoints = length / 2;
 
@@ -1161,6 +1527,8 @@ LineDeleteCoords(
     if (state == TK_STATE_NULL) {
 	state = Canvas(canvas)->canvas_state;
     }
+    TkCanvasStaticDamageItem(canvas, itemPtr);
+    linePtr->splineCount = 0;
 
     first &= -2;
     last &= -2;
@@ -1708,8 +2076,20 @@ ScaleLine(
 	coordPtr[0] = originX + scaleX*(*coordPtr - originX);
 	coordPtr[1] = originY + scaleY*(coordPtr[1] - originY);
     }
+
+    /*
+     * The spline construction is affine, so the cached flattened curve can
+     * be scaled directly instead of being thrown away.
+     */
+
+    for (i = 0, coordPtr = linePtr->splinePtr; i < linePtr->splineCount;
+	    i++, coordPtr += 2) {
+	coordPtr[0] = originX + scaleX*(*coordPtr - originX);
+	coordPtr[1] = originY + scaleY*(coordPtr[1] - originY);
+    }
     if (linePtr->arrow != ARROWS_NONE) {
 	ConfigureArrows(canvas, linePtr);
+	linePtr->splineCount = 0;
     }
     ComputeLineBbox(canvas, linePtr);
 }
@@ -1851,6 +2231,11 @@ TranslateLine(
 	    coordPtr[1] += deltaY;
 	}
     }
+    for (i = 0, coordPtr = linePtr->splinePtr; i < linePtr->splineCount;
+	    i++, coordPtr += 2) {
+	coordPtr[0] += deltaX;
+	coordPtr[1] += deltaY;
+    }
     ComputeLineBbox(canvas, linePtr);
 }
 
@@ -1901,6 +2286,7 @@ RotateLine(
 	    TkRotatePoint(originX, originY, s, c, &coordPtr[0], &coordPtr[1]);
 	}
     }
+    linePtr->splineCount = 0;
     ComputeLineBbox(canvas, linePtr);
 }
 
@@ -15,6 +15,11 @@
 #include "tkCanvas.h"
 #include "default.h"
 
+#undef MIN
+#define MIN(a,b) (((a) < (b)) ? (a) : (b))
+#undef MAX
+#define MAX(a,b) (((a) > (b)) ? (a) : (b))
+
 /*
  * The structure below defines the record for each polygon item.
  */
@@ -49,6 +54,19 @@ typedef struct PolygonItem  {
     int splineSteps;		/* Number of steps in each spline segment. */
     int autoClosed;		/* Zero means the given polygon was closed,
 				   one means that we auto closed it. */
+    int *edgeBucketStartPtr;	/* Lazily built edge table used to answer
+				 * point-in-polygon queries without scanning
+				 * every edge: edges are bucketed by the
+				 * x-range they span, and a query only visits
+				 * the bucket containing the query point.
+				 * This array holds numEdgeBuckets+1 offsets
+				 * into edgeIndexPtr. NULL means the table
+				 * has not been built since the coordinates
+				 * last changed. */
+    int *edgeIndexPtr;		/* Edge indices, concatenated per bucket. */
+    int numEdgeBuckets;		/* Number of buckets in the table. */
+    double edgeTableX0;		/* X-coordinate where bucket 0 starts. */
+    double edgeBucketWidth;	/* Width of each bucket, in canvas units. */
 } PolygonItem;
 
 /*
@@ -150,6 +168,10 @@ static const Tk_ConfigSpec configSpecs[] = {
 
 static void		ComputePolygonBbox(Tk_Canvas canvas,
 			    PolygonItem *polyPtr);
+static void		BuildPolygonEdgeTable(PolygonItem *polyPtr);
+static void		FreePolygonEdgeTable(PolygonItem *polyPtr);
+static int		PolygonPointInside(PolygonItem *polyPtr,
+			    double *pointPtr);
 static int		ConfigurePolygon(Tcl_Interp *interp,
 			    Tk_Canvas canvas, Tk_Item *itemPtr, int objc,
 			    Tcl_Obj *const objv[], int flags);
@@ -281,6 +303,9 @@ CreatePolygon(
     polyPtr->smooth = NULL;
     polyPtr->splineSteps = 12;
     polyPtr->autoClosed = 0;
+    polyPtr->edgeBucketStartPtr = NULL;
+    polyPtr->edgeIndexPtr = NULL;
+    polyPtr->numEdgeBuckets = 0;
 
     /*
      * Count the number of points and then parse them into a point array.
@@ -369,17 +394,24 @@ PolygonCoords(
 
     numPoints = objc/2;
     if (polyPtr->pointsAllocated <= numPoints) {
+	int space = 2*polyPtr->pointsAllocated;
+
 	if (polyPtr->coordPtr != NULL) {
 	    ckfree(polyPtr->coordPtr);
 	}
 
 	/*
 	 * One extra point gets allocated here, because we always add
-	 * another point to close the polygon.
+	 * another point to close the polygon. Grow with headroom so
+	 * repeated coords calls with growing point counts don't
+	 * reallocate every time.
 	 */
 
-	polyPtr->coordPtr = (double *)ckalloc(sizeof(double) * (objc+2));
-	polyPtr->pointsAllocated = numPoints+1;
+	if (space <= numPoints) {
+	    space = numPoints+1;
+	}
+	polyPtr->coordPtr = (double *)ckalloc(sizeof(double) * 2*space);
+	polyPtr->pointsAllocated = space;
     }
     for (i = objc-1; i >= 0; i--) {
 	if (Tk_CanvasGetCoordFromObj(interp, canvas, objv[i],
@@ -597,6 +629,7 @@ DeletePolygon(
     if (polyPtr->fillGC != NULL) {
 	Tk_FreeGC(display, polyPtr->fillGC);
     }
+    FreePolygonEdgeTable(polyPtr);
 }
 
 /*
@@ -630,6 +663,14 @@ ComputePolygonBbox(
     if (state == TK_STATE_NULL) {
 	state = Canvas(canvas)->canvas_state;
     }
+
+    /*
+     * Any operation that lands here may have changed the coordinates, so
+     * the cached edge table (if any) is stale.
+     */
+
+    FreePolygonEdgeTable(polyPtr);
+
     width = polyPtr->outline.width;
     if (polyPtr->coordPtr == NULL || (polyPtr->numPoints < 1)
 	    || (state == TK_STATE_HIDDEN)) {
@@ -1034,6 +1075,7 @@ PolygonInsert(
 	    || !objc || objc&1) {
 	return;
     }
+    TkCanvasStaticDamageItem(canvas, itemPtr);
     length = 2*(polyPtr->numPoints - polyPtr->autoClosed);
     while ((int)beforeThis > length) {
 	beforeThis -= length;
@@ -1177,6 +1219,7 @@ PolygonDeleteCoords(
     int count, i;
     int length = 2*(polyPtr->numPoints - polyPtr->autoClosed);
 
+    TkCanvasStaticDamageItem(canvas, itemPtr);
     while ((int)first >= length) {
 	first -= length;
     }
@@ -1223,6 +1266,246 @@ PolygonDeleteCoords(
     ComputePolygonBbox(canvas, polyPtr);
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * BuildPolygonEdgeTable --
+ *
+ *	Build the cached edge table for a polygon. Point-in-polygon testing
+ *	casts a vertical ray through the query point, so an edge can only
+ *	contribute if the point's x-coordinate falls within the x-range the
+ *	edge spans; the table buckets the edges by that range so a query
+ *	visits one bucket instead of every edge.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory is allocated for the table; it is released by
+ *	FreePolygonEdgeTable when the coordinates change or the item is
+ *	deleted.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+BuildPolygonEdgeTable(
+    PolygonItem *polyPtr)	/* Polygon whose table is to be built. */
+{
+    int numEdges = polyPtr->numPoints - 1;
+    int numBuckets, total, i, lo, hi;
+    double minX, maxX, eMin, eMax;
+    double *coordPtr = polyPtr->coordPtr;
+    int *startPtr, *indexPtr;
+
+    minX = maxX = coordPtr[0];
+    for (i = 1; i < polyPtr->numPoints; i++) {
+	if (coordPtr[2*i] < minX) {
+	    minX = coordPtr[2*i];
+	} else if (coordPtr[2*i] > maxX) {
+	    maxX = coordPtr[2*i];
+	}
+    }
+
+    /*
+     * Pick the bucket count so that the table stays linear in the number of
+     * edges: long edges land in every bucket they span, so halve the bucket
+     * count until the total number of entries is within bounds.
+     */
+
+    numBuckets = numEdges;
+    if (numBuckets > 256) {
+	numBuckets = 256;
+    }
+    if ((numBuckets < 1) || (maxX <= minX)) {
+	numBuckets = 1;
+    }
+    for (;;) {
+	total = 0;
+	for (i = 0; i < numEdges; i++) {
+	    if (coordPtr[2*i] == coordPtr[2*i+2]) {
+		continue;	/* Vertical edge: never intersects. */
+	    }
+	    eMin = MIN(coordPtr[2*i], coordPtr[2*i+2]);
+	    eMax = MAX(coordPtr[2*i], coordPtr[2*i+2]);
+	    lo = (int) ((eMin - minX) * numBuckets / (maxX - minX));
+	    hi = (int) ((eMax - minX) * numBuckets / (maxX - minX));
+	    if (lo < 0) {
+		lo = 0;
+	    }
+	    if (hi >= numBuckets) {
+		hi = numBuckets - 1;
+	    }
+	    total += hi - lo + 1;
+	}
+	if ((total <= 4*numEdges) || (numBuckets <= 1)) {
+	    break;
+	}
+	numBuckets /= 2;
+    }
+
+    startPtr = (int *)ckalloc((numBuckets + 1) * sizeof(int));
+    indexPtr = (int *)ckalloc((total > 0 ? total : 1) * sizeof(int));
+
+    /*
+     * Counting sort: first accumulate per-bucket counts into startPtr,
+     * convert to offsets, then drop each edge into its buckets.
+     */
+
+    for (i = 0; i <= numBuckets; i++) {
+	startPtr[i] = 0;
+    }
+    for (i = 0; i < numEdges; i++) {
+	if (coordPtr[2*i] == coordPtr[2*i+2]) {
+	    continue;
+	}
+	eMin = MIN(coordPtr[2*i], coordPtr[2*i+2]);
+	eMax = MAX(coordPtr[2*i], coordPtr[2*i+2]);
+	lo = (int) ((eMin - minX) * numBuckets / (maxX - minX));
+	hi = (int) ((eMax - minX) * numBuckets / (maxX - minX));
+	if (lo < 0) {
+	    lo = 0;
+	}
+	if (hi >= numBuckets) {
+	    hi = numBuckets - 1;
+	}
+	for (; lo <= hi; lo++) {
+	    startPtr[lo+1]++;
+	}
+    }
+    for (i = 0; i < numBuckets; i++) {
+	startPtr[i+1] += startPtr[i];
+    }
+    for (i = 0; i < numEdges; i++) {
+	if (coordPtr[2*i] == coordPtr[2*i+2]) {
+	    continue;
+	}
+	eMin = MIN(coordPtr[2*i], coordPtr[2*i+2]);
+	eMax = MAX(coordPtr[2*i], coordPtr[2*i+2]);
+	lo = (int) ((eMin - minX) * numBuckets / (maxX - minX));
+	hi = (int) ((eMax - minX) * numBuckets / (maxX - minX));
+	if (lo < 0) {
+	    lo = 0;
+	}
+	if (hi >= numBuckets) {
+	    hi = numBuckets - 1;
+	}
+	for (; lo <= hi; lo++) {
+	    indexPtr[startPtr[lo]++] = i;
+	}
+    }
+    for (i = numBuckets; i > 0; i--) {
+	startPtr[i] = startPtr[i-1];
+    }
+    startPtr[0] = 0;
+
+    polyPtr->edgeBucketStartPtr = startPtr;
+    polyPtr->edgeIndexPtr = indexPtr;
+    polyPtr->numEdgeBuckets = numBuckets;
+    polyPtr->edgeTableX0 = minX;
+    polyPtr->edgeBucketWidth = (maxX - minX) / numBuckets;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * FreePolygonEdgeTable --
+ *
+ *	Release the cached edge table of a polygon, if one exists.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory is released; the next point query rebuilds the table.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+FreePolygonEdgeTable(
+    PolygonItem *polyPtr)	/* Polygon whose table is to be released. */
+{
+    if (polyPtr->edgeBucketStartPtr != NULL) {
+	ckfree(polyPtr->edgeBucketStartPtr);
+	polyPtr->edgeBucketStartPtr = NULL;
+    }
+    if (polyPtr->edgeIndexPtr != NULL) {
+	ckfree(polyPtr->edgeIndexPtr);
+	polyPtr->edgeIndexPtr = NULL;
+    }
+    polyPtr->numEdgeBuckets = 0;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * PolygonPointInside --
+ *
+ *	Decide whether a point lies inside the fill region of a polygon
+ *	using the cached edge table, building it first if necessary. The
+ *	intersection rule matches TkPolygonToPoint exactly (vertical ray,
+ *	x-range half-open on the right, vertical edges ignored) so the two
+ *	always agree about insideness.
+ *
+ * Results:
+ *	1 if the point is inside the polygon, 0 if it is outside, -1 if the
+ *	polygon is too small for the test to be meaningful.
+ *
+ * Side effects:
+ *	The edge table may be built.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+PolygonPointInside(
+    PolygonItem *polyPtr,	/* Polygon to check against. */
+    double *pointPtr)		/* Coordinates of the query point. */
+{
+    int b, i, intersections;
+    int *startPtr, *indexPtr;
+    double px = pointPtr[0], py = pointPtr[1];
+    double *edgePtr, m1, b1;
+
+    if ((polyPtr->numPoints < 3) || (polyPtr->coordPtr == NULL)) {
+	return -1;
+    }
+    if (polyPtr->edgeBucketStartPtr == NULL) {
+	BuildPolygonEdgeTable(polyPtr);
+    }
+    startPtr = polyPtr->edgeBucketStartPtr;
+    indexPtr = polyPtr->edgeIndexPtr;
+
+    if ((px < polyPtr->edgeTableX0) || (polyPtr->edgeBucketWidth <= 0)) {
+	return 0;
+    }
+    b = (int) ((px - polyPtr->edgeTableX0) / polyPtr->edgeBucketWidth);
+    if (b >= polyPtr->numEdgeBuckets) {
+	return 0;
+    }
+
+    intersections = 0;
+    for (i = startPtr[b]; i < startPtr[b+1]; i++) {
+	edgePtr = polyPtr->coordPtr + 2*indexPtr[i];
+	if (edgePtr[0] >= edgePtr[2]) {
+	    if ((px >= edgePtr[0]) || (px < edgePtr[2])) {
+		continue;
+	    }
+	} else {
+	    if ((px >= edgePtr[2]) || (px < edgePtr[0])) {
+		continue;
+	    }
+	}
+	m1 = (edgePtr[3] - edgePtr[1]) / (edgePtr[2] - edgePtr[0]);
+	b1 = edgePtr[1] - m1*edgePtr[0];
+	if (m1*px + b1 > py) {
+	    intersections++;
+	}
+    }
+    return intersections & 0x1;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1279,6 +1562,18 @@ PolygonToPoint(
     }
     radius = width/2.0;
 
+    /*
+     * A point inside the fill region is at distance 0 no matter what the
+     * outline looks like, so consult the cached edge table before doing
+     * the full per-edge scan. Smoothed polygons hit-test against their
+     * expanded point set, which the table does not describe.
+     */
+
+    if (!(polyPtr->smooth && (polyPtr->numPoints > 2))
+	    && (PolygonPointInside(polyPtr, pointPtr) > 0)) {
+	return 0.0;
+    }
+
     /*
      * Handle smoothed polygons by generating an expanded set of points
      * against which to do the check.
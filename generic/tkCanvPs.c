@@ -34,6 +34,34 @@ typedef struct TkColormapData {	/* Hold color information for a window */
     int red_shift, green_shift, blue_shift;	/* color band */
 } TkColormapData;
 
+/*
+ * One of the following structures carries the state of a buffered encoder
+ * for Postscript image data. Pixels are accumulated in a local character
+ * buffer so that they do not each pay for a Tcl_Obj append, and the data can
+ * optionally be compressed with a RunLengthEncode/ASCII85 filter chain
+ * (Level 2) instead of plain hex.
+ */
+
+#define STREAM_BUFFER_SIZE 2048
+
+typedef struct PostscriptStream {
+    Tcl_Obj *psObj;		/* Where to append encoded output. */
+    int ascii85;		/* 0 means plain hex (ASCIIHexDecode); 1 means
+				 * run-length packets wrapped in ASCII85. */
+    int lineLen;		/* Characters emitted on the current output
+				 * line. */
+    unsigned char runByte;	/* Current run-length candidate byte. */
+    int runCount;		/* Number of pending copies of runByte. */
+    unsigned char literal[128];	/* Pending bytes that are not part of a run
+				 * long enough to pack. */
+    int literalCount;		/* Number of bytes in literal. */
+    unsigned int group;		/* Partial 4-byte group for ASCII85. */
+    int groupCount;		/* Number of bytes accumulated in group. */
+    char buffer[STREAM_BUFFER_SIZE];
+				/* Local output accumulator. */
+    int bufferCount;		/* Characters in buffer. */
+} PostscriptStream;
+
 /*
  * One of the following structures is created to keep track of Postscript
  * output being generated. It consists mostly of information provided on the
@@ -67,6 +95,11 @@ typedef struct TkPostscriptInfo {
 				 * "gray", or "color".  Malloc'ed. */
     int colorLevel;		/* Numeric value corresponding to colorMode: 0
 				 * for mono, 1 for gray, 2 for color. */
+    char *imageEncoding;	/* Encoding for photo image data: "hex" or
+				 * "ascii85".  Malloc'ed. */
+    int imageA85;		/* Non-zero means encode photo image data with
+				 * the Level-2 RunLengthEncode/ASCII85 filter
+				 * chain rather than plain hex. */
     char *fileName;		/* Name of file in which to write Postscript;
 				 * NULL means return Postscript info as
 				 * result. Malloc'ed. */
@@ -105,6 +138,8 @@ static const Tk_ConfigSpec configSpecs[] = {
 	"", offsetof(TkPostscriptInfo, fontVar), 0, NULL},
     {TK_CONFIG_PIXELS, "-height", NULL, NULL,
 	"", offsetof(TkPostscriptInfo, height), 0, NULL},
+    {TK_CONFIG_STRING, "-imageencoding", NULL, NULL,
+	"", offsetof(TkPostscriptInfo, imageEncoding), 0, NULL},
     {TK_CONFIG_ANCHOR, "-pageanchor", NULL, NULL,
 	"", offsetof(TkPostscriptInfo, pageAnchor), 0, NULL},
     {TK_CONFIG_STRING, "-pageheight", NULL, NULL,
@@ -138,6 +173,11 @@ static void		PostscriptBitmap(Tk_Window tkwin, Pixmap bitmap,
 			    int startX, int startY, int width, int height,
 			    Tcl_Obj *psObj);
 static inline Tcl_Obj *	GetPostscriptBuffer(Tcl_Interp *interp);
+static void		StreamInit(PostscriptStream *streamPtr,
+			    Tcl_Obj *psObj, int ascii85);
+static void		StreamPutByte(PostscriptStream *streamPtr,
+			    unsigned int byte);
+static void		StreamEnd(PostscriptStream *streamPtr);
 
 /*
  *--------------------------------------------------------------
@@ -229,6 +269,8 @@ TkCanvPostscriptCmd(
     psInfo.colorVar = NULL;
     psInfo.colorMode = NULL;
     psInfo.colorLevel = 0;
+    psInfo.imageEncoding = NULL;
+    psInfo.imageA85 = 0;
     psInfo.fileName = NULL;
     psInfo.channelName = NULL;
     psInfo.chan = NULL;
@@ -334,6 +376,25 @@ TkCanvPostscriptCmd(
 	}
     }
 
+    if (psInfo.imageEncoding == NULL) {
+	psInfo.imageA85 = 0;
+    } else {
+	length = strlen(psInfo.imageEncoding);
+	if (strncmp(psInfo.imageEncoding, "hex", length) == 0) {
+	    psInfo.imageA85 = 0;
+	} else if (strncmp(psInfo.imageEncoding, "ascii85", length) == 0) {
+	    psInfo.imageA85 = 1;
+	} else {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "bad image encoding \"%s\": must be hex or ascii85",
+		    psInfo.imageEncoding));
+	    Tcl_SetErrorCode(interp, "TK", "CANVAS", "PS", "IMAGEENCODING",
+		    NULL);
+	    result = TCL_ERROR;
+	    goto cleanup;
+	}
+    }
+
     if (psInfo.fileName != NULL) {
 	/*
 	 * Check that -file and -channel are not both specified.
@@ -644,6 +705,9 @@ TkCanvPostscriptCmd(
     if (psInfo.colorMode != NULL) {
 	ckfree(psInfo.colorMode);
     }
+    if (psInfo.imageEncoding != NULL) {
+	ckfree(psInfo.imageEncoding);
+    }
     if (psInfo.fileName != NULL) {
 	ckfree(psInfo.fileName);
     }
@@ -1464,6 +1528,208 @@ TkPostscriptImage(
     return TCL_OK;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * StreamInit, StreamPutByte, StreamEnd --
+ *
+ *	These functions implement a buffered encoder for the image data emitted
+ *	into Postscript output. StreamInit prepares the state, StreamPutByte
+ *	adds one data byte, and StreamEnd flushes everything pending and writes
+ *	the end-of-data marker. In hex mode bytes are written for an
+ *	ASCIIHexDecode filter; in ascii85 mode they are packed into
+ *	RunLengthDecode packets and wrapped in ASCII85 for a Level-2
+ *	interpreter, which typically shrinks photo data severalfold.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Postscript data is appended to the Tcl_Obj handed to StreamInit.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+StreamFlush(
+    PostscriptStream *streamPtr)
+{
+    if (streamPtr->bufferCount > 0) {
+	Tcl_AppendToObj(streamPtr->psObj, streamPtr->buffer,
+		streamPtr->bufferCount);
+	streamPtr->bufferCount = 0;
+    }
+}
+
+static void
+StreamChar(
+    PostscriptStream *streamPtr,
+    char c)
+{
+    if (streamPtr->bufferCount >= STREAM_BUFFER_SIZE - 2) {
+	StreamFlush(streamPtr);
+    }
+    streamPtr->buffer[streamPtr->bufferCount++] = c;
+    if (++streamPtr->lineLen >= 60) {
+	streamPtr->buffer[streamPtr->bufferCount++] = '\n';
+	streamPtr->lineLen = 0;
+    }
+}
+
+static void
+StreamA85Byte(
+    PostscriptStream *streamPtr,
+    unsigned int byte)
+{
+    unsigned int group;
+    char c[5];
+    int i;
+
+    streamPtr->group = (streamPtr->group << 8) | (byte & 0xff);
+    if (++streamPtr->groupCount < 4) {
+	return;
+    }
+    group = streamPtr->group;
+    streamPtr->group = 0;
+    streamPtr->groupCount = 0;
+    if (group == 0) {
+	StreamChar(streamPtr, 'z');
+	return;
+    }
+    for (i = 4; i >= 0; i--) {
+	c[i] = (char) ('!' + group % 85);
+	group /= 85;
+    }
+    for (i = 0; i < 5; i++) {
+	StreamChar(streamPtr, c[i]);
+    }
+}
+
+static void
+StreamLiteralFlush(
+    PostscriptStream *streamPtr)
+{
+    int i;
+
+    if (streamPtr->literalCount > 0) {
+	StreamA85Byte(streamPtr, streamPtr->literalCount - 1);
+	for (i = 0; i < streamPtr->literalCount; i++) {
+	    StreamA85Byte(streamPtr, streamPtr->literal[i]);
+	}
+	streamPtr->literalCount = 0;
+    }
+}
+
+static void
+StreamRunFlush(
+    PostscriptStream *streamPtr)
+{
+    int i;
+
+    if (streamPtr->runCount >= 3) {
+	/*
+	 * Long enough for a repeat packet. Pending literal bytes preceded
+	 * the run, so they must be emitted first.
+	 */
+
+	StreamLiteralFlush(streamPtr);
+	StreamA85Byte(streamPtr, 257 - streamPtr->runCount);
+	StreamA85Byte(streamPtr, streamPtr->runByte);
+    } else {
+	for (i = 0; i < streamPtr->runCount; i++) {
+	    streamPtr->literal[streamPtr->literalCount++] = streamPtr->runByte;
+	    if (streamPtr->literalCount == 128) {
+		StreamLiteralFlush(streamPtr);
+	    }
+	}
+    }
+    streamPtr->runCount = 0;
+}
+
+static void
+StreamInit(
+    PostscriptStream *streamPtr,
+    Tcl_Obj *psObj,
+    int ascii85)
+{
+    streamPtr->psObj = psObj;
+    streamPtr->ascii85 = ascii85;
+    streamPtr->lineLen = 0;
+    streamPtr->runCount = 0;
+    streamPtr->literalCount = 0;
+    streamPtr->group = 0;
+    streamPtr->groupCount = 0;
+    streamPtr->bufferCount = 0;
+}
+
+static void
+StreamPutByte(
+    PostscriptStream *streamPtr,
+    unsigned int byte)
+{
+    static const char hex[] = "0123456789ABCDEF";
+
+    byte &= 0xff;
+    if (!streamPtr->ascii85) {
+	StreamChar(streamPtr, hex[byte >> 4]);
+	StreamChar(streamPtr, hex[byte & 0xf]);
+	return;
+    }
+    if ((streamPtr->runCount > 0) && (byte == streamPtr->runByte)
+	    && (streamPtr->runCount < 128)) {
+	streamPtr->runCount++;
+	return;
+    }
+    StreamRunFlush(streamPtr);
+    streamPtr->runByte = (unsigned char) byte;
+    streamPtr->runCount = 1;
+}
+
+static void
+StreamEnd(
+    PostscriptStream *streamPtr)
+{
+    unsigned int group;
+    char c[5];
+    int i;
+
+    if (!streamPtr->ascii85) {
+	StreamFlush(streamPtr);
+	Tcl_AppendToObj(streamPtr->psObj, ">\n", -1);
+	return;
+    }
+
+    /*
+     * Flush the pending run-length state, then write the RunLengthDecode
+     * end-of-data marker, which is itself part of the ASCII85 payload.
+     */
+
+    StreamRunFlush(streamPtr);
+    StreamLiteralFlush(streamPtr);
+    StreamA85Byte(streamPtr, 128);
+
+    /*
+     * A trailing partial group is padded with zero bytes and written without
+     * the padding's characters; the 'z' shorthand is not allowed here.
+     */
+
+    if (streamPtr->groupCount > 0) {
+	int count = streamPtr->groupCount;
+
+	group = streamPtr->group << (8 * (4 - count));
+	for (i = 4; i >= 0; i--) {
+	    c[i] = (char) ('!' + group % 85);
+	    group /= 85;
+	}
+	for (i = 0; i <= count; i++) {
+	    StreamChar(streamPtr, c[i]);
+	}
+	streamPtr->groupCount = 0;
+    }
+    StreamFlush(streamPtr);
+    Tcl_AppendToObj(streamPtr->psObj, "~>\n", -1);
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1496,13 +1762,14 @@ Tk_PostscriptPhoto(
     int colorLevel = psInfoPtr->colorLevel;
     const char *displayOperation, *decode;
     unsigned char *pixelPtr;
-    int bpc, xx, yy, lineLen, alpha;
+    int bpc, xx, yy, alpha;
     float red, green, blue;
     int bytesPerLine = 0, maxWidth = 0;
     unsigned char opaque = 255;
     unsigned char *alphaPtr;
     int alphaOffset, alphaPitch, alphaIncr;
     Tcl_Obj *psObj;
+    PostscriptStream stream;
 
     if (psInfoPtr->prepass) {
 	return TCL_OK;
@@ -1568,10 +1835,14 @@ Tk_PostscriptPhoto(
     Tcl_AppendPrintfToObj(psObj,
 	    "<<\n  /ImageType 1\n"
 	    "  /Width %d\n  /Height %d\n  /BitsPerComponent %d\n"
-	    "  /DataSource currentfile\n  /ASCIIHexDecode filter\n"
+	    "  /DataSource currentfile\n  %s\n"
 	    "  /ImageMatrix [1 0 0 -1 0 %d]\n  /Decode [%s]\n>>\n"
 	    "1 %s\n",
-	    width, height, bpc, height, decode, displayOperation);
+	    width, height, bpc,
+	    psInfoPtr->imageA85
+		? "/ASCII85Decode filter\n  /RunLengthDecode filter"
+		: "/ASCIIHexDecode filter",
+	    height, decode, displayOperation);
 
     /*
      * Check the PhotoImageBlock information. We assume that:
@@ -1597,7 +1868,8 @@ Tk_PostscriptPhoto(
 	alphaOffset = blockPtr->offset[3];
     }
 
-    for (yy = 0, lineLen=0; yy < height; yy++) {
+    StreamInit(&stream, psObj, psInfoPtr->imageA85);
+    for (yy = 0; yy < height; yy++) {
 	switch (colorLevel) {
 	case 0: {
 	    /*
@@ -1631,18 +1903,13 @@ Tk_PostscriptPhoto(
 		}
 		mask >>= 1;
 		if (mask == 0) {
-		    Tcl_AppendPrintfToObj(psObj, "%02X", data);
-		    lineLen += 2;
-		    if (lineLen >= 60) {
-			lineLen = 0;
-			Tcl_AppendToObj(psObj, "\n", -1);
-		    }
+		    StreamPutByte(&stream, data);
 		    mask = 0x80;
 		    data = 0x00;
 		}
 	    }
 	    if ((width % 8) != 0) {
-		Tcl_AppendPrintfToObj(psObj, "%02X", data);
+		StreamPutByte(&stream, data);
 		mask = 0x80;
 		data = 0x00;
 	    }
@@ -1670,18 +1937,13 @@ Tk_PostscriptPhoto(
 		}
 		mask >>= 1;
 		if (mask == 0) {
-		    Tcl_AppendPrintfToObj(psObj, "%02X", data);
-		    lineLen += 2;
-		    if (lineLen >= 60) {
-			lineLen = 0;
-			Tcl_AppendToObj(psObj, "\n", -1);
-		    }
+		    StreamPutByte(&stream, data);
 		    mask = 0x80;
 		    data = 0x00;
 		}
 	    }
 	    if ((width % 8) != 0) {
-		Tcl_AppendPrintfToObj(psObj, "%02X", data);
+		StreamPutByte(&stream, data);
 		mask = 0x80;
 		data = 0x00;
 	    }
@@ -1696,12 +1958,7 @@ Tk_PostscriptPhoto(
 	    for (xx = 0; xx < width; xx ++) {
 		alpha = *(alphaPtr + (yy * alphaPitch)
 			+ (xx * alphaIncr) + alphaOffset);
-		Tcl_AppendPrintfToObj(psObj, "%02X", alpha | 0x01);
-		lineLen += 2;
-		if (lineLen >= 60) {
-		    lineLen = 0;
-		    Tcl_AppendToObj(psObj, "\n", -1);
-		}
+		StreamPutByte(&stream, alpha | 0x01);
 	    }
 
 	    /*
@@ -1717,13 +1974,8 @@ Tk_PostscriptPhoto(
 		green = pixelPtr[blockPtr->offset[1]];
 		blue = pixelPtr[blockPtr->offset[2]];
 
-		Tcl_AppendPrintfToObj(psObj, "%02X", (int) floor(0.5 +
+		StreamPutByte(&stream, (unsigned int) floor(0.5 +
 			( 0.3086 * red + 0.6094 * green + 0.0820 * blue)));
-		lineLen += 2;
-		if (lineLen >= 60) {
-		    lineLen = 0;
-		    Tcl_AppendToObj(psObj, "\n", -1);
-		}
 	    }
 	    break;
 	}
@@ -1736,12 +1988,7 @@ Tk_PostscriptPhoto(
 	    for (xx = 0; xx < width; xx ++) {
 		alpha = *(alphaPtr + (yy * alphaPitch)
 			+ (xx * alphaIncr) + alphaOffset);
-		Tcl_AppendPrintfToObj(psObj, "%02X", alpha | 0x01);
-		lineLen += 2;
-		if (lineLen >= 60) {
-		    lineLen = 0;
-		    Tcl_AppendToObj(psObj, "\n", -1);
-		}
+		StreamPutByte(&stream, alpha | 0x01);
 	    }
 
 	    /*
@@ -1753,15 +2000,9 @@ Tk_PostscriptPhoto(
 		pixelPtr = blockPtr->pixelPtr + (yy * blockPtr->pitch)
 			+ (xx * blockPtr->pixelSize);
 
-		Tcl_AppendPrintfToObj(psObj, "%02X%02X%02X",
-			pixelPtr[blockPtr->offset[0]],
-			pixelPtr[blockPtr->offset[1]],
-			pixelPtr[blockPtr->offset[2]]);
-		lineLen += 6;
-		if (lineLen >= 60) {
-		    lineLen = 0;
-		    Tcl_AppendToObj(psObj, "\n", -1);
-		}
+		StreamPutByte(&stream, pixelPtr[blockPtr->offset[0]]);
+		StreamPutByte(&stream, pixelPtr[blockPtr->offset[1]]);
+		StreamPutByte(&stream, pixelPtr[blockPtr->offset[2]]);
 	    }
 	    break;
 	}
@@ -1771,7 +2012,7 @@ Tk_PostscriptPhoto(
      * The end-of-data marker.
      */
 
-    Tcl_AppendToObj(psObj, ">\n", -1);
+    StreamEnd(&stream);
     return TCL_OK;
 }
 
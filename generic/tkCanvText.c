@@ -64,7 +64,15 @@ typedef struct TextItem {
 
     TkSizeT numChars;		/* Length of text in characters. */
     TkSizeT numBytes;		/* Length of text in bytes. */
-    Tk_TextLayout textLayout;	/* Cached text layout information. */
+    Tk_TextLayout textLayout;	/* Cached text layout information. The layout
+				 * depends only on the text, font, wrap width
+				 * and justification, not on the item's
+				 * position, so it is recomputed by
+				 * RecomputeTextLayout when one of those
+				 * inputs changes and merely repositioned by
+				 * ComputeTextBbox when the item moves. */
+    int layoutWidth;		/* Width of textLayout, in pixels. */
+    int layoutHeight;		/* Height of textLayout, in pixels. */
     int actualWidth;		/* Width of text as computed. Used to make
 				 * selections of wrapped text display
 				 * right. */
@@ -135,6 +143,7 @@ static const Tk_ConfigSpec configSpecs[] = {
  */
 
 static void		ComputeTextBbox(Tk_Canvas canvas, TextItem *textPtr);
+static void		RecomputeTextLayout(TextItem *textPtr);
 static int		ConfigureText(Tcl_Interp *interp,
 			    Tk_Canvas canvas, Tk_Item *itemPtr, int argc,
 			    Tcl_Obj *const objv[], int flags);
@@ -270,6 +279,8 @@ CreateText(
     textPtr->numChars	= 0;
     textPtr->numBytes	= 0;
     textPtr->textLayout = NULL;
+    textPtr->layoutWidth = 0;
+    textPtr->layoutHeight = 0;
     textPtr->actualWidth = 0;
     textPtr->drawOrigin[0] = textPtr->drawOrigin[1] = 0.0;
     textPtr->gc		= NULL;
@@ -542,6 +553,7 @@ ConfigureText(
     textPtr->sine = sin(textPtr->angle * PI/180.0);
     textPtr->cosine = cos(textPtr->angle * PI/180.0);
 
+    RecomputeTextLayout(textPtr);
     ComputeTextBbox(canvas, textPtr);
     return TCL_OK;
 }
@@ -607,6 +619,38 @@ DeleteText(
     }
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * RecomputeTextLayout --
+ *
+ *	This function recomputes the cached text layout of a text item. It
+ *	must be called whenever the text, font, wrap width or justification
+ *	of the item changes; operations that only move the item (coords,
+ *	move, scale, rotate) keep the existing layout and just reposition it
+ *	via ComputeTextBbox, so dragging an item does not re-shape its text.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The textLayout, layoutWidth and layoutHeight fields of textPtr are
+ *	updated; the old layout is freed.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+RecomputeTextLayout(
+    TextItem *textPtr)		/* Item whose layout is to be recomputed. */
+{
+    Tk_FreeTextLayout(textPtr->textLayout);
+    textPtr->textLayout = Tk_ComputeTextLayout(textPtr->tkfont,
+	    textPtr->text, textPtr->numChars, textPtr->width,
+	    textPtr->justify, 0, &textPtr->layoutWidth,
+	    &textPtr->layoutHeight);
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -641,10 +685,8 @@ ComputeTextBbox(
 	state = Canvas(canvas)->canvas_state;
     }
 
-    Tk_FreeTextLayout(textPtr->textLayout);
-    textPtr->textLayout = Tk_ComputeTextLayout(textPtr->tkfont,
-	    textPtr->text, textPtr->numChars, textPtr->width,
-	    textPtr->justify, 0, &width, &height);
+    width = textPtr->layoutWidth;
+    height = textPtr->layoutHeight;
 
     if (state == TK_STATE_HIDDEN || textPtr->color == NULL) {
 	width = height = 0;
@@ -1067,6 +1109,7 @@ TextInsert(
     if (textPtr->insertPos + 1 >= index + 1) {
 	textPtr->insertPos += charsAdded;
     }
+    RecomputeTextLayout(textPtr);
     ComputeTextBbox(canvas, textPtr);
 }
 
@@ -1161,6 +1204,7 @@ TextDeleteChars(
 	    textPtr->insertPos = first;
 	}
     }
+    RecomputeTextLayout(textPtr);
     ComputeTextBbox(canvas, textPtr);
     return;
 }
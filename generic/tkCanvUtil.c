@@ -24,6 +24,27 @@ typedef struct SmoothAssocData {
 				 * option. */
 } SmoothAssocData;
 
+/*
+ * The following structure holds the per-thread rectangle batch used by
+ * TkCanvasBatchFillRect and friends; see the comments on those functions at
+ * the end of this file.
+ */
+
+#define TK_CANVAS_BATCH_SIZE 256
+
+typedef struct ThreadSpecificData {
+    Display *display;		/* Display the queued rectangles target. */
+    Drawable drawable;		/* Drawable the queued rectangles target. */
+    GC gc;			/* Graphics context shared by the batch. */
+    int fill;			/* Non-zero if the batch holds filled
+				 * rectangles, zero if it holds outlines. */
+    const void *owner;		/* Item type that queued the rectangles. */
+    int numRects;		/* Number of valid entries in rects. */
+    XRectangle rects[TK_CANVAS_BATCH_SIZE];
+				/* The queued rectangles. */
+} ThreadSpecificData;
+static Tcl_ThreadDataKey dataKey;
+
 const Tk_SmoothMethod tkBezierSmoothMethod = {
     "true",
     TkMakeBezierCurve,
@@ -42,6 +63,9 @@ static const Tk_SmoothMethod tkRawSmoothMethod = {
  * Function forward-declarations.
  */
 
+static void		BatchAppend(Display *display, Drawable drawable,
+			    GC gc, const void *owner, int fill, int x, int y,
+			    unsigned int width, unsigned int height);
 static void		SmoothMethodCleanupProc(ClientData clientData,
 			    Tcl_Interp *interp);
 static SmoothAssocData *InitSmoothMethods(Tcl_Interp *interp);
@@ -1243,20 +1267,34 @@ Tk_ChangeOutlineGC(
 
     if ((dash->number<-1) ||
 	    ((dash->number == -1) && (dash->pattern.array[0] != ','))) {
+	char staticList[2*sizeof(char *)];
 	char *q;
 	int i = -dash->number;
 
 	p = (i > (int)sizeof(char *)) ? dash->pattern.pt : dash->pattern.array;
-	q = (char *)ckalloc(2 * i);
+	q = (2 * i <= (int)sizeof(staticList)) ? staticList
+		: (char *)ckalloc(2 * i);
 	i = DashConvert(q, p, i, width);
-	XSetDashes(Canvas(canvas)->display, outline->gc, outline->offset, q,i);
-	ckfree(q);
+	TkGCSetDashes(Canvas(canvas)->display, outline->gc, outline->offset,
+		q, i);
+	if (q != staticList) {
+	    ckfree(q);
+	}
     } else if (dash->number>2 || (dash->number==2 &&
 	    (dash->pattern.array[0]!=dash->pattern.array[1]))) {
 	p = (dash->number > (int) sizeof(char *))
 		? dash->pattern.pt : dash->pattern.array;
-	XSetDashes(Canvas(canvas)->display, outline->gc, outline->offset, p,
-		dash->number);
+	TkGCSetDashes(Canvas(canvas)->display, outline->gc, outline->offset,
+		p, dash->number);
+    } else if (dash->number != 0) {
+	/*
+	 * This item's pattern is fully described by the single-element dash
+	 * list the GC was created with; if an item sharing the GC left a
+	 * longer list behind (see Tk_ResetOutlineGC), put the original one
+	 * back.
+	 */
+
+	TkGCRestoreDashes(Canvas(canvas)->display, outline->gc);
     }
     if (stipple!=None) {
 	int w = 0; int h = 0;
@@ -1294,7 +1332,11 @@ Tk_ChangeOutlineGC(
  *
  *	Restores the GC to the situation before Tk_ChangeOutlineGC() was
  *	called. This function should be called just after the dashed item is
- *	drawn, because the GC is supposed to be read-only.
+ *	drawn, because the GC is supposed to be read-only. The dash list is
+ *	deliberately left in place: tkGC.c records it against the GC and puts
+ *	the creation-time list back only when some other holder of the GC
+ *	needs it, so that consecutive items drawn with the same pattern do
+ *	not ping-pong the server's dash state.
  *
  * Results:
  *	1 if there is a stipple pattern, and 0 otherwise.
@@ -1311,30 +1353,16 @@ Tk_ResetOutlineGC(
     Tk_Item *item,
     Tk_Outline *outline)
 {
-    char dashList;
-    double width;
-    Tk_Dash *dash;
     XColor *color;
     Pixmap stipple;
     Tk_State state = item->state;
 
-    width = outline->width;
-    if (width < 1.0) {
-	width = 1.0;
-    }
-    dash = &(outline->dash);
     color = outline->color;
     stipple = outline->stipple;
     if (state == TK_STATE_NULL) {
 	state = Canvas(canvas)->canvas_state;
     }
     if (Canvas(canvas)->currentItemPtr == item) {
-	if (outline->activeWidth>width) {
-	    width = outline->activeWidth;
-	}
-	if (outline->activeDash.number != 0) {
-	    dash = &(outline->activeDash);
-	}
 	if (outline->activeColor!=NULL) {
 	    color = outline->activeColor;
 	}
@@ -1342,12 +1370,6 @@ Tk_ResetOutlineGC(
 	    stipple = outline->activeStipple;
 	}
     } else if (state == TK_STATE_DISABLED) {
-	if (outline->disabledWidth>width) {
-	    width = outline->disabledWidth;
-	}
-	if (outline->disabledDash.number != 0) {
-	    dash = &(outline->disabledDash);
-	}
 	if (outline->disabledColor!=NULL) {
 	    color = outline->disabledColor;
 	}
@@ -1359,19 +1381,6 @@ Tk_ResetOutlineGC(
 	return 0;
     }
 
-    if ((dash->number > 2) || (dash->number < -1) || (dash->number==2 &&
-	    (dash->pattern.array[0] != dash->pattern.array[1])) ||
-	    ((dash->number == -1) && (dash->pattern.array[0] != ','))) {
-	if ((unsigned int)ABS(dash->number) > sizeof(char *)) {
-	    dashList = dash->pattern.pt[0];
-	} else if (dash->number != 0) {
-	    dashList = dash->pattern.array[0];
-	} else {
-	    dashList = (char) (4 * width + 0.5);
-	}
-	XSetDashes(Canvas(canvas)->display, outline->gc, outline->offset,
-		&dashList , 1);
-    }
     if (stipple != None) {
 	XSetTSOrigin(Canvas(canvas)->display, outline->gc, 0, 0);
 	return 1;
@@ -1914,6 +1923,164 @@ TkRotatePoint(
     *yPtr = originY - x * sine + y * cosine;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkCanvasBatchFillRect, TkCanvasBatchDrawRect --
+ *
+ *	Queue one filled or outlined rectangle for later submission as part
+ *	of a batched XFillRectangles/XDrawRectangles call. Canvas item
+ *	display procedures use these instead of XFillRectangle/XDrawRectangle
+ *	so that runs of items drawn with the same GC (dense scatter plots,
+ *	bar charts and the like) reach the server as a handful of requests
+ *	instead of one per item.
+ *
+ *	The pending rectangles are flushed whenever the target drawable, GC,
+ *	primitive kind or owning item type changes, when the buffer fills
+ *	up, and at the latest when the canvas finishes a redraw pass. All
+ *	rectangles in one batch share a single GC, so reordering within the
+ *	batch cannot change the rendered result; the flush-on-change rule
+ *	keeps everything else in submission order.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May issue the queued rectangles to the display.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+BatchAppend(
+    Display *display,		/* Display to draw on. */
+    Drawable drawable,		/* Pixmap or window to draw into. */
+    GC gc,			/* Graphics context for the rectangle. */
+    const void *owner,		/* Item type queueing the rectangle; used by
+				 * TkCanvasBatchBoundary to flush when
+				 * another item type starts drawing. */
+    int fill,			/* Non-zero for XFillRectangles, zero for
+				 * XDrawRectangles. */
+    int x, int y,
+    unsigned int width, unsigned int height)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    XRectangle *rectPtr;
+
+    if ((tsdPtr->numRects > 0)
+	    && ((tsdPtr->display != display) || (tsdPtr->drawable != drawable)
+	    || (tsdPtr->gc != gc) || (tsdPtr->fill != fill)
+	    || (tsdPtr->owner != owner)
+	    || (tsdPtr->numRects >= TK_CANVAS_BATCH_SIZE))) {
+	TkCanvasBatchFlush();
+    }
+    tsdPtr->display = display;
+    tsdPtr->drawable = drawable;
+    tsdPtr->gc = gc;
+    tsdPtr->fill = fill;
+    tsdPtr->owner = owner;
+    rectPtr = &tsdPtr->rects[tsdPtr->numRects++];
+    rectPtr->x = (short) x;
+    rectPtr->y = (short) y;
+    rectPtr->width = (unsigned short) width;
+    rectPtr->height = (unsigned short) height;
+}
+
+void
+TkCanvasBatchFillRect(
+    Display *display,
+    Drawable drawable,
+    GC gc,
+    const void *owner,
+    int x, int y,
+    unsigned int width, unsigned int height)
+{
+    BatchAppend(display, drawable, gc, owner, 1, x, y, width, height);
+}
+
+void
+TkCanvasBatchDrawRect(
+    Display *display,
+    Drawable drawable,
+    GC gc,
+    const void *owner,
+    int x, int y,
+    unsigned int width, unsigned int height)
+{
+    BatchAppend(display, drawable, gc, owner, 0, x, y, width, height);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkCanvasBatchBoundary --
+ *
+ *	Called by the canvas widget before handing control to an item's
+ *	display procedure. If rectangles queued by a different item type are
+ *	still pending, they are flushed first, so that items which draw
+ *	directly (text, images, ...) cannot be overpainted out of order by a
+ *	deferred batch.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May issue the queued rectangles to the display.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkCanvasBatchBoundary(
+    const void *owner)		/* Item type about to draw. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if ((tsdPtr->numRects > 0) && (tsdPtr->owner != owner)) {
+	TkCanvasBatchFlush();
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkCanvasBatchFlush --
+ *
+ *	Submit any queued rectangles to the display in a single
+ *	XFillRectangles or XDrawRectangles call. The canvas widget calls
+ *	this at the end of every redraw pass; item display procedures call
+ *	it before issuing a primitive that must not be reordered with
+ *	already queued rectangles.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Draws on whatever drawable the queued rectangles targeted.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkCanvasBatchFlush(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (tsdPtr->numRects > 0) {
+	if (tsdPtr->fill) {
+	    XFillRectangles(tsdPtr->display, tsdPtr->drawable, tsdPtr->gc,
+		    tsdPtr->rects, tsdPtr->numRects);
+	} else {
+	    XDrawRectangles(tsdPtr->display, tsdPtr->drawable, tsdPtr->gc,
+		    tsdPtr->rects, tsdPtr->numRects);
+	}
+	tsdPtr->numRects = 0;
+    }
+}
+
 /*
  * Local Variables:
  * mode: c
@@ -31,8 +31,32 @@ typedef struct WindowItem  {
     Tk_Anchor anchor;		/* Where to anchor window relative to
 				 * (x,y). */
     Tk_Canvas canvas;		/* Canvas containing this item. */
+    int geomState;		/* One of the WIN_ITEM_GEOM_* values below;
+				 * records what DisplayWinItem last asked of
+				 * the geometry machinery so that redisplay
+				 * passes that leave the window where it is
+				 * can be skipped. */
+    short geomX, geomY;		/* Position last passed to
+				 * Tk_MaintainGeometry. */
+    int geomWidth, geomHeight;	/* Dimensions last passed to
+				 * Tk_MaintainGeometry. */
 } WindowItem;
 
+/*
+ * Values for geomState. Window items are redisplayed on every pass over the
+ * canvas (they are never obscured by the pixmap copy), so most calls to
+ * DisplayWinItem find the window already exactly where it belongs; the state
+ * recorded here lets those calls return without touching the geometry
+ * management structures. The state reverts to UNKNOWN whenever the item is
+ * reconfigured or loses its window, which forces the next pass to reposition
+ * from scratch.
+ */
+
+#define WIN_ITEM_GEOM_UNKNOWN	0	/* Must reposition and remap. */
+#define WIN_ITEM_GEOM_PLACED	1	/* Window placed at geomX/geomY with
+					 * size geomWidth x geomHeight. */
+#define WIN_ITEM_GEOM_WITHDRAWN	2	/* Window unmapped or unmaintained. */
+
 /*
  * Information used for parsing configuration specs:
  */
@@ -191,6 +215,7 @@ CreateWinItem(
     winItemPtr->height = 0;
     winItemPtr->anchor = TK_ANCHOR_CENTER;
     winItemPtr->canvas = canvas;
+    winItemPtr->geomState = WIN_ITEM_GEOM_UNKNOWN;
 
     /*
      * Process the arguments to fill in the item record. Only 1 (list) or 2 (x
@@ -371,6 +396,7 @@ ConfigureWinItem(
 	}
     }
 
+    winItemPtr->geomState = WIN_ITEM_GEOM_UNKNOWN;
     ComputeWindowBbox(canvas, winItemPtr);
     return TCL_OK;
 
@@ -589,10 +615,13 @@ DisplayWinItem(
      * to indicate that we should no longer display ourselves.
      */
     if (state == TK_STATE_HIDDEN || drawable == None) {
-	if (canvasTkwin == Tk_Parent(winItemPtr->tkwin)) {
-	    Tk_UnmapWindow(winItemPtr->tkwin);
-	} else {
-	    Tk_UnmaintainGeometry(winItemPtr->tkwin, canvasTkwin);
+	if (winItemPtr->geomState != WIN_ITEM_GEOM_WITHDRAWN) {
+	    winItemPtr->geomState = WIN_ITEM_GEOM_WITHDRAWN;
+	    if (canvasTkwin == Tk_Parent(winItemPtr->tkwin)) {
+		Tk_UnmapWindow(winItemPtr->tkwin);
+	    } else {
+		Tk_UnmaintainGeometry(winItemPtr->tkwin, canvasTkwin);
+	    }
 	}
 	return;
     }
@@ -610,10 +639,13 @@ DisplayWinItem(
 
     if (((x + width) <= 0) || ((y + height) <= 0)
 	    || (x >= Tk_Width(canvasTkwin)) || (y >= Tk_Height(canvasTkwin))) {
-	if (canvasTkwin == Tk_Parent(winItemPtr->tkwin)) {
-	    Tk_UnmapWindow(winItemPtr->tkwin);
-	} else {
-	    Tk_UnmaintainGeometry(winItemPtr->tkwin, canvasTkwin);
+	if (winItemPtr->geomState != WIN_ITEM_GEOM_WITHDRAWN) {
+	    winItemPtr->geomState = WIN_ITEM_GEOM_WITHDRAWN;
+	    if (canvasTkwin == Tk_Parent(winItemPtr->tkwin)) {
+		Tk_UnmapWindow(winItemPtr->tkwin);
+	    } else {
+		Tk_UnmaintainGeometry(winItemPtr->tkwin, canvasTkwin);
+	    }
 	}
 	return;
     }
@@ -624,6 +656,7 @@ DisplayWinItem(
      */
 
     if (canvasTkwin == Tk_Parent(winItemPtr->tkwin)) {
+	winItemPtr->geomState = WIN_ITEM_GEOM_PLACED;
 	if ((x != Tk_X(winItemPtr->tkwin)) || (y != Tk_Y(winItemPtr->tkwin))
 		|| (width != Tk_Width(winItemPtr->tkwin))
 		|| (height != Tk_Height(winItemPtr->tkwin))) {
@@ -631,6 +664,23 @@ DisplayWinItem(
 	}
 	Tk_MapWindow(winItemPtr->tkwin);
     } else {
+	if ((winItemPtr->geomState == WIN_ITEM_GEOM_PLACED)
+		&& (x == winItemPtr->geomX) && (y == winItemPtr->geomY)
+		&& (width == winItemPtr->geomWidth)
+		&& (height == winItemPtr->geomHeight)) {
+	    /*
+	     * Nothing moved since the last pass; the maintain machinery in
+	     * tkGeometry.c is still tracking the same placement and will
+	     * respond to ancestor events on its own.
+	     */
+
+	    return;
+	}
+	winItemPtr->geomState = WIN_ITEM_GEOM_PLACED;
+	winItemPtr->geomX = x;
+	winItemPtr->geomY = y;
+	winItemPtr->geomWidth = width;
+	winItemPtr->geomHeight = height;
 	Tk_MaintainGeometry(winItemPtr->tkwin, canvasTkwin, x, y,
 		width, height);
     }
@@ -1132,6 +1182,7 @@ WinItemLostContentProc(
 	Tk_UnmaintainGeometry(winItemPtr->tkwin, canvasTkwin);
     }
     Tk_UnmapWindow(winItemPtr->tkwin);
+    winItemPtr->geomState = WIN_ITEM_GEOM_UNKNOWN;
     winItemPtr->tkwin = NULL;
 }
 
@@ -60,6 +60,15 @@ typedef struct TagSearch {
     unsigned int rewritebufferAllocated;
 				/* Available space for rewrites. */
     TagSearchExpr *expr;	/* Compiled tag expression. */
+    Tk_Item **indexItems;	/* When not NULL, the membership array for a
+				 * single-tag search, taken from the canvas's
+				 * tag index. */
+    int indexCount;		/* Number of entries in indexItems. */
+    int indexPos;		/* Next entry of indexItems to return. */
+    unsigned long indexEpoch;	/* Value of the canvas's tagIndexEpoch when
+				 * indexItems was captured; a mismatch means
+				 * the array is stale and the search must
+				 * fall back to walking the item list. */
 } TagSearch;
 
 /*
@@ -72,6 +81,96 @@ typedef struct TagSearch {
 #define SEARCH_TYPE_TAG		3	/* Looking for an item by simple tag */
 #define SEARCH_TYPE_EXPR	4	/* Compound search */
 
+/*
+ * The structure below holds a spatial index over all of the items in a
+ * canvas. The index is a loose uniform grid: each item is bucketed by the
+ * center of its bounding box, and the largest item half-size is remembered so
+ * that queries can expand their search rectangle enough to pick up big items
+ * from neighboring buckets. The index is built lazily the first time an area
+ * query runs against an unmodified canvas and is discarded wholesale whenever
+ * any item is created, deleted, restacked, or changes its bounding box; this
+ * keeps the bookkeeping trivial while still letting repeated searches and
+ * redisplays of a mostly-static scene avoid scanning the full item list.
+ */
+
+typedef struct SpatialIndex {
+    int numItems;		/* Number of items in the canvas when the
+				 * index was built. */
+    int numCells;		/* rows*cols, or 0 if the canvas had too few
+				 * items to be worth indexing; in that case
+				 * callers must scan the item list. */
+    int rows, cols;		/* Dimensions of the grid. */
+    int gridX1, gridY1;		/* Canvas coordinates of the grid origin. */
+    int cellWidth, cellHeight;	/* Size of each grid cell; always >= 1. */
+    int slopX, slopY;		/* Largest half-width/half-height over all
+				 * items; queries must grow by this much to
+				 * catch items bucketed by their centers. */
+    int anyAlwaysRedraw;	/* Non-zero if any item's type has the
+				 * alwaysRedraw bit set. Such items must be
+				 * seen by every redisplay, so DisplayCanvas
+				 * can't use the index then. */
+    Tk_Item **items;		/* All items, in display list order. */
+    int *cellStart;		/* For each cell, index of its first entry in
+				 * cellItems; numCells+1 entries. */
+    int *cellItems;		/* Concatenated per-cell lists of indices
+				 * into items. */
+} SpatialIndex;
+
+/*
+ * Canvases with fewer items than this are never indexed; a scan of the item
+ * list is cheaper than building and consulting the grid.
+ */
+
+#define SPATIAL_INDEX_MIN_ITEMS 128
+
+/*
+ * Each value in a canvas's tagIndexTable is one of the structures below,
+ * recording which items carry one particular tag. The arrays are kept in
+ * display list order so single-tag searches served from the index return
+ * items in the same order as a walk of the item list would.
+ */
+
+typedef struct TagIndexEntry {
+    Tk_Item **items;		/* Items carrying the tag, in display list
+				 * order. */
+    int numItems;		/* Number of entries in use. */
+    int allocated;		/* Number of entries allocated. */
+} TagIndexEntry;
+
+/*
+ * Canvases with fewer items than this never build the tag index; the linear
+ * tag scan is cheap enough there.
+ */
+
+#define TAG_INDEX_MIN_ITEMS 128
+
+/*
+ * Each running "animate" operation is represented by one of the structures
+ * below, kept on a per-canvas list and stepped together from a single timer
+ * paced on the frame clock's interval. Items are remembered by id rather
+ * than by pointer: ids are never reused, so a deleted item simply ends its
+ * animation at the next tick instead of leaving a dangling reference.
+ */
+
+typedef struct TkCanvasTween {
+    int itemId;			/* Id of the item being animated. */
+    int nCoords;		/* Number of coordinates in each of the two
+				 * arrays below. */
+    double *startCoords;	/* Item coordinates when the animation
+				 * started (malloc'ed). */
+    double *endCoords;		/* Item coordinates when it completes
+				 * (malloc'ed). */
+    Tcl_WideInt startUsec;	/* Time the animation started, in
+				 * microseconds. */
+    int durationMs;		/* Total duration, in milliseconds. */
+    int easing;			/* One of the TWEEN_EASING_* values below. */
+    struct TkCanvasTween *nextPtr;
+				/* Next animation on this canvas, or NULL. */
+} TkCanvasTween;
+
+#define TWEEN_EASING_LINEAR	0
+#define TWEEN_EASING_CUBIC	1
+
 /*
  * Custom option for handling "-state" and "-offset"
  */
@@ -130,6 +229,10 @@ static const Tk_ConfigSpec configSpecs[] = {
 	DEF_CANVAS_INSERT_ON_TIME, offsetof(TkCanvas, insertOnTime), 0, NULL},
     {TK_CONFIG_PIXELS, "-insertwidth", "insertWidth", "InsertWidth",
 	DEF_CANVAS_INSERT_WIDTH, offsetof(TkCanvas, textInfo.insertWidth), 0, NULL},
+    {TK_CONFIG_COLOR, "-lodcolor", "lodColor", "Foreground",
+	DEF_CANVAS_LOD_COLOR, offsetof(TkCanvas, lodColor), 0, NULL},
+    {TK_CONFIG_PIXELS, "-lodthreshold", "lodThreshold", "LodThreshold",
+	DEF_CANVAS_LOD_THRESHOLD, offsetof(TkCanvas, lodThreshold), 0, NULL},
     {TK_CONFIG_CUSTOM, "-offset", "offset", "Offset", "0,0",
 	offsetof(TkCanvas, tsoffset),TK_CONFIG_DONT_SET_DEFAULT,
 	&offsetOption},
@@ -159,6 +262,8 @@ static const Tk_ConfigSpec configSpecs[] = {
     {TK_CONFIG_CUSTOM, "-state", "state", "State",
 	"normal", offsetof(TkCanvas, canvas_state), TK_CONFIG_DONT_SET_DEFAULT,
 	&stateOption},
+    {TK_CONFIG_BOOLEAN, "-staticlayer", "staticLayer", "StaticLayer",
+	"0", offsetof(TkCanvas, staticLayer), 0, NULL},
     {TK_CONFIG_STRING, "-takefocus", "takeFocus", "TakeFocus",
 	DEF_CANVAS_TAKE_FOCUS, offsetof(TkCanvas, takeFocus),
 	TK_CONFIG_NULL_OK, NULL},
@@ -233,6 +338,11 @@ static void		CanvasSelectTo(TkCanvas *canvasPtr,
 			    Tk_Item *itemPtr, TkSizeT index);
 static void		CanvasSetOrigin(TkCanvas *canvasPtr,
 			    int xOrigin, int yOrigin);
+static void		CanvasTweenApply(TkCanvas *canvasPtr,
+			    Tk_Item *itemPtr, TkCanvasTween *tweenPtr,
+			    double u);
+static void		CanvasTweenFree(TkCanvasTween *tweenPtr);
+static void		CanvasTweenTick(ClientData clientData);
 static void		CanvasUpdateScrollbars(TkCanvas *canvasPtr);
 static int		CanvasWidgetCmd(ClientData clientData,
 			    Tcl_Interp *interp, int argc,
@@ -247,7 +357,12 @@ static void		DefaultRotateImplementation(TkCanvas *canvasPtr,
 static void		DestroyCanvas(void *memPtr);
 static int		DrawCanvas(Tcl_Interp *interp, ClientData clientData, Tk_PhotoHandle photohandle, int subsample, int zoom);
 static void		DisplayCanvas(ClientData clientData);
-static void		DoItem(Tcl_Obj *accumObj,
+static long		DisplayRegion(TkCanvas *canvasPtr, int dirtyX1,
+			    int dirtyY1, int dirtyX2, int dirtyY2,
+			    int useStatic);
+static void		AddDirtyRect(TkCanvas *canvasPtr, int x1, int y1,
+			    int x2, int y2);
+static void		DoItem(TkCanvas *canvasPtr, Tcl_Obj *accumObj,
 			    Tk_Item *itemPtr, Tk_Uid tag);
 static void		EventuallyRedrawItem(TkCanvas *canvasPtr,
 			    Tk_Item *itemPtr);
@@ -263,6 +378,21 @@ static void		InitCanvas(void);
 static void		PickCurrentItem(TkCanvas *canvasPtr, XEvent *eventPtr);
 static Tcl_Obj *	ScrollFractions(int screen1,
 			    int screen2, int object1, int object2);
+static SpatialIndex *	SpatialIndexGet(TkCanvas *canvasPtr);
+static void		SnapshotPutDouble(Tcl_DString *dsPtr, double value);
+static void		SnapshotPutString(Tcl_DString *dsPtr,
+			    const char *string);
+static void		SnapshotPutUint32(Tcl_DString *dsPtr,
+			    unsigned int value);
+static void		SpatialIndexInvalidate(TkCanvas *canvasPtr);
+static int		SpatialIndexQuery(SpatialIndex *indexPtr, int x1,
+			    int y1, int x2, int y2, Tk_Item ***itemsOut);
+static TagIndexEntry *	TagIndexGet(TkCanvas *canvasPtr, Tk_Uid uid);
+static void		TagIndexInvalidate(TkCanvas *canvasPtr);
+static int		StaticLayerEnsure(TkCanvas *canvasPtr);
+static Tk_Item *	AllocItem(TkCanvas *canvasPtr, Tk_ItemType *typePtr);
+static void		FreeItem(TkCanvas *canvasPtr, Tk_Item *itemPtr);
+static void		DrainItemPools(TkCanvas *canvasPtr);
 static int		RelinkItems(TkCanvas *canvasPtr, Tcl_Obj *tag,
 			    Tk_Item *prevPtr, TagSearch **searchPtrPtr);
 static void 		TagSearchExprInit(TagSearchExpr **exprPtrPtr);
@@ -463,8 +593,142 @@ ItemDisplay(
     int screenX1, int screenY1,
     int width, int height)
 {
+    Tcl_Time perfStart;
+
+    /*
+     * Rectangles queued by another item type must reach the display before
+     * this item draws over them; see TkCanvasBatchBoundary in tkCanvUtil.c.
+     */
+
+    TkCanvasBatchBoundary(itemPtr->typePtr);
+    TK_PERF_TIMER_START(&perfStart);
     itemPtr->typePtr->displayProc((Tk_Canvas) canvasPtr, itemPtr,
 	    canvasPtr->display, pixmap, screenX1, screenY1, width, height);
+    TK_PERF_XRECORD(canvasPtr->tkwin, itemPtr->typePtr->name,
+	    (unsigned int) (itemPtr->x2 - itemPtr->x1)
+	    * (unsigned int) (itemPtr->y2 - itemPtr->y1) * 4, &perfStart);
+}
+
+/*
+ * Level-of-detail reduction: when the canvas is zoomed far out, items can
+ * shrink below the point where rendering them fully is distinguishable from
+ * a dot, yet their display procedures still pay full price. If the item's
+ * bounding box fits within -lodthreshold pixels in both dimensions, draw a
+ * single point at its center instead and report the item as handled.
+ */
+
+static inline int
+ItemDisplayLod(
+    TkCanvas *canvasPtr,
+    Tk_Item *itemPtr,
+    Drawable pixmap,
+    int screenX1, int screenY1)
+{
+    int thr = canvasPtr->lodThreshold;
+
+    if ((thr <= 0) || AlwaysRedraw(itemPtr)
+	    || (itemPtr->x2 - itemPtr->x1 >= thr)
+	    || (itemPtr->y2 - itemPtr->y1 >= thr)) {
+	return 0;
+    }
+
+    /*
+     * Respect the rectangle batching order: pending rectangles from other
+     * items must reach the drawable before this point goes on top.
+     */
+
+    TkCanvasBatchBoundary(NULL);
+    XDrawPoint(canvasPtr->display, pixmap, canvasPtr->lodGC,
+	    (itemPtr->x1 + itemPtr->x2)/2 - screenX1,
+	    (itemPtr->y1 + itemPtr->y2)/2 - screenY1);
+    return 1;
+}
+
+/*
+ * Batch dispatch for item types that provide a displayManyProc or a
+ * translateManyProc: consecutive items sharing such a type are collected
+ * into a small array and handed to the type in a single call, so that types
+ * with many cheap instances (e.g. plot points) pay one virtual call per run
+ * instead of one per item. Flushing whenever the type changes keeps the
+ * stacking order identical to per-item dispatch.
+ */
+
+#define ITEM_BATCH_SIZE 64
+
+typedef struct ItemBatch {
+    Tk_Item *items[ITEM_BATCH_SIZE];
+    int count;
+} ItemBatch;
+
+static void
+FlushDisplayBatch(
+    TkCanvas *canvasPtr,
+    ItemBatch *batchPtr,
+    Pixmap pixmap,
+    int screenX1, int screenY1,
+    int width, int height)
+{
+    Tk_ItemType *typePtr;
+    unsigned int area = 0;
+    Tcl_Time perfStart;
+    int i;
+
+    if (batchPtr->count == 0) {
+	return;
+    }
+    typePtr = batchPtr->items[0]->typePtr;
+    TkCanvasBatchBoundary(typePtr);
+    TK_PERF_TIMER_START(&perfStart);
+    typePtr->displayManyProc((Tk_Canvas) canvasPtr, batchPtr->items,
+	    batchPtr->count, canvasPtr->display, pixmap, screenX1, screenY1,
+	    width, height);
+    for (i = 0; i < batchPtr->count; i++) {
+	area += (unsigned int) (batchPtr->items[i]->x2
+		- batchPtr->items[i]->x1)
+		* (unsigned int) (batchPtr->items[i]->y2
+		- batchPtr->items[i]->y1);
+    }
+    TK_PERF_XRECORD(canvasPtr->tkwin, typePtr->name, area * 4, &perfStart);
+    batchPtr->count = 0;
+}
+
+static inline void
+ItemDisplayBatched(
+    TkCanvas *canvasPtr,
+    Tk_Item *itemPtr,
+    ItemBatch *batchPtr,
+    Pixmap pixmap,
+    int screenX1, int screenY1,
+    int width, int height)
+{
+    if (itemPtr->typePtr->displayManyProc == NULL) {
+	FlushDisplayBatch(canvasPtr, batchPtr, pixmap, screenX1, screenY1,
+		width, height);
+	ItemDisplay(canvasPtr, itemPtr, pixmap, screenX1, screenY1, width,
+		height);
+	return;
+    }
+    if ((batchPtr->count == ITEM_BATCH_SIZE) || ((batchPtr->count > 0)
+	    && (batchPtr->items[0]->typePtr != itemPtr->typePtr))) {
+	FlushDisplayBatch(canvasPtr, batchPtr, pixmap, screenX1, screenY1,
+		width, height);
+    }
+    batchPtr->items[batchPtr->count++] = itemPtr;
+}
+
+static inline int
+ItemIsStatic(
+    TkCanvas *canvasPtr,
+    Tk_Item *itemPtr)
+{
+    int i;
+
+    for (i = 0; i < (int)itemPtr->numTags; i++) {
+	if (itemPtr->tagPtr[i] == canvasPtr->staticUid) {
+	    return 1;
+	}
+    }
+    return 0;
 }
 
 static int
@@ -564,6 +828,52 @@ ItemTranslate(
 	    xDelta, yDelta);
 }
 
+static void
+FlushTranslateBatch(
+    TkCanvas *canvasPtr,
+    ItemBatch *batchPtr,
+    double xDelta,
+    double yDelta)
+{
+    int i;
+
+    if (batchPtr->count == 0) {
+	return;
+    }
+    batchPtr->items[0]->typePtr->translateManyProc((Tk_Canvas) canvasPtr,
+	    batchPtr->items, batchPtr->count, xDelta, yDelta);
+    for (i = 0; i < batchPtr->count; i++) {
+	EventuallyRedrawItem(canvasPtr, batchPtr->items[i]);
+    }
+    batchPtr->count = 0;
+}
+
+/*
+ * The caller is expected to have redrawn the item's old extent already; the
+ * redraw of the new extent happens here (immediately for per-item dispatch,
+ * at flush time for batched items).
+ */
+
+static inline void
+ItemTranslateBatched(
+    TkCanvas *canvasPtr,
+    Tk_Item *itemPtr,
+    ItemBatch *batchPtr,
+    double xDelta,
+    double yDelta)
+{
+    if (itemPtr->typePtr->translateManyProc == NULL) {
+	ItemTranslate(canvasPtr, itemPtr, xDelta, yDelta);
+	EventuallyRedrawItem(canvasPtr, itemPtr);
+	return;
+    }
+    if ((batchPtr->count == ITEM_BATCH_SIZE) || ((batchPtr->count > 0)
+	    && (batchPtr->items[0]->typePtr != itemPtr->typePtr))) {
+	FlushTranslateBatch(canvasPtr, batchPtr, xDelta, yDelta);
+    }
+    batchPtr->items[batchPtr->count++] = itemPtr;
+}
+
 static inline void
 ItemRotate(
     TkCanvas *canvasPtr,
@@ -659,165 +969,965 @@ DefaultRotateImplementation(
 
     Tcl_ResetResult(interp);
 }
-
+
+/*
+ * Current time in microseconds, on the same clock the frame clock in
+ * tkEvent.c uses for its deadlines.
+ */
+
+static inline Tcl_WideInt
+TweenNowUsec(void)
+{
+    Tcl_Time now;
+
+    Tcl_GetTime(&now);
+    return (Tcl_WideInt) now.sec * 1000000 + now.usec;
+}
+
 /*
  *--------------------------------------------------------------
  *
- * Tk_CanvasObjCmd --
+ * CanvasTweenApply --
  *
- *	This function is invoked to process the "canvas" Tcl command. See the
- *	user documentation for details on what it does.
+ *	Move an animated item to the position it should occupy at fraction u
+ *	(0.0 to 1.0) of its animation, easing included.
  *
  * Results:
- *	A standard Tcl result.
+ *	None.
  *
  * Side effects:
- *	See the user documentation.
+ *	The item's coordinates are rewritten and both its old and new extents
+ *	are marked for redisplay. The interpreter result is clobbered by the
+ *	coordinate write; the caller is expected to reset it.
  *
  *--------------------------------------------------------------
  */
 
-int
-Tk_CanvasObjCmd(
-    ClientData clientData,	/* Main window associated with interpreter. */
-    Tcl_Interp *interp,		/* Current interpreter. */
-    int argc,			/* Number of arguments. */
-    Tcl_Obj *const argv[])	/* Argument objects. */
+static void
+CanvasTweenApply(
+    TkCanvas *canvasPtr,	/* Canvas containing the item. */
+    Tk_Item *itemPtr,		/* Item being animated. */
+    TkCanvasTween *tweenPtr,	/* Animation state for the item. */
+    double u)			/* Fraction of the animation's duration that
+				 * has elapsed, clamped to [0,1]. */
 {
-    Tk_Window tkwin = (Tk_Window)clientData;
-    TkCanvas *canvasPtr;
-    Tk_Window newWin;
+    Tcl_Obj **objv;
+    int i;
 
-    if (typeList == NULL) {
-	InitCanvas();
-    }
+    if (tweenPtr->easing == TWEEN_EASING_CUBIC) {
+	if (u < 0.5) {
+	    u = 4.0 * u * u * u;
+	} else {
+	    double v = -2.0 * u + 2.0;
 
-    if (argc < 2) {
-	Tcl_WrongNumArgs(interp, 1, argv, "pathName ?-option value ...?");
-	return TCL_ERROR;
+	    u = 1.0 - v * v * v / 2.0;
+	}
     }
 
-    newWin = Tk_CreateWindowFromPath(interp,tkwin,Tcl_GetString(argv[1]),NULL);
-    if (newWin == NULL) {
-	return TCL_ERROR;
+    objv = (Tcl_Obj **) ckalloc(sizeof(Tcl_Obj *) * tweenPtr->nCoords);
+    for (i = 0; i < tweenPtr->nCoords; i++) {
+	objv[i] = Tcl_NewDoubleObj(tweenPtr->startCoords[i]
+		+ u * (tweenPtr->endCoords[i] - tweenPtr->startCoords[i]));
+	Tcl_IncrRefCount(objv[i]);
     }
-
-    /*
-     * Initialize fields that won't be initialized by ConfigureCanvas, or
-     * which ConfigureCanvas expects to have reasonable values (e.g. resource
-     * pointers).
-     */
-
-    canvasPtr = (TkCanvas *)ckalloc(sizeof(TkCanvas));
-    canvasPtr->tkwin = newWin;
-    canvasPtr->display = Tk_Display(newWin);
-    canvasPtr->interp = interp;
-    canvasPtr->widgetCmd = Tcl_CreateObjCommand(interp,
-	    Tk_PathName(canvasPtr->tkwin), CanvasWidgetCmd, canvasPtr,
-	    CanvasCmdDeletedProc);
-    canvasPtr->firstItemPtr = NULL;
-    canvasPtr->lastItemPtr = NULL;
-    canvasPtr->borderWidth = 0;
-    canvasPtr->bgBorder = NULL;
-    canvasPtr->relief = TK_RELIEF_FLAT;
-    canvasPtr->highlightWidth = 0;
-    canvasPtr->highlightBgColorPtr = NULL;
-    canvasPtr->highlightColorPtr = NULL;
-    canvasPtr->inset = 0;
-    canvasPtr->pixmapGC = NULL;
-    canvasPtr->width = None;
-    canvasPtr->height = None;
-    canvasPtr->confine = 0;
-    canvasPtr->textInfo.selBorder = NULL;
-    canvasPtr->textInfo.selBorderWidth = 0;
-    canvasPtr->textInfo.selFgColorPtr = NULL;
-    canvasPtr->textInfo.selItemPtr = NULL;
-    canvasPtr->textInfo.selectFirst = TCL_INDEX_NONE;
-    canvasPtr->textInfo.selectLast = TCL_INDEX_NONE;
-    canvasPtr->textInfo.anchorItemPtr = NULL;
-    canvasPtr->textInfo.selectAnchor = 0;
-    canvasPtr->textInfo.insertBorder = NULL;
-    canvasPtr->textInfo.insertWidth = 0;
-    canvasPtr->textInfo.insertBorderWidth = 0;
-    canvasPtr->textInfo.focusItemPtr = NULL;
-    canvasPtr->textInfo.gotFocus = 0;
-    canvasPtr->textInfo.cursorOn = 0;
-    canvasPtr->insertOnTime = 0;
-    canvasPtr->insertOffTime = 0;
-    canvasPtr->insertBlinkHandler = NULL;
-    canvasPtr->xOrigin = canvasPtr->yOrigin = 0;
-    canvasPtr->drawableXOrigin = canvasPtr->drawableYOrigin = 0;
-    canvasPtr->bindingTable = NULL;
-    canvasPtr->currentItemPtr = NULL;
-    canvasPtr->newCurrentPtr = NULL;
-    canvasPtr->closeEnough = 0.0;
-    canvasPtr->pickEvent.type = LeaveNotify;
-    canvasPtr->pickEvent.xcrossing.x = 0;
-    canvasPtr->pickEvent.xcrossing.y = 0;
-    canvasPtr->state = 0;
-    canvasPtr->xScrollCmd = NULL;
-    canvasPtr->yScrollCmd = NULL;
-    canvasPtr->scrollX1 = 0;
-    canvasPtr->scrollY1 = 0;
-    canvasPtr->scrollX2 = 0;
-    canvasPtr->scrollY2 = 0;
-    canvasPtr->regionString = NULL;
-    canvasPtr->xScrollIncrement = 0;
-    canvasPtr->yScrollIncrement = 0;
-    canvasPtr->scanX = 0;
-    canvasPtr->scanXOrigin = 0;
-    canvasPtr->scanY = 0;
-    canvasPtr->scanYOrigin = 0;
-    canvasPtr->hotPtr = NULL;
-    canvasPtr->hotPrevPtr = NULL;
-    canvasPtr->cursor = NULL;
-    canvasPtr->takeFocus = NULL;
-    canvasPtr->pixelsPerMM = WidthOfScreen(Tk_Screen(newWin));
-    canvasPtr->pixelsPerMM /= WidthMMOfScreen(Tk_Screen(newWin));
-    canvasPtr->flags = 0;
-    canvasPtr->nextId = 1;
-    canvasPtr->psInfo = NULL;
-    canvasPtr->canvas_state = TK_STATE_NORMAL;
-    canvasPtr->tsoffset.flags = 0;
-    canvasPtr->tsoffset.xoffset = 0;
-    canvasPtr->tsoffset.yoffset = 0;
-    canvasPtr->bindTagExprs = NULL;
-    Tcl_InitHashTable(&canvasPtr->idTable, TCL_ONE_WORD_KEYS);
-
-    Tk_SetClass(canvasPtr->tkwin, "Canvas");
-    Tk_SetClassProcs(canvasPtr->tkwin, &canvasClass, canvasPtr);
-    Tk_CreateEventHandler(canvasPtr->tkwin,
-	    ExposureMask|StructureNotifyMask|FocusChangeMask,
-	    CanvasEventProc, canvasPtr);
-    Tk_CreateEventHandler(canvasPtr->tkwin, KeyPressMask|KeyReleaseMask
-	    |ButtonPressMask|ButtonReleaseMask|EnterWindowMask
-	    |LeaveWindowMask|PointerMotionMask|VirtualEventMask,
-	    CanvasBindProc, canvasPtr);
-    Tk_CreateSelHandler(canvasPtr->tkwin, XA_PRIMARY, XA_STRING,
-	    CanvasFetchSelection, canvasPtr, XA_STRING);
-    if (ConfigureCanvas(interp, canvasPtr, argc-2, argv+2, 0) != TCL_OK) {
-	goto error;
+    EventuallyRedrawItem(canvasPtr, itemPtr);
+    ItemCoords(canvasPtr, itemPtr, tweenPtr->nCoords, objv);
+    EventuallyRedrawItem(canvasPtr, itemPtr);
+    for (i = 0; i < tweenPtr->nCoords; i++) {
+	Tcl_DecrRefCount(objv[i]);
     }
-
-    Tcl_SetObjResult(interp, Tk_NewWindowObj(canvasPtr->tkwin));
-    return TCL_OK;
-
-  error:
-    Tk_DestroyWindow(canvasPtr->tkwin);
-    return TCL_ERROR;
+    ckfree((char *) objv);
 }
-
+
 /*
  *--------------------------------------------------------------
  *
- * CanvasWidgetCmd --
+ * CanvasTweenFree --
  *
- *	This function is invoked to process the Tcl command that corresponds
- *	to a widget managed by this module. See the user documentation for
- *	details on what it does.
+ *	Release the storage of one animation record. The record must already
+ *	have been unlinked from its canvas's list.
  *
- * Results:
- *	A standard Tcl result.
+ *--------------------------------------------------------------
+ */
+
+static void
+CanvasTweenFree(
+    TkCanvasTween *tweenPtr)	/* Animation record to free. */
+{
+    ckfree((char *) tweenPtr->startCoords);
+    ckfree((char *) tweenPtr->endCoords);
+    ckfree((char *) tweenPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * CanvasTweenTick --
+ *
+ *	Timer handler that advances every running animation of a canvas by
+ *	one frame. All items are moved in the same invocation, so their
+ *	damage accumulates into the canvas's dirty regions and is repaired by
+ *	a single redisplay pass no matter how many animations are running.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Animated items are moved and their extents marked for redisplay.
+ *	Completed animations, and animations whose item has been deleted,
+ *	are discarded. If any animation remains the timer is rescheduled for
+ *	the next frame deadline, skipping whole frames when the event loop
+ *	has fallen behind rather than letting late ticks pile up.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+CanvasTweenTick(
+    ClientData clientData)	/* Information about canvas widget. */
+{
+    TkCanvas *canvasPtr = (TkCanvas *)clientData;
+    TkCanvasTween *tweenPtr, **prevPtrPtr;
+    Tcl_WideInt nowUsec = TweenNowUsec();
+
+    canvasPtr->tweenTimer = NULL;
+
+    prevPtrPtr = &canvasPtr->tweenPtr;
+    while ((tweenPtr = *prevPtrPtr) != NULL) {
+	Tk_Item *itemPtr = NULL;
+	Tcl_HashEntry *hPtr = Tcl_FindHashEntry(&canvasPtr->idTable,
+		INT2PTR(tweenPtr->itemId));
+	double u = 1.0;
+
+	if (hPtr != NULL) {
+	    itemPtr = (Tk_Item *) Tcl_GetHashValue(hPtr);
+	}
+	if (itemPtr == NULL) {
+	    *prevPtrPtr = tweenPtr->nextPtr;
+	    CanvasTweenFree(tweenPtr);
+	    continue;
+	}
+	if (tweenPtr->durationMs > 0) {
+	    u = (double) (nowUsec - tweenPtr->startUsec)
+		    / (1000.0 * tweenPtr->durationMs);
+	}
+	if (u >= 1.0) {
+	    u = 1.0;
+	} else if (u < 0.0) {
+	    u = 0.0;
+	}
+	CanvasTweenApply(canvasPtr, itemPtr, tweenPtr, u);
+	if (u >= 1.0) {
+	    *prevPtrPtr = tweenPtr->nextPtr;
+	    CanvasTweenFree(tweenPtr);
+	} else {
+	    prevPtrPtr = &tweenPtr->nextPtr;
+	}
+    }
+    Tcl_ResetResult(canvasPtr->interp);
+
+    if (canvasPtr->tweenPtr != NULL) {
+	Tcl_WideInt interval = TkFrameClockIntervalUsec();
+
+	canvasPtr->tweenDue += interval;
+	if (canvasPtr->tweenDue <= nowUsec) {
+	    canvasPtr->tweenDue += ((nowUsec - canvasPtr->tweenDue)
+		    / interval + 1) * interval;
+	}
+	canvasPtr->tweenTimer = Tcl_CreateTimerHandler(
+		(int) ((canvasPtr->tweenDue - nowUsec + 999) / 1000),
+		CanvasTweenTick, canvasPtr);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SpatialIndexInvalidate --
+ *
+ *	Throw away the spatial index of a canvas, if one has been built. Must
+ *	be called whenever any item is created, deleted, restacked, or may
+ *	have changed its bounding box.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory held by the index is released; the next area query will
+ *	rebuild it.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SpatialIndexInvalidate(
+    TkCanvas *canvasPtr)	/* Canvas whose index is now stale. */
+{
+    SpatialIndex *indexPtr = canvasPtr->spatialPtr;
+
+    if (indexPtr != NULL) {
+	canvasPtr->spatialPtr = NULL;
+	if (indexPtr->items != NULL) {
+	    ckfree(indexPtr->items);
+	    ckfree(indexPtr->cellStart);
+	    ckfree(indexPtr->cellItems);
+	}
+	ckfree(indexPtr);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SpatialIndexCell --
+ *
+ *	Compute the grid cell that holds the point (x,y), clipping to the
+ *	edges of the grid for points outside it.
+ *
+ * Results:
+ *	An index into the cellStart array of the index.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static inline int
+SpatialIndexCell(
+    SpatialIndex *indexPtr,
+    int x, int y)
+{
+    int col = (x - indexPtr->gridX1) / indexPtr->cellWidth;
+    int row = (y - indexPtr->gridY1) / indexPtr->cellHeight;
+
+    if (col < 0) {
+	col = 0;
+    } else if (col >= indexPtr->cols) {
+	col = indexPtr->cols - 1;
+    }
+    if (row < 0) {
+	row = 0;
+    } else if (row >= indexPtr->rows) {
+	row = indexPtr->rows - 1;
+    }
+    return row*indexPtr->cols + col;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SpatialIndexGet --
+ *
+ *	Return the spatial index for a canvas, building it first if no
+ *	up-to-date index exists.
+ *
+ * Results:
+ *	A pointer to the index, which remains owned by the canvas. If the
+ *	canvas has too few items to be worth indexing, the returned index has
+ *	numCells == 0 and the caller must fall back to scanning the item
+ *	list.
+ *
+ * Side effects:
+ *	Memory is allocated and cached in canvasPtr->spatialPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static SpatialIndex *
+SpatialIndexGet(
+    TkCanvas *canvasPtr)	/* Canvas to index. */
+{
+    SpatialIndex *indexPtr = canvasPtr->spatialPtr;
+    Tk_Item *itemPtr;
+    int numItems = 0, anyAlways = 0;
+    int minX = 0, minY = 0, maxX = 0, maxY = 0, slopX = 0, slopY = 0;
+    int i, cell, target;
+
+    if (indexPtr != NULL) {
+	return indexPtr;
+    }
+
+    /*
+     * First pass over the item list: count the items and compute the extent
+     * of their bounding-box centers as well as the largest item half-size.
+     */
+
+    for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+	    itemPtr = itemPtr->nextPtr) {
+	int cx = (itemPtr->x1 + itemPtr->x2)/2;
+	int cy = (itemPtr->y1 + itemPtr->y2)/2;
+
+	if (numItems == 0) {
+	    minX = maxX = cx;
+	    minY = maxY = cy;
+	} else {
+	    if (cx < minX) {
+		minX = cx;
+	    } else if (cx > maxX) {
+		maxX = cx;
+	    }
+	    if (cy < minY) {
+		minY = cy;
+	    } else if (cy > maxY) {
+		maxY = cy;
+	    }
+	}
+	if (itemPtr->x2 - cx > slopX) {
+	    slopX = itemPtr->x2 - cx;
+	}
+	if (itemPtr->y2 - cy > slopY) {
+	    slopY = itemPtr->y2 - cy;
+	}
+	if (AlwaysRedraw(itemPtr)) {
+	    anyAlways = 1;
+	}
+	numItems++;
+    }
+
+    indexPtr = (SpatialIndex *)ckalloc(sizeof(SpatialIndex));
+    indexPtr->numItems = numItems;
+    indexPtr->numCells = 0;
+    indexPtr->anyAlwaysRedraw = anyAlways;
+    indexPtr->slopX = slopX + 1;
+    indexPtr->slopY = slopY + 1;
+    indexPtr->items = NULL;
+    indexPtr->cellStart = NULL;
+    indexPtr->cellItems = NULL;
+    canvasPtr->spatialPtr = indexPtr;
+    if (numItems < SPATIAL_INDEX_MIN_ITEMS) {
+	return indexPtr;
+    }
+
+    /*
+     * Pick a grid of roughly one item per cell, capped so that empty cells
+     * can't dominate the memory bill for sparse canvases.
+     */
+
+    target = (numItems > 65536) ? 65536 : numItems;
+    indexPtr->cols = (int) sqrt((double) target);
+    if (indexPtr->cols < 1) {
+	indexPtr->cols = 1;
+    }
+    indexPtr->rows = (target + indexPtr->cols - 1) / indexPtr->cols;
+    indexPtr->gridX1 = minX;
+    indexPtr->gridY1 = minY;
+    indexPtr->cellWidth = (maxX - minX)/indexPtr->cols + 1;
+    indexPtr->cellHeight = (maxY - minY)/indexPtr->rows + 1;
+    indexPtr->numCells = indexPtr->rows * indexPtr->cols;
+    indexPtr->items = (Tk_Item **)ckalloc(numItems * sizeof(Tk_Item *));
+    indexPtr->cellStart = (int *)ckalloc(
+	    (indexPtr->numCells + 1) * sizeof(int));
+    indexPtr->cellItems = (int *)ckalloc(numItems * sizeof(int));
+
+    /*
+     * Bucket the items by counting sort: count the population of each cell,
+     * turn the counts into start offsets, then deposit each item's index and
+     * finally shift the offsets back so cellStart[c] is the first entry of
+     * cell c again. Within a cell, entries stay in display list order.
+     */
+
+    i = 0;
+    for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+	    itemPtr = itemPtr->nextPtr) {
+	indexPtr->items[i++] = itemPtr;
+    }
+    for (cell = 0; cell <= indexPtr->numCells; cell++) {
+	indexPtr->cellStart[cell] = 0;
+    }
+    for (i = 0; i < numItems; i++) {
+	itemPtr = indexPtr->items[i];
+	cell = SpatialIndexCell(indexPtr, (itemPtr->x1 + itemPtr->x2)/2,
+		(itemPtr->y1 + itemPtr->y2)/2);
+	indexPtr->cellStart[cell + 1]++;
+    }
+    for (cell = 0; cell < indexPtr->numCells; cell++) {
+	indexPtr->cellStart[cell + 1] += indexPtr->cellStart[cell];
+    }
+    for (i = 0; i < numItems; i++) {
+	itemPtr = indexPtr->items[i];
+	cell = SpatialIndexCell(indexPtr, (itemPtr->x1 + itemPtr->x2)/2,
+		(itemPtr->y1 + itemPtr->y2)/2);
+	indexPtr->cellItems[indexPtr->cellStart[cell]++] = i;
+    }
+    for (cell = indexPtr->numCells; cell > 0; cell--) {
+	indexPtr->cellStart[cell] = indexPtr->cellStart[cell - 1];
+    }
+    indexPtr->cellStart[0] = 0;
+    return indexPtr;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SpatialIndexQuery --
+ *
+ *	Find all items whose bounding boxes touch the given rectangle, using
+ *	the spatial index instead of the full item list. The comparison is
+ *	inclusive on all edges, so the result is a superset of what the
+ *	callers' own (stricter) bounding-box tests accept; callers must still
+ *	apply those tests along with any state filtering.
+ *
+ * Results:
+ *	The number of items found. *itemsOut is set to a ckalloc'ed array of
+ *	the items, in display list order, which the caller must free; if no
+ *	items matched, *itemsOut is set to NULL.
+ *
+ * Side effects:
+ *	Memory is allocated for the result array.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+CompareIndexedItems(
+    const void *a,
+    const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+static int
+SpatialIndexQuery(
+    SpatialIndex *indexPtr,	/* Index built by SpatialIndexGet; must have
+				 * numCells > 0. */
+    int x1, int y1,		/* Upper-left corner of area of interest, in
+				 * canvas coordinates. */
+    int x2, int y2,		/* Lower-right corner of area of interest. */
+    Tk_Item ***itemsOut)	/* Result array is stored here. */
+{
+    int row, col, row1, col1, row2, col2, i, numFound = 0, capacity = 64;
+    int *found = (int *)ckalloc(capacity * sizeof(int));
+
+    /*
+     * Items are bucketed by the centers of their bounding boxes, so grow the
+     * search rectangle by the largest item half-size to be sure of visiting
+     * every cell that could hold an overlapping item.
+     */
+
+    col1 = (x1 - indexPtr->slopX - indexPtr->gridX1) / indexPtr->cellWidth;
+    row1 = (y1 - indexPtr->slopY - indexPtr->gridY1) / indexPtr->cellHeight;
+    col2 = (x2 + indexPtr->slopX - indexPtr->gridX1) / indexPtr->cellWidth;
+    row2 = (y2 + indexPtr->slopY - indexPtr->gridY1) / indexPtr->cellHeight;
+    if (col1 < 0) {
+	col1 = 0;
+    }
+    if (row1 < 0) {
+	row1 = 0;
+    }
+    if (col2 >= indexPtr->cols) {
+	col2 = indexPtr->cols - 1;
+    }
+    if (row2 >= indexPtr->rows) {
+	row2 = indexPtr->rows - 1;
+    }
+
+    for (row = row1; row <= row2; row++) {
+	for (col = col1; col <= col2; col++) {
+	    int cell = row*indexPtr->cols + col;
+	    int last = indexPtr->cellStart[cell + 1];
+
+	    for (i = indexPtr->cellStart[cell]; i < last; i++) {
+		Tk_Item *itemPtr = indexPtr->items[indexPtr->cellItems[i]];
+
+		if ((itemPtr->x1 > x2) || (itemPtr->x2 < x1)
+			|| (itemPtr->y1 > y2) || (itemPtr->y2 < y1)) {
+		    continue;
+		}
+		if (numFound >= capacity) {
+		    capacity *= 2;
+		    found = (int *)ckrealloc(found, capacity * sizeof(int));
+		}
+		found[numFound++] = indexPtr->cellItems[i];
+	    }
+	}
+    }
+    if (numFound == 0) {
+	ckfree(found);
+	*itemsOut = NULL;
+	return 0;
+    }
+
+    /*
+     * The entries were collected cell by cell; sort them so the result comes
+     * back in display list order, which every caller relies on.
+     */
+
+    qsort(found, numFound, sizeof(int), CompareIndexedItems);
+    *itemsOut = (Tk_Item **)ckalloc(numFound * sizeof(Tk_Item *));
+    for (i = 0; i < numFound; i++) {
+	(*itemsOut)[i] = indexPtr->items[found[i]];
+    }
+    ckfree(found);
+    return numFound;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * AllocItem, FreeItem, DrainItemPools --
+ *
+ *	Allocation of canvas item records. Records are recycled through
+ *	per-canvas free lists segregated by record size, so workloads that
+ *	create and destroy items at a high rate mostly stay out of the
+ *	general-purpose allocator. Each free list is capped; records beyond
+ *	the cap, and records of more distinct sizes than there are pool
+ *	slots, go straight back to ckfree.
+ *
+ * Results:
+ *	AllocItem returns an uninitialized item record of the type's size.
+ *
+ * Side effects:
+ *	Memory is allocated or recycled. DrainItemPools returns all pooled
+ *	records to the allocator and is called when the canvas is destroyed.
+ *
+ *--------------------------------------------------------------
+ */
+
+#define ITEM_POOL_MAX_FREE 1024
+
+static Tk_Item *
+AllocItem(
+    TkCanvas *canvasPtr,	/* Canvas in which the item will live. */
+    Tk_ItemType *typePtr)	/* Type of item to allocate. */
+{
+    TkCanvasItemPool *poolPtr = canvasPtr->itemPool;
+    int i;
+
+    for (i = 0; i < TK_CANVAS_ITEM_POOL_SIZES; i++, poolPtr++) {
+	if (poolPtr->itemSize == (TkSizeT)typePtr->itemSize) {
+	    if (poolPtr->firstFreePtr != NULL) {
+		void *blockPtr = poolPtr->firstFreePtr;
+
+		poolPtr->firstFreePtr = *(void **)blockPtr;
+		poolPtr->numFree--;
+		return (Tk_Item *)blockPtr;
+	    }
+	    break;
+	}
+	if (poolPtr->itemSize == 0) {
+	    poolPtr->itemSize = typePtr->itemSize;
+	    break;
+	}
+    }
+    return (Tk_Item *)ckalloc(typePtr->itemSize);
+}
+
+static void
+FreeItem(
+    TkCanvas *canvasPtr,	/* Canvas the item belonged to. */
+    Tk_Item *itemPtr)		/* Item record to release; the type-specific
+				 * contents must already be cleaned up. */
+{
+    TkCanvasItemPool *poolPtr = canvasPtr->itemPool;
+    int i;
+
+    for (i = 0; i < TK_CANVAS_ITEM_POOL_SIZES; i++, poolPtr++) {
+	if (poolPtr->itemSize == (TkSizeT)itemPtr->typePtr->itemSize) {
+	    if (poolPtr->numFree < ITEM_POOL_MAX_FREE) {
+		*(void **)itemPtr = poolPtr->firstFreePtr;
+		poolPtr->firstFreePtr = itemPtr;
+		poolPtr->numFree++;
+		return;
+	    }
+	    break;
+	}
+	if (poolPtr->itemSize == 0) {
+	    break;
+	}
+    }
+    ckfree(itemPtr);
+}
+
+static void
+DrainItemPools(
+    TkCanvas *canvasPtr)	/* Canvas being destroyed. */
+{
+    TkCanvasItemPool *poolPtr = canvasPtr->itemPool;
+    int i;
+
+    for (i = 0; i < TK_CANVAS_ITEM_POOL_SIZES; i++, poolPtr++) {
+	while (poolPtr->firstFreePtr != NULL) {
+	    void *blockPtr = poolPtr->firstFreePtr;
+
+	    poolPtr->firstFreePtr = *(void **)blockPtr;
+	    ckfree(blockPtr);
+	}
+	poolPtr->itemSize = 0;
+	poolPtr->numFree = 0;
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TagIndexInvalidate --
+ *
+ *	Throw away the per-tag membership index of a canvas and bump its
+ *	epoch. Must be called whenever an item is created or deleted, a tag
+ *	is added to or removed from an item, or the display list order
+ *	changes.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory held by the index is released; searches in progress detect
+ *	the epoch change and fall back to walking the item list.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+TagIndexInvalidate(
+    TkCanvas *canvasPtr)	/* Canvas whose tag index is now stale. */
+{
+    canvasPtr->tagIndexEpoch++;
+    if (canvasPtr->tagIndexValid) {
+	Tcl_HashEntry *hPtr;
+	Tcl_HashSearch hSearch;
+
+	for (hPtr = Tcl_FirstHashEntry(&canvasPtr->tagIndexTable, &hSearch);
+		hPtr != NULL; hPtr = Tcl_NextHashEntry(&hSearch)) {
+	    TagIndexEntry *indexEntryPtr =
+		    (TagIndexEntry *)Tcl_GetHashValue(hPtr);
+
+	    ckfree(indexEntryPtr->items);
+	    ckfree(indexEntryPtr);
+	}
+	Tcl_DeleteHashTable(&canvasPtr->tagIndexTable);
+	Tcl_InitHashTable(&canvasPtr->tagIndexTable, TCL_ONE_WORD_KEYS);
+	canvasPtr->tagIndexValid = 0;
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TagIndexGet --
+ *
+ *	Return the membership list for one tag, building the canvas's tag
+ *	index first if no up-to-date index exists.
+ *
+ * Results:
+ *	A pointer to the entry for the tag, which remains owned by the
+ *	canvas and is valid until the next call to TagIndexInvalidate. If
+ *	the tag is carried by no item, an empty entry is returned. A NULL
+ *	result means the canvas is too small to be worth indexing and the
+ *	caller must walk the item list instead.
+ *
+ * Side effects:
+ *	Memory is allocated and cached in canvasPtr->tagIndexTable.
+ *
+ *--------------------------------------------------------------
+ */
+
+static TagIndexEntry *
+TagIndexGet(
+    TkCanvas *canvasPtr,	/* Canvas whose items are being searched. */
+    Tk_Uid uid)			/* Tag being searched for. */
+{
+    static TagIndexEntry emptyEntry = { NULL, 0, 0 };
+    Tcl_HashEntry *hPtr;
+    Tk_Item *itemPtr;
+    TagIndexEntry *indexEntryPtr;
+    Tk_Uid *tagPtr;
+    int count, isNew;
+
+    if (canvasPtr->numItems < TAG_INDEX_MIN_ITEMS) {
+	return NULL;
+    }
+    if (!canvasPtr->tagIndexValid) {
+	for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+		itemPtr = itemPtr->nextPtr) {
+	    for (tagPtr = itemPtr->tagPtr, count = (int)itemPtr->numTags;
+		    count > 0; tagPtr++, count--) {
+		hPtr = Tcl_CreateHashEntry(&canvasPtr->tagIndexTable,
+			(char *) *tagPtr, &isNew);
+		if (isNew) {
+		    indexEntryPtr = (TagIndexEntry *)
+			    ckalloc(sizeof(TagIndexEntry));
+		    indexEntryPtr->allocated = 8;
+		    indexEntryPtr->numItems = 0;
+		    indexEntryPtr->items = (Tk_Item **)ckalloc(
+			    indexEntryPtr->allocated * sizeof(Tk_Item *));
+		    Tcl_SetHashValue(hPtr, indexEntryPtr);
+		} else {
+		    indexEntryPtr = (TagIndexEntry *)Tcl_GetHashValue(hPtr);
+
+		    /*
+		     * Guard against an item carrying the same tag twice
+		     * (possible via "-tags {a a}"); the item list walk must
+		     * yield each item only once.
+		     */
+
+		    if (indexEntryPtr->numItems > 0 && indexEntryPtr->
+			    items[indexEntryPtr->numItems-1] == itemPtr) {
+			continue;
+		    }
+		}
+		if (indexEntryPtr->numItems == indexEntryPtr->allocated) {
+		    indexEntryPtr->allocated *= 2;
+		    indexEntryPtr->items = (Tk_Item **)ckrealloc(
+			    indexEntryPtr->items,
+			    indexEntryPtr->allocated * sizeof(Tk_Item *));
+		}
+		indexEntryPtr->items[indexEntryPtr->numItems++] = itemPtr;
+	    }
+	}
+	canvasPtr->tagIndexValid = 1;
+    }
+    hPtr = Tcl_FindHashEntry(&canvasPtr->tagIndexTable, (char *) uid);
+    if (hPtr == NULL) {
+	return &emptyEntry;
+    }
+    return (TagIndexEntry *)Tcl_GetHashValue(hPtr);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * Tk_CanvasObjCmd --
+ *
+ *	This function is invoked to process the "canvas" Tcl command. See the
+ *	user documentation for details on what it does.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	See the user documentation.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+Tk_CanvasObjCmd(
+    ClientData clientData,	/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int argc,			/* Number of arguments. */
+    Tcl_Obj *const argv[])	/* Argument objects. */
+{
+    Tk_Window tkwin = (Tk_Window)clientData;
+    TkCanvas *canvasPtr;
+    Tk_Window newWin;
+
+    if (typeList == NULL) {
+	InitCanvas();
+    }
+
+    if (argc < 2) {
+	Tcl_WrongNumArgs(interp, 1, argv, "pathName ?-option value ...?");
+	return TCL_ERROR;
+    }
+
+    newWin = Tk_CreateWindowFromPath(interp,tkwin,Tcl_GetString(argv[1]),NULL);
+    if (newWin == NULL) {
+	return TCL_ERROR;
+    }
+
+    /*
+     * Initialize fields that won't be initialized by ConfigureCanvas, or
+     * which ConfigureCanvas expects to have reasonable values (e.g. resource
+     * pointers).
+     */
+
+    canvasPtr = (TkCanvas *)ckalloc(sizeof(TkCanvas));
+    canvasPtr->tkwin = newWin;
+    canvasPtr->display = Tk_Display(newWin);
+    canvasPtr->interp = interp;
+    canvasPtr->widgetCmd = Tcl_CreateObjCommand(interp,
+	    Tk_PathName(canvasPtr->tkwin), CanvasWidgetCmd, canvasPtr,
+	    CanvasCmdDeletedProc);
+    canvasPtr->firstItemPtr = NULL;
+    canvasPtr->lastItemPtr = NULL;
+    canvasPtr->spatialPtr = NULL;
+    canvasPtr->borderWidth = 0;
+    canvasPtr->bgBorder = NULL;
+    canvasPtr->relief = TK_RELIEF_FLAT;
+    canvasPtr->highlightWidth = 0;
+    canvasPtr->highlightBgColorPtr = NULL;
+    canvasPtr->highlightColorPtr = NULL;
+    canvasPtr->inset = 0;
+    canvasPtr->pixmapGC = NULL;
+    canvasPtr->lodThreshold = 0;
+    canvasPtr->lodColor = NULL;
+    canvasPtr->lodGC = NULL;
+    canvasPtr->width = None;
+    canvasPtr->height = None;
+    canvasPtr->confine = 0;
+    canvasPtr->textInfo.selBorder = NULL;
+    canvasPtr->textInfo.selBorderWidth = 0;
+    canvasPtr->textInfo.selFgColorPtr = NULL;
+    canvasPtr->textInfo.selItemPtr = NULL;
+    canvasPtr->textInfo.selectFirst = TCL_INDEX_NONE;
+    canvasPtr->textInfo.selectLast = TCL_INDEX_NONE;
+    canvasPtr->textInfo.anchorItemPtr = NULL;
+    canvasPtr->textInfo.selectAnchor = 0;
+    canvasPtr->textInfo.insertBorder = NULL;
+    canvasPtr->textInfo.insertWidth = 0;
+    canvasPtr->textInfo.insertBorderWidth = 0;
+    canvasPtr->textInfo.focusItemPtr = NULL;
+    canvasPtr->textInfo.gotFocus = 0;
+    canvasPtr->textInfo.cursorOn = 0;
+    canvasPtr->insertOnTime = 0;
+    canvasPtr->insertOffTime = 0;
+    canvasPtr->insertBlinkHandler = NULL;
+    canvasPtr->xOrigin = canvasPtr->yOrigin = 0;
+    canvasPtr->drawableXOrigin = canvasPtr->drawableYOrigin = 0;
+    canvasPtr->bindingTable = NULL;
+    canvasPtr->currentItemPtr = NULL;
+    canvasPtr->newCurrentPtr = NULL;
+    canvasPtr->closeEnough = 0.0;
+    canvasPtr->pickEvent.type = LeaveNotify;
+    canvasPtr->pickEvent.xcrossing.x = 0;
+    canvasPtr->pickEvent.xcrossing.y = 0;
+    canvasPtr->state = 0;
+    canvasPtr->xScrollCmd = NULL;
+    canvasPtr->yScrollCmd = NULL;
+    canvasPtr->scrollX1 = 0;
+    canvasPtr->scrollY1 = 0;
+    canvasPtr->scrollX2 = 0;
+    canvasPtr->scrollY2 = 0;
+    canvasPtr->regionString = NULL;
+    canvasPtr->xScrollIncrement = 0;
+    canvasPtr->yScrollIncrement = 0;
+    canvasPtr->scanX = 0;
+    canvasPtr->scanXOrigin = 0;
+    canvasPtr->scanY = 0;
+    canvasPtr->scanYOrigin = 0;
+    canvasPtr->hotPtr = NULL;
+    canvasPtr->hotPrevPtr = NULL;
+    canvasPtr->cursor = NULL;
+    canvasPtr->takeFocus = NULL;
+    canvasPtr->pixelsPerMM = WidthOfScreen(Tk_Screen(newWin));
+    canvasPtr->pixelsPerMM /= WidthMMOfScreen(Tk_Screen(newWin));
+    canvasPtr->flags = 0;
+    canvasPtr->nextId = 1;
+    canvasPtr->psInfo = NULL;
+    canvasPtr->canvas_state = TK_STATE_NORMAL;
+    canvasPtr->tsoffset.flags = 0;
+    canvasPtr->tsoffset.xoffset = 0;
+    canvasPtr->tsoffset.yoffset = 0;
+    canvasPtr->bindTagExprs = NULL;
+    Tcl_InitHashTable(&canvasPtr->idTable, TCL_ONE_WORD_KEYS);
+    Tcl_InitHashTable(&canvasPtr->tagExprTable, TCL_ONE_WORD_KEYS);
+    Tcl_InitHashTable(&canvasPtr->tagIndexTable, TCL_ONE_WORD_KEYS);
+    canvasPtr->tagIndexValid = 0;
+    canvasPtr->tagIndexEpoch = 0;
+    canvasPtr->snapshotGen = 0;
+    canvasPtr->numItems = 0;
+    memset(canvasPtr->itemPool, 0, sizeof(canvasPtr->itemPool));
+    canvasPtr->staticLayer = 0;
+    canvasPtr->staticPixmap = None;
+    canvasPtr->staticValid = 0;
+    canvasPtr->staticXOrigin = canvasPtr->staticYOrigin = 0;
+    canvasPtr->staticWidth = canvasPtr->staticHeight = 0;
+    canvasPtr->staticUid = Tk_GetUid("static");
+    canvasPtr->numDirty = 0;
+    canvasPtr->tweenPtr = NULL;
+    canvasPtr->tweenTimer = NULL;
+    canvasPtr->tweenDue = 0;
+
+    Tk_SetClass(canvasPtr->tkwin, "Canvas");
+    Tk_SetClassProcs(canvasPtr->tkwin, &canvasClass, canvasPtr);
+    Tk_CreateEventHandler(canvasPtr->tkwin,
+	    ExposureMask|StructureNotifyMask|FocusChangeMask,
+	    CanvasEventProc, canvasPtr);
+    Tk_CreateEventHandler(canvasPtr->tkwin, KeyPressMask|KeyReleaseMask
+	    |ButtonPressMask|ButtonReleaseMask|EnterWindowMask
+	    |LeaveWindowMask|PointerMotionMask|VirtualEventMask,
+	    CanvasBindProc, canvasPtr);
+    Tk_CreateSelHandler(canvasPtr->tkwin, XA_PRIMARY, XA_STRING,
+	    CanvasFetchSelection, canvasPtr, XA_STRING);
+    if (ConfigureCanvas(interp, canvasPtr, argc-2, argv+2, 0) != TCL_OK) {
+	goto error;
+    }
+
+    Tcl_SetObjResult(interp, Tk_NewWindowObj(canvasPtr->tkwin));
+    return TCL_OK;
+
+  error:
+    Tk_DestroyWindow(canvasPtr->tkwin);
+    return TCL_ERROR;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * SnapshotPutUint32, SnapshotPutDouble, SnapshotPutString --
+ *
+ *	Append one primitive value to the binary buffer being assembled by
+ *	the "snapshot" widget command. Integers are stored as 32 bits
+ *	little-endian, doubles as their little-endian IEEE 754 bit pattern
+ *	and strings as a 32-bit length followed by the bytes (no trailing
+ *	NUL), independent of the host byte order.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The buffer grows.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+SnapshotPutUint32(
+    Tcl_DString *dsPtr,		/* Buffer being assembled. */
+    unsigned int value)		/* Value to append. */
+{
+    char bytes[4];
+
+    bytes[0] = (char) (value & 0xff);
+    bytes[1] = (char) ((value >> 8) & 0xff);
+    bytes[2] = (char) ((value >> 16) & 0xff);
+    bytes[3] = (char) ((value >> 24) & 0xff);
+    Tcl_DStringAppend(dsPtr, bytes, 4);
+}
+
+static void
+SnapshotPutDouble(
+    Tcl_DString *dsPtr,		/* Buffer being assembled. */
+    double value)		/* Value to append. */
+{
+    union {
+	double d;
+	Tcl_WideUInt w;
+    } u;
+    char bytes[8];
+    int i;
+
+    u.w = 0;
+    u.d = value;
+    for (i = 0; i < 8; i++) {
+	bytes[i] = (char) ((u.w >> (8*i)) & 0xff);
+    }
+    Tcl_DStringAppend(dsPtr, bytes, 8);
+}
+
+static void
+SnapshotPutString(
+    Tcl_DString *dsPtr,		/* Buffer being assembled. */
+    const char *string)		/* NUL-terminated string to append. */
+{
+    unsigned int length = (unsigned int) strlen(string);
+
+    SnapshotPutUint32(dsPtr, length);
+    Tcl_DStringAppend(dsPtr, string, (int) length);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * CanvasWidgetCmd --
+ *
+ *	This function is invoked to process the Tcl command that corresponds
+ *	to a widget managed by this module. See the user documentation for
+ *	details on what it does.
+ *
+ * Results:
+ *	A standard Tcl result.
  *
  * Side effects:
  *	See the user documentation.
@@ -841,50 +1951,208 @@ CanvasWidgetCmd(
 
     int idx;
     static const char *const canvasOptionStrings[] = {
-	"addtag",	"bbox",		"bind",		"canvasx",
+	"addtag",	"animate",	"bbox",		"bind",		"canvasx",
 	"canvasy",	"cget",		"configure",	"coords",
-	"create",	"dchars",	"delete",	"dtag",
+	"coordslist",	"create",	"dchars",	"delete",	"dtag",
 	"find",		"focus",	"gettags",	"icursor",
         "image",	"imove",	"index",	"insert",
 	"itemcget",	"itemconfigure",
 	"lower",	"move",		"moveto",	"postscript",
 	"raise",	"rchars",	"rotate",	"scale",
-	"scan",		"select",	"type",		"xview",
-	"yview",	NULL
+	"scan",		"select",	"snapshot",	"transform",	"type",
+	"xview",	"yview",	NULL
     };
     enum canvasOptionStringsEnum {
-	CANV_ADDTAG,	CANV_BBOX,	CANV_BIND,	CANV_CANVASX,
+	CANV_ADDTAG,	CANV_ANIMATE,	CANV_BBOX,	CANV_BIND,
+	CANV_CANVASX,
 	CANV_CANVASY,	CANV_CGET,	CANV_CONFIGURE,	CANV_COORDS,
+	CANV_COORDSLIST,
 	CANV_CREATE,	CANV_DCHARS,	CANV_DELETE,	CANV_DTAG,
 	CANV_FIND,	CANV_FOCUS,	CANV_GETTAGS,	CANV_ICURSOR,
         CANV_IMAGE,	CANV_IMOVE,	CANV_INDEX,	CANV_INSERT,
 	CANV_ITEMCGET,	CANV_ITEMCONFIGURE,
 	CANV_LOWER,	CANV_MOVE,	CANV_MOVETO,	CANV_POSTSCRIPT,
 	CANV_RAISE,	CANV_RCHARS,	CANV_ROTATE,	CANV_SCALE,
-	CANV_SCAN,	CANV_SELECT,	CANV_TYPE,	CANV_XVIEW,
-	CANV_YVIEW
+	CANV_SCAN,	CANV_SELECT,	CANV_SNAPSHOT,	CANV_TRANSFORM,
+	CANV_TYPE,
+	CANV_XVIEW,	CANV_YVIEW
     };
 
-    if (objc < 2) {
-	Tcl_WrongNumArgs(interp, 1, objv, "option ?arg ...?");
-	return TCL_ERROR;
-    }
-    if (Tcl_GetIndexFromObj(interp, objv[1], canvasOptionStrings, "option", 0,
-	    &idx) != TCL_OK) {
-	return TCL_ERROR;
-    }
-    Tcl_Preserve(canvasPtr);
+    if (objc < 2) {
+	Tcl_WrongNumArgs(interp, 1, objv, "option ?arg ...?");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[1], canvasOptionStrings, "option", 0,
+	    &idx) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    Tcl_Preserve(canvasPtr);
+
+    result = TCL_OK;
+    switch ((enum canvasOptionStringsEnum)idx) {
+    case CANV_ADDTAG:
+	if (objc < 4) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "tag searchCommand ?arg ...?");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	result = FIND_ITEMS(objv[2], 3);
+	break;
+
+    case CANV_ANIMATE: {
+	Tcl_Obj **coordObjv = NULL, **curObjv;
+	int coordObjc = 0, curObjc, durationMs = 300;
+	int easing = TWEEN_EASING_LINEAR;
+	int i, optIdx;
+	TkCanvasTween *tweenPtr, **prevPtrPtr;
+	static const char *const animateOptionStrings[] = {
+	    "-coords", "-duration", "-easing", NULL
+	};
+	enum animateOptionsEnum {
+	    ANIM_COORDS, ANIM_DURATION, ANIM_EASING
+	};
+	static const char *const easingStrings[] = {
+	    "cubic", "linear", NULL
+	};
+
+	if ((objc < 5) || (objc % 2 == 0)) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "tagOrId -option value ?-option value ...?");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	for (i = 3; i < objc; i += 2) {
+	    if (Tcl_GetIndexFromObj(interp, objv[i], animateOptionStrings,
+		    "option", 0, &optIdx) != TCL_OK) {
+		result = TCL_ERROR;
+		goto done;
+	    }
+	    switch ((enum animateOptionsEnum) optIdx) {
+	    case ANIM_COORDS:
+		if (Tcl_ListObjGetElements(interp, objv[i+1], &coordObjc,
+			&coordObjv) != TCL_OK) {
+		    result = TCL_ERROR;
+		    goto done;
+		}
+		break;
+	    case ANIM_DURATION:
+		if (Tcl_GetIntFromObj(interp, objv[i+1], &durationMs)
+			!= TCL_OK) {
+		    result = TCL_ERROR;
+		    goto done;
+		}
+		break;
+	    case ANIM_EASING:
+		if (Tcl_GetIndexFromObj(interp, objv[i+1], easingStrings,
+			"easing", 0, &easing) != TCL_OK) {
+		    result = TCL_ERROR;
+		    goto done;
+		}
+		easing = (easing == 0) ? TWEEN_EASING_CUBIC
+			: TWEEN_EASING_LINEAR;
+		break;
+	    }
+	}
+	if (coordObjv == NULL) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "no target coordinates given: must supply -coords", -1));
+	    Tcl_SetErrorCode(interp, "TK", "CANVAS", "ANIMATE", "COORDS",
+		    NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	FIRST_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, goto done);
+	if (itemPtr == NULL) {
+	    break;
+	}
+
+	/*
+	 * The item's current coordinates become the starting point of the
+	 * interpolation. They are only available through the interpreter
+	 * result, so they must be copied out before the result is reset.
+	 */
+
+	result = ItemCoords(canvasPtr, itemPtr, 0, NULL);
+	if (result != TCL_OK) {
+	    goto done;
+	}
+	if (Tcl_ListObjGetElements(NULL, Tcl_GetObjResult(interp),
+		&curObjc, &curObjv) != TCL_OK) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (coordObjc != curObjc) {
+	    Tcl_ResetResult(interp);
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "wrong # coordinates: expected %d, got %d",
+		    curObjc, coordObjc));
+	    Tcl_SetErrorCode(interp, "TK", "CANVAS", "ANIMATE", "COORDS",
+		    NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	tweenPtr = (TkCanvasTween *) ckalloc(sizeof(TkCanvasTween));
+	tweenPtr->itemId = itemPtr->id;
+	tweenPtr->nCoords = coordObjc;
+	tweenPtr->startCoords = (double *)
+		ckalloc(sizeof(double) * coordObjc);
+	tweenPtr->endCoords = (double *) ckalloc(sizeof(double) * coordObjc);
+	tweenPtr->durationMs = durationMs;
+	tweenPtr->easing = easing;
+	tweenPtr->nextPtr = NULL;
+	for (i = 0; i < coordObjc; i++) {
+	    if (Tcl_GetDoubleFromObj(NULL, curObjv[i],
+		    &tweenPtr->startCoords[i]) != TCL_OK) {
+		tweenPtr->startCoords[i] = 0.0;
+	    }
+	}
+	Tcl_ResetResult(interp);
+	for (i = 0; i < coordObjc; i++) {
+	    if (Tcl_GetDoubleFromObj(interp, coordObjv[i],
+		    &tweenPtr->endCoords[i]) != TCL_OK) {
+		CanvasTweenFree(tweenPtr);
+		result = TCL_ERROR;
+		goto done;
+	    }
+	}
+
+	/*
+	 * A new animation supersedes any animation already running on the
+	 * same item.
+	 */
+
+	for (prevPtrPtr = &canvasPtr->tweenPtr; *prevPtrPtr != NULL;
+		prevPtrPtr = &(*prevPtrPtr)->nextPtr) {
+	    if ((*prevPtrPtr)->itemId == tweenPtr->itemId) {
+		TkCanvasTween *oldPtr = *prevPtrPtr;
+
+		*prevPtrPtr = oldPtr->nextPtr;
+		CanvasTweenFree(oldPtr);
+		break;
+	    }
+	}
+	if (durationMs <= 0) {
+	    /*
+	     * Nothing to interpolate over: jump to the end coordinates.
+	     */
+
+	    CanvasTweenApply(canvasPtr, itemPtr, tweenPtr, 1.0);
+	    Tcl_ResetResult(interp);
+	    CanvasTweenFree(tweenPtr);
+	    break;
+	}
+	tweenPtr->startUsec = TweenNowUsec();
+	tweenPtr->nextPtr = canvasPtr->tweenPtr;
+	canvasPtr->tweenPtr = tweenPtr;
+	if (canvasPtr->tweenTimer == NULL) {
+	    Tcl_WideInt interval = TkFrameClockIntervalUsec();
 
-    result = TCL_OK;
-    switch ((enum canvasOptionStringsEnum)idx) {
-    case CANV_ADDTAG:
-	if (objc < 4) {
-	    Tcl_WrongNumArgs(interp, 2, objv, "tag searchCommand ?arg ...?");
-	    result = TCL_ERROR;
-	    goto done;
+	    canvasPtr->tweenDue = tweenPtr->startUsec + interval;
+	    canvasPtr->tweenTimer = Tcl_CreateTimerHandler(
+		    (int) ((interval + 999) / 1000), CanvasTweenTick,
+		    canvasPtr);
 	}
-	result = FIND_ITEMS(objv[2], 3);
 	break;
+    }
 
     case CANV_BBOX: {
 	int i, gotAny;
@@ -1169,6 +2437,42 @@ CanvasWidgetCmd(
 	    }
 	}
 	break;
+    case CANV_COORDSLIST: {
+	Tcl_Obj *resultObj;
+
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "tagOrId");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+
+	/*
+	 * Collect the coordinates of every matching item into one flat
+	 * list, in display list order. Item types only expose their
+	 * coordinates through their coordProc, which reports them as the
+	 * interp result, so each report is transferred into the
+	 * accumulator as it is made.
+	 */
+
+	resultObj = Tcl_NewObj();
+	Tcl_IncrRefCount(resultObj);
+	FOR_EVERY_CANVAS_ITEM_MATCHING(objv[2], &searchPtr,
+		goto coordsListError) {
+	    result = ItemCoords(canvasPtr, itemPtr, 0, NULL);
+	    if (result != TCL_OK) {
+		goto coordsListError;
+	    }
+	    Tcl_ListObjAppendList(NULL, resultObj, Tcl_GetObjResult(interp));
+	    Tcl_ResetResult(interp);
+	}
+	Tcl_SetObjResult(interp, resultObj);
+	Tcl_DecrRefCount(resultObj);
+	break;
+
+    coordsListError:
+	Tcl_DecrRefCount(resultObj);
+	goto done;
+    }
     case CANV_IMOVE: {
 	double ignored;
 	Tcl_Obj *tmpObj;
@@ -1304,7 +2608,7 @@ CanvasWidgetCmd(
 	}
 
 	typePtr = matchPtr;
-	itemPtr = (Tk_Item *)ckalloc(typePtr->itemSize);
+	itemPtr = AllocItem(canvasPtr, typePtr);
 	itemPtr->id = canvasPtr->nextId++;
 	itemPtr->tagPtr = itemPtr->staticTagSpace;
 	itemPtr->tagSpace = TK_TAG_SPACE;
@@ -1314,7 +2618,7 @@ CanvasWidgetCmd(
 	itemPtr->redraw_flags = 0;
 
 	if (ItemCreate(canvasPtr, itemPtr, objc, objv) != TCL_OK) {
-	    ckfree(itemPtr);
+	    FreeItem(canvasPtr, itemPtr);
 	    result = TCL_ERROR;
 	    goto done;
 	}
@@ -1332,6 +2636,8 @@ CanvasWidgetCmd(
 	    canvasPtr->lastItemPtr->nextPtr = itemPtr;
 	}
 	canvasPtr->lastItemPtr = itemPtr;
+	canvasPtr->numItems++;
+	TagIndexInvalidate(canvasPtr);
 	itemPtr->redraw_flags |= FORCE_REDRAW;
 	EventuallyRedrawItem(canvasPtr, itemPtr);
 	canvasPtr->flags |= REPICK_NEEDED;
@@ -1417,7 +2723,9 @@ CanvasWidgetCmd(
 		if (canvasPtr->lastItemPtr == itemPtr) {
 		    canvasPtr->lastItemPtr = itemPtr->prevPtr;
 		}
-		ckfree(itemPtr);
+		canvasPtr->numItems--;
+		TagIndexInvalidate(canvasPtr);
+		FreeItem(canvasPtr, itemPtr);
 		if (itemPtr == canvasPtr->currentItemPtr) {
 		    canvasPtr->currentItemPtr = NULL;
 		    canvasPtr->flags |= REPICK_NEEDED;
@@ -1450,9 +2758,9 @@ CanvasWidgetCmd(
 	    goto done;
 	}
 	if (objc == 4) {
-	    tag = Tk_GetUid(Tcl_GetString(objv[3]));
+	    tag = TkGetUidFromObj(objv[3]);
 	} else {
-	    tag = Tk_GetUid(Tcl_GetString(objv[2]));
+	    tag = TkGetUidFromObj(objv[2]);
 	}
 	FOR_EVERY_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, goto done) {
 	    for (i = (int)itemPtr->numTags-1; i >= 0; i--) {
@@ -1466,6 +2774,10 @@ CanvasWidgetCmd(
                             itemPtr->tagPtr + i + 1,
                             (itemPtr->numTags - (i+1)) * sizeof(Tk_Uid));
 		    itemPtr->numTags--;
+		    TagIndexInvalidate(canvasPtr);
+		    if (tag == canvasPtr->staticUid) {
+			canvasPtr->staticValid = 0;
+		    }
 
                     /*
                      * There must be no break here: all tags with the same name must
@@ -1655,6 +2967,13 @@ CanvasWidgetCmd(
 		result = ItemConfigure(canvasPtr, itemPtr, objc-3, objv+3);
 		EventuallyRedrawItem(canvasPtr, itemPtr);
 		canvasPtr->flags |= REPICK_NEEDED;
+
+		/*
+		 * The configure may have replaced the item's tag list
+		 * (-tags), so the tag index can't be trusted any more.
+		 */
+
+		TagIndexInvalidate(canvasPtr);
 	    }
 	    if ((result != TCL_OK) || (objc < 5)) {
 		break;
@@ -1687,6 +3006,7 @@ CanvasWidgetCmd(
     }
     case CANV_MOVE: {
 	double xAmount, yAmount;
+	ItemBatch batch;
 
 	if (objc != 5) {
 	    Tcl_WrongNumArgs(interp, 2, objv, "tagOrId xAmount yAmount");
@@ -1699,18 +3019,21 @@ CanvasWidgetCmd(
 	    result = TCL_ERROR;
 	    goto done;
 	}
+	batch.count = 0;
 	FOR_EVERY_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, goto done) {
 	    EventuallyRedrawItem(canvasPtr, itemPtr);
-	    ItemTranslate(canvasPtr, itemPtr, xAmount, yAmount);
-	    EventuallyRedrawItem(canvasPtr, itemPtr);
+	    ItemTranslateBatched(canvasPtr, itemPtr, &batch, xAmount,
+		    yAmount);
 	    canvasPtr->flags |= REPICK_NEEDED;
 	}
+	FlushTranslateBatch(canvasPtr, &batch, xAmount, yAmount);
 	break;
     }
     case CANV_MOVETO: {
 	int xBlank, yBlank;
 	double xAmount, yAmount;
 	double oldX = 0, oldY = 0, newX, newY;
+	ItemBatch batch;
 
 	if (objc != 5) {
 	    Tcl_WrongNumArgs(interp, 2, objv, "tagOrId x y");
@@ -1761,12 +3084,14 @@ CanvasWidgetCmd(
 	     * Move the object(s).
 	     */
 
+	    batch.count = 0;
 	    FOR_EVERY_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, goto done) {
 		EventuallyRedrawItem(canvasPtr, itemPtr);
-		ItemTranslate(canvasPtr, itemPtr, xAmount, yAmount);
-		EventuallyRedrawItem(canvasPtr, itemPtr);
+		ItemTranslateBatched(canvasPtr, itemPtr, &batch, xAmount,
+			yAmount);
 		canvasPtr->flags |= REPICK_NEEDED;
 	    }
+	    FlushTranslateBatch(canvasPtr, &batch, xAmount, yAmount);
 	}
 	break;
     }
@@ -2061,6 +3386,142 @@ CanvasWidgetCmd(
 	}
 	break;
     }
+    case CANV_SNAPSHOT: {
+	Tcl_DString buf;
+	Tcl_Obj **coordObjv;
+	const Tk_ConfigSpec *specPtr;
+	int coordObjc, i;
+	unsigned int numOpts;
+
+	if (objc != 2) {
+	    Tcl_WrongNumArgs(interp, 2, objv, NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+
+	/*
+	 * Serialize the display list into a compact binary buffer so that
+	 * external renderers can mirror the canvas without a cget round trip
+	 * per item attribute. All integers are 32-bit little-endian, doubles
+	 * are little-endian IEEE 754 and strings are length-prefixed. The
+	 * buffer starts with the magic "TkCS", a format version, the current
+	 * generation number and the item count; each item contributes its
+	 * id, type name, coordinates and resolved configuration options in
+	 * display list order.
+	 */
+
+	Tcl_DStringInit(&buf);
+	Tcl_DStringAppend(&buf, "TkCS", 4);
+	SnapshotPutUint32(&buf, 1);
+	SnapshotPutUint32(&buf, (unsigned int) canvasPtr->snapshotGen);
+	SnapshotPutUint32(&buf, (unsigned int) canvasPtr->numItems);
+	for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+		itemPtr = itemPtr->nextPtr) {
+	    SnapshotPutUint32(&buf, (unsigned int) itemPtr->id);
+	    SnapshotPutString(&buf, itemPtr->typePtr->name);
+
+	    coordObjc = 0;
+	    coordObjv = NULL;
+	    if ((ItemCoords(canvasPtr, itemPtr, 0, NULL) != TCL_OK)
+		    || (Tcl_ListObjGetElements(NULL,
+		    Tcl_GetObjResult(interp), &coordObjc,
+		    &coordObjv) != TCL_OK)) {
+		coordObjc = 0;
+	    }
+	    SnapshotPutUint32(&buf, (unsigned int) coordObjc);
+	    for (i = 0; i < coordObjc; i++) {
+		double coord = 0.0;
+
+		Tcl_GetDoubleFromObj(NULL, coordObjv[i], &coord);
+		SnapshotPutDouble(&buf, coord);
+	    }
+	    Tcl_ResetResult(interp);
+
+	    /*
+	     * The option values are emitted exactly as "itemcget" would
+	     * report them, so defaults are already resolved.
+	     */
+
+	    numOpts = 0;
+	    for (specPtr = itemPtr->typePtr->configSpecs;
+		    specPtr->type != TK_CONFIG_END; specPtr++) {
+		if ((specPtr->argvName != NULL)
+			&& (specPtr->type != TK_CONFIG_SYNONYM)) {
+		    numOpts++;
+		}
+	    }
+	    SnapshotPutUint32(&buf, numOpts);
+	    for (specPtr = itemPtr->typePtr->configSpecs;
+		    specPtr->type != TK_CONFIG_END; specPtr++) {
+		if ((specPtr->argvName == NULL)
+			|| (specPtr->type == TK_CONFIG_SYNONYM)) {
+		    continue;
+		}
+		SnapshotPutString(&buf, specPtr->argvName);
+		if (Tk_ConfigureValue(interp, canvasPtr->tkwin,
+			itemPtr->typePtr->configSpecs, (char *) itemPtr,
+			specPtr->argvName, 0) == TCL_OK) {
+		    SnapshotPutString(&buf, Tcl_GetStringResult(interp));
+		} else {
+		    SnapshotPutString(&buf, "");
+		}
+		Tcl_ResetResult(interp);
+	    }
+	}
+	Tcl_SetObjResult(interp, Tcl_NewByteArrayObj(
+		(unsigned char *) Tcl_DStringValue(&buf),
+		Tcl_DStringLength(&buf)));
+	Tcl_DStringFree(&buf);
+	break;
+    }
+    case CANV_TRANSFORM: {
+	double xOrigin, yOrigin, xScale, yScale, xAmount, yAmount;
+
+	if (objc != 9) {
+	    Tcl_WrongNumArgs(interp, 2, objv,
+		    "tagOrId xOrigin yOrigin xScale yScale xAmount yAmount");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if ((Tk_CanvasGetCoordFromObj(interp, (Tk_Canvas) canvasPtr,
+		    objv[3], &xOrigin) != TCL_OK)
+		|| (Tk_CanvasGetCoordFromObj(interp, (Tk_Canvas) canvasPtr,
+		    objv[4], &yOrigin) != TCL_OK)
+		|| (Tcl_GetDoubleFromObj(interp, objv[5], &xScale)!=TCL_OK)
+		|| (Tcl_GetDoubleFromObj(interp, objv[6], &yScale)!=TCL_OK)
+		|| (Tk_CanvasGetCoordFromObj(interp, (Tk_Canvas) canvasPtr,
+		    objv[7], &xAmount) != TCL_OK)
+		|| (Tk_CanvasGetCoordFromObj(interp, (Tk_Canvas) canvasPtr,
+		    objv[8], &yAmount) != TCL_OK)) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if ((xScale == 0.0) || (yScale == 0.0)) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "scale factor cannot be zero", -1));
+	    Tcl_SetErrorCode(interp, "TK", "CANVAS", "BAD_SCALE", NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+
+	/*
+	 * One pass over the matching items: each item is scaled about the
+	 * origin and then translated before moving on to the next one, so
+	 * a combined pan/zoom costs a single tag search and the damage
+	 * from both steps is merged into one redraw region.
+	 */
+
+	FOR_EVERY_CANVAS_ITEM_MATCHING(objv[2], &searchPtr, goto done) {
+	    EventuallyRedrawItem(canvasPtr, itemPtr);
+	    ItemScale(canvasPtr, itemPtr, xOrigin, yOrigin, xScale, yScale);
+	    if ((xAmount != 0.0) || (yAmount != 0.0)) {
+		ItemTranslate(canvasPtr, itemPtr, xAmount, yAmount);
+	    }
+	    EventuallyRedrawItem(canvasPtr, itemPtr);
+	    canvasPtr->flags |= REPICK_NEEDED;
+	}
+	break;
+    }
     case CANV_TYPE:
 	if (objc != 3) {
 	    Tcl_WrongNumArgs(interp, 2, objv, "tag");
@@ -2237,6 +3698,8 @@ DestroyCanvas(
     TkCanvas *canvasPtr = (TkCanvas *)memPtr;
     Tk_Item *itemPtr;
     TagSearchExpr *expr, *next;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch hSearch;
 
     /*
      * Free up all of the items in the canvas.
@@ -2257,10 +3720,26 @@ DestroyCanvas(
      * Tk_FreeOptions handle all the standard option-related stuff.
      */
 
+    SpatialIndexInvalidate(canvasPtr);
+    DrainItemPools(canvasPtr);
     Tcl_DeleteHashTable(&canvasPtr->idTable);
+    hPtr = Tcl_FirstHashEntry(&canvasPtr->tagExprTable, &hSearch);
+    for ( ; hPtr != NULL; hPtr = Tcl_NextHashEntry(&hSearch)) {
+	TagSearchExprDestroy((TagSearchExpr *)Tcl_GetHashValue(hPtr));
+    }
+    Tcl_DeleteHashTable(&canvasPtr->tagExprTable);
+    TagIndexInvalidate(canvasPtr);
+    Tcl_DeleteHashTable(&canvasPtr->tagIndexTable);
+    if (canvasPtr->staticPixmap != None) {
+	Tk_FreePixmap(canvasPtr->display, canvasPtr->staticPixmap);
+	canvasPtr->staticPixmap = None;
+    }
     if (canvasPtr->pixmapGC != NULL) {
 	Tk_FreeGC(canvasPtr->display, canvasPtr->pixmapGC);
     }
+    if (canvasPtr->lodGC != NULL) {
+	Tk_FreeGC(canvasPtr->display, canvasPtr->lodGC);
+    }
     expr = canvasPtr->bindTagExprs;
     while (expr) {
 	next = expr->next;
@@ -2268,6 +3747,13 @@ DestroyCanvas(
 	expr = next;
     }
     Tcl_DeleteTimerHandler(canvasPtr->insertBlinkHandler);
+    Tcl_DeleteTimerHandler(canvasPtr->tweenTimer);
+    while (canvasPtr->tweenPtr != NULL) {
+	TkCanvasTween *tweenPtr = canvasPtr->tweenPtr;
+
+	canvasPtr->tweenPtr = tweenPtr->nextPtr;
+	CanvasTweenFree(tweenPtr);
+    }
     if (canvasPtr->bindingTable != NULL) {
 	Tk_DeleteBindingTable(canvasPtr->bindingTable);
     }
@@ -2337,6 +3823,22 @@ ConfigureCanvas(
     }
     canvasPtr->pixmapGC = newGC;
 
+    gcValues.foreground = canvasPtr->lodColor->pixel;
+    newGC = Tk_GetGC(canvasPtr->tkwin,
+	    GCFunction|GCGraphicsExposures|GCForeground, &gcValues);
+    if (canvasPtr->lodGC != NULL) {
+	Tk_FreeGC(canvasPtr->display, canvasPtr->lodGC);
+    }
+    canvasPtr->lodGC = newGC;
+
+    /*
+     * Any option change (background, state, -staticlayer itself, ...) may
+     * affect how the static layer renders, so throw away the retained
+     * pixmap; it is rebuilt on the next redisplay if still wanted.
+     */
+
+    canvasPtr->staticValid = 0;
+
     /*
      * Reconfigure items to reflect changed state disabled/normal.
      */
@@ -2731,9 +4233,13 @@ DrawCanvas(
                 == TK_STATE_HIDDEN)) {
             continue;
         }
+        if (ItemDisplayLod(canvasPtr, itemPtr, pixmap, pixmapX1, pixmapY1)) {
+            continue;
+        }
         ItemDisplay(canvasPtr, itemPtr, pixmap, pixmapX1, pixmapY1, pmWidth,
                 pmHeight);
     }
+    TkCanvasBatchFlush();
 
     /*
      * Copy the Pixmap into an ZPixmap format XImage so we can copy it across
@@ -2977,6 +4483,153 @@ done:
     return result;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * StaticLayerEnsure --
+ *
+ *	Make sure the retained pixmap holding the canvas's static layer (all
+ *	items carrying the "static" tag) is up to date for the currently
+ *	visible area, rebuilding it if necessary. The cache can only be used
+ *	when the static items form the bottom of the display list and none
+ *	of them demands to be redrawn on every pass; otherwise copying the
+ *	pixmap and then drawing only the remaining items would produce the
+ *	wrong stacking order.
+ *
+ * Results:
+ *	Returns 1 if staticPixmap may be copied in place of redrawing the
+ *	static items, 0 if the caller must fall back to drawing every item.
+ *
+ * Side effects:
+ *	May allocate or redraw the retained pixmap.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+StaticLayerEnsure(
+    TkCanvas *canvasPtr)	/* Information about widget. */
+{
+    Tk_Window tkwin = canvasPtr->tkwin;
+    Tk_Item *itemPtr;
+    int cacheX1, cacheY1, cacheX2, cacheY2, width, height, sawDynamic;
+
+    cacheX1 = canvasPtr->xOrigin;
+    cacheY1 = canvasPtr->yOrigin;
+    width = Tk_Width(tkwin);
+    height = Tk_Height(tkwin);
+    cacheX2 = cacheX1 + width;
+    cacheY2 = cacheY1 + height;
+    if ((width <= 0) || (height <= 0)) {
+	return 0;
+    }
+    if (canvasPtr->staticValid && (cacheX1 == canvasPtr->staticXOrigin)
+	    && (cacheY1 == canvasPtr->staticYOrigin)
+	    && (width == canvasPtr->staticWidth)
+	    && (height == canvasPtr->staticHeight)) {
+	return 1;
+    }
+
+    /*
+     * Check that the static items are a contiguous run at the bottom of the
+     * display list, and that none of them is of an always-redraw type (such
+     * as window items, which must be visited on every redisplay).
+     */
+
+    sawDynamic = 0;
+    for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+	    itemPtr = itemPtr->nextPtr) {
+	if (ItemIsStatic(canvasPtr, itemPtr)) {
+	    if (sawDynamic || AlwaysRedraw(itemPtr)) {
+		return 0;
+	    }
+	} else {
+	    sawDynamic = 1;
+	}
+    }
+
+    if ((canvasPtr->staticPixmap == None)
+	    || (width != canvasPtr->staticWidth)
+	    || (height != canvasPtr->staticHeight)) {
+	if (canvasPtr->staticPixmap != None) {
+	    Tk_FreePixmap(Tk_Display(tkwin), canvasPtr->staticPixmap);
+	}
+	canvasPtr->staticPixmap = Tk_GetPixmap(Tk_Display(tkwin),
+		Tk_WindowId(tkwin), width, height, Tk_Depth(tkwin));
+	canvasPtr->staticWidth = width;
+	canvasPtr->staticHeight = height;
+    }
+    canvasPtr->staticXOrigin = cacheX1;
+    canvasPtr->staticYOrigin = cacheY1;
+
+    /*
+     * Render the static layer. The drawable origins are set for the cache
+     * pixmap here; DisplayCanvas resets them before any other drawing.
+     */
+
+    canvasPtr->drawableXOrigin = cacheX1;
+    canvasPtr->drawableYOrigin = cacheY1;
+    XFillRectangle(Tk_Display(tkwin), canvasPtr->staticPixmap,
+	    canvasPtr->pixmapGC, 0, 0, (unsigned int) width,
+	    (unsigned int) height);
+    for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+	    itemPtr = itemPtr->nextPtr) {
+	if (!ItemIsStatic(canvasPtr, itemPtr)) {
+	    break;
+	}
+	if ((itemPtr->x1 >= cacheX2) || (itemPtr->y1 >= cacheY2)
+		|| (itemPtr->x2 < cacheX1) || (itemPtr->y2 < cacheY1)) {
+	    continue;
+	}
+	if (itemPtr->state == TK_STATE_HIDDEN ||
+		(itemPtr->state == TK_STATE_NULL &&
+		canvasPtr->canvas_state == TK_STATE_HIDDEN)) {
+	    continue;
+	}
+	if (ItemDisplayLod(canvasPtr, itemPtr, canvasPtr->staticPixmap,
+		cacheX1, cacheY1)) {
+	    continue;
+	}
+	ItemDisplay(canvasPtr, itemPtr, canvasPtr->staticPixmap,
+		cacheX1, cacheY1, width, height);
+    }
+    TkCanvasBatchFlush();
+    canvasPtr->staticValid = 1;
+    return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkCanvasStaticDamageItem --
+ *
+ *	Called by item implementations that damage the screen directly via
+ *	Tk_CanvasEventuallyRedraw (rather than going through the canvas
+ *	widget code), to note that the given item's appearance is changing.
+ *	If the item belongs to the retained static layer, the layer's cached
+ *	pixmap is discarded so that it gets rebuilt with the new appearance.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May invalidate the static layer cache.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkCanvasStaticDamageItem(
+    Tk_Canvas canvas,		/* Canvas containing the item. */
+    Tk_Item *itemPtr)		/* Item whose appearance is changing. */
+{
+    TkCanvas *canvasPtr = Canvas(canvas);
+
+    if (canvasPtr->staticValid && ItemIsStatic(canvasPtr, itemPtr)) {
+	canvasPtr->staticValid = 0;
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -3002,8 +4655,9 @@ DisplayCanvas(
     TkCanvas *canvasPtr = (TkCanvas *)clientData;
     Tk_Window tkwin = canvasPtr->tkwin;
     Tk_Item *itemPtr;
-    Pixmap pixmap;
-    int screenX1, screenX2, screenY1, screenY2, width, height;
+    long pixels = 0;
+    int useStatic = 0;
+    Tcl_Time perfStart;
 #ifdef MAC_OSX_TK
     TkWindow *winPtr;
     MacDrawable *macWin;
@@ -3012,6 +4666,8 @@ DisplayCanvas(
     if (canvasPtr->tkwin == NULL) {
 	return;
     }
+    TK_PERF_TIMER_START(&perfStart);
+    TkFrameBudgetStart();
 
     if (!Tk_IsMapped(tkwin)) {
 	goto done;
@@ -3047,191 +4703,368 @@ DisplayCanvas(
     }
 
     /*
-     * Scan through the item list, registering the bounding box for all items
-     * that didn't do that for the final coordinates yet. This can be
-     * determined by the FORCE_REDRAW flag.
+     * Scan through the item list, registering the bounding box for all items
+     * that didn't do that for the final coordinates yet. This can be
+     * determined by the FORCE_REDRAW flag.
+     */
+
+    for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+	    itemPtr = itemPtr->nextPtr) {
+	if (itemPtr->redraw_flags & FORCE_REDRAW) {
+	    itemPtr->redraw_flags &= ~FORCE_REDRAW;
+	    EventuallyRedrawItem(canvasPtr, itemPtr);
+	    itemPtr->redraw_flags &= ~FORCE_REDRAW;
+	}
+    }
+
+    /*
+     * Repaint each accumulated dirty area separately. Bring the static layer
+     * cache up to date first (before any drawable origins are set up below),
+     * so the background items can be copied rather than re-rendered.
+     */
+
+    if ((canvasPtr->redrawX1 < canvasPtr->redrawX2)
+	    && (canvasPtr->redrawY1 < canvasPtr->redrawY2)) {
+	int i;
+
+	if (canvasPtr->staticLayer) {
+	    useStatic = StaticLayerEnsure(canvasPtr);
+	}
+	if (canvasPtr->numDirty > 0) {
+	    for (i = 0; i < canvasPtr->numDirty; i++) {
+		pixels += DisplayRegion(canvasPtr,
+			canvasPtr->dirtyRects[i].x1, canvasPtr->dirtyRects[i].y1,
+			canvasPtr->dirtyRects[i].x2, canvasPtr->dirtyRects[i].y2,
+			useStatic);
+		if ((i + 1 < canvasPtr->numDirty) && TkFrameBudgetCheck()) {
+		    /*
+		     * Out of frame budget with dirty rectangles left. Keep
+		     * the remainder (and all the redraw flags) for the next
+		     * idle pass, which is scheduled directly here because
+		     * REDRAW_PENDING is still set and nothing else will
+		     * schedule it. Pending input gets serviced in between.
+		     */
+
+		    memmove(canvasPtr->dirtyRects,
+			    canvasPtr->dirtyRects + i + 1,
+			    (canvasPtr->numDirty - i - 1)
+			    * sizeof(canvasPtr->dirtyRects[0]));
+		    canvasPtr->numDirty -= i + 1;
+		    Tcl_DoWhenIdle(DisplayCanvas, canvasPtr);
+		    TK_PERF_COUNT(TK_PERF_PIXELS_PAINTED, pixels);
+		    TK_PERF_TIMER_STOP(TK_PERF_TIMER_CANVAS, &perfStart);
+		    return;
+		}
+	    }
+	} else {
+	    pixels += DisplayRegion(canvasPtr, canvasPtr->redrawX1,
+		    canvasPtr->redrawY1, canvasPtr->redrawX2,
+		    canvasPtr->redrawY2, useStatic);
+	}
+    }
+
+    /*
+     * Draw the window borders, if needed.
+     */
+
+    if (canvasPtr->flags & REDRAW_BORDERS) {
+	canvasPtr->flags &= ~REDRAW_BORDERS;
+	if (canvasPtr->borderWidth > 0) {
+	    Tk_Draw3DRectangle(tkwin, Tk_WindowId(tkwin),
+		    canvasPtr->bgBorder, canvasPtr->highlightWidth,
+		    canvasPtr->highlightWidth,
+		    Tk_Width(tkwin) - 2*canvasPtr->highlightWidth,
+		    Tk_Height(tkwin) - 2*canvasPtr->highlightWidth,
+		    canvasPtr->borderWidth, canvasPtr->relief);
+	}
+	if (canvasPtr->highlightWidth != 0) {
+	    GC fgGC, bgGC;
+
+	    bgGC = Tk_GCForColor(canvasPtr->highlightBgColorPtr,
+		    Tk_WindowId(tkwin));
+	    if (canvasPtr->textInfo.gotFocus) {
+		fgGC = Tk_GCForColor(canvasPtr->highlightColorPtr,
+			Tk_WindowId(tkwin));
+	    	TkpDrawHighlightBorder(tkwin, fgGC, bgGC,
+			canvasPtr->highlightWidth, Tk_WindowId(tkwin));
+	    } else {
+	    	TkpDrawHighlightBorder(tkwin, bgGC, bgGC,
+			canvasPtr->highlightWidth, Tk_WindowId(tkwin));
+	    }
+	}
+    }
+
+  done:
+    canvasPtr->flags &= ~(REDRAW_PENDING|BBOX_NOT_EMPTY);
+    canvasPtr->redrawX1 = canvasPtr->redrawX2 = 0;
+    canvasPtr->redrawY1 = canvasPtr->redrawY2 = 0;
+
+    /*
+     * When a script has created the global variable tk_canvasRedraw, record
+     * what this pass painted as "pixels rectangles", so the effect of damage
+     * coalescing can be measured.
      */
 
-    for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
-	    itemPtr = itemPtr->nextPtr) {
-	if (itemPtr->redraw_flags & FORCE_REDRAW) {
-	    itemPtr->redraw_flags &= ~FORCE_REDRAW;
-	    EventuallyRedrawItem(canvasPtr, itemPtr);
-	    itemPtr->redraw_flags &= ~FORCE_REDRAW;
-	}
+    if ((canvasPtr->interp != NULL) && (Tcl_GetVar2(canvasPtr->interp,
+	    "tk_canvasRedraw", NULL, TCL_GLOBAL_ONLY) != NULL)) {
+	Tcl_SetVar2Ex(canvasPtr->interp, "tk_canvasRedraw", NULL,
+		Tcl_ObjPrintf("%ld %d", pixels, canvasPtr->numDirty),
+		TCL_GLOBAL_ONLY);
+    }
+    canvasPtr->numDirty = 0;
+    TK_PERF_COUNT(TK_PERF_PIXELS_PAINTED, pixels);
+    TK_PERF_TIMER_STOP(TK_PERF_TIMER_CANVAS, &perfStart);
+    if (canvasPtr->flags & UPDATE_SCROLLBARS) {
+	CanvasUpdateScrollbars(canvasPtr);
     }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayRegion --
+ *
+ *	Repaint one damaged rectangle of a canvas window: clip it to the
+ *	visible area, then redraw every item overlapping it. Invoked from
+ *	DisplayCanvas once per tracked dirty rectangle.
+ *
+ * Results:
+ *	The number of pixels painted, or 0 if the area was empty or entirely
+ *	off-screen.
+ *
+ * Side effects:
+ *	Information appears on the screen.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static long
+DisplayRegion(
+    TkCanvas *canvasPtr,	/* Information about widget. */
+    int dirtyX1, int dirtyY1,	/* Area needing repaint, in integer canvas
+				 * coordinates. */
+    int dirtyX2, int dirtyY2,
+    int useStatic)		/* Non-zero means the static layer cache is
+				 * valid and may be copied for the
+				 * background. */
+{
+    Tk_Window tkwin = canvasPtr->tkwin;
+    Tk_Item *itemPtr;
+    Pixmap pixmap;
+    SpatialIndex *indexPtr;
+    ItemBatch batch;
+    int screenX1, screenX2, screenY1, screenY2, width, height;
 
     /*
      * Compute the intersection between the area that needs redrawing and the
      * area that's visible on the screen.
      */
 
-    if ((canvasPtr->redrawX1 < canvasPtr->redrawX2)
-	    && (canvasPtr->redrawY1 < canvasPtr->redrawY2)) {
-	screenX1 = canvasPtr->xOrigin + canvasPtr->inset;
-	screenY1 = canvasPtr->yOrigin + canvasPtr->inset;
-	screenX2 = canvasPtr->xOrigin + Tk_Width(tkwin) - canvasPtr->inset;
-	screenY2 = canvasPtr->yOrigin + Tk_Height(tkwin) - canvasPtr->inset;
-	if (canvasPtr->redrawX1 > screenX1) {
-	    screenX1 = canvasPtr->redrawX1;
-	}
-	if (canvasPtr->redrawY1 > screenY1) {
-	    screenY1 = canvasPtr->redrawY1;
-	}
-	if (canvasPtr->redrawX2 < screenX2) {
-	    screenX2 = canvasPtr->redrawX2;
-	}
-	if (canvasPtr->redrawY2 < screenY2) {
-	    screenY2 = canvasPtr->redrawY2;
-	}
-	if ((screenX1 >= screenX2) || (screenY1 >= screenY2)) {
-	    goto borders;
-	}
+    screenX1 = canvasPtr->xOrigin + canvasPtr->inset;
+    screenY1 = canvasPtr->yOrigin + canvasPtr->inset;
+    screenX2 = canvasPtr->xOrigin + Tk_Width(tkwin) - canvasPtr->inset;
+    screenY2 = canvasPtr->yOrigin + Tk_Height(tkwin) - canvasPtr->inset;
+    if (dirtyX1 > screenX1) {
+	screenX1 = dirtyX1;
+    }
+    if (dirtyY1 > screenY1) {
+	screenY1 = dirtyY1;
+    }
+    if (dirtyX2 < screenX2) {
+	screenX2 = dirtyX2;
+    }
+    if (dirtyY2 < screenY2) {
+	screenY2 = dirtyY2;
+    }
+    if ((screenX1 >= screenX2) || (screenY1 >= screenY2)) {
+	return 0;
+    }
 
-	width = screenX2 - screenX1;
-	height = screenY2 - screenY1;
+    width = screenX2 - screenX1;
+    height = screenY2 - screenY1;
 
 #ifndef TK_NO_DOUBLE_BUFFERING
-	/*
-	 * Redrawing is done in a temporary pixmap that is allocated here and
-	 * freed at the end of the function. All drawing is done to the
-	 * pixmap, and the pixmap is copied to the screen at the end of the
-	 * function. The temporary pixmap serves two purposes:
-	 *
-	 * 1. It provides a smoother visual effect (no clearing and gradual
-	 *    redraw will be visible to users).
-	 * 2. It allows us to redraw only the objects that overlap the redraw
-	 *    area. Otherwise incorrect results could occur from redrawing
-	 *    things that stick outside of the redraw area (we'd have to
-	 *    redraw everything in order to make the overlaps look right).
-	 *
-	 * Some tricky points about the pixmap:
-	 *
-	 * 1. We only allocate a large enough pixmap to hold the area that has
-	 *    to be redisplayed. This saves time in in the X server for large
-	 *    objects that cover much more than the area being redisplayed:
-	 *    only the area of the pixmap will actually have to be redrawn.
-	 * 2. Some X servers (e.g. the one for DECstations) have troubles with
-	 *    with characters that overlap an edge of the pixmap (on the DEC
-	 *    servers, as of 8/18/92, such characters are drawn one pixel too
-	 *    far to the right). To handle this problem, make the pixmap a bit
-	 *    larger than is absolutely needed so that for normal-sized fonts
-	 *    the characters that overlap the edge of the pixmap will be
-	 *    outside the area we care about.
-	 */
+    /*
+     * Redrawing is done in a temporary pixmap that is allocated here and
+     * freed at the end of the function. All drawing is done to the pixmap,
+     * and the pixmap is copied to the screen at the end of the function. The
+     * temporary pixmap serves two purposes:
+     *
+     * 1. It provides a smoother visual effect (no clearing and gradual
+     *    redraw will be visible to users).
+     * 2. It allows us to redraw only the objects that overlap the redraw
+     *    area. Otherwise incorrect results could occur from redrawing
+     *    things that stick outside of the redraw area (we'd have to
+     *    redraw everything in order to make the overlaps look right).
+     *
+     * Some tricky points about the pixmap:
+     *
+     * 1. We only allocate a large enough pixmap to hold the area that has
+     *    to be redisplayed. This saves time in in the X server for large
+     *    objects that cover much more than the area being redisplayed:
+     *    only the area of the pixmap will actually have to be redrawn.
+     * 2. Some X servers (e.g. the one for DECstations) have troubles with
+     *    with characters that overlap an edge of the pixmap (on the DEC
+     *    servers, as of 8/18/92, such characters are drawn one pixel too
+     *    far to the right). To handle this problem, make the pixmap a bit
+     *    larger than is absolutely needed so that for normal-sized fonts
+     *    the characters that overlap the edge of the pixmap will be
+     *    outside the area we care about.
+     */
 
-	canvasPtr->drawableXOrigin = screenX1 - 30;
-	canvasPtr->drawableYOrigin = screenY1 - 30;
-	pixmap = Tk_GetPixmap(Tk_Display(tkwin), Tk_WindowId(tkwin),
+    canvasPtr->drawableXOrigin = screenX1 - 30;
+    canvasPtr->drawableYOrigin = screenY1 - 30;
+    pixmap = Tk_GetPixmap(Tk_Display(tkwin), Tk_WindowId(tkwin),
 	    (screenX2 + 30 - canvasPtr->drawableXOrigin),
 	    (screenY2 + 30 - canvasPtr->drawableYOrigin),
 	    Tk_Depth(tkwin));
 #else
-	canvasPtr->drawableXOrigin = canvasPtr->xOrigin;
-	canvasPtr->drawableYOrigin = canvasPtr->yOrigin;
-	pixmap = Tk_WindowId(tkwin);
-	TkpClipDrawableToRect(Tk_Display(tkwin), pixmap,
-		screenX1 - canvasPtr->xOrigin, screenY1 - canvasPtr->yOrigin,
-		width, height);
+    canvasPtr->drawableXOrigin = canvasPtr->xOrigin;
+    canvasPtr->drawableYOrigin = canvasPtr->yOrigin;
+    pixmap = Tk_WindowId(tkwin);
+    TkpClipDrawableToRect(Tk_Display(tkwin), pixmap,
+	    screenX1 - canvasPtr->xOrigin, screenY1 - canvasPtr->yOrigin,
+	    width, height);
 #endif /* TK_NO_DOUBLE_BUFFERING */
 
-	/*
-	 * Clear the area to be redrawn.
-	 */
+    /*
+     * Clear the area to be redrawn: either with the retained rendering of
+     * the static layer, or with the background color.
+     */
+
+    if (useStatic) {
+	Tcl_Time perfStart;
 
+	TK_PERF_TIMER_START(&perfStart);
+	XCopyArea(Tk_Display(tkwin), canvasPtr->staticPixmap, pixmap,
+		canvasPtr->pixmapGC,
+		screenX1 - canvasPtr->staticXOrigin,
+		screenY1 - canvasPtr->staticYOrigin,
+		(unsigned int) width, (unsigned int) height,
+		screenX1 - canvasPtr->drawableXOrigin,
+		screenY1 - canvasPtr->drawableYOrigin);
+	TK_PERF_XRECORD(canvasPtr->tkwin, "copyarea",
+		(unsigned int) width * (unsigned int) height * 4, &perfStart);
+    } else {
 	XFillRectangle(Tk_Display(tkwin), pixmap, canvasPtr->pixmapGC,
 		screenX1 - canvasPtr->drawableXOrigin,
 		screenY1 - canvasPtr->drawableYOrigin, (unsigned int) width,
 		(unsigned int) height);
+    }
 
-	/*
-	 * Scan through the item list, redrawing those items that need it. An
-	 * item must be redraw if either (a) it intersects the smaller
-	 * on-screen area or (b) it intersects the full canvas area and its
-	 * type requests that it be redrawn always (e.g. so subwindows can be
-	 * unmapped when they move off-screen).
-	 */
+    /*
+     * Scan through the item list, redrawing those items that need it. An
+     * item must be redraw if either (a) it intersects the smaller on-screen
+     * area or (b) it intersects the full canvas area and its type requests
+     * that it be redrawn always (e.g. so subwindows can be unmapped when
+     * they move off-screen).
+     */
 
-	for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
-		itemPtr = itemPtr->nextPtr) {
+    batch.count = 0;
+    indexPtr = SpatialIndexGet(canvasPtr);
+    if (indexPtr->numCells > 0 && !indexPtr->anyAlwaysRedraw) {
+	Tk_Item **items;
+	int i, numFound = SpatialIndexQuery(indexPtr, screenX1, screenY1,
+		screenX2, screenY2, &items);
+
+	for (i = 0; i < numFound; i++) {
+	    itemPtr = items[i];
 	    if ((itemPtr->x1 >= screenX2)
 		    || (itemPtr->y1 >= screenY2)
 		    || (itemPtr->x2 < screenX1)
 		    || (itemPtr->y2 < screenY1)) {
-		if (!AlwaysRedraw(itemPtr)
-			|| (itemPtr->x1 >= canvasPtr->redrawX2)
-			|| (itemPtr->y1 >= canvasPtr->redrawY2)
-			|| (itemPtr->x2 < canvasPtr->redrawX1)
-			|| (itemPtr->y2 < canvasPtr->redrawY1)) {
-		    continue;
-		}
+		continue;
 	    }
 	    if (itemPtr->state == TK_STATE_HIDDEN ||
 		    (itemPtr->state == TK_STATE_NULL &&
 		    canvasPtr->canvas_state == TK_STATE_HIDDEN)) {
 		continue;
 	    }
-	    ItemDisplay(canvasPtr, itemPtr, pixmap, screenX1, screenY1, width,
-		    height);
+	    if (useStatic && ItemIsStatic(canvasPtr, itemPtr)) {
+		continue;
+	    }
+
+	    /*
+	     * A level-of-detail point is drawn immediately, so any batched
+	     * items below it in the stacking order must be flushed first.
+	     */
+
+	    if (canvasPtr->lodThreshold > 0) {
+		FlushDisplayBatch(canvasPtr, &batch, pixmap, screenX1,
+			screenY1, width, height);
+	    }
+	    if (ItemDisplayLod(canvasPtr, itemPtr, pixmap, screenX1,
+		    screenY1)) {
+		continue;
+	    }
+	    ItemDisplayBatched(canvasPtr, itemPtr, &batch, pixmap, screenX1,
+		    screenY1, width, height);
+	}
+	if (items != NULL) {
+	    ckfree(items);
+	}
+    } else
+    for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
+	    itemPtr = itemPtr->nextPtr) {
+	if ((itemPtr->x1 >= screenX2)
+		|| (itemPtr->y1 >= screenY2)
+		|| (itemPtr->x2 < screenX1)
+		|| (itemPtr->y2 < screenY1)) {
+	    if (!AlwaysRedraw(itemPtr)
+		    || (itemPtr->x1 >= canvasPtr->redrawX2)
+		    || (itemPtr->y1 >= canvasPtr->redrawY2)
+		    || (itemPtr->x2 < canvasPtr->redrawX1)
+		    || (itemPtr->y2 < canvasPtr->redrawY1)) {
+		continue;
+	    }
+	}
+	if (itemPtr->state == TK_STATE_HIDDEN ||
+		(itemPtr->state == TK_STATE_NULL &&
+		canvasPtr->canvas_state == TK_STATE_HIDDEN)) {
+	    continue;
+	}
+	if (useStatic && ItemIsStatic(canvasPtr, itemPtr)) {
+	    continue;
+	}
+	if (canvasPtr->lodThreshold > 0) {
+	    FlushDisplayBatch(canvasPtr, &batch, pixmap, screenX1, screenY1,
+		    width, height);
 	}
+	if (ItemDisplayLod(canvasPtr, itemPtr, pixmap, screenX1, screenY1)) {
+	    continue;
+	}
+	ItemDisplayBatched(canvasPtr, itemPtr, &batch, pixmap, screenX1,
+		screenY1, width, height);
+    }
+    FlushDisplayBatch(canvasPtr, &batch, pixmap, screenX1, screenY1, width,
+	    height);
+    TkCanvasBatchFlush();
 
 #ifndef TK_NO_DOUBLE_BUFFERING
-	/*
-	 * Copy from the temporary pixmap to the screen, then free up the
-	 * temporary pixmap.
-	 */
+    /*
+     * Copy from the temporary pixmap to the screen, then free up the
+     * temporary pixmap.
+     */
+
+    {
+	Tcl_Time perfStart;
 
+	TK_PERF_TIMER_START(&perfStart);
 	XCopyArea(Tk_Display(tkwin), pixmap, Tk_WindowId(tkwin),
 		canvasPtr->pixmapGC,
 		screenX1 - canvasPtr->drawableXOrigin,
 		screenY1 - canvasPtr->drawableYOrigin,
 		(unsigned int) width, (unsigned int) height,
 		screenX1 - canvasPtr->xOrigin, screenY1 - canvasPtr->yOrigin);
-	Tk_FreePixmap(Tk_Display(tkwin), pixmap);
+	TK_PERF_XRECORD(canvasPtr->tkwin, "copyarea",
+		(unsigned int) width * (unsigned int) height * 4, &perfStart);
+    }
+    Tk_FreePixmap(Tk_Display(tkwin), pixmap);
 #else
-	TkpClipDrawableToRect(Tk_Display(tkwin), pixmap, 0, 0, -1, -1);
+    TkpClipDrawableToRect(Tk_Display(tkwin), pixmap, 0, 0, -1, -1);
 #endif /* TK_NO_DOUBLE_BUFFERING */
-    }
-
-    /*
-     * Draw the window borders, if needed.
-     */
-
-  borders:
-    if (canvasPtr->flags & REDRAW_BORDERS) {
-	canvasPtr->flags &= ~REDRAW_BORDERS;
-	if (canvasPtr->borderWidth > 0) {
-	    Tk_Draw3DRectangle(tkwin, Tk_WindowId(tkwin),
-		    canvasPtr->bgBorder, canvasPtr->highlightWidth,
-		    canvasPtr->highlightWidth,
-		    Tk_Width(tkwin) - 2*canvasPtr->highlightWidth,
-		    Tk_Height(tkwin) - 2*canvasPtr->highlightWidth,
-		    canvasPtr->borderWidth, canvasPtr->relief);
-	}
-	if (canvasPtr->highlightWidth != 0) {
-	    GC fgGC, bgGC;
-
-	    bgGC = Tk_GCForColor(canvasPtr->highlightBgColorPtr,
-		    Tk_WindowId(tkwin));
-	    if (canvasPtr->textInfo.gotFocus) {
-		fgGC = Tk_GCForColor(canvasPtr->highlightColorPtr,
-			Tk_WindowId(tkwin));
-	    	TkpDrawHighlightBorder(tkwin, fgGC, bgGC,
-			canvasPtr->highlightWidth, Tk_WindowId(tkwin));
-	    } else {
-	    	TkpDrawHighlightBorder(tkwin, bgGC, bgGC,
-			canvasPtr->highlightWidth, Tk_WindowId(tkwin));
-	    }
-	}
-    }
 
-  done:
-    canvasPtr->flags &= ~(REDRAW_PENDING|BBOX_NOT_EMPTY);
-    canvasPtr->redrawX1 = canvasPtr->redrawX2 = 0;
-    canvasPtr->redrawY1 = canvasPtr->redrawY2 = 0;
-    if (canvasPtr->flags & UPDATE_SCROLLBARS) {
-	CanvasUpdateScrollbars(canvasPtr);
-    }
+    return (long) width * height;
 }
 
 /*
@@ -3363,6 +5196,84 @@ CanvasCmdDeletedProc(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * AddDirtyRect --
+ *
+ *	Record one damaged area in the canvas's dirty rectangle list. The new
+ *	area is merged with a tracked rectangle when doing so wastes no
+ *	pixels (they overlap or nest), or when the list is full; otherwise it
+ *	gets its own entry so that distant small updates are repainted
+ *	separately.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	canvasPtr->dirtyRects and canvasPtr->numDirty are updated.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+AddDirtyRect(
+    TkCanvas *canvasPtr,	/* Information about widget. */
+    int x1, int y1,		/* Upper left corner of damaged area. Pixels
+				 * on edge are redrawn. */
+    int x2, int y2)		/* Lower right corner of damaged area. Pixels
+				 * on edge are not redrawn. */
+{
+    TkCanvasDirtyRect *rectPtr;
+    int i, best, ux1, uy1, ux2, uy2;
+    double waste, bestWaste = 0.0;
+
+    /*
+     * Find the tracked rectangle whose union with the new area wastes the
+     * fewest pixels. Areas are computed in floating point so huge scroll
+     * regions cannot overflow.
+     */
+
+    best = -1;
+    for (i = 0; i < canvasPtr->numDirty; i++) {
+	rectPtr = &canvasPtr->dirtyRects[i];
+	ux1 = (x1 < rectPtr->x1) ? x1 : rectPtr->x1;
+	uy1 = (y1 < rectPtr->y1) ? y1 : rectPtr->y1;
+	ux2 = (x2 > rectPtr->x2) ? x2 : rectPtr->x2;
+	uy2 = (y2 > rectPtr->y2) ? y2 : rectPtr->y2;
+	waste = (double) (ux2 - ux1) * (uy2 - uy1)
+		- (double) (rectPtr->x2 - rectPtr->x1)
+		    * (rectPtr->y2 - rectPtr->y1)
+		- (double) (x2 - x1) * (y2 - y1);
+	if ((best < 0) || (waste < bestWaste)) {
+	    best = i;
+	    bestWaste = waste;
+	}
+    }
+    if ((best >= 0) && ((bestWaste <= 0.0)
+	    || (canvasPtr->numDirty >= TK_CANVAS_DIRTY_MAX))) {
+	rectPtr = &canvasPtr->dirtyRects[best];
+	if (x1 < rectPtr->x1) {
+	    rectPtr->x1 = x1;
+	}
+	if (y1 < rectPtr->y1) {
+	    rectPtr->y1 = y1;
+	}
+	if (x2 > rectPtr->x2) {
+	    rectPtr->x2 = x2;
+	}
+	if (y2 > rectPtr->y2) {
+	    rectPtr->y2 = y2;
+	}
+	return;
+    }
+    rectPtr = &canvasPtr->dirtyRects[canvasPtr->numDirty++];
+    rectPtr->x1 = x1;
+    rectPtr->y1 = y1;
+    rectPtr->x2 = x2;
+    rectPtr->y2 = y2;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -3390,6 +5301,13 @@ Tk_CanvasEventuallyRedraw(
 {
     TkCanvas *canvasPtr = Canvas(canvas);
 
+    /*
+     * Item implementations call this when their geometry changes, so any
+     * cached spatial index is stale from here on.
+     */
+
+    SpatialIndexInvalidate(canvasPtr);
+
     /*
      * If tkwin is NULL, the canvas has been destroyed, so we can't really
      * redraw it.
@@ -3425,6 +5343,7 @@ Tk_CanvasEventuallyRedraw(
 	canvasPtr->redrawY2 = y2;
 	canvasPtr->flags |= BBOX_NOT_EMPTY;
     }
+    AddDirtyRect(canvasPtr, x1, y1, x2, y2);
     if (!(canvasPtr->flags & REDRAW_PENDING)) {
 	Tcl_DoWhenIdle(DisplayCanvas, canvasPtr);
 	canvasPtr->flags |= REDRAW_PENDING;
@@ -3454,7 +5373,23 @@ EventuallyRedrawItem(
     Tk_Item *itemPtr)		/* Item to be redrawn. May be NULL, in which
 				 * case nothing happens. */
 {
-    if (itemPtr == NULL || canvasPtr->tkwin == NULL) {
+    if (itemPtr == NULL) {
+	return;
+    }
+
+    /*
+     * A call here means some item's geometry, state or stacking order is
+     * changing, so a previously built spatial index can't be trusted. Note
+     * that this must happen even when the item is entirely off-screen. For
+     * the same reason any snapshot captured earlier is now out of date.
+     */
+
+    SpatialIndexInvalidate(canvasPtr);
+    canvasPtr->snapshotGen++;
+    if (canvasPtr->staticValid && ItemIsStatic(canvasPtr, itemPtr)) {
+	canvasPtr->staticValid = 0;
+    }
+    if (canvasPtr->tkwin == NULL) {
 	return;
     }
     if ((itemPtr->x1 >= itemPtr->x2) || (itemPtr->y1 >= itemPtr->y2) ||
@@ -3487,6 +5422,8 @@ EventuallyRedrawItem(
 	    canvasPtr->redrawY2 = itemPtr->y2;
 	    canvasPtr->flags |= BBOX_NOT_EMPTY;
 	}
+	AddDirtyRect(canvasPtr, itemPtr->x1, itemPtr->y1, itemPtr->x2,
+		itemPtr->y2);
 	itemPtr->redraw_flags |= FORCE_REDRAW;
     }
     if (!(canvasPtr->flags & REDRAW_PENDING)) {
@@ -3611,7 +5548,8 @@ InitCanvas(void)
     tkOvalType.nextPtr = &tkBitmapType;
     tkBitmapType.nextPtr = &tkArcType;
     tkArcType.nextPtr = &tkWindowType;
-    tkWindowType.nextPtr = NULL;
+    tkWindowType.nextPtr = &tkControlType;
+    tkControlType.nextPtr = NULL;
     Tcl_MutexUnlock(&typeListMutex);
 }
 
@@ -3794,6 +5732,7 @@ TagSearchScan(
     searchPtr->canvasPtr = canvasPtr;
     searchPtr->searchOver = 0;
     searchPtr->type = SEARCH_TYPE_EMPTY;
+    searchPtr->indexItems = NULL;
 
     /*
      * Find the first matching item in one of several ways. If the tag is a
@@ -3818,7 +5757,7 @@ TagSearchScan(
      * memory leak.
      */
 
-    searchPtr->expr->uid = Tk_GetUid(tag);
+    searchPtr->expr->uid = TkGetUidFromObj(tagObj);
 
     /*
      * Short circuit impossible searches for null tags.
@@ -3857,21 +5796,65 @@ TagSearchScan(
     searchPtr->string = tag;
     searchPtr->stringIndex = 0;
     if (searchPtr->type == SEARCH_TYPE_EXPR) {
+	Tcl_HashEntry *hPtr;
+	TagSearchExpr *cachedPtr;
+	int isNew;
+
 	/*
-	 * An operator was found in the prescan, so now compile the tag
-	 * expression into array of Tk_Uid flagging any syntax errors found.
+	 * An operator was found in the prescan. A tag expression compiles to
+	 * a pure function of its string, so see whether this canvas has
+	 * compiled the same expression before and reuse the uid array if so;
+	 * only expressions seen for the first time pay for a parse.
 	 */
 
+	hPtr = Tcl_CreateHashEntry(&canvasPtr->tagExprTable,
+		(char *) searchPtr->expr->uid, &isNew);
+	if (!isNew) {
+	    cachedPtr = (TagSearchExpr *)Tcl_GetHashValue(hPtr);
+	    if (searchPtr->expr->allocated < cachedPtr->length) {
+		searchPtr->expr->allocated = cachedPtr->length;
+		if (searchPtr->expr->uids) {
+		    ckfree(searchPtr->expr->uids);
+		}
+		searchPtr->expr->uids = (Tk_Uid *)
+			ckalloc(cachedPtr->length * sizeof(Tk_Uid));
+	    }
+	    if (cachedPtr->length > 0) {
+		memcpy(searchPtr->expr->uids, cachedPtr->uids,
+			cachedPtr->length * sizeof(Tk_Uid));
+	    }
+	    searchPtr->expr->length = cachedPtr->length;
+	    return TCL_OK;
+	}
 	if (TagSearchScanExpr(canvasPtr->interp, searchPtr,
 		searchPtr->expr) != TCL_OK) {
 	    /*
 	     * Syntax error in tag expression. The result message was set by
-	     * TagSearchScanExpr.
+	     * TagSearchScanExpr. Don't cache failures: the entry would only
+	     * pin the error case in the table.
 	     */
 
+	    Tcl_DeleteHashEntry(hPtr);
 	    return TCL_ERROR;
 	}
 	searchPtr->expr->length = searchPtr->expr->index;
+
+	/*
+	 * Stash a private copy of the compiled expression for future scans.
+	 */
+
+	cachedPtr = NULL;
+	TagSearchExprInit(&cachedPtr);
+	cachedPtr->uid = searchPtr->expr->uid;
+	cachedPtr->length = searchPtr->expr->length;
+	if (cachedPtr->length > 0) {
+	    cachedPtr->allocated = cachedPtr->length;
+	    cachedPtr->uids = (Tk_Uid *)
+		    ckalloc(cachedPtr->length * sizeof(Tk_Uid));
+	    memcpy(cachedPtr->uids, searchPtr->expr->uids,
+		    cachedPtr->length * sizeof(Tk_Uid));
+	}
+	Tcl_SetHashValue(hPtr, cachedPtr);
     } else if (searchPtr->expr->uid == GetStaticUids()->allUid) {
 	/*
 	 * All items match.
@@ -4404,11 +6387,38 @@ TagSearchFirst(
     }
 
     if (searchPtr->type == SEARCH_TYPE_TAG) {
+	TagIndexEntry *indexEntryPtr;
+
+	uid = searchPtr->expr->uid;
+
+	/*
+	 * Try the per-tag membership index first, so the search touches only
+	 * the items that actually carry the tag. The captured array stays in
+	 * use for as long as the canvas is unchanged; TagSearchNext reverts
+	 * to the item list walk below as soon as the epoch moves.
+	 */
+
+	indexEntryPtr = TagIndexGet(searchPtr->canvasPtr, uid);
+	if (indexEntryPtr != NULL) {
+	    searchPtr->indexItems = indexEntryPtr->items;
+	    searchPtr->indexCount = indexEntryPtr->numItems;
+	    searchPtr->indexEpoch = searchPtr->canvasPtr->tagIndexEpoch;
+	    if (indexEntryPtr->numItems == 0) {
+		searchPtr->lastPtr = NULL;
+		searchPtr->searchOver = 1;
+		return NULL;
+	    }
+	    itemPtr = indexEntryPtr->items[0];
+	    searchPtr->indexPos = 1;
+	    searchPtr->lastPtr = itemPtr->prevPtr;
+	    searchPtr->currentPtr = itemPtr;
+	    return itemPtr;
+	}
+
 	/*
 	 * Optimized single-tag search
 	 */
 
-	uid = searchPtr->expr->uid;
 	for (lastPtr = NULL, itemPtr = searchPtr->canvasPtr->firstItemPtr;
 		itemPtr != NULL; lastPtr=itemPtr, itemPtr=itemPtr->nextPtr) {
 	    for (tagPtr = itemPtr->tagPtr, count = (int)itemPtr->numTags;
@@ -4469,6 +6479,31 @@ TagSearchNext(
     Tk_Uid uid, *tagPtr;
     int count;
 
+    /*
+     * Serve single-tag searches from the captured membership array for as
+     * long as the canvas is unchanged. lastPtr and currentPtr are kept
+     * exactly as the item list walk would have left them, so on any epoch
+     * change the code below resumes seamlessly.
+     */
+
+    if (searchPtr->indexItems != NULL) {
+	if (searchPtr->indexEpoch !=
+		searchPtr->canvasPtr->tagIndexEpoch) {
+	    searchPtr->indexItems = NULL;
+	} else if (searchPtr->searchOver) {
+	    return NULL;
+	} else if (searchPtr->indexPos >= searchPtr->indexCount) {
+	    searchPtr->lastPtr = NULL;
+	    searchPtr->searchOver = 1;
+	    return NULL;
+	} else {
+	    itemPtr = searchPtr->indexItems[searchPtr->indexPos++];
+	    searchPtr->lastPtr = itemPtr->prevPtr;
+	    searchPtr->currentPtr = itemPtr;
+	    return itemPtr;
+	}
+    }
+
     /*
      * Find next item in list (this may not actually be a suitable one to
      * return), and return if there are no items left.
@@ -4565,6 +6600,9 @@ TagSearchNext(
 
 static void
 DoItem(
+    TkCanvas *canvasPtr,	/* Canvas containing the item; needed so the
+				 * tag index can be invalidated when a tag is
+				 * added. */
     Tcl_Obj *accumObj,		/* Object in which to (possibly) record item
 				 * id. */
     Tk_Item *itemPtr,		/* Item to (possibly) modify. */
@@ -4614,6 +6652,10 @@ DoItem(
 
     *tagPtr = tag;
     itemPtr->numTags++;
+    TagIndexInvalidate(canvasPtr);
+    if (tag == canvasPtr->staticUid) {
+	canvasPtr->staticValid = 0;
+    }
 }
 
 /*
@@ -4672,7 +6714,7 @@ FindItems(
     };
 
     if (newTag != NULL) {
-	uid = Tk_GetUid(Tcl_GetString(newTag));
+	uid = TkGetUidFromObj(newTag);
     } else {
 	uid = NULL;
     }
@@ -4694,7 +6736,7 @@ FindItems(
 	}
 	if ((lastPtr != NULL) && (lastPtr->nextPtr != NULL)) {
 	    resultObj = Tcl_NewObj();
-	    DoItem(resultObj, lastPtr->nextPtr, uid);
+	    DoItem(canvasPtr, resultObj, lastPtr->nextPtr, uid);
 	    Tcl_SetObjResult(interp, resultObj);
 	}
 	break;
@@ -4708,7 +6750,7 @@ FindItems(
 	resultObj = Tcl_NewObj();
 	for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
 		itemPtr = itemPtr->nextPtr) {
-	    DoItem(resultObj, itemPtr, uid);
+	    DoItem(canvasPtr, resultObj, itemPtr, uid);
 	}
 	Tcl_SetObjResult(interp, resultObj);
 	break;
@@ -4722,7 +6764,7 @@ FindItems(
 		return TCL_ERROR);
 	if ((itemPtr != NULL) && (itemPtr->prevPtr != NULL)) {
 	    resultObj = Tcl_NewObj();
-	    DoItem(resultObj, itemPtr->prevPtr, uid);
+	    DoItem(canvasPtr, resultObj, itemPtr->prevPtr, uid);
 	    Tcl_SetObjResult(interp, resultObj);
 	}
 	break;
@@ -4814,7 +6856,7 @@ FindItems(
 		}
 		if (itemPtr == startPtr) {
 		    resultObj = Tcl_NewObj();
-		    DoItem(resultObj, closestPtr, uid);
+		    DoItem(canvasPtr, resultObj, closestPtr, uid);
 		    Tcl_SetObjResult(interp, resultObj);
 		    return TCL_OK;
 		}
@@ -4856,7 +6898,7 @@ FindItems(
 	resultObj = Tcl_NewObj();
 	FOR_EVERY_CANVAS_ITEM_MATCHING(objv[first+1], searchPtrPtr,
 		goto badWithTagSearch) {
-	    DoItem(resultObj, itemPtr, uid);
+	    DoItem(canvasPtr, resultObj, itemPtr, uid);
 	}
 	Tcl_SetObjResult(interp, resultObj);
 	return TCL_OK;
@@ -4908,6 +6950,7 @@ FindArea(
     int x1, y1, x2, y2;
     Tk_Item *itemPtr;
     Tcl_Obj *resultObj;
+    SpatialIndex *indexPtr;
 
     if ((Tk_CanvasGetCoordFromObj(interp, (Tk_Canvas) canvasPtr, objv[0],
 		&rect[0]) != TCL_OK)
@@ -4936,6 +6979,32 @@ FindArea(
     x2 = (int) (rect[2] + 1.0);
     y2 = (int) (rect[3] + 1.0);
     resultObj = Tcl_NewObj();
+    indexPtr = SpatialIndexGet(canvasPtr);
+    if (indexPtr->numCells > 0) {
+	Tk_Item **items;
+	int i, numFound = SpatialIndexQuery(indexPtr, x1, y1, x2, y2, &items);
+
+	for (i = 0; i < numFound; i++) {
+	    itemPtr = items[i];
+	    if (itemPtr->state == TK_STATE_HIDDEN ||
+		    (itemPtr->state == TK_STATE_NULL
+		    && canvasPtr->canvas_state == TK_STATE_HIDDEN)) {
+		continue;
+	    }
+	    if ((itemPtr->x1 >= x2) || (itemPtr->x2 <= x1)
+		    || (itemPtr->y1 >= y2) || (itemPtr->y2 <= y1)) {
+		continue;
+	    }
+	    if (ItemOverlap(canvasPtr, itemPtr, rect) >= enclosed) {
+		DoItem(canvasPtr, resultObj, itemPtr, uid);
+	    }
+	}
+	if (items != NULL) {
+	    ckfree(items);
+	}
+	Tcl_SetObjResult(interp, resultObj);
+	return TCL_OK;
+    }
     for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
 	    itemPtr = itemPtr->nextPtr) {
 	if (itemPtr->state == TK_STATE_HIDDEN ||
@@ -4948,7 +7017,7 @@ FindArea(
 	    continue;
 	}
 	if (ItemOverlap(canvasPtr, itemPtr, rect) >= enclosed) {
-	    DoItem(resultObj, itemPtr, uid);
+	    DoItem(canvasPtr, resultObj, itemPtr, uid);
 	}
     }
     Tcl_SetObjResult(interp, resultObj);
@@ -4988,6 +7057,15 @@ RelinkItems(
     Tk_Item *firstMovePtr, *lastMovePtr;
     int result;
 
+    /*
+     * The display list order is about to change, which invalidates the
+     * ordering baked into any cached spatial or tag index.
+     */
+
+    SpatialIndexInvalidate(canvasPtr);
+    TagIndexInvalidate(canvasPtr);
+    canvasPtr->staticValid = 0;
+
     /*
      * Find all of the items to be moved and remove them from the list, making
      * an auxiliary list running from firstMovePtr to lastMovePtr. Record
@@ -5310,6 +7388,7 @@ PickCurrentItem(
                             itemPtr->tagPtr + i + 1,
                             (itemPtr->numTags - (i+1)) * sizeof(Tk_Uid));
 		    itemPtr->numTags--;
+		    TagIndexInvalidate(canvasPtr);
 		    break;
 		}
 	    }
@@ -5343,7 +7422,8 @@ PickCurrentItem(
     if (canvasPtr->currentItemPtr != NULL) {
 	XEvent event;
 
-	DoItem(NULL, canvasPtr->currentItemPtr, searchUids->currentUid);
+	DoItem(canvasPtr, NULL, canvasPtr->currentItemPtr,
+		searchUids->currentUid);
 	if ((canvasPtr->currentItemPtr->redraw_flags & TK_ITEM_STATE_DEPENDANT
 		&& prevItemPtr != canvasPtr->currentItemPtr)) {
 	    ItemConfigure(canvasPtr, canvasPtr->currentItemPtr, 0, NULL);
@@ -5384,6 +7464,7 @@ CanvasFindClosest(
     Tk_Item *itemPtr;
     Tk_Item *bestPtr;
     int x1, y1, x2, y2;
+    SpatialIndex *indexPtr;
 
     x1 = (int) (coords[0] - canvasPtr->closeEnough);
     y1 = (int) (coords[1] - canvasPtr->closeEnough);
@@ -5391,6 +7472,30 @@ CanvasFindClosest(
     y2 = (int) (coords[1] + canvasPtr->closeEnough);
 
     bestPtr = NULL;
+    indexPtr = SpatialIndexGet(canvasPtr);
+    if (indexPtr->numCells > 0) {
+	Tk_Item **items;
+	int i, numFound = SpatialIndexQuery(indexPtr, x1, y1, x2, y2, &items);
+
+	for (i = 0; i < numFound; i++) {
+	    itemPtr = items[i];
+	    if (itemPtr->state == TK_STATE_HIDDEN ||
+		    itemPtr->state==TK_STATE_DISABLED ||
+		    (itemPtr->state == TK_STATE_NULL &&
+		    (canvasPtr->canvas_state == TK_STATE_HIDDEN ||
+		    canvasPtr->canvas_state == TK_STATE_DISABLED))) {
+		continue;
+	    }
+	    if (ItemPoint(canvasPtr, itemPtr, coords, 0)
+		    <= canvasPtr->closeEnough) {
+		bestPtr = itemPtr;
+	    }
+	}
+	if (items != NULL) {
+	    ckfree(items);
+	}
+	return bestPtr;
+    }
     for (itemPtr = canvasPtr->firstItemPtr; itemPtr != NULL;
 	    itemPtr = itemPtr->nextPtr) {
 	if (itemPtr->state == TK_STATE_HIDDEN ||
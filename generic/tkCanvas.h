@@ -35,6 +35,41 @@ struct TagSearchExpr_s {
 };
 #endif /* not USE_OLD_TAG_SEARCH */
 
+/*
+ * Each structure below heads a free list of item records of one particular
+ * size. Freed records are chained through their first word and handed back
+ * out by subsequent item creations, so streaming workloads that create and
+ * destroy items continuously stay out of the general-purpose allocator. The
+ * number of distinct record sizes in play equals the number of item types in
+ * use, which is small.
+ */
+
+typedef struct TkCanvasItemPool {
+    TkSizeT itemSize;		/* Size of the records on this free list, or
+				 * 0 if the slot is unused. */
+    void *firstFreePtr;		/* First record on the free list, chained
+				 * through the first word of each record. */
+    int numFree;		/* Number of records on the free list. */
+} TkCanvasItemPool;
+
+#define TK_CANVAS_ITEM_POOL_SIZES 8
+
+/*
+ * Each structure below records one damaged area awaiting repaint. The redraw
+ * scheduler keeps a short list of these so that two small updates in distant
+ * parts of the window need not be repainted through their common bounding
+ * rectangle.
+ */
+
+typedef struct TkCanvasDirtyRect {
+    int x1, y1;			/* Upper left corner, in integer canvas
+				 * coordinates. Pixels on edge are redrawn. */
+    int x2, y2;			/* Lower right corner. Pixels on edge are not
+				 * redrawn. */
+} TkCanvasDirtyRect;
+
+#define TK_CANVAS_DIRTY_MAX 8
+
 /*
  * The record below describes a canvas widget. It is made available to the
  * item functions so they can access certain shared fields such as the overall
@@ -87,8 +122,25 @@ typedef struct TkCanvas {
     int redrawX2, redrawY2;	/* Lower right corner of area to redraw, in
 				 * integer canvas coordinates. Border pixels
 				 * will *not* be redrawn. */
+    TkCanvasDirtyRect dirtyRects[TK_CANVAS_DIRTY_MAX];
+				/* Independent areas needing redraw. The
+				 * bounding box above always covers all of
+				 * them; this list lets distant small updates
+				 * be repainted separately instead of through
+				 * one huge rectangle. Only valid if
+				 * REDRAW_PENDING flag is set. */
+    int numDirty;		/* Number of valid entries in dirtyRects. */
     int confine;		/* Non-zero means constrain view to keep as
 				 * much of canvas visible as possible. */
+    int lodThreshold;		/* If > 0, items whose bounding box is
+				 * smaller than this many pixels in both
+				 * dimensions are drawn as a single point of
+				 * lodColor rather than fully rendered. Zero
+				 * disables the reduction. */
+    XColor *lodColor;		/* Color of the stand-in point drawn for
+				 * items below lodThreshold. */
+    GC lodGC;			/* Graphics context for drawing those
+				 * points. */
 
     /*
      * Information used to manage the selection and insertion cursor:
@@ -201,6 +253,11 @@ typedef struct TkCanvas {
 				 * means item is first in list). This is only
 				 * a hint and may not really be hotPtr's
 				 * predecessor. */
+    struct SpatialIndex *spatialPtr;
+				/* Lazily built spatial index over all items,
+				 * or NULL. Thrown away whenever an item's
+				 * geometry or stacking order changes. See
+				 * SpatialIndexGet in tkCanvas.c. */
 
     /*
      * Miscellaneous information:
@@ -220,6 +277,61 @@ typedef struct TkCanvas {
 				 * Postscript for the canvas. NULL means no
 				 * Postscript is currently being generated. */
     Tcl_HashTable idTable;	/* Table of integer indices. */
+    Tcl_HashTable tagExprTable;	/* Maps the Uid of a tag expression string to
+				 * a compiled TagSearchExpr template so that
+				 * repeated searches skip re-parsing. The
+				 * compiled form depends only on the string,
+				 * so entries never need invalidating; they
+				 * are freed with the canvas. */
+    Tcl_HashTable tagIndexTable;/* Maps tag Uids to arrays of the items
+				 * carrying that tag, in display list order.
+				 * Only meaningful while tagIndexValid is
+				 * set; built lazily by single-tag searches.
+				 * See TagIndexGet in tkCanvas.c. */
+    int tagIndexValid;		/* Non-zero means tagIndexTable is up to
+				 * date. */
+    unsigned long tagIndexEpoch;/* Bumped whenever tag membership or the
+				 * display list order changes, so searches in
+				 * progress can detect that a captured
+				 * membership array has gone stale. */
+    unsigned long snapshotGen;	/* Bumped whenever any item is created,
+				 * deleted or modified. Reported by the
+				 * "snapshot" widget command so external
+				 * consumers can tell whether a previously
+				 * captured snapshot is still current. */
+    int numItems;		/* Total number of items in the canvas. */
+    TkCanvasItemPool itemPool[TK_CANVAS_ITEM_POOL_SIZES];
+				/* Free lists of item records, segregated by
+				 * record size, so canvases that create and
+				 * destroy items at a high rate recycle
+				 * memory instead of hammering the
+				 * allocator. See AllocItem in tkCanvas.c. */
+    int staticLayer;		/* Boolean: value of the -staticlayer
+				 * option. Non-zero means items tagged
+				 * "static" are rendered once into a retained
+				 * pixmap which later redraws copy from. */
+    Pixmap staticPixmap;	/* Retained rendering of the static layer for
+				 * the visible area, or None. Only meaningful
+				 * while staticValid is set. */
+    int staticValid;		/* Non-zero means staticPixmap holds an up to
+				 * date rendering of the static items. */
+    int staticXOrigin, staticYOrigin;
+				/* Canvas coordinates corresponding to the
+				 * (0,0) corner of staticPixmap. */
+    int staticWidth, staticHeight;
+				/* Dimensions of staticPixmap, in pixels. */
+    Tk_Uid staticUid;		/* Interned "static" tag, for quick
+				 * comparisons against item tags. */
+    struct TkCanvasTween *tweenPtr;
+				/* List of coordinate animations currently
+				 * running on items of this canvas, or NULL.
+				 * See the "animate" widget command in
+				 * tkCanvas.c. */
+    Tcl_TimerToken tweenTimer;	/* Timer driving the running animations, or
+				 * NULL when none are running. */
+    Tcl_WideInt tweenDue;	/* Absolute time of the next animation tick
+				 * in microseconds, valid while tweenTimer
+				 * is scheduled. */
 
     /*
      * Additional information, added by the 'dash'-patch
@@ -295,11 +407,24 @@ MODULE_SCOPE int	TkCanvPostscriptCmd(TkCanvas *canvasPtr,
 MODULE_SCOPE int 	TkCanvTranslatePath(TkCanvas *canvPtr,
 			    int numVertex, double *coordPtr, int closed,
 			    XPoint *outPtr);
+MODULE_SCOPE void	TkCanvasStaticDamageItem(Tk_Canvas canvas,
+			    Tk_Item *itemPtr);
+MODULE_SCOPE void	TkCanvasBatchFillRect(Display *display,
+			    Drawable drawable, GC gc, const void *owner,
+			    int x, int y, unsigned int width,
+			    unsigned int height);
+MODULE_SCOPE void	TkCanvasBatchDrawRect(Display *display,
+			    Drawable drawable, GC gc, const void *owner,
+			    int x, int y, unsigned int width,
+			    unsigned int height);
+MODULE_SCOPE void	TkCanvasBatchBoundary(const void *owner);
+MODULE_SCOPE void	TkCanvasBatchFlush(void);
 /*
  * Standard item types provided by Tk:
  */
 
-MODULE_SCOPE Tk_ItemType tkArcType, tkBitmapType, tkImageType, tkLineType;
+MODULE_SCOPE Tk_ItemType tkArcType, tkBitmapType, tkControlType;
+MODULE_SCOPE Tk_ItemType tkImageType, tkLineType;
 MODULE_SCOPE Tk_ItemType tkOvalType, tkPolygonType;
 MODULE_SCOPE Tk_ItemType tkRectangleType, tkTextType, tkWindowType;
 
@@ -43,7 +43,8 @@ static int		ClipboardGetProc(ClientData clientData,
  *	buffer.
  *
  * Side effects:
- *	None.
+ *	The buffer chain for the target may be rendered into a contiguous
+ *	buffer that is kept until the clipboard contents change.
  *
  *----------------------------------------------------------------------
  */
@@ -58,50 +59,44 @@ ClipboardHandler(
 {
     TkClipboardTarget *targetPtr = (TkClipboardTarget *)clientData;
     TkClipboardBuffer *cbPtr;
-    char *srcPtr, *destPtr;
-    TkSizeT count = 0;
-    TkSizeT scanned = 0;
-    TkSizeT length, freeCount;
+    char *destPtr;
+    TkSizeT count;
 
     /*
-     * Skip to buffer containing offset byte
+     * Render the buffer chain into one contiguous buffer the first time a
+     * chunk of this target is requested. Subsequent chunks, and repeated
+     * retrievals of the same clipboard contents, are then served with a
+     * single copy instead of rescanning the chain from the start for every
+     * chunk. The rendering is discarded whenever the clipboard changes, and
+     * targets that are never requested are never rendered.
      */
 
-    for (cbPtr = targetPtr->firstBufferPtr; ; cbPtr = cbPtr->nextPtr) {
-	if (cbPtr == NULL) {
-	    return 0;
+    if (targetPtr->flatBuffer == NULL) {
+	TkSizeT length = 0;
+
+	for (cbPtr = targetPtr->firstBufferPtr; cbPtr != NULL;
+		cbPtr = cbPtr->nextPtr) {
+	    length += cbPtr->length;
 	}
-	if (scanned + cbPtr->length > offset) {
-	    break;
+	targetPtr->flatBuffer = (char *)ckalloc(length + 1);
+	targetPtr->flatLength = length;
+	destPtr = targetPtr->flatBuffer;
+	for (cbPtr = targetPtr->firstBufferPtr; cbPtr != NULL;
+		cbPtr = cbPtr->nextPtr) {
+	    memcpy(destPtr, cbPtr->buffer, cbPtr->length);
+	    destPtr += cbPtr->length;
 	}
-	scanned += cbPtr->length;
+	*destPtr = '\0';
     }
 
-    /*
-     * Copy up to maxBytes or end of list, switching buffers as needed.
-     */
-
-    freeCount = maxBytes;
-    srcPtr = cbPtr->buffer + (offset - scanned);
-    destPtr = buffer;
-    length = cbPtr->length - (offset - scanned);
-    while (1) {
-	if (length > freeCount) {
-	    strncpy(destPtr, srcPtr, freeCount);
-	    return maxBytes;
-	} else {
-	    strncpy(destPtr, srcPtr, length);
-	    destPtr += length;
-	    count += length;
-	    freeCount -= length;
-	}
-	cbPtr = cbPtr->nextPtr;
-	if (cbPtr == NULL) {
-	    break;
-	}
-	srcPtr = cbPtr->buffer;
-	length = cbPtr->length;
+    if (offset >= targetPtr->flatLength) {
+	return 0;
+    }
+    count = targetPtr->flatLength - offset;
+    if (count > maxBytes) {
+	count = maxBytes;
     }
+    memcpy(buffer, targetPtr->flatBuffer + offset, count);
     return count;
 }
 
@@ -270,6 +265,9 @@ Tk_ClipboardClear(
 	    nextCbPtr = cbPtr->nextPtr;
 	    ckfree(cbPtr);
 	}
+	if (targetPtr->flatBuffer != NULL) {
+	    ckfree(targetPtr->flatBuffer);
+	}
 	nextTargetPtr = targetPtr->nextPtr;
 	Tk_DeleteSelHandler(dispPtr->clipWindow, dispPtr->clipboardAtom,
 		targetPtr->type);
@@ -363,6 +361,8 @@ Tk_ClipboardAppend(
 	targetPtr->type = type;
 	targetPtr->format = format;
 	targetPtr->firstBufferPtr = targetPtr->lastBufferPtr = NULL;
+	targetPtr->flatBuffer = NULL;
+	targetPtr->flatLength = 0;
 	targetPtr->nextPtr = dispPtr->clipTargetPtr;
 	dispPtr->clipTargetPtr = targetPtr;
 	Tk_CreateSelHandler(dispPtr->clipWindow, dispPtr->clipboardAtom,
@@ -378,9 +378,15 @@ Tk_ClipboardAppend(
     }
 
     /*
-     * Append a new buffer to the buffer chain.
+     * Append a new buffer to the buffer chain, discarding any contiguous
+     * rendering of the old contents.
      */
 
+    if (targetPtr->flatBuffer != NULL) {
+	ckfree(targetPtr->flatBuffer);
+	targetPtr->flatBuffer = NULL;
+	targetPtr->flatLength = 0;
+    }
     cbPtr = (TkClipboardBuffer *)ckalloc(sizeof(TkClipboardBuffer));
     cbPtr->nextPtr = NULL;
     if (targetPtr->lastBufferPtr != NULL) {
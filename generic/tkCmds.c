@@ -26,6 +26,8 @@
  * Forward declarations for functions defined later in this file:
  */
 
+static void		BulkRootCoords(TkWindow *winPtr,
+			    Tcl_HashTable *cachePtr, int *xPtr, int *yPtr);
 static TkWindow *	GetTopHierarchy(Tk_Window tkwin);
 static char *		WaitVariableProc(ClientData clientData,
 			    Tcl_Interp *interp, const char *name1,
@@ -36,10 +38,19 @@ static void		WaitWindowProc(ClientData clientData,
 			    XEvent *eventPtr);
 static int		AppnameCmd(ClientData dummy, Tcl_Interp *interp,
 			    int objc, Tcl_Obj *const *objv);
+static int		BatchgeometryCmd(ClientData dummy, Tcl_Interp *interp,
+			    int objc, Tcl_Obj *const *objv);
 static int		CaretCmd(ClientData dummy, Tcl_Interp *interp,
 			    int objc, Tcl_Obj *const *objv);
+static void		CollectConfigureMatches(TkWindow *winPtr,
+			    const char *pattern, Tcl_Obj *listObj);
+static int		ConfigureallCmd(ClientData dummy, Tcl_Interp *interp,
+			    int objc, Tcl_Obj *const *objv);
 static int		InactiveCmd(ClientData dummy, Tcl_Interp *interp,
 			    int objc, Tcl_Obj *const *objv);
+static int		PerfCmd(ClientData dummy, Tcl_Interp *interp,
+			    int objc, Tcl_Obj *const *objv);
+static Tcl_WideUInt	PerfXRequestTotal(void);
 static int		ScalingCmd(ClientData dummy, Tcl_Interp *interp,
 			    int objc, Tcl_Obj *const *objv);
 static int		UseinputmethodsCmd(ClientData dummy,
@@ -61,9 +72,15 @@ MODULE_SCOPE const TkEnsemble tkFontchooserEnsemble[];
 
 static const TkEnsemble tkCmdMap[] = {
     {"appname",		AppnameCmd, NULL },
+    {"batchgeometry",	BatchgeometryCmd, NULL },
     {"busy",		Tk_BusyObjCmd, NULL },
     {"caret",		CaretCmd, NULL },
+    {"configureall",	ConfigureallCmd, NULL },
+    {"fontcache",	TkFontcacheObjCmd, NULL },
+    {"frameclock",	TkFrameclockObjCmd, NULL },
     {"inactive",	InactiveCmd, NULL },
+    {"perf",		PerfCmd, NULL },
+    {"resourcecache",	TkResourcecacheObjCmd, NULL },
     {"scaling",		ScalingCmd, NULL },
     {"useinputmethods",	UseinputmethodsCmd, NULL },
     {"windowingsystem",	WindowingsystemCmd, NULL },
@@ -659,8 +676,8 @@ TkInitTkCmd(
 /*
  *----------------------------------------------------------------------
  *
- * AppnameCmd, CaretCmd, ScalingCmd, UseinputmethodsCmd,
- * WindowingsystemCmd, InactiveCmd --
+ * AppnameCmd, BatchgeometryCmd, CaretCmd, ConfigureallCmd, ScalingCmd,
+ * UseinputmethodsCmd, WindowingsystemCmd, InactiveCmd --
  *
  *	These functions are invoked to process the "tk" ensemble subcommands.
  *	See the user documentation for details on what they do.
@@ -706,6 +723,31 @@ AppnameCmd(
     return TCL_OK;
 }
 
+int
+BatchgeometryCmd(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    int code;
+
+    if (objc != 2) {
+	Tcl_WrongNumArgs(interp, 1, objv, "script");
+	return TCL_ERROR;
+    }
+
+    /*
+     * The batch is closed even if the script fails, so that the geometry
+     * requests made before the error still reach their managers.
+     */
+
+    TkGeometryBatchBegin();
+    code = Tcl_EvalObjEx(interp, objv[1], 0);
+    TkGeometryBatchEnd();
+    return code;
+}
+
 int
 CaretCmd(
     ClientData clientData,	/* Main window associated with interpreter. */
@@ -798,6 +840,349 @@ CaretCmd(
     return TCL_OK;
 }
 
+/*
+ * CollectConfigureMatches --
+ *	Helper for ConfigureallCmd.  Appends to listObj the path name of
+ *	winPtr, if it matches pattern, and of every matching descendant.
+ *	The names are collected up front so that widget creation or
+ *	destruction triggered by a configure call cannot disturb the
+ *	traversal.
+ */
+
+static void
+CollectConfigureMatches(
+    TkWindow *winPtr,		/* Root of the hierarchy to scan. */
+    const char *pattern,	/* Glob pattern to match path names against. */
+    Tcl_Obj *listObj)		/* Unshared list to append path names to. */
+{
+    TkWindow *childPtr;
+
+    if ((winPtr->pathName != NULL)
+	    && Tcl_StringMatch(winPtr->pathName, pattern)) {
+	Tcl_ListObjAppendElement(NULL, listObj,
+		Tcl_NewStringObj(winPtr->pathName, -1));
+    }
+    for (childPtr = winPtr->childList; childPtr != NULL;
+	    childPtr = childPtr->nextPtr) {
+	CollectConfigureMatches(childPtr, pattern, listObj);
+    }
+}
+
+int
+ConfigureallCmd(
+    ClientData clientData,	/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    Tk_Window tkwin = (Tk_Window)clientData;
+    Tcl_Obj *matchListObj, **matchv, **optv, **wordv, *configureObj;
+    int matchc, optc, i, count = 0, code = TCL_OK;
+
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 1, objv, "pattern optionValueList");
+	return TCL_ERROR;
+    }
+    if (Tcl_ListObjGetElements(interp, objv[2], &optc, &optv) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (optc & 1) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"option list must have an even number of elements", -1));
+	Tcl_SetErrorCode(interp, "TK", "CONFIGUREALL", "ODDLIST", NULL);
+	return TCL_ERROR;
+    }
+
+    matchListObj = Tcl_NewObj();
+    Tcl_IncrRefCount(matchListObj);
+    CollectConfigureMatches((TkWindow *)tkwin, Tcl_GetString(objv[1]),
+	    matchListObj);
+    Tcl_ListObjGetElements(NULL, matchListObj, &matchc, &matchv);
+
+    /*
+     * Hand the very same value objects to every widget.  A value's costly
+     * conversion (pixel distance, state map, etc.) is performed once by the
+     * first widget and reused via the object's cached internal rep by all
+     * the others; the per-widget relayouts collapse into idle callbacks as
+     * usual.
+     */
+
+    configureObj = Tcl_NewStringObj("configure", -1);
+    Tcl_IncrRefCount(configureObj);
+    wordv = (Tcl_Obj **)ckalloc((optc + 2) * sizeof(Tcl_Obj *));
+    wordv[1] = configureObj;
+    memcpy(wordv + 2, optv, optc * sizeof(Tcl_Obj *));
+
+    for (i = 0; i < matchc; i++) {
+	if (Tk_NameToWindow(interp, Tcl_GetString(matchv[i]), tkwin) == NULL) {
+	    /*
+	     * Destroyed by an earlier configure call; skip it.
+	     */
+
+	    Tcl_ResetResult(interp);
+	    continue;
+	}
+	wordv[0] = matchv[i];
+	code = Tcl_EvalObjv(interp, optc + 2, wordv, 0);
+	if (code != TCL_OK) {
+	    Tcl_AppendObjToErrorInfo(interp, Tcl_ObjPrintf(
+		    "\n    (while configuring \"%s\")",
+		    Tcl_GetString(matchv[i])));
+	    break;
+	}
+	count++;
+    }
+
+    ckfree(wordv);
+    Tcl_DecrRefCount(configureObj);
+    Tcl_DecrRefCount(matchListObj);
+    if (code == TCL_OK) {
+	Tcl_SetObjResult(interp, Tcl_NewWideIntObj(count));
+    }
+    return code;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * PerfCmd --
+ *
+ *	This function is invoked to process the "tk perf" Tcl command. It
+ *	controls the performance counters and latency histograms declared in
+ *	tkInt.h, which are fed by the TK_PERF_* probes in the event loop and
+ *	the widget display procedures.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	"tk perf start" and "tk perf stop" toggle collection, "tk perf
+ *	reset" clears everything collected so far, and "tk perf report"
+ *	returns a dictionary of the accumulated data.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int		tkPerfEnabled = 0;
+Tcl_WideUInt	tkPerfCounters[TK_PERF_NUM_COUNTERS];
+TkPerfTimer	tkPerfTimers[TK_PERF_NUM_TIMERS];
+TkPerfXSample	tkPerfXLog[TK_PERF_XLOG_SIZE];
+unsigned int	tkPerfXLogCount = 0;
+
+static Tcl_WideUInt perfXRequestBase = 0;
+				/* Sum of the X request serials of all open
+				 * displays when collection last started, so
+				 * the report can show requests issued since
+				 * then. */
+
+static Tcl_WideUInt
+PerfXRequestTotal(void)
+{
+    TkDisplay *dispPtr;
+    Tcl_WideUInt total = 0;
+
+    for (dispPtr = TkGetDisplayList(); dispPtr != NULL;
+	    dispPtr = dispPtr->nextPtr) {
+	total += (Tcl_WideUInt) (NextRequest(dispPtr->display) - 1);
+    }
+    return total;
+}
+
+void
+TkPerfTimerRecord(
+    TkPerfTimerId id,		/* Which histogram to update. */
+    const Tcl_Time *startPtr)	/* Time recorded by TK_PERF_TIMER_START at
+				 * the beginning of the interval. */
+{
+    Tcl_Time now;
+    Tcl_WideUInt us;
+    TkPerfTimer *timerPtr = &tkPerfTimers[id];
+    int bucket;
+
+    if (startPtr->sec == 0) {
+	/*
+	 * Collection was enabled after this interval began; there is no
+	 * meaningful start time to measure against.
+	 */
+
+	return;
+    }
+    Tcl_GetTime(&now);
+    us = (Tcl_WideUInt) (now.sec - startPtr->sec) * 1000000
+	    + (Tcl_WideUInt) (now.usec - startPtr->usec);
+    timerPtr->count++;
+    timerPtr->totalUs += us;
+    if (us > timerPtr->maxUs) {
+	timerPtr->maxUs = us;
+    }
+    for (bucket = 0; (bucket < TK_PERF_HIST_BUCKETS - 1)
+	    && (us >= ((Tcl_WideUInt) 2 << bucket)); bucket++) {
+	/* Empty loop body. */
+    }
+    timerPtr->hist[bucket]++;
+}
+
+void
+TkPerfXRecord(
+    Tk_Window tkwin,		/* Widget the request is attributed to. */
+    const char *kind,		/* Static string naming the request. */
+    unsigned int bytes,		/* Approximate payload size. */
+    const Tcl_Time *startPtr)	/* Time recorded by TK_PERF_TIMER_START just
+				 * before the request was issued. */
+{
+    TkPerfXSample *samplePtr =
+	    &tkPerfXLog[tkPerfXLogCount % TK_PERF_XLOG_SIZE];
+    Tcl_Time now;
+
+    samplePtr->path = Tk_GetUid(Tk_PathName(tkwin));
+    samplePtr->kind = kind;
+    samplePtr->bytes = bytes;
+    if (startPtr->sec == 0) {
+	samplePtr->us = 0;
+    } else {
+	Tcl_GetTime(&now);
+	samplePtr->us = (unsigned int) ((now.sec - startPtr->sec) * 1000000
+		+ (now.usec - startPtr->usec));
+    }
+    tkPerfXLogCount++;
+}
+
+int
+PerfCmd(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    static const char *const perfOptions[] = {
+	"report", "reset", "start", "status", "stop", "xdump", NULL
+    };
+    enum options { TK_PERF_REPORT, TK_PERF_RESET, TK_PERF_START,
+	    TK_PERF_STATUS, TK_PERF_STOP, TK_PERF_XDUMP };
+    static const char *const timerNames[TK_PERF_NUM_TIMERS] = {
+	"eventdispatch", "canvasdisplay", "textdisplay"
+    };
+    int index, i, numRedisplays, linesRedrawn, numCopies;
+    Tcl_Obj *dictObj, *timerObj, *histObj;
+
+    if (objc != 2) {
+	Tcl_WrongNumArgs(interp, 1, objv, "option");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[1], perfOptions, "option", 0,
+	    &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    switch ((enum options) index) {
+    case TK_PERF_START:
+	if (!tkPerfEnabled) {
+	    perfXRequestBase = PerfXRequestTotal();
+	    tkPerfEnabled = 1;
+	}
+	break;
+    case TK_PERF_STOP:
+	tkPerfEnabled = 0;
+	break;
+    case TK_PERF_STATUS:
+	Tcl_SetObjResult(interp, Tcl_NewBooleanObj(tkPerfEnabled));
+	break;
+    case TK_PERF_RESET:
+	memset(tkPerfCounters, 0, sizeof(tkPerfCounters));
+	memset(tkPerfTimers, 0, sizeof(tkPerfTimers));
+	tkPerfXLogCount = 0;
+	perfXRequestBase = PerfXRequestTotal();
+	break;
+    case TK_PERF_REPORT:
+	dictObj = Tcl_NewDictObj();
+	for (i = 0; i < TK_PERF_NUM_TIMERS; i++) {
+	    TkPerfTimer *timerPtr = &tkPerfTimers[i];
+	    int bucket;
+
+	    timerObj = Tcl_NewDictObj();
+	    Tcl_DictObjPut(NULL, timerObj, Tcl_NewStringObj("count", -1),
+		    Tcl_NewWideIntObj((Tcl_WideInt) timerPtr->count));
+	    Tcl_DictObjPut(NULL, timerObj, Tcl_NewStringObj("totalus", -1),
+		    Tcl_NewWideIntObj((Tcl_WideInt) timerPtr->totalUs));
+	    Tcl_DictObjPut(NULL, timerObj, Tcl_NewStringObj("maxus", -1),
+		    Tcl_NewWideIntObj((Tcl_WideInt) timerPtr->maxUs));
+	    histObj = Tcl_NewObj();
+	    for (bucket = 0; bucket < TK_PERF_HIST_BUCKETS; bucket++) {
+		Tcl_ListObjAppendElement(NULL, histObj, Tcl_NewWideIntObj(
+			(Tcl_WideInt) timerPtr->hist[bucket]));
+	    }
+	    Tcl_DictObjPut(NULL, timerObj,
+		    Tcl_NewStringObj("histogram", -1), histObj);
+	    Tcl_DictObjPut(NULL, dictObj,
+		    Tcl_NewStringObj(timerNames[i], -1), timerObj);
+	}
+	Tcl_DictObjPut(NULL, dictObj,
+		Tcl_NewStringObj("pixelspainted", -1),
+		Tcl_NewWideIntObj(
+		(Tcl_WideInt) tkPerfCounters[TK_PERF_PIXELS_PAINTED]));
+	Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("xrequests", -1),
+		Tcl_NewWideIntObj(
+		(Tcl_WideInt) (PerfXRequestTotal() - perfXRequestBase)));
+	TkTextDispStats(&numRedisplays, &linesRedrawn, &numCopies);
+	Tcl_DictObjPut(NULL, dictObj,
+		Tcl_NewStringObj("textredisplays", -1),
+		Tcl_NewWideIntObj(numRedisplays));
+	Tcl_DictObjPut(NULL, dictObj,
+		Tcl_NewStringObj("textlinesredrawn", -1),
+		Tcl_NewWideIntObj(linesRedrawn));
+	Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("textcopies", -1),
+		Tcl_NewWideIntObj(numCopies));
+	Tcl_SetObjResult(interp, dictObj);
+	break;
+    case TK_PERF_XDUMP: {
+	/*
+	 * Aggregate the ring buffer into collapsed-stack format: one line
+	 * per (widget path, request kind) pair, weighted by the summed
+	 * payload bytes, ready to feed to a flamegraph renderer.
+	 */
+
+	Tcl_HashTable aggTable;
+	Tcl_HashEntry *hPtr;
+	Tcl_HashSearch search;
+	Tcl_DString key;
+	Tcl_Obj *resultObj;
+	unsigned int first, n;
+
+	Tcl_InitHashTable(&aggTable, TCL_STRING_KEYS);
+	Tcl_DStringInit(&key);
+	n = tkPerfXLogCount;
+	first = (n > TK_PERF_XLOG_SIZE) ? n - TK_PERF_XLOG_SIZE : 0;
+	for (; first < n; first++) {
+	    TkPerfXSample *samplePtr =
+		    &tkPerfXLog[first % TK_PERF_XLOG_SIZE];
+	    int isNew;
+	    size_t total;
+
+	    Tcl_DStringSetLength(&key, 0);
+	    Tcl_DStringAppend(&key, samplePtr->path, -1);
+	    Tcl_DStringAppend(&key, ";", 1);
+	    Tcl_DStringAppend(&key, samplePtr->kind, -1);
+	    hPtr = Tcl_CreateHashEntry(&aggTable, Tcl_DStringValue(&key),
+		    &isNew);
+	    total = isNew ? 0 : (size_t) Tcl_GetHashValue(hPtr);
+	    Tcl_SetHashValue(hPtr, (ClientData) (total + samplePtr->bytes));
+	}
+	resultObj = Tcl_NewObj();
+	for (hPtr = Tcl_FirstHashEntry(&aggTable, &search); hPtr != NULL;
+		hPtr = Tcl_NextHashEntry(&search)) {
+	    Tcl_AppendPrintfToObj(resultObj, "%s %lu\n",
+		    (char *) Tcl_GetHashKey(&aggTable, hPtr),
+		    (unsigned long) (size_t) Tcl_GetHashValue(hPtr));
+	}
+	Tcl_DeleteHashTable(&aggTable);
+	Tcl_DStringFree(&key);
+	Tcl_SetObjResult(interp, resultObj);
+	break;
+    }
+    }
+    return TCL_OK;
+}
+
 int
 ScalingCmd(
     ClientData clientData,	/* Main window associated with interpreter. */
@@ -840,8 +1225,19 @@ ScalingCmd(
 	if (height <= 0) {
 	    height = 1;
 	}
-	WidthMMOfScreen(screenPtr) = width;
-	HeightMMOfScreen(screenPtr) = height;
+	if ((WidthMMOfScreen(screenPtr) != width)
+		|| (HeightMMOfScreen(screenPtr) != height)) {
+	    WidthMMOfScreen(screenPtr) = width;
+	    HeightMMOfScreen(screenPtr) = height;
+
+	    /*
+	     * Cached pixel conversions and pre-rendered resources are keyed
+	     * by this epoch; bumping it makes them recompute lazily instead
+	     * of silently keeping values for the old ratio.
+	     */
+
+	    ((TkWindow *) tkwin)->dispPtr->scalingEpoch++;
+	}
     } else {
 	Tcl_WrongNumArgs(interp, 1, objv, "?-displayof window? ?factor?");
 	return TCL_ERROR;
@@ -1303,8 +1699,8 @@ Tk_WinfoObjCmd(
 	"atom",		"atomname",	"containing",	"interps",
 	"pathname",
 
-	"exists",	"fpixels",	"pixels",	"rgb",
-	"visualsavailable",
+	"bulk",		"exists",	"fpixels",	"pixels",
+	"rgb",		"visualsavailable",
 
 	NULL
     };
@@ -1323,8 +1719,8 @@ Tk_WinfoObjCmd(
 	WIN_ATOM,	WIN_ATOMNAME,	WIN_CONTAINING,	WIN_INTERPS,
 	WIN_PATHNAME,
 
-	WIN_EXISTS,	WIN_FPIXELS,	WIN_PIXELS,	WIN_RGB,
-	WIN_VISUALSAVAILABLE
+	WIN_BULK,	WIN_EXISTS,	WIN_FPIXELS,	WIN_PIXELS,
+	WIN_RGB,	WIN_VISUALSAVAILABLE
     };
 
     if (objc < 2) {
@@ -1673,6 +2069,110 @@ Tk_WinfoObjCmd(
 	 * objv[3] is window.
 	 */
 
+    case WIN_BULK: {
+	static const char *const bulkAttrNames[] = {
+	    "height", "reqheight", "reqwidth", "rootx", "rooty",
+	    "width", "x", "y", NULL
+	};
+	enum bulkAttr {
+	    BULK_HEIGHT, BULK_REQHEIGHT, BULK_REQWIDTH, BULK_ROOTX,
+	    BULK_ROOTY, BULK_WIDTH, BULK_X, BULK_Y
+	};
+	Tcl_Obj **attrObjs, *resultPtr;
+	Tcl_HashTable rootCache;
+	Tk_Window bulkWin;
+	int attrCount, attrIndex, i, j, needRoot, rootX = 0, rootY = 0;
+
+	if (objc < 4) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "window attrList ?window ...?");
+	    return TCL_ERROR;
+	}
+	if (Tcl_ListObjGetElements(interp, objv[3], &attrCount,
+		&attrObjs) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	needRoot = 0;
+	for (j = 0; j < attrCount; j++) {
+	    if (Tcl_GetIndexFromObj(interp, attrObjs[j], bulkAttrNames,
+		    "attribute", 0, &attrIndex) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	    if ((attrIndex == BULK_ROOTX) || (attrIndex == BULK_ROOTY)) {
+		needRoot = 1;
+	    }
+	}
+
+	/*
+	 * Validate every window up front so that no cleanup is needed once
+	 * the result and the root-coordinate cache are being built.
+	 */
+
+	for (i = 2; i < objc; i++) {
+	    if ((i != 3) && (TkGetWindowFromObj(interp, tkwin, objv[i],
+		    &bulkWin) != TCL_OK)) {
+		return TCL_ERROR;
+	    }
+	}
+
+	if (needRoot) {
+	    Tcl_InitHashTable(&rootCache, TCL_ONE_WORD_KEYS);
+	}
+	resultPtr = Tcl_NewListObj(0, NULL);
+	for (i = 2; i < objc; i++) {
+	    if (i == 3) {
+		continue;
+	    }
+	    TkGetWindowFromObj(NULL, tkwin, objv[i], &bulkWin);
+	    winPtr = (TkWindow *) bulkWin;
+	    if (needRoot) {
+		BulkRootCoords(winPtr, &rootCache, &rootX, &rootY);
+	    }
+	    for (j = 0; j < attrCount; j++) {
+		Tcl_GetIndexFromObj(NULL, attrObjs[j], bulkAttrNames,
+			"attribute", 0, &attrIndex);
+		switch ((enum bulkAttr) attrIndex) {
+		case BULK_HEIGHT:
+		    x = Tk_Height(bulkWin);
+		    break;
+		case BULK_REQHEIGHT:
+		    x = Tk_ReqHeight(bulkWin);
+		    break;
+		case BULK_REQWIDTH:
+		    x = Tk_ReqWidth(bulkWin);
+		    break;
+		case BULK_ROOTX:
+		    x = rootX;
+		    break;
+		case BULK_ROOTY:
+		    x = rootY;
+		    break;
+		case BULK_WIDTH:
+		    x = Tk_Width(bulkWin);
+		    break;
+		case BULK_X:
+		    x = Tk_X(bulkWin);
+		    break;
+		default:		/* BULK_Y */
+		    x = Tk_Y(bulkWin);
+		    break;
+		}
+		Tcl_ListObjAppendElement(NULL, resultPtr,
+			Tcl_NewWideIntObj(x));
+	    }
+	}
+	if (needRoot) {
+	    Tcl_HashSearch search;
+	    Tcl_HashEntry *hPtr;
+
+	    for (hPtr = Tcl_FirstHashEntry(&rootCache, &search); hPtr != NULL;
+		    hPtr = Tcl_NextHashEntry(&search)) {
+		ckfree(Tcl_GetHashValue(hPtr));
+	    }
+	    Tcl_DeleteHashTable(&rootCache);
+	}
+	Tcl_SetObjResult(interp, resultPtr);
+	break;
+    }
     case WIN_EXISTS: {
 	int alive;
 
@@ -1943,6 +2443,65 @@ GetTopHierarchy(
     }
     return winPtr;
 }
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * BulkRootCoords --
+ *
+ *	Compute the root coordinates of the (0,0) point of a window for the
+ *	"winfo bulk" command, memoizing the results in a hash table that
+ *	lives for the duration of one bulk query. An interior window's root
+ *	coordinates are its parent's plus its own offset within the parent,
+ *	so windows sharing ancestors (the common case when many siblings are
+ *	queried at once) each cost a single addition instead of a full
+ *	ancestry walk. Top-levels, embedded windows and menubars carry a
+ *	wmInfoPtr and are handed to the platform's Tk_GetRootCoords, which
+ *	knows about wrapper windows and menu bars.
+ *
+ * Results:
+ *	The locations pointed to by xPtr and yPtr are filled in with the root
+ *	coordinates of the (0,0) point in winPtr.
+ *
+ * Side effects:
+ *	Entries holding ckalloc'ed coordinate pairs are added to the cache;
+ *	the caller is responsible for freeing them.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+BulkRootCoords(
+    TkWindow *winPtr,		/* Window whose root coordinates are
+				 * wanted. */
+    Tcl_HashTable *cachePtr,	/* Maps TkWindow * to an int[2] holding
+				 * previously computed coordinates. */
+    int *xPtr,			/* Where to store x-displacement of (0,0). */
+    int *yPtr)			/* Where to store y-displacement of (0,0). */
+{
+    Tcl_HashEntry *hPtr;
+    int isNew, *coords;
+
+    hPtr = Tcl_CreateHashEntry(cachePtr, (char *) winPtr, &isNew);
+    if (!isNew) {
+	coords = (int *) Tcl_GetHashValue(hPtr);
+	*xPtr = coords[0];
+	*yPtr = coords[1];
+	return;
+    }
+    if ((winPtr->wmInfoPtr == NULL) && (winPtr->parentPtr != NULL)) {
+	BulkRootCoords(winPtr->parentPtr, cachePtr, xPtr, yPtr);
+	*xPtr += winPtr->changes.x + winPtr->changes.border_width;
+	*yPtr += winPtr->changes.y + winPtr->changes.border_width;
+    } else {
+	Tk_GetRootCoords((Tk_Window) winPtr, xPtr, yPtr);
+    }
+    coords = (int *) ckalloc(2 * sizeof(int));
+    coords[0] = *xPtr;
+    coords[1] = *yPtr;
+    Tcl_SetHashValue(hPtr, coords);
+}
+
 
 /*
  * Local Variables:
@@ -103,6 +103,11 @@ typedef struct OptionTable {
 				 * templates, this points to the table
 				 * corresponding to the next template in the
 				 * chain. */
+    Tcl_HashTable nameTable;	/* Maps from full option names (including
+				 * those of chained tables, first table
+				 * winning) to Option pointers, for fast
+				 * exact-match lookups.  Abbreviations
+				 * still use a linear scan. */
     size_t numOptions;		/* The number of items in the options array
 				 * below. */
     Option options[1];		/* Information about the individual options in
@@ -128,6 +133,7 @@ static Option *		GetOption(const char *name, OptionTable *tablePtr);
 static Option *		GetOptionFromObj(Tcl_Interp *interp,
 			    Tcl_Obj *objPtr, OptionTable *tablePtr);
 static int		ObjectIsEmpty(Tcl_Obj *objPtr);
+static void		OptionThreadExitProc(ClientData clientData);
 static void		FreeOptionInternalRep(Tcl_Obj *objPtr);
 static void		DupOptionInternalRep(Tcl_Obj *, Tcl_Obj *);
 
@@ -174,7 +180,7 @@ Tk_CreateOptionTable(
 {
     Tcl_HashEntry *hashEntryPtr;
     int newEntry;
-    OptionTable *tablePtr;
+    OptionTable *tablePtr, *tablePtr2;
     const Tk_OptionSpec *specPtr, *specPtr2;
     Option *optionPtr;
     size_t numOptions, i;
@@ -192,6 +198,7 @@ Tk_CreateOptionTable(
     if (!tsdPtr->initialized) {
 	Tcl_InitHashTable(&tsdPtr->hashTable, TCL_ONE_WORD_KEYS);
 	tsdPtr->initialized = 1;
+	Tcl_CreateThreadExitHandler(OptionThreadExitProc, NULL);
     }
 
     /*
@@ -217,7 +224,17 @@ Tk_CreateOptionTable(
 	numOptions++;
     }
     tablePtr = (OptionTable *)ckalloc(sizeof(OptionTable) + (numOptions * sizeof(Option)));
-    tablePtr->refCount = 1;
+
+    /*
+     * One reference for the caller, and one held by the thread-wide cache
+     * so that the processed table outlives any individual user.  Without
+     * the cache reference an application that repeatedly creates and
+     * destroys its last widget of a given class (or spins up short-lived
+     * interpreters) would rebuild the table from the template each time.
+     * The cache reference is released by OptionThreadExitProc.
+     */
+
+    tablePtr->refCount = 2;
     tablePtr->hashEntryPtr = hashEntryPtr;
     tablePtr->nextPtr = NULL;
     tablePtr->numOptions = numOptions;
@@ -303,6 +320,25 @@ Tk_CreateOptionTable(
 		Tk_CreateOptionTable(interp, (Tk_OptionSpec *)specPtr->clientData);
     }
 
+    /*
+     * Build the exact-name lookup table, covering the entire chain.  When
+     * the same name appears in several tables in the chain the first table
+     * wins, matching the scan order in GetOption.
+     */
+
+    Tcl_InitHashTable(&tablePtr->nameTable, TCL_STRING_KEYS);
+    for (tablePtr2 = tablePtr; tablePtr2 != NULL;
+	    tablePtr2 = tablePtr2->nextPtr) {
+	for (optionPtr = tablePtr2->options, i = tablePtr2->numOptions;
+		i > 0; optionPtr++, i--) {
+	    hashEntryPtr = Tcl_CreateHashEntry(&tablePtr->nameTable,
+		    optionPtr->specPtr->optionName, &newEntry);
+	    if (newEntry) {
+		Tcl_SetHashValue(hashEntryPtr, optionPtr);
+	    }
+	}
+    }
+
     return (Tk_OptionTable) tablePtr;
 }
 
@@ -351,9 +387,61 @@ Tk_DeleteOptionTable(
 	    Tcl_DecrRefCount(optionPtr->extra.monoColorPtr);
 	}
     }
-    Tcl_DeleteHashEntry(tablePtr->hashEntryPtr);
+    Tcl_DeleteHashTable(&tablePtr->nameTable);
+    if (tablePtr->hashEntryPtr != NULL) {
+	Tcl_DeleteHashEntry(tablePtr->hashEntryPtr);
+    }
     ckfree(tablePtr);
 }
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * OptionThreadExitProc --
+ *
+ *	Thread exit handler that releases the reference held by the
+ *	thread-wide cache on every option table processed in this thread.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Tables that are no longer referenced elsewhere are freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+OptionThreadExitProc(
+    TCL_UNUSED(void *))
+{
+    Tcl_HashEntry *hashEntryPtr;
+    Tcl_HashSearch search;
+    OptionTable *tablePtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (!tsdPtr->initialized) {
+	return;
+    }
+
+    /*
+     * Releasing one table can free tables chained to it, which removes
+     * their hash entries, so remove each entry before releasing its table
+     * and restart the scan rather than continuing a search that may have
+     * been invalidated.
+     */
+
+    while ((hashEntryPtr = Tcl_FirstHashEntry(&tsdPtr->hashTable,
+	    &search)) != NULL) {
+	tablePtr = (OptionTable *)Tcl_GetHashValue(hashEntryPtr);
+	Tcl_DeleteHashEntry(hashEntryPtr);
+	tablePtr->hashEntryPtr = NULL;
+	Tk_DeleteOptionTable((Tk_OptionTable) tablePtr);
+    }
+    Tcl_DeleteHashTable(&tsdPtr->hashTable);
+    tsdPtr->initialized = 0;
+}
 
 /*
  *--------------------------------------------------------------
@@ -991,6 +1079,20 @@ GetOption(
      *    careful to distinguish this case from an ambiguous abbreviation.
      */
 
+    /*
+     * Exact matches (the overwhelmingly common case) are resolved with a
+     * single hash lookup; only abbreviations fall through to the scan.
+     */
+
+    {
+	Tcl_HashEntry *hashEntryPtr =
+	    Tcl_FindHashEntry(&tablePtr->nameTable, name);
+
+	if (hashEntryPtr != NULL) {
+	    return (Option *)Tcl_GetHashValue(hashEntryPtr);
+	}
+    }
+
     bestPtr = NULL;
     for (tablePtr2 = tablePtr; tablePtr2 != NULL;
 	    tablePtr2 = tablePtr2->nextPtr) {
@@ -2090,8 +2192,14 @@ TkDebugConfig(
 	    hashEntryPtr = Tcl_NextHashEntry(&search)) {
 	if (tablePtr == (OptionTable *) Tcl_GetHashValue(hashEntryPtr)) {
 	    for ( ; tablePtr != NULL; tablePtr = tablePtr->nextPtr) {
+		/*
+		 * Report the number of uses by callers; every table in the
+		 * hash also carries one reference held by the thread-wide
+		 * cache, which is not a use in that sense.
+		 */
+
 		Tcl_ListObjAppendElement(NULL, objPtr,
-			Tcl_NewWideIntObj(tablePtr->refCount));
+			Tcl_NewWideIntObj(tablePtr->refCount - 1));
 		Tcl_ListObjAppendElement(NULL, objPtr,
 			Tcl_NewWideIntObj(tablePtr->numOptions));
 		Tcl_ListObjAppendElement(NULL, objPtr, Tcl_NewStringObj(
@@ -896,6 +896,12 @@ EXTERN Tcl_Obj *	Tk_FontGetDescription(Tk_Font tkfont);
 /* 280 */
 EXTERN void		Tk_CreatePhotoImageFormatVersion3(
 				const Tk_PhotoImageFormatVersion3 *formatPtr);
+/* 281 */
+EXTERN int		Tk_CollapseWheelEvents(Display *display,
+				int collapse);
+/* 282 */
+EXTERN void		Tk_QueueThreadWindowEvent(Tcl_ThreadId threadId,
+				XEvent *eventPtr);
 
 typedef struct {
     const struct TkPlatStubs *tkPlatStubs;
@@ -1190,6 +1196,8 @@ typedef struct TkStubs {
     Tcl_Obj * (*tk_FontGetDescription) (Tk_Font tkfont); /* 279 */
     void (*tk_CreatePhotoImageFormatVersion3) (
 	    const Tk_PhotoImageFormatVersion3 *formatPtr);  /* 280 */
+    int (*tk_CollapseWheelEvents) (Display *display, int collapse); /* 281 */
+    void (*tk_QueueThreadWindowEvent) (Tcl_ThreadId threadId, XEvent *eventPtr); /* 282 */
 } TkStubs;
 
 extern const TkStubs *tkStubsPtr;
@@ -1764,6 +1772,10 @@ extern const TkStubs *tkStubsPtr;
 	(tkStubsPtr->tk_FontGetDescription) /* 279 */
 #define Tk_CreatePhotoImageFormatVersion3 \
 	(tkStubsPtr->tk_CreatePhotoImageFormatVersion3) /* 280 */
+#define Tk_CollapseWheelEvents \
+	(tkStubsPtr->tk_CollapseWheelEvents) /* 281 */
+#define Tk_QueueThreadWindowEvent \
+	(tkStubsPtr->tk_QueueThreadWindowEvent) /* 282 */
 
 #endif /* defined(USE_TK_STUBS) */
 
@@ -406,6 +406,9 @@ static int		ConfigureEntry(Tcl_Interp *interp, Entry *entryPtr,
 static int		DeleteChars(Entry *entryPtr, TkSizeT index, TkSizeT count);
 static void		DestroyEntry(void *memPtr);
 static void		DisplayEntry(ClientData clientData);
+#ifndef TK_NO_DOUBLE_BUFFERING
+static void		DisplayEntryCursorOnly(Entry *entryPtr);
+#endif
 static void		EntryBlinkProc(ClientData clientData);
 static void		EntryCmdDeletedProc(ClientData clientData);
 static void		EntryComputeGeometry(Entry *entryPtr);
@@ -416,6 +419,7 @@ static TkSizeT	EntryFetchSelection(ClientData clientData, TkSizeT offset,
 			    char *buffer, TkSizeT maxBytes);
 static void		EntryLostSelection(ClientData clientData);
 static void		EventuallyRedraw(Entry *entryPtr);
+static void		EventuallyRedrawCursor(Entry *entryPtr);
 static void		EntryScanTo(Entry *entryPtr, int y);
 static void		EntrySetValue(Entry *entryPtr, const char *value);
 static void		EntrySelectTo(Entry *entryPtr, TkSizeT index);
@@ -1601,6 +1605,176 @@ TkpDrawSpinboxButtons(
 }
 #endif /* Not MAC_OSX_TK */
 
+#ifndef TK_NO_DOUBLE_BUFFERING
+/*
+ *--------------------------------------------------------------
+ *
+ * DisplayEntryCursorOnly --
+ *
+ *	Repaint just the strip of an entry window covered by the insertion
+ *	cursor. This is all that changes when the cursor blinks, so the
+ *	blink timer uses this instead of redrawing the whole window.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The cursor strip is redrawn on the screen.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+DisplayEntryCursorOnly(
+    Entry *entryPtr)		/* Information about window. */
+{
+    Tk_Window tkwin = entryPtr->tkwin;
+    int baseY, selStartX, selEndX, cursorX;
+    int stripX, stripY, stripWidth, stripHeight, showSelection;
+    Tk_FontMetrics fm;
+    Pixmap pixmap;
+
+    if ((entryPtr->state != STATE_NORMAL)
+	    || !(entryPtr->flags & GOT_FOCUS)) {
+	return;
+    }
+
+    Tk_GetFontMetrics(entryPtr->tkfont, &fm);
+    baseY = (Tk_Height(tkwin) + fm.ascent - fm.descent) / 2;
+    Tk_CharBbox(entryPtr->textLayout, entryPtr->insertPos, &cursorX, NULL,
+	    NULL, NULL);
+    cursorX += entryPtr->layoutX;
+    cursorX -= (entryPtr->insertWidth == 1) ? 1 : (entryPtr->insertWidth)/2;
+    if ((entryPtr->insertPos + 1 < entryPtr->leftIndex + 1) || (cursorX
+	    >= Tk_Width(tkwin) - entryPtr->inset - entryPtr->xWidth)) {
+	return;
+    }
+
+    /*
+     * Clamp the strip to the area inside the border and focus highlight,
+     * which a full redisplay would draw on top of the cursor anyway.
+     */
+
+    stripX = cursorX;
+    stripY = baseY - fm.ascent - entryPtr->selBorderWidth;
+    stripWidth = entryPtr->insertWidth;
+    stripHeight = fm.ascent + fm.descent + 2*entryPtr->selBorderWidth;
+    if (stripX < entryPtr->inset) {
+	stripWidth -= entryPtr->inset - stripX;
+	stripX = entryPtr->inset;
+    }
+    if (stripX + stripWidth > Tk_Width(tkwin) - entryPtr->inset) {
+	stripWidth = Tk_Width(tkwin) - entryPtr->inset - stripX;
+    }
+    if (stripY < entryPtr->inset) {
+	stripHeight -= entryPtr->inset - stripY;
+	stripY = entryPtr->inset;
+    }
+    if (stripY + stripHeight > Tk_Height(tkwin) - entryPtr->inset) {
+	stripHeight = Tk_Height(tkwin) - entryPtr->inset - stripY;
+    }
+    if ((stripWidth <= 0) || (stripHeight <= 0)) {
+	return;
+    }
+
+    /*
+     * Render the strip into a pixmap of its own size; everything is drawn
+     * with coordinates shifted by the strip origin and the server clips
+     * whatever falls outside.
+     */
+
+    pixmap = Tk_GetPixmap(entryPtr->display, Tk_WindowId(tkwin),
+	    stripWidth, stripHeight, Tk_Depth(tkwin));
+    Tk_Fill3DRectangle(tkwin, pixmap, entryPtr->normalBorder,
+	    0, 0, stripWidth, stripHeight, 0, TK_RELIEF_FLAT);
+
+    if (Tk_AlwaysShowSelection(entryPtr->tkwin)) {
+	showSelection = 1;
+    } else {
+	showSelection = (entryPtr->flags & GOT_FOCUS);
+    }
+    if (showSelection
+	    && (entryPtr->selectLast + 1 > entryPtr->leftIndex + 1)) {
+	if (entryPtr->selectFirst <= entryPtr->leftIndex) {
+	    selStartX = entryPtr->leftX;
+	} else {
+	    Tk_CharBbox(entryPtr->textLayout, entryPtr->selectFirst,
+		    &selStartX, NULL, NULL, NULL);
+	    selStartX += entryPtr->layoutX;
+	}
+	Tk_CharBbox(entryPtr->textLayout, entryPtr->selectLast,
+		&selEndX, NULL, NULL, NULL);
+	selEndX += entryPtr->layoutX;
+	Tk_Fill3DRectangle(tkwin, pixmap, entryPtr->selBorder,
+		selStartX - entryPtr->selBorderWidth - stripX,
+		baseY - fm.ascent - entryPtr->selBorderWidth - stripY,
+		(selEndX - selStartX) + 2*entryPtr->selBorderWidth,
+		(fm.ascent + fm.descent) + 2*entryPtr->selBorderWidth,
+		entryPtr->selBorderWidth,
+#ifndef MAC_OSX_TK
+		TK_RELIEF_RAISED
+#else
+		MAC_OSX_ENTRY_SELECT_RELIEF
+#endif
+		);
+    }
+
+    if (entryPtr->flags & CURSOR_ON) {
+	Tk_Fill3DRectangle(tkwin, pixmap, entryPtr->insertBorder,
+		cursorX - stripX, baseY - fm.ascent - stripY,
+		entryPtr->insertWidth, fm.ascent + fm.descent,
+		entryPtr->insertBorderWidth, TK_RELIEF_RAISED);
+    } else if ((entryPtr->numChars == 0)
+	    && (entryPtr->placeholderChars != 0)) {
+	Tk_DrawTextLayout(entryPtr->display, pixmap, entryPtr->placeholderGC,
+		entryPtr->placeholderLayout,
+		entryPtr->placeholderX - stripX, entryPtr->layoutY - stripY,
+		entryPtr->placeholderLeftIndex, entryPtr->placeholderChars);
+    } else {
+	if (showSelection && (entryPtr->selTextGC != entryPtr->textGC)
+		&& (entryPtr->selectFirst + 1 < entryPtr->selectLast + 1)) {
+	    /*
+	     * Draw the selected and unselected portions separately.
+	     */
+
+	    TkSizeT selFirst;
+
+	    if (entryPtr->selectFirst + 1 < entryPtr->leftIndex + 1) {
+		selFirst = entryPtr->leftIndex;
+	    } else {
+		selFirst = entryPtr->selectFirst;
+	    }
+	    if (entryPtr->leftIndex < selFirst) {
+		Tk_DrawTextLayout(entryPtr->display, pixmap,
+			entryPtr->textGC, entryPtr->textLayout,
+			entryPtr->layoutX - stripX, entryPtr->layoutY - stripY,
+			entryPtr->leftIndex, selFirst);
+	    }
+	    Tk_DrawTextLayout(entryPtr->display, pixmap, entryPtr->selTextGC,
+		    entryPtr->textLayout,
+		    entryPtr->layoutX - stripX, entryPtr->layoutY - stripY,
+		    selFirst, entryPtr->selectLast);
+	    if (entryPtr->selectLast < entryPtr->numChars) {
+		Tk_DrawTextLayout(entryPtr->display, pixmap,
+			entryPtr->textGC, entryPtr->textLayout,
+			entryPtr->layoutX - stripX, entryPtr->layoutY - stripY,
+			entryPtr->selectLast, entryPtr->numChars);
+	    }
+	} else {
+	    Tk_DrawTextLayout(entryPtr->display, pixmap, entryPtr->textGC,
+		    entryPtr->textLayout,
+		    entryPtr->layoutX - stripX, entryPtr->layoutY - stripY,
+		    entryPtr->leftIndex, entryPtr->numChars);
+	}
+    }
+
+    XCopyArea(entryPtr->display, pixmap, Tk_WindowId(tkwin), entryPtr->textGC,
+	    0, 0, (unsigned) stripWidth, (unsigned) stripHeight,
+	    stripX, stripY);
+    Tk_FreePixmap(entryPtr->display, pixmap);
+}
+#endif /* !TK_NO_DOUBLE_BUFFERING */
+
 /*
  *--------------------------------------------------------------
  *
@@ -1628,12 +1802,27 @@ DisplayEntry(
     Tk_FontMetrics fm;
     Pixmap pixmap;
     Tk_3DBorder border;
+#ifndef TK_NO_DOUBLE_BUFFERING
+    int cursorOnly = (entryPtr->flags & CURSOR_REDRAW_ONLY);
+#endif
 
-    entryPtr->flags &= ~REDRAW_PENDING;
+    entryPtr->flags &= ~(REDRAW_PENDING|CURSOR_REDRAW_ONLY);
     if ((entryPtr->flags & ENTRY_DELETED) || !Tk_IsMapped(tkwin)) {
 	return;
     }
 
+#ifndef TK_NO_DOUBLE_BUFFERING
+    /*
+     * If the only reason for this redisplay is a blink of the insertion
+     * cursor, repaint just the cursor strip.
+     */
+
+    if (cursorOnly && !(entryPtr->flags & UPDATE_SCROLLBAR)) {
+	DisplayEntryCursorOnly(entryPtr);
+	return;
+    }
+#endif /* !TK_NO_DOUBLE_BUFFERING */
+
     Tk_GetFontMetrics(entryPtr->tkfont, &fm);
 
     /*
@@ -3015,16 +3204,48 @@ EventuallyRedraw(
     }
 
     /*
-     * Right now we don't do selective redisplays: the whole window will be
-     * redrawn. This doesn't seem to hurt performance noticeably, but if it
-     * does then this could be changed.
+     * A full redisplay takes precedence over any cursor-only redisplay that
+     * may already be pending.
      */
 
+    entryPtr->flags &= ~CURSOR_REDRAW_ONLY;
     if (!(entryPtr->flags & REDRAW_PENDING)) {
 	entryPtr->flags |= REDRAW_PENDING;
 	Tcl_DoWhenIdle(DisplayEntry, entryPtr);
     }
 }
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * EventuallyRedrawCursor --
+ *
+ *	Ensure that the insertion cursor strip of an entry is eventually
+ *	redrawn. If a full redisplay is already pending it covers the cursor
+ *	too; otherwise a cursor-only redisplay is scheduled, which is much
+ *	cheaper than repainting the whole window on every blink.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Information gets redisplayed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+EventuallyRedrawCursor(
+    Entry *entryPtr)		/* Information about widget. */
+{
+    if ((entryPtr->flags & ENTRY_DELETED) || !Tk_IsMapped(entryPtr->tkwin)) {
+	return;
+    }
+    if (!(entryPtr->flags & REDRAW_PENDING)) {
+	entryPtr->flags |= REDRAW_PENDING|CURSOR_REDRAW_ONLY;
+	Tcl_DoWhenIdle(DisplayEntry, entryPtr);
+    }
+}
 
 /*
  *----------------------------------------------------------------------
@@ -3170,7 +3391,7 @@ EntryBlinkProc(
 	entryPtr->insertBlinkHandler = Tcl_CreateTimerHandler(
 		entryPtr->insertOnTime, EntryBlinkProc, entryPtr);
     }
-    EventuallyRedraw(entryPtr);
+    EventuallyRedrawCursor(entryPtr);
 }
 
 /*
@@ -267,6 +267,10 @@ typedef struct {
  * VALIDATE_ABORT:		Non-zero if validatecommand signals an abort
  *				for current procedure and make no changes
  * ENTRY_VAR_TRACED:		Non-zero if a var trace is set.
+ * CURSOR_REDRAW_ONLY:		Non-zero means the pending redisplay was
+ *				requested only because the insertion cursor
+ *				blinked, so just the cursor strip needs to
+ *				be repainted.
  */
 
 #define REDRAW_PENDING		1
@@ -280,6 +284,7 @@ typedef struct {
 #define VALIDATE_VAR		0x100
 #define VALIDATE_ABORT		0x200
 #define ENTRY_VAR_TRACED	0x400
+#define CURSOR_REDRAW_ONLY	0x800
 
 /*
  * The following enum is used to define a type for the -state option of the
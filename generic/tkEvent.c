@@ -138,6 +138,20 @@ typedef struct ExitHandler {
 				 * application, or NULL for end of list. */
 } ExitHandler;
 
+/*
+ * For each callback attached to the frame clock with "tk frameclock attach"
+ * there is a structure of the following type:
+ */
+
+typedef struct FrameClockCallback {
+    Tcl_Interp *interp;		/* Interpreter in which to evaluate the
+				 * script; preserved while attached. */
+    Tcl_Obj *scriptObj;		/* Script to evaluate once per frame. */
+    struct FrameClockCallback *nextPtr;
+				/* Next in the list of attached callbacks, or
+				 * NULL for the end of the list. */
+} FrameClockCallback;
+
 /*
  * The structure below is used to store Data for the Event module that must be
  * kept thread-local. The "dataKey" is used to fetch the thread-specific
@@ -179,6 +193,33 @@ typedef struct {
     int inExit;			/* True when this thread is exiting. This is
 				 * used as a hack to decide to close the
 				 * standard channels. */
+
+    /*
+     * Frame budget bookkeeping for cooperative redraw callbacks; see
+     * TkFrameBudgetStart and TkFrameBudgetCheck.
+     */
+
+    Tcl_Time frameStart;	/* Time at which the currently running
+				 * budgeted redraw callback started. */
+    int frameCheckCounter;	/* Number of budget checks since the clock
+				 * was last read; used to amortize the cost
+				 * of Tcl_GetTime. */
+
+    /*
+     * Frame clock state for the "tk frameclock" command; see
+     * TkFrameclockObjCmd.
+     */
+
+    FrameClockCallback *frameClockList;
+				/* First attached callback, or NULL. */
+    Tcl_TimerToken frameClockTimer;
+				/* Timer for the next frame tick, or NULL
+				 * when no callbacks are attached. */
+    int frameClockInterval;	/* Frame interval in microseconds; 0 until
+				 * initialized to the default. */
+    Tcl_WideInt frameClockDue;	/* Absolute time of the next tick in
+				 * microseconds, valid while the timer is
+				 * scheduled. */
 } ThreadSpecificData;
 static Tcl_ThreadDataKey dataKey;
 
@@ -192,12 +233,42 @@ static ExitHandler *firstExitPtr = NULL;
 				 * application. */
 TCL_DECLARE_MUTEX(exitMutex)
 
+/*
+ * Window events posted from other threads are appended to a per-target-thread
+ * staging list, and the whole list is transferred to the target thread's
+ * event queue with a single Tcl_ThreadQueueEvent/Tcl_ThreadAlert, so a burst
+ * of posted events causes only one wakeup of the target thread.
+ */
+
+typedef struct StagedWindowEvent {
+    XEvent event;		/* Event to transfer to the target thread. */
+    struct StagedWindowEvent *nextPtr;
+				/* Next in staging list, or NULL for end. */
+} StagedWindowEvent;
+
+typedef struct ThreadEventStaging {
+    Tcl_ThreadId threadId;	/* Thread whose event queue is fed by this
+				 * staging list. */
+    StagedWindowEvent *firstPtr;/* First staged event, or NULL if empty. */
+    StagedWindowEvent *lastPtr;	/* Last staged event, or NULL if empty. */
+    int wakeupPosted;		/* Non-zero means a drain event is already on
+				 * the target thread's queue, so no further
+				 * wakeup is needed. */
+    struct ThreadEventStaging *nextPtr;
+				/* Next in list of all staging lists. */
+} ThreadEventStaging;
+
+static ThreadEventStaging *firstStagingPtr = NULL;
+				/* First in list of all staging lists. */
+TCL_DECLARE_MUTEX(stagingMutex)
+
 /*
  * Prototypes for functions that are only referenced locally within this file.
  */
 
 static void		CleanUpTkEvent(XEvent *eventPtr);
 static void		DelayedMotionProc(ClientData clientData);
+static void		DelayedWheelProc(ClientData clientData);
 static unsigned long    GetEventMaskFromXEvent(XEvent *eventPtr);
 static TkWindow *	GetTkWindowFromXEvent(XEvent *eventPtr);
 static void		InvokeClientMessageHandlers(ThreadSpecificData *tsdPtr,
@@ -212,6 +283,7 @@ static Window		ParentXId(Display *display, Window w);
 static int		RefreshKeyboardMappingIfNeeded(XEvent *eventPtr);
 static int		TkXErrorHandler(ClientData clientData,
 			    XErrorEvent *errEventPtr);
+static int		StagedWindowEventProc(Tcl_Event *evPtr, int flags);
 static int		WindowEventProc(Tcl_Event *evPtr, int flags);
 static void		CreateXIC(TkWindow *winPtr);
 
@@ -1137,9 +1209,11 @@ Tk_HandleEvent(
     unsigned long mask;
     InProgress ip;
     Tcl_Interp *interp = NULL;
+    Tcl_Time perfStart;
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
 	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
+    TK_PERF_TIMER_START(&perfStart);
 
 #if !defined(_WIN32) && !defined(MAC_OSX_TK)
     if ((eventPtr->xbutton.button >= Button4) && (eventPtr->xbutton.button < Button8)) {
@@ -1328,6 +1402,343 @@ Tk_HandleEvent(
 
   releaseEventResources:
     CleanUpTkEvent(eventPtr);
+    TK_PERF_TIMER_STOP(TK_PERF_TIMER_EVENT, &perfStart);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkFrameBudgetStart --
+ *
+ *	Called at the beginning of an expensive Tcl_DoWhenIdle redraw
+ *	callback to start that callback's time budget. The callback is
+ *	expected to call TkFrameBudgetCheck at convenient interruption
+ *	points (between display lines, between dirty rectangles) and, when
+ *	the check fires, to reschedule itself and return so that pending
+ *	input events are serviced before the repaint continues.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Records the start time in thread-specific data.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkFrameBudgetStart(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    Tcl_GetTime(&tsdPtr->frameStart);
+    tsdPtr->frameCheckCounter = 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkFrameBudgetCheck --
+ *
+ *	Reports whether the redraw callback that last called
+ *	TkFrameBudgetStart has used up its frame budget and should yield
+ *	back to the event loop. The budget is sized so that input can still
+ *	be echoed within a 16 ms frame even while a full-window repaint is
+ *	in progress. To keep the check cheap enough to run between
+ *	individual display lines or canvas items, the clock is only
+ *	consulted on every 16th call.
+ *
+ * Results:
+ *	Non-zero if the budget is exhausted, zero to keep drawing.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+#define FRAME_BUDGET_US		10000
+#define FRAME_CHECK_INTERVAL	16
+
+int
+TkFrameBudgetCheck(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    Tcl_Time now;
+
+    if (++tsdPtr->frameCheckCounter < FRAME_CHECK_INTERVAL) {
+	return 0;
+    }
+    tsdPtr->frameCheckCounter = 0;
+    Tcl_GetTime(&now);
+    return ((now.sec - tsdPtr->frameStart.sec) * 1000000
+	    + (now.usec - tsdPtr->frameStart.usec)) >= FRAME_BUDGET_US;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * FrameClockNowUsec --
+ *
+ *	Returns the current time on the same monotonically advancing scale
+ *	the frame clock deadlines are kept on, in microseconds.
+ *
+ * Results:
+ *	The time in microseconds.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static Tcl_WideInt
+FrameClockNowUsec(void)
+{
+    Tcl_Time now;
+
+    Tcl_GetTime(&now);
+    return (Tcl_WideInt) now.sec * 1000000 + now.usec;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * FrameClockTimerProc --
+ *
+ *	Timer handler that delivers one frame tick: every attached callback
+ *	runs exactly once, then the next tick is scheduled from the absolute
+ *	deadline of the current one, so the frame rate does not drift the
+ *	way chained relative "after" timers do.  When callbacks overrun the
+ *	frame interval, whole frames are skipped rather than delivering a
+ *	burst of late ticks.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Scripts are evaluated.  A callback whose script raises an error is
+ *	detached, and the error is reported through the background exception
+ *	mechanism.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+FrameClockTimerProc(
+    TCL_UNUSED(ClientData))
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    FrameClockCallback *cbPtr, *nextPtr, **prevPtrPtr;
+    Tcl_WideInt nowUsec;
+    int delay;
+
+    tsdPtr->frameClockTimer = NULL;
+
+    prevPtrPtr = &tsdPtr->frameClockList;
+    for (cbPtr = tsdPtr->frameClockList; cbPtr != NULL; cbPtr = nextPtr) {
+	nextPtr = cbPtr->nextPtr;
+	if (Tcl_InterpDeleted(cbPtr->interp)
+		|| (Tcl_EvalObjEx(cbPtr->interp, cbPtr->scriptObj,
+		TCL_EVAL_GLOBAL) != TCL_OK)) {
+	    if (!Tcl_InterpDeleted(cbPtr->interp)) {
+		Tcl_BackgroundException(cbPtr->interp, TCL_ERROR);
+	    }
+	    *prevPtrPtr = nextPtr;
+	    Tcl_Release(cbPtr->interp);
+	    Tcl_DecrRefCount(cbPtr->scriptObj);
+	    ckfree(cbPtr);
+	    continue;
+	}
+	prevPtrPtr = &cbPtr->nextPtr;
+    }
+    if (tsdPtr->frameClockList == NULL) {
+	return;
+    }
+
+    /*
+     * Advance the deadline by whole frame intervals.  If the callbacks ran
+     * past the next deadline already, skip the missed frames; the next tick
+     * then lands on the frame grid instead of firing immediately.
+     */
+
+    nowUsec = FrameClockNowUsec();
+    tsdPtr->frameClockDue += tsdPtr->frameClockInterval;
+    if (tsdPtr->frameClockDue <= nowUsec) {
+	tsdPtr->frameClockDue += ((nowUsec - tsdPtr->frameClockDue)
+		/ tsdPtr->frameClockInterval + 1) * tsdPtr->frameClockInterval;
+    }
+    delay = (int) ((tsdPtr->frameClockDue - nowUsec + 999) / 1000);
+    tsdPtr->frameClockTimer = Tcl_CreateTimerHandler(delay,
+	    FrameClockTimerProc, NULL);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkFrameclockObjCmd --
+ *
+ *	This function is invoked to process the "tk frameclock" Tcl command.
+ *	It maintains a per-thread clock that ticks once per display frame
+ *	and runs the attached callback scripts on each tick.  The X servers
+ *	reachable from this code offer no usable presentation-timing
+ *	extension, so the clock free-runs at a configurable interval
+ *	(default 16667 microseconds, a 60 Hz frame); unlike chained "after"
+ *	timers, ticks are scheduled from absolute deadlines and therefore do
+ *	not accumulate drift, and late frames are skipped instead of being
+ *	delivered in a burst.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Callbacks may be attached or detached and a timer handler may be
+ *	created or cancelled.
+ *
+ *----------------------------------------------------------------------
+ */
+
+#define FRAME_CLOCK_DEFAULT_US	16667
+
+int
+TkFrameclockObjCmd(
+    TCL_UNUSED(ClientData),
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    static const char *const frameclockOptions[] = {
+	"attach", "detach", "interval", NULL
+    };
+    enum frameclockOption {
+	FRAMECLOCK_ATTACH, FRAMECLOCK_DETACH, FRAMECLOCK_INTERVAL
+    };
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    FrameClockCallback *cbPtr, **prevPtrPtr;
+    int index, interval;
+
+    if (objc < 2) {
+	Tcl_WrongNumArgs(interp, 1, objv, "option ?arg?");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[1], frameclockOptions, "option", 0,
+	    &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (tsdPtr->frameClockInterval <= 0) {
+	tsdPtr->frameClockInterval = FRAME_CLOCK_DEFAULT_US;
+    }
+
+    switch ((enum frameclockOption) index) {
+    case FRAMECLOCK_ATTACH:
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "script");
+	    return TCL_ERROR;
+	}
+	cbPtr = (FrameClockCallback *)ckalloc(sizeof(FrameClockCallback));
+	cbPtr->interp = interp;
+	cbPtr->scriptObj = objv[2];
+	Tcl_IncrRefCount(cbPtr->scriptObj);
+	Tcl_Preserve(interp);
+	cbPtr->nextPtr = tsdPtr->frameClockList;
+	tsdPtr->frameClockList = cbPtr;
+	if (tsdPtr->frameClockTimer == NULL) {
+	    tsdPtr->frameClockDue = FrameClockNowUsec()
+		    + tsdPtr->frameClockInterval;
+	    tsdPtr->frameClockTimer = Tcl_CreateTimerHandler(
+		    (tsdPtr->frameClockInterval + 999) / 1000,
+		    FrameClockTimerProc, NULL);
+	}
+	return TCL_OK;
+
+    case FRAMECLOCK_DETACH:
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "script");
+	    return TCL_ERROR;
+	}
+	for (prevPtrPtr = &tsdPtr->frameClockList;
+		(cbPtr = *prevPtrPtr) != NULL;
+		prevPtrPtr = &cbPtr->nextPtr) {
+	    if ((cbPtr->interp == interp) && !strcmp(
+		    Tcl_GetString(cbPtr->scriptObj),
+		    Tcl_GetString(objv[2]))) {
+		*prevPtrPtr = cbPtr->nextPtr;
+		Tcl_Release(cbPtr->interp);
+		Tcl_DecrRefCount(cbPtr->scriptObj);
+		ckfree(cbPtr);
+		if (tsdPtr->frameClockList == NULL
+			&& tsdPtr->frameClockTimer != NULL) {
+		    Tcl_DeleteTimerHandler(tsdPtr->frameClockTimer);
+		    tsdPtr->frameClockTimer = NULL;
+		}
+		return TCL_OK;
+	    }
+	}
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"script \"%s\" is not attached to the frame clock",
+		Tcl_GetString(objv[2])));
+	Tcl_SetErrorCode(interp, "TK", "FRAMECLOCK", "NOT_ATTACHED", NULL);
+	return TCL_ERROR;
+
+    case FRAMECLOCK_INTERVAL:
+	if (objc == 2) {
+	    Tcl_SetObjResult(interp,
+		    Tcl_NewIntObj(tsdPtr->frameClockInterval));
+	    return TCL_OK;
+	}
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "?microseconds?");
+	    return TCL_ERROR;
+	}
+	if (Tcl_GetIntFromObj(interp, objv[2], &interval) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (interval <= 0) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "invalid interval %d: must be a positive number of "
+		    "microseconds", interval));
+	    Tcl_SetErrorCode(interp, "TK", "FRAMECLOCK", "BAD_INTERVAL",
+		    NULL);
+	    return TCL_ERROR;
+	}
+	tsdPtr->frameClockInterval = interval;
+	return TCL_OK;
+    }
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkFrameClockIntervalUsec --
+ *
+ *	Returns the frame interval of this thread's frame clock in
+ *	microseconds, so that native animation drivers can pace themselves
+ *	on the same frame grid as "tk frameclock" callbacks.
+ *
+ * Results:
+ *	The interval in microseconds.
+ *
+ * Side effects:
+ *	Initializes the interval to its default on first use.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkFrameClockIntervalUsec(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (tsdPtr->frameClockInterval <= 0) {
+	tsdPtr->frameClockInterval = FRAME_CLOCK_DEFAULT_US;
+    }
+    return tsdPtr->frameClockInterval;
 }
 
 /*
@@ -1500,6 +1911,45 @@ Tk_CollapseMotionEvents(
     }
     return prev;
 }
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * Tk_CollapseWheelEvents --
+ *
+ *	This function controls whether we accumulate the deltas of
+ *	successive mouse wheel events in a particular display or not.
+ *	This is off by default on Windows and Aqua because it reduces the
+ *	number of wheel events a script observes; the Unix port turns it
+ *	on for X11 displays, where scrolling devices report long bursts
+ *	of small emulated button presses.
+ *
+ * Results:
+ *	The return value is the previous collapse value in effect.
+ *
+ * Side effects:
+ *	Filtering of mouse wheel events may be changed after calling this.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+Tk_CollapseWheelEvents(
+    Display *display,		/* Display handling these events. */
+    int collapse)		/* Boolean value that specifies whether the
+				 * deltas of successive wheel events should
+				 * be accumulated. */
+{
+    TkDisplay *dispPtr = (TkDisplay *) display;
+    int prev = (dispPtr->flags & TK_DISPLAY_COLLAPSE_WHEEL_EVENTS);
+
+    if (collapse) {
+	dispPtr->flags |= TK_DISPLAY_COLLAPSE_WHEEL_EVENTS;
+    } else {
+	dispPtr->flags &= ~TK_DISPLAY_COLLAPSE_WHEEL_EVENTS;
+    }
+    return prev;
+}
 
 /*
  *----------------------------------------------------------------------
@@ -1549,7 +1999,8 @@ Tk_QueueWindowEvent(
      * motion data)
      */
 
-    if (!(dispPtr->flags & TK_DISPLAY_COLLAPSE_MOTION_EVENTS)) {
+    if (!(dispPtr->flags & (TK_DISPLAY_COLLAPSE_MOTION_EVENTS
+	    | TK_DISPLAY_COLLAPSE_WHEEL_EVENTS))) {
 	wevPtr = (TkWindowEvent *)ckalloc(sizeof(TkWindowEvent));
 	wevPtr->header.proc = WindowEventProc;
 	wevPtr->event = *eventPtr;
@@ -1582,10 +2033,43 @@ Tk_QueueWindowEvent(
 	}
     }
 
+    if ((dispPtr->delayedWheelPtr != NULL) && (position == TCL_QUEUE_TAIL)) {
+	if ((eventPtr->type == MouseWheelEvent) && (eventPtr->xkey.window
+		== dispPtr->delayedWheelPtr->event.xkey.window)
+		&& (eventPtr->xkey.state
+		== dispPtr->delayedWheelPtr->event.xkey.state)) {
+	    /*
+	     * The new event is a wheel event for the same window and with
+	     * the same modifiers as the saved wheel event. Replace the saved
+	     * event with the new one, accumulating the deltas.
+	     */
+
+	    int delta = (int) dispPtr->delayedWheelPtr->event.xkey.keycode
+		    + (int) eventPtr->xkey.keycode;
+
+	    dispPtr->delayedWheelPtr->event = *eventPtr;
+	    dispPtr->delayedWheelPtr->event.xkey.keycode = (unsigned) delta;
+	    return;
+	} else if ((eventPtr->type != GraphicsExpose)
+		&& (eventPtr->type != NoExpose)
+		&& (eventPtr->type != Expose)) {
+	    /*
+	     * The new event may conflict with the saved wheel event. Queue
+	     * the saved wheel event now so that it will be processed before
+	     * the new event.
+	     */
+
+	    Tcl_QueueEvent(&dispPtr->delayedWheelPtr->header, position);
+	    dispPtr->delayedWheelPtr = NULL;
+	    Tcl_CancelIdleCall(DelayedWheelProc, dispPtr);
+	}
+    }
+
     wevPtr = (TkWindowEvent *)ckalloc(sizeof(TkWindowEvent));
     wevPtr->header.proc = WindowEventProc;
     wevPtr->event = *eventPtr;
-    if ((eventPtr->type == MotionNotify) && (position == TCL_QUEUE_TAIL)) {
+    if ((eventPtr->type == MotionNotify) && (position == TCL_QUEUE_TAIL)
+	    && (dispPtr->flags & TK_DISPLAY_COLLAPSE_MOTION_EVENTS)) {
 	/*
 	 * The new event is a motion event so don't queue it immediately; save
 	 * it around in case another motion event arrives that it can be
@@ -1597,11 +2081,161 @@ Tk_QueueWindowEvent(
 	}
 	dispPtr->delayedMotionPtr = wevPtr;
 	Tcl_DoWhenIdle(DelayedMotionProc, dispPtr);
+    } else if ((eventPtr->type == MouseWheelEvent)
+	    && (position == TCL_QUEUE_TAIL)
+	    && (dispPtr->flags & TK_DISPLAY_COLLAPSE_WHEEL_EVENTS)) {
+	/*
+	 * The new event is a wheel event so don't queue it immediately; save
+	 * it around in case more wheel events arrive whose deltas can be
+	 * accumulated into it.
+	 */
+
+	if (dispPtr->delayedWheelPtr != NULL) {
+	    Tcl_Panic("Tk_QueueWindowEvent found unexpected delayed wheel event");
+	}
+	dispPtr->delayedWheelPtr = wevPtr;
+	Tcl_DoWhenIdle(DelayedWheelProc, dispPtr);
     } else {
 	Tcl_QueueEvent(&wevPtr->header, position);
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * Tk_QueueThreadWindowEvent --
+ *
+ *	Given an X-style window event, this function posts it from the
+ *	current thread to the event queue of the thread identified by
+ *	threadId, typically the thread running the Tk event loop. Unlike
+ *	calling Tcl_ThreadQueueEvent directly, posted events are staged and
+ *	transferred in batches: a burst of posted events acquires the target
+ *	thread's queue lock and wakes the target thread only once.
+ *
+ *	This function may be called from any thread. It is the only function
+ *	in Tk that may be, apart from the Tcl stubs.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The event is appended to the staging list of the target thread, and
+ *	the target thread is alerted if it has not been alerted already.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+Tk_QueueThreadWindowEvent(
+    Tcl_ThreadId threadId,	/* Identifier for thread to use. */
+    XEvent *eventPtr)		/* Event to add to the thread's queue. This
+				 * function copies it before posting. */
+{
+    ThreadEventStaging *stagingPtr;
+    StagedWindowEvent *stagedPtr;
+    int mustAlert = 0;
+
+    stagedPtr = (StagedWindowEvent *)ckalloc(sizeof(StagedWindowEvent));
+    stagedPtr->event = *eventPtr;
+    stagedPtr->nextPtr = NULL;
+
+    Tcl_MutexLock(&stagingMutex);
+    for (stagingPtr = firstStagingPtr; stagingPtr != NULL;
+	    stagingPtr = stagingPtr->nextPtr) {
+	if (stagingPtr->threadId == threadId) {
+	    break;
+	}
+    }
+    if (stagingPtr == NULL) {
+	stagingPtr = (ThreadEventStaging *)ckalloc(sizeof(ThreadEventStaging));
+	stagingPtr->threadId = threadId;
+	stagingPtr->firstPtr = NULL;
+	stagingPtr->lastPtr = NULL;
+	stagingPtr->wakeupPosted = 0;
+	stagingPtr->nextPtr = firstStagingPtr;
+	firstStagingPtr = stagingPtr;
+    }
+    if (stagingPtr->lastPtr == NULL) {
+	stagingPtr->firstPtr = stagedPtr;
+    } else {
+	stagingPtr->lastPtr->nextPtr = stagedPtr;
+    }
+    stagingPtr->lastPtr = stagedPtr;
+    if (!stagingPtr->wakeupPosted) {
+	stagingPtr->wakeupPosted = 1;
+	mustAlert = 1;
+    }
+    Tcl_MutexUnlock(&stagingMutex);
+
+    if (mustAlert) {
+	Tcl_Event *evPtr = (Tcl_Event *)ckalloc(sizeof(Tcl_Event));
+
+	evPtr->proc = StagedWindowEventProc;
+	Tcl_ThreadQueueEvent(threadId, evPtr, TCL_QUEUE_TAIL);
+	Tcl_ThreadAlert(threadId);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * StagedWindowEventProc --
+ *
+ *	This function is called by Tcl_DoOneEvent in the target thread when
+ *	window events have been posted from other threads. It drains the
+ *	staging list of the current thread and requeues every staged event
+ *	locally with Tk_QueueWindowEvent, so posted events get exactly the
+ *	same treatment (restrict procedures, motion and wheel event
+ *	collapsing) as events read from the display.
+ *
+ * Results:
+ *	Returns 1 if the event was handled, meaning it should be removed
+ *	from the queue. Returns 0 if the event was not handled, meaning it
+ *	should stay on the queue, which happens when the TCL_WINDOW_EVENTS
+ *	bit isn't set in flags.
+ *
+ * Side effects:
+ *	Staged events are moved onto the Tcl event queue of this thread.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+StagedWindowEventProc(
+    TCL_UNUSED(Tcl_Event *),	/* Drain marker event; carries no payload. */
+    int flags)			/* Flags that indicate what events to handle,
+				 * such as TCL_WINDOW_EVENTS. */
+{
+    Tcl_ThreadId threadId = Tcl_GetCurrentThread();
+    ThreadEventStaging *stagingPtr;
+    StagedWindowEvent *stagedPtr = NULL;
+    StagedWindowEvent *nextPtr;
+
+    if (!(flags & TCL_WINDOW_EVENTS)) {
+	return 0;
+    }
+
+    Tcl_MutexLock(&stagingMutex);
+    for (stagingPtr = firstStagingPtr; stagingPtr != NULL;
+	    stagingPtr = stagingPtr->nextPtr) {
+	if (stagingPtr->threadId == threadId) {
+	    stagedPtr = stagingPtr->firstPtr;
+	    stagingPtr->firstPtr = NULL;
+	    stagingPtr->lastPtr = NULL;
+	    stagingPtr->wakeupPosted = 0;
+	    break;
+	}
+    }
+    Tcl_MutexUnlock(&stagingMutex);
+
+    for ( ; stagedPtr != NULL; stagedPtr = nextPtr) {
+	nextPtr = stagedPtr->nextPtr;
+	Tk_QueueWindowEvent(&stagedPtr->event, TCL_QUEUE_TAIL);
+	ckfree(stagedPtr);
+    }
+    return 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -1822,6 +2456,39 @@ DelayedMotionProc(
     Tcl_QueueEvent(&dispPtr->delayedMotionPtr->header, TCL_QUEUE_TAIL);
     dispPtr->delayedMotionPtr = NULL;
 }
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DelayedWheelProc --
+ *
+ *	This function is invoked as an idle handler when a mouse wheel event
+ *	has been delayed. It queues the delayed event, carrying the
+ *	accumulated delta, so that it will finally be serviced.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The delayed mouse wheel event gets added to the Tcl event queue for
+ *	servicing.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DelayedWheelProc(
+    ClientData clientData)	/* Pointer to display containing a delayed
+				 * wheel event to be serviced. */
+{
+    TkDisplay *dispPtr = (TkDisplay *)clientData;
+
+    if (dispPtr->delayedWheelPtr == NULL) {
+	Tcl_Panic("DelayedWheelProc found no delayed mouse wheel event");
+    }
+    Tcl_QueueEvent(&dispPtr->delayedWheelPtr->header, TCL_QUEUE_TAIL);
+    dispPtr->delayedWheelPtr = NULL;
+}
 
 /*
  *----------------------------------------------------------------------
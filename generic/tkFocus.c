@@ -67,6 +67,28 @@ typedef struct TkDisplayFocusInfo {
 				 * for a given application. */
 } DisplayFocusInfo;
 
+/*
+ * For each top-level window whose focus traversal order has been requested
+ * since the widget hierarchy last changed, one record of the following type
+ * caches that order. The order is the pre-order walk of the top-level and its
+ * non-top-level descendants that tk_focusNext and tk_focusPrev used to
+ * recompute with repeated [winfo] calls on every keystroke; caching it here
+ * makes traversal cost independent of the widget count. The records hang off
+ * the TkMainInfo structure and are discarded wholesale whenever a window is
+ * created, destroyed, restacked or re-managed anywhere in the application.
+ */
+
+typedef struct TkFocusOrderInfo {
+    TkWindow *topLevelPtr;	/* Top-level whose traversal order this
+				 * record caches. */
+    Tcl_Obj *orderObj;		/* List object holding the path names of the
+				 * top-level and its descendants in traversal
+				 * order. Holds a reference count. */
+    struct TkFocusOrderInfo *nextPtr;
+				/* Next in list of all traversal order records
+				 * for a given application. */
+} FocusOrderInfo;
+
 /*
  * Debugging support...
  */
@@ -80,6 +102,7 @@ typedef struct TkDisplayFocusInfo {
  * Forward declarations for functions defined in this file:
  */
 
+static void		AppendFocusOrder(TkWindow *winPtr, Tcl_Obj *listObj);
 static DisplayFocusInfo*FindDisplayFocusInfo(TkMainInfo *mainPtr,
 			    TkDisplay *dispPtr);
 static void		FocusMapProc(ClientData clientData, XEvent *eventPtr);
@@ -226,6 +249,155 @@ Tk_FocusObjCmd(
     }
     return TCL_OK;
 }
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkFocusOrderObjCmd --
+ *
+ *	This function is invoked to process the "::tk::FocusTraversalOrder"
+ *	Tcl command, the native helper behind tk_focusNext and tk_focusPrev.
+ *	Given a window it returns the focus traversal order of the window's
+ *	top-level: the path names of the top-level and its non-top-level
+ *	descendants, in a pre-order walk with the stacking order determining
+ *	the order of siblings. The order is computed at most once per change
+ *	to the widget hierarchy; subsequent calls return the cached list.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	A traversal order record may be created and linked onto the
+ *	application's list.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkFocusOrderObjCmd(
+    ClientData clientData,	/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    Tk_Window tkwin = (Tk_Window)clientData;
+    TkWindow *winPtr, *topLevelPtr;
+    FocusOrderInfo *orderPtr;
+
+    if (objc != 2) {
+	Tcl_WrongNumArgs(interp, 1, objv, "window");
+	return TCL_ERROR;
+    }
+    winPtr = (TkWindow *) Tk_NameToWindow(interp, Tcl_GetString(objv[1]),
+	    tkwin);
+    if (winPtr == NULL) {
+	return TCL_ERROR;
+    }
+
+    for (topLevelPtr = winPtr; ; topLevelPtr = topLevelPtr->parentPtr) {
+	if (topLevelPtr == NULL) {
+	    /*
+	     * The window is being deleted; there is no order to report.
+	     */
+
+	    return TCL_OK;
+	}
+	if (topLevelPtr->flags & TK_TOP_HIERARCHY) {
+	    break;
+	}
+    }
+
+    for (orderPtr = winPtr->mainPtr->focusOrderPtr; orderPtr != NULL;
+	    orderPtr = orderPtr->nextPtr) {
+	if (orderPtr->topLevelPtr == topLevelPtr) {
+	    break;
+	}
+    }
+    if (orderPtr == NULL) {
+	orderPtr = (FocusOrderInfo *)ckalloc(sizeof(FocusOrderInfo));
+	orderPtr->topLevelPtr = topLevelPtr;
+	orderPtr->orderObj = Tcl_NewListObj(0, NULL);
+	Tcl_IncrRefCount(orderPtr->orderObj);
+	AppendFocusOrder(topLevelPtr, orderPtr->orderObj);
+	orderPtr->nextPtr = winPtr->mainPtr->focusOrderPtr;
+	winPtr->mainPtr->focusOrderPtr = orderPtr;
+    }
+    Tcl_SetObjResult(interp, orderPtr->orderObj);
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * AppendFocusOrder --
+ *
+ *	Append the path names of winPtr and its descendants to listObj in
+ *	focus traversal order. Anonymous windows and descendants that are
+ *	themselves top-levels are skipped, matching the script-level
+ *	traversal that this order replaces.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Elements are appended to listObj.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+AppendFocusOrder(
+    TkWindow *winPtr,		/* Window whose subtree is to be listed. */
+    Tcl_Obj *listObj)		/* Unshared list to append path names to. */
+{
+    TkWindow *childPtr;
+
+    Tcl_ListObjAppendElement(NULL, listObj,
+	    Tcl_NewStringObj(winPtr->pathName, -1));
+    for (childPtr = winPtr->childList; childPtr != NULL;
+	    childPtr = childPtr->nextPtr) {
+	if (childPtr->flags & (TK_ANONYMOUS_WINDOW|TK_TOP_HIERARCHY)) {
+	    continue;
+	}
+	AppendFocusOrder(childPtr, listObj);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkFocusOrderInvalidate --
+ *
+ *	This function is invoked whenever the widget hierarchy of an
+ *	application changes in a way that could affect focus traversal: a
+ *	named window was created or destroyed, a window was restacked, or a
+ *	window changed between top-level and internal status. It discards
+ *	all cached traversal orders for the application; they are recomputed
+ *	lazily the next time traversal is requested.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	All traversal order records for the application are freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkFocusOrderInvalidate(
+    TkMainInfo *mainPtr)	/* Record that identifies a particular
+				 * application. */
+{
+    while (mainPtr->focusOrderPtr != NULL) {
+	FocusOrderInfo *orderPtr = mainPtr->focusOrderPtr;
+
+	mainPtr->focusOrderPtr = orderPtr->nextPtr;
+	Tcl_DecrRefCount(orderPtr->orderObj);
+	ckfree(orderPtr);
+    }
+}
+
 
 /*
  *--------------------------------------------------------------
@@ -1059,6 +1231,7 @@ TkFocusFree(
 	mainPtr->tlFocusPtr = mainPtr->tlFocusPtr->nextPtr;
 	ckfree(tlFocusPtr);
     }
+    TkFocusOrderInvalidate(mainPtr);
 }
 
 /*
@@ -1088,6 +1261,7 @@ TkFocusSplit(
     TkWindow *topLevelPtr, *subWinPtr;
 
     FindDisplayFocusInfo(winPtr->mainPtr, winPtr->dispPtr);
+    TkFocusOrderInvalidate(winPtr->mainPtr);
 
     /*
      * Find the top-level window for winPtr, then find (or create) a record
@@ -1184,6 +1358,10 @@ TkFocusJoin(
 {
     ToplevelFocusInfo *tlFocusPtr, *tmpPtr;
 
+    if (winPtr && winPtr->mainPtr) {
+	TkFocusOrderInvalidate(winPtr->mainPtr);
+    }
+
     /*
      * Remove old toplevel record
      */
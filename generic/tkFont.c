@@ -50,6 +50,28 @@ typedef struct NamedFont {
     TkFontAttributes fa;	/* Desired attributes for named font. */
 } NamedFont;
 
+/*
+ * The following structure is used by the "tk fontcache warm" command to keep
+ * track of a batch of fonts that are being resolved during idle time. The
+ * resolved fonts stay referenced until the application's main window is
+ * destroyed, so the entries they create in the fontCache hash table remain
+ * warm for later Tk_GetFont calls.
+ */
+
+typedef struct FontWarmer {
+    Tcl_Interp *interp;		/* Interpreter in which the warm-up was
+				 * requested. */
+    Tk_Window tkwin;		/* Main window of the application whose font
+				 * cache is being warmed. */
+    int numFonts;		/* Number of entries in the names and fonts
+				 * arrays. */
+    int nextFont;		/* Index of the next name to resolve. */
+    char **names;		/* Malloc-ed array of malloc-ed font names
+				 * still to be resolved. */
+    Tk_Font *fonts;		/* Malloc-ed array of fonts resolved so far;
+				 * entries may be NULL if resolution failed. */
+} FontWarmer;
+
 /*
  * The following two structures are used to keep track of string measurement
  * information when using the text layout facilities.
@@ -94,6 +116,15 @@ typedef struct TextLayout {
     const char *string;		/* The string that was layed out. */
     int width;			/* The maximum width of all lines in the text
 				 * layout. */
+    int refCount;		/* Number of holders of this layout: the
+				 * callers it was handed to plus the layout
+				 * cache. The layout is freed when this drops
+				 * to zero. */
+    char *ownedString;		/* If non-NULL, a private copy of the string
+				 * the layout was computed from, freed along
+				 * with the layout. Cached layouts always own
+				 * their string so they never reference
+				 * caller-owned memory. */
     int numChunks;		/* Number of chunks actually used in following
 				 * array. */
     LayoutChunk chunks[TKFLEXARRAY];/* Array of chunks. The actual size will be
@@ -101,6 +132,65 @@ typedef struct TextLayout {
 				 * THE STRUCTURE. */
 } TextLayout;
 
+/*
+ * The following structures implement a per-thread cache of text layouts, so
+ * that redrawing a widget whose text, font and layout options are unchanged
+ * does not recompute the layout from scratch. The cache is organized as an
+ * array of buckets selected by a hash of the string, each kept in least-
+ * recently-used order, so that a full repaint of a widget with many distinct
+ * cells (a treeview with dozens of columns, say) neither thrashes the cache
+ * nor pays a long linear scan per cell.
+ */
+
+#define LAYOUT_CACHE_BUCKETS	64
+				/* Number of hash buckets; must be a power of
+				 * 2. */
+#define LAYOUT_CACHE_BUCKET_SIZE 8
+				/* Maximum number of cached layouts per
+				 * bucket. */
+#define LAYOUT_CACHE_MAX_BYTES	256
+				/* Longest string worth caching; layouts of
+				 * longer strings bypass the cache. */
+
+typedef struct CachedLayout {
+    TextLayout *layoutPtr;	/* Cached layout; the cache holds one
+				 * reference to it. */
+    int numBytes;		/* Length of the laid-out string, which is
+				 * the layout's ownedString. */
+    int wrapLength;		/* The remaining inputs the layout was
+				 * computed from. */
+    Tk_Justify justify;
+    int flags;
+    int width, height;		/* The resulting dimensions. */
+    struct CachedLayout *nextPtr;
+				/* Next in list of cached layouts, most
+				 * recently used first. */
+} CachedLayout;
+
+typedef struct ThreadSpecificData {
+    CachedLayout *layoutCache[LAYOUT_CACHE_BUCKETS];
+				/* Hash buckets of cached layouts, each most
+				 * recently used first. */
+    int layoutCacheCount[LAYOUT_CACHE_BUCKETS];
+				/* Number of entries in each bucket. */
+} ThreadSpecificData;
+static Tcl_ThreadDataKey dataKey;
+
+/*
+ * Hash a string into a layout cache bucket index. The multiplier is the
+ * same one Tcl uses for string hashing.
+ */
+
+#define LAYOUT_CACHE_BUCKET(string, numBytes, bucket) \
+    do {								\
+	unsigned int h_ = (unsigned int) (numBytes);			\
+	int i_;								\
+	for (i_ = 0; i_ < (numBytes); i_++) {				\
+	    h_ = (h_ * 9) + (unsigned char) (string)[i_];		\
+	}								\
+	(bucket) = h_ & (LAYOUT_CACHE_BUCKETS - 1);			\
+    } while (0)
+
 /*
  * The following structures are used as two-way maps between the values for
  * the fields in the TkFontAttributes structure and the strings used in Tcl,
@@ -327,7 +417,17 @@ static int		ConfigAttributesObj(Tcl_Interp *interp,
 			    Tk_Window tkwin, int objc, Tcl_Obj *const objv[],
 			    TkFontAttributes *faPtr);
 static void		DupFontObjProc(Tcl_Obj *srcObjPtr, Tcl_Obj *dupObjPtr);
+static void		CacheLayout(TextLayout *layoutPtr, int numBytes,
+			    int wrapLength, Tk_Justify justify, int flags,
+			    int width, int height);
 static int		FieldSpecified(const char *field);
+static TextLayout *	FindCachedLayout(Tk_Font tkfont, const char *string,
+			    int numBytes, int wrapLength, Tk_Justify justify,
+			    int flags, int *widthPtr, int *heightPtr);
+static void		FontWarmEventProc(ClientData clientData,
+			    XEvent *eventPtr);
+static void		FontWarmIdleProc(ClientData clientData);
+static void		FreeCachedLayouts(Tk_Font tkfont);
 static void		FreeFontObj(Tcl_Obj *objPtr);
 static void		FreeFontObjProc(Tcl_Obj *objPtr);
 static int		GetAttributeInfoObj(Tcl_Interp *interp,
@@ -448,6 +548,187 @@ TkFontPkgFree(
     ckfree(fiPtr);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * TkFontcacheObjCmd --
+ *
+ *	This function is invoked to process the "tk fontcache" Tcl command. The
+ *	"warm" option resolves a list of fonts one at a time during idle
+ *	periods, so that the first widget to actually display a given font
+ *	does not pay the full cost of pattern matching and platform font
+ *	initialization.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Schedules idle callbacks that populate the fontCache hash table. The
+ *	warmed fonts stay referenced until the main window is destroyed.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+int
+TkFontcacheObjCmd(
+    ClientData clientData,	/* Main window associated with interpreter. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    Tk_Window tkwin = (Tk_Window)clientData;
+    static const char *const optionStrings[] = {
+	"warm", NULL
+    };
+    enum options {
+	FONTCACHE_WARM
+    };
+    int index;
+
+    if (objc < 2) {
+	Tcl_WrongNumArgs(interp, 1, objv, "option ?arg?");
+	return TCL_ERROR;
+    }
+    if (Tcl_GetIndexFromObj(interp, objv[1], optionStrings, "option", 0,
+	    &index) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    switch ((enum options) index) {
+    case FONTCACHE_WARM: {
+	FontWarmer *warmerPtr;
+	Tcl_Obj **elemPtrs;
+	int i, count, length;
+	const char *name;
+
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "fontList");
+	    return TCL_ERROR;
+	}
+	if (Tcl_ListObjGetElements(interp, objv[2], &count, &elemPtrs)
+		!= TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (count == 0) {
+	    break;
+	}
+
+	warmerPtr = (FontWarmer *)ckalloc(sizeof(FontWarmer));
+	warmerPtr->interp = interp;
+	warmerPtr->tkwin = tkwin;
+	warmerPtr->numFonts = count;
+	warmerPtr->nextFont = 0;
+	warmerPtr->names = (char **)ckalloc(count * sizeof(char *));
+	warmerPtr->fonts = (Tk_Font *)ckalloc(count * sizeof(Tk_Font));
+	for (i = 0; i < count; i++) {
+	    name = Tcl_GetStringFromObj(elemPtrs[i], &length);
+	    warmerPtr->names[i] = (char *)ckalloc(length + 1);
+	    memcpy(warmerPtr->names[i], name, length + 1);
+	}
+
+	/*
+	 * The event handler cleans up the warmer (and releases the warmed
+	 * fonts) when the main window goes away; this happens before
+	 * TkFontPkgFree tears down the fontCache hash table.
+	 */
+
+	Tk_CreateEventHandler(tkwin, StructureNotifyMask, FontWarmEventProc,
+		warmerPtr);
+	Tcl_DoWhenIdle(FontWarmIdleProc, warmerPtr);
+	break;
+    }
+    }
+    return TCL_OK;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FontWarmIdleProc --
+ *
+ *	This function is invoked at idle time to resolve the next font in a
+ *	warm-up batch. Only one font is resolved per callback so that warming
+ *	never delays a pending redraw by more than one font's worth of work.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Resolves a font, which creates an entry in the fontCache hash table
+ *	and primes the platform font caches. Reschedules itself while fonts
+ *	remain to be resolved.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+static void
+FontWarmIdleProc(
+    ClientData clientData)	/* Pointer to FontWarmer record. */
+{
+    FontWarmer *warmerPtr = (FontWarmer *)clientData;
+    Tk_Font tkfont;
+
+    tkfont = Tk_GetFont(warmerPtr->interp, warmerPtr->tkwin,
+	    warmerPtr->names[warmerPtr->nextFont]);
+    if (tkfont == NULL) {
+	/*
+	 * Warming is best effort: ignore names that do not resolve and
+	 * don't leave an error message lying around in the interpreter.
+	 */
+
+	Tcl_ResetResult(warmerPtr->interp);
+    }
+    warmerPtr->fonts[warmerPtr->nextFont] = tkfont;
+    warmerPtr->nextFont++;
+    if (warmerPtr->nextFont < warmerPtr->numFonts) {
+	Tcl_DoWhenIdle(FontWarmIdleProc, warmerPtr);
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FontWarmEventProc --
+ *
+ *	This function is invoked when the main window of an application with a
+ *	pending or completed font warm-up is destroyed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Releases the warmed fonts and frees the FontWarmer record.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+static void
+FontWarmEventProc(
+    ClientData clientData,	/* Pointer to FontWarmer record. */
+    XEvent *eventPtr)		/* Information about event. */
+{
+    FontWarmer *warmerPtr = (FontWarmer *)clientData;
+    int i;
+
+    if (eventPtr->type != DestroyNotify) {
+	return;
+    }
+    if (warmerPtr->nextFont < warmerPtr->numFonts) {
+	Tcl_CancelIdleCall(FontWarmIdleProc, warmerPtr);
+    }
+    for (i = 0; i < warmerPtr->nextFont; i++) {
+	if (warmerPtr->fonts[i] != NULL) {
+	    Tk_FreeFont(warmerPtr->fonts[i]);
+	}
+    }
+    for (i = 0; i < warmerPtr->numFonts; i++) {
+	ckfree(warmerPtr->names[i]);
+    }
+    ckfree(warmerPtr->names);
+    ckfree(warmerPtr->fonts);
+    ckfree(warmerPtr);
+}
+
 /*
  *---------------------------------------------------------------------------
  *
@@ -861,6 +1142,7 @@ UpdateDependentFonts(
 		fontPtr != NULL; fontPtr = fontPtr->nextPtr) {
 	    if (fontPtr->namedHashPtr == namedHashPtr) {
 		TkpGetFontFromAttributes(fontPtr, tkwin, &nfPtr->fa);
+		FreeCachedLayouts((Tk_Font) fontPtr);
 		if (!fiPtr->updatePending) {
 		    fiPtr->updatePending = 1;
 		    Tcl_DoWhenIdle(TheWorldHasChanged, fiPtr);
@@ -1105,6 +1387,7 @@ Tk_AllocFontFromObj(
 				 * native format, or parseable string. */
 {
     TkFontInfo *fiPtr = ((TkWindow *) tkwin)->mainPtr->fontInfoPtr;
+    int scalingEpoch = ((TkWindow *) tkwin)->dispPtr->scalingEpoch;
     Tcl_HashEntry *cacheHashPtr, *namedHashPtr;
     TkFont *fontPtr, *firstFontPtr, *oldFontPtr;
     int isNew, descent;
@@ -1125,7 +1408,8 @@ Tk_AllocFontFromObj(
 
 	    FreeFontObj(objPtr);
 	    oldFontPtr = NULL;
-	} else if (Tk_Screen(tkwin) == oldFontPtr->screen) {
+	} else if ((Tk_Screen(tkwin) == oldFontPtr->screen)
+		&& (oldFontPtr->scalingEpoch == scalingEpoch)) {
 	    oldFontPtr->resourceRefCount++;
 	    return (Tk_Font) oldFontPtr;
 	}
@@ -1133,7 +1417,8 @@ Tk_AllocFontFromObj(
 
     /*
      * Next, search the list of fonts that have the name we want, to see if
-     * one of them is for the right screen.
+     * one of them is for the right screen and was sized under the current
+     * [tk scaling] ratio.
      */
 
     isNew = 0;
@@ -1147,7 +1432,8 @@ Tk_AllocFontFromObj(
     firstFontPtr = (TkFont *)Tcl_GetHashValue(cacheHashPtr);
     for (fontPtr = firstFontPtr; (fontPtr != NULL);
 	    fontPtr = fontPtr->nextPtr) {
-	if (Tk_Screen(tkwin) == fontPtr->screen) {
+	if ((Tk_Screen(tkwin) == fontPtr->screen)
+		&& (fontPtr->scalingEpoch == scalingEpoch)) {
 	    fontPtr->resourceRefCount++;
 	    fontPtr->objRefCount++;
 	    objPtr->internalRep.twoPtrValue.ptr1 = fontPtr;
@@ -1218,6 +1504,7 @@ Tk_AllocFontFromObj(
     fontPtr->cacheHashPtr = cacheHashPtr;
     fontPtr->namedHashPtr = namedHashPtr;
     fontPtr->screen = Tk_Screen(tkwin);
+    fontPtr->scalingEpoch = scalingEpoch;
     fontPtr->nextPtr = firstFontPtr;
     Tcl_SetHashValue(cacheHashPtr, fontPtr);
 
@@ -1441,6 +1728,7 @@ Tk_FreeFont(
     if (fontPtr->resourceRefCount-- > 1) {
 	return;
     }
+    FreeCachedLayouts(tkfont);
     if (fontPtr->namedHashPtr != NULL) {
 	/*
 	 * This font derived from a named font. Reduce the reference count on
@@ -1919,6 +2207,187 @@ TkUnderlineCharsInContext(
 	    (unsigned) fontPtr->underlineHeight);
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FindCachedLayout --
+ *
+ *	Look in the per-thread layout cache for a layout that was computed
+ *	from the same font, string and layout options.
+ *
+ * Results:
+ *	On a hit, returns the cached layout with its reference count
+ *	incremented and stores its dimensions in *widthPtr and *heightPtr;
+ *	the entry is moved to the front of the cache. Returns NULL on a
+ *	miss.
+ *
+ * Side effects:
+ *	None.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+static TextLayout *
+FindCachedLayout(
+    Tk_Font tkfont,		/* Font the text would be laid out in. */
+    const char *string,		/* The string to be laid out. */
+    int numBytes,		/* Length of string, in bytes. */
+    int wrapLength,		/* Wrap length the layout is wanted for,
+				 * after normalization (never 0). */
+    Tk_Justify justify,		/* Justification the layout is wanted for. */
+    int flags,			/* TK_IGNORE_TABS/TK_IGNORE_NEWLINES bits
+				 * only. */
+    int *widthPtr,		/* If non-NULL, filled with layout width on a
+				 * hit. */
+    int *heightPtr)		/* If non-NULL, filled with layout height on
+				 * a hit. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    CachedLayout *entryPtr, *prevPtr;
+    unsigned int bucket;
+
+    LAYOUT_CACHE_BUCKET(string, numBytes, bucket);
+    prevPtr = NULL;
+    for (entryPtr = tsdPtr->layoutCache[bucket]; entryPtr != NULL;
+	    entryPtr = entryPtr->nextPtr) {
+	if ((entryPtr->layoutPtr->tkfont == tkfont)
+		&& (entryPtr->numBytes == numBytes)
+		&& (entryPtr->wrapLength == wrapLength)
+		&& (entryPtr->justify == justify)
+		&& (entryPtr->flags == flags)
+		&& (memcmp(entryPtr->layoutPtr->ownedString, string,
+			numBytes) == 0)) {
+	    if (prevPtr != NULL) {
+		prevPtr->nextPtr = entryPtr->nextPtr;
+		entryPtr->nextPtr = tsdPtr->layoutCache[bucket];
+		tsdPtr->layoutCache[bucket] = entryPtr;
+	    }
+	    if (widthPtr != NULL) {
+		*widthPtr = entryPtr->width;
+	    }
+	    if (heightPtr != NULL) {
+		*heightPtr = entryPtr->height;
+	    }
+	    entryPtr->layoutPtr->refCount++;
+	    return entryPtr->layoutPtr;
+	}
+	prevPtr = entryPtr;
+    }
+    return NULL;
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * CacheLayout --
+ *
+ *	Enter a freshly computed layout into the per-thread layout cache,
+ *	evicting the least recently used entry if the cache is full. The
+ *	layout must own its string.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The layout's reference count is incremented to account for the
+ *	cache's reference. An evicted layout may be freed.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+static void
+CacheLayout(
+    TextLayout *layoutPtr,	/* Layout to cache; must own its string. */
+    int numBytes,		/* Length of the laid-out string. */
+    int wrapLength,		/* The inputs the layout was computed from. */
+    Tk_Justify justify,
+    int flags,
+    int width, int height)	/* The resulting dimensions. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    CachedLayout *entryPtr;
+    unsigned int bucket;
+
+    LAYOUT_CACHE_BUCKET(layoutPtr->ownedString, numBytes, bucket);
+    entryPtr = (CachedLayout *)ckalloc(sizeof(CachedLayout));
+    entryPtr->layoutPtr = layoutPtr;
+    entryPtr->numBytes = numBytes;
+    entryPtr->wrapLength = wrapLength;
+    entryPtr->justify = justify;
+    entryPtr->flags = flags;
+    entryPtr->width = width;
+    entryPtr->height = height;
+    entryPtr->nextPtr = tsdPtr->layoutCache[bucket];
+    tsdPtr->layoutCache[bucket] = entryPtr;
+    layoutPtr->refCount++;
+
+    if (tsdPtr->layoutCacheCount[bucket] < LAYOUT_CACHE_BUCKET_SIZE) {
+	tsdPtr->layoutCacheCount[bucket]++;
+    } else {
+	CachedLayout *lastPtr = tsdPtr->layoutCache[bucket];
+
+	while (lastPtr->nextPtr->nextPtr != NULL) {
+	    lastPtr = lastPtr->nextPtr;
+	}
+	Tk_FreeTextLayout((Tk_TextLayout) lastPtr->nextPtr->layoutPtr);
+	ckfree(lastPtr->nextPtr);
+	lastPtr->nextPtr = NULL;
+    }
+}
+
+/*
+ *---------------------------------------------------------------------------
+ *
+ * FreeCachedLayouts --
+ *
+ *	Flush entries from the per-thread layout cache. This must be called
+ *	whenever a font is freed or re-initialized in place, since cached
+ *	layouts are keyed by the Tk_Font token and hold metrics computed
+ *	from it.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	All cached layouts computed with tkfont (or all cached layouts, if
+ *	tkfont is NULL) are released.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+static void
+FreeCachedLayouts(
+    Tk_Font tkfont)		/* Font whose layouts should be flushed, or
+				 * NULL to flush the entire cache. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    CachedLayout *entryPtr, *prevPtr, *nextPtr;
+    int bucket;
+
+    for (bucket = 0; bucket < LAYOUT_CACHE_BUCKETS; bucket++) {
+	prevPtr = NULL;
+	for (entryPtr = tsdPtr->layoutCache[bucket]; entryPtr != NULL;
+		entryPtr = nextPtr) {
+	    nextPtr = entryPtr->nextPtr;
+	    if ((tkfont == NULL) || (entryPtr->layoutPtr->tkfont == tkfont)) {
+		if (prevPtr == NULL) {
+		    tsdPtr->layoutCache[bucket] = nextPtr;
+		} else {
+		    prevPtr->nextPtr = nextPtr;
+		}
+		Tk_FreeTextLayout((Tk_TextLayout) entryPtr->layoutPtr);
+		ckfree(entryPtr);
+		tsdPtr->layoutCacheCount[bucket]--;
+	    } else {
+		prevPtr = entryPtr;
+	    }
+	}
+    }
+}
+
 /*
  *---------------------------------------------------------------------------
  *
@@ -1971,6 +2440,8 @@ Tk_ComputeTextLayout(
     const char *start, *endp, *special;
     int n, y, bytesThisChunk, maxChunks, curLine, layoutHeight;
     int baseline, height, curX, newX, maxWidth, *lineLengths;
+    int numBytes, cacheFlags;
+    char *ownedString;
     TextLayout *layoutPtr;
     LayoutChunk *chunkPtr;
     const TkFontMetrics *fmPtr;
@@ -1999,12 +2470,37 @@ Tk_ComputeTextLayout(
 	wrapLength = -1;
     }
 
+    /*
+     * Consult the layout cache, and on a miss lay the text out over a
+     * private copy of the string so that the result can be cached without
+     * referencing caller-owned memory. Long strings bypass the cache.
+     */
+
+    cacheFlags = flags & (TK_IGNORE_TABS | TK_IGNORE_NEWLINES);
+    numBytes = Tcl_UtfAtIndex(string, numChars) - string;
+    if (numBytes <= LAYOUT_CACHE_MAX_BYTES) {
+	layoutPtr = FindCachedLayout(tkfont, string, numBytes, wrapLength,
+		justify, cacheFlags, widthPtr, heightPtr);
+	if (layoutPtr != NULL) {
+	    Tcl_DStringFree(&lineBuffer);
+	    return (Tk_TextLayout) layoutPtr;
+	}
+	ownedString = (char *)ckalloc(numBytes + 1);
+	memcpy(ownedString, string, numBytes);
+	ownedString[numBytes] = '\0';
+	string = ownedString;
+    } else {
+	ownedString = NULL;
+    }
+
     maxChunks = 1;
 
     layoutPtr = (TextLayout *)ckalloc(offsetof(TextLayout, chunks)
 	    + maxChunks * sizeof(LayoutChunk));
     layoutPtr->tkfont = tkfont;
     layoutPtr->string = string;
+    layoutPtr->refCount = 1;
+    layoutPtr->ownedString = ownedString;
     layoutPtr->numChunks = 0;
 
     baseline = fmPtr->ascent;
@@ -2231,10 +2727,197 @@ Tk_ComputeTextLayout(
     }
     Tcl_DStringFree(&lineBuffer);
 
+    if (ownedString != NULL) {
+	CacheLayout(layoutPtr, numBytes, wrapLength, justify, cacheFlags,
+		layoutPtr->width, layoutHeight);
+    }
     return (Tk_TextLayout) layoutPtr;
 }
 
 /*
+ *---------------------------------------------------------------------------
+ *
+ * TkTextLayoutEdit --
+ *
+ *	Compute a text layout for a string that differs from an existing
+ *	layout only by a localized edit, re-measuring just the changed span
+ *	instead of the whole string. The caller must pass the same font,
+ *	wrap length, justification and flags that produced oldLayout. The
+ *	fast path applies to unwrapped single-chunk layouts (the common
+ *	case for entry widgets); anything else falls back to
+ *	Tk_ComputeTextLayout. oldLayout is not consumed; the caller remains
+ *	responsible for freeing it.
+ *
+ * Results:
+ *	The return value and the width/height outputs are exactly as for
+ *	Tk_ComputeTextLayout on the new string.
+ *
+ * Side effects:
+ *	Memory is allocated for the new layout, and the layout may be
+ *	entered into the layout cache.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+Tk_TextLayout
+TkTextLayoutEdit(
+    Tk_Font tkfont,		/* Font used to display the text. */
+    Tk_TextLayout oldLayout,	/* Layout previously computed with identical
+				 * parameters for the pre-edit string, or
+				 * NULL. */
+    const char *string,		/* New string to lay out. */
+    int numChars,		/* Number of characters to consider from
+				 * string, or < 0 for strlen(). */
+    int wrapLength,		/* Longest permissible line length; <= 0
+				 * means no automatic wrapping. */
+    Tk_Justify justify,		/* How to justify lines. */
+    int flags,			/* TK_IGNORE_TABS and/or TK_IGNORE_NEWLINES,
+				 * as for Tk_ComputeTextLayout. */
+    int *widthPtr,		/* Filled with width of string. */
+    int *heightPtr)		/* Filled with height of string. */
+{
+    TextLayout *oldPtr = (TextLayout *) oldLayout;
+    TkFont *fontPtr = (TkFont *) tkfont;
+    const LayoutChunk *oldChunk;
+    TextLayout *layoutPtr;
+    const char *oldString, *p;
+    char *ownedString;
+    int numBytes, oldBytes, prefix, suffix, limit;
+    int oldMidWidth, newMidWidth, width, height, cacheFlags;
+
+    if ((fontPtr == NULL) || (string == NULL) || (oldPtr == NULL)
+	    || (oldPtr->tkfont != tkfont) || (wrapLength > 0)
+	    || (oldPtr->numChunks != 1)) {
+	goto fallback;
+    }
+    oldChunk = &oldPtr->chunks[0];
+    if ((oldChunk->numBytes == 0)
+	    || (oldChunk->numDisplayChars != oldChunk->numChars)) {
+	goto fallback;
+    }
+
+    if (numChars < 0) {
+	numChars = Tcl_NumUtfChars(string, -1);
+    }
+    numBytes = Tcl_UtfAtIndex(string, numChars) - string;
+    if (numBytes == 0) {
+	/*
+	 * Empty layouts use a special zero-width chunk; let the full
+	 * computation build it.
+	 */
+
+	goto fallback;
+    }
+    oldString = oldChunk->start;
+    oldBytes = oldChunk->numBytes;
+
+    /*
+     * Find the unchanged prefix and suffix surrounding the edit, backing
+     * off to UTF-8 character boundaries. The byte ranges compared are
+     * identical in both strings, so the boundaries agree.
+     */
+
+    limit = (oldBytes < numBytes) ? oldBytes : numBytes;
+    for (prefix = 0; (prefix < limit) && (string[prefix] == oldString[prefix]);
+	    prefix++) {
+	/* Empty loop body. */
+    }
+    while ((prefix > 0) && ((string[prefix] & 0xC0) == 0x80)) {
+	prefix--;
+    }
+    limit -= prefix;
+    for (suffix = 0; (suffix < limit) && (string[numBytes - suffix - 1]
+	    == oldString[oldBytes - suffix - 1]); suffix++) {
+	/* Empty loop body. */
+    }
+    while ((suffix > 0) && ((string[numBytes - suffix] & 0xC0) == 0x80)) {
+	suffix--;
+    }
+
+    /*
+     * The fast path only handles edits whose replacement text stays on the
+     * single line, i.e. introduces no unignored tabs or newlines.
+     */
+
+    for (p = string + prefix; p < string + (numBytes - suffix); p++) {
+	if (!(flags & TK_IGNORE_NEWLINES) && ((*p == '\n') || (*p == '\r'))) {
+	    goto fallback;
+	}
+	if (!(flags & TK_IGNORE_TABS) && (*p == '\t')) {
+	    goto fallback;
+	}
+    }
+
+    /*
+     * Re-measure only the replaced and replacement spans. Tk's character
+     * measurement is additive, so the width of the unchanged prefix and
+     * suffix carries over from the old layout.
+     */
+
+    oldMidWidth = newMidWidth = 0;
+    if (oldBytes - prefix - suffix > 0) {
+	Tk_MeasureChars(tkfont, oldString + prefix,
+		oldBytes - prefix - suffix, -1, 0, &oldMidWidth);
+    }
+    if (numBytes - prefix - suffix > 0) {
+	Tk_MeasureChars(tkfont, string + prefix,
+		numBytes - prefix - suffix, -1, 0, &newMidWidth);
+    }
+    width = oldChunk->totalWidth - oldMidWidth + newMidWidth;
+    height = fontPtr->fm.ascent + fontPtr->fm.descent;
+
+    cacheFlags = flags & (TK_IGNORE_TABS | TK_IGNORE_NEWLINES);
+    if (wrapLength == 0) {
+	wrapLength = -1;
+    }
+    if (numBytes <= LAYOUT_CACHE_MAX_BYTES) {
+	layoutPtr = FindCachedLayout(tkfont, string, numBytes, wrapLength,
+		justify, cacheFlags, widthPtr, heightPtr);
+	if (layoutPtr != NULL) {
+	    return (Tk_TextLayout) layoutPtr;
+	}
+	ownedString = (char *)ckalloc(numBytes + 1);
+	memcpy(ownedString, string, numBytes);
+	ownedString[numBytes] = '\0';
+	string = ownedString;
+    } else {
+	ownedString = NULL;
+    }
+
+    layoutPtr = (TextLayout *)ckalloc(offsetof(TextLayout, chunks)
+	    + sizeof(LayoutChunk));
+    layoutPtr->tkfont			= tkfont;
+    layoutPtr->string			= string;
+    layoutPtr->width			= width;
+    layoutPtr->refCount			= 1;
+    layoutPtr->ownedString		= ownedString;
+    layoutPtr->numChunks		= 1;
+    layoutPtr->chunks[0].start		= string;
+    layoutPtr->chunks[0].numBytes	= numBytes;
+    layoutPtr->chunks[0].numChars	= numChars;
+    layoutPtr->chunks[0].numDisplayChars = numChars;
+    layoutPtr->chunks[0].x		= 0;
+    layoutPtr->chunks[0].y		= fontPtr->fm.ascent;
+    layoutPtr->chunks[0].totalWidth	= width;
+    layoutPtr->chunks[0].displayWidth	= width;
+
+    if (widthPtr != NULL) {
+	*widthPtr = width;
+    }
+    if (heightPtr != NULL) {
+	*heightPtr = height;
+    }
+    if (ownedString != NULL) {
+	CacheLayout(layoutPtr, numBytes, wrapLength, justify, cacheFlags,
+		width, height);
+    }
+    return (Tk_TextLayout) layoutPtr;
+
+  fallback:
+    return Tk_ComputeTextLayout(tkfont, string, numChars, wrapLength,
+	    justify, flags, widthPtr, heightPtr);
+}
+/*
  *---------------------------------------------------------------------------
  *
  * Tk_FreeTextLayout --
@@ -2258,6 +2941,12 @@ Tk_FreeTextLayout(
     TextLayout *layoutPtr = (TextLayout *) textLayout;
 
     if (layoutPtr != NULL) {
+	if (layoutPtr->refCount-- > 1) {
+	    return;
+	}
+	if (layoutPtr->ownedString != NULL) {
+	    ckfree(layoutPtr->ownedString);
+	}
 	ckfree(layoutPtr);
     }
 }
@@ -108,6 +108,12 @@ typedef struct TkFont {
 				 * tkfont was based on, or NULL if the tkfont
 				 * was not based on a named font. */
     Screen *screen;		/* The screen where this font is valid. */
+    int scalingEpoch;		/* Value of the display's scalingEpoch when
+				 * this font was allocated. Point sizes are
+				 * resolved to pixels at allocation time, so
+				 * after [tk scaling] changes the ratio a
+				 * fresh variant is allocated instead of
+				 * reusing this one. */
     int tabWidth;		/* Width of tabs in this font (pixels). */
     int	underlinePos;		/* Offset from baseline to origin of underline
 				 * bar (used for drawing underlines on a
@@ -322,6 +322,15 @@ static const Tk_OptionSpec *const optionSpecs[] = {
     labelframeOptSpec,
 };
 
+/*
+ * Cumulative count of interior pixels that DisplayFrame did not have to
+ * paint because they were covered by child windows. Read (and reset) by the
+ * testframeoverdraw command through TkFrameOverdrawStats, since tkTest.c
+ * links against the stub tables and cannot reference the counter itself.
+ */
+
+static Tcl_WideInt frameOverdrawPixels = 0;
+
 /*
  * Forward declarations for functions defined later in this file:
  */
@@ -379,6 +388,37 @@ static const Tk_GeomMgr frameGeomType = {
     FrameLostContentProc		/* lostContentProc */
 };
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TkFrameOverdrawStats --
+ *
+ *	Returns the cumulative number of interior pixels that DisplayFrame
+ *	did not have to paint because they were covered by child windows,
+ *	for the "testframeoverdraw" command. Exported through the internal
+ *	stub table so that tkTest.c can reach it.
+ *
+ * Results:
+ *	The current value of the overdraw counter.
+ *
+ * Side effects:
+ *	If reset is non-zero, the counter is cleared after being read.
+ *
+ *--------------------------------------------------------------
+ */
+
+Tcl_WideInt
+TkFrameOverdrawStats(
+    int reset)			/* Non-zero means clear the counter. */
+{
+    Tcl_WideInt count = frameOverdrawPixels;
+
+    if (reset) {
+	frameOverdrawPixels = 0;
+    }
+    return count;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1482,6 +1522,9 @@ DisplayFrame(
     int bdX1, bdY1, bdX2, bdY2, hlWidth;
     Pixmap pixmap;
     TkRegion clipRegion = NULL;
+    TkRegion uncovered;
+    TkWindow *childPtr;
+    XRectangle rect, paintBox;
 
     framePtr->flags &= ~REDRAW_PENDING;
     if ((framePtr->tkwin == NULL) || !Tk_IsMapped(tkwin)) {
@@ -1518,6 +1561,51 @@ DisplayFrame(
 	return;
     }
 
+    /*
+     * Child windows obscure whatever the frame paints underneath them, so
+     * subtract the mapped children from the interior before painting. When
+     * the children cover the interior completely the redraw can be skipped
+     * altogether; otherwise the copy to the screen is clipped to the
+     * bounding box of the uncovered area. tkFrameOverdrawPixels accumulates
+     * the number of pixels this avoids painting, for verification from the
+     * test suite.
+     */
+
+    uncovered = TkCreateRegion();
+    rect.x = rect.y = hlWidth;
+    rect.width = Tk_Width(tkwin) - 2*hlWidth;
+    rect.height = Tk_Height(tkwin) - 2*hlWidth;
+    TkUnionRectWithRegion(&rect, uncovered, uncovered);
+    for (childPtr = ((TkWindow *) tkwin)->childList; childPtr != NULL;
+	    childPtr = childPtr->nextPtr) {
+	TkRegion childRegion;
+
+	if (!(childPtr->flags & TK_MAPPED)
+		|| (childPtr->flags & TK_TOP_HIERARCHY)) {
+	    continue;
+	}
+	rect.x = childPtr->changes.x;
+	rect.y = childPtr->changes.y;
+	rect.width = childPtr->changes.width
+		+ 2*childPtr->changes.border_width;
+	rect.height = childPtr->changes.height
+		+ 2*childPtr->changes.border_width;
+	childRegion = TkCreateRegion();
+	TkUnionRectWithRegion(&rect, childRegion, childRegion);
+	TkSubtractRegion(uncovered, childRegion, uncovered);
+	TkDestroyRegion(childRegion);
+    }
+    TkClipBox(uncovered, &paintBox);
+    TkDestroyRegion(uncovered);
+    frameOverdrawPixels += (Tk_Width(tkwin) - 2*hlWidth)
+	    * (Tk_Height(tkwin) - 2*hlWidth)
+	    - paintBox.width * paintBox.height;
+    if (((paintBox.width == 0) || (paintBox.height == 0))
+	    && !((framePtr->type == TYPE_LABELFRAME)
+		&& (((Labelframe *) framePtr)->labelWin != NULL))) {
+	return;
+    }
+
 #ifndef TK_NO_DOUBLE_BUFFERING
     /*
      * In order to avoid screen flashes, this function redraws the frame into
@@ -1672,11 +1760,11 @@ DisplayFrame(
      * free up the pixmap.
      */
 
-    XCopyArea(framePtr->display, pixmap, Tk_WindowId(tkwin),
-	    framePtr->copyGC, hlWidth, hlWidth,
-	    (unsigned) (Tk_Width(tkwin) - 2 * hlWidth),
-	    (unsigned) (Tk_Height(tkwin) - 2 * hlWidth),
-	    hlWidth, hlWidth);
+    if ((paintBox.width > 0) && (paintBox.height > 0)) {
+	XCopyArea(framePtr->display, pixmap, Tk_WindowId(tkwin),
+		framePtr->copyGC, paintBox.x, paintBox.y,
+		paintBox.width, paintBox.height, paintBox.x, paintBox.y);
+    }
     Tk_FreePixmap(framePtr->display, pixmap);
 #endif /* TK_NO_DOUBLE_BUFFERING */
 }
@@ -20,12 +20,39 @@
  * identifier.
  */
 
+/*
+ * Longest multi-element dash list that is remembered per GC; canvas dash
+ * patterns are limited to sizeof(char *) elements (doubled by the conversion
+ * of character-style patterns), so in practice every list fits.
+ */
+
+#define GC_DASH_SHADOW_SIZE	32
+
 typedef struct {
     GC gc;			/* Graphics context. */
     Display *display;		/* Display to which gc belongs. */
     size_t refCount;		/* Number of active uses of gc. */
     Tcl_HashEntry *valueHashPtr;/* Entry in valueTable (needed when deleting
 				 * this structure). */
+    int screenNum;		/* Screen number of display for which gc is
+				 * valid. */
+    int depth;			/* Depth for which gc is valid. */
+    unsigned long setMask;	/* Union of all value masks ever applied to
+				 * gc, either at creation or when recycling
+				 * it from the pool; tells a later recycle
+				 * which fields must be reset to their
+				 * defaults. */
+    int dashLen;		/* Length of the dash list most recently
+				 * installed on gc by TkGCSetDashes; 0 if the
+				 * gc still holds the single-element list it
+				 * was created with, -1 if a list too long to
+				 * record was installed. */
+    int dashOffset;		/* Dash offset that accompanied dashShadow. */
+    char dashShadow[GC_DASH_SHADOW_SIZE];
+				/* The recorded dash list. */
+    int canonOffset;		/* Creation-time dash offset of gc. */
+    char canonDash;		/* Creation-time dashes value of gc; the list
+				 * a sharer of the gc expects to find. */
 } TkGC;
 
 typedef struct {
@@ -35,6 +62,35 @@ typedef struct {
     int depth;			/* and depth for which GC is valid. */
 } ValueKey;
 
+/*
+ * When the last reference to a GC is released the GC is not handed back to
+ * the server right away: up to GC_POOL_MAX_SIZE of them are parked on a
+ * per-display free list, and Tk_GetGC recycles a parked GC with a single
+ * XChangeGC request in place of the XFreeGC/XCreateGC pair that widget
+ * reconfiguration otherwise generates.
+ */
+
+typedef struct TkPooledGC {
+    GC gc;			/* The parked graphics context. */
+    int screenNum;		/* Screen number for which gc is valid. */
+    int depth;			/* Depth for which gc is valid. */
+    unsigned long setMask;	/* Union of all value masks ever applied to
+				 * gc. */
+    struct TkPooledGC *nextPtr;	/* Next context in the display's pool. */
+} TkPooledGC;
+
+#define GC_POOL_MAX_SIZE 8
+
+/*
+ * Fields that cannot be reset to their creation-time defaults through
+ * XChangeGC: the default font is server-dependent and the default tile and
+ * stipple are anonymous pixmaps, so None is not a settable stand-in for any
+ * of them.  A parked GC that has had one of these fields set can only be
+ * recycled for a request that sets the same field again.
+ */
+
+#define GC_STICKY_FIELDS	(GCFont|GCTile|GCStipple)
+
 /*
  * Forward declarations for functions defined in this file:
  */
@@ -77,6 +133,7 @@ Tk_GetGC(
     ValueKey valueKey;
     Tcl_HashEntry *valueHashPtr, *idHashPtr;
     TkGC *gcPtr;
+    TkPooledGC *pooledPtr, **pooledPtrPtr;
     int isNew;
     Drawable d, freeDrawable;
     TkDisplay *dispPtr = ((TkWindow *) tkwin)->dispPtr;
@@ -220,6 +277,18 @@ Tk_GetGC(
     if (!isNew) {
 	gcPtr = (TkGC *)Tcl_GetHashValue(valueHashPtr);
 	gcPtr->refCount++;
+	if (gcPtr->dashLen != 0) {
+	    /*
+	     * TkGCSetDashes left a longer dash list on the shared gc; put
+	     * the creation-time list back before handing out a new
+	     * reference, since the new holder expects the gc to match the
+	     * values it asked for.
+	     */
+
+	    XSetDashes(valueKey.display, gcPtr->gc, gcPtr->canonOffset,
+		    &gcPtr->canonDash, 1);
+	    gcPtr->dashLen = 0;
+	}
 	return gcPtr->gc;
     }
 
@@ -231,28 +300,70 @@ Tk_GetGC(
     gcPtr = (TkGC *)ckalloc(sizeof(TkGC));
 
     /*
-     * Find or make a drawable to use to specify the screen and depth of the
-     * GC. We may have to make a small pixmap, to avoid doing
-     * Tk_MakeWindowExist on the window.
+     * Look for a parked GC of the right screen and depth that can be
+     * recycled; reprogramming one with XChangeGC saves the XFreeGC plus
+     * XCreateGC pair.  Every field that was ever set on the parked GC and is
+     * not requested now is reset to its default, which valueKey already
+     * holds; GCs whose sticky fields cannot be reset that way are passed
+     * over.
      */
 
-    freeDrawable = None;
-    if (Tk_WindowId(tkwin) != None) {
-	d = Tk_WindowId(tkwin);
-    } else if (valueKey.depth ==
-	    DefaultDepth(valueKey.display, valueKey.screenNum)) {
-	d = RootWindow(valueKey.display, valueKey.screenNum);
+    pooledPtr = NULL;
+    for (pooledPtrPtr = &dispPtr->gcPoolPtr; *pooledPtrPtr != NULL;
+	    pooledPtrPtr = &(*pooledPtrPtr)->nextPtr) {
+	if (((*pooledPtrPtr)->screenNum == valueKey.screenNum)
+		&& ((*pooledPtrPtr)->depth == valueKey.depth)
+		&& !((*pooledPtrPtr)->setMask & ~valueMask
+			& GC_STICKY_FIELDS)) {
+	    pooledPtr = *pooledPtrPtr;
+	    *pooledPtrPtr = pooledPtr->nextPtr;
+	    dispPtr->gcPoolSize--;
+	    break;
+	}
+    }
+
+    if (pooledPtr != NULL) {
+	gcPtr->setMask = valueMask | pooledPtr->setMask;
+	XChangeGC(valueKey.display, pooledPtr->gc, gcPtr->setMask,
+		&valueKey.values);
+	gcPtr->gc = pooledPtr->gc;
+	ckfree(pooledPtr);
     } else {
-	d = Tk_GetPixmap(valueKey.display,
-		RootWindow(valueKey.display, valueKey.screenNum),
-		1, 1, valueKey.depth);
-	freeDrawable = d;
+	/*
+	 * Find or make a drawable to use to specify the screen and depth of
+	 * the GC. We may have to make a small pixmap, to avoid doing
+	 * Tk_MakeWindowExist on the window.
+	 */
+
+	freeDrawable = None;
+	if (Tk_WindowId(tkwin) != None) {
+	    d = Tk_WindowId(tkwin);
+	} else if (valueKey.depth ==
+		DefaultDepth(valueKey.display, valueKey.screenNum)) {
+	    d = RootWindow(valueKey.display, valueKey.screenNum);
+	} else {
+	    d = Tk_GetPixmap(valueKey.display,
+		    RootWindow(valueKey.display, valueKey.screenNum),
+		    1, 1, valueKey.depth);
+	    freeDrawable = d;
+	}
+
+	gcPtr->gc = XCreateGC(valueKey.display, d, valueMask,
+		&valueKey.values);
+	gcPtr->setMask = valueMask;
+	if (freeDrawable != None) {
+	    Tk_FreePixmap(valueKey.display, freeDrawable);
+	}
     }
 
-    gcPtr->gc = XCreateGC(valueKey.display, d, valueMask, &valueKey.values);
     gcPtr->display = valueKey.display;
     gcPtr->refCount = 1;
     gcPtr->valueHashPtr = valueHashPtr;
+    gcPtr->dashLen = 0;
+    gcPtr->canonOffset = valueKey.values.dash_offset;
+    gcPtr->canonDash = valueKey.values.dashes;
+    gcPtr->screenNum = valueKey.screenNum;
+    gcPtr->depth = valueKey.depth;
     idHashPtr = Tcl_CreateHashEntry(&dispPtr->gcIdTable,
 	    (char *) gcPtr->gc, &isNew);
     if (!isNew) {
@@ -260,9 +371,6 @@ Tk_GetGC(
     }
     Tcl_SetHashValue(valueHashPtr, gcPtr);
     Tcl_SetHashValue(idHashPtr, gcPtr);
-    if (freeDrawable != None) {
-	Tk_FreePixmap(valueKey.display, freeDrawable);
-    }
 
     return gcPtr->gc;
 }
@@ -313,13 +421,127 @@ Tk_FreeGC(
     }
     gcPtr = (TkGC *)Tcl_GetHashValue(idHashPtr);
     if (gcPtr->refCount-- <= 1) {
-	XFreeGC(gcPtr->display, gcPtr->gc);
 	Tcl_DeleteHashEntry(gcPtr->valueHashPtr);
 	Tcl_DeleteHashEntry(idHashPtr);
+	if (dispPtr->gcPoolSize < GC_POOL_MAX_SIZE) {
+	    TkPooledGC *pooledPtr = (TkPooledGC *)ckalloc(sizeof(TkPooledGC));
+
+	    pooledPtr->gc = gcPtr->gc;
+	    pooledPtr->screenNum = gcPtr->screenNum;
+	    pooledPtr->depth = gcPtr->depth;
+	    pooledPtr->setMask = gcPtr->setMask;
+	    pooledPtr->nextPtr = dispPtr->gcPoolPtr;
+	    dispPtr->gcPoolPtr = pooledPtr;
+	    dispPtr->gcPoolSize++;
+	} else {
+	    XFreeGC(gcPtr->display, gcPtr->gc);
+	}
 	ckfree(gcPtr);
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkGCSetDashes --
+ *
+ *	Installs a multi-element dash list on a GC obtained from Tk_GetGC,
+ *	like XSetDashes, but skips the server request when the GC already
+ *	holds exactly that list. The list is recorded against the GC so that
+ *	Tk_GetGC can put the creation-time list back before sharing the GC
+ *	with another holder.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The GC's dash list and dash offset may be changed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkGCSetDashes(
+    Display *display,		/* Display owning gc. */
+    GC gc,			/* Graphics context obtained from
+				 * Tk_GetGC. */
+    int offset,			/* Desired dash offset. */
+    const char *list,		/* Desired dash list. */
+    int n)			/* Number of elements in list. */
+{
+    TkDisplay *dispPtr = TkGetDisplay(display);
+    Tcl_HashEntry *idHashPtr;
+    TkGC *gcPtr;
+
+    if ((dispPtr == NULL) || (dispPtr->gcInit <= 0)
+	    || ((idHashPtr = Tcl_FindHashEntry(&dispPtr->gcIdTable,
+		    gc)) == NULL)) {
+	XSetDashes(display, gc, offset, list, n);
+	return;
+    }
+    gcPtr = (TkGC *)Tcl_GetHashValue(idHashPtr);
+    if ((n > 0) && (n <= GC_DASH_SHADOW_SIZE)) {
+	if ((gcPtr->dashLen == n) && (gcPtr->dashOffset == offset)
+		&& (memcmp(gcPtr->dashShadow, list, n) == 0)) {
+	    return;
+	}
+	gcPtr->dashLen = n;
+	gcPtr->dashOffset = offset;
+	memcpy(gcPtr->dashShadow, list, n);
+    } else {
+	gcPtr->dashLen = -1;
+    }
+
+    /*
+     * Make sure a later recycle of this gc from the pool resets the dash
+     * fields, even if the new holder does not set them itself.
+     */
+
+    gcPtr->setMask |= GCDashOffset|GCDashList;
+    XSetDashes(display, gc, offset, list, n);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkGCRestoreDashes --
+ *
+ *	Puts the creation-time dash list back on a GC if TkGCSetDashes has
+ *	installed a different one, so that a holder relying on the list the
+ *	GC was created with draws correctly. Does nothing when the GC
+ *	already holds its creation-time list.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The GC's dash list and dash offset may be changed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkGCRestoreDashes(
+    Display *display,		/* Display owning gc. */
+    GC gc)			/* Graphics context obtained from
+				 * Tk_GetGC. */
+{
+    TkDisplay *dispPtr = TkGetDisplay(display);
+    Tcl_HashEntry *idHashPtr;
+    TkGC *gcPtr;
+
+    if ((dispPtr == NULL) || (dispPtr->gcInit <= 0)
+	    || ((idHashPtr = Tcl_FindHashEntry(&dispPtr->gcIdTable,
+		    gc)) == NULL)) {
+	return;
+    }
+    gcPtr = (TkGC *)Tcl_GetHashValue(idHashPtr);
+    if (gcPtr->dashLen != 0) {
+	XSetDashes(display, gc, gcPtr->canonOffset, &gcPtr->canonDash, 1);
+	gcPtr->dashLen = 0;
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -344,6 +566,7 @@ TkGCCleanup(
     Tcl_HashEntry *entryPtr;
     Tcl_HashSearch search;
     TkGC *gcPtr;
+    TkPooledGC *pooledPtr;
 
     for (entryPtr = Tcl_FirstHashEntry(&dispPtr->gcIdTable, &search);
 	    entryPtr != NULL; entryPtr = Tcl_NextHashEntry(&search)) {
@@ -354,6 +577,13 @@ TkGCCleanup(
 	Tcl_DeleteHashEntry(entryPtr);
 	ckfree(gcPtr);
     }
+    while (dispPtr->gcPoolPtr != NULL) {
+	pooledPtr = dispPtr->gcPoolPtr;
+	dispPtr->gcPoolPtr = pooledPtr->nextPtr;
+	XFreeGC(dispPtr->display, pooledPtr->gc);
+	ckfree(pooledPtr);
+    }
+    dispPtr->gcPoolSize = 0;
     Tcl_DeleteHashTable(&dispPtr->gcValueTable);
     Tcl_DeleteHashTable(&dispPtr->gcIdTable);
     dispPtr->gcInit = -1;
@@ -383,6 +613,8 @@ GCInit(
 	Tcl_Panic("called GCInit after GCCleanup");
     }
     dispPtr->gcInit = 1;
+    dispPtr->gcPoolPtr = NULL;
+    dispPtr->gcPoolSize = 0;
     Tcl_InitHashTable(&dispPtr->gcValueTable, sizeof(ValueKey)/sizeof(int));
     Tcl_InitHashTable(&dispPtr->gcIdTable, TCL_ONE_WORD_KEYS);
 }
@@ -49,16 +49,109 @@ typedef struct MaintainContainer {
 				 * this container. */
 } MaintainContainer;
 
+/*
+ * Data structures of the following type represent one pending geometry
+ * manager arrangement registered with TkScheduleLayout.
+ */
+
+typedef struct LayoutRequest {
+    Tcl_IdleProc *proc;		/* Arrangement procedure to invoke. */
+    ClientData clientData;	/* Argument for proc; identifies the container
+				 * so that duplicate requests can be
+				 * merged. */
+    int depth;			/* Number of ancestors of the container
+				 * window. Pending arrangements are kept
+				 * ordered by increasing depth so that
+				 * containers are arranged parent-first. */
+    struct LayoutRequest *nextPtr;
+				/* Next in list of pending arrangements. */
+} LayoutRequest;
+
+/*
+ * Data structures of the following type record one window whose geometry
+ * request was intercepted inside a "tk batchgeometry" script; the request is
+ * propagated to the window's geometry manager when the outermost batch ends.
+ */
+
+typedef struct DeferredRequest {
+    TkWindow *winPtr;		/* Window whose requested size changed. NULL
+				 * means the window was destroyed while the
+				 * batch was open. */
+    struct DeferredRequest *nextPtr;
+				/* Next in list of deferred requests. */
+} DeferredRequest;
+
+typedef struct ThreadSpecificData {
+    LayoutRequest *layoutFirstPtr;
+				/* First in list of pending arrangements,
+				 * ordered by increasing depth. */
+    int layoutIdleScheduled;	/* Non-zero means that LayoutIdleProc has
+				 * already been scheduled as an idle
+				 * handler. */
+    int geometryBatchDepth;	/* Number of nested TkGeometryBatchBegin
+				 * calls that have not yet been matched by
+				 * TkGeometryBatchEnd. While positive,
+				 * Tk_GeometryRequest defers propagation. */
+    DeferredRequest *deferredFirstPtr;
+				/* First in list of requests deferred by the
+				 * current batch, in order of arrival. */
+    DeferredRequest *deferredLastPtr;
+				/* Last in that list, or NULL if empty. */
+} ThreadSpecificData;
+static Tcl_ThreadDataKey dataKey;
+
+/*
+ * Counts pending arrangements that were hoisted ahead of a deeper container,
+ * i.e. cases where the parent-first ordering may have saved the deeper
+ * container from being arranged twice. Read by the "testlayoutreorders"
+ * command through TkLayoutReorderStats, since tkTest.c links against the
+ * stub tables and cannot reference the counter itself.
+ */
+
+static Tcl_WideInt layoutReorderCount = 0;
+
 /*
  * Prototypes for static procedures in this file:
  */
 
+static void		LayoutIdleProc(ClientData clientData);
 static void		MaintainCheckProc(ClientData clientData);
 static void		MaintainContainerProc(ClientData clientData,
 			    XEvent *eventPtr);
 static void		MaintainContentProc(ClientData clientData,
 			    XEvent *eventPtr);
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TkLayoutReorderStats --
+ *
+ *	Returns the number of times the layout scheduler has hoisted a
+ *	pending arrangement ahead of a deeper container, for the
+ *	"testlayoutreorders" command. Exported through the internal stub
+ *	table so that tkTest.c can reach it.
+ *
+ * Results:
+ *	The current value of the reorder counter.
+ *
+ * Side effects:
+ *	If reset is non-zero, the counter is cleared after being read.
+ *
+ *--------------------------------------------------------------
+ */
+
+Tcl_WideInt
+TkLayoutReorderStats(
+    int reset)			/* Non-zero means clear the counter. */
+{
+    Tcl_WideInt count = layoutReorderCount;
+
+    if (reset) {
+	layoutReorderCount = 0;
+    }
+    return count;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -152,6 +245,34 @@ Tk_GeometryRequest(
     winPtr->reqHeight = reqHeight;
     if ((winPtr->geomMgrPtr != NULL)
 	    && (winPtr->geomMgrPtr->requestProc != NULL)) {
+	ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+		Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+	if (tsdPtr->geometryBatchDepth > 0) {
+	    /*
+	     * A "tk batchgeometry" script is running: remember the window
+	     * and propagate the request when the batch ends. The flag bit
+	     * keeps a widget that changes size repeatedly during
+	     * construction from being queued more than once.
+	     */
+
+	    DeferredRequest *reqPtr;
+
+	    if (winPtr->flags & TK_DEFERRED_GEOMETRY) {
+		return;
+	    }
+	    winPtr->flags |= TK_DEFERRED_GEOMETRY;
+	    reqPtr = (DeferredRequest *)ckalloc(sizeof(DeferredRequest));
+	    reqPtr->winPtr = winPtr;
+	    reqPtr->nextPtr = NULL;
+	    if (tsdPtr->deferredLastPtr == NULL) {
+		tsdPtr->deferredFirstPtr = reqPtr;
+	    } else {
+		tsdPtr->deferredLastPtr->nextPtr = reqPtr;
+	    }
+	    tsdPtr->deferredLastPtr = reqPtr;
+	    return;
+	}
 	winPtr->geomMgrPtr->requestProc(winPtr->geomData, tkwin);
     }
 }
@@ -778,6 +899,286 @@ MaintainCheckProc(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkScheduleLayout --
+ *
+ *	Arrange for a geometry manager's arrangement procedure to be invoked
+ *	at the next idle point. Requests for the same procedure and argument
+ *	are merged, and pending arrangements are run parent-first so that a
+ *	container is laid out before any of its descendants that are also
+ *	waiting.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Proc will be invoked with clientData as argument at the next idle
+ *	point, after all arrangements pending for shallower containers.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkScheduleLayout(
+    Tk_Window tkwin,		/* Container window whose content is to be
+				 * re-arranged. */
+    Tcl_IdleProc *proc,		/* Arrangement procedure of the geometry
+				 * manager. */
+    ClientData clientData)	/* Argument for proc. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    LayoutRequest *newPtr, *reqPtr, *prevPtr;
+    TkWindow *winPtr;
+    int depth;
+
+    for (reqPtr = tsdPtr->layoutFirstPtr; reqPtr != NULL;
+	    reqPtr = reqPtr->nextPtr) {
+	if ((reqPtr->proc == proc) && (reqPtr->clientData == clientData)) {
+	    return;
+	}
+    }
+
+    depth = 0;
+    for (winPtr = (TkWindow *) tkwin; winPtr->parentPtr != NULL;
+	    winPtr = winPtr->parentPtr) {
+	depth++;
+    }
+
+    newPtr = (LayoutRequest *)ckalloc(sizeof(LayoutRequest));
+    newPtr->proc = proc;
+    newPtr->clientData = clientData;
+    newPtr->depth = depth;
+
+    prevPtr = NULL;
+    for (reqPtr = tsdPtr->layoutFirstPtr;
+	    (reqPtr != NULL) && (reqPtr->depth <= depth);
+	    reqPtr = reqPtr->nextPtr) {
+	prevPtr = reqPtr;
+    }
+    if (reqPtr != NULL) {
+	layoutReorderCount++;
+    }
+    newPtr->nextPtr = reqPtr;
+    if (prevPtr == NULL) {
+	tsdPtr->layoutFirstPtr = newPtr;
+    } else {
+	prevPtr->nextPtr = newPtr;
+    }
+
+    if (!tsdPtr->layoutIdleScheduled) {
+	tsdPtr->layoutIdleScheduled = 1;
+	Tcl_DoWhenIdle(LayoutIdleProc, NULL);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkUnscheduleLayout --
+ *
+ *	Cancel a pending arrangement registered with TkScheduleLayout. It is
+ *	not an error to cancel an arrangement that is no longer (or was
+ *	never) pending.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Proc will not be invoked for clientData at the next idle point.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkUnscheduleLayout(
+    Tcl_IdleProc *proc,		/* Arrangement procedure of the geometry
+				 * manager. */
+    ClientData clientData)	/* Argument for proc. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    LayoutRequest *reqPtr, *prevPtr;
+
+    prevPtr = NULL;
+    for (reqPtr = tsdPtr->layoutFirstPtr; reqPtr != NULL;
+	    reqPtr = reqPtr->nextPtr) {
+	if ((reqPtr->proc == proc) && (reqPtr->clientData == clientData)) {
+	    if (prevPtr == NULL) {
+		tsdPtr->layoutFirstPtr = reqPtr->nextPtr;
+	    } else {
+		prevPtr->nextPtr = reqPtr->nextPtr;
+	    }
+	    ckfree(reqPtr);
+	    return;
+	}
+	prevPtr = reqPtr;
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * LayoutIdleProc --
+ *
+ *	Idle handler that runs the pending arrangements registered with
+ *	TkScheduleLayout, shallowest container first. Arrangements scheduled
+ *	while this procedure is running are deferred to the next idle pass,
+ *	mirroring the behavior of Tcl_DoWhenIdle.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Whatever the arrangement procedures do; typically the content of the
+ *	pending containers gets resized or moved.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+LayoutIdleProc(
+    TCL_UNUSED(void *))
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    LayoutRequest *reqPtr;
+    int count = 0;
+
+    tsdPtr->layoutIdleScheduled = 0;
+    for (reqPtr = tsdPtr->layoutFirstPtr; reqPtr != NULL;
+	    reqPtr = reqPtr->nextPtr) {
+	count++;
+    }
+
+    /*
+     * Pop the requests off the list one at a time rather than detaching the
+     * whole list, so that a TkUnscheduleLayout call made by one arrangement
+     * procedure (e.g. while destroying another container) still finds and
+     * removes the stale entry.
+     */
+
+    while ((count-- > 0) && ((reqPtr = tsdPtr->layoutFirstPtr) != NULL)) {
+	Tcl_IdleProc *proc = reqPtr->proc;
+	ClientData clientData = reqPtr->clientData;
+
+	tsdPtr->layoutFirstPtr = reqPtr->nextPtr;
+	ckfree(reqPtr);
+	proc(clientData);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkGeometryBatchBegin, TkGeometryBatchEnd --
+ *
+ *	Bracket a "tk batchgeometry" script. While at least one batch is
+ *	open, Tk_GeometryRequest records the windows whose requested size
+ *	changed instead of invoking their geometry managers; the outermost
+ *	TkGeometryBatchEnd replays the recorded requests in order. Because
+ *	the managers react by calling TkScheduleLayout, the actual
+ *	arrangements still run parent-first in a single idle pass.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	TkGeometryBatchEnd invokes the requestProc of every geometry manager
+ *	with a deferred request, which typically schedules arrangements and
+ *	propagates requested sizes up the containment hierarchy.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkGeometryBatchBegin(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    tsdPtr->geometryBatchDepth++;
+}
+
+void
+TkGeometryBatchEnd(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    DeferredRequest *reqPtr;
+
+    if (tsdPtr->geometryBatchDepth <= 0) {
+	Tcl_Panic("TkGeometryBatchEnd: no batch is open");
+    }
+    if (--tsdPtr->geometryBatchDepth > 0) {
+	return;
+    }
+
+    /*
+     * Pop the requests off the list one at a time so that windows destroyed
+     * by a requestProc are still found by TkGeometryBatchDeadWindow.
+     */
+
+    while ((reqPtr = tsdPtr->deferredFirstPtr) != NULL) {
+	TkWindow *winPtr = reqPtr->winPtr;
+
+	tsdPtr->deferredFirstPtr = reqPtr->nextPtr;
+	if (tsdPtr->deferredFirstPtr == NULL) {
+	    tsdPtr->deferredLastPtr = NULL;
+	}
+	ckfree(reqPtr);
+	if (winPtr == NULL) {
+	    continue;
+	}
+	winPtr->flags &= ~TK_DEFERRED_GEOMETRY;
+	if ((winPtr->geomMgrPtr != NULL)
+		&& (winPtr->geomMgrPtr->requestProc != NULL)) {
+	    winPtr->geomMgrPtr->requestProc(winPtr->geomData,
+		    (Tk_Window) winPtr);
+	}
+    }
+}
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkGeometryBatchDeadWindow --
+ *
+ *	Mark any deferred request for a window that is being destroyed as
+ *	dead, so that TkGeometryBatchEnd does not touch freed memory.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	None, unless winPtr has a deferred request pending.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkGeometryBatchDeadWindow(
+    TkWindow *winPtr)		/* Window that is being destroyed. */
+{
+    ThreadSpecificData *tsdPtr;
+    DeferredRequest *reqPtr;
+
+    if (!(winPtr->flags & TK_DEFERRED_GEOMETRY)) {
+	return;
+    }
+    tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    for (reqPtr = tsdPtr->deferredFirstPtr; reqPtr != NULL;
+	    reqPtr = reqPtr->nextPtr) {
+	if (reqPtr->winPtr == winPtr) {
+	    reqPtr->winPtr = NULL;
+	    break;
+	}
+    }
+    winPtr->flags &= ~TK_DEFERRED_GEOMETRY;
+}
+
 /*
  * Local Variables:
  * mode: c
@@ -15,6 +15,14 @@
 
 #include "tkInt.h"
 
+/*
+ * Number of recently returned Tk_Uids remembered by Tk_GetUid. Tag-heavy
+ * canvas operations intern the same handful of tags over and over, so a
+ * short move-to-front list answers most calls without hashing the string.
+ */
+
+#define UID_CACHE_SIZE 8
+
 /*
  * One of these structures is created per thread to store thread-specific
  * data. In this case, it is used to house the Tk_Uid structs used by each
@@ -25,11 +33,31 @@
 typedef struct {
     int initialized;
     Tcl_HashTable uidTable;
+    Tk_Uid uidCache[UID_CACHE_SIZE];
+				/* Most recently returned Uids, most recent
+				 * first. Unused slots are NULL. */
 } ThreadSpecificData;
 static Tcl_ThreadDataKey dataKey;
 
+static void		DupUidInternalRep(Tcl_Obj *srcPtr, Tcl_Obj *copyPtr);
 static void		FreeUidThreadExitProc(ClientData clientData);
 
+/*
+ * The following structure defines the implementation of the "uid" Tcl
+ * object, used to cache the result of interning the object's string value
+ * with Tk_GetUid. The internalRep.twoPtrValue fields hold the Tk_Uid and
+ * the thread's uid table, so an object that migrates to another thread
+ * (whose table interns strings at different addresses) is re-converted.
+ */
+
+const Tcl_ObjType tkUidObjType = {
+    "uid",			/* name */
+    NULL,			/* freeIntRepProc */
+    DupUidInternalRep,		/* dupIntRepProc */
+    NULL,			/* updateStringProc */
+    NULL			/* setFromAnyProc */
+};
+
 /*
  * The following tables defines the string values for reliefs, which are
  * used by Tk_GetAnchorFromObj and Tk_GetJustifyFromObj.
@@ -55,7 +83,7 @@ static const char *const justifyStrings[] = {
  *	unless "interp" is NULL.
  *
  * Side effects:
- *	The object gets converted by Tcl_GetIndexFromObj.
+ *	The object gets converted by TkGetEnumFromObj.
  *
  *----------------------------------------------------------------------
  */
@@ -71,8 +99,7 @@ Tk_GetAnchorFromObj(
 {
     int index, code;
 
-    code = Tcl_GetIndexFromObj(interp, objPtr, anchorStrings, "anchor", 0,
-	    &index);
+    code = TkGetEnumFromObj(interp, objPtr, anchorStrings, "anchor", &index);
     if (code == TCL_OK) {
 	*anchorPtr = (Tk_Anchor) index;
     }
@@ -369,7 +396,7 @@ Tk_NameOfCapStyle(
  *	unless "interp" is NULL.
  *
  * Side effects:
- *	The object gets converted by Tcl_GetIndexFromObj.
+ *	The object gets converted by TkGetEnumFromObj.
  *
  *----------------------------------------------------------------------
  */
@@ -385,8 +412,8 @@ Tk_GetJustifyFromObj(
 {
     int index, code;
 
-    code = Tcl_GetIndexFromObj(interp, objPtr, justifyStrings,
-	    "justification", 0, &index);
+    code = TkGetEnumFromObj(interp, objPtr, justifyStrings, "justification",
+	    &index);
     if (code == TCL_OK) {
 	*justifyPtr = (Tk_Justify) index;
     }
@@ -499,6 +526,7 @@ FreeUidThreadExitProc(
 	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
     Tcl_DeleteHashTable(&tsdPtr->uidTable);
+    memset(tsdPtr->uidCache, 0, sizeof(tsdPtr->uidCache));
     tsdPtr->initialized = 0;
 }
 
@@ -528,18 +556,116 @@ Tk_Uid
 Tk_GetUid(
     const char *string)		/* String to convert. */
 {
-    int dummy;
+    int dummy, i;
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
             Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
     Tcl_HashTable *tablePtr = &tsdPtr->uidTable;
+    Tk_Uid uid;
 
     if (!tsdPtr->initialized) {
 	Tcl_InitHashTable(tablePtr, TCL_STRING_KEYS);
 	Tcl_CreateThreadExitHandler(FreeUidThreadExitProc, NULL);
 	tsdPtr->initialized = 1;
     }
-    return (Tk_Uid) Tcl_GetHashKey(tablePtr,
+
+    /*
+     * Check the recently-returned Uids before hashing; comparing against a
+     * handful of interned strings is cheaper than hashing the argument. A
+     * hit is moved to the front of the cache.
+     */
+
+    for (i = 0; (i < UID_CACHE_SIZE)
+	    && ((uid = tsdPtr->uidCache[i]) != NULL); i++) {
+	if ((uid[0] == string[0]) && (strcmp(uid, string) == 0)) {
+	    for ( ; i > 0; i--) {
+		tsdPtr->uidCache[i] = tsdPtr->uidCache[i-1];
+	    }
+	    tsdPtr->uidCache[0] = uid;
+	    return uid;
+	}
+    }
+
+    uid = (Tk_Uid) Tcl_GetHashKey(tablePtr,
 	    Tcl_CreateHashEntry(tablePtr, string, &dummy));
+    for (i = UID_CACHE_SIZE - 1; i > 0; i--) {
+	tsdPtr->uidCache[i] = tsdPtr->uidCache[i-1];
+    }
+    tsdPtr->uidCache[0] = uid;
+    return uid;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkGetUidFromObj --
+ *
+ *	Like Tk_GetUid, but caches the resulting Uid in the internal
+ *	representation of objPtr so that repeated interning of the same
+ *	object (e.g. a canvas tag argument in an event binding that fires on
+ *	every pointer motion) skips the string lookup entirely.
+ *
+ * Results:
+ *	The Tk_Uid corresponding to the string value of objPtr, exactly as
+ *	Tk_GetUid would return it.
+ *
+ * Side effects:
+ *	The object's internal representation may be replaced with one
+ *	recording the Uid and the thread's uid table.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tk_Uid
+TkGetUidFromObj(
+    Tcl_Obj *objPtr)		/* Object whose string value is to be
+				 * converted. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+            Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    Tk_Uid uid;
+
+    if ((objPtr->typePtr == &tkUidObjType)
+	    && (objPtr->internalRep.twoPtrValue.ptr2 == tsdPtr)) {
+	return (Tk_Uid) objPtr->internalRep.twoPtrValue.ptr1;
+    }
+
+    uid = Tk_GetUid(Tcl_GetString(objPtr));
+    if ((objPtr->typePtr != NULL)
+	    && (objPtr->typePtr->freeIntRepProc != NULL)) {
+	objPtr->typePtr->freeIntRepProc(objPtr);
+    }
+    objPtr->internalRep.twoPtrValue.ptr1 = (void *) uid;
+    objPtr->internalRep.twoPtrValue.ptr2 = tsdPtr;
+    objPtr->typePtr = &tkUidObjType;
+    return uid;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DupUidInternalRep --
+ *
+ *	Initialize the internal representation of a "uid" Tcl_Obj to a copy
+ *	of the internal representation of an existing object. Uids are
+ *	interned forever, so the cached pointers can be shared freely within
+ *	a thread.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The copy gets the same cached Uid as the source object.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DupUidInternalRep(
+    Tcl_Obj *srcPtr,		/* Object with internal rep to copy. */
+    Tcl_Obj *copyPtr)		/* Object with internal rep to set. */
+{
+    copyPtr->internalRep.twoPtrValue = srcPtr->internalRep.twoPtrValue;
+    copyPtr->typePtr = &tkUidObjType;
 }
 
 /*
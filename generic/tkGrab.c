@@ -1236,6 +1236,10 @@ TkGrabDeadWindow(
     if (dispPtr->grabWinPtr == winPtr) {
 	dispPtr->grabWinPtr = NULL;
     }
+    if ((dispPtr->grabCacheWinPtr == winPtr)
+	    || (dispPtr->grabCacheGrabWinPtr == winPtr)) {
+	dispPtr->grabCacheWinPtr = NULL;
+    }
 }
 
 /*
@@ -1582,17 +1586,36 @@ TkGrabState(
     TkWindow *winPtr)		/* Window for which grab information is
 				 * needed. */
 {
-    TkWindow *grabWinPtr = winPtr->dispPtr->grabWinPtr;
+    TkDisplay *dispPtr = winPtr->dispPtr;
+    TkWindow *grabWinPtr = dispPtr->grabWinPtr;
 
     if (grabWinPtr == NULL) {
 	return TK_GRAB_NONE;
     }
     if ((winPtr->mainPtr != grabWinPtr->mainPtr)
-	    && !(winPtr->dispPtr->grabFlags & GRAB_GLOBAL)) {
+	    && !(dispPtr->grabFlags & GRAB_GLOBAL)) {
 	return TK_GRAB_NONE;
     }
 
-    return TkPositionInTree(winPtr, grabWinPtr);
+    /*
+     * While a grab is active this function runs several times per pointer
+     * event for the same window, each time walking the window's ancestry.
+     * Tk never reparents windows within its hierarchy, so the result can
+     * only change when a window dies (handled in TkGrabDeadWindow) or when
+     * the grab itself changes; cache it for those repeated calls.
+     */
+
+    if ((winPtr == dispPtr->grabCacheWinPtr)
+	    && (grabWinPtr == dispPtr->grabCacheGrabWinPtr)
+	    && (dispPtr->grabFlags == dispPtr->grabCacheFlags)) {
+	return dispPtr->grabCacheState;
+    }
+
+    dispPtr->grabCacheWinPtr = winPtr;
+    dispPtr->grabCacheGrabWinPtr = grabWinPtr;
+    dispPtr->grabCacheFlags = dispPtr->grabFlags;
+    dispPtr->grabCacheState = TkPositionInTree(winPtr, grabWinPtr);
+    return dispPtr->grabCacheState;
 }
 
 /*
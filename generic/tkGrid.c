@@ -88,6 +88,10 @@ typedef struct SlotInfo {
 				 * introspection. It is the pixel offset of
 				 * the right or bottom edge of this slot from
 				 * the beginning of the layout. */
+    int prevOffset;		/* The offset this slot had when the layout
+				 * was last applied to the content windows.
+				 * Used to detect that a re-solve left the
+				 * layout unchanged. */
     int temp;			/* This is a temporary value used for
 				 * calculating adjusted weights when shrinking
 				 * the layout below its nominal size. */
@@ -144,6 +148,20 @@ typedef struct {
     				 * container. */
     Tk_Anchor anchor;		/* Value of anchor option: specifies where a
 				 * grid without weight should be placed. */
+    int lastRealWidth;		/* Layout area at the time the layout was
+				 * last applied; part of the check whether
+				 * the layout is unchanged. */
+    int lastRealHeight;		/* Likewise for the height. */
+    int lastColSlots;		/* Number of column slots when the layout was
+				 * last applied. */
+    int lastRowSlots;		/* Likewise for the rows. */
+    int lastMapped;		/* Whether the container was mapped when the
+				 * layout was last applied. */
+    int layoutValid;		/* Non-zero means the last ArrangeGrid pass
+				 * completed without being aborted, so the
+				 * prevOffset values and the fields above
+				 * describe the geometry the content windows
+				 * actually have. */
 } GridContainer;
 
 /*
@@ -243,11 +261,26 @@ typedef struct UniformGroup {
  *				needs of its content.
  * ALLOCED_CONTAINER		1 means that Grid has allocated itself as
  *				geometry container for this window.
+ * REQ_DIRTY		1 means the geometry inputs of this content window
+ *				(requested size, border width or grid options)
+ *				changed since it was last placed, so it must be
+ *				re-placed even if the row/column layout of its
+ *				container did not change.
  */
 
 #define REQUESTED_RELAYOUT	1
 #define DONT_PROPAGATE		2
 #define ALLOCED_CONTAINER	4
+#define REQ_DIRTY		8
+
+/*
+ * Number of times the row/column constraint solver has run, for performance
+ * monitoring from the test command testgridsolves. Read through
+ * TkGridSolveStats, since tkTest.c links against the stub tables and cannot
+ * reference the counter itself.
+ */
+
+static Tcl_WideInt gridSolveCount = 0;
 
 /*
  * Prototypes for procedures used only in this file:
@@ -311,6 +344,36 @@ static const Tk_GeomMgr gridMgrType = {
     GridLostContentProc,		/* lostContentProc */
 };
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkGridSolveStats --
+ *
+ *	Returns the number of times the row/column constraint solver has run,
+ *	for the "testgridsolves" command. Exported through the internal stub
+ *	table so that tkTest.c can reach it.
+ *
+ * Results:
+ *	The current value of the solve counter.
+ *
+ * Side effects:
+ *	If reset is non-zero, the counter is cleared after being read.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Tcl_WideInt
+TkGridSolveStats(
+    int reset)			/* Non-zero means clear the counter. */
+{
+    Tcl_WideInt count = gridSolveCount;
+
+    if (reset) {
+	gridSolveCount = 0;
+    }
+    return count;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -485,7 +548,7 @@ GridAnchorCommand(
 	}
 	if (!(containerPtr->flags & REQUESTED_RELAYOUT)) {
 	    containerPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	    TkScheduleLayout(containerPtr->tkwin, ArrangeGrid, containerPtr);
 	}
     }
     return TCL_OK;
@@ -678,7 +741,7 @@ GridForgetRemoveCommand(
 		}
 		contentPtr->doubleBw = 2*Tk_Changes(tkwin)->border_width;
 		if (contentPtr->flags & REQUESTED_RELAYOUT) {
-		    Tcl_CancelIdleCall(ArrangeGrid, contentPtr);
+		    TkUnscheduleLayout(ArrangeGrid, contentPtr);
 		}
 		contentPtr->flags = 0;
 		contentPtr->sticky = 0;
@@ -834,7 +897,7 @@ GridLocationCommand(
      */
 
     while (containerPtr->flags & REQUESTED_RELAYOUT) {
-	Tcl_CancelIdleCall(ArrangeGrid, containerPtr);
+	TkUnscheduleLayout(ArrangeGrid, containerPtr);
 	ArrangeGrid(containerPtr);
     }
     SetGridSize(containerPtr);
@@ -947,7 +1010,7 @@ GridPropagateCommand(
 	}
 	if (!(containerPtr->flags & REQUESTED_RELAYOUT)) {
 	    containerPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	    TkScheduleLayout(containerPtr->tkwin, ArrangeGrid, containerPtr);
 	}
     }
     return TCL_OK;
@@ -1274,7 +1337,7 @@ GridRowColumnConfigureCommand(
     }
     if (!(containerPtr->flags & REQUESTED_RELAYOUT)) {
 	containerPtr->flags |= REQUESTED_RELAYOUT;
-	Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	TkScheduleLayout(containerPtr->tkwin, ArrangeGrid, containerPtr);
     }
     return TCL_OK;
 
@@ -1447,10 +1510,11 @@ GridReqProc(
 {
     Gridder *gridPtr = (Gridder *)clientData;
 
+    gridPtr->flags |= REQ_DIRTY;
     gridPtr = gridPtr->containerPtr;
     if (gridPtr && !(gridPtr->flags & REQUESTED_RELAYOUT)) {
 	gridPtr->flags |= REQUESTED_RELAYOUT;
-	Tcl_DoWhenIdle(ArrangeGrid, gridPtr);
+	TkScheduleLayout(gridPtr->tkwin, ArrangeGrid, gridPtr);
     }
 }
 
@@ -1742,6 +1806,11 @@ ArrangeGrid(
     int width, height;		/* Requested size of layout, in pixels. */
     int realWidth, realHeight;	/* Actual size layout should take-up. */
     int usedX, usedY;
+    int numColSlots, numRowSlots;
+				/* Number of column/row slots in the layout. */
+    int layoutUnchanged;	/* The adjusted layout is identical to the one
+				 * applied by the last completed pass. */
+    int slot;
 
     containerPtr->flags &= ~REQUESTED_RELAYOUT;
 
@@ -1797,7 +1866,7 @@ ArrangeGrid(
 	Tk_GeometryRequest(containerPtr->tkwin, width, height);
 	if (width>1 && height>1) {
 	    containerPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	    TkScheduleLayout(containerPtr->tkwin, ArrangeGrid, containerPtr);
 	}
 	containerPtr->abortPtr = NULL;
 	Tcl_Release(containerPtr);
@@ -1824,6 +1893,44 @@ ArrangeGrid(
     TkComputeAnchor(containerPtr->containerDataPtr->anchor, containerPtr->tkwin,
 	    0, 0, usedX, usedY, &slotPtr->startX, &slotPtr->startY);
 
+    /*
+     * Determine whether the adjusted layout differs from the one that was
+     * applied by the last completed pass. If it does not, content windows
+     * whose own geometry inputs are unchanged are already in place and can
+     * be skipped below; a change confined to one cell then re-places only
+     * the windows of that cell.
+     */
+
+    numColSlots = MAX(slotPtr->columnEnd, slotPtr->columnMax);
+    numRowSlots = MAX(slotPtr->rowEnd, slotPtr->rowMax);
+    layoutUnchanged = slotPtr->layoutValid
+	    && (realWidth == slotPtr->lastRealWidth)
+	    && (realHeight == slotPtr->lastRealHeight)
+	    && (numColSlots == slotPtr->lastColSlots)
+	    && (numRowSlots == slotPtr->lastRowSlots)
+	    && ((Tk_IsMapped(containerPtr->tkwin) != 0)
+		    == slotPtr->lastMapped);
+    for (slot = 0; slot < numColSlots; slot++) {
+	if (slotPtr->columnPtr[slot].offset
+		!= slotPtr->columnPtr[slot].prevOffset) {
+	    slotPtr->columnPtr[slot].prevOffset =
+		    slotPtr->columnPtr[slot].offset;
+	    layoutUnchanged = 0;
+	}
+    }
+    for (slot = 0; slot < numRowSlots; slot++) {
+	if (slotPtr->rowPtr[slot].offset != slotPtr->rowPtr[slot].prevOffset) {
+	    slotPtr->rowPtr[slot].prevOffset = slotPtr->rowPtr[slot].offset;
+	    layoutUnchanged = 0;
+	}
+    }
+    slotPtr->lastRealWidth = realWidth;
+    slotPtr->lastRealHeight = realHeight;
+    slotPtr->lastColSlots = numColSlots;
+    slotPtr->lastRowSlots = numRowSlots;
+    slotPtr->lastMapped = (Tk_IsMapped(containerPtr->tkwin) != 0);
+    slotPtr->layoutValid = 0;
+
     /*
      * Now adjust the actual size of the content to its cavity by computing the
      * cavity size, and adjusting the widget according to its stickyness.
@@ -1835,6 +1942,10 @@ ArrangeGrid(
 	int col = contentPtr->column;
 	int row = contentPtr->row;
 
+	if (layoutUnchanged && !(contentPtr->flags & REQ_DIRTY)) {
+	    continue;
+	}
+
 	x = (col>0) ? slotPtr->columnPtr[col-1].offset : 0;
 	y = (row>0) ? slotPtr->rowPtr[row-1].offset : 0;
 
@@ -1882,6 +1993,10 @@ ArrangeGrid(
 	    Tk_MaintainGeometry(contentPtr->tkwin, containerPtr->tkwin, x, y,
 		    width, height);
 	}
+	contentPtr->flags &= ~REQ_DIRTY;
+    }
+    if (!abort) {
+	slotPtr->layoutValid = 1;
     }
 
     containerPtr->abortPtr = NULL;
@@ -1952,6 +2067,8 @@ ResolveConstraints(
 
     GridLayout layoutData[TYPICAL_SIZE + 1];
 
+    gridSolveCount++;
+
     if (slotType == COLUMN) {
 	constraintCount = containerPtr->containerDataPtr->columnMax;
 	slotCount = containerPtr->containerDataPtr->columnEnd;
@@ -2729,6 +2846,12 @@ InitContainerData(
 	gridPtr->startX = 0;
 	gridPtr->startY = 0;
 	gridPtr->anchor = GRID_DEFAULT_ANCHOR;
+	gridPtr->lastRealWidth = 0;
+	gridPtr->lastRealHeight = 0;
+	gridPtr->lastColSlots = 0;
+	gridPtr->lastRowSlots = 0;
+	gridPtr->lastMapped = 0;
+	gridPtr->layoutValid = 0;
 
 	memset(gridPtr->columnPtr, 0, size);
 	memset(gridPtr->rowPtr, 0, size);
@@ -2778,7 +2901,7 @@ Unlink(
     }
     if (!(containerPtr->flags & REQUESTED_RELAYOUT)) {
 	containerPtr->flags |= REQUESTED_RELAYOUT;
-	Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	TkScheduleLayout(containerPtr->tkwin, ArrangeGrid, containerPtr);
     }
     if (containerPtr->abortPtr != NULL) {
 	*containerPtr->abortPtr = 1;
@@ -2874,14 +2997,16 @@ GridStructureProc(
 	if ((gridPtr->contentPtr != NULL)
 		&& !(gridPtr->flags & REQUESTED_RELAYOUT)) {
 	    gridPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, gridPtr);
+	    TkScheduleLayout(gridPtr->tkwin, ArrangeGrid, gridPtr);
 	}
 	if ((gridPtr->containerPtr != NULL) &&
 		(gridPtr->doubleBw != 2*Tk_Changes(gridPtr->tkwin)->border_width)) {
 	    if (!(gridPtr->containerPtr->flags & REQUESTED_RELAYOUT)) {
 		gridPtr->doubleBw = 2*Tk_Changes(gridPtr->tkwin)->border_width;
+		gridPtr->flags |= REQ_DIRTY;
 		gridPtr->containerPtr->flags |= REQUESTED_RELAYOUT;
-		Tcl_DoWhenIdle(ArrangeGrid, gridPtr->containerPtr);
+		TkScheduleLayout(gridPtr->containerPtr->tkwin, ArrangeGrid,
+			gridPtr->containerPtr);
 	    }
 	}
     } else if (eventPtr->type == DestroyNotify) {
@@ -2901,7 +3026,7 @@ GridStructureProc(
 	Tcl_DeleteHashEntry(Tcl_FindHashEntry(&dispPtr->gridHashTable,
 		gridPtr->tkwin));
 	if (gridPtr->flags & REQUESTED_RELAYOUT) {
-	    Tcl_CancelIdleCall(ArrangeGrid, gridPtr);
+	    TkUnscheduleLayout(ArrangeGrid, gridPtr);
 	}
 	gridPtr->tkwin = NULL;
 	Tcl_EventuallyFree(gridPtr, (Tcl_FreeProc *)DestroyGrid);
@@ -2909,7 +3034,7 @@ GridStructureProc(
 	if ((gridPtr->contentPtr != NULL)
 		&& !(gridPtr->flags & REQUESTED_RELAYOUT)) {
 	    gridPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, gridPtr);
+	    TkScheduleLayout(gridPtr->tkwin, ArrangeGrid, gridPtr);
 	}
     } else if (eventPtr->type == UnmapNotify) {
 	Gridder *contentPtr;
@@ -3426,12 +3551,13 @@ ConfigureContent(
 	 */
 
     scheduleLayout:
+	contentPtr->flags |= REQ_DIRTY;
 	if (containerPtr->abortPtr != NULL) {
 	    *containerPtr->abortPtr = 1;
 	}
 	if (!(containerPtr->flags & REQUESTED_RELAYOUT)) {
 	    containerPtr->flags |= REQUESTED_RELAYOUT;
-	    Tcl_DoWhenIdle(ArrangeGrid, containerPtr);
+	    TkScheduleLayout(containerPtr->tkwin, ArrangeGrid, containerPtr);
 	}
     }
 
@@ -64,6 +64,13 @@ typedef struct ImageModel {
     int deleted;		/* Flag set when image is being deleted. */
     TkWindow *winPtr;		/* Main window of interpreter (used to detect
 				 * when the world is falling apart.) */
+    int dirtyX, dirtyY;		/* Upper-left corner of the area accumulated
+				 * from Tk_ImageChanged calls that has not
+				 * yet been delivered to the instances. */
+    int dirtyWidth, dirtyHeight;/* Dimensions of that area; dirtyWidth <= 0
+				 * means no delivery is being held back. */
+    int notifyPending;		/* Non-zero means an idle call to deliver the
+				 * accumulated area is scheduled. */
 } ImageModel;
 
 typedef struct {
@@ -82,6 +89,7 @@ static Tcl_ThreadDataKey dataKey;
  */
 
 static void		ImageTypeThreadExitProc(ClientData clientData);
+static void		DeliverImageChanges(ClientData clientData);
 static void		DeleteImage(ImageModel *modelPtr);
 static void		EventuallyDeleteImage(ImageModel *modelPtr,
 			    int forgetImageHashNow);
@@ -327,6 +335,9 @@ Tk_ImageObjCmd(
 	    modelPtr->instancePtr = NULL;
 	    modelPtr->deleted = 0;
 	    modelPtr->winPtr = winPtr->mainPtr->winPtr;
+	    modelPtr->dirtyX = modelPtr->dirtyY = 0;
+	    modelPtr->dirtyWidth = modelPtr->dirtyHeight = 0;
+	    modelPtr->notifyPending = 0;
 	    Tcl_Preserve(modelPtr->winPtr);
 	    Tcl_SetHashValue(hPtr, modelPtr);
 	} else {
@@ -535,12 +546,120 @@ Tk_ImageChanged(
     ImageModel *modelPtr = (ImageModel *) imageModel;
     Image *imagePtr;
 
-    modelPtr->width = imageWidth;
-    modelPtr->height = imageHeight;
+    if ((imageWidth != modelPtr->width) || (imageHeight != modelPtr->height)) {
+	/*
+	 * A size change must reach the instances synchronously: widgets
+	 * adjust their geometry requests from within the changeProc and
+	 * scripts rely on seeing the result immediately. Fold any content
+	 * area that is still being held back into this notification.
+	 */
+
+	if (modelPtr->notifyPending) {
+	    Tcl_CancelIdleCall(DeliverImageChanges, modelPtr);
+	    modelPtr->notifyPending = 0;
+	}
+	if ((modelPtr->dirtyWidth > 0) && (modelPtr->dirtyHeight > 0)) {
+	    int x2 = x + width, y2 = y + height;
+
+	    if (modelPtr->dirtyX < x) {
+		x = modelPtr->dirtyX;
+	    }
+	    if (modelPtr->dirtyY < y) {
+		y = modelPtr->dirtyY;
+	    }
+	    if (modelPtr->dirtyX + modelPtr->dirtyWidth > x2) {
+		x2 = modelPtr->dirtyX + modelPtr->dirtyWidth;
+	    }
+	    if (modelPtr->dirtyY + modelPtr->dirtyHeight > y2) {
+		y2 = modelPtr->dirtyY + modelPtr->dirtyHeight;
+	    }
+	    width = x2 - x;
+	    height = y2 - y;
+	    modelPtr->dirtyWidth = modelPtr->dirtyHeight = 0;
+	}
+	modelPtr->width = imageWidth;
+	modelPtr->height = imageHeight;
+	for (imagePtr = modelPtr->instancePtr; imagePtr != NULL;
+		imagePtr = imagePtr->nextPtr) {
+	    imagePtr->changeProc(imagePtr->widgetClientData, x, y, width,
+		    height, imageWidth, imageHeight);
+	}
+	return;
+    }
+
+    /*
+     * Only the content changed. Accumulate the changed area and notify the
+     * instances once per event-loop pass; an image that is modified many
+     * times between two screen updates (an animation, or a script issuing
+     * many separate put operations) then walks its instances once with the
+     * merged area instead of once per call.
+     */
+
+    if ((modelPtr->dirtyWidth > 0) && (modelPtr->dirtyHeight > 0)) {
+	int x2 = modelPtr->dirtyX + modelPtr->dirtyWidth;
+	int y2 = modelPtr->dirtyY + modelPtr->dirtyHeight;
+
+	if (x + width > x2) {
+	    x2 = x + width;
+	}
+	if (y + height > y2) {
+	    y2 = y + height;
+	}
+	if (x < modelPtr->dirtyX) {
+	    modelPtr->dirtyX = x;
+	}
+	if (y < modelPtr->dirtyY) {
+	    modelPtr->dirtyY = y;
+	}
+	modelPtr->dirtyWidth = x2 - modelPtr->dirtyX;
+	modelPtr->dirtyHeight = y2 - modelPtr->dirtyY;
+    } else {
+	modelPtr->dirtyX = x;
+	modelPtr->dirtyY = y;
+	modelPtr->dirtyWidth = width;
+	modelPtr->dirtyHeight = height;
+    }
+    if (!modelPtr->notifyPending) {
+	modelPtr->notifyPending = 1;
+	Tcl_DoWhenIdle(DeliverImageChanges, modelPtr);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DeliverImageChanges --
+ *
+ *	Idle callback that walks the instances of an image and notifies each
+ *	of them once of all the content changes accumulated since the last
+ *	delivery.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The instance widgets will typically schedule their redisplay.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DeliverImageChanges(
+    ClientData clientData)	/* Pointer to ImageModel. */
+{
+    ImageModel *modelPtr = (ImageModel *)clientData;
+    Image *imagePtr;
+    int x = modelPtr->dirtyX;
+    int y = modelPtr->dirtyY;
+    int width = modelPtr->dirtyWidth;
+    int height = modelPtr->dirtyHeight;
+
+    modelPtr->notifyPending = 0;
+    modelPtr->dirtyWidth = modelPtr->dirtyHeight = 0;
     for (imagePtr = modelPtr->instancePtr; imagePtr != NULL;
 	    imagePtr = imagePtr->nextPtr) {
 	imagePtr->changeProc(imagePtr->widgetClientData, x, y, width, height,
-		imageWidth, imageHeight);
+		modelPtr->width, modelPtr->height);
     }
 }
 
@@ -698,6 +817,9 @@ Tk_FreeImage(
 	if (modelPtr->hPtr != NULL) {
 	    Tcl_DeleteHashEntry(modelPtr->hPtr);
 	}
+	if (modelPtr->notifyPending) {
+	    Tcl_CancelIdleCall(DeliverImageChanges, modelPtr);
+	}
 	Tcl_Release(modelPtr->winPtr);
 	ckfree(modelPtr);
     }
@@ -975,6 +1097,9 @@ DeleteImage(
 	if (modelPtr->hPtr != NULL) {
 	    Tcl_DeleteHashEntry(modelPtr->hPtr);
 	}
+	if (modelPtr->notifyPending) {
+	    Tcl_CancelIdleCall(DeliverImageChanges, modelPtr);
+	}
 	Tcl_Release(modelPtr->winPtr);
 	ckfree(modelPtr);
     } else {
@@ -104,6 +104,15 @@ typedef struct {
 	int bitsInWindow;
 	unsigned char *c;
     } reader;
+    struct {
+	unsigned char buf[2048];
+	int len;		/* Number of valid bytes in buf. */
+	int pos;		/* Index of the next unconsumed byte. */
+    } readAhead;		/* Read-ahead buffer for the file case of
+				 * Fread. GIF data arrives as length-prefixed
+				 * sub-blocks of at most 255 bytes, so
+				 * unbuffered decoding would go to the
+				 * channel twice per sub-block. */
 } GIFImageConfig;
 
 /*
@@ -412,7 +421,6 @@ FileReadGIF(
     int index = 0, argc = 0, i, result = TCL_ERROR;
     Tcl_Obj **objv;
     unsigned char buf[100];
-    unsigned char *trashBuffer = NULL;
     int bitPixel;
     int gifLabel;
     unsigned char colorMap[MAXCOLORMAPSIZE][4];
@@ -599,39 +607,32 @@ FileReadGIF(
 	    }
 
 	    /*
-	     * If we've not yet allocated a trash buffer, do so now.
+	     * The raster data of the unwanted frame is stored as an LZW
+	     * minimum code size byte followed by length-prefixed data
+	     * sub-blocks, so the frame can be stepped over by walking the
+	     * length prefixes; there is no need to run the LZW decoder
+	     * just to find where the frame ends. This is what makes
+	     * stepping through the frames of a long animation cheap, as
+	     * reaching frame n previously decoded the n-1 frames in front
+	     * of it into a scratch buffer.
 	     */
 
-	    if (trashBuffer == NULL) {
-		if (fileWidth > (int)((UINT_MAX/3)/fileHeight)) {
-		    goto error;
-		}
-		nBytes = fileWidth * fileHeight * 3;
-		trashBuffer = (unsigned char *)ckalloc(nBytes);
-		if (trashBuffer) {
-		    memset(trashBuffer, 0, nBytes);
-		}
+	    if (Fread(gifConfPtr, buf, 1, 1, chan) != 1) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(
+			"error reading GIF image data", -1));
+		Tcl_SetErrorCode(interp, "TK", "IMAGE", "GIF", "DATA",
+			NULL);
+		goto error;
 	    }
-
-	    /*
-	     * Slurp! Process the data for this image and stuff it in a trash
-	     * buffer.
-	     *
-	     * Yes, it might be more efficient here to *not* store the data
-	     * (we're just going to throw it away later). However, I elected
-	     * to implement it this way for good reasons. First, I wanted to
-	     * avoid duplicating the (fairly complex) LWZ decoder in
-	     * ReadImage. Fine, you say, why didn't you just modify it to
-	     * allow the use of a NULL specifier for the output buffer? I
-	     * tried that, but it negatively impacted the performance of what
-	     * I think will be the common case: reading the first image in the
-	     * file. Rather than marginally improve the speed of the less
-	     * frequent case, I chose to maintain high performance for the
-	     * common case.
-	     */
-
-	    if (ReadImage(gifConfPtr, interp, trashBuffer, chan, imageWidth,
-		    imageHeight, colorMap, 0, 0, 0, -1) != TCL_OK) {
+	    do {
+		bitPixel = GetDataBlock(gifConfPtr, chan,
+			gifConfPtr->workingBuffer);
+	    } while (bitPixel > 0);
+	    if (bitPixel < 0) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(
+			"error reading GIF image data", -1));
+		Tcl_SetErrorCode(interp, "TK", "IMAGE", "GIF", "DATA",
+			NULL);
 		goto error;
 	    }
 	    continue;
@@ -771,14 +772,6 @@ FileReadGIF(
     result = TCL_OK;
 
 error:
-    
-    /*
-     * If a trash buffer has been allocated, free it now.
-     */
-
-    if (trashBuffer != NULL) {
-	ckfree(trashBuffer);
-    }
     return result;
 }
 
@@ -854,7 +847,7 @@ StringMatchGIF(
     TkSizeT got, length;
     MFile handle;
 
-    data = Tcl_GetByteArrayFromObj(dataObj, &length);
+    data = TkImgGetDataBytes(dataObj, &length);
 
     /*
      * Header is a minimum of 10 bytes.
@@ -924,7 +917,7 @@ StringReadGIF(
     MFile handle, *hdlPtr = &handle;
     TkSizeT length;
     const char *xferFormat;
-    unsigned char *data = Tcl_GetByteArrayFromObj(dataObj, &length);
+    unsigned char *data = TkImgGetDataBytes(dataObj, &length);
 
     mInit(data, hdlPtr, length);
 
@@ -1240,8 +1233,14 @@ ReadImage(
     oldCode = -1;
     firstCode = -1;
 
-    memset(prefix, 0, (1 << MAX_LWZ_BITS) * sizeof(short));
-    memset(append, 0, (1 << MAX_LWZ_BITS) * sizeof(char));
+    /*
+     * Only the singleton entries of the code table need initial values.
+     * Clearing the rest of prefix[] and append[] would be wasted work: the
+     * decoder rejects any code above maxCode before looking it up, and
+     * every entry below maxCode is written when maxCode grows past it, so
+     * no slot is ever read before it has been assigned.
+     */
+
     for (i = 0; i < clearCode; i++) {
 	append[i] = i;
     }
@@ -1744,10 +1743,52 @@ Fread(
     }
 
     /*
-     * Otherwise we've got a real file to read.
+     * Otherwise we've got a real file to read. Serve the request from the
+     * read-ahead buffer, refilling it in large chunks; requests that are
+     * bigger than the buffer bypass it once the buffered bytes are used up.
+     * Reading past the end of the GIF data is harmless because the whole
+     * channel belongs to this decoder for the duration of the operation.
      */
 
-    return Tcl_Read(chan, (char *) dst, hunk * count);
+    {
+	size_t total = hunk * count, copied = 0, n;
+	int got;
+
+	while (copied < total) {
+	    if (gifConfPtr->readAhead.pos < gifConfPtr->readAhead.len) {
+		n = gifConfPtr->readAhead.len - gifConfPtr->readAhead.pos;
+		if (n > total - copied) {
+		    n = total - copied;
+		}
+		memcpy(dst + copied,
+			gifConfPtr->readAhead.buf + gifConfPtr->readAhead.pos,
+			n);
+		gifConfPtr->readAhead.pos += (int) n;
+		copied += n;
+		continue;
+	    }
+	    if (total - copied >= sizeof(gifConfPtr->readAhead.buf)) {
+		got = Tcl_Read(chan, (char *) dst + copied, total - copied);
+		if (got > 0) {
+		    copied += (size_t) got;
+		} else if ((copied == 0) && (got < 0)) {
+		    return (size_t) -1;
+		}
+		break;
+	    }
+	    got = Tcl_Read(chan, (char *) gifConfPtr->readAhead.buf,
+		    sizeof(gifConfPtr->readAhead.buf));
+	    if (got <= 0) {
+		if ((copied == 0) && (got < 0)) {
+		    return (size_t) -1;
+		}
+		break;
+	    }
+	    gifConfPtr->readAhead.len = got;
+	    gifConfPtr->readAhead.pos = 0;
+	}
+	return copied;
+    }
 }
 
 /*
@@ -336,7 +336,7 @@ InitPNGImage(
 	Tcl_IncrRefCount(objPtr);
 	pngPtr->objDataPtr = objPtr;
 	pngPtr->strDataBuf =
-		Tcl_GetByteArrayFromObj(objPtr, &pngPtr->strDataLen);
+		TkImgGetDataBytes(objPtr, &pngPtr->strDataLen);
     }
 
     /*
@@ -1287,7 +1287,7 @@ ReadIHDR(
      */
 
     if (mismatch && pngPtr->strDataBuf) {
-	pngPtr->strDataBuf = Tcl_GetByteArrayFromObj(pngPtr->objDataPtr,
+	pngPtr->strDataBuf = TkImgGetDataBytes(pngPtr->objDataPtr,
 		&pngPtr->strDataLen);
 	pngPtr->base64Data = pngPtr->strDataBuf;
 
@@ -1955,6 +1955,40 @@ DecodeLine(
 	return TCL_ERROR;
     }
 
+    /*
+     * Fast path for 8-bit, non-interlaced, non-palette images, which is
+     * where virtually all large photographic images end up. The samples of
+     * an unfiltered scan line are already in the order the photo block
+     * expects, so the row can be copied wholesale (adding opaque alpha
+     * where the source has no alpha channel) instead of being reassembled
+     * sample by sample below.
+     */
+
+    if (!pngPtr->interlace && (8 == pngPtr->bitDepth)
+	    && (PNG_COLOR_PLTE != pngPtr->colorType)
+	    && ((pngPtr->colorType & PNG_COLOR_ALPHA) || !pngPtr->useTRNS)) {
+	unsigned char *destPtr = pixelPtr
+		+ pngPtr->currentLine * pngPtr->block.pitch;
+
+	if (pngPtr->colorType & PNG_COLOR_ALPHA) {
+	    memcpy(destPtr, p,
+		    (size_t) pngPtr->block.width * pngPtr->numChannels);
+	} else if (PNG_COLOR_RGB == pngPtr->colorType) {
+	    for (colNum = 0; colNum < pngPtr->block.width; colNum++) {
+		*destPtr++ = *p++;
+		*destPtr++ = *p++;
+		*destPtr++ = *p++;
+		*destPtr++ = 255;
+	    }
+	} else {
+	    for (colNum = 0; colNum < pngPtr->block.width; colNum++) {
+		*destPtr++ = *p++;
+		*destPtr++ = 255;
+	    }
+	}
+	pngPtr->currentLine++;
+	return TCL_OK;
+    }
 
     if (pngPtr->interlace) {
 	switch (pngPtr->phase) {
@@ -2936,7 +2970,7 @@ StringMatchPNG(
 
     InitPNGImage(NULL, &png, NULL, pObjData, TCL_ZLIB_STREAM_INFLATE);
 
-    png.strDataBuf = Tcl_GetByteArrayFromObj(pObjData, &png.strDataLen);
+    png.strDataBuf = TkImgGetDataBytes(pObjData, &png.strDataLen);
 
     if (ReadIHDR(interp, &png) == TCL_OK) {
 	*widthPtr = png.block.width;
@@ -3359,6 +3393,33 @@ WriteIDAT(
 
 	*destPtr++ = PNG_FILTER_NONE;
 
+	/*
+	 * When the source block is already laid out exactly like the output
+	 * pixels, copy the row in one go. The photo model always hands over
+	 * 4-byte RGBA pixels, so this covers every truecolor write; the
+	 * pixel-by-pixel loop below remains for grayscale output and for
+	 * callers with other block layouts.
+	 */
+
+	if ((blockPtr->pixelSize == 4) && (blockPtr->offset[0] == 0)
+		&& (blockPtr->offset[1] == 1) && (blockPtr->offset[2] == 2)
+		&& (blockPtr->offset[3] == 3)
+		&& (PNG_COLOR_RGBA == pngPtr->colorType)) {
+	    memcpy(destPtr, srcPtr, (size_t) blockPtr->width * 4);
+	    goto compressRow;
+	}
+	if ((blockPtr->pixelSize == 4) && (blockPtr->offset[0] == 0)
+		&& (blockPtr->offset[1] == 1) && (blockPtr->offset[2] == 2)
+		&& (PNG_COLOR_RGB == pngPtr->colorType)) {
+	    for (colNum = 0 ; colNum < blockPtr->width ; colNum++) {
+		*destPtr++ = srcPtr[0];
+		*destPtr++ = srcPtr[1];
+		*destPtr++ = srcPtr[2];
+		srcPtr += 4;
+	    }
+	    goto compressRow;
+	}
+
 	/*
 	 * Copy each pixel into the destination buffer after the filter type
 	 * before filtering.
@@ -3402,6 +3463,7 @@ WriteIDAT(
 	 * choke on. [Bug 2984787]
 	 */
 
+    compressRow:
 	if (rowNum + 1 == blockPtr->height) {
 	    flush = TCL_ZLIB_FINALIZE;
 	}
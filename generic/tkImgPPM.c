@@ -144,6 +144,7 @@ FileReadPPM(
     int nLines, h, type, bytesPerChannel = 1;
     size_t nBytes, count;
     unsigned char *pixelPtr;
+    unsigned char scaleMap[256];
     Tk_PhotoImageBlock block;
 
     type = ReadPPMFileHeader(chan, &fileWidth, &fileHeight, &maxIntensity);
@@ -215,6 +216,19 @@ FileReadPPM(
     pixelPtr = (unsigned char *)ckalloc(nBytes);
     block.pixelPtr = pixelPtr + srcX * block.pixelSize;
 
+    if (maxIntensity < 0x00ff) {
+	int i;
+
+	/*
+	 * Map every possible sample value to full range once, instead of
+	 * dividing by maxIntensity for each byte of each row below.
+	 */
+
+	for (i = 0; i < 256; i++) {
+	    scaleMap[i] = (unsigned char) ((i * 255) / maxIntensity);
+	}
+    }
+
     for (h = height; h > 0; h -= nLines) {
 	if (nLines > h) {
 	    nLines = h;
@@ -235,13 +249,28 @@ FileReadPPM(
 	    unsigned char *p;
 
 	    for (p = pixelPtr; count > 0; count--, p++) {
-		*p = (((int) *p) * 255)/maxIntensity;
+		*p = scaleMap[*p];
+	    }
+	} else if (maxIntensity == 0xffff) {
+	    unsigned char *p;
+	    unsigned int value;
+
+	    /*
+	     * Full-range 16-bit samples, the usual case for 16-bit capture
+	     * hardware. 65535 is 255*257, so scaling to 8 bits is an exact
+	     * division by the constant 257, which the compiler strength-
+	     * reduces to a multiply and shift.
+	     */
+
+	    for (p = pixelPtr; count > 1; count -= 2, p += 2) {
+		value = ((unsigned int) p[0]) * 256 + ((unsigned int) p[1]);
+		p[0] = p[1] = (unsigned char) (value / 257);
 	    }
 	} else if (maxIntensity > 0x00ff) {
 	    unsigned char *p;
 	    unsigned int value;
 
-	    for (p = pixelPtr; count > 0; count--, p += 2) {
+	    for (p = pixelPtr; count > 1; count -= 2, p += 2) {
 		value = ((unsigned int) p[0]) * 256 + ((unsigned int) p[1]);
 		value = value * 255 / maxIntensity;
 		p[0] = p[1] = (unsigned char) value;
@@ -493,6 +522,7 @@ StringReadPPM(
     int fileWidth, fileHeight, maxIntensity;
     int nLines, nBytes, h, type, count, dataSize, bytesPerChannel = 1;
     unsigned char *pixelPtr, *dataBuffer;
+    unsigned char scaleMap[256];
     Tk_PhotoImageBlock block;
 
     type = ReadPPMStringHeader(dataObj, &fileWidth, &fileHeight,
@@ -583,6 +613,19 @@ StringReadPPM(
     pixelPtr = (unsigned char *)ckalloc(nBytes);
     block.pixelPtr = pixelPtr + srcX * block.pixelSize;
 
+    if (maxIntensity < 0x00ff) {
+	int i;
+
+	/*
+	 * Map every possible sample value to full range once, instead of
+	 * dividing by maxIntensity for each byte of each row below.
+	 */
+
+	for (i = 0; i < 256; i++) {
+	    scaleMap[i] = (unsigned char) ((i * 255) / maxIntensity);
+	}
+    }
+
     for (h = height; h > 0; h -= nLines) {
 	unsigned char *p;
 
@@ -599,11 +642,28 @@ StringReadPPM(
 	}
 	if (maxIntensity < 0x00ff) {
 	    for (p=pixelPtr,count=nBytes ; count>0 ; count--,p++,dataBuffer++) {
-		*p = (((int) *dataBuffer) * 255)/maxIntensity;
+		*p = scaleMap[*dataBuffer];
+	    }
+	} else if (maxIntensity == 0xffff) {
+	    unsigned int value;
+
+	    /*
+	     * Full-range 16-bit samples: scaling to 8 bits is an exact
+	     * division by the constant 257 (65535 is 255*257), which the
+	     * compiler strength-reduces to a multiply and shift.
+	     */
+
+	    memcpy(pixelPtr, dataBuffer, nBytes);
+	    dataBuffer += nBytes;
+	    for (p = pixelPtr,count=nBytes; count > 1; count-=2, p += 2) {
+		value = ((unsigned int) p[0]) * 256 + ((unsigned int) p[1]);
+		p[0] = p[1] = (unsigned char) (value / 257);
 	    }
 	} else {
 	    unsigned int value;
 
+	    memcpy(pixelPtr, dataBuffer, nBytes);
+	    dataBuffer += nBytes;
 	    for (p = pixelPtr,count=nBytes; count > 1; count-=2, p += 2) {
 		value = ((unsigned int) p[0]) * 256 + ((unsigned int) p[1]);
 		value = value * 255 / maxIntensity;
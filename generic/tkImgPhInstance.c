@@ -42,6 +42,7 @@ extern int		_XInitImageFuncPtrs(XImage *image);
 static void		BlendComplexAlpha(XImage *bgImg, PhotoInstance *iPtr,
 			    int xOffset, int yOffset, int width, int height);
 #endif
+static int		InstanceNeedsDithering(PhotoInstance *instancePtr);
 static int		IsValidPalette(PhotoInstance *instancePtr,
 			    const char *palette);
 static int		CountBits(unsigned mask);
@@ -248,6 +249,18 @@ TkImgPhotoGet(
 	{32, 32, 30,		/* 15 bits, 30720 colors */}
     };
 
+    /*
+     * A lazy image decodes its retained -file/-data source at the point
+     * where it is first displayed.  Errors are reported in the background;
+     * the image then simply stays blank.
+     */
+
+    if (modelPtr->decodePending) {
+	if (TkImgPhotoDecodeSource(modelPtr->interp, modelPtr) != TCL_OK) {
+	    Tcl_BackgroundException(modelPtr->interp, TCL_ERROR);
+	}
+    }
+
     /*
      * See if there is already an instance for windows using the same
      * colormap. If so then just re-use it.
@@ -467,6 +480,11 @@ BlendComplexAlpha(
     unsigned long red_mask, green_mask, blue_mask;
     unsigned long red_shift, green_shift, blue_shift;
     Visual *visual = iPtr->visualInfo.visual;
+    int hostOrder;
+    union {
+	unsigned int word;
+	unsigned char bytes[sizeof(unsigned int)];
+    } endian;
 
     red_mask = visual->red_mask;
     green_mask = visual->green_mask;
@@ -483,6 +501,8 @@ BlendComplexAlpha(
     while ((0x0001 & (blue_mask >> blue_shift)) == 0) {
 	blue_shift++;
     }
+    endian.word = 1;
+    hostOrder = endian.bytes[0] ? LSBFirst : MSBFirst;
 #endif /* !_WIN32 */
 
     /*
@@ -539,6 +559,44 @@ BlendComplexAlpha(
 	}
 	return;
     }
+
+    if ((bgImg->format == ZPixmap) && (bgImg->bits_per_pixel == 32)
+	    && (bgImg->byte_order == hostOrder)) {
+	/*
+	 * 32-bit ZPixmap rows in host byte order can be read and written as
+	 * whole words, avoiding the per-pixel XGetPixel/XPutPixel dispatch
+	 * through the image's function pointers. The resulting loop body is
+	 * branch-light, so compilers can vectorize it; fully opaque pixels
+	 * additionally skip reading the background word back.
+	 */
+
+	for (y = 0; y < height; y++) {
+	    unsigned int *bgRowPtr = (unsigned int *)
+		    (bgImg->data + y * bgImg->bytes_per_line);
+
+	    modelPtr = alphaAr + ((y + yOffset) * iPtr->modelPtr->width
+		    + xOffset) * 4;
+	    for (x = 0; x < width; x++, modelPtr += 4) {
+		alpha = modelPtr[3];
+		if (alpha == 255) {
+		    bgRowPtr[x] = RGB(modelPtr[0], modelPtr[1], modelPtr[2]);
+		} else if (alpha) {
+		    unsigned char ra, ga, ba;
+
+		    pixel = bgRowPtr[x];
+		    ra = GetRValue(pixel);
+		    ga = GetGValue(pixel);
+		    ba = GetBValue(pixel);
+		    unalpha = 255 - alpha;	/* Calculate once. */
+		    r = ALPHA_BLEND(ra, modelPtr[0], alpha, unalpha);
+		    g = ALPHA_BLEND(ga, modelPtr[1], alpha, unalpha);
+		    b = ALPHA_BLEND(ba, modelPtr[2], alpha, unalpha);
+		    bgRowPtr[x] = RGB(r, g, b);
+		}
+	    }
+	}
+	return;
+    }
 #endif /* !_WIN32 */
 
     for (y = 0; y < height; y++) {
@@ -692,15 +750,30 @@ TkImgPhotoDisplay(
 	 */
 
     fallBack:
-	TkSetRegion(display, instancePtr->gc,
-		instancePtr->modelPtr->validRegion);
-	XSetClipOrigin(display, instancePtr->gc, drawableX - imageX,
-		drawableY - imageY);
-	XCopyArea(display, instancePtr->pixels, drawable, instancePtr->gc,
-		imageX, imageY, (unsigned) width, (unsigned) height,
-		drawableX, drawableY);
-	XSetClipMask(display, instancePtr->gc, None);
-	XSetClipOrigin(display, instancePtr->gc, 0, 0);
+	if (TkRectInRegion(instancePtr->modelPtr->validRegion, imageX, imageY,
+		(unsigned) width, (unsigned) height) == RectangleIn) {
+	    /*
+	     * The drawn area contains only valid data, so the clip region
+	     * would not mask anything out. Leaving the GC untouched saves
+	     * re-sending the clip rectangles and origin to the server on
+	     * every draw - Xlib diffs scalar GC components client-side but
+	     * always retransmits clip rectangles.
+	     */
+
+	    XCopyArea(display, instancePtr->pixels, drawable,
+		    instancePtr->gc, imageX, imageY, (unsigned) width,
+		    (unsigned) height, drawableX, drawableY);
+	} else {
+	    TkSetRegion(display, instancePtr->gc,
+		    instancePtr->modelPtr->validRegion);
+	    XSetClipOrigin(display, instancePtr->gc, drawableX - imageX,
+		    drawableY - imageY);
+	    XCopyArea(display, instancePtr->pixels, drawable,
+		    instancePtr->gc, imageX, imageY, (unsigned) width,
+		    (unsigned) height, drawableX, drawableY);
+	    XSetClipMask(display, instancePtr->gc, None);
+	    XSetClipOrigin(display, instancePtr->gc, 0, 0);
+	}
     }
     (void)XFlush(display);
 #endif
@@ -754,6 +827,48 @@ TkImgPhotoFree(
     Tcl_DoWhenIdle(TkImgDisposeInstance, instancePtr);
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * InstanceNeedsDithering --
+ *
+ *	Determine whether the given instance will ever dither, i.e. whether
+ *	it needs the Floyd-Steinberg error array at all.  Mirrors the test
+ *	made in TkImgDitherInstance: dithering is not needed for TrueColor
+ *	and DirectColor visuals with enough levels per component.
+ *
+ * Results:
+ *	1 if the instance may dither, 0 if it never will.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+InstanceNeedsDithering(
+    PhotoInstance *instancePtr)	/* Instance to check. */
+{
+    ColorTable *colorPtr = instancePtr->colorTablePtr;
+
+    if (colorPtr == NULL) {
+	return 1;
+    }
+    if ((colorPtr->visualInfo.c_class == DirectColor)
+	    || (colorPtr->visualInfo.c_class == TrueColor)) {
+	int nRed, nGreen, nBlue, result;
+
+	result = sscanf(colorPtr->id.palette, "%d/%d/%d", &nRed,
+		&nGreen, &nBlue);
+	if ((nRed >= 256)
+		&& ((result == 1) || ((nGreen >= 256) && (nBlue >= 256)))) {
+	    return 0;
+	}
+    }
+    return 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -825,7 +940,8 @@ TkImgPhotoInstanceSetSize(
     if ((instancePtr->width != modelPtr->width)
 	    || (instancePtr->height != modelPtr->height)
 	    || (instancePtr->error == NULL)) {
-	if (modelPtr->height > 0 && modelPtr->width > 0) {
+	if (modelPtr->height > 0 && modelPtr->width > 0
+		&& InstanceNeedsDithering(instancePtr)) {
 	    /*
 	     * TODO: use attemptckalloc() here once there is a strategy that
 	     * will allow us to recover from failure. Right now, there's no
@@ -867,7 +983,9 @@ TkImgPhotoInstanceSetSize(
 	     * array.
 	     */
 
-	    if (modelPtr->width == instancePtr->width) {
+	    if (newError == NULL) {
+		/* No error array needed any more; nothing to copy. */
+	    } else if (modelPtr->width == instancePtr->width) {
 		offset = validBox.y * modelPtr->width * 3;
 		memcpy(newError + offset, instancePtr->error + offset,
 			(size_t) validBox.height
@@ -1614,6 +1732,9 @@ TkImgDisposeInstance(
 	}
 	prevPtr->nextPtr = instancePtr->nextPtr;
     }
+    if (instancePtr->modelPtr->instancePtr == NULL) {
+	TkImgPhotoInstancesGone(instancePtr->modelPtr);
+    }
     Tk_FreeColormap(instancePtr->display, instancePtr->colormap);
     ckfree(instancePtr);
 }
@@ -1646,26 +1767,20 @@ TkImgDitherInstance(
     ColorTable *colorPtr = instancePtr->colorTablePtr;
     XImage *imagePtr;
     int nLines, bigEndian, i, c, x, y, xEnd, doDithering = 1;
-    int bitsPerPixel, bytesPerLine, lineLength;
+    int bitsPerPixel, bytesPerLine, lineLength, padBytes;
     unsigned char *srcLinePtr;
     schar *errLinePtr;
     unsigned firstBit, word, mask;
 
     /*
      * Turn dithering off in certain cases where it is not needed (TrueColor,
-     * DirectColor with many colors).
+     * DirectColor with many colors), or where it is impossible because the
+     * instance has no error array.
      */
 
-    if ((colorPtr->visualInfo.c_class == DirectColor)
-	    || (colorPtr->visualInfo.c_class == TrueColor)) {
-	int nRed, nGreen, nBlue, result;
-
-	result = sscanf(colorPtr->id.palette, "%d/%d/%d", &nRed,
-		&nGreen, &nBlue);
-	if ((nRed >= 256)
-		&& ((result == 1) || ((nGreen >= 256) && (nBlue >= 256)))) {
-	    doDithering = 0;
-	}
+    if (!InstanceNeedsDithering(instancePtr)
+	    || (instancePtr->error == NULL)) {
+	doDithering = 0;
     }
 
     /*
@@ -1686,7 +1801,20 @@ TkImgDitherInstance(
 	return;			/* We must be really tight on memory. */
     }
     bitsPerPixel = imagePtr->bits_per_pixel;
-    bytesPerLine = ((bitsPerPixel * width + 31) >> 3) & ~3;
+
+    /*
+     * Lay the lines out at the alignment the XImage was created with
+     * (negotiated through XCreateImage's bitmap_pad) instead of assuming the
+     * usual 32-bit padding, so a port or server preferring wider strides is
+     * honored. The pad is at least 4 bytes, matching the historic layout.
+     */
+
+    padBytes = imagePtr->bitmap_pad >> 3;
+    if (padBytes < 4) {
+	padBytes = 4;
+    }
+    bytesPerLine = (((bitsPerPixel * width + 7) >> 3) + padBytes - 1)
+	    & ~(padBytes - 1);
     imagePtr->width = width;
     imagePtr->height = nLines;
     imagePtr->bytes_per_line = bytesPerLine;
@@ -1702,7 +1830,8 @@ TkImgDitherInstance(
 
     lineLength = modelPtr->width * 3;
     srcLinePtr = modelPtr->pix32 + (yStart * modelPtr->width + xStart) * 4;
-    errLinePtr = instancePtr->error + yStart * lineLength + xStart * 3;
+    errLinePtr = (instancePtr->error != NULL)
+	    ? instancePtr->error + yStart * lineLength + xStart * 3 : NULL;
     xEnd = xStart + width;
 
     /*
@@ -1722,9 +1851,50 @@ TkImgDitherInstance(
 	    unsigned char *srcPtr = srcLinePtr;
 	    schar *errPtr = errLinePtr;
 	    unsigned char *destBytePtr = dstLinePtr;
+#ifndef _WIN32
+	    unsigned short *destShortPtr = (unsigned short *) dstLinePtr;
+#endif
 	    unsigned *destLongPtr = (unsigned *) dstLinePtr;
 
-	    if (colorPtr->flags & COLOR_WINDOW) {
+	    if ((colorPtr->flags & COLOR_WINDOW) && !doDithering
+		    && !(colorPtr->flags & MAP_COLORS)
+		    && ((bitsPerPixel == NBBY)
+#ifndef _WIN32
+		    || (bitsPerPixel == NBBY * sizeof(unsigned short))
+		    || (bitsPerPixel == NBBY * sizeof(unsigned))
+#endif
+		    )) {
+		/*
+		 * Continuous-tone color output with a direct pixel layout.
+		 * The general case below re-tests the dithering mode and the
+		 * image depth for every pixel; on deep displays those
+		 * branches dominate the cost of the translation itself, so
+		 * translate whole rows with branch-free loops instead.
+		 */
+
+		if (bitsPerPixel == NBBY) {
+		    for (x = xStart; x < xEnd; ++x, srcPtr += 4) {
+			*destBytePtr++ = colorPtr->redValues[srcPtr[0]]
+				+ colorPtr->greenValues[srcPtr[1]]
+				+ colorPtr->blueValues[srcPtr[2]];
+		    }
+#ifndef _WIN32
+		} else if (bitsPerPixel == NBBY * sizeof(unsigned short)) {
+		    for (x = xStart; x < xEnd; ++x, srcPtr += 4) {
+			*destShortPtr++ = colorPtr->redValues[srcPtr[0]]
+				+ colorPtr->greenValues[srcPtr[1]]
+				+ colorPtr->blueValues[srcPtr[2]];
+		    }
+		} else {
+		    for (x = xStart; x < xEnd; ++x, srcPtr += 4) {
+			*destLongPtr++ = colorPtr->redValues[srcPtr[0]]
+				+ colorPtr->greenValues[srcPtr[1]]
+				+ colorPtr->blueValues[srcPtr[2]];
+		    }
+#endif
+		}
+
+	    } else if (colorPtr->flags & COLOR_WINDOW) {
 		/*
 		 * Color window. We dither the three components independently,
 		 * using Floyd-Steinberg dithering, which propagates errors
@@ -1813,6 +1983,10 @@ TkImgDitherInstance(
 			 * sizes.
 			 */
 
+		    case NBBY * sizeof(unsigned short):
+			*destShortPtr++ = i;
+			break;
+
 		    case NBBY * sizeof(unsigned):
 			*destLongPtr++ = i;
 			break;
@@ -1875,6 +2049,10 @@ TkImgDitherInstance(
 			 * sizes.
 			 */
 
+		    case NBBY * sizeof(unsigned short):
+			*destShortPtr++ = i;
+			break;
+
 		    case NBBY * sizeof(unsigned):
 			*destLongPtr++ = i;
 			break;
@@ -1942,7 +2120,9 @@ TkImgDitherInstance(
 		*destLongPtr = word;
 	    }
 	    srcLinePtr += modelPtr->width * 4;
-	    errLinePtr += lineLength;
+	    if (errLinePtr != NULL) {
+		errLinePtr += lineLength;
+	    }
 	    dstLinePtr += bytesPerLine;
 	}
 
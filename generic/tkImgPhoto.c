@@ -149,15 +149,39 @@ typedef struct {
 				 * photo image formats in Version3 format.*/
     int initialized;		/* Set to 1 if we've initialized the
 				 * structure. */
+    Tcl_HashTable sharedPixelHash;
+				/* Maps "WIDTHxHEIGHT:HASH" content keys to
+				 * PhotoShared records, so that photo models
+				 * decoded from identical data can share one
+				 * pixel buffer. */
+    int sharedPixelHashInit;	/* Set to 1 once sharedPixelHash has been
+				 * initialized. */
 } ThreadSpecificData;
 static Tcl_ThreadDataKey dataKey;
 
+/*
+ * A decoded pixel buffer shared between several photo models holding
+ * identical content.  Models reference it through their sharedPtr field and
+ * copy the buffer before their first modification (copy-on-write).
+ */
+
+struct PhotoShared {
+    unsigned char *pix32;	/* The shared 32-bit pixel data. */
+    size_t pixSize;		/* Number of bytes in pix32. */
+    size_t refCount;		/* Number of photo models using the buffer. */
+    Tcl_HashEntry *hashPtr;	/* This record's entry in the thread's
+				 * sharedPixelHash. */
+};
+
 /*
  * Default configuration
  */
 
+#define DEF_PHOTO_DISCARDDELAY	"0"
 #define DEF_PHOTO_GAMMA		"1"
 #define DEF_PHOTO_HEIGHT	"0"
+#define DEF_PHOTO_LAZY		"0"
+#define DEF_PHOTO_LOADASYNC	"0"
 #define DEF_PHOTO_PALETTE	""
 #define DEF_PHOTO_WIDTH		"0"
 
@@ -166,12 +190,18 @@ static Tcl_ThreadDataKey dataKey;
  */
 
 static const Tk_ConfigSpec configSpecs[] = {
+    {TK_CONFIG_INT, "-discarddelay", NULL, NULL,
+	 DEF_PHOTO_DISCARDDELAY, offsetof(PhotoModel, discardDelay), 0, NULL},
     {TK_CONFIG_STRING, "-file", NULL, NULL,
 	 NULL, offsetof(PhotoModel, fileString), TK_CONFIG_NULL_OK, NULL},
     {TK_CONFIG_DOUBLE, "-gamma", NULL, NULL,
 	 DEF_PHOTO_GAMMA, offsetof(PhotoModel, gamma), 0, NULL},
     {TK_CONFIG_INT, "-height", NULL, NULL,
 	 DEF_PHOTO_HEIGHT, offsetof(PhotoModel, userHeight), 0, NULL},
+    {TK_CONFIG_BOOLEAN, "-lazy", NULL, NULL,
+	 DEF_PHOTO_LAZY, offsetof(PhotoModel, lazy), 0, NULL},
+    {TK_CONFIG_BOOLEAN, "-loadasync", NULL, NULL,
+	 DEF_PHOTO_LOADASYNC, offsetof(PhotoModel, loadAsync), 0, NULL},
     {TK_CONFIG_UID, "-palette", NULL, NULL,
 	 DEF_PHOTO_PALETTE, offsetof(PhotoModel, palette), 0, NULL},
     {TK_CONFIG_INT, "-width", NULL, NULL,
@@ -197,6 +227,26 @@ static int		ImgPhotoConfigureModel(Tcl_Interp *interp,
 static int		ToggleComplexAlphaIfNeeded(PhotoModel *mPtr);
 static int		ImgPhotoSetSize(PhotoModel *modelPtr, int width,
 			    int height);
+static void		ImgPhotoGetBlock(PhotoModel *modelPtr,
+			    Tk_PhotoImageBlock *blockPtr);
+static int		ImgPhotoReadFile(Tcl_Interp *interp,
+			    PhotoModel *modelPtr,
+			    Tcl_Obj **metadataOutObjPtr);
+static int		ImgPhotoReadString(Tcl_Interp *interp,
+			    PhotoModel *modelPtr,
+			    Tcl_Obj **metadataOutObjPtr);
+static int		ImgPhotoProbeFile(Tcl_Interp *interp,
+			    PhotoModel *modelPtr, int *widthPtr,
+			    int *heightPtr);
+static void		ImgPhotoDiscardPixels(PhotoModel *modelPtr);
+static void		ImgPhotoDiscardTimerProc(ClientData clientData);
+static int		ImgPhotoMergeMetadata(Tcl_Interp *interp,
+			    PhotoModel *modelPtr,
+			    Tcl_Obj **metadataOutObjPtr);
+static void		ImgPhotoLoadIdleProc(ClientData clientData);
+static void		ImgPhotoSharePixels(PhotoModel *modelPtr);
+static void		ImgPhotoUnsharePixels(PhotoModel *modelPtr);
+static void		ImgPhotoReleasePixels(PhotoModel *modelPtr);
 static char *		ImgGetPhoto(PhotoModel *modelPtr,
 			    Tk_PhotoImageBlock *blockPtr,
 			    struct SubcommandOptions *optPtr);
@@ -241,6 +291,10 @@ PhotoFormatThreadExitProc(
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
 	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
+    if (tsdPtr->sharedPixelHashInit) {
+	Tcl_DeleteHashTable(&tsdPtr->sharedPixelHash);
+	tsdPtr->sharedPixelHashInit = 0;
+    }
 #if !defined(TK_NO_DEPRECATED) && TCL_MAJOR_VERSION < 9
     while (tsdPtr->oldFormatList != NULL) {
 	freePtr = tsdPtr->oldFormatList;
@@ -484,6 +538,18 @@ ImgPhotoCmd(
 	return TCL_ERROR;
     }
 
+    /*
+     * All subcommands except cget and configure operate on the decoded
+     * pixels, so a lazy image must decode its retained source first.
+     */
+
+    if (modelPtr->decodePending && (index != PHOTO_CGET)
+	    && (index != PHOTO_CONFIGURE)) {
+	if (TkImgPhotoDecodeSource(interp, modelPtr) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+    }
+
     switch ((enum PhotoOptions) index) {
     case PHOTO_BLANK:
 	/*
@@ -653,7 +719,7 @@ ImgPhotoCmd(
 		    Tcl_GetString(options.name), NULL);
 	    return TCL_ERROR;
 	}
-	Tk_PhotoGetImage(srcHandle, &block);
+	ImgPhotoGetBlock((PhotoModel *) srcHandle, &block);
 	if ((options.fromX2 > block.width) || (options.fromY2 > block.height)
 		|| (options.fromX2 > block.width)
 		|| (options.fromY2 > block.height)) {
@@ -1109,6 +1175,18 @@ ImgPhotoCmd(
 	    return TCL_ERROR;
 	}
 
+	/*
+	 * Image files are consumed in bulk, so use a much larger channel
+	 * buffer than the default to cut down on read system calls and
+	 * copying through the channel buffers.
+	 */
+
+	if (Tcl_SetChannelOption(interp, chan, "-buffersize", "65536")
+		!= TCL_OK) {
+	    Tcl_Close(NULL, chan);
+	    return TCL_ERROR;
+	}
+
 	if (MatchFileFormat(interp, chan,
 		Tcl_GetString(options.name), options.format,
 		options.metadata, NULL, &imageFormat,
@@ -1363,6 +1441,8 @@ readCleanup:
 	     * Set new alpha value for the pixel
 	     */
 
+	    ImgPhotoUnsharePixels(modelPtr);
+	    modelPtr->pixelsModified = 1;
 	    pixelPtr = modelPtr->pix32 + (y * modelPtr->width + x) * 4;
 	    if (boolMode) {
 		pixelPtr[3] = newVal ? 0 : 255;
@@ -1954,11 +2034,9 @@ ImgPhotoConfigureModel(
     const char *oldFileString, *oldPaletteString;
     Tcl_Obj *oldData, *data = NULL, *oldFormat, *format = NULL,
 	    *metadataInObj = NULL, *metadataOutObj = NULL;
-    Tcl_Obj *tempdata, *tempformat;
     TkSizeT length;
-    int i, j, result, imageWidth, imageHeight, oldformat;
+    int i, j, imageWidth, imageHeight, oldformat;
     double oldGamma;
-    Tcl_Channel chan;
     Tk_PhotoImageFormat *imageFormat;
     Tk_PhotoImageFormatVersion3 *imageFormatVersion3;
     const char **args;
@@ -2118,7 +2196,19 @@ ImgPhotoConfigureModel(
      * is correctly allocated for this image.
      */
 
-    if (ImgPhotoSetSize(modelPtr, modelPtr->width,
+    if (modelPtr->decodePending) {
+	/*
+	 * The image is still undecoded; record any user-declared size
+	 * without allocating pixel storage for it.
+	 */
+
+	if (modelPtr->userWidth > 0) {
+	    modelPtr->width = modelPtr->userWidth;
+	}
+	if (modelPtr->userHeight > 0) {
+	    modelPtr->height = modelPtr->userHeight;
+	}
+    } else if (ImgPhotoSetSize(modelPtr, modelPtr->width,
 	    modelPtr->height) != TCL_OK) {
 	Tcl_SetObjResult(interp, Tcl_NewStringObj(
 		TK_PHOTO_ALLOC_FAILURE_MESSAGE, -1));
@@ -2134,131 +2224,430 @@ ImgPhotoConfigureModel(
     if ((modelPtr->fileString != NULL)
 	    && ((modelPtr->fileString != oldFileString)
 	    || (modelPtr->format != oldFormat))) {
+	if (modelPtr->lazy && (modelPtr->instancePtr == NULL)) {
+	    /*
+	     * Keep only the encoded file resident: determine the image
+	     * dimensions from the format header and defer the decode until
+	     * the image is first displayed or its pixels are accessed.
+	     */
 
-	/*
-	 * Prevent file system access in a safe interpreter.
-	 */
+	    if (ImgPhotoProbeFile(interp, modelPtr, &imageWidth,
+		    &imageHeight) != TCL_OK) {
+		goto errorExit;
+	    }
+	    ImgPhotoDiscardPixels(modelPtr);
+	    modelPtr->width = (modelPtr->userWidth > 0) ?
+		    modelPtr->userWidth : imageWidth;
+	    modelPtr->height = (modelPtr->userHeight > 0) ?
+		    modelPtr->userHeight : imageHeight;
+	} else if (modelPtr->loadAsync) {
+	    /*
+	     * Defer reading the file until the event loop is idle, so that
+	     * creating many images does not stall startup.  Any declared
+	     * -width/-height has already been reserved above; the image is
+	     * resized and redisplayed when the read completes.
+	     */
 
-	if (Tcl_IsSafe(interp)) {
-	    Tcl_ResetResult(interp);
-	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
-		    "can't get image from a file in a safe interpreter",
-		    -1));
-	    Tcl_SetErrorCode(interp, "TK", "SAFE", "PHOTO_FILE", NULL);
+	    if (!modelPtr->loadPending) {
+		modelPtr->loadPending = 1;
+		Tcl_DoWhenIdle(ImgPhotoLoadIdleProc, modelPtr);
+	    }
+	} else if (ImgPhotoReadFile(interp, modelPtr, &metadataOutObj)
+		!= TCL_OK) {
 	    goto errorExit;
 	}
+    }
 
-	chan = Tcl_OpenFileChannel(interp, modelPtr->fileString, "r", 0);
-	if (chan == NULL) {
+    if ((modelPtr->fileString == NULL) && (modelPtr->dataString != NULL)
+	    && ((modelPtr->dataString != oldData)
+		    || (modelPtr->format != oldFormat))) {
+	if (modelPtr->lazy && (modelPtr->instancePtr == NULL)) {
+	    /*
+	     * Keep only the encoded data resident: determine the image
+	     * dimensions from the format header and defer the decode until
+	     * the image is first displayed or its pixels are accessed.
+	     */
+
+	    if (MatchStringFormat(interp, modelPtr->dataString,
+		    modelPtr->format, modelPtr->metadata, NULL,
+		    &imageFormat, &imageFormatVersion3, &imageWidth,
+		    &imageHeight, &oldformat) != TCL_OK) {
+		goto errorExit;
+	    }
+	    ImgPhotoDiscardPixels(modelPtr);
+	    modelPtr->width = (modelPtr->userWidth > 0) ?
+		    modelPtr->userWidth : imageWidth;
+	    modelPtr->height = (modelPtr->userHeight > 0) ?
+		    modelPtr->userHeight : imageHeight;
+	} else if (ImgPhotoReadString(interp, modelPtr, &metadataOutObj)
+		!= TCL_OK) {
 	    goto errorExit;
 	}
+    }
 
-	/*
-	 * Flag that we want the metadata result dict
-	 */
+    /*
+     * Merge driver returned metadata and master metadata
+     */
 
-	metadataOutObj = Tcl_NewDictObj();
-	Tcl_IncrRefCount(metadataOutObj);
+    if (ImgPhotoMergeMetadata(interp, modelPtr, &metadataOutObj) != TCL_OK) {
+	goto errorExit;
+    }
 
-	/*
-	 * -translation binary also sets -encoding binary
-	 */
+    /*
+     * Enforce a reasonable value for gamma.
+     */
 
-	if ((Tcl_SetChannelOption(interp, chan,
-		"-translation", "binary") != TCL_OK) ||
-		(MatchFileFormat(interp, chan, modelPtr->fileString,
-			modelPtr->format, modelPtr->metadata, metadataOutObj,
-			&imageFormat, &imageFormatVersion3,
-			&imageWidth, &imageHeight, &oldformat) != TCL_OK)) {
-	    Tcl_Close(NULL, chan);
-	    goto errorExit;
-	}
-	result = ImgPhotoSetSize(modelPtr, imageWidth, imageHeight);
-	if (result != TCL_OK) {
-	    Tcl_Close(NULL, chan);
-	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
-		    TK_PHOTO_ALLOC_FAILURE_MESSAGE, -1));
-	    Tcl_SetErrorCode(interp, "TK", "MALLOC", NULL);
-	    goto errorExit;
-	}
-	tempformat = modelPtr->format;
-	if (oldformat && tempformat) {
-	    tempformat = (Tcl_Obj *) Tcl_GetString(tempformat);
-	}
-	if (imageFormat != NULL) {
-	    result = imageFormat->fileReadProc(interp, chan,
-		    modelPtr->fileString, tempformat,
-		    (Tk_PhotoHandle) modelPtr,
-		    0, 0, imageWidth, imageHeight, 0, 0);
-	} else {
-	    result = imageFormatVersion3->fileReadProc(interp, chan,
-		    modelPtr->fileString, tempformat, modelPtr->metadata,
-		    (Tk_PhotoHandle) modelPtr,
-		    0, 0, imageWidth, imageHeight, 0, 0,
-		    metadataOutObj);
-	}
+    if (modelPtr->gamma <= 0) {
+	modelPtr->gamma = 1.0;
+    }
 
-	Tcl_Close(NULL, chan);
-	if (result != TCL_OK) {
-	    goto errorExit;
-	}
+    if ((modelPtr->gamma != oldGamma)
+	    || (modelPtr->palette != oldPaletteString)) {
+	modelPtr->flags |= IMAGE_CHANGED;
+    }
+
+    /*
+     * Cycle through all of the instances of this image, regenerating the
+     * information for each instance. Then force the image to be redisplayed
+     * everywhere that it is used.
+     */
+
+    for (instancePtr = modelPtr->instancePtr; instancePtr != NULL;
+	    instancePtr = instancePtr->nextPtr) {
+	TkImgPhotoConfigureInstance(instancePtr);
+    }
+
+    /*
+     * Inform the generic image code that the image has (potentially) changed.
+     */
 
+    Tk_ImageChanged(modelPtr->tkModel, 0, 0, modelPtr->width,
+	    modelPtr->height, modelPtr->width, modelPtr->height);
+    modelPtr->flags &= ~IMAGE_CHANGED;
+
+    if (oldData != NULL) {
+	Tcl_DecrRefCount(oldData);
+    }
+    if (oldFormat != NULL) {
+	Tcl_DecrRefCount(oldFormat);
+    }
+    if (metadataOutObj != NULL) {
+	Tcl_DecrRefCount(metadataOutObj);
+    }
+
+    ToggleComplexAlphaIfNeeded(modelPtr);
+
+    return TCL_OK;
+
+  errorExit:
+    if (oldData != NULL) {
+	Tcl_DecrRefCount(oldData);
+    }
+    if (oldFormat != NULL) {
+	Tcl_DecrRefCount(oldFormat);
+    }
+    if (metadataOutObj != NULL) {
+	Tcl_DecrRefCount(metadataOutObj);
+    }
+    return TCL_ERROR;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoReadFile --
+ *
+ *	Read and decode the file named by the model's -file option into the
+ *	model's pixel storage.  This is the read formerly done inline by
+ *	ImgPhotoConfigureModel; it is also run from the idle handler when
+ *	-loadasync is in effect.
+ *
+ * Results:
+ *	A standard Tcl return value.  On success *metadataOutObjPtr is set
+ *	to a dict (with one reference owned by the caller) holding any
+ *	metadata the driver returned; on failure it is set to NULL and an
+ *	error message is left in the interp's result.
+ *
+ * Side effects:
+ *	The image is resized to the decoded size and its pixels replaced.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ImgPhotoReadFile(
+    Tcl_Interp *interp,		/* Interpreter to use for reporting errors. */
+    PhotoModel *modelPtr,	/* Photo model whose fileString is read. */
+    Tcl_Obj **metadataOutObjPtr)
+				/* Driver metadata dict is returned here. */
+{
+    Tcl_Channel chan;
+    Tk_PhotoImageFormat *imageFormat;
+    Tk_PhotoImageFormatVersion3 *imageFormatVersion3;
+    Tcl_Obj *metadataOutObj, *tempformat;
+    int imageWidth, imageHeight, oldformat, result;
+
+    *metadataOutObjPtr = NULL;
+
+    /*
+     * Prevent file system access in a safe interpreter.
+     */
+
+    if (Tcl_IsSafe(interp)) {
 	Tcl_ResetResult(interp);
-	modelPtr->flags |= IMAGE_CHANGED;
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"can't get image from a file in a safe interpreter",
+		-1));
+	Tcl_SetErrorCode(interp, "TK", "SAFE", "PHOTO_FILE", NULL);
+	return TCL_ERROR;
     }
 
-    if ((modelPtr->fileString == NULL) && (modelPtr->dataString != NULL)
-	    && ((modelPtr->dataString != oldData)
-		    || (modelPtr->format != oldFormat))) {
+    chan = Tcl_OpenFileChannel(interp, modelPtr->fileString, "r", 0);
+    if (chan == NULL) {
+	return TCL_ERROR;
+    }
 
-	/*
-	 * Flag that we want the metadata result dict
-	 */
+    /*
+     * Flag that we want the metadata result dict
+     */
 
-	metadataOutObj = Tcl_NewDictObj();
-	Tcl_IncrRefCount(metadataOutObj);
+    metadataOutObj = Tcl_NewDictObj();
+    Tcl_IncrRefCount(metadataOutObj);
 
-	if (MatchStringFormat(interp, modelPtr->dataString,
-		modelPtr->format, modelPtr->metadata, metadataOutObj,
-		&imageFormat, &imageFormatVersion3, &imageWidth,
-		&imageHeight, &oldformat) != TCL_OK) {
-	    goto errorExit;
-	}
-	if (ImgPhotoSetSize(modelPtr, imageWidth, imageHeight) != TCL_OK) {
-	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
-		    TK_PHOTO_ALLOC_FAILURE_MESSAGE, -1));
-	    Tcl_SetErrorCode(interp, "TK", "MALLOC", NULL);
-	    goto errorExit;
+    /*
+     * -translation binary also sets -encoding binary.  The larger
+     * buffer size saves read system calls on bulk image data.
+     */
+
+    if ((Tcl_SetChannelOption(interp, chan,
+	    "-translation", "binary") != TCL_OK) ||
+	    (Tcl_SetChannelOption(interp, chan,
+	    "-buffersize", "65536") != TCL_OK) ||
+	    (MatchFileFormat(interp, chan, modelPtr->fileString,
+		    modelPtr->format, modelPtr->metadata, metadataOutObj,
+		    &imageFormat, &imageFormatVersion3,
+		    &imageWidth, &imageHeight, &oldformat) != TCL_OK)) {
+	Tcl_Close(NULL, chan);
+	Tcl_DecrRefCount(metadataOutObj);
+	return TCL_ERROR;
+    }
+    if (ImgPhotoSetSize(modelPtr, imageWidth, imageHeight) != TCL_OK) {
+	Tcl_Close(NULL, chan);
+	Tcl_DecrRefCount(metadataOutObj);
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		TK_PHOTO_ALLOC_FAILURE_MESSAGE, -1));
+	Tcl_SetErrorCode(interp, "TK", "MALLOC", NULL);
+	return TCL_ERROR;
+    }
+    tempformat = modelPtr->format;
+    if (oldformat && tempformat) {
+	tempformat = (Tcl_Obj *) Tcl_GetString(tempformat);
+    }
+    if (imageFormat != NULL) {
+	result = imageFormat->fileReadProc(interp, chan,
+		modelPtr->fileString, tempformat,
+		(Tk_PhotoHandle) modelPtr,
+		0, 0, imageWidth, imageHeight, 0, 0);
+    } else {
+	result = imageFormatVersion3->fileReadProc(interp, chan,
+		modelPtr->fileString, tempformat, modelPtr->metadata,
+		(Tk_PhotoHandle) modelPtr,
+		0, 0, imageWidth, imageHeight, 0, 0,
+		metadataOutObj);
+    }
+
+    Tcl_Close(NULL, chan);
+    if (result != TCL_OK) {
+	Tcl_DecrRefCount(metadataOutObj);
+	return TCL_ERROR;
+    }
+
+    Tcl_ResetResult(interp);
+    modelPtr->flags |= IMAGE_CHANGED;
+    modelPtr->pixelsModified = 0;
+    ImgPhotoSharePixels(modelPtr);
+    *metadataOutObjPtr = metadataOutObj;
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoReadString --
+ *
+ *	Decode the string named by the model's -data option into the model's
+ *	pixel storage.  This is the counterpart of ImgPhotoReadFile for the
+ *	-data option; it is also run when a lazy image decodes its retained
+ *	source.
+ *
+ * Results:
+ *	A standard Tcl return value.  On success *metadataOutObjPtr is set
+ *	to a dict (with one reference owned by the caller) holding any
+ *	metadata the driver returned; on failure it is set to NULL and an
+ *	error message is left in the interp's result.
+ *
+ * Side effects:
+ *	The image is resized to the decoded size and its pixels replaced.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ImgPhotoReadString(
+    Tcl_Interp *interp,		/* Interpreter to use for reporting errors. */
+    PhotoModel *modelPtr,	/* Photo model whose dataString is decoded. */
+    Tcl_Obj **metadataOutObjPtr)
+				/* Driver metadata dict is returned here. */
+{
+    Tk_PhotoImageFormat *imageFormat;
+    Tk_PhotoImageFormatVersion3 *imageFormatVersion3;
+    Tcl_Obj *metadataOutObj, *tempdata, *tempformat;
+    int imageWidth, imageHeight, oldformat;
+
+    *metadataOutObjPtr = NULL;
+
+    /*
+     * Flag that we want the metadata result dict
+     */
+
+    metadataOutObj = Tcl_NewDictObj();
+    Tcl_IncrRefCount(metadataOutObj);
+
+    if (MatchStringFormat(interp, modelPtr->dataString,
+	    modelPtr->format, modelPtr->metadata, metadataOutObj,
+	    &imageFormat, &imageFormatVersion3, &imageWidth,
+	    &imageHeight, &oldformat) != TCL_OK) {
+	Tcl_DecrRefCount(metadataOutObj);
+	return TCL_ERROR;
+    }
+    if (ImgPhotoSetSize(modelPtr, imageWidth, imageHeight) != TCL_OK) {
+	Tcl_DecrRefCount(metadataOutObj);
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		TK_PHOTO_ALLOC_FAILURE_MESSAGE, -1));
+	Tcl_SetErrorCode(interp, "TK", "MALLOC", NULL);
+	return TCL_ERROR;
+    }
+    tempformat = modelPtr->format;
+    tempdata = modelPtr->dataString;
+    if (oldformat) {
+	if (tempformat) {
+	    tempformat = (Tcl_Obj *) Tcl_GetString(tempformat);
 	}
-	tempformat = modelPtr->format;
-	tempdata = modelPtr->dataString;
-	if (oldformat) {
-	    if (tempformat) {
-		tempformat = (Tcl_Obj *) Tcl_GetString(tempformat);
-	    }
-	    tempdata = (Tcl_Obj *) Tcl_GetString(tempdata);
+	tempdata = (Tcl_Obj *) Tcl_GetString(tempdata);
+    }
+    if (imageFormat != NULL) {
+	if (imageFormat->stringReadProc(interp, tempdata, tempformat,
+		(Tk_PhotoHandle) modelPtr, 0, 0, imageWidth, imageHeight,
+		0, 0) != TCL_OK) {
+	    Tcl_DecrRefCount(metadataOutObj);
+	    return TCL_ERROR;
 	}
-	if (imageFormat != NULL) {
-	    if (imageFormat->stringReadProc(interp, tempdata, tempformat,
-		    (Tk_PhotoHandle) modelPtr, 0, 0, imageWidth, imageHeight,
-		    0, 0) != TCL_OK) {
-		goto errorExit;
-	    }
-	} else {
-	    if (imageFormatVersion3->stringReadProc(interp, tempdata, tempformat,
-		    modelPtr->metadata, (Tk_PhotoHandle) modelPtr, 0, 0,
-		    imageWidth, imageHeight, 0, 0, metadataOutObj) != TCL_OK) {
-		goto errorExit;
-	    }
+    } else {
+	if (imageFormatVersion3->stringReadProc(interp, tempdata, tempformat,
+		modelPtr->metadata, (Tk_PhotoHandle) modelPtr, 0, 0,
+		imageWidth, imageHeight, 0, 0, metadataOutObj) != TCL_OK) {
+	    Tcl_DecrRefCount(metadataOutObj);
+	    return TCL_ERROR;
 	}
-
-	Tcl_ResetResult(interp);
-	modelPtr->flags |= IMAGE_CHANGED;
     }
 
+    Tcl_ResetResult(interp);
+    modelPtr->flags |= IMAGE_CHANGED;
+    modelPtr->pixelsModified = 0;
+    ImgPhotoSharePixels(modelPtr);
+    *metadataOutObjPtr = metadataOutObj;
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoProbeFile --
+ *
+ *	Determine the dimensions of the image in the file named by the
+ *	model's -file option without decoding it, by running only the format
+ *	match procedures against the file.
+ *
+ * Results:
+ *	A standard Tcl return value.  On success *widthPtr and *heightPtr
+ *	are set to the dimensions reported by the format header.
+ *
+ * Side effects:
+ *	The file is opened and read briefly.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ImgPhotoProbeFile(
+    Tcl_Interp *interp,		/* Interpreter to use for reporting errors. */
+    PhotoModel *modelPtr,	/* Photo model whose fileString is probed. */
+    int *widthPtr, int *heightPtr)
+				/* Image dimensions are returned here. */
+{
+    Tcl_Channel chan;
+    Tk_PhotoImageFormat *imageFormat;
+    Tk_PhotoImageFormatVersion3 *imageFormatVersion3;
+    int oldformat;
+
     /*
-     * Merge driver returned metadata and master metadata
+     * Prevent file system access in a safe interpreter.
      */
+
+    if (Tcl_IsSafe(interp)) {
+	Tcl_ResetResult(interp);
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"can't get image from a file in a safe interpreter",
+		-1));
+	Tcl_SetErrorCode(interp, "TK", "SAFE", "PHOTO_FILE", NULL);
+	return TCL_ERROR;
+    }
+
+    chan = Tcl_OpenFileChannel(interp, modelPtr->fileString, "r", 0);
+    if (chan == NULL) {
+	return TCL_ERROR;
+    }
+    if ((Tcl_SetChannelOption(interp, chan,
+	    "-translation", "binary") != TCL_OK) ||
+	    (MatchFileFormat(interp, chan, modelPtr->fileString,
+		    modelPtr->format, modelPtr->metadata, NULL,
+		    &imageFormat, &imageFormatVersion3,
+		    widthPtr, heightPtr, &oldformat) != TCL_OK)) {
+	Tcl_Close(NULL, chan);
+	return TCL_ERROR;
+    }
+    Tcl_Close(NULL, chan);
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoMergeMetadata --
+ *
+ *	Merge metadata returned by an image driver into the model's
+ *	metadata dict.
+ *
+ * Results:
+ *	A standard Tcl return value.  *metadataOutObjPtr may be stolen (set
+ *	to NULL) when it becomes the model's metadata dict; otherwise the
+ *	caller keeps its reference.
+ *
+ * Side effects:
+ *	The model's metadata dict may be replaced or extended.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ImgPhotoMergeMetadata(
+    Tcl_Interp *interp,		/* Interpreter to use for reporting errors. */
+    PhotoModel *modelPtr,	/* Photo model to merge the metadata into. */
+    Tcl_Obj **metadataOutObjPtr)
+				/* Driver metadata dict, or NULL. */
+{
+    Tcl_Obj *metadataOutObj = *metadataOutObjPtr;
+
     if (metadataOutObj != NULL) {
 	int dictSize;
 	if (TCL_OK != Tcl_DictObjSize(interp,metadataOutObj, &dictSize)) {
@@ -2266,17 +2655,17 @@ ImgPhotoConfigureModel(
 		    "driver metadata not a dict", -1));
 	    Tcl_SetErrorCode(interp, "TK", "IMAGE", "PHOTO",
 		    "UNRECOGNIZED_DATA", NULL);
-	    goto errorExit;
+	    return TCL_ERROR;
 	}
 	if (dictSize > 0) {
 
 	    /*
 	     * We have driver return metadata
 	     */
-	    
+
 	    if (modelPtr->metadata == NULL) {
 		modelPtr->metadata = metadataOutObj;
-		metadataOutObj = NULL;
+		*metadataOutObjPtr = NULL;
 	    } else {
 		Tcl_DictSearch search;
 		Tcl_Obj *key, *value;
@@ -2290,7 +2679,7 @@ ImgPhotoConfigureModel(
 
 		if (Tcl_DictObjFirst(interp, metadataOutObj, &search, &key,
 			&value, &done) != TCL_OK) {
-		    goto errorExit;
+		    return TCL_ERROR;
 		}
 		for (; !done ; Tcl_DictObjNext(&search, &key, &value, &done)) {
 		    Tcl_DictObjPut(interp, modelPtr->metadata, key, value);
@@ -2298,64 +2687,203 @@ ImgPhotoConfigureModel(
 	    }
 	}
     }
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkImgPhotoDecodeSource --
+ *
+ *	Decode the model's -file or -data source into its pixel storage and
+ *	propagate the result to the instances and the generic image code.
+ *	This is the common tail of the -loadasync idle read and the deferred
+ *	decode of a lazy image.
+ *
+ * Results:
+ *	A standard Tcl return value.  On failure an error message is left in
+ *	the interp's result.
+ *
+ * Side effects:
+ *	The image is resized and its pixels replaced; any pending decode is
+ *	no longer pending, even on failure.
+ *
+ *----------------------------------------------------------------------
+ */
 
-    /*
-     * Enforce a reasonable value for gamma.
-     */
-
-    if (modelPtr->gamma <= 0) {
-	modelPtr->gamma = 1.0;
+int
+TkImgPhotoDecodeSource(
+    Tcl_Interp *interp,		/* Interpreter to use for reporting errors. */
+    PhotoModel *modelPtr)	/* Photo model whose source is decoded. */
+{
+    PhotoInstance *instancePtr;
+    Tcl_Obj *metadataOutObj = NULL;
+    int result;
+
+    modelPtr->decodePending = 0;
+    if (modelPtr->fileString != NULL) {
+	result = ImgPhotoReadFile(interp, modelPtr, &metadataOutObj);
+    } else if (modelPtr->dataString != NULL) {
+	result = ImgPhotoReadString(interp, modelPtr, &metadataOutObj);
+    } else {
+	return TCL_OK;
     }
-
-    if ((modelPtr->gamma != oldGamma)
-	    || (modelPtr->palette != oldPaletteString)) {
-	modelPtr->flags |= IMAGE_CHANGED;
+    if (result == TCL_OK) {
+	result = ImgPhotoMergeMetadata(interp, modelPtr, &metadataOutObj);
+    }
+    if (metadataOutObj != NULL) {
+	Tcl_DecrRefCount(metadataOutObj);
+    }
+    if (result != TCL_OK) {
+	return TCL_ERROR;
     }
-
-    /*
-     * Cycle through all of the instances of this image, regenerating the
-     * information for each instance. Then force the image to be redisplayed
-     * everywhere that it is used.
-     */
 
     for (instancePtr = modelPtr->instancePtr; instancePtr != NULL;
 	    instancePtr = instancePtr->nextPtr) {
 	TkImgPhotoConfigureInstance(instancePtr);
     }
-
-    /*
-     * Inform the generic image code that the image has (potentially) changed.
-     */
-
     Tk_ImageChanged(modelPtr->tkModel, 0, 0, modelPtr->width,
 	    modelPtr->height, modelPtr->width, modelPtr->height);
     modelPtr->flags &= ~IMAGE_CHANGED;
+    ToggleComplexAlphaIfNeeded(modelPtr);
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoLoadIdleProc --
+ *
+ *	Idle handler that performs the deferred file read for a photo image
+ *	configured with -loadasync.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The image is read, its instances reconfigured and the generic image
+ *	code notified.  Read errors are reported through the background
+ *	exception mechanism.
+ *
+ *----------------------------------------------------------------------
+ */
 
-    if (oldData != NULL) {
-	Tcl_DecrRefCount(oldData);
-    }
-    if (oldFormat != NULL) {
-	Tcl_DecrRefCount(oldFormat);
+static void
+ImgPhotoLoadIdleProc(
+    ClientData clientData)	/* Pointer to PhotoModel structure. */
+{
+    PhotoModel *modelPtr = (PhotoModel *) clientData;
+
+    modelPtr->loadPending = 0;
+    if ((modelPtr->fileString == NULL) || (modelPtr->tkModel == NULL)) {
+	return;
     }
-    if (metadataOutObj != NULL) {
-	Tcl_DecrRefCount(metadataOutObj);
+    if (TkImgPhotoDecodeSource(modelPtr->interp, modelPtr) != TCL_OK) {
+	Tcl_BackgroundException(modelPtr->interp, TCL_ERROR);
     }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoDiscardPixels --
+ *
+ *	Drop the model's decoded pixel storage in favor of its retained
+ *	-file/-data source, leaving the image in the undecoded state it had
+ *	before its first display.  The image dimensions are kept.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Pixel storage is released and the valid region emptied; the next
+ *	access decodes the source again.
+ *
+ *----------------------------------------------------------------------
+ */
 
-    ToggleComplexAlphaIfNeeded(modelPtr);
+static void
+ImgPhotoDiscardPixels(
+    PhotoModel *modelPtr)	/* Photo model whose pixels are dropped. */
+{
+    ImgPhotoReleasePixels(modelPtr);
+    modelPtr->pix32 = NULL;
+    if (modelPtr->validRegion != NULL) {
+	TkDestroyRegion(modelPtr->validRegion);
+    }
+    modelPtr->validRegion = TkCreateRegion();
+    modelPtr->ditherX = modelPtr->ditherY = 0;
+    modelPtr->decodePending = 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoDiscardTimerProc --
+ *
+ *	Timer handler that discards the decoded pixels of a lazy image which
+ *	has stayed undisplayed for its -discarddelay period.  The conditions
+ *	are re-checked here because the image may have been displayed or
+ *	modified since the timer was scheduled.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Pixel storage may be released.
+ *
+ *----------------------------------------------------------------------
+ */
 
-    return TCL_OK;
+static void
+ImgPhotoDiscardTimerProc(
+    ClientData clientData)	/* Pointer to PhotoModel structure. */
+{
+    PhotoModel *modelPtr = (PhotoModel *) clientData;
 
-  errorExit:
-    if (oldData != NULL) {
-	Tcl_DecrRefCount(oldData);
-    }
-    if (oldFormat != NULL) {
-	Tcl_DecrRefCount(oldFormat);
+    modelPtr->discardTimer = NULL;
+    if ((modelPtr->tkModel == NULL) || (modelPtr->instancePtr != NULL)
+	    || modelPtr->pixelsModified || modelPtr->decodePending
+	    || ((modelPtr->fileString == NULL)
+	    && (modelPtr->dataString == NULL))) {
+	return;
     }
-    if (metadataOutObj != NULL) {
-	Tcl_DecrRefCount(metadataOutObj);
+    ImgPhotoDiscardPixels(modelPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkImgPhotoInstancesGone --
+ *
+ *	Called when the last instance of a photo image is disposed of.  For
+ *	a lazy image with a -discarddelay, schedules the discard of the
+ *	decoded pixels; they can be recreated from the retained source if
+ *	the image is displayed again.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	A timer handler may be created.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkImgPhotoInstancesGone(
+    PhotoModel *modelPtr)	/* Photo model that lost its last instance. */
+{
+    if (!modelPtr->lazy || (modelPtr->discardDelay <= 0)
+	    || (modelPtr->discardTimer != NULL)
+	    || modelPtr->pixelsModified || modelPtr->decodePending
+	    || (modelPtr->tkModel == NULL)
+	    || ((modelPtr->fileString == NULL)
+	    && (modelPtr->dataString == NULL))) {
+	return;
     }
-    return TCL_ERROR;
+    modelPtr->discardTimer = Tcl_CreateTimerHandler(modelPtr->discardDelay,
+	    ImgPhotoDiscardTimerProc, modelPtr);
 }
 
 /*
@@ -2429,6 +2957,14 @@ ImgPhotoDelete(
     PhotoModel *modelPtr = (PhotoModel *)modelData;
     PhotoInstance *instancePtr;
 
+    if (modelPtr->loadPending) {
+	Tcl_CancelIdleCall(ImgPhotoLoadIdleProc, modelPtr);
+	modelPtr->loadPending = 0;
+    }
+    if (modelPtr->discardTimer != NULL) {
+	Tcl_DeleteTimerHandler(modelPtr->discardTimer);
+	modelPtr->discardTimer = NULL;
+    }
     while ((instancePtr = modelPtr->instancePtr) != NULL) {
 	if (instancePtr->refCount > 0) {
 	    Tcl_Panic("tried to delete photo image when instances still exist");
@@ -2440,9 +2976,7 @@ ImgPhotoDelete(
     if (modelPtr->imageCmd != NULL) {
 	Tcl_DeleteCommandFromToken(modelPtr->interp, modelPtr->imageCmd);
     }
-    if (modelPtr->pix32 != NULL) {
-	ckfree(modelPtr->pix32);
-    }
+    ImgPhotoReleasePixels(modelPtr);
     if (modelPtr->validRegion != NULL) {
 	TkDestroyRegion(modelPtr->validRegion);
     }
@@ -2489,6 +3023,203 @@ ImgPhotoCmdDeletedProc(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoGetBlock --
+ *
+ *	Fill in a Tk_PhotoImageBlock describing the model's pixel data, for
+ *	Tk's own read-only uses.  Unlike Tk_PhotoGetImage this does not give
+ *	the model exclusive ownership of the buffer first, so it must not be
+ *	used where the pixels may be modified through the block.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ImgPhotoGetBlock(
+    PhotoModel *modelPtr,	/* Photo model whose data is wanted. */
+    Tk_PhotoImageBlock *blockPtr)
+				/* Details of the pixel data are returned
+				 * here. */
+{
+    blockPtr->pixelPtr = modelPtr->pix32;
+    blockPtr->width = modelPtr->width;
+    blockPtr->height = modelPtr->height;
+    blockPtr->pitch = modelPtr->width * 4;
+    blockPtr->pixelSize = 4;
+    blockPtr->offset[0] = 0;
+    blockPtr->offset[1] = 1;
+    blockPtr->offset[2] = 2;
+    blockPtr->offset[3] = 3;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoSharePixels --
+ *
+ *	Try to share this model's decoded pixel buffer with other models
+ *	holding identical content, so that many images created from the same
+ *	file or data hold one pixel buffer between them.  Called after a
+ *	successful decode.  The buffer is looked up by a content hash in the
+ *	thread's sharedPixelHash and compared byte for byte before sharing.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The model's pix32 may be replaced by a shared buffer, or registered
+ *	as a new shared buffer for later models to join.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ImgPhotoSharePixels(
+    PhotoModel *modelPtr)	/* Photo model that has just been decoded. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    PhotoShared *sharedPtr;
+    Tcl_HashEntry *hPtr;
+    size_t pixSize = (size_t) modelPtr->width * modelPtr->height * 4;
+    Tcl_WideUInt hash;
+    const unsigned char *p;
+    char key[64];
+    int isNew;
+
+    if ((modelPtr->pix32 == NULL) || (pixSize == 0)
+	    || (modelPtr->sharedPtr != NULL)) {
+	return;
+    }
+    if (!tsdPtr->sharedPixelHashInit) {
+	Tcl_InitHashTable(&tsdPtr->sharedPixelHash, TCL_STRING_KEYS);
+	tsdPtr->sharedPixelHashInit = 1;
+    }
+
+    /*
+     * FNV-1a over the decoded pixels.
+     */
+
+    hash = (Tcl_WideUInt) 0xcbf29ce484222325ULL;
+    for (p = modelPtr->pix32; p < modelPtr->pix32 + pixSize; p++) {
+	hash = (hash ^ *p) * (Tcl_WideUInt) 0x100000001b3ULL;
+    }
+    sprintf(key, "%dx%d:%08x%08x", modelPtr->width, modelPtr->height,
+	    (unsigned) (hash >> 32), (unsigned) hash);
+
+    hPtr = Tcl_CreateHashEntry(&tsdPtr->sharedPixelHash, key, &isNew);
+    if (!isNew) {
+	sharedPtr = (PhotoShared *) Tcl_GetHashValue(hPtr);
+	if ((sharedPtr->pixSize == pixSize)
+		&& (memcmp(sharedPtr->pix32, modelPtr->pix32, pixSize) == 0)) {
+	    ckfree(modelPtr->pix32);
+	    modelPtr->pix32 = sharedPtr->pix32;
+	    modelPtr->sharedPtr = sharedPtr;
+	    sharedPtr->refCount++;
+	}
+	return;
+    }
+    sharedPtr = (PhotoShared *) ckalloc(sizeof(PhotoShared));
+    sharedPtr->pix32 = modelPtr->pix32;
+    sharedPtr->pixSize = pixSize;
+    sharedPtr->refCount = 1;
+    sharedPtr->hashPtr = hPtr;
+    Tcl_SetHashValue(hPtr, sharedPtr);
+    modelPtr->sharedPtr = sharedPtr;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoUnsharePixels --
+ *
+ *	Give the model exclusive ownership of its pixel buffer again, copying
+ *	it if other models still use it.  Must be called before any code
+ *	modifies pix32 or lets a pointer to it escape.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	pix32 may be replaced by a private copy; the shared record may be
+ *	removed from the thread's sharedPixelHash.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ImgPhotoUnsharePixels(
+    PhotoModel *modelPtr)	/* Photo model about to be modified. */
+{
+    PhotoShared *sharedPtr = modelPtr->sharedPtr;
+    unsigned char *copy;
+
+    if (sharedPtr == NULL) {
+	return;
+    }
+    if (sharedPtr->refCount == 1) {
+	/*
+	 * Sole user: take back exclusive ownership.  The hash entry has to
+	 * go, since the content is about to change.
+	 */
+
+	Tcl_DeleteHashEntry(sharedPtr->hashPtr);
+	ckfree(sharedPtr);
+	modelPtr->sharedPtr = NULL;
+	return;
+    }
+    copy = (unsigned char *) ckalloc(sharedPtr->pixSize);
+    memcpy(copy, sharedPtr->pix32, sharedPtr->pixSize);
+    sharedPtr->refCount--;
+    modelPtr->pix32 = copy;
+    modelPtr->sharedPtr = NULL;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ImgPhotoReleasePixels --
+ *
+ *	Drop the model's reference to its pixel buffer, in place of a plain
+ *	ckfree of pix32.  Frees the buffer only when no other model shares
+ *	it.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Storage may be freed; pix32 is left dangling and must be reassigned
+ *	or never used again by the caller.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ImgPhotoReleasePixels(
+    PhotoModel *modelPtr)	/* Photo model giving up its pixel buffer. */
+{
+    PhotoShared *sharedPtr = modelPtr->sharedPtr;
+
+    if (sharedPtr != NULL) {
+	modelPtr->sharedPtr = NULL;
+	if (--sharedPtr->refCount == 0) {
+	    Tcl_DeleteHashEntry(sharedPtr->hashPtr);
+	    ckfree(sharedPtr->pix32);
+	    ckfree(sharedPtr);
+	}
+    } else if (modelPtr->pix32 != NULL) {
+	ckfree(modelPtr->pix32);
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -2638,7 +3369,7 @@ ImgPhotoSetSize(
 		}
 	    }
 
-	    ckfree(modelPtr->pix32);
+	    ImgPhotoReleasePixels(modelPtr);
 	}
 
 	modelPtr->pix32 = newPix32;
@@ -2679,6 +3410,129 @@ ImgPhotoSetSize(
     return TCL_OK;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkImgGetDataBytes --
+ *
+ *	Return a pointer to the bytes of an image -data value, avoiding the
+ *	creation of a byte-array representation when the data is textual.
+ *	Base64-encoded image data (and ASCII formats such as GIF87a headers)
+ *	consists purely of 7-bit characters, for which the bytes of the
+ *	existing string representation are identical to what a byte-array
+ *	conversion would produce; reading them in place spares a full copy
+ *	of the data, which matters for large embedded images.
+ *
+ * Results:
+ *	Returns a pointer to the data bytes and stores the number of bytes
+ *	in *lengthPtr. The pointer remains valid as long as the object
+ *	exists with an unmodified value.
+ *
+ * Side effects:
+ *	May create a byte-array representation for the object when the data
+ *	is binary.
+ *
+ *----------------------------------------------------------------------
+ */
+
+unsigned char *
+TkImgGetDataBytes(
+    Tcl_Obj *objPtr,		/* The value of the -data option. */
+    TkSizeT *lengthPtr)		/* Filled with the number of bytes. */
+{
+    if (objPtr->bytes != NULL) {
+	TkSizeT i, numBytes = objPtr->length;
+	const char *str = objPtr->bytes;
+
+	for (i = 0; i < numBytes; i++) {
+	    if (str[i] & 0x80) {
+		break;
+	    }
+	}
+	if (i == numBytes) {
+	    *lengthPtr = numBytes;
+	    return (unsigned char *) str;
+	}
+    }
+
+    /*
+     * Binary data, or no string representation to inspect: hand out the
+     * byte-array representation as before.
+     */
+
+    return Tcl_GetByteArrayFromObj(objPtr, lengthPtr);
+}
+
+/*
+ * The table below maps the leading bytes of image file data to the built-in
+ * format handlers able to parse them. MatchFileFormat consults it before
+ * invoking a handler's fileMatchProc, so that handlers whose magic number
+ * cannot match are skipped without each of them re-reading and re-parsing
+ * the file header. Handlers without an entry here (for instance loadable
+ * extensions, or the svg format whose data may start with arbitrary
+ * whitespace) are always probed.
+ */
+
+typedef struct FormatMagic {
+    const char *name;		/* Name of the format handler. */
+    const char *magic;		/* Leading bytes identifying the format. */
+    size_t length;		/* Number of leading bytes to compare. */
+} FormatMagic;
+
+static const FormatMagic formatMagicTable[] = {
+    { "gif", "GIF8", 4 },	/* GIF87a and GIF89a. */
+    { "png", "\211PNG", 4 },
+    { "ppm", "P", 1 }		/* P6 (ppm) or P5 (pgm). */
+};
+
+#define PHOTO_FORMAT_MAGIC_SIZE	4
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * MagicCouldMatch --
+ *
+ *	Check the leading bytes of image file data against the magic number
+ *	registered for a format handler, if there is one.
+ *
+ * Results:
+ *	Returns 0 if the handler has a registered magic number which the
+ *	given header cannot match, 1 otherwise (in particular for handlers
+ *	without a table entry, which must always be probed).
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+MagicCouldMatch(
+    const char *formatName,	/* Name of the format handler. */
+    const char *header,		/* Leading bytes read from the file. */
+    int headerLength)		/* Number of valid bytes in header. */
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(formatMagicTable)/sizeof(formatMagicTable[0]);
+	    i++) {
+	const FormatMagic *magicPtr = &formatMagicTable[i];
+
+	if (strcasecmp(formatName, magicPtr->name) != 0) {
+	    continue;
+	}
+	if ((size_t) headerLength < magicPtr->length) {
+	    /*
+	     * The file is shorter than the magic number, so it cannot match.
+	     */
+
+	    return 0;
+	}
+	return memcmp(header, magicPtr->magic, magicPtr->length) == 0;
+    }
+    return 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -2729,11 +3583,24 @@ MatchFileFormat(
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
 	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
     const char *formatString = NULL;
+    char header[PHOTO_FORMAT_MAGIC_SIZE];
+    int headerLength = -1;
 
     if (formatObj) {
 	formatString = Tcl_GetString(formatObj);
     }
 
+    /*
+     * When no format was specified, read the leading bytes of the file once
+     * so that handlers with a registered magic number which cannot match can
+     * be skipped without being invoked at all.
+     */
+
+    if (formatObj == NULL) {
+	(void) Tcl_Seek(chan, Tcl_LongAsWide(0L), SEEK_SET);
+	headerLength = Tcl_Read(chan, header, PHOTO_FORMAT_MAGIC_SIZE);
+    }
+
     /*
      * Scan through the table of file format handlers to find one which can
      * handle the image.
@@ -2757,6 +3624,11 @@ MatchFileFormat(
 	    }
 	}
 	if (formatPtr->fileMatchProc != NULL) {
+	    if ((headerLength >= 0)
+		    && !MagicCouldMatch(formatPtr->name, header,
+			    headerLength)) {
+		continue;
+	    }
 	    (void) Tcl_Seek(chan, Tcl_LongAsWide(0L), SEEK_SET);
 
 	    if (formatPtr->fileMatchProc(chan, fileName, formatObj,
@@ -2792,6 +3664,11 @@ if (formatPtr == NULL) {
 		}
 	    }
 	    if (formatPtr->fileMatchProc != NULL) {
+		if ((headerLength >= 0)
+			&& !MagicCouldMatch(formatPtr->name, header,
+				headerLength)) {
+		    continue;
+		}
 		(void) Tcl_Seek(chan, Tcl_LongAsWide(0L), SEEK_SET);
 		if (formatPtr->fileMatchProc(chan, fileName, (Tcl_Obj *)
 			formatString, widthPtr, heightPtr, interp)) {
@@ -2845,6 +3722,11 @@ if (formatPtr == NULL) {
 	    }
 	}
 	if (formatVersion3Ptr->fileMatchProc != NULL) {
+	    if ((headerLength >= 0)
+		    && !MagicCouldMatch(formatVersion3Ptr->name, header,
+			    headerLength)) {
+		continue;
+	    }
 	    (void) Tcl_Seek(chan, Tcl_LongAsWide(0L), SEEK_SET);
 
 	    if (formatVersion3Ptr->fileMatchProc(interp, chan, fileName,
@@ -3213,6 +4095,8 @@ Tk_PhotoPutBlock(
     int wLeft, hLeft, wCopy, hCopy, pitch;
     unsigned char *srcPtr, *srcLinePtr, *destPtr, *destLinePtr;
     int sourceIsSimplePhoto = compRule & SOURCE_IS_SIMPLE_ALPHA_PHOTO;
+    unsigned char alphaAnd;
+    size_t count;
     XRectangle rect;
 
     /*
@@ -3236,6 +4120,13 @@ Tk_PhotoPutBlock(
 	return TCL_OK;
     }
 
+    /*
+     * The decoded pixels are about to diverge from any retained -file or
+     * -data source, so they may no longer be discarded and re-decoded.
+     */
+
+    modelPtr->pixelsModified = 1;
+
     /*
      * Fix for bug e4336bef5d:
      *
@@ -3249,6 +4140,7 @@ Tk_PhotoPutBlock(
      * different values and still point to the same block of memory. (e.g.
      * if the -from option was passed to [imageName copy])
      */
+    ImgPhotoUnsharePixels(modelPtr);
     sourceBlock = *blockPtr;
     memToFree = NULL;
     if (sourceBlock.pixelPtr >= modelPtr->pix32
@@ -3347,6 +4239,41 @@ Tk_PhotoPutBlock(
 	memmove(destLinePtr, sourceBlock.pixelPtr + sourceBlock.offset[0],
 		((size_t)height * width * 4));
 
+	/*
+	 * Whole-block replacement is how full-frame producers (video and
+	 * camera feeds) hand over every frame, so check whether the new data
+	 * is completely opaque before falling into the span-based
+	 * recomputation of the validity region below, which walks the alpha
+	 * channel row by row and is far more expensive than this scan.
+	 */
+
+	alphaAnd = 255;
+	destPtr = destLinePtr + 3;
+	for (count = (size_t) height * width; count > 0; --count, destPtr += 4) {
+	    alphaAnd &= *destPtr;
+	}
+	if (alphaAnd == 255) {
+	    /*
+	     * Every pixel in the block is opaque, so the whole rectangle is
+	     * valid. A block which replaces the image completely also
+	     * determines the complex alpha flag on its own; a smaller block
+	     * cannot introduce partial transparency, though it may leave the
+	     * flag conservatively set.
+	     */
+
+	    rect.x = x;
+	    rect.y = y;
+	    rect.width = width;
+	    rect.height = height;
+	    TkUnionRectWithRegion(&rect, modelPtr->validRegion,
+		    modelPtr->validRegion);
+	    if ((x == 0) && (y == 0) && (width == modelPtr->width)
+		    && (height == modelPtr->height)) {
+		modelPtr->flags &= ~COMPLEX_ALPHA;
+	    }
+	    goto updateInstances;
+	}
+
 	/*
 	 * We know there's an alpha offset and we're setting the data, so skip
 	 * directly to the point when we recompute the photo validity region.
@@ -3458,21 +4385,24 @@ Tk_PhotoPutBlock(
 
 		    if (alpha) {
 			int Alpha = destPtr[3];
+			int beta = Alpha*(255-alpha)/255;
 
 			/*
 			 * OK, there's real work to be done. Luckily, there's
 			 * a substantial literature on what to do in this
 			 * case. In particular, Porter and Duff have done a
 			 * taxonomy of compositing rules, and the right one is
-			 * the "Source Over" rule. This code implements that.
+			 * the "Source Over" rule. This code implements that,
+			 * with the destination attenuation factor computed
+			 * once per pixel instead of once per channel.
 			 */
 
-			destPtr[0] = PD_SRC_OVER(srcPtr[0], alpha, destPtr[0],
-				Alpha);
-			destPtr[1] = PD_SRC_OVER(srcPtr[greenOffset], alpha,
-				destPtr[1], Alpha);
-			destPtr[2] = PD_SRC_OVER(srcPtr[blueOffset], alpha,
-				destPtr[2], Alpha);
+			destPtr[0] = PD_SRC_OVER_HOISTED(srcPtr[0], alpha,
+				destPtr[0], beta);
+			destPtr[1] = PD_SRC_OVER_HOISTED(srcPtr[greenOffset],
+				alpha, destPtr[1], beta);
+			destPtr[2] = PD_SRC_OVER_HOISTED(srcPtr[blueOffset],
+				alpha, destPtr[2], beta);
 			destPtr[3] = PD_SRC_OVER_ALPHA(alpha, Alpha);
 		    }
 
@@ -3587,6 +4517,7 @@ Tk_PhotoPutBlock(
      * Update each instance.
      */
 
+  updateInstances:
     Tk_DitherPhoto((Tk_PhotoHandle)modelPtr, x, y, width, height);
 
     /*
@@ -3683,6 +4614,8 @@ Tk_PhotoPutZoomedBlock(
 	return TCL_OK;
     }
 
+    modelPtr->pixelsModified = 1;
+
     /*
      * Fix for Bug e4336bef5d:
      * Make a local copy of *blockPtr, as we might have to change some
@@ -3695,6 +4628,7 @@ Tk_PhotoPutZoomedBlock(
      * different values and still point to the same block of memory. (e.g.
      * if the -from option was passed to [imageName copy])
      */
+    ImgPhotoUnsharePixels(modelPtr);
     sourceBlock = *blockPtr;
     memToFree = NULL;
     if (sourceBlock.pixelPtr >= modelPtr->pix32
@@ -3811,6 +4745,24 @@ Tk_PhotoPutZoomedBlock(
 	yRepeat = zoomY;
 	srcLinePtr = srcOrigPtr;
 	for (; hCopy > 0; --hCopy) {
+	    /*
+	     * When zooming vertically, every repeated row is identical to the
+	     * one just written above it, provided the result does not depend
+	     * on the previous destination contents.  Copy it instead of
+	     * re-running the sampling loop.
+	     */
+
+	    if ((yRepeat < zoomY)
+		    && (!alphaOffset || (compRule == TK_PHOTO_COMPOSITE_SET))) {
+		memcpy(destLinePtr, destLinePtr - pitch, (size_t) width * 4);
+		destLinePtr += pitch;
+		yRepeat--;
+		if (yRepeat <= 0) {
+		    srcLinePtr += blockYSkip;
+		    yRepeat = zoomY;
+		}
+		continue;
+	    }
 	    destPtr = destLinePtr;
 	    for (wLeft = width; wLeft > 0;) {
 		wCopy = MIN(wLeft, blockWid);
@@ -3847,13 +4799,14 @@ Tk_PhotoPutZoomedBlock(
 			} else if (alpha) {
 			    int Alpha = destPtr[3];	/* Destination
 							 * alpha. */
-
-			    destPtr[0] = PD_SRC_OVER(srcPtr[0], alpha,
-				    destPtr[0], Alpha);
-			    destPtr[1] = PD_SRC_OVER(srcPtr[greenOffset],alpha,
-				    destPtr[1], Alpha);
-			    destPtr[2] = PD_SRC_OVER(srcPtr[blueOffset], alpha,
-				    destPtr[2], Alpha);
+			    int beta = Alpha*(255-alpha)/255;
+
+			    destPtr[0] = PD_SRC_OVER_HOISTED(srcPtr[0], alpha,
+				    destPtr[0], beta);
+			    destPtr[1] = PD_SRC_OVER_HOISTED(srcPtr[greenOffset],
+				    alpha, destPtr[1], beta);
+			    destPtr[2] = PD_SRC_OVER_HOISTED(srcPtr[blueOffset],
+				    alpha, destPtr[2], beta);
 			    destPtr[3] = PD_SRC_OVER_ALPHA(alpha, Alpha);
 
 			    destPtr += 4;
@@ -4067,6 +5020,7 @@ Tk_PhotoBlank(
 
     modelPtr->ditherX = modelPtr->ditherY = 0;
     modelPtr->flags = 0;
+    modelPtr->pixelsModified = 1;
 
     /*
      * The image has valid data nowhere.
@@ -4082,8 +5036,11 @@ Tk_PhotoBlank(
      * arrays for each instance.
      */
 
-    memset(modelPtr->pix32, 0,
-	    ((size_t)modelPtr->width * modelPtr->height * 4));
+    ImgPhotoUnsharePixels(modelPtr);
+    if (modelPtr->pix32 != NULL) {
+	memset(modelPtr->pix32, 0,
+		((size_t)modelPtr->width * modelPtr->height * 4));
+    }
     for (instancePtr = modelPtr->instancePtr; instancePtr != NULL;
 	    instancePtr = instancePtr->nextPtr) {
 	TkImgResetDither(instancePtr);
@@ -4208,6 +5165,7 @@ Tk_PhotoSetSize(
 
     modelPtr->userWidth = width;
     modelPtr->userHeight = height;
+    modelPtr->pixelsModified = 1;
     if (ImgPhotoSetSize(modelPtr, ((width > 0) ? width: modelPtr->width),
 	    ((height > 0) ? height: modelPtr->height)) == TCL_ERROR) {
 	if (interp != NULL) {
@@ -4285,7 +5243,7 @@ ImgGetPhoto(
     unsigned char *pixelPtr;
     int x, y, greenOffset, blueOffset, alphaOffset;
 
-    Tk_PhotoGetImage((Tk_PhotoHandle) modelPtr, blockPtr);
+    ImgPhotoGetBlock(modelPtr, blockPtr);
     blockPtr->pixelPtr += optPtr->fromY * blockPtr->pitch
 	    + optPtr->fromX * blockPtr->pixelSize;
     blockPtr->width = optPtr->fromX2 - optPtr->fromX;
@@ -4474,15 +5432,21 @@ Tk_PhotoGetImage(
 {
     PhotoModel *modelPtr = (PhotoModel *) handle;
 
-    blockPtr->pixelPtr = modelPtr->pix32;
-    blockPtr->width = modelPtr->width;
-    blockPtr->height = modelPtr->height;
-    blockPtr->pitch = modelPtr->width * 4;
-    blockPtr->pixelSize = 4;
-    blockPtr->offset[0] = 0;
-    blockPtr->offset[1] = 1;
-    blockPtr->offset[2] = 2;
-    blockPtr->offset[3] = 3;
+    if (modelPtr->decodePending) {
+	if (TkImgPhotoDecodeSource(modelPtr->interp, modelPtr) != TCL_OK) {
+	    Tcl_BackgroundException(modelPtr->interp, TCL_ERROR);
+	}
+    }
+
+    /*
+     * The pointer handed out below escapes our control, so make sure the
+     * buffer is not shared with another model.  The caller may also write
+     * through it, so assume the pixels diverge from any retained source.
+     */
+
+    ImgPhotoUnsharePixels(modelPtr);
+    modelPtr->pixelsModified = 1;
+    ImgPhotoGetBlock(modelPtr, blockPtr);
     return 1;
 }
 
@@ -4515,7 +5479,7 @@ ImgPhotoPostscript(
 {
     Tk_PhotoImageBlock block;
 
-    Tk_PhotoGetImage(clientData, &block);
+    ImgPhotoGetBlock((PhotoModel *) clientData, &block);
     block.pixelPtr += y * block.pitch + x * block.pixelSize;
 
     return Tk_PostscriptPhoto(interp, &block, psInfo, width, height);
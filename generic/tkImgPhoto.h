@@ -32,6 +32,7 @@ typedef struct ColorTableId	ColorTableId;
 typedef struct ColorTable	ColorTable;
 typedef struct PhotoInstance	PhotoInstance;
 typedef struct PhotoModel	PhotoModel;
+typedef struct PhotoShared	PhotoShared;
 
 /*
  * A signed 8-bit integral type. If chars are unsigned and the compiler isn't
@@ -156,12 +157,37 @@ struct PhotoModel {
 				 * instances of this image. */
     double gamma;		/* Display gamma value to correct for. */
     char *fileString;		/* Name of file to read into image. */
+    int loadAsync;		/* Non-zero means defer reading the file named
+				 * by fileString until the event loop is
+				 * idle. */
+    int loadPending;		/* Non-zero means a deferred file read is
+				 * currently scheduled as an idle handler. */
+    int lazy;			/* Non-zero means keep only the encoded
+				 * -file/-data source resident and defer
+				 * decoding it until the image is first
+				 * displayed or its pixels are first
+				 * accessed. */
+    int decodePending;		/* Non-zero means the -file/-data source has
+				 * not been decoded yet; pix32 may be NULL
+				 * even though width and height are set. */
+    int discardDelay;		/* Number of milliseconds an undisplayed lazy
+				 * image keeps its decoded pixels before they
+				 * are dropped in favor of the retained
+				 * source. 0 means never drop them. */
+    Tcl_TimerToken discardTimer;/* Scheduled discard of the decoded pixels,
+				 * or NULL. */
+    int pixelsModified;		/* Non-zero means the decoded pixels no
+				 * longer match the -file/-data source, so
+				 * they must not be discarded. */
     Tcl_Obj *dataString;	/* Object to use as contents of image. */
     Tcl_Obj *format;		/* User-specified format of data in image file
 				 * or string value. */
     Tcl_Obj *metadata;		/* User-specified metadata dict or read from
 				 * image file */
     unsigned char *pix32;	/* Local storage for 32-bit image. */
+    PhotoShared *sharedPtr;	/* Shared pixel store that pix32 currently
+				 * points into, or NULL if this model owns
+				 * pix32 exclusively. */
     int ditherX, ditherY;	/* Location of first incorrectly dithered
 				 * pixel in image. */
     TkRegion validRegion;	/* Tk region indicating which parts of the
@@ -235,6 +261,17 @@ struct PhotoInstance {
 #define PD_SRC_OVER_ALPHA(srcAlpha, dstAlpha) \
 	(srcAlpha + (255-srcAlpha)*dstAlpha/255)
 
+/*
+ * Source-Over with the destination attenuation factor hoisted out of the
+ * per-channel arithmetic. dstBeta must be dstAlpha*(255-srcAlpha)/255, which
+ * is common to the three colour channels of a pixel; computing it once per
+ * pixel and passing it in yields results bit-identical to PD_SRC_OVER with a
+ * third of the multiplications and divisions.
+ */
+
+#define PD_SRC_OVER_HOISTED(srcColor, srcAlpha, dstColor, dstBeta) \
+	((srcColor)*(srcAlpha)/255 + (dstBeta)*(dstColor)/255)
+
 #undef MIN
 #define MIN(a, b)	((a) < (b)? (a): (b))
 #undef MAX
@@ -259,6 +296,9 @@ MODULE_SCOPE void	TkImgPhotoDisplay(ClientData clientData,
 MODULE_SCOPE void	TkImgPhotoFree(ClientData clientData,
 			    Display *display);
 MODULE_SCOPE void	TkImgResetDither(PhotoInstance *instancePtr);
+MODULE_SCOPE int	TkImgPhotoDecodeSource(Tcl_Interp *interp,
+			    PhotoModel *modelPtr);
+MODULE_SCOPE void	TkImgPhotoInstancesGone(PhotoModel *modelPtr);
 
 /*
  * Local Variables:
@@ -41,6 +41,28 @@ typedef struct {
  * eliminate double parsing of the SVG file/string.
  */
 
+/*
+ * One cached rasterized rendering of an SVG source. Re-rendering an icon at
+ * an already seen size then only costs the block transfer into the photo
+ * image instead of a full parse and rasterize run. The source text and the
+ * format string together determine the rendered width, height and scale.
+ */
+
+typedef struct {
+    char *source;		/* SVG source text the pixels were produced
+				 * from, or NULL for an empty slot. */
+    TkSizeT sourceLength;	/* Number of bytes of source. */
+    char *format;		/* String form of the format list the image
+				 * was rendered with (empty if none). */
+    int width, height;		/* Pixel dimensions of the rendering. */
+    unsigned char *pixels;	/* RGBA pixel data, width*height*4 bytes. */
+    unsigned long lastUsed;	/* Ticket of the most recent use, for LRU
+				 * eviction. */
+} NSVGrasterEntry;
+
+#define NSVG_RASTER_CACHE_SLOTS	8
+#define NSVG_RASTER_MAX_BYTES	(4 * 1024 * 1024)
+
 typedef struct {
     /* A poiner to remember if it is the same svn image (data)
      * It is a Tcl_Channel if image created by -file option
@@ -50,6 +72,12 @@ typedef struct {
     Tcl_DString formatString;
     NSVGimage *nsvgImage;
     RastOpts ropts;
+    NSVGrasterEntry raster[NSVG_RASTER_CACHE_SLOTS];
+				/* Cache of recent rasterized renderings.
+				 * Unlike the parse cache above, these
+				 * survive the match/read cycle. */
+    unsigned long rasterTicket;	/* Running counter backing the lastUsed
+				 * tickets. */
 } NSVGcache;
 
 static const void *	MemMem(const void *haystack, size_t haysize,
@@ -73,7 +101,19 @@ static NSVGimage *	ParseSVGWithOptions(Tcl_Interp *interp,
 static int		RasterizeSVG(Tcl_Interp *interp,
 			    Tk_PhotoHandle imageHandle, NSVGimage *nsvgImage,
 			    int destX, int destY, int width, int height,
-			    int srcX, int srcY, RastOpts *ropts);
+			    int srcX, int srcY, RastOpts *ropts,
+			    Tcl_Obj *formatObj, const char *source,
+			    TkSizeT sourceLength);
+static NSVGrasterEntry * GetCachedRaster(Tcl_Interp *interp,
+			    const char *source, TkSizeT sourceLength,
+			    Tcl_Obj *formatObj);
+static void		CacheRaster(Tcl_Interp *interp, const char *source,
+			    TkSizeT sourceLength, Tcl_Obj *formatObj,
+			    int width, int height, unsigned char *pixels);
+static int		PutCachedRaster(Tcl_Interp *interp,
+			    Tk_PhotoHandle imageHandle,
+			    NSVGrasterEntry *entryPtr, int destX, int destY,
+			    int width, int height);
 static double		GetScaleFromParameters(NSVGimage *nsvgImage,
 			    RastOpts *ropts, int *widthPtr, int *heightPtr);
 static NSVGcache *	GetCachePtr(Tcl_Interp *interp);
@@ -239,8 +279,10 @@ FileReadSVG(
     int srcX, int srcY)
 {
     TkSizeT length;
+    int result;
     const char *data;
     RastOpts ropts;
+    NSVGrasterEntry *entryPtr;
     NSVGimage *nsvgImage = GetCachedSVG(interp, chan, formatObj, &ropts);
     (void)fileName;
 
@@ -255,15 +297,26 @@ FileReadSVG(
 	    return TCL_ERROR;
 	}
 	data = Tcl_GetStringFromObj(dataObj, &length);
+	entryPtr = GetCachedRaster(interp, data, length, formatObj);
+	if (entryPtr != NULL) {
+	    Tcl_DecrRefCount(dataObj);
+	    return PutCachedRaster(interp, imageHandle, entryPtr,
+			destX, destY, width, height);
+	}
 	nsvgImage = ParseSVGWithOptions(interp, data, length, formatObj,
 			    &ropts);
-	Tcl_DecrRefCount(dataObj);
 	if (nsvgImage == NULL) {
+	    Tcl_DecrRefCount(dataObj);
 	    return TCL_ERROR;
 	}
+	result = RasterizeSVG(interp, imageHandle, nsvgImage, destX, destY,
+		    width, height, srcX, srcY, &ropts, formatObj, data,
+		    length);
+	Tcl_DecrRefCount(dataObj);
+	return result;
     }
     return RasterizeSVG(interp, imageHandle, nsvgImage, destX, destY,
-		width, height, srcX, srcY, &ropts);
+		width, height, srcX, srcY, &ropts, NULL, NULL, 0);
 }
 
 /*
@@ -350,10 +403,17 @@ StringReadSVG(
     TkSizeT length;
     const char *data;
     RastOpts ropts;
-    NSVGimage *nsvgImage = GetCachedSVG(interp, dataObj, formatObj, &ropts);
+    NSVGrasterEntry *entryPtr;
+    NSVGimage *nsvgImage;
 
+    data = Tcl_GetStringFromObj(dataObj, &length);
+    entryPtr = GetCachedRaster(interp, data, length, formatObj);
+    if (entryPtr != NULL) {
+	return PutCachedRaster(interp, imageHandle, entryPtr,
+		    destX, destY, width, height);
+    }
+    nsvgImage = GetCachedSVG(interp, dataObj, formatObj, &ropts);
     if (nsvgImage == NULL) {
-	data = Tcl_GetStringFromObj(dataObj, &length);
 	nsvgImage = ParseSVGWithOptions(interp, data, length, formatObj,
 			    &ropts);
     }
@@ -361,7 +421,7 @@ StringReadSVG(
 	return TCL_ERROR;
     }
     return RasterizeSVG(interp, imageHandle, nsvgImage, destX, destY,
-		width, height, srcX, srcY, &ropts);
+		width, height, srcX, srcY, &ropts, formatObj, data, length);
 }
 
 /*
@@ -551,7 +611,10 @@ error:
  * RasterizeSVG --
  *
  *	This function is called to rasterize the given nsvgImage and
- *	fill the imageHandle with data.
+ *	fill the imageHandle with data. If the SVG source text is given,
+ *	the resulting pixels are stored in the raster cache so that a
+ *	repeated rendering of the same source at the same size becomes a
+ *	block transfer.
  *
  * Results:
  *	A standard TCL completion code. If TCL_ERROR is returned then an error
@@ -572,7 +635,10 @@ RasterizeSVG(
     int destX, int destY,
     int width, int height,
     int srcX, int srcY,
-    RastOpts *ropts)
+    RastOpts *ropts,
+    Tcl_Obj *formatObj,
+    const char *source,
+    TkSizeT sourceLength)
 {
     int w, h, c;
     NSVGrasterizer *rast;
@@ -626,7 +692,11 @@ RasterizeSVG(
 		width, height, TK_PHOTO_COMPOSITE_SET) != TCL_OK) {
 	goto cleanimg;
     }
-    ckfree(imgData);
+    if (source != NULL) {
+	CacheRaster(interp, source, sourceLength, formatObj, w, h, imgData);
+    } else {
+	ckfree(imgData);
+    }
     nsvgDeleteRasterizer(rast);
     nsvgDelete(nsvgImage);
     return TCL_OK;
@@ -729,6 +799,8 @@ GetCachePtr(
 	cachePtr->dataOrChan = NULL;
 	Tcl_DStringInit(&cachePtr->formatString);
 	cachePtr->nsvgImage = NULL;
+	memset(cachePtr->raster, 0, sizeof(cachePtr->raster));
+	cachePtr->rasterTicket = 0;
 	Tcl_SetAssocData(interp, "tksvgnano", FreeCache, cachePtr);
     }
     return cachePtr;
@@ -821,6 +893,160 @@ GetCachedSVG(
     return nsvgImage;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * GetCachedRaster --
+ *
+ *	Try to find a cached rasterized rendering of the given SVG source
+ *	and format. The found entry is marked as most recently used.
+ *
+ * Results:
+ *	Return the found cache entry on success, and NULL otherwise.
+ *
+ * Side effects:
+ *
+ *----------------------------------------------------------------------
+ */
+
+static NSVGrasterEntry *
+GetCachedRaster(
+    Tcl_Interp *interp,
+    const char *source,
+    TkSizeT sourceLength,
+    Tcl_Obj *formatObj)
+{
+    NSVGcache *cachePtr = GetCachePtr(interp);
+    const char *format = (formatObj != NULL) ? Tcl_GetString(formatObj) : "";
+    NSVGrasterEntry *entryPtr;
+    int i;
+
+    if (cachePtr == NULL) {
+	return NULL;
+    }
+    for (i = 0; i < NSVG_RASTER_CACHE_SLOTS; i++) {
+	entryPtr = &cachePtr->raster[i];
+	if ((entryPtr->source != NULL)
+		&& (entryPtr->sourceLength == sourceLength)
+		&& (memcmp(entryPtr->source, source, sourceLength) == 0)
+		&& (strcmp(entryPtr->format, format) == 0)) {
+	    entryPtr->lastUsed = ++cachePtr->rasterTicket;
+	    return entryPtr;
+	}
+    }
+    return NULL;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CacheRaster --
+ *
+ *	Store a rasterized rendering in the raster cache, evicting the
+ *	least recently used entry if all slots are occupied. Ownership of
+ *	the pixel buffer passes to the cache; too large renderings are
+ *	not cached and their buffer is freed right away.
+ *
+ * Results:
+ *
+ * Side effects:
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CacheRaster(
+    Tcl_Interp *interp,
+    const char *source,
+    TkSizeT sourceLength,
+    Tcl_Obj *formatObj,
+    int width, int height,
+    unsigned char *pixels)
+{
+    NSVGcache *cachePtr = GetCachePtr(interp);
+    const char *format = (formatObj != NULL) ? Tcl_GetString(formatObj) : "";
+    NSVGrasterEntry *entryPtr, *oldestPtr;
+    int i;
+
+    if ((cachePtr == NULL)
+	    || ((Tcl_WideUInt)width * (Tcl_WideUInt)height * 4
+		> NSVG_RASTER_MAX_BYTES)) {
+	ckfree(pixels);
+	return;
+    }
+    oldestPtr = &cachePtr->raster[0];
+    for (i = 0; i < NSVG_RASTER_CACHE_SLOTS; i++) {
+	entryPtr = &cachePtr->raster[i];
+	if (entryPtr->source == NULL) {
+	    oldestPtr = entryPtr;
+	    break;
+	}
+	if (entryPtr->lastUsed < oldestPtr->lastUsed) {
+	    oldestPtr = entryPtr;
+	}
+    }
+    if (oldestPtr->source != NULL) {
+	ckfree(oldestPtr->source);
+	ckfree(oldestPtr->format);
+	ckfree(oldestPtr->pixels);
+    }
+    oldestPtr->source = (char *)ckalloc(sourceLength + 1);
+    memcpy(oldestPtr->source, source, sourceLength);
+    oldestPtr->source[sourceLength] = '\0';
+    oldestPtr->sourceLength = sourceLength;
+    oldestPtr->format = (char *)ckalloc(strlen(format) + 1);
+    strcpy(oldestPtr->format, format);
+    oldestPtr->width = width;
+    oldestPtr->height = height;
+    oldestPtr->pixels = pixels;
+    oldestPtr->lastUsed = ++cachePtr->rasterTicket;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * PutCachedRaster --
+ *
+ *	Transfer a cached rasterized rendering into the given photo
+ *	image, skipping the parse and rasterize steps entirely.
+ *
+ * Results:
+ *	A standard TCL completion code. If TCL_ERROR is returned then an error
+ *	message is left in the interp's result.
+ *
+ * Side effects:
+ *	New data is added to the image given by imageHandle.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+PutCachedRaster(
+    Tcl_Interp *interp,
+    Tk_PhotoHandle imageHandle,
+    NSVGrasterEntry *entryPtr,
+    int destX, int destY,
+    int width, int height)
+{
+    Tk_PhotoImageBlock svgblock;
+    int c;
+
+    svgblock.pixelPtr = entryPtr->pixels;
+    svgblock.width = entryPtr->width;
+    svgblock.height = entryPtr->height;
+    svgblock.pitch = entryPtr->width * 4;
+    svgblock.pixelSize = 4;
+    for (c = 0; c <= 3; c++) {
+	svgblock.offset[c] = c;
+    }
+    if (Tk_PhotoExpand(interp, imageHandle,
+		destX + width, destY + height) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    return Tk_PhotoPutBlock(interp, imageHandle, &svgblock, destX, destY,
+		width, height, TK_PHOTO_COMPOSITE_SET);
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -869,12 +1095,20 @@ static void
 FreeCache(ClientData clientData, Tcl_Interp *interp)
 {
     NSVGcache *cachePtr = (NSVGcache *)clientData;
+    int i;
     (void)interp;
 
     Tcl_DStringFree(&cachePtr->formatString);
     if (cachePtr->nsvgImage != NULL) {
         nsvgDelete(cachePtr->nsvgImage);
     }
+    for (i = 0; i < NSVG_RASTER_CACHE_SLOTS; i++) {
+	if (cachePtr->raster[i].source != NULL) {
+	    ckfree(cachePtr->raster[i].source);
+	    ckfree(cachePtr->raster[i].format);
+	    ckfree(cachePtr->raster[i].pixels);
+	}
+    }
     ckfree(cachePtr);
 }
 
@@ -257,6 +257,14 @@ typedef struct TkDisplay {
     KeyCode *modKeyCodes;	/* Pointer to an array giving keycodes for all
 				 * of the keys that have modifiers associated
 				 * with them. Malloc'ed, but may be NULL. */
+    KeySym *keySymCache;	/* Prefetched keycode-to-keysym table with
+				 * four entries per keycode, refreshed along
+				 * with the other keymap information above.
+				 * Malloc'ed, but may be NULL. */
+    Tcl_HashTable keySymToCode;	/* Maps a KeySym to the KeyCode that
+				 * generates it, replicating the search order
+				 * of XKeysymToKeycode. Only valid when
+				 * keySymCache is non-NULL. */
 
     /*
      * Information used by tkBitmap.c only:
@@ -339,6 +347,14 @@ typedef struct TkDisplay {
 				 * right away and we can merge the two of them
 				 * together. NULL means that there is no
 				 * delayed motion event. */
+    struct TkWindowEvent *delayedWheelPtr;
+				/* Points to a malloc-ed mouse wheel event
+				 * whose processing has been delayed so that
+				 * the deltas of immediately following wheel
+				 * events for the same window can be
+				 * accumulated into it. NULL means that there
+				 * is no delayed wheel event. Only used when
+				 * TK_DISPLAY_COLLAPSE_WHEEL_EVENTS is set. */
 
     /*
      * Information used by tkFocus.c only:
@@ -369,6 +385,12 @@ typedef struct TkDisplay {
     Tcl_HashTable gcIdTable;    /* Maps from a GC to a TkGC. */
     int gcInit;			/* 0 means the tables below need
 				 * initializing. */
+    struct TkPooledGC *gcPoolPtr;
+				/* List of GCs whose last reference has been
+				 * released, retained so that Tk_GetGC can
+				 * recycle them with XChangeGC instead of
+				 * creating a fresh GC. */
+    int gcPoolSize;		/* Number of GCs on gcPoolPtr. */
 
     /*
      * Information used by tkGeometry.c only:
@@ -423,6 +445,20 @@ typedef struct TkDisplay {
 				 * if list is empty. */
     int grabFlags;		/* Miscellaneous flag values. See definitions
 				 * in tkGrab.c. */
+    struct TkWindow *grabCacheWinPtr;
+				/* Window for which grabCacheState holds the
+				 * result of the last TkGrabState call, or
+				 * NULL if the cache is empty. The cached
+				 * result is used only while grabWinPtr and
+				 * grabFlags still equal grabCacheGrabWinPtr
+				 * and grabCacheFlags. */
+    struct TkWindow *grabCacheGrabWinPtr;
+				/* Value of grabWinPtr at the time the cache
+				 * was filled. */
+    int grabCacheFlags;		/* Value of grabFlags at the time the cache
+				 * was filled. */
+    int grabCacheState;		/* Cached TkGrabState result for
+				 * grabCacheWinPtr. */
 
     /*
      * Information used by tkGrid.c only:
@@ -512,6 +548,12 @@ typedef struct TkDisplay {
 				 * of interpreter names. */
     Atom appNameProperty;	/* X's name for property used to hold the
 				 * application name on each comm window. */
+    int commSocket;		/* On Unix, file descriptor of the listening
+				 * socket for the same-host fast "send"
+				 * transport, or -1 if that transport is
+				 * unavailable. Unused on other platforms. */
+    char *commSocketPath;	/* Path name bound to commSocket (malloc-ed),
+				 * or NULL. */
 
     /*
      * Information used by tkUnixWm.c and tkWinWm.c only:
@@ -576,6 +618,12 @@ typedef struct TkDisplay {
 
     int iconDataSize;		/* Size of default iconphoto image data. */
     unsigned char *iconDataPtr;	/* Default iconphoto image data, if set. */
+    int scalingEpoch;		/* Incremented each time [tk scaling] changes
+				 * the pixels-per-point ratio of one of this
+				 * display's screens. Cached conversions and
+				 * pre-rendered resources record the epoch
+				 * they were computed under and are refreshed
+				 * lazily when it no longer matches. */
     int ximGeneration;          /* Used to invalidate XIC */
 #if !defined(TK_USE_INPUT_METHODS) && (TCL_MAJOR_VERSION < 9)
     XIM inputMethod;		/* Input method for this display. */
@@ -588,6 +636,11 @@ typedef struct TkDisplay {
  * Flag values for TkDisplay flags.
  *  TK_DISPLAY_COLLAPSE_MOTION_EVENTS:	(default on)
  *	Indicates that we should collapse motion events on this display
+ *  TK_DISPLAY_COLLAPSE_WHEEL_EVENTS:	(default off; on for X11 displays)
+ *	Indicates that we should accumulate the deltas of successive mouse
+ *	wheel events on this display.  The Unix TkpOpenDisplay turns this
+ *	on because X11 reports scrolling as high-rate bursts of emulated
+ *	button presses.
  *  TK_DISPLAY_USE_IM:			(default on, set via tk.tcl)
  *	Whether to use input methods for this display
  *  TK_DISPLAY_WM_TRACING:		(default off)
@@ -596,6 +649,7 @@ typedef struct TkDisplay {
 
 #define TK_DISPLAY_COLLAPSE_MOTION_EVENTS	(1 << 0)
 #define TK_DISPLAY_USE_IM			(1 << 1)
+#define TK_DISPLAY_COLLAPSE_WHEEL_EVENTS	(1 << 2)
 #define TK_DISPLAY_WM_TRACING			(1 << 3)
 
 /*
@@ -660,6 +714,13 @@ typedef struct TkMainInfo {
     Tcl_HashTable nameTable;	/* Hash table mapping path names to TkWindow
 				 * structs for all windows related to this
 				 * main window. Managed by tkWindow.c. */
+    Tcl_HashTable liveWindowTable;
+				/* Hash table keyed by TkWindow address for
+				 * all windows in nameTable. Used to
+				 * revalidate cached window object
+				 * representations after a deletion without
+				 * doing a full name lookup. Managed by
+				 * tkWindow.c. */
 #if TCL_MAJOR_VERSION > 8
     size_t deletionEpoch;		/* Incremented by window deletions. */
 #else
@@ -687,6 +748,10 @@ typedef struct TkMainInfo {
 				 * information for each display that this
 				 * application has ever used. Used only by
 				 * tkFocus.c. */
+    struct TkFocusOrderInfo *focusOrderPtr;
+				/* First in list of records caching the focus
+				 * traversal order for each top-level in the
+				 * application. Used only by tkFocus.c. */
 
     struct ElArray *optionRootPtr;
 				/* Top level of option hierarchy for this main
@@ -1064,6 +1129,7 @@ MODULE_SCOPE const Tcl_ObjType tkCursorObjType;
 MODULE_SCOPE const Tcl_ObjType tkFontObjType;
 MODULE_SCOPE const Tcl_ObjType tkStateKeyObjType;
 MODULE_SCOPE const Tcl_ObjType tkTextIndexType;
+MODULE_SCOPE const Tcl_ObjType tkUidObjType;
 
 /*
  * Miscellaneous variables shared among Tk modules but not exported to the
@@ -1287,19 +1353,169 @@ MODULE_SCOPE int	TkSetGeometryContainer(Tcl_Interp *interp,
 			    Tk_Window tkwin, const char *name);
 MODULE_SCOPE void	TkFreeGeometryContainer(Tk_Window tkwin,
 			    const char *name);
+MODULE_SCOPE void	TkScheduleLayout(Tk_Window tkwin,
+			    Tcl_IdleProc *proc, ClientData clientData);
+MODULE_SCOPE void	TkUnscheduleLayout(Tcl_IdleProc *proc,
+			    ClientData clientData);
+MODULE_SCOPE void	TkGeometryBatchBegin(void);
+MODULE_SCOPE void	TkGeometryBatchEnd(void);
+MODULE_SCOPE void	TkGeometryBatchDeadWindow(TkWindow *winPtr);
 
 MODULE_SCOPE void	TkEventInit(void);
 MODULE_SCOPE void	TkRegisterObjTypes(void);
 MODULE_SCOPE int	TkDeadAppObjCmd(ClientData clientData,
 			    Tcl_Interp *interp, int objc, Tcl_Obj *const argv[]);
+MODULE_SCOPE int	TkFontcacheObjCmd(ClientData clientData,
+			    Tcl_Interp *interp, int objc,
+			    Tcl_Obj *const objv[]);
+MODULE_SCOPE int	TkFrameclockObjCmd(ClientData clientData,
+			    Tcl_Interp *interp, int objc,
+			    Tcl_Obj *const objv[]);
+MODULE_SCOPE int	TkFrameClockIntervalUsec(void);
+MODULE_SCOPE int	TkResourcecacheObjCmd(ClientData clientData,
+			    Tcl_Interp *interp, int objc,
+			    Tcl_Obj *const objv[]);
+
+/*
+ * Direct scrollbar linkage (implemented in tkScrollbar.c). These routines
+ * let a scrollable widget hand its view fractions straight to a core
+ * scrollbar, and let the scrollbar dispatch view changes straight back,
+ * without evaluating the usual -yscrollcommand/-command scripts. The
+ * scrollbar structure stays opaque outside tkScrollbar.c.
+ */
+
+struct TkScrollbar;
+MODULE_SCOPE struct TkScrollbar *TkScrollbarFromObj(Tcl_Interp *interp,
+			    Tk_Window tkwin, Tcl_Obj *objPtr);
+MODULE_SCOPE int	TkScrollbarIsVertical(struct TkScrollbar *scrollPtr);
+MODULE_SCOPE void	TkScrollbarLinkWidget(struct TkScrollbar *scrollPtr,
+			    Tcl_Obj *cmdPrefixObj);
+MODULE_SCOPE void	TkScrollbarSetRange(struct TkScrollbar *scrollPtr,
+			    double first, double last);
+
+/*
+ * Lightweight performance instrumentation behind the "tk perf" command (see
+ * PerfCmd in tkCmds.c). The probes are compiled in unconditionally, but each
+ * one reduces to a single predictable branch on tkPerfEnabled while
+ * collection is off, so they are cheap enough to leave in production builds.
+ */
+
+typedef enum {
+    TK_PERF_TIMER_EVENT,	/* Tk_HandleEvent dispatch latency. */
+    TK_PERF_TIMER_CANVAS,	/* DisplayCanvas idle callback duration. */
+    TK_PERF_TIMER_TEXT,		/* DisplayText idle callback duration. */
+    TK_PERF_NUM_TIMERS
+} TkPerfTimerId;
+
+typedef enum {
+    TK_PERF_PIXELS_PAINTED,	/* Pixels filled by widget redraws. */
+    TK_PERF_NUM_COUNTERS
+} TkPerfCounterId;
+
+#define TK_PERF_HIST_BUCKETS 24
+
+typedef struct TkPerfTimer {
+    Tcl_WideUInt count;		/* Number of recorded intervals. */
+    Tcl_WideUInt totalUs;	/* Sum of the intervals, in microseconds. */
+    Tcl_WideUInt maxUs;		/* Largest single interval. */
+    Tcl_WideUInt hist[TK_PERF_HIST_BUCKETS];
+				/* Bucket i counts intervals whose duration
+				 * lies in [2^i, 2^(i+1)) microseconds (the
+				 * first bucket also counts 0, the last
+				 * absorbs everything longer). */
+} TkPerfTimer;
+
+MODULE_SCOPE int	tkPerfEnabled;
+MODULE_SCOPE Tcl_WideUInt tkPerfCounters[TK_PERF_NUM_COUNTERS];
+MODULE_SCOPE TkPerfTimer tkPerfTimers[TK_PERF_NUM_TIMERS];
+MODULE_SCOPE void	TkPerfTimerRecord(TkPerfTimerId id,
+			    const Tcl_Time *startPtr);
+
+/*
+ * Ring buffer of render request samples behind "tk perf xdump". Each sample
+ * attributes one render request to the widget that issued it, so that X
+ * traffic can be traced back to widgets on remote displays. Only the most
+ * recent TK_PERF_XLOG_SIZE samples are kept.
+ */
+
+#define TK_PERF_XLOG_SIZE 4096
+
+typedef struct TkPerfXSample {
+    Tk_Uid path;		/* Path name of the issuing widget, as a uid
+				 * so the sample stays valid after the widget
+				 * is destroyed. */
+    const char *kind;		/* Statically allocated string naming the
+				 * kind of request (an item type name or a
+				 * request name such as "copyarea"). */
+    unsigned int bytes;		/* Approximate payload size in bytes. */
+    unsigned int us;		/* Client-side duration in microseconds, or 0
+				 * if collection started mid-request. */
+} TkPerfXSample;
+
+MODULE_SCOPE TkPerfXSample tkPerfXLog[TK_PERF_XLOG_SIZE];
+MODULE_SCOPE unsigned int tkPerfXLogCount;
+MODULE_SCOPE void	TkPerfXRecord(Tk_Window tkwin, const char *kind,
+			    unsigned int bytes, const Tcl_Time *startPtr);
+MODULE_SCOPE void	TkTextDispStats(int *numRedisplaysPtr,
+			    int *linesRedrawnPtr, int *numCopiesPtr);
+
+/*
+ * Cooperative frame scheduler for Tcl_DoWhenIdle redraw callbacks (see
+ * tkEvent.c). A callback brackets its work with TkFrameBudgetStart and polls
+ * TkFrameBudgetCheck at interruption points; when the check fires it
+ * reschedules itself and returns, so big repaints cannot starve input.
+ */
+
+MODULE_SCOPE void	TkFrameBudgetStart(void);
+MODULE_SCOPE int	TkFrameBudgetCheck(void);
+
+#define TK_PERF_TIMER_START(startPtr) \
+    do {								\
+	if (tkPerfEnabled) {						\
+	    Tcl_GetTime(startPtr);					\
+	} else {							\
+	    (startPtr)->sec = 0;					\
+	}								\
+    } while (0)
+#define TK_PERF_TIMER_STOP(id, startPtr) \
+    do {								\
+	if (tkPerfEnabled) {						\
+	    TkPerfTimerRecord(id, startPtr);				\
+	}								\
+    } while (0)
+#define TK_PERF_COUNT(id, amount) \
+    do {								\
+	if (tkPerfEnabled) {						\
+	    tkPerfCounters[id] += (Tcl_WideUInt) (amount);		\
+	}								\
+    } while (0)
+#define TK_PERF_XRECORD(tkwin, kind, bytes, startPtr) \
+    do {								\
+	if (tkPerfEnabled) {						\
+	    TkPerfXRecord(tkwin, kind, bytes, startPtr);		\
+	}								\
+    } while (0)
 MODULE_SCOPE int	TkCanvasGetCoordObj(Tcl_Interp *interp,
 			    Tk_Canvas canvas, Tcl_Obj *obj,
 			    double *doublePtr);
+MODULE_SCOPE int	TkMakeBezierCurveSegments(double *pointPtr,
+			    int numPoints, int firstUnit, int numSteps,
+			    double dblPoints[], int *lastSizePtr);
+MODULE_SCOPE void	TkMakeWindowTreeExist(TkWindow *winPtr);
 MODULE_SCOPE int	TkGetDoublePixels(Tcl_Interp *interp, Tk_Window tkwin,
 			    const char *string, double *doublePtr);
+MODULE_SCOPE int	TkGetEnumFromObj(Tcl_Interp *interp, Tcl_Obj *objPtr,
+			    const char *const *tablePtr, const char *msg,
+			    int *indexPtr);
+MODULE_SCOPE Tk_Uid	TkGetUidFromObj(Tcl_Obj *objPtr);
+MODULE_SCOPE void	TkGCSetDashes(Display *display, GC gc, int offset,
+			    const char *list, int n);
+MODULE_SCOPE void	TkGCRestoreDashes(Display *display, GC gc);
 MODULE_SCOPE int	TkPostscriptImage(Tcl_Interp *interp, Tk_Window tkwin,
 			    Tk_PostscriptInfo psInfo, XImage *ximage,
 			    int x, int y, int width, int height);
+MODULE_SCOPE unsigned char *TkImgGetDataBytes(Tcl_Obj *objPtr,
+			    TkSizeT *lengthPtr);
 #if TCL_MAJOR_VERSION > 8
 MODULE_SCOPE int TkCanvasTagsParseProc(ClientData clientData, Tcl_Interp *interp,
     Tk_Window tkwin, const char *value, char *widgRec, size_t offset);
@@ -1328,6 +1544,10 @@ MODULE_SCOPE int	TkParsePadAmount(Tcl_Interp *interp,
 			    int *pad1Ptr, int *pad2Ptr);
 MODULE_SCOPE void       TkFocusSplit(TkWindow *winPtr);
 MODULE_SCOPE void       TkFocusJoin(TkWindow *winPtr);
+MODULE_SCOPE void       TkFocusOrderInvalidate(TkMainInfo *mainPtr);
+MODULE_SCOPE int	TkFocusOrderObjCmd(ClientData clientData,
+			    Tcl_Interp *interp, int objc,
+			    Tcl_Obj *const objv[]);
 MODULE_SCOPE void	TkpDrawCharsInContext(Display * display,
 			    Drawable drawable, GC gc, Tk_Font tkfont,
 			    const char *source, int numBytes, int rangeStart,
@@ -1344,6 +1564,10 @@ MODULE_SCOPE void	TkUnderlineCharsInContext(Display *display,
 			    Drawable drawable, GC gc, Tk_Font tkfont,
 			    const char *string, int numBytes, int x, int y,
 			    int firstByte, int lastByte);
+MODULE_SCOPE Tk_TextLayout TkTextLayoutEdit(Tk_Font tkfont,
+			    Tk_TextLayout oldLayout, const char *string,
+			    int numChars, int wrapLength, Tk_Justify justify,
+			    int flags, int *widthPtr, int *heightPtr);
 MODULE_SCOPE void	TkpGetFontAttrsForChar(Tk_Window tkwin, Tk_Font tkfont,
 			    int c, struct TkFontAttributes *faPtr);
 MODULE_SCOPE void	TkpDrawFrameEx(Tk_Window tkwin, Drawable drawable,
@@ -1389,26 +1613,67 @@ MODULE_SCOPE Status TkParseColor (Display * display,
 #endif
 #if !defined(_WIN32) && !defined(__CYGWIN__) /* UNIX and MacOSX */
 #undef TkPutImage
+#ifdef MAC_OSX_TK
 #define TkPutImage(colors, ncolors, display, pixels, gc, image, srcx, srcy, destx, desty, width, height) \
 	XPutImage(display, pixels, gc, image, srcx, srcy, destx, desty, width, height);
 #else
+MODULE_SCOPE int TkUnixPutImage(Display *display, Drawable d, GC gc,
+				XImage *image, int src_x, int src_y,
+				int dest_x, int dest_y, unsigned int width,
+				unsigned int height);
+#define TkPutImage(colors, ncolors, display, pixels, gc, image, srcx, srcy, destx, desty, width, height) \
+	TkUnixPutImage(display, pixels, gc, image, srcx, srcy, destx, desty, width, height);
+#endif
+#else
 #undef XPutImage
 #define XPutImage(display, pixels, gc, image, srcx, srcy, destx, desty, width, height) \
 	TkPutImage(NULL, 0, display, pixels, gc, image, srcx, srcy, destx, desty, width, height);
 #endif
 
 /*
- * These macros are just wrappers for the equivalent X Region calls.
+ * These macros are just wrappers for the equivalent X Region calls, except
+ * that on Unix region creation and destruction go through a small per-thread
+ * pool (see unix/tkUnixXId.c) so that code which briefly accumulates damage
+ * rectangles in a region does not pay for an allocation and free per use.
  */
 #define TkClipBox XClipBox
+#if !defined(_WIN32) && !defined(__CYGWIN__) && !defined(MAC_OSX_TK)
+MODULE_SCOPE Region	TkUnixCreateRegion(void);
+MODULE_SCOPE void	TkUnixDestroyRegion(Region rgn);
+#define TkCreateRegion TkUnixCreateRegion
+#define TkDestroyRegion TkUnixDestroyRegion
+#else
 #define TkCreateRegion XCreateRegion
 #define TkDestroyRegion XDestroyRegion
+#endif
 #define TkIntersectRegion XIntersectRegion
 #define TkRectInRegion XRectInRegion
 #define TkSetRegion XSetRegion
 #define TkSubtractRegion XSubtractRegion
 #define TkUnionRectWithRegion XUnionRectWithRegion
 
+/*
+ * On Unix, scroll copies can be pipelined: TkScrollWindowDefer issues the
+ * copy without waiting for its damage report and TkScrollWindowFlush
+ * collects the damage for all deferred copies in one pass (see
+ * unix/tkUnixDraw.c). On the other platforms TkScrollWindow is local and
+ * synchronous anyway, so the macros fall back to it and the flush is a
+ * no-op.
+ */
+#if !defined(_WIN32) && !defined(__CYGWIN__) && !defined(MAC_OSX_TK)
+MODULE_SCOPE int	TkUnixScrollWindowDefer(Tk_Window tkwin, GC gc,
+			    int x, int y, int width, int height, int dx,
+			    int dy, Region damageRgn);
+MODULE_SCOPE int	TkUnixScrollWindowFlush(Tk_Window tkwin,
+			    Region damageRgn);
+#define TkScrollWindowDefer TkUnixScrollWindowDefer
+#define TkScrollWindowFlush TkUnixScrollWindowFlush
+#else
+#define TkScrollWindowDefer(tkwin, gc, x, y, width, height, dx, dy, damageRgn) \
+	TkScrollWindow(tkwin, gc, x, y, width, height, dx, dy, damageRgn)
+#define TkScrollWindowFlush(tkwin, damageRgn) (0)
+#endif
+
 #ifdef HAVE_XFT
 MODULE_SCOPE void	TkUnixSetXftClipRegion(Region clipRegion);
 #endif
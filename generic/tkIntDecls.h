@@ -570,6 +570,12 @@ EXTERN int		TkpWillDrawWidget(Tk_Window tkwin);
 EXTERN int		TkDebugPhotoStringMatchDef(Tcl_Interp *inter,
 				Tcl_Obj *data, Tcl_Obj *formatString,
 				int *widthPtr, int *heightPtr);
+/* 188 */
+EXTERN Tcl_WideInt	TkGridSolveStats(int reset);
+/* 189 */
+EXTERN Tcl_WideInt	TkLayoutReorderStats(int reset);
+/* 190 */
+EXTERN Tcl_WideInt	TkFrameOverdrawStats(int reset);
 
 typedef struct TkIntStubs {
     int magic;
@@ -806,6 +812,9 @@ typedef struct TkIntStubs {
     int (*tkpWillDrawWidget) (Tk_Window tkwin); /* 186 */
 #endif /* MACOSX */
     int (*tkDebugPhotoStringMatchDef) (Tcl_Interp *inter, Tcl_Obj *data, Tcl_Obj *formatString, int *widthPtr, int *heightPtr); /* 187 */
+    Tcl_WideInt (*tkGridSolveStats) (int reset); /* 188 */
+    Tcl_WideInt (*tkLayoutReorderStats) (int reset); /* 189 */
+    Tcl_WideInt (*tkFrameOverdrawStats) (int reset); /* 190 */
 } TkIntStubs;
 
 extern const TkIntStubs *tkIntStubsPtr;
@@ -1188,6 +1197,12 @@ extern const TkIntStubs *tkIntStubsPtr;
 #endif /* MACOSX */
 #define TkDebugPhotoStringMatchDef \
 	(tkIntStubsPtr->tkDebugPhotoStringMatchDef) /* 187 */
+#define TkGridSolveStats \
+	(tkIntStubsPtr->tkGridSolveStats) /* 188 */
+#define TkLayoutReorderStats \
+	(tkIntStubsPtr->tkLayoutReorderStats) /* 189 */
+#define TkFrameOverdrawStats \
+	(tkIntStubsPtr->tkFrameOverdrawStats) /* 190 */
 
 #endif /* defined(USE_TK_STUBS) */
 
@@ -51,6 +51,14 @@ typedef struct {
     char *listVarName;		/* List variable name */
     Tcl_Obj *listObj;		/* Pointer to the list object being used */
     int nElements;		/* Holds the current count of elements */
+    char *dataCmd;		/* Command prefix used to fetch elements on
+				 * demand, or NULL when the listbox stores
+				 * its elements itself. Malloc-ed. */
+    int dataSize;		/* Number of elements reported when dataCmd
+				 * is set. */
+    Tcl_Obj *dataItemObj;	/* Element most recently fetched through
+				 * dataCmd; callers borrow this reference
+				 * until the next fetch. */
     Tcl_HashTable *selection;	/* Tracks selection */
     Tcl_HashTable *itemAttrTable;
 				/* Tracks item attributes */
@@ -107,6 +115,16 @@ typedef struct {
 
     int maxWidth;		/* Width (in pixels) of widest string in
 				 * listbox. */
+    int *widthHist;		/* Bucketed histogram of element pixel
+				 * widths: widthHist[w] counts the elements
+				 * exactly w pixels wide. Rebuilt by full
+				 * geometry scans and updated incrementally
+				 * on insert and delete, so that deleting a
+				 * widest element does not force the whole
+				 * list to be re-measured. NULL when the
+				 * histogram has been discarded. Malloc-ed. */
+    int widthHistLength;	/* Number of buckets allocated in
+				 * widthHist. */
     int xScrollUnit;		/* Number of pixels in one "unit" for
 				 * horizontal scrolling (window scrolls
 				 * horizontally in increments of this size).
@@ -254,6 +272,12 @@ static const Tk_OptionSpec optionSpecs[] = {
     {TK_OPTION_CURSOR, "-cursor", "cursor", "Cursor",
 	 DEF_LISTBOX_CURSOR, TCL_INDEX_NONE, offsetof(Listbox, cursor),
 	 TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_STRING, "-datacommand", "dataCommand", "DataCommand",
+	 DEF_LISTBOX_DATA_COMMAND, TCL_INDEX_NONE, offsetof(Listbox, dataCmd),
+	 TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_INT, "-datasize", "dataSize", "DataSize",
+	 DEF_LISTBOX_DATA_SIZE, TCL_INDEX_NONE, offsetof(Listbox, dataSize),
+	 0, 0, 0},
     {TK_OPTION_COLOR, "-disabledforeground", "disabledForeground",
 	 "DisabledForeground", DEF_LISTBOX_DISABLED_FG, TCL_INDEX_NONE,
 	 offsetof(Listbox, dfgColorPtr), TK_OPTION_NULL_OK, 0, 0},
@@ -431,6 +455,13 @@ static int		ListboxXviewSubCmd(Tcl_Interp *interp,
 			    Listbox *listPtr, int objc, Tcl_Obj *const objv[]);
 static int		ListboxYviewSubCmd(Tcl_Interp *interp,
 			    Listbox *listPtr, int objc, Tcl_Obj *const objv[]);
+static Tcl_Obj *	ListboxGetItem(Tcl_Interp *interp, Listbox *listPtr,
+			    int index);
+static void		ListboxWidthHistReset(Listbox *listPtr);
+static void		ListboxWidthHistFree(Listbox *listPtr);
+static void		ListboxWidthHistAdd(Listbox *listPtr, int pixelWidth);
+static int		ListboxWidthHistRemove(Listbox *listPtr,
+			    int pixelWidth);
 static ItemAttr *	ListboxGetItemAttributes(Tcl_Interp *interp,
 			    Listbox *listPtr, int index);
 static void		ListboxWorldChanged(ClientData instanceData);
@@ -813,6 +844,41 @@ ListboxWidgetObjCmd(
 	    result = TCL_OK;
 	    break;
 	}
+	if (listPtr->dataCmd != NULL) {
+	    /*
+	     * Virtual mode: fetch the requested elements through the data
+	     * command instead of the internal list.
+	     */
+
+	    Tcl_Obj *el;
+
+	    if (objc == 3) {
+		el = ListboxGetItem(interp, listPtr, first);
+		if (el == NULL) {
+		    result = TCL_ERROR;
+		    break;
+		}
+		Tcl_SetObjResult(interp, el);
+	    } else {
+		Tcl_Obj *resultObj = Tcl_NewListObj(0, NULL);
+
+		for (index = first; index <= last; index++) {
+		    el = ListboxGetItem(interp, listPtr, index);
+		    if (el == NULL) {
+			result = TCL_ERROR;
+			break;
+		    }
+		    Tcl_ListObjAppendElement(NULL, resultObj, el);
+		}
+		if (result != TCL_OK) {
+		    Tcl_DecrRefCount(resultObj);
+		    break;
+		}
+		Tcl_SetObjResult(interp, resultObj);
+	    }
+	    result = TCL_OK;
+	    break;
+	}
 	result = Tcl_ListObjGetElements(interp, listPtr->listObj, &listLen,
 		&elemPtrs);
 	if (result != TCL_OK) {
@@ -1111,9 +1177,16 @@ ListboxBboxSubCmd(
 	 * Compute the pixel width of the requested element.
 	 */
 
-	result = Tcl_ListObjIndex(interp, listPtr->listObj, index, &el);
-	if (result != TCL_OK) {
-	    return result;
+	if (listPtr->dataCmd != NULL) {
+	    el = ListboxGetItem(interp, listPtr, index);
+	    if (el == NULL) {
+		return TCL_ERROR;
+	    }
+	} else {
+	    result = Tcl_ListObjIndex(interp, listPtr->listObj, index, &el);
+	    if (result != TCL_OK) {
+		return result;
+	    }
 	}
 
 	stringRep = Tcl_GetStringFromObj(el, &stringLen);
@@ -1461,6 +1534,13 @@ DestroyListbox(
 	listPtr->listObj = NULL;
     }
 
+    if (listPtr->dataItemObj != NULL) {
+	Tcl_DecrRefCount(listPtr->dataItemObj);
+	listPtr->dataItemObj = NULL;
+    }
+
+    ListboxWidthHistFree(listPtr);
+
     if (listPtr->listVarName != NULL) {
 	Tcl_UntraceVar2(listPtr->interp, listPtr->listVarName, NULL,
 		TCL_GLOBAL_ONLY|TCL_TRACE_WRITES|TCL_TRACE_UNSETS,
@@ -1621,6 +1701,25 @@ ConfigureListbox(
 		    ListboxLostSelection, listPtr);
 	}
 
+	/*
+	 * The on-demand data source excludes a list variable, since there is
+	 * no stored list to mirror into it.
+	 */
+
+	if (listPtr->dataCmd != NULL) {
+	    if (listPtr->listVarName != NULL) {
+		Tcl_SetObjResult(interp, Tcl_NewStringObj(
+			"cannot use -listvariable and -datacommand"
+			" at the same time", -1));
+		Tcl_SetErrorCode(interp, "TK", "LISTBOX", "DATACOMMAND",
+			NULL);
+		continue;
+	    }
+	    if (listPtr->dataSize < 0) {
+		listPtr->dataSize = 0;
+	    }
+	}
+
 	/*
 	 * Verify the current status of the list var.
 	 * PREVIOUS STATE | NEW STATE  | ACTION
@@ -1686,6 +1785,9 @@ ConfigureListbox(
      */
 
     Tcl_ListObjLength(listPtr->interp, listPtr->listObj, &listPtr->nElements);
+    if (listPtr->dataCmd != NULL) {
+	listPtr->nElements = listPtr->dataSize;
+    }
 
     if (error) {
 	Tcl_SetObjResult(interp, errorResult);
@@ -1821,6 +1923,81 @@ ListboxWorldChanged(
     EventuallyRedrawRange(listPtr, 0, listPtr->nElements-1);
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * ListboxGetItem --
+ *
+ *	Fetch the element at the given index, either from the internal list
+ *	object or, when -datacommand is set, by evaluating that callback with
+ *	the index appended.
+ *
+ * Results:
+ *	Returns a pointer to the element object, or NULL if the callback
+ *	failed or destroyed the listbox.  The reference is only valid until
+ *	the next call of this function for the same listbox.  When interp is
+ *	NULL a callback error is reported as a background error; otherwise it
+ *	is left in interp.  Callers that keep using the listbox after a
+ *	callback must hold a Tcl_Preserve reference on it.
+ *
+ * Side effects:
+ *	Evaluates the -datacommand callback.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static Tcl_Obj *
+ListboxGetItem(
+    Tcl_Interp *interp,		/* Interpreter for error reporting, or NULL
+				 * to report errors in the background. */
+    Listbox *listPtr,		/* Listbox to fetch the element from. */
+    int index)			/* Index of the desired element. */
+{
+    Tcl_DString buf;
+    Tcl_Obj *elemObj;
+    char string[TCL_INTEGER_SPACE];
+    int result;
+
+    if (listPtr->dataCmd == NULL) {
+	Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, index, &elemObj);
+	return elemObj;
+    }
+
+    snprintf(string, sizeof(string), "%d", index);
+    Tcl_DStringInit(&buf);
+    Tcl_DStringAppend(&buf, listPtr->dataCmd, -1);
+    Tcl_DStringAppend(&buf, " ", 1);
+    Tcl_DStringAppend(&buf, string, -1);
+    Tcl_Preserve(listPtr);
+    result = Tcl_EvalEx(listPtr->interp, Tcl_DStringValue(&buf),
+	    Tcl_DStringLength(&buf), TCL_EVAL_GLOBAL);
+    Tcl_DStringFree(&buf);
+    if ((result != TCL_OK) || (listPtr->flags & LISTBOX_DELETED)) {
+	if (result != TCL_OK) {
+	    if (interp == NULL) {
+		Tcl_AddErrorInfo(listPtr->interp,
+			"\n    (-datacommand callback)");
+		Tcl_BackgroundException(listPtr->interp, result);
+	    }
+	} else if (interp != NULL) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "listbox was deleted by the -datacommand callback", -1));
+	    Tcl_SetErrorCode(interp, "TK", "LISTBOX", "DATACOMMAND", NULL);
+	}
+	Tcl_Release(listPtr);
+	return NULL;
+    }
+    elemObj = Tcl_GetObjResult(listPtr->interp);
+    Tcl_IncrRefCount(elemObj);
+    if (listPtr->dataItemObj != NULL) {
+	Tcl_DecrRefCount(listPtr->dataItemObj);
+    }
+    listPtr->dataItemObj = elemObj;
+    Tcl_ResetResult(listPtr->interp);
+    Tcl_Release(listPtr);
+    return elemObj;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -1859,6 +2036,10 @@ DisplayListbox(
 				 * off-screen. */
     Pixmap pixmap;
     int textWidth;
+    Tcl_Obj **prefetch = NULL;	/* In virtual mode, the visible elements
+				 * fetched up front through the data
+				 * command. */
+    int numPrefetch = 0;
 
     listPtr->flags &= ~REDRAW_PENDING;
     if (listPtr->flags & LISTBOX_DELETED) {
@@ -1924,6 +2105,41 @@ DisplayListbox(
     }
     prevSelected = 0;
 
+    /*
+     * In virtual mode, fetch every visible element through the data command
+     * before anything is drawn, so that all of the callbacks (which may do
+     * anything except modify the listbox itself) are evaluated up front.
+     */
+
+    if ((listPtr->dataCmd != NULL) && (limit >= listPtr->topIndex)) {
+	prefetch = (Tcl_Obj **)ckalloc(
+		(limit - listPtr->topIndex + 1) * sizeof(Tcl_Obj *));
+	Tcl_Preserve(listPtr);
+	for (i = listPtr->topIndex; i <= limit; i++) {
+	    curElement = ListboxGetItem(NULL, listPtr, i);
+	    if (listPtr->flags & LISTBOX_DELETED) {
+		break;
+	    }
+	    if (curElement == NULL) {
+		curElement = Tcl_NewObj();
+	    }
+	    Tcl_IncrRefCount(curElement);
+	    prefetch[numPrefetch++] = curElement;
+	}
+	if (listPtr->flags & LISTBOX_DELETED) {
+	    while (numPrefetch > 0) {
+		Tcl_DecrRefCount(prefetch[--numPrefetch]);
+	    }
+	    ckfree(prefetch);
+#ifndef TK_NO_DOUBLE_BUFFERING
+	    Tk_FreePixmap(listPtr->display, pixmap);
+#endif /* TK_NO_DOUBLE_BUFFERING */
+	    Tcl_Release(listPtr);
+	    return;
+	}
+	Tcl_Release(listPtr);
+    }
+
     for (i = listPtr->topIndex; i <= limit; i++) {
 	int width = Tk_Width(tkwin);	/* zeroth approx to silence warning */
 
@@ -2078,7 +2294,12 @@ DisplayListbox(
 	 * Draw the actual text of this item.
 	 */
 
-        Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, i, &curElement);
+        if (prefetch != NULL) {
+            curElement = prefetch[i - listPtr->topIndex];
+        } else {
+            Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, i,
+                    &curElement);
+        }
         stringRep = Tcl_GetStringFromObj(curElement, &stringLen);
         textWidth = Tk_TextWidth(listPtr->tkfont, stringRep, stringLen);
 
@@ -2205,6 +2426,140 @@ DisplayListbox(
 	    (unsigned) Tk_Height(tkwin), 0, 0);
     Tk_FreePixmap(listPtr->display, pixmap);
 #endif /* TK_NO_DOUBLE_BUFFERING */
+    if (prefetch != NULL) {
+	while (numPrefetch > 0) {
+	    Tcl_DecrRefCount(prefetch[--numPrefetch]);
+	}
+	ckfree(prefetch);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ListboxWidthHistReset, ListboxWidthHistFree --
+ *
+ *	Prepare the width histogram for a full rebuild, or discard it
+ *	entirely. A discarded histogram stays away until the next full
+ *	geometry scan rebuilds it; incremental updates in the meantime fall
+ *	back to the rescan-on-delete behavior.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Memory may be allocated or freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ListboxWidthHistReset(
+    Listbox *listPtr)		/* Listbox whose histogram is rebuilt. */
+{
+    if (listPtr->widthHist == NULL) {
+	listPtr->widthHist = (int *)ckalloc(sizeof(int));
+	listPtr->widthHistLength = 1;
+    }
+    memset(listPtr->widthHist, 0, listPtr->widthHistLength * sizeof(int));
+}
+
+static void
+ListboxWidthHistFree(
+    Listbox *listPtr)		/* Listbox whose histogram is discarded. */
+{
+    if (listPtr->widthHist != NULL) {
+	ckfree(listPtr->widthHist);
+	listPtr->widthHist = NULL;
+    }
+    listPtr->widthHistLength = 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ListboxWidthHistAdd --
+ *
+ *	Account for one element of the given pixel width, updating maxWidth
+ *	as a side effect. When the histogram has been discarded only the
+ *	maxWidth update is performed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The histogram may grow; listPtr->maxWidth may increase.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ListboxWidthHistAdd(
+    Listbox *listPtr,		/* Listbox of interest. */
+    int pixelWidth)		/* Pixel width of the new element. */
+{
+    if (pixelWidth > listPtr->maxWidth) {
+	listPtr->maxWidth = pixelWidth;
+    }
+    if (listPtr->widthHist == NULL) {
+	return;
+    }
+    if (pixelWidth >= listPtr->widthHistLength) {
+	int newLength = 2*pixelWidth + 1;
+	int *newHist = (int *)ckalloc(newLength * sizeof(int));
+
+	memset(newHist, 0, newLength * sizeof(int));
+	memcpy(newHist, listPtr->widthHist,
+		listPtr->widthHistLength * sizeof(int));
+	ckfree(listPtr->widthHist);
+	listPtr->widthHist = newHist;
+	listPtr->widthHistLength = newLength;
+    }
+    listPtr->widthHist[pixelWidth]++;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ListboxWidthHistRemove --
+ *
+ *	Account for the removal of one element of the given pixel width. If
+ *	the widest bucket empties, maxWidth is lowered to the next occupied
+ *	bucket without rescanning the list. If the histogram disagrees with
+ *	the caller it cannot be trusted and is discarded.
+ *
+ * Results:
+ *	Returns 1 if the histogram handled the removal (maxWidth is
+ *	up-to-date), or 0 if the caller must fall back to a full rescan.
+ *
+ * Side effects:
+ *	listPtr->maxWidth may decrease; the histogram may be freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ListboxWidthHistRemove(
+    Listbox *listPtr,		/* Listbox of interest. */
+    int pixelWidth)		/* Pixel width of the removed element. */
+{
+    int w;
+
+    if ((listPtr->widthHist == NULL)
+	    || (pixelWidth >= listPtr->widthHistLength)
+	    || (listPtr->widthHist[pixelWidth] <= 0)) {
+	ListboxWidthHistFree(listPtr);
+	return 0;
+    }
+    listPtr->widthHist[pixelWidth]--;
+    if ((pixelWidth == listPtr->maxWidth)
+	    && (listPtr->widthHist[pixelWidth] == 0)) {
+	for (w = pixelWidth; (w > 0) && (listPtr->widthHist[w] == 0); w--) {
+	    /* Empty loop body. */
+	}
+	listPtr->maxWidth = w;
+    }
+    return 1;
 }
 
 /*
@@ -2253,21 +2608,52 @@ ListboxComputeGeometry(
 	    listPtr->xScrollUnit = 1;
 	}
 	listPtr->maxWidth = 0;
-	for (i = 0; i < listPtr->nElements; i++) {
+	if (listPtr->dataCmd != NULL) {
 	    /*
-	     * Compute the pixel width of the current element.
+	     * In virtual mode, measuring every element would defeat the
+	     * purpose of fetching on demand, so estimate the widest element
+	     * from a spread of at most 100 samples across the list.
 	     */
 
-	    result = Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, i,
-		    &element);
-	    if (result != TCL_OK) {
-		continue;
+	    int step = (listPtr->nElements + 99) / 100;
+
+	    if (step < 1) {
+		step = 1;
+	    }
+	    ListboxWidthHistFree(listPtr);
+	    Tcl_Preserve(listPtr);
+	    for (i = 0; i < listPtr->nElements; i += step) {
+		element = ListboxGetItem(NULL, listPtr, i);
+		if (listPtr->flags & LISTBOX_DELETED) {
+		    Tcl_Release(listPtr);
+		    return;
+		}
+		if (element == NULL) {
+		    continue;
+		}
+		text = Tcl_GetStringFromObj(element, &textLength);
+		pixelWidth = Tk_TextWidth(listPtr->tkfont, text, textLength);
+		if (pixelWidth > listPtr->maxWidth) {
+		    listPtr->maxWidth = pixelWidth;
+		}
 	    }
-	    text = Tcl_GetStringFromObj(element, &textLength);
-	    Tk_GetFontMetrics(listPtr->tkfont, &fm);
-	    pixelWidth = Tk_TextWidth(listPtr->tkfont, text, textLength);
-	    if (pixelWidth > listPtr->maxWidth) {
-		listPtr->maxWidth = pixelWidth;
+	    Tcl_Release(listPtr);
+	} else {
+	    ListboxWidthHistReset(listPtr);
+	    for (i = 0; i < listPtr->nElements; i++) {
+		/*
+		 * Compute the pixel width of the current element.
+		 */
+
+		result = Tcl_ListObjIndex(listPtr->interp, listPtr->listObj,
+			i, &element);
+		if (result != TCL_OK) {
+		    continue;
+		}
+		text = Tcl_GetStringFromObj(element, &textLength);
+		Tk_GetFontMetrics(listPtr->tkfont, &fm);
+		pixelWidth = Tk_TextWidth(listPtr->tkfont, text, textLength);
+		ListboxWidthHistAdd(listPtr, pixelWidth);
 	    }
 	}
     }
@@ -2334,6 +2720,14 @@ ListboxInsertSubCmd(
     Tcl_Obj *newListObj;
     const char *stringRep;
 
+    if (listPtr->dataCmd != NULL) {
+	Tcl_SetObjResult(listPtr->interp, Tcl_NewStringObj(
+		"cannot insert into a listbox with -datacommand", -1));
+	Tcl_SetErrorCode(listPtr->interp, "TK", "LISTBOX", "DATACOMMAND",
+		NULL);
+	return TCL_ERROR;
+    }
+
     oldMaxWidth = listPtr->maxWidth;
     for (i = 0; i < objc; i++) {
 	/*
@@ -2343,9 +2737,7 @@ ListboxInsertSubCmd(
 
 	stringRep = Tcl_GetStringFromObj(objv[i], &length);
 	pixelWidth = Tk_TextWidth(listPtr->tkfont, stringRep, length);
-	if (pixelWidth > listPtr->maxWidth) {
-	    listPtr->maxWidth = pixelWidth;
-	}
+	ListboxWidthHistAdd(listPtr, pixelWidth);
     }
 
     /*
@@ -2444,12 +2836,20 @@ ListboxDeleteSubCmd(
     int first,			/* Index of first element to delete. */
     int last)			/* Index of last element to delete. */
 {
-    int count, i, widthChanged, result, pixelWidth;
+    int count, i, widthChanged, oldMaxWidth, result, pixelWidth;
     TkSizeT length;
     Tcl_Obj *newListObj, *element;
     const char *stringRep;
     Tcl_HashEntry *entry;
 
+    if (listPtr->dataCmd != NULL) {
+	Tcl_SetObjResult(listPtr->interp, Tcl_NewStringObj(
+		"cannot delete from a listbox with -datacommand", -1));
+	Tcl_SetErrorCode(listPtr->interp, "TK", "LISTBOX", "DATACOMMAND",
+		NULL);
+	return TCL_ERROR;
+    }
+
     /*
      * Adjust the range to fit within the existing elements of the listbox,
      * and make sure there's something to delete.
@@ -2469,12 +2869,13 @@ ListboxDeleteSubCmd(
     /*
      * Foreach deleted index we must:
      * a) remove selection information,
-     * b) check the width of the element; if it is equal to the max, set
-     *    widthChanged to 1, because it may be the only element with that
-     *    width.
+     * b) remove the element's pixel width from the width histogram, which
+     *    keeps maxWidth current; if the histogram has been discarded,
+     *    widthChanged is set to force a full rescan below.
      */
 
     widthChanged = 0;
+    oldMaxWidth = listPtr->maxWidth;
     for (i = first; i <= last; i++) {
 	/*
 	 * Remove selection information.
@@ -2493,16 +2894,17 @@ ListboxDeleteSubCmd(
 	}
 
 	/*
-	 * Check width of the element. We only have to check if widthChanged
-	 * has not already been set to 1, because we only need one maxWidth
-	 * element to disappear for us to have to recompute the width.
+	 * Remove the element's pixel width from the histogram, which keeps
+	 * maxWidth current without rescanning. If the histogram cannot
+	 * handle the removal a full rescan is forced below, and further
+	 * measuring here would be wasted work.
 	 */
 
-	if (widthChanged == 0) {
+	if ((listPtr->widthHist != NULL) || (widthChanged == 0)) {
 	    Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, i, &element);
 	    stringRep = Tcl_GetStringFromObj(element, &length);
 	    pixelWidth = Tk_TextWidth(listPtr->tkfont, stringRep, length);
-	    if (pixelWidth == listPtr->maxWidth) {
+	    if (!ListboxWidthHistRemove(listPtr, pixelWidth)) {
 		widthChanged = 1;
 	    }
 	}
@@ -2588,7 +2990,7 @@ ListboxDeleteSubCmd(
     }
     listPtr->flags |= UPDATE_V_SCROLLBAR;
     ListboxComputeGeometry(listPtr, 0, widthChanged, 0);
-    if (widthChanged) {
+    if (widthChanged || (listPtr->maxWidth != oldMaxWidth)) {
 	listPtr->flags |= UPDATE_H_SCROLLBAR;
     }
     EventuallyRedrawRange(listPtr, first, listPtr->nElements-1);
@@ -3146,8 +3548,20 @@ ListboxFetchSelection(
 	    if (needNewline) {
 		Tcl_DStringAppend(&selection, "\n", 1);
 	    }
-	    Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, i,
-		    &curElement);
+	    if (listPtr->dataCmd != NULL) {
+		Tcl_Preserve(listPtr);
+		curElement = ListboxGetItem(NULL, listPtr, i);
+		if ((curElement == NULL)
+			|| (listPtr->flags & LISTBOX_DELETED)) {
+		    Tcl_Release(listPtr);
+		    Tcl_DStringFree(&selection);
+		    return -1;
+		}
+		Tcl_Release(listPtr);
+	    } else {
+		Tcl_ListObjIndex(listPtr->interp, listPtr->listObj, i,
+			&curElement);
+	    }
 	    stringRep = Tcl_GetStringFromObj(curElement, &stringLen);
 	    Tcl_DStringAppend(&selection, stringRep, stringLen);
 	    needNewline = 1;
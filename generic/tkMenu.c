@@ -1500,6 +1500,7 @@ MenuWorldChanged(
     	TkMenuConfigureEntryDrawOptions(menuPtr->entries[i],
 		menuPtr->entries[i]->index);
 	TkpConfigureMenuEntry(menuPtr->entries[i]);
+	menuPtr->entries[i]->entryFlags &= ~ENTRY_GEOM_CACHED;
     }
     TkEventuallyRecomputeMenu(menuPtr);
 }
@@ -1944,6 +1945,7 @@ ConfigureMenuEntry(
 	    PostProcessEntry(mePtr);
 	}
 	Tk_FreeSavedOptions(&errorStruct);
+	mePtr->entryFlags &= ~ENTRY_GEOM_CACHED;
     }
 
     TkEventuallyRecomputeMenu(menuPtr);
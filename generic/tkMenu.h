@@ -129,6 +129,16 @@ typedef struct TkMenuEntry {
 				 * entry. */
     int labelWidth;		/* Number of pixels to allow for displaying
 				 * labels in menu entries. */
+    int labelReqWidth;		/* Measured size of this entry's label,
+				 * cached so that recomputing the menu layout
+				 * only re-measures entries that have
+				 * actually changed. Only valid when
+				 * ENTRY_GEOM_CACHED is set in entryFlags. */
+    int labelReqHeight;		/* Measured height of the label. */
+    int accelReqWidth;		/* Measured size of the accelerator. */
+    int accelReqHeight;
+    int indicReqWidth;		/* Measured size of the indicator. */
+    int indicReqHeight;
     int compound;		/* Value of -compound option; specifies
 				 * whether the entry should show both an image
 				 * and text, and, if so, how. */
@@ -215,6 +225,11 @@ typedef struct TkMenuEntry {
  * ENTRY_LAST_COLUMN:		Used by the drawing code. If the entry is in
  *				the last column, the space to its right needs
  *				to be filled.
+ * ENTRY_GEOM_CACHED:		Non-zero means the labelReq/accelReq/indicReq
+ *				fields hold valid measurements for the
+ *				entry's current configuration, so layout can
+ *				skip re-measuring it. Cleared whenever the
+ *				entry is (re)configured or fonts change.
  * ENTRY_PLATFORM_FLAG1 - 4	These flags are reserved for use by the
  *				platform-dependent implementation of menus
  *				and should not be used by anything else.
@@ -223,6 +238,7 @@ typedef struct TkMenuEntry {
 #define ENTRY_SELECTED		1
 #define ENTRY_NEEDS_REDISPLAY	2
 #define ENTRY_LAST_COLUMN	4
+#define ENTRY_GEOM_CACHED	8
 #define ENTRY_PLATFORM_FLAG1	(1 << 30)
 #define ENTRY_PLATFORM_FLAG2	(1 << 29)
 #define ENTRY_PLATFORM_FLAG3	(1 << 28)
@@ -315,6 +331,14 @@ typedef struct TkMenu {
 
     int totalWidth;		/* Width of entire menu. */
     int totalHeight;		/* Height of entire menu. */
+    Pixmap prerenderPixmap;	/* Off-screen rendering of the entire menu,
+				 * prepared at idle time while the menu is
+				 * unposted, or None. Copied to the window by
+				 * the first redisplay after the menu is
+				 * posted, so that posting doesn't have to
+				 * draw every entry synchronously. */
+    int prerenderWidth;		/* Dimensions of prerenderPixmap. Only */
+    int prerenderHeight;	/* meaningful when it is not None. */
 
     /*
      * Miscellaneous information:
@@ -439,6 +463,10 @@ typedef struct TkMenuReferences {
  *				menu (via a destroy binding or somesuch).
  * MENU_WIN_DESTRUCTION_PENDING Non-zero means we are in the middle of
  *				destroying this menu's Tk_Window.
+ * PRERENDER_PENDING:		Non-zero means a DoWhenIdle handler has
+ *				already been queued to pre-render this menu
+ *				into an off-screen pixmap while it is
+ *				unposted.
  * MENU_PLATFORM_FLAG1...	Reserved for use by the platform-specific menu
  *				code.
  */
@@ -447,6 +475,7 @@ typedef struct TkMenuReferences {
 #define RESIZE_PENDING			2
 #define MENU_DELETION_PENDING		4
 #define MENU_WIN_DESTRUCTION_PENDING	8
+#define PRERENDER_PENDING		16
 #define MENU_PLATFORM_FLAG1	(1 << 30)
 #define MENU_PLATFORM_FLAG2	(1 << 29)
 #define MENU_PLATFORM_FLAG3	(1 << 28)
@@ -21,6 +21,10 @@ static void		AdjustMenuCoords(TkMenu *menuPtr, TkMenuEntry *mePtr,
 			    int *xPtr, int *yPtr);
 static void		ComputeMenuGeometry(ClientData clientData);
 static void		DisplayMenu(ClientData clientData);
+static void		DrawMenu(TkMenu *menuPtr, Drawable drawable,
+			    int width, int height, int drawAll);
+static void		EventuallyPrerenderMenu(TkMenu *menuPtr);
+static void		PrerenderMenu(ClientData clientData);
 
 /*
  *----------------------------------------------------------------------
@@ -50,6 +54,8 @@ TkMenuInitializeDrawingFields(
     menuPtr->indicatorGC = NULL;
     menuPtr->disabledImageGC = NULL;
     menuPtr->totalWidth = menuPtr->totalHeight = 0;
+    menuPtr->prerenderPixmap = None;
+    menuPtr->prerenderWidth = menuPtr->prerenderHeight = 0;
 }
 
 /*
@@ -124,6 +130,10 @@ TkMenuFreeDrawOptions(
     if (menuPtr->indicatorGC != NULL) {
 	Tk_FreeGC(menuPtr->display, menuPtr->indicatorGC);
     }
+    if (menuPtr->prerenderPixmap != None) {
+	Tk_FreePixmap(menuPtr->display, menuPtr->prerenderPixmap);
+	menuPtr->prerenderPixmap = None;
+    }
 }
 
 /*
@@ -499,8 +509,22 @@ TkEventuallyRedrawMenu(
 	    menuPtr->entries[i]->entryFlags |= ENTRY_NEEDS_REDISPLAY;
 	}
     }
-    if (!Tk_IsMapped(menuPtr->tkwin)
-	    || (menuPtr->menuFlags & REDRAW_PENDING)) {
+    if (!Tk_IsMapped(menuPtr->tkwin)) {
+	/*
+	 * The menu isn't posted, so there is nothing to paint right now.
+	 * Whatever changed has made any pre-rendered image stale, though, so
+	 * throw it away and arrange for a fresh one to be prepared at idle
+	 * time; the next post will then only need to copy it.
+	 */
+
+	if (menuPtr->prerenderPixmap != None) {
+	    Tk_FreePixmap(menuPtr->display, menuPtr->prerenderPixmap);
+	    menuPtr->prerenderPixmap = None;
+	}
+	EventuallyPrerenderMenu(menuPtr);
+	return;
+    }
+    if (menuPtr->menuFlags & REDRAW_PENDING) {
 	return;
     }
     Tcl_DoWhenIdle(DisplayMenu, menuPtr);
@@ -604,49 +628,49 @@ TkMenuSelectImageProc(
 /*
  *----------------------------------------------------------------------
  *
- * DisplayMenu --
+ * DrawMenu --
  *
- *	This function is invoked to display a menu widget.
+ *	Draws a menu into the given drawable. Factored out of DisplayMenu so
+ *	that PrerenderMenu can draw into an off-screen pixmap as well.
  *
  * Results:
  *	None.
  *
  * Side effects:
  *	Commands are output to X to display the menu in its current mode.
+ *	Unless drawAll is set, entries without ENTRY_NEEDS_REDISPLAY are
+ *	skipped and the flag is cleared on the ones that are drawn.
  *
  *----------------------------------------------------------------------
  */
 
 static void
-DisplayMenu(
-    ClientData clientData)	/* Information about widget. */
+DrawMenu(
+    TkMenu *menuPtr,		/* Information about widget. */
+    Drawable drawable,		/* Window or pixmap to draw into. */
+    int width, int height,	/* Dimensions of the drawable. */
+    int drawAll)		/* Non-zero means draw every entry regardless
+				 * of its ENTRY_NEEDS_REDISPLAY flag, and
+				 * leave the flags alone. */
 {
-    TkMenu *menuPtr = (TkMenu *)clientData;
     TkMenuEntry *mePtr;
     Tk_Window tkwin = menuPtr->tkwin;
     TkSizeT index;
     int strictMotif;
     Tk_Font tkfont;
     Tk_FontMetrics menuMetrics;
-    int width;
     int borderWidth;
     Tk_3DBorder border;
     int relief;
 
-
-    menuPtr->menuFlags &= ~REDRAW_PENDING;
-    if ((menuPtr->tkwin == NULL) || !Tk_IsMapped(tkwin)) {
-	return;
-    }
-
     Tk_GetPixelsFromObj(NULL, menuPtr->tkwin, menuPtr->borderWidthPtr,
 	    &borderWidth);
     border = Tk_Get3DBorderFromObj(menuPtr->tkwin, menuPtr->borderPtr);
 
     if (menuPtr->menuType == MENUBAR) {
-	Tk_Fill3DRectangle(tkwin, Tk_WindowId(tkwin), border, borderWidth,
-		borderWidth, Tk_Width(tkwin) - 2 * borderWidth,
-		Tk_Height(tkwin) - 2 * borderWidth, 0, TK_RELIEF_FLAT);
+	Tk_Fill3DRectangle(tkwin, drawable, border, borderWidth,
+		borderWidth, width - 2 * borderWidth,
+		height - 2 * borderWidth, 0, TK_RELIEF_FLAT);
     }
 
     strictMotif = Tk_StrictMotif(menuPtr->tkwin);
@@ -665,14 +689,16 @@ DisplayMenu(
 
     for (index = 0; index < menuPtr->numEntries; index++) {
 	mePtr = menuPtr->entries[index];
-	if (menuPtr->menuType != MENUBAR) {
+	if ((menuPtr->menuType != MENUBAR) && !drawAll) {
 	    if (!(mePtr->entryFlags & ENTRY_NEEDS_REDISPLAY)) {
 		continue;
 	    }
 	}
-	mePtr->entryFlags &= ~ENTRY_NEEDS_REDISPLAY;
+	if (!drawAll) {
+	    mePtr->entryFlags &= ~ENTRY_NEEDS_REDISPLAY;
+	}
 
-	TkpDrawMenuEntry(mePtr, Tk_WindowId(menuPtr->tkwin), tkfont,
+	TkpDrawMenuEntry(mePtr, drawable, tkfont,
 		&menuMetrics, mePtr->x, mePtr->y, mePtr->width,
 		mePtr->height, strictMotif, 1);
 
@@ -683,9 +709,9 @@ DisplayMenu(
              * This has zero width except after menu resizing.
              */
 
-            Tk_Fill3DRectangle(tkwin, Tk_WindowId(tkwin), border,
+            Tk_Fill3DRectangle(tkwin, drawable, border,
                     mePtr->x + mePtr->width, mePtr->y,
-                    Tk_Width(tkwin) - mePtr->x - mePtr->width - borderWidth,
+                    width - mePtr->x - mePtr->width - borderWidth,
                     mePtr->height, 0, TK_RELIEF_FLAT);
         }
 
@@ -697,20 +723,20 @@ DisplayMenu(
              */
 
 	    mePtr = menuPtr->entries[index - 1];
-	    Tk_Fill3DRectangle(tkwin, Tk_WindowId(tkwin), border,
+	    Tk_Fill3DRectangle(tkwin, drawable, border,
 		mePtr->x, mePtr->y + mePtr->height, mePtr->width,
-		Tk_Height(tkwin) - mePtr->y - mePtr->height - borderWidth,
+		height - mePtr->y - mePtr->height - borderWidth,
 		0, TK_RELIEF_FLAT);
 	}
     }
 
     if (menuPtr->menuType != MENUBAR) {
-	int x, y, height;
+	int x, y, fillWidth, fillHeight;
 
 	if (menuPtr->numEntries == 0) {
 	    x = y = borderWidth;
-	    width = Tk_Width(tkwin) - 2 * borderWidth;
-	    height = Tk_Height(tkwin) - 2 * borderWidth;
+	    fillWidth = width - 2 * borderWidth;
+	    fillHeight = height - 2 * borderWidth;
 	} else {
 	    mePtr = menuPtr->entries[menuPtr->numEntries - 1];
 
@@ -718,14 +744,14 @@ DisplayMenu(
              * Paint the area under the last entry of the menu.
              */
 
-	    Tk_Fill3DRectangle(tkwin, Tk_WindowId(tkwin),
+	    Tk_Fill3DRectangle(tkwin, drawable,
 		border, mePtr->x, mePtr->y + mePtr->height, mePtr->width,
-		Tk_Height(tkwin) - mePtr->y - mePtr->height - borderWidth,
+		height - mePtr->y - mePtr->height - borderWidth,
 		0, TK_RELIEF_FLAT);
 	    x = mePtr->x + mePtr->width;
 	    y = mePtr->y + mePtr->height;
-	    width = Tk_Width(tkwin) - x - borderWidth;
-	    height = Tk_Height(tkwin) - y - borderWidth;
+	    fillWidth = width - x - borderWidth;
+	    fillHeight = height - y - borderWidth;
 	}
 
         /*
@@ -733,14 +759,173 @@ DisplayMenu(
          * This has zero width except after menu resizing.
          */
 
-	Tk_Fill3DRectangle(tkwin, Tk_WindowId(tkwin), border, x, y,
-		width, height, 0, TK_RELIEF_FLAT);
+	Tk_Fill3DRectangle(tkwin, drawable, border, x, y,
+		fillWidth, fillHeight, 0, TK_RELIEF_FLAT);
     }
 
     Tk_GetReliefFromObj(NULL, menuPtr->reliefPtr, &relief);
-    Tk_Draw3DRectangle(menuPtr->tkwin, Tk_WindowId(tkwin),
-	    border, 0, 0, Tk_Width(tkwin), Tk_Height(tkwin), borderWidth,
-	    relief);
+    Tk_Draw3DRectangle(menuPtr->tkwin, drawable,
+	    border, 0, 0, width, height, borderWidth, relief);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayMenu --
+ *
+ *	This function is invoked to display a menu widget.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Commands are output to X to display the menu in its current mode.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DisplayMenu(
+    ClientData clientData)	/* Information about widget. */
+{
+    TkMenu *menuPtr = (TkMenu *)clientData;
+    Tk_Window tkwin = menuPtr->tkwin;
+    TkSizeT i;
+
+    menuPtr->menuFlags &= ~REDRAW_PENDING;
+    if ((menuPtr->tkwin == NULL) || !Tk_IsMapped(tkwin)) {
+	return;
+    }
+
+    if (menuPtr->prerenderPixmap != None) {
+	if ((menuPtr->prerenderWidth == Tk_Width(tkwin))
+		&& (menuPtr->prerenderHeight == Tk_Height(tkwin))) {
+	    /*
+	     * The menu was rendered off-screen while it was unposted, so a
+	     * single copy brings the window up to date. The pixmap shows the
+	     * unposted state (no active entry), so it is discarded right away
+	     * and later activation changes are drawn directly; a fresh copy
+	     * is prepared once the menu is unposted again.
+	     */
+
+	    XCopyArea(menuPtr->display, menuPtr->prerenderPixmap,
+		    Tk_WindowId(tkwin), menuPtr->textGC, 0, 0,
+		    (unsigned) menuPtr->prerenderWidth,
+		    (unsigned) menuPtr->prerenderHeight, 0, 0);
+	    for (i = 0; i < menuPtr->numEntries; i++) {
+		menuPtr->entries[i]->entryFlags &= ~ENTRY_NEEDS_REDISPLAY;
+	    }
+	    Tk_FreePixmap(menuPtr->display, menuPtr->prerenderPixmap);
+	    menuPtr->prerenderPixmap = None;
+	    return;
+	}
+
+	/*
+	 * The window came up at a size other than the one the pixmap was
+	 * rendered for (the window manager had other ideas); the pixmap is
+	 * useless, so fall through to drawing directly.
+	 */
+
+	Tk_FreePixmap(menuPtr->display, menuPtr->prerenderPixmap);
+	menuPtr->prerenderPixmap = None;
+    }
+
+    DrawMenu(menuPtr, Tk_WindowId(tkwin), Tk_Width(tkwin), Tk_Height(tkwin),
+	    0);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * EventuallyPrerenderMenu --
+ *
+ *	Arrange for an unposted menu to be rendered into an off-screen pixmap
+ *	at idle time, so that posting it later is little more than a map and
+ *	raise. Does nothing for menubars (which are mapped by the window
+ *	manager, not posted) or for menus that are currently posted.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	A when-idle handler is scheduled to do the rendering, if there isn't
+ *	one already scheduled.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+EventuallyPrerenderMenu(
+    TkMenu *menuPtr)		/* Information about menu to pre-render. */
+{
+    if ((menuPtr->tkwin == NULL) || Tk_IsMapped(menuPtr->tkwin)
+	    || (menuPtr->menuType == MENUBAR)
+	    || (menuPtr->menuFlags & PRERENDER_PENDING)) {
+	return;
+    }
+    Tcl_DoWhenIdle(PrerenderMenu, menuPtr);
+    menuPtr->menuFlags |= PRERENDER_PENDING;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * PrerenderMenu --
+ *
+ *	This function is invoked at idle time to realize an unposted menu's
+ *	window and render all of its entries into a retained pixmap. Creating
+ *	the window and drawing every entry are the expensive parts of posting
+ *	a menu (painfully so on remote displays); doing them here means the
+ *	first redisplay after posting is a single XCopyArea.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The menu's X window is created if it didn't exist yet, and
+ *	menuPtr->prerenderPixmap is (re)filled with an image of the menu.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+PrerenderMenu(
+    ClientData clientData)	/* Information about widget. */
+{
+    TkMenu *menuPtr = (TkMenu *)clientData;
+    Tk_Window tkwin = menuPtr->tkwin;
+    int width, height;
+
+    menuPtr->menuFlags &= ~PRERENDER_PENDING;
+    if ((tkwin == NULL) || Tk_IsMapped(tkwin)
+	    || (menuPtr->menuType == MENUBAR)) {
+	return;
+    }
+
+    /*
+     * If a geometry recomputation is still pending then the entry layout
+     * isn't final; ComputeMenuGeometry will reschedule us when it is.
+     */
+
+    if (menuPtr->menuFlags & RESIZE_PENDING) {
+	return;
+    }
+
+    Tk_MakeWindowExist(tkwin);
+    width = Tk_ReqWidth(tkwin);
+    height = Tk_ReqHeight(tkwin);
+    if ((width <= 0) || (height <= 0)) {
+	return;
+    }
+
+    if (menuPtr->prerenderPixmap != None) {
+	Tk_FreePixmap(menuPtr->display, menuPtr->prerenderPixmap);
+    }
+    menuPtr->prerenderPixmap = Tk_GetPixmap(menuPtr->display,
+	    Tk_WindowId(tkwin), width, height, Tk_Depth(tkwin));
+    menuPtr->prerenderWidth = width;
+    menuPtr->prerenderHeight = height;
+    DrawMenu(menuPtr, menuPtr->prerenderPixmap, width, height, 1);
 }
 
 /*
@@ -773,6 +958,13 @@ TkMenuEventProc(
     } else if (eventPtr->type == ConfigureNotify) {
 	TkEventuallyRecomputeMenu(menuPtr);
 	TkEventuallyRedrawMenu(menuPtr, NULL);
+    } else if (eventPtr->type == UnmapNotify) {
+	/*
+	 * The menu was just unposted. Prepare a fresh off-screen rendering
+	 * so that the next post only has to map, raise and copy.
+	 */
+
+	EventuallyPrerenderMenu(menuPtr);
     } else if (eventPtr->type == ActivateNotify) {
 	if (menuPtr->menuType == TEAROFF_MENU) {
 	    TkpSetMainMenubar(menuPtr->interp, menuPtr->tkwin, NULL);
@@ -800,6 +992,10 @@ TkMenuEventProc(
 	    Tcl_CancelIdleCall(ComputeMenuGeometry, menuPtr);
 	    menuPtr->menuFlags &= ~RESIZE_PENDING;
 	}
+	if (menuPtr->menuFlags & PRERENDER_PENDING) {
+	    Tcl_CancelIdleCall(PrerenderMenu, menuPtr);
+	    menuPtr->menuFlags &= ~PRERENDER_PENDING;
+	}
 	Tcl_EventuallyFree(menuPtr, TCL_DYNAMIC);
     }
 }
@@ -839,6 +1035,7 @@ TkMenuImageProc(
     (void)imgWidth;
     (void)imgHeight;
 
+    ((TkMenuEntry *) clientData)->entryFlags &= ~ENTRY_GEOM_CACHED;
     if ((menuPtr->tkwin != NULL) && !(menuPtr->menuFlags & RESIZE_PENDING)) {
 	menuPtr->menuFlags |= RESIZE_PENDING;
 	Tcl_DoWhenIdle(ComputeMenuGeometry, menuPtr);
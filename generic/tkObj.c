@@ -15,11 +15,25 @@
  * The following structure is the internal representation for pixel objects.
  */
 
+#define PIXEL_CACHE_SIZE 4
+
+typedef struct PixelCacheEntry {
+    Screen *screen;		/* Screen the conversion was made for;
+				 * NULL if the slot is unused. */
+    int scalingEpoch;		/* Value of the display's scalingEpoch when
+				 * the conversion was made; a mismatch means
+				 * [tk scaling] has changed the ratio since
+				 * then and the entry no longer applies. */
+    double dblValue;		/* Converted value, in pixels */
+    int intValue;		/* dblValue rounded to an integer */
+} PixelCacheEntry;
+
 typedef struct PixelRep {
     double value;
     int units;
-    Tk_Window tkwin;
-    int returnValue;
+    PixelCacheEntry cache[PIXEL_CACHE_SIZE];
+				/* Per-screen conversions, in
+				 * most-recently-used order. */
 } PixelRep;
 
 #define SIMPLE_PIXELREP(objPtr)				\
@@ -86,6 +100,7 @@ typedef struct WindowRep {
  * Prototypes for functions defined later in this file:
  */
 
+static void		DupEnumInternalRep(Tcl_Obj *srcPtr, Tcl_Obj *copyPtr);
 static void		DupMMInternalRep(Tcl_Obj *srcPtr, Tcl_Obj *copyPtr);
 static void		DupPixelInternalRep(Tcl_Obj *srcPtr, Tcl_Obj*copyPtr);
 static void		DupWindowInternalRep(Tcl_Obj *srcPtr,Tcl_Obj*copyPtr);
@@ -167,6 +182,23 @@ static const Tcl_ObjType windowObjType = {
     NULL,			/* updateStringProc */
     NULL			/* setFromAnyProc */
 };
+
+/*
+ * The following structure defines the implementation of the "enum" Tcl
+ * object, used by TkGetEnumFromObj to cache the index of a keyword within
+ * the string table it was resolved against.  The internalRep.twoPtrValue
+ * fields hold the table pointer and the index.  Unlike Tcl's own index
+ * type, the table pointer is part of the cache key, so values that are
+ * alternately interpreted against several tables keep a valid cache.
+ */
+
+static const Tcl_ObjType enumObjType = {
+    "enum",			/* name */
+    NULL,			/* freeIntRepProc */
+    DupEnumInternalRep,		/* dupIntRepProc */
+    NULL,			/* updateStringProc */
+    NULL			/* setFromAnyProc */
+};
 
 /*
  *----------------------------------------------------------------------
@@ -289,7 +321,7 @@ GetPixelsFromObjEx(
     int *intPtr,
     double *dblPtr)		/* Places to store resulting pixels. */
 {
-    int result, fresh;
+    int result;
     double d;
     PixelRep *pixelPtr;
     static const double bias[] = {
@@ -322,9 +354,7 @@ GetPixelsFromObjEx(
 	}
     }
 
- retry:
-    fresh = (objPtr->typePtr != &pixelObjType);
-    if (fresh) {
+    if (objPtr->typePtr != &pixelObjType) {
 	result = SetPixelFromAny(interp, objPtr);
 	if (result != TCL_OK) {
 	    return result;
@@ -337,29 +367,52 @@ GetPixelsFromObjEx(
 	    *dblPtr = (double) (*intPtr);
 	}
     } else {
+	Screen *screen = Tk_Screen(tkwin);
+	int epoch = ((TkWindow *) tkwin)->dispPtr->scalingEpoch;
+	int i;
+
 	pixelPtr = GET_COMPLEXPIXEL(objPtr);
-	if ((!fresh) && (pixelPtr->tkwin != tkwin)) {
+	for (i = 0; i < PIXEL_CACHE_SIZE; i++) {
+	    if ((pixelPtr->cache[i].screen == screen)
+		    && (pixelPtr->cache[i].scalingEpoch == epoch)) {
+		break;
+	    }
+	}
+	if (i == PIXEL_CACHE_SIZE) {
 	    /*
-	     * In the case of exo-screen conversions of non-pixels, we force a
-	     * recomputation from the string.
+	     * Not converted for this screen at the current scaling yet; do
+	     * so now, evicting the least recently used cache entry.  The
+	     * original value and units are display-independent, so no
+	     * recomputation from the string is needed.
 	     */
 
-	    FreePixelInternalRep(objPtr);
-	    goto retry;
-	}
-	if ((pixelPtr->tkwin != tkwin) || dblPtr) {
 	    d = pixelPtr->value;
 	    if (pixelPtr->units >= 0) {
-		d *= bias[pixelPtr->units] * WidthOfScreen(Tk_Screen(tkwin));
-		d /= WidthMMOfScreen(Tk_Screen(tkwin));
-	    }
-	    pixelPtr->returnValue = (int) (d<0 ? d-0.5 : d+0.5);
-	    pixelPtr->tkwin = tkwin;
-	    if (dblPtr) {
-		*dblPtr = d;
+		d *= bias[pixelPtr->units] * WidthOfScreen(screen);
+		d /= WidthMMOfScreen(screen);
 	    }
+	    i--;
+	    pixelPtr->cache[i].screen = screen;
+	    pixelPtr->cache[i].scalingEpoch = epoch;
+	    pixelPtr->cache[i].dblValue = d;
+	    pixelPtr->cache[i].intValue = (int) (d<0 ? d-0.5 : d+0.5);
+	}
+	if (i > 0) {
+	    /*
+	     * Move to the front, keeping the entries in MRU order.
+	     */
+
+	    PixelCacheEntry entry = pixelPtr->cache[i];
+
+	    memmove(pixelPtr->cache + 1, pixelPtr->cache,
+		    i * sizeof(PixelCacheEntry));
+	    pixelPtr->cache[0] = entry;
+	    i = 0;
+	}
+	*intPtr = pixelPtr->cache[0].intValue;
+	if (dblPtr) {
+	    *dblPtr = pixelPtr->cache[0].dblValue;
 	}
-	*intPtr = pixelPtr->returnValue;
     }
     return TCL_OK;
 }
@@ -430,18 +483,14 @@ Tk_GetDoublePixelsFromObj(
     if (result != TCL_OK) {
 	return result;
     }
-    if (objPtr->typePtr == &pixelObjType && !SIMPLE_PIXELREP(objPtr)) {
-	PixelRep *pixelPtr = GET_COMPLEXPIXEL(objPtr);
 
-	if (pixelPtr->units >= 0) {
-	    /*
-	     * Internally "shimmer" to pixel units.
-	     */
+    /*
+     * There is no need to convert the internal rep to pixel units here:
+     * the per-screen cache already makes repeated queries cheap, and
+     * keeping the original units preserves correct conversions for
+     * other screens.
+     */
 
-	    pixelPtr->units = -1;
-	    pixelPtr->value = d;
-	}
-    }
     *doublePtr = d;
     return TCL_OK;
 }
@@ -509,10 +558,7 @@ DupPixelInternalRep(
 
 	oldPtr = GET_COMPLEXPIXEL(srcPtr);
 	newPtr = (PixelRep *)ckalloc(sizeof(PixelRep));
-	newPtr->value = oldPtr->value;
-	newPtr->units = oldPtr->units;
-	newPtr->tkwin = oldPtr->tkwin;
-	newPtr->returnValue = oldPtr->returnValue;
+	memcpy(newPtr, oldPtr, sizeof(PixelRep));
 	SET_COMPLEXPIXEL(copyPtr, newPtr);
     }
 }
@@ -596,8 +642,7 @@ SetPixelFromAny(
 
 	pixelPtr->value = d;
 	pixelPtr->units = units;
-	pixelPtr->tkwin = NULL;
-	pixelPtr->returnValue = i;
+	memset(pixelPtr->cache, 0, sizeof(pixelPtr->cache));
 	SET_COMPLEXPIXEL(objPtr, pixelPtr);
     }
     return TCL_OK;
@@ -931,18 +976,33 @@ TkGetWindowFromObj(
 	    || winPtr->mainPtr != mainPtr
 	    || winPtr->epoch != mainPtr->deletionEpoch) {
 	/*
-	 * Cache is invalid.
+	 * Cache is invalid. A stale deletion epoch alone does not mean the
+	 * cached window is gone, though: deleting any window in the
+	 * application bumps the epoch. Check the cached pointer against the
+	 * table of live windows, so that cached representations survive
+	 * deletions of unrelated windows. The name comparison catches the
+	 * case where the address has been reused for a different window (in
+	 * which case a window of the same name is the right answer anyway).
 	 */
 
-	winPtr->tkwin = Tk_NameToWindow(interp,
-		Tcl_GetString(objPtr), tkwin);
-	if (winPtr->tkwin == NULL) {
-	    /* ASSERT: Tk_NameToWindow has left error message in interp */
-	    return TCL_ERROR;
-	}
+	if (winPtr->tkwin != NULL && winPtr->mainPtr == mainPtr
+		&& Tcl_FindHashEntry(&mainPtr->liveWindowTable,
+			(char *) winPtr->tkwin) != NULL
+		&& ((TkWindow *) winPtr->tkwin)->pathName != NULL
+		&& strcmp(((TkWindow *) winPtr->tkwin)->pathName,
+			Tcl_GetString(objPtr)) == 0) {
+	    winPtr->epoch = mainPtr->deletionEpoch;
+	} else {
+	    winPtr->tkwin = Tk_NameToWindow(interp,
+		    Tcl_GetString(objPtr), tkwin);
+	    if (winPtr->tkwin == NULL) {
+		/* ASSERT: Tk_NameToWindow has left error message in interp */
+		return TCL_ERROR;
+	    }
 
-	winPtr->mainPtr = mainPtr;
-	winPtr->epoch = mainPtr ? mainPtr->deletionEpoch : 0;
+	    winPtr->mainPtr = mainPtr;
+	    winPtr->epoch = mainPtr ? mainPtr->deletionEpoch : 0;
+	}
     }
 
     *windowPtr = winPtr->tkwin;
@@ -1201,6 +1261,100 @@ TkParsePadAmount(
     return TCL_OK;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkGetEnumFromObj --
+ *
+ *	Resolve an object against a NULL-terminated table of keyword strings
+ *	and return the index of the matching entry, caching the result in
+ *	the object so that repeated resolution of the same value against the
+ *	same table costs a pair of pointer comparisons.
+ *
+ * Results:
+ *	The return value is a standard Tcl result.  On success *indexPtr is
+ *	set to the index of the matching table entry; unique abbreviations
+ *	are accepted.  On error a message built from msg is left in the
+ *	interpreter's result unless interp is NULL.
+ *
+ * Side effects:
+ *	The object's internal representation is replaced with one recording
+ *	the table and index.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkGetEnumFromObj(
+    Tcl_Interp *interp,		/* Used for error reporting. May be NULL. */
+    Tcl_Obj *objPtr,		/* The object we are trying to get the value
+				 * from. */
+    const char *const *tablePtr,/* NULL-terminated table of keyword
+				 * strings. */
+    const char *msg,		/* What the keyword names, for the error
+				 * message. */
+    int *indexPtr)		/* Where to place the index of the matching
+				 * table entry. */
+{
+    int index, code;
+
+    if ((objPtr->typePtr == &enumObjType)
+	    && (objPtr->internalRep.twoPtrValue.ptr1 == (void *) tablePtr)) {
+	*indexPtr = (int) PTR2INT(objPtr->internalRep.twoPtrValue.ptr2);
+	return TCL_OK;
+    }
+
+    code = Tcl_GetIndexFromObjStruct(interp, objPtr, tablePtr,
+	    sizeof(char *), msg, 0, &index);
+    if (code != TCL_OK) {
+	return code;
+    }
+
+    /*
+     * Re-key the cache on our own type.  Tcl's index type caches against a
+     * single table, so a value that is alternately interpreted against two
+     * tables (such as "center" used both as an anchor and as a
+     * justification) would be re-compared on every use.
+     */
+
+    if ((objPtr->typePtr != NULL)
+	    && (objPtr->typePtr->freeIntRepProc != NULL)) {
+	objPtr->typePtr->freeIntRepProc(objPtr);
+    }
+    objPtr->internalRep.twoPtrValue.ptr1 = (void *) tablePtr;
+    objPtr->internalRep.twoPtrValue.ptr2 = INT2PTR(index);
+    objPtr->typePtr = &enumObjType;
+    *indexPtr = index;
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DupEnumInternalRep --
+ *
+ *	Initialize the internal representation of an "enum" Tcl_Obj to a
+ *	copy of the internal representation of an existing object.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	copyPtr's internal rep is set to the table and index recorded in
+ *	srcPtr's internal rep.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DupEnumInternalRep(
+    Tcl_Obj *srcPtr,		/* Object with internal rep to copy. */
+    Tcl_Obj *copyPtr)		/* Object with internal rep to set. */
+{
+    copyPtr->internalRep = srcPtr->internalRep;
+    copyPtr->typePtr = srcPtr->typePtr;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -1225,10 +1379,12 @@ TkRegisterObjTypes(void)
     Tcl_RegisterObjType(&tkBitmapObjType);
     Tcl_RegisterObjType(&tkColorObjType);
     Tcl_RegisterObjType(&tkCursorObjType);
+    Tcl_RegisterObjType(&enumObjType);
     Tcl_RegisterObjType(&tkFontObjType);
     Tcl_RegisterObjType(&mmObjType);
     Tcl_RegisterObjType(&pixelObjType);
     Tcl_RegisterObjType(&tkStateKeyObjType);
+    Tcl_RegisterObjType(&tkUidObjType);
     Tcl_RegisterObjType(&windowObjType);
     Tcl_RegisterObjType(&tkTextIndexType);
 }
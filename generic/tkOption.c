@@ -204,9 +204,26 @@ typedef struct {
 				 * priority level. */
     Element defaultMatch;	/* Special "no match" Element to use as
 				 * default for searches.*/
+    Tcl_HashTable memoTable;	/* Maps query signature strings (application,
+				 * name/class uids of the window's ancestry,
+				 * option name and class) to resolved values
+				 * (Tk_Uid, possibly NULL). */
+    int dbEpoch;		/* Incremented whenever any option database in
+				 * this thread changes. */
+    int memoEpoch;		/* Value of dbEpoch when memoTable was last
+				 * emptied; when it lags dbEpoch the table
+				 * contents are stale and must be flushed. */
 } ThreadSpecificData;
 static Tcl_ThreadDataKey dataKey;
 
+/*
+ * Cap on the number of memoized query results; when it is reached the table
+ * is emptied wholesale, which keeps memory bounded in applications that keep
+ * creating windows with fresh path names.
+ */
+
+#define OPTION_MEMO_MAX_SIZE 2048
+
 /*
  * Forward declarations for functions defined in this file:
  */
@@ -270,6 +287,7 @@ Tk_AddOption(
 	OptionInit(winPtr->mainPtr);
     }
     tsdPtr->cachedWindow = NULL;/* Invalidate the cache. */
+    tsdPtr->dbEpoch++;		/* Invalidate memoized query results. */
 
     /*
      * Compute the priority for the new element, including both the overall
@@ -411,6 +429,8 @@ Tk_GetOption(
     int count;
     StackLevel *levelPtr;
     int stackDepth[NUM_STACKS];
+    TkWindow *winPtr = (TkWindow *) tkwin;
+    Tcl_HashEntry *memoPtr = NULL;
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
 	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
@@ -419,6 +439,47 @@ Tk_GetOption(
      * SetupStacks call below (squeeze out those nanoseconds).
      */
 
+    /*
+     * Check for a memoized result first.  The outcome of a query depends
+     * only on the option database contents and on the names and classes of
+     * the window and its ancestors, so the memo key is built from those
+     * (as interned uid pointers, which is both exact and cheap) and the
+     * table is emptied whenever the database changes.  This answers repeat
+     * queries from short-lived windows such as tooltips without rebuilding
+     * the option stacks for each new window.
+     */
+
+    if (tsdPtr->initialized && (winPtr->mainPtr->optionRootPtr != NULL)) {
+	Tcl_DString keyDs;
+	TkWindow *ancestorPtr;
+	char buf[3*24];
+	int isNew;
+
+	if ((tsdPtr->memoEpoch != tsdPtr->dbEpoch)
+		|| (tsdPtr->memoTable.numEntries >= OPTION_MEMO_MAX_SIZE)) {
+	    Tcl_DeleteHashTable(&tsdPtr->memoTable);
+	    Tcl_InitHashTable(&tsdPtr->memoTable, TCL_STRING_KEYS);
+	    tsdPtr->memoEpoch = tsdPtr->dbEpoch;
+	}
+	Tcl_DStringInit(&keyDs);
+	sprintf(buf, "%p %p %p", (void *) winPtr->mainPtr,
+		(void *) Tk_GetUid(name),
+		(className != NULL) ? (void *) Tk_GetUid(className) : NULL);
+	Tcl_DStringAppend(&keyDs, buf, -1);
+	for (ancestorPtr = winPtr; ancestorPtr != NULL;
+		ancestorPtr = ancestorPtr->parentPtr) {
+	    sprintf(buf, " %p %p", (void *) ancestorPtr->nameUid,
+		    (void *) ancestorPtr->classUid);
+	    Tcl_DStringAppend(&keyDs, buf, -1);
+	}
+	memoPtr = Tcl_CreateHashEntry(&tsdPtr->memoTable,
+		Tcl_DStringValue(&keyDs), &isNew);
+	Tcl_DStringFree(&keyDs);
+	if (!isNew) {
+	    return (Tk_Uid) Tcl_GetHashValue(memoPtr);
+	}
+    }
+
     if (tkwin != (Tk_Window) tsdPtr->cachedWindow) {
 	SetupStacks((TkWindow *) tkwin, 1);
     }
@@ -588,6 +649,9 @@ Tk_GetOption(
 	}
     }
 
+    if (memoPtr != NULL) {
+	Tcl_SetHashValue(memoPtr, bestPtr->child.valueUid);
+    }
     return bestPtr->child.valueUid;
 }
 
@@ -672,6 +736,7 @@ Tk_OptionObjCmd(
 	    mainPtr->optionRootPtr = NULL;
 	}
 	tsdPtr->cachedWindow = NULL;
+	tsdPtr->dbEpoch++;
 	break;
     }
 
@@ -752,13 +817,39 @@ TkOptionDeadWindow(
      */
 
     if (tsdPtr->initialized && (winPtr->optionLevel != -1)) {
-	int i;
+	int i, j, *basePtr;
+	ElArray *arrayPtr;
+
+	/*
+	 * Rather than discarding the stacks wholesale, pop them back to the
+	 * deepest surviving ancestor of the dead window (the same partial
+	 * flush that TkOptionClassChanged does).  The retained levels serve
+	 * the next window created under the same ancestors, so transient
+	 * windows such as tooltips and menus do not force a full stack
+	 * rebuild on every create/destroy cycle.
+	 */
 
 	for (i = 1; i <= tsdPtr->curLevel; i++) {
-	    tsdPtr->levels[i].winPtr->optionLevel = -1;
+	    if (tsdPtr->levels[i].winPtr == winPtr) {
+		for (j = i; j <= tsdPtr->curLevel; j++) {
+		    tsdPtr->levels[j].winPtr->optionLevel = -1;
+		}
+		tsdPtr->curLevel = i-1;
+		basePtr = tsdPtr->levels[i].bases;
+		for (j = 0; j < NUM_STACKS; j++) {
+		    arrayPtr = tsdPtr->stacks[j];
+		    arrayPtr->numUsed = basePtr[j];
+		    arrayPtr->nextToUse = &arrayPtr->els[arrayPtr->numUsed];
+		}
+		if (tsdPtr->curLevel <= 0) {
+		    tsdPtr->cachedWindow = NULL;
+		} else {
+		    tsdPtr->cachedWindow =
+			    tsdPtr->levels[tsdPtr->curLevel].winPtr;
+		}
+		break;
+	    }
 	}
-	tsdPtr->curLevel = -1;
-	tsdPtr->cachedWindow = NULL;
     }
 
     /*
@@ -769,6 +860,7 @@ TkOptionDeadWindow(
 	    && (winPtr->mainPtr->optionRootPtr != NULL)) {
 	ClearOptionTree(winPtr->mainPtr->optionRootPtr);
 	winPtr->mainPtr->optionRootPtr = NULL;
+	tsdPtr->dbEpoch++;
     }
 }
 
@@ -1432,6 +1524,7 @@ OptionThreadExitProc(
 	    ckfree(tsdPtr->stacks[i]);
 	}
 	ckfree(tsdPtr->levels);
+	Tcl_DeleteHashTable(&tsdPtr->memoTable);
 	tsdPtr->initialized = 0;
     }
 }
@@ -1485,6 +1578,8 @@ OptionInit(
 	defaultMatchPtr->child.valueUid = NULL;
 	defaultMatchPtr->priority = -1;
 	defaultMatchPtr->flags = 0;
+	Tcl_InitHashTable(&tsdPtr->memoTable, TCL_STRING_KEYS);
+	tsdPtr->memoEpoch = tsdPtr->dbEpoch;
 	Tcl_CreateThreadExitHandler(OptionThreadExitProc, NULL);
     }
 
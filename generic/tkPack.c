@@ -56,6 +56,16 @@ typedef struct Packer {
     int doubleBw;		/* Twice the window's last known border width.
 				 * If this changes, the window must be
 				 * repacked within its container. */
+    int lastWidth, lastHeight;	/* Dimensions of this window the last time its
+				 * content was arranged. Used together with
+				 * LAYOUT_VALID to skip repacks whose inputs
+				 * have not changed. */
+    int lastBorderLeft, lastBorderRight;
+    int lastBorderTop, lastBorderBottom;
+				/* Internal border widths of this window the
+				 * last time its content was arranged. */
+    int lastMapped;		/* Non-zero means this window was mapped the
+				 * last time its content was arranged. */
     int *abortPtr;		/* If non-NULL, it means that there is a
 				 * nested call to ArrangePacking already
 				 * working on this window. *abortPtr may be
@@ -89,6 +99,11 @@ typedef struct Packer {
  *				needs of its content.
  * ALLOCED_CONTAINER	1 means that Pack has allocated itself as
  *				geometry container for this window.
+ * LAYOUT_VALID:		1 means the last ArrangePacking call for this
+ *				window ran to completion and the "last*"
+ *				fields above still describe the window, so a
+ *				repack may be skipped if nothing else has
+ *				changed since then.
  */
 
 #define REQUESTED_REPACK	1
@@ -98,6 +113,7 @@ typedef struct Packer {
 #define OLD_STYLE		16
 #define DONT_PROPAGATE		32
 #define ALLOCED_CONTAINER	64
+#define LAYOUT_VALID		128
 
 /*
  * The following structure is the official type record for the packer:
@@ -428,12 +444,14 @@ Tk_PackObjCmd(
 	     * propagate upwards to the container's container.
 	     */
 
+	    containerPtr->flags &= ~LAYOUT_VALID;
 	    if (containerPtr->abortPtr != NULL) {
 		*containerPtr->abortPtr = 1;
 	    }
 	    if (!(containerPtr->flags & REQUESTED_REPACK)) {
 		containerPtr->flags |= REQUESTED_REPACK;
-		Tcl_DoWhenIdle(ArrangePacking, containerPtr);
+		TkScheduleLayout(containerPtr->tkwin, ArrangePacking,
+			containerPtr);
 	    }
 	} else {
 	    if (containerPtr->flags & ALLOCED_CONTAINER) {
@@ -525,9 +543,10 @@ PackReqProc(
     Packer *packPtr = (Packer *)clientData;
 
     packPtr = packPtr->containerPtr;
+    packPtr->flags &= ~LAYOUT_VALID;
     if (!(packPtr->flags & REQUESTED_REPACK)) {
 	packPtr->flags |= REQUESTED_REPACK;
-	Tcl_DoWhenIdle(ArrangePacking, packPtr);
+	TkScheduleLayout(packPtr->tkwin, ArrangePacking, packPtr);
     }
 }
 
@@ -617,6 +636,32 @@ ArrangePacking(
 	return;
     }
 
+    /*
+     * Skip the repack entirely if its inputs are unchanged: the previous
+     * arrangement ran to completion, no content has changed its requested
+     * geometry or packing options since then, and the container's size,
+     * internal borders and mapped state are all as they were. This makes
+     * repacks triggered by ConfigureNotify events that merely move the
+     * container (or re-report an unchanged size) free.
+     */
+
+    if ((containerPtr->flags & LAYOUT_VALID)
+	    && (Tk_Width(containerPtr->tkwin) == containerPtr->lastWidth)
+	    && (Tk_Height(containerPtr->tkwin) == containerPtr->lastHeight)
+	    && (Tk_InternalBorderLeft(containerPtr->tkwin)
+		    == containerPtr->lastBorderLeft)
+	    && (Tk_InternalBorderRight(containerPtr->tkwin)
+		    == containerPtr->lastBorderRight)
+	    && (Tk_InternalBorderTop(containerPtr->tkwin)
+		    == containerPtr->lastBorderTop)
+	    && (Tk_InternalBorderBottom(containerPtr->tkwin)
+		    == containerPtr->lastBorderBottom)
+	    && ((Tk_IsMapped(containerPtr->tkwin) != 0)
+		    == containerPtr->lastMapped)) {
+	return;
+    }
+    containerPtr->flags &= ~LAYOUT_VALID;
+
     /*
      * Abort any nested call to ArrangePacking for this window, since we'll do
      * everything necessary here, and set up so this call can be aborted if
@@ -697,7 +742,7 @@ ArrangePacking(
 	    && !(containerPtr->flags & DONT_PROPAGATE)) {
 	Tk_GeometryRequest(containerPtr->tkwin, maxWidth, maxHeight);
 	containerPtr->flags |= REQUESTED_REPACK;
-	Tcl_DoWhenIdle(ArrangePacking, containerPtr);
+	TkScheduleLayout(containerPtr->tkwin, ArrangePacking, containerPtr);
 	goto done;
     }
 
@@ -886,6 +931,21 @@ ArrangePacking(
 	}
     }
 
+    /*
+     * Record the inputs this arrangement was computed from, so that repacks
+     * which change none of them can be skipped.
+     */
+
+    containerPtr->lastWidth = Tk_Width(containerPtr->tkwin);
+    containerPtr->lastHeight = Tk_Height(containerPtr->tkwin);
+    containerPtr->lastBorderLeft = Tk_InternalBorderLeft(containerPtr->tkwin);
+    containerPtr->lastBorderRight = Tk_InternalBorderRight(containerPtr->tkwin);
+    containerPtr->lastBorderTop = Tk_InternalBorderTop(containerPtr->tkwin);
+    containerPtr->lastBorderBottom =
+	    Tk_InternalBorderBottom(containerPtr->tkwin);
+    containerPtr->lastMapped = (Tk_IsMapped(containerPtr->tkwin) != 0);
+    containerPtr->flags |= LAYOUT_VALID;
+
   done:
     containerPtr->abortPtr = NULL;
     Tcl_Release(containerPtr);
@@ -1071,6 +1131,10 @@ GetPacker(
     packPtr->padLeft = packPtr->padTop = 0;
     packPtr->iPadX = packPtr->iPadY = 0;
     packPtr->doubleBw = 2*Tk_Changes(tkwin)->border_width;
+    packPtr->lastWidth = packPtr->lastHeight = 0;
+    packPtr->lastBorderLeft = packPtr->lastBorderRight = 0;
+    packPtr->lastBorderTop = packPtr->lastBorderBottom = 0;
+    packPtr->lastMapped = 0;
     packPtr->abortPtr = NULL;
     packPtr->flags = 0;
     Tcl_SetHashValue(hPtr, packPtr);
@@ -1309,12 +1373,13 @@ PackAfter(
      * Arrange for the container to be re-packed at the first idle moment.
      */
 
+    containerPtr->flags &= ~LAYOUT_VALID;
     if (containerPtr->abortPtr != NULL) {
 	*containerPtr->abortPtr = 1;
     }
     if (!(containerPtr->flags & REQUESTED_REPACK)) {
 	containerPtr->flags |= REQUESTED_REPACK;
-	Tcl_DoWhenIdle(ArrangePacking, containerPtr);
+	TkScheduleLayout(containerPtr->tkwin, ArrangePacking, containerPtr);
     }
     return TCL_OK;
 }
@@ -1359,9 +1424,10 @@ Unlink(
 	    }
 	}
     }
+    containerPtr->flags &= ~LAYOUT_VALID;
     if (!(containerPtr->flags & REQUESTED_REPACK)) {
 	containerPtr->flags |= REQUESTED_REPACK;
-	Tcl_DoWhenIdle(ArrangePacking, containerPtr);
+	TkScheduleLayout(containerPtr->tkwin, ArrangePacking, containerPtr);
     }
     if (containerPtr->abortPtr != NULL) {
 	*containerPtr->abortPtr = 1;
@@ -1443,14 +1509,16 @@ PackStructureProc(
 	if ((packPtr->contentPtr != NULL)
 		&& !(packPtr->flags & REQUESTED_REPACK)) {
 	    packPtr->flags |= REQUESTED_REPACK;
-	    Tcl_DoWhenIdle(ArrangePacking, packPtr);
+	    TkScheduleLayout(packPtr->tkwin, ArrangePacking, packPtr);
 	}
 	if ((packPtr->containerPtr != NULL)
 	        && (packPtr->doubleBw != 2*Tk_Changes(packPtr->tkwin)->border_width)) {
+	    packPtr->containerPtr->flags &= ~LAYOUT_VALID;
 	    if (!(packPtr->containerPtr->flags & REQUESTED_REPACK)) {
 		packPtr->doubleBw = 2*Tk_Changes(packPtr->tkwin)->border_width;
 		packPtr->containerPtr->flags |= REQUESTED_REPACK;
-		Tcl_DoWhenIdle(ArrangePacking, packPtr->containerPtr);
+		TkScheduleLayout(packPtr->containerPtr->tkwin, ArrangePacking,
+			packPtr->containerPtr);
 	    }
 	}
     } else if (eventPtr->type == DestroyNotify) {
@@ -1476,7 +1544,7 @@ PackStructureProc(
 	}
 
 	if (packPtr->flags & REQUESTED_REPACK) {
-	    Tcl_CancelIdleCall(ArrangePacking, packPtr);
+	    TkUnscheduleLayout(ArrangePacking, packPtr);
 	}
 	packPtr->tkwin = NULL;
 	Tcl_EventuallyFree(packPtr, (Tcl_FreeProc *) DestroyPacker);
@@ -1489,7 +1557,7 @@ PackStructureProc(
 	if ((packPtr->contentPtr != NULL)
 		&& !(packPtr->flags & REQUESTED_REPACK)) {
 	    packPtr->flags |= REQUESTED_REPACK;
-	    Tcl_DoWhenIdle(ArrangePacking, packPtr);
+	    TkScheduleLayout(packPtr->tkwin, ArrangePacking, packPtr);
 	}
     } else if (eventPtr->type == UnmapNotify) {
 	Packer *packPtr2;
@@ -1874,12 +1942,14 @@ ConfigureContent(
 	 */
 
     scheduleLayout:
+	containerPtr->flags &= ~LAYOUT_VALID;
 	if (containerPtr->abortPtr != NULL) {
 	    *containerPtr->abortPtr = 1;
 	}
 	if (!(containerPtr->flags & REQUESTED_REPACK)) {
 	    containerPtr->flags |= REQUESTED_REPACK;
-	    Tcl_DoWhenIdle(ArrangePacking, containerPtr);
+	    TkScheduleLayout(containerPtr->tkwin, ArrangePacking,
+		    containerPtr);
 	}
     }
     return TCL_OK;
@@ -102,6 +102,14 @@ typedef struct Pane {
     int handlex, handley;	/* Coordinates of the sash handle. */
     enum stretch stretch;	/* Controls how pane grows/shrinks */
     int hide;			/* Controls visibility of pane */
+    int appliedX, appliedY;	/* Geometry last applied to the pane by
+				 * ArrangePanes. During a sash drag most
+				 * parcels are unchanged, so panes whose
+				 * applied geometry still matches are skipped
+				 * instead of being re-managed. */
+    int appliedWidth, appliedHeight;
+    int appliedMapped;		/* Non-zero means the applied* fields are
+				 * valid and the pane is maintained. */
     struct PanedWindow *containerPtr;
 				/* Paned window managing the window. */
     Tk_Window after;		/* Placeholder for parsing options. */
@@ -1564,7 +1572,7 @@ DestroyPanedWindow(
 	Tcl_CancelIdleCall(DisplayPanedWindow, pwPtr);
     }
     if (pwPtr->flags & RESIZE_PENDING) {
-	Tcl_CancelIdleCall(ArrangePanes, pwPtr);
+	TkUnscheduleLayout(ArrangePanes, pwPtr);
     }
 
     /*
@@ -1635,7 +1643,7 @@ PanedWindowReqProc(
     if (Tk_IsMapped(pwPtr->tkwin)) {
 	if (!(pwPtr->flags & RESIZE_PENDING)) {
 	    pwPtr->flags |= RESIZE_PENDING;
-	    Tcl_DoWhenIdle(ArrangePanes, pwPtr);
+	    TkScheduleLayout(pwPtr->tkwin, ArrangePanes, pwPtr);
 	}
     } else {
 	int doubleBw = 2 * Tk_Changes(panePtr->tkwin)->border_width;
@@ -1823,6 +1831,7 @@ ArrangePanes(
 	if (panePtr->hide) {
 	    Tk_UnmaintainGeometry(panePtr->tkwin, pwPtr->tkwin);
 	    Tk_UnmapWindow(panePtr->tkwin);
+	    panePtr->appliedMapped = 0;
 	    continue;
 	}
 
@@ -1978,17 +1987,32 @@ ArrangePanes(
 	paneY += panePtr->pady;
 
 	/*
-	 * Now put the window in the proper spot.
+	 * Now put the window in the proper spot. Panes whose parcel has not
+	 * changed since the last arrangement are left alone; during a sash
+	 * drag this limits the re-layout to the panes on either side of the
+	 * dragged sash.
 	 */
 
 	if (newPaneWidth <= 0 || newPaneHeight <= 0 ||
 		(horizontal ? paneX - internalBW > pwWidth :
 		paneY - internalBW > pwHeight)) {
-	    Tk_UnmaintainGeometry(panePtr->tkwin, pwPtr->tkwin);
-	    Tk_UnmapWindow(panePtr->tkwin);
-	} else {
+	    if (panePtr->appliedMapped) {
+		Tk_UnmaintainGeometry(panePtr->tkwin, pwPtr->tkwin);
+		Tk_UnmapWindow(panePtr->tkwin);
+		panePtr->appliedMapped = 0;
+	    }
+	} else if (!panePtr->appliedMapped
+		|| (panePtr->appliedX != paneX)
+		|| (panePtr->appliedY != paneY)
+		|| (panePtr->appliedWidth != newPaneWidth)
+		|| (panePtr->appliedHeight != newPaneHeight)) {
 	    Tk_MaintainGeometry(panePtr->tkwin, pwPtr->tkwin,
 		    paneX, paneY, newPaneWidth, newPaneHeight);
+	    panePtr->appliedX = paneX;
+	    panePtr->appliedY = paneY;
+	    panePtr->appliedWidth = newPaneWidth;
+	    panePtr->appliedHeight = newPaneHeight;
+	    panePtr->appliedMapped = 1;
 	}
 	sashCount--;
     }
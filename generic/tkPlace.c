@@ -214,12 +214,13 @@ Tk_PlaceObjCmd(
     TkDisplay *dispPtr;
     Tk_OptionTable optionTable;
     static const char *const optionStrings[] = {
-	"configure", "content", "forget", "info", "slaves", NULL
+	"configure", "content", "forget", "info", "move", "slaves", NULL
     };
     static const char *const optionStringsNoDep[] = {
-	"configure", "content", "forget", "info", NULL
+	"configure", "content", "forget", "info", "move", NULL
     };
-    enum options { PLACE_CONFIGURE, PLACE_CONTENT, PLACE_FORGET, PLACE_INFO, PLACE_SLAVES };
+    enum options { PLACE_CONFIGURE, PLACE_CONTENT, PLACE_FORGET, PLACE_INFO,
+	    PLACE_MOVE, PLACE_SLAVES };
     int index;
 
     if (objc < 3) {
@@ -341,6 +342,70 @@ Tk_PlaceObjCmd(
 	}
 	return PlaceInfoCommand(interp, tkwin);
 
+    case PLACE_MOVE: {
+	/*
+	 * Lightweight motion path for drag and drop: update the -x and -y
+	 * fields of an already placed window without running the option
+	 * table, then let the usual idle handler coalesce the relayouts.
+	 */
+
+	Container *containerPtr;
+	int x, y;
+
+	if (objc != 5) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "pathName x y");
+	    return TCL_ERROR;
+	}
+	if ((Tk_GetPixelsFromObj(interp, tkwin, objv[3], &x) != TCL_OK)
+		|| (Tk_GetPixelsFromObj(interp, tkwin, objv[4], &y)
+		!= TCL_OK)) {
+	    return TCL_ERROR;
+	}
+	contentPtr = FindContent(tkwin);
+	if (contentPtr == NULL) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "can't move \"%s\": it is not managed by the placer",
+		    Tk_PathName(tkwin)));
+	    Tcl_SetErrorCode(interp, "TK", "GEOMETRY", "PLACER", NULL);
+	    return TCL_ERROR;
+	}
+	if ((x == contentPtr->x) && (y == contentPtr->y)
+		&& (contentPtr->xPtr != NULL) && (contentPtr->yPtr != NULL)) {
+	    break;
+	}
+	contentPtr->x = x;
+	contentPtr->y = y;
+
+	/*
+	 * Keep the Tcl_Obj reps in step with the integer fields so that
+	 * [place info] and [place configure] continue to report the truth.
+	 */
+
+	if (contentPtr->xPtr != objv[3]) {
+	    if (contentPtr->xPtr != NULL) {
+		Tcl_DecrRefCount(contentPtr->xPtr);
+	    }
+	    contentPtr->xPtr = objv[3];
+	    Tcl_IncrRefCount(objv[3]);
+	}
+	if (contentPtr->yPtr != objv[4]) {
+	    if (contentPtr->yPtr != NULL) {
+		Tcl_DecrRefCount(contentPtr->yPtr);
+	    }
+	    contentPtr->yPtr = objv[4];
+	    Tcl_IncrRefCount(objv[4]);
+	}
+
+	containerPtr = contentPtr->containerPtr;
+	if ((containerPtr != NULL)
+		&& !(containerPtr->flags & PARENT_RECONFIG_PENDING)) {
+	    containerPtr->flags |= PARENT_RECONFIG_PENDING;
+	    TkScheduleLayout(containerPtr->tkwin, RecomputePlacement,
+		    containerPtr);
+	}
+	break;
+    }
+
     case PLACE_SLAVES:
     case PLACE_CONTENT: {
 	Container *containerPtr;
@@ -771,7 +836,8 @@ ConfigureContent(
 
     if (!(containerPtr->flags & PARENT_RECONFIG_PENDING)) {
 	containerPtr->flags |= PARENT_RECONFIG_PENDING;
-	Tcl_DoWhenIdle(RecomputePlacement, containerPtr);
+	TkScheduleLayout(containerPtr->tkwin, RecomputePlacement,
+		containerPtr);
     }
     return TCL_OK;
 
@@ -1105,7 +1171,8 @@ PlaceStructureProc(
 	if ((containerPtr->contentPtr != NULL)
 		&& !(containerPtr->flags & PARENT_RECONFIG_PENDING)) {
 	    containerPtr->flags |= PARENT_RECONFIG_PENDING;
-	    Tcl_DoWhenIdle(RecomputePlacement, containerPtr);
+	    TkScheduleLayout(containerPtr->tkwin, RecomputePlacement,
+		    containerPtr);
 	}
 	return;
     case DestroyNotify:
@@ -1118,7 +1185,7 @@ PlaceStructureProc(
 	Tcl_DeleteHashEntry(Tcl_FindHashEntry(&dispPtr->containerTable,
 		containerPtr->tkwin));
 	if (containerPtr->flags & PARENT_RECONFIG_PENDING) {
-	    Tcl_CancelIdleCall(RecomputePlacement, containerPtr);
+	    TkUnscheduleLayout(RecomputePlacement, containerPtr);
 	}
 	containerPtr->tkwin = NULL;
 	if (containerPtr->abortPtr != NULL) {
@@ -1135,7 +1202,8 @@ PlaceStructureProc(
 	if ((containerPtr->contentPtr != NULL)
 		&& !(containerPtr->flags & PARENT_RECONFIG_PENDING)) {
 	    containerPtr->flags |= PARENT_RECONFIG_PENDING;
-	    Tcl_DoWhenIdle(RecomputePlacement, containerPtr);
+	    TkScheduleLayout(containerPtr->tkwin, RecomputePlacement,
+		    containerPtr);
 	}
 	return;
     case UnmapNotify:
@@ -1230,7 +1298,8 @@ PlaceRequestProc(
     }
     if (!(containerPtr->flags & PARENT_RECONFIG_PENDING)) {
 	containerPtr->flags |= PARENT_RECONFIG_PENDING;
-	Tcl_DoWhenIdle(RecomputePlacement, containerPtr);
+	TkScheduleLayout(containerPtr->tkwin, RecomputePlacement,
+		containerPtr);
     }
 }
 
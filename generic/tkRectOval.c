@@ -918,8 +918,22 @@ DisplayRectOval(
 	    }
 	}
 	if (rectOvalPtr->header.typePtr == &tkRectangleType) {
-	    XFillRectangle(display, drawable, rectOvalPtr->fillGC,
-		    x1, y1, (unsigned int) (x2-x1), (unsigned int) (y2-y1));
+	    if (fillStipple == None) {
+		/*
+		 * Plain solid fill: queue the rectangle so that runs of
+		 * rectangle items sharing one GC go to the server as a
+		 * single XFillRectangles request.
+		 */
+
+		TkCanvasBatchFillRect(display, drawable, rectOvalPtr->fillGC,
+			itemPtr->typePtr, x1, y1, (unsigned int) (x2-x1),
+			(unsigned int) (y2-y1));
+	    } else {
+		TkCanvasBatchFlush();
+		XFillRectangle(display, drawable, rectOvalPtr->fillGC,
+			x1, y1, (unsigned int) (x2-x1),
+			(unsigned int) (y2-y1));
+	    }
 	} else {
 	    XFillArc(display, drawable, rectOvalPtr->fillGC,
 		    x1, y1, (unsigned) (x2-x1), (unsigned) (y2-y1),
@@ -931,10 +945,25 @@ DisplayRectOval(
     }
 
     if (rectOvalPtr->outline.gc != NULL) {
-	Tk_ChangeOutlineGC(canvas, itemPtr, &(rectOvalPtr->outline));
+	int gcChanged = Tk_ChangeOutlineGC(canvas, itemPtr,
+		&(rectOvalPtr->outline));
+
 	if (rectOvalPtr->header.typePtr == &tkRectangleType) {
-	    XDrawRectangle(display, drawable, rectOvalPtr->outline.gc,
-		    x1, y1, (unsigned) (x2-x1), (unsigned) (y2-y1));
+	    if (!gcChanged) {
+		TkCanvasBatchDrawRect(display, drawable,
+			rectOvalPtr->outline.gc, itemPtr->typePtr,
+			x1, y1, (unsigned) (x2-x1), (unsigned) (y2-y1));
+	    } else {
+		/*
+		 * The outline GC was modified in place for this item (dash
+		 * offset or stipple origin), so the rectangle cannot be
+		 * deferred past the matching Tk_ResetOutlineGC below.
+		 */
+
+		TkCanvasBatchFlush();
+		XDrawRectangle(display, drawable, rectOvalPtr->outline.gc,
+			x1, y1, (unsigned) (x2-x1), (unsigned) (y2-y1));
+	    }
 	} else {
 	    XDrawArc(display, drawable, rectOvalPtr->outline.gc,
 		    x1, y1, (unsigned) (x2-x1), (unsigned) (y2-y1), 0, 360*64);
@@ -162,6 +162,7 @@ Tk_ScrollbarObjCmd(
     scrollPtr->width = 0;
     scrollPtr->command = NULL;
     scrollPtr->commandSize = 0;
+    scrollPtr->attachCmdObj = NULL;
     scrollPtr->repeatDelay = 0;
     scrollPtr->repeatInterval = 0;
     scrollPtr->borderWidth = 0;
@@ -229,12 +230,13 @@ ScrollbarWidgetObjCmd(
     int result = TCL_OK, cmdIndex, length;
     TkSizeT len;
     static const char *const commandNames[] = {
-        "activate", "cget", "configure", "delta", "fraction",
+        "activate", "cget", "configure", "delta", "dispatch", "fraction",
         "get", "identify", "set", NULL
     };
     enum command {
         COMMAND_ACTIVATE, COMMAND_CGET, COMMAND_CONFIGURE, COMMAND_DELTA,
-        COMMAND_FRACTION, COMMAND_GET, COMMAND_IDENTIFY, COMMAND_SET
+        COMMAND_DISPATCH, COMMAND_FRACTION, COMMAND_GET, COMMAND_IDENTIFY,
+        COMMAND_SET
     };
 
     if (objc < 2) {
@@ -338,6 +340,69 @@ ScrollbarWidgetObjCmd(
 	Tcl_SetObjResult(interp, Tcl_NewDoubleObj(fraction));
 	break;
     }
+    case COMMAND_DISPATCH: {
+	Tcl_CmdInfo cmdInfo;
+	Tcl_Obj **prefixObjv, **dispObjv;
+	int prefixObjc, dispObjc, i;
+
+	if (objc < 3) {
+		Tcl_WrongNumArgs(interp, 1, objv, "dispatch arg ?arg ...?");
+	    goto error;
+	}
+
+	/*
+	 * If no widget has linked itself to this scrollbar, report that the
+	 * caller should fall back to evaluating the -command string.
+	 */
+
+	if (scrollPtr->attachCmdObj == NULL) {
+	    Tcl_SetObjResult(interp, Tcl_NewBooleanObj(0));
+	    break;
+	}
+	if (Tcl_ListObjGetElements(interp, scrollPtr->attachCmdObj,
+		&prefixObjc, &prefixObjv) != TCL_OK) {
+	    goto error;
+	}
+	if ((prefixObjc == 0) || !Tcl_GetCommandInfo(interp,
+		Tcl_GetString(prefixObjv[0]), &cmdInfo)
+		|| !cmdInfo.isNativeObjectProc) {
+	    /*
+	     * The attached widget has gone away; drop the stale linkage.
+	     */
+
+	    Tcl_DecrRefCount(scrollPtr->attachCmdObj);
+	    scrollPtr->attachCmdObj = NULL;
+	    Tcl_SetObjResult(interp, Tcl_NewBooleanObj(0));
+	    break;
+	}
+
+	/*
+	 * Invoke the attached widget's command procedure directly, without
+	 * going back through the interpreter.
+	 */
+
+	dispObjc = prefixObjc + objc - 2;
+	dispObjv = (Tcl_Obj **)ckalloc(dispObjc * sizeof(Tcl_Obj *));
+	for (i = 0; i < prefixObjc; i++) {
+	    dispObjv[i] = prefixObjv[i];
+	}
+	for (i = 2; i < objc; i++) {
+	    dispObjv[prefixObjc + i - 2] = objv[i];
+	}
+	for (i = 0; i < dispObjc; i++) {
+	    Tcl_IncrRefCount(dispObjv[i]);
+	}
+	result = cmdInfo.objProc(cmdInfo.objClientData, interp, dispObjc,
+		dispObjv);
+	for (i = 0; i < dispObjc; i++) {
+	    Tcl_DecrRefCount(dispObjv[i]);
+	}
+	ckfree(dispObjv);
+	if (result == TCL_OK) {
+	    Tcl_SetObjResult(interp, Tcl_NewBooleanObj(1));
+	}
+	break;
+    }
     case COMMAND_FRACTION: {
 	int x, y, pos;
 	double fraction;
@@ -426,22 +491,9 @@ ScrollbarWidgetObjCmd(
 	    if (Tcl_GetDoubleFromObj(interp, objv[3], &last) != TCL_OK) {
 		goto error;
 	    }
-	    if (first < 0) {
-		scrollPtr->firstFraction = 0;
-	    } else if (first > 1.0) {
-		scrollPtr->firstFraction = 1.0;
-	    } else {
-		scrollPtr->firstFraction = first;
-	    }
-	    if (last < scrollPtr->firstFraction) {
-		scrollPtr->lastFraction = scrollPtr->firstFraction;
-	    } else if (last > 1.0) {
-		scrollPtr->lastFraction = 1.0;
-	    } else {
-		scrollPtr->lastFraction = last;
-	    }
+	    TkScrollbarSetRange(scrollPtr, first, last);
+	    break;
 #ifndef TK_NO_DEPRECATED
-	    scrollPtr->flags &= ~OLD_STYLE_COMMANDS;
 	} else if (objc == 6) {
 	    int totalUnits, windowUnits, firstUnit, lastUnit;
 	    if (Tcl_GetIntFromObj(interp, objv[2], &totalUnits) != TCL_OK) {
@@ -601,6 +653,10 @@ TkScrollbarEventProc(
 	if (scrollPtr->flags & REDRAW_PENDING) {
 	    Tcl_CancelIdleCall(TkpDisplayScrollbar, scrollPtr);
 	}
+	if (scrollPtr->attachCmdObj != NULL) {
+	    Tcl_DecrRefCount(scrollPtr->attachCmdObj);
+	    scrollPtr->attachCmdObj = NULL;
+	}
 	/*
 	 * Free up all the stuff that requires special handling, then let
 	 * Tk_FreeOptions handle all the standard option-related stuff.
@@ -697,6 +753,153 @@ TkScrollbarEventuallyRedraw(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkScrollbarFromObj --
+ *
+ *	Given the path name of a window, return the scrollbar record for it if
+ *	it is a core scrollbar widget.
+ *
+ * Results:
+ *	A pointer to the scrollbar record, or NULL if the window doesn't
+ *	exist or isn't a scrollbar. In the latter cases an error message is
+ *	left in interp's result if interp is not NULL.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+TkScrollbar *
+TkScrollbarFromObj(
+    Tcl_Interp *interp,		/* Used for error reporting. NULL means resolve
+				 * silently. */
+    Tk_Window tkwin,		/* Window used to look up the path name. */
+    Tcl_Obj *objPtr)		/* Path name of the scrollbar. */
+{
+    Tk_Window target;
+
+    target = Tk_NameToWindow(interp, Tcl_GetString(objPtr), tkwin);
+    if (target == NULL) {
+	return NULL;
+    }
+    if (strcmp(Tk_Class(target), "Scrollbar") != 0) {
+	if (interp != NULL) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "window \"%s\" is not a scrollbar",
+		    Tcl_GetString(objPtr)));
+	    Tcl_SetErrorCode(interp, "TK", "SCROLLBAR", "ATTACH", NULL);
+	}
+	return NULL;
+    }
+    return (TkScrollbar *)((TkWindow *) target)->instanceData;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkScrollbarIsVertical --
+ *
+ *	Reports the orientation of a scrollbar, for widgets that cannot see
+ *	into the scrollbar record.
+ *
+ * Results:
+ *	Non-zero if the scrollbar is oriented vertically.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkScrollbarIsVertical(
+    TkScrollbar *scrollPtr)	/* Scrollbar to query. */
+{
+    return scrollPtr->vertical;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkScrollbarLinkWidget --
+ *
+ *	Installs (or removes) the command prefix that the "dispatch" widget
+ *	command invokes directly when the scrollbar is manipulated. Called by
+ *	scrollable widgets when they attach themselves to the scrollbar.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Any previous linkage is released.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkScrollbarLinkWidget(
+    TkScrollbar *scrollPtr,	/* Scrollbar to update. */
+    Tcl_Obj *cmdPrefixObj)	/* Command prefix (e.g. ".t yview") to invoke
+				 * directly, or NULL to break an existing
+				 * linkage. */
+{
+    if (scrollPtr->attachCmdObj != NULL) {
+	Tcl_DecrRefCount(scrollPtr->attachCmdObj);
+    }
+    scrollPtr->attachCmdObj = cmdPrefixObj;
+    if (cmdPrefixObj != NULL) {
+	Tcl_IncrRefCount(cmdPrefixObj);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkScrollbarSetRange --
+ *
+ *	Updates the fractions describing the scrollbar's slider, exactly as
+ *	the "set" widget command does, but callable directly from C so that
+ *	attached widgets can skip the -yscrollcommand evaluation.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The scrollbar is redisplayed with the new slider position.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkScrollbarSetRange(
+    TkScrollbar *scrollPtr,	/* Scrollbar to update. */
+    double first, double last)	/* Fractions between 0 and 1 describing the
+				 * visible range. */
+{
+    if (first < 0) {
+	scrollPtr->firstFraction = 0;
+    } else if (first > 1.0) {
+	scrollPtr->firstFraction = 1.0;
+    } else {
+	scrollPtr->firstFraction = first;
+    }
+    if (last < scrollPtr->firstFraction) {
+	scrollPtr->lastFraction = scrollPtr->firstFraction;
+    } else if (last > 1.0) {
+	scrollPtr->lastFraction = 1.0;
+    } else {
+	scrollPtr->lastFraction = last;
+    }
+#ifndef TK_NO_DEPRECATED
+    scrollPtr->flags &= ~OLD_STYLE_COMMANDS;
+#endif /* !TK_NO_DEPRECATED */
+    TkpComputeScrollbarGeometry(scrollPtr);
+    TkScrollbarEventuallyRedraw(scrollPtr);
+}
+
 /*
  * Local Variables:
  * mode: c
@@ -39,6 +39,13 @@ typedef struct TkScrollbar {
 				 * scrolling commands. NULL means don't invoke
 				 * commands. Malloc'ed. */
     int commandSize;		/* Number of non-NULL bytes in command. */
+    Tcl_Obj *attachCmdObj;	/* When a scrollable widget has linked itself
+				 * directly to this scrollbar (e.g. via the
+				 * text widget's "attach" command), this holds
+				 * the command prefix (such as ".t yview")
+				 * that the "dispatch" widget command invokes
+				 * without an interpreter round trip. NULL
+				 * means no widget is attached. */
     int repeatDelay;		/* How long to wait before auto-repeating on
 				 * scrolling actions (in ms). */
     int repeatInterval;		/* Interval between autorepeats (in ms). */
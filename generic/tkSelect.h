@@ -92,6 +92,10 @@ typedef struct TkSelRetrievalInfo {
 				 * of data that cross buffer boundaries. */
     int encFlags;		/* Encoding translation state flags. */
     Tcl_DString buf;		/* Buffer to hold translation data. */
+    int multiple;		/* Non-zero means this retrieval is part of a
+				 * group issued as one MULTIPLE request; the
+				 * result arrives in this structure's property
+				 * with no per-target SelectionNotify. */
     struct TkSelRetrievalInfo *nextPtr;
 				/* Next in list of all pending selection
 				 * retrievals. NULL means end of list. */
@@ -121,6 +125,11 @@ typedef struct TkClipboardTarget {
     TkClipboardBuffer *lastBufferPtr;
 				/* Last in list of clipboard buffers. Used to
 				 * speed up appends. */
+    char *flatBuffer;		/* Contiguous rendering of the buffer chain,
+				 * built lazily the first time this target is
+				 * retrieved and discarded whenever the chain
+				 * changes. NULL means not yet rendered. */
+    TkSizeT flatLength;		/* Number of bytes in flatBuffer. */
     struct TkClipboardTarget *nextPtr;
 				/* Next in list of targets on clipboard. NULL
 				 * means end of list. */
@@ -163,6 +172,10 @@ MODULE_SCOPE void	TkSelClearSelection(Tk_Window tkwin, XEvent *eventPtr);
 MODULE_SCOPE int	TkSelDefaultSelection(TkSelectionInfo *infoPtr,
 			    Atom target, char *buffer, int maxBytes,
 			    Atom *typePtr);
+MODULE_SCOPE int	TkSelGetSelectionMultiple(Tcl_Interp *interp,
+			    Tk_Window tkwin, Atom selection, int numTargets,
+			    Atom *targets, Tk_GetSelProc *proc,
+			    ClientData *clientDatas, int *results);
 #ifndef TkSelUpdateClipboard
 MODULE_SCOPE void	TkSelUpdateClipboard(TkWindow *winPtr,
 			    TkClipboardTarget *targetPtr);
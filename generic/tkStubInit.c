@@ -520,6 +520,9 @@ static const TkIntStubs tkIntStubs = {
     TkpWillDrawWidget, /* 186 */
 #endif /* MACOSX */
     TkDebugPhotoStringMatchDef, /* 187 */
+    TkGridSolveStats, /* 188 */
+    TkLayoutReorderStats, /* 189 */
+    TkFrameOverdrawStats, /* 190 */
 };
 
 static const TkIntPlatStubs tkIntPlatStubs = {
@@ -1332,7 +1335,9 @@ const TkStubs tkStubs = {
     Tk_NewWindowObj, /* 277 */
     Tk_SendVirtualEvent, /* 278 */
     Tk_FontGetDescription, /* 279 */
-    Tk_CreatePhotoImageFormatVersion3 /* 280 */
+    Tk_CreatePhotoImageFormatVersion3, /* 280 */
+    Tk_CollapseWheelEvents, /* 281 */
+    Tk_QueueThreadWindowEvent /* 282 */
 };
 
 /* !END!: Do not edit above this line. */
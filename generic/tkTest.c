@@ -198,6 +198,15 @@ static int		TestpropObjCmd(ClientData dummy,
 static int		TestprintfObjCmd(ClientData dummy,
 			    Tcl_Interp *interp, int objc,
 			    Tcl_Obj * const objv[]);
+static int		TestgridsolvesObjCmd(ClientData dummy,
+			    Tcl_Interp *interp, int objc,
+			    Tcl_Obj * const objv[]);
+static int		TestlayoutreordersObjCmd(ClientData dummy,
+			    Tcl_Interp *interp, int objc,
+			    Tcl_Obj * const objv[]);
+static int		TestframeoverdrawObjCmd(ClientData dummy,
+			    Tcl_Interp *interp, int objc,
+			    Tcl_Obj * const objv[]);
 #if !(defined(_WIN32) || defined(MAC_OSX_TK) || defined(__CYGWIN__))
 static int		TestwrapperObjCmd(ClientData dummy,
 			    Tcl_Interp *interp, int objc,
@@ -273,6 +282,12 @@ Tktest_Init(
     Tcl_CreateObjCommand(interp, "testprop", TestpropObjCmd,
 	    (ClientData) Tk_MainWindow(interp), NULL);
     Tcl_CreateObjCommand(interp, "testprintf", TestprintfObjCmd, NULL, NULL);
+    Tcl_CreateObjCommand(interp, "testgridsolves", TestgridsolvesObjCmd,
+	    NULL, NULL);
+    Tcl_CreateObjCommand(interp, "testlayoutreorders",
+	    TestlayoutreordersObjCmd, NULL, NULL);
+    Tcl_CreateObjCommand(interp, "testframeoverdraw",
+	    TestframeoverdrawObjCmd, NULL, NULL);
     Tcl_CreateObjCommand(interp, "testtext", TkpTesttextCmd,
 	    (ClientData) Tk_MainWindow(interp), NULL);
     Tcl_CreateObjCommand(interp, "testphotostringmatch",
@@ -1907,6 +1922,114 @@ TestpropObjCmd(
     return TCL_OK;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TestgridsolvesObjCmd --
+ *
+ *	This function implements the "testgridsolves" command. It returns the
+ *	number of times the grid constraint solver has run, so that tests and
+ *	performance investigations can measure how often widget changes cause
+ *	relayouts. With the optional "reset" argument the counter is reset to
+ *	zero after being read.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	May reset the solve counter.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+TestgridsolvesObjCmd(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument strings. */
+{
+    if (objc > 2 || (objc == 2 && strcmp(Tcl_GetString(objv[1]), "reset"))) {
+	Tcl_WrongNumArgs(interp, 1, objv, "?reset?");
+	return TCL_ERROR;
+    }
+    Tcl_SetObjResult(interp, Tcl_NewWideIntObj(TkGridSolveStats(objc == 2)));
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TestlayoutreordersObjCmd --
+ *
+ *	This function implements the "testlayoutreorders" command. It returns
+ *	the number of times the central layout scheduler has hoisted a
+ *	pending arrangement ahead of a deeper container, so that tests can
+ *	verify the parent-first ordering. With the optional "reset" argument
+ *	the counter is reset to zero after being read.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	May reset the reorder counter.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+TestlayoutreordersObjCmd(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument strings. */
+{
+    if (objc > 2 || (objc == 2 && strcmp(Tcl_GetString(objv[1]), "reset"))) {
+	Tcl_WrongNumArgs(interp, 1, objv, "?reset?");
+	return TCL_ERROR;
+    }
+    Tcl_SetObjResult(interp,
+	    Tcl_NewWideIntObj(TkLayoutReorderStats(objc == 2)));
+    return TCL_OK;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TestframeoverdrawObjCmd --
+ *
+ *	This function implements the "testframeoverdraw" command. It returns
+ *	the cumulative number of interior pixels that frame widgets did not
+ *	have to paint because they were covered by child windows, so that
+ *	tests can verify the occlusion subtraction in DisplayFrame. With the
+ *	optional "reset" argument the counter is reset to zero after being
+ *	read.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	May reset the overdraw counter.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+TestframeoverdrawObjCmd(
+    TCL_UNUSED(void *),
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument strings. */
+{
+    if (objc > 2 || (objc == 2 && strcmp(Tcl_GetString(objv[1]), "reset"))) {
+	Tcl_WrongNumArgs(interp, 1, objv, "?reset?");
+	return TCL_ERROR;
+    }
+    Tcl_SetObjResult(interp,
+	    Tcl_NewWideIntObj(TkFrameOverdrawStats(objc == 2)));
+    return TCL_OK;
+}
+
 /*
  *----------------------------------------------------------------------
  *
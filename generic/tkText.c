@@ -18,6 +18,14 @@
 #include "tkUndo.h"
 #include "default.h"
 
+#if defined(_WIN32)
+#include "tkWinInt.h"
+#elif defined(MAC_OSX_TK)
+#include "tkMacOSXInt.h"
+#else /* if defined(__unix__) */
+#include "tkUnixInt.h"
+#endif
+
 #if defined(MAC_OSX_TK)
 #define Style TkStyle
 #define DInfo TkDInfo
@@ -155,6 +163,9 @@ static const Tk_OptionSpec optionSpecs[] = {
     {TK_OPTION_COLOR, "-foreground", "foreground", "Foreground",
 	DEF_TEXT_FG, TCL_INDEX_NONE, offsetof(TkText, fgColor), 0,
 	0, 0},
+    {TK_OPTION_BOOLEAN, "-gutter", "gutter", "Gutter",
+	DEF_TEXT_GUTTER, TCL_INDEX_NONE, offsetof(TkText, gutter), 0, 0,
+	TK_TEXT_LINE_GEOMETRY},
     {TK_OPTION_PIXELS, "-height", "height", "Height",
 	DEF_TEXT_HEIGHT, TCL_INDEX_NONE, offsetof(TkText, height), 0, 0, 0},
     {TK_OPTION_COLOR, "-highlightbackground", "highlightBackground",
@@ -196,6 +207,9 @@ static const Tk_OptionSpec optionSpecs[] = {
     {TK_OPTION_INT, "-maxundo", "maxUndo", "MaxUndo",
 	DEF_TEXT_MAX_UNDO, TCL_INDEX_NONE, offsetof(TkText, maxUndo),
 	TK_OPTION_DONT_SET_DEFAULT, 0, 0},
+    {TK_OPTION_INT, "-maxundosize", "maxUndoSize", "MaxUndoSize",
+	DEF_TEXT_MAX_UNDO_SIZE, TCL_INDEX_NONE, offsetof(TkText, maxUndoSize),
+	TK_OPTION_DONT_SET_DEFAULT, 0, 0},
     {TK_OPTION_PIXELS, "-padx", "padX", "Pad",
 	DEF_TEXT_PADX, TCL_INDEX_NONE, offsetof(TkText, padX), 0, 0,
 	TK_TEXT_LINE_GEOMETRY},
@@ -283,6 +297,9 @@ typedef int		SearchMatchProc(int lineNum,
 typedef int		SearchLineIndexProc(Tcl_Interp *interp,
 			    Tcl_Obj *objPtr, struct SearchSpec *searchSpecPtr,
 			    int *linePosPtr, TkSizeT *offsetPosPtr);
+typedef int		SearchFastProc(Tcl_Interp *interp,
+			    struct SearchSpec *searchSpecPtr,
+			    Tcl_Obj *patObj, int *handledPtr);
 
 typedef struct SearchSpec {
     int exact;			/* Whether search is exact or regexp. */
@@ -319,6 +336,11 @@ typedef struct SearchSpec {
     SearchLineIndexProc *lineIndexProc;
 				/* Function to call when we have found a
 				 * match. */
+    SearchFastProc *fastProc;	/* If non-NULL, a function which may perform
+				 * the whole search with a faster dedicated
+				 * engine. It declines the searches it cannot
+				 * handle, in which case the generic
+				 * SearchCore is used. */
     ClientData clientData;	/* Information about structure being searched,
 				 * in this case a text widget. */
 } SearchSpec;
@@ -373,12 +395,18 @@ static int		TextInsertCmd(TkSharedText *sharedTextPtr,
 			    TkText *textPtr, Tcl_Interp *interp,
 			    int objc, Tcl_Obj *const objv[],
 			    const TkTextIndex *indexPtr, int viewUpdate);
+static int		TextLoadCmd(TkText *textPtr, Tcl_Interp *interp,
+			    Tcl_Obj *chanObj);
 static int		TextReplaceCmd(TkText *textPtr, Tcl_Interp *interp,
 			    const TkTextIndex *indexFromPtr,
 			    const TkTextIndex *indexToPtr,
 			    int objc, Tcl_Obj *const objv[], int viewUpdate);
 static int		TextSearchCmd(TkText *textPtr, Tcl_Interp *interp,
 			    int objc, Tcl_Obj *const objv[]);
+static int		TextAttachYScrollbar(Tcl_Interp *interp,
+			    TkText *textPtr, Tcl_Obj *pathObj);
+static int		TextBlockSelCmd(TkText *textPtr, Tcl_Interp *interp,
+			    int objc, Tcl_Obj *const objv[]);
 static int		TextEditCmd(TkText *textPtr, Tcl_Interp *interp,
 			    int objc, Tcl_Obj *const objv[]);
 static int		TextWidgetObjCmd(ClientData clientData,
@@ -406,6 +434,9 @@ static Tcl_Obj *	TextGetText(const TkText *textPtr,
 static void		GenerateModifiedEvent(TkText *textPtr);
 static void		GenerateUndoStackEvent(TkText *textPtr);
 static void		UpdateDirtyFlag(TkSharedText *sharedPtr);
+static void		RecordEditDelta(TkSharedText *sharedTextPtr,
+			    const TkTextIndex *index1Ptr,
+			    const TkTextIndex *index2Ptr);
 static void		TextPushUndoAction(TkText *textPtr,
 			    Tcl_Obj *undoString, int insert,
 			    const TkTextIndex *index1Ptr,
@@ -417,13 +448,14 @@ static int		TextPeerCmd(TkText *textPtr, Tcl_Interp *interp,
 static TkUndoProc	TextUndoRedoCallback;
 
 /*
- * Declarations of the three search procs required by the multi-line search
+ * Declarations of the search procs required by the multi-line search
  * routines.
  */
 
 static SearchMatchProc		TextSearchFoundMatch;
 static SearchAddLineProc	TextSearchAddNextLine;
 static SearchLineIndexProc	TextSearchGetLineIndex;
+static SearchFastProc		TextSearchFastExact;
 
 /*
  * The structure below defines text class behavior by means of functions that
@@ -552,6 +584,8 @@ CreateWidget(
 	sharedPtr->autoSeparators = 1;
 	sharedPtr->lastEditMode = TK_TEXT_EDIT_OTHER;
 	sharedPtr->stateEpoch = 0;
+	sharedPtr->deltaStartLine = -1;
+	sharedPtr->deltaEndDist = 0;
     }
 
     /*
@@ -592,6 +626,9 @@ CreateWidget(
     textPtr->wrapMode = TEXT_WRAPMODE_CHAR;
     textPtr->prevWidth = Tk_Width(newWin);
     textPtr->prevHeight = Tk_Height(newWin);
+    textPtr->blockSelActive = 0;
+    textPtr->blockSelLine1 = textPtr->blockSelCol1 = 0;
+    textPtr->blockSelLine2 = textPtr->blockSelCol2 = 0;
 
     /*
      * Register with the B-tree. In some sense it would be best if we could do
@@ -613,6 +650,7 @@ CreateWidget(
     textPtr->pickEvent.type = LeaveNotify;
     textPtr->undo = textPtr->sharedTextPtr->undo;
     textPtr->maxUndo = textPtr->sharedTextPtr->maxUndo;
+    textPtr->maxUndoSize = textPtr->sharedTextPtr->maxUndoSize;
     textPtr->autoSeparators = textPtr->sharedTextPtr->autoSeparators;
     textPtr->tabOptionPtr = NULL;
 
@@ -674,6 +712,86 @@ CreateWidget(
     return TCL_OK;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TextAttachYScrollbar --
+ *
+ *	This function implements "pathName attach -yscrollbar pathName". It
+ *	links the text widget directly to a vertical scrollbar so that view
+ *	updates in both directions are dispatched in C, without evaluating
+ *	the -yscrollcommand and -command scripts. An empty path name breaks
+ *	an existing linkage.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	The scrollbar immediately receives the widget's current view, and
+ *	from now on manipulating it scrolls this widget directly.
+ *
+ *--------------------------------------------------------------
+ */
+
+static int
+TextAttachYScrollbar(
+    Tcl_Interp *interp,		/* Used for error reporting. */
+    TkText *textPtr,		/* Information about text widget. */
+    Tcl_Obj *pathObj)		/* Path name of the scrollbar, or an empty
+				 * string to detach. */
+{
+    struct TkScrollbar *scrollPtr;
+    const char *path = Tcl_GetString(pathObj);
+
+    /*
+     * Undo any existing linkage, including the command prefix held by the
+     * previously attached scrollbar.
+     */
+
+    if (textPtr->yScrollbarObj != NULL) {
+	scrollPtr = TkScrollbarFromObj(NULL, textPtr->tkwin,
+		textPtr->yScrollbarObj);
+	if (scrollPtr != NULL) {
+	    TkScrollbarLinkWidget(scrollPtr, NULL);
+	}
+	Tcl_DecrRefCount(textPtr->yScrollbarObj);
+	textPtr->yScrollbarObj = NULL;
+    }
+    if (path[0] == '\0') {
+	return TCL_OK;
+    }
+
+    scrollPtr = TkScrollbarFromObj(interp, textPtr->tkwin, pathObj);
+    if (scrollPtr == NULL) {
+	return TCL_ERROR;
+    }
+    if (!TkScrollbarIsVertical(scrollPtr)) {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"scrollbar \"%s\" is not oriented vertically", path));
+	Tcl_SetErrorCode(interp, "TK", "TEXT", "ATTACH_ORIENT", NULL);
+	return TCL_ERROR;
+    }
+
+    textPtr->yScrollbarObj = pathObj;
+    Tcl_IncrRefCount(pathObj);
+
+    /*
+     * Give the scrollbar the command prefix to invoke directly when it is
+     * manipulated, then push the current view to it right away.
+     */
+
+    {
+	Tcl_Obj *cmdObj = Tcl_NewListObj(0, NULL);
+
+	Tcl_ListObjAppendElement(NULL, cmdObj,
+		Tcl_NewStringObj(Tk_PathName(textPtr->tkwin), -1));
+	Tcl_ListObjAppendElement(NULL, cmdObj, Tcl_NewStringObj("yview", -1));
+	TkScrollbarLinkWidget(scrollPtr, cmdObj);
+    }
+    TkTextUpdateYScrollbar(textPtr);
+    return TCL_OK;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -704,17 +822,22 @@ TextWidgetObjCmd(
     int idx;
 
     static const char *const optionStrings[] = {
-	"bbox", "cget", "compare", "configure", "count", "debug", "delete",
-	"dlineinfo", "dump", "edit", "get", "image", "index", "insert",
-	"mark", "peer", "pendingsync", "replace", "scan", "search",
-	"see", "sync", "tag", "window", "xview", "yview", NULL
+	"attach",
+	"bbox", "blockselect", "cget", "compare", "configure", "count",
+	"debug", "delete", "dlineinfo", "dump", "edit", "get", "hash",
+	"image",
+	"index", "insert", "load", "mark", "peer", "pendingsync", "render",
+	"replace", "scan", "search", "see", "sync", "tag", "window",
+	"xview", "yview", NULL
     };
     enum options {
-	TEXT_BBOX, TEXT_CGET, TEXT_COMPARE, TEXT_CONFIGURE, TEXT_COUNT,
-	TEXT_DEBUG, TEXT_DELETE, TEXT_DLINEINFO, TEXT_DUMP, TEXT_EDIT,
-	TEXT_GET, TEXT_IMAGE, TEXT_INDEX, TEXT_INSERT, TEXT_MARK,
-	TEXT_PEER, TEXT_PENDINGSYNC, TEXT_REPLACE, TEXT_SCAN,
-	TEXT_SEARCH, TEXT_SEE, TEXT_SYNC, TEXT_TAG, TEXT_WINDOW,
+	TEXT_ATTACH,
+	TEXT_BBOX, TEXT_BLOCKSELECT, TEXT_CGET, TEXT_COMPARE, TEXT_CONFIGURE,
+	TEXT_COUNT, TEXT_DEBUG, TEXT_DELETE, TEXT_DLINEINFO, TEXT_DUMP,
+	TEXT_EDIT, TEXT_GET, TEXT_HASH, TEXT_IMAGE, TEXT_INDEX, TEXT_INSERT,
+	TEXT_LOAD,
+	TEXT_MARK, TEXT_PEER, TEXT_PENDINGSYNC, TEXT_RENDER, TEXT_REPLACE,
+	TEXT_SCAN, TEXT_SEARCH, TEXT_SEE, TEXT_SYNC, TEXT_TAG, TEXT_WINDOW,
 	TEXT_XVIEW, TEXT_YVIEW
     };
 
@@ -730,6 +853,28 @@ TextWidgetObjCmd(
     textPtr->refCount++;
 
     switch ((enum options) idx) {
+    case TEXT_ATTACH:
+	if ((objc != 3) && (objc != 4)) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "-yscrollbar ?pathName?");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (strcmp(Tcl_GetString(objv[2]), "-yscrollbar") != 0) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "bad attach option \"%s\": must be -yscrollbar",
+		    Tcl_GetString(objv[2])));
+	    Tcl_SetErrorCode(interp, "TK", "TEXT", "ATTACH_OPTION", NULL);
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (objc == 3) {
+	    if (textPtr->yScrollbarObj != NULL) {
+		Tcl_SetObjResult(interp, textPtr->yScrollbarObj);
+	    }
+	    break;
+	}
+	result = TextAttachYScrollbar(interp, textPtr, objv[3]);
+	break;
     case TEXT_BBOX: {
 	int x, y, width, height;
 	const TkTextIndex *indexPtr;
@@ -757,6 +902,9 @@ TextWidgetObjCmd(
 	}
 	break;
     }
+    case TEXT_BLOCKSELECT:
+	result = TextBlockSelCmd(textPtr, interp, objc, objv);
+	break;
     case TEXT_CGET:
 	if (objc != 3) {
 	    Tcl_WrongNumArgs(interp, 2, objv, "option");
@@ -863,7 +1011,8 @@ TextWidgetObjCmd(
 	}
 
 	for (i = 2; i < objc-2; i++) {
-	    int value;
+	    int value = 0;
+	    Tcl_Obj *valueObj = NULL;
 	    TkSizeT length;
 	    const char *option = Tcl_GetStringFromObj(objv[i], &length);
 	    char c;
@@ -1003,6 +1152,36 @@ TextWidgetObjCmd(
 		index = *indexToPtr;
 		TkTextFindDisplayLineEnd(textPtr, &index, 0, &x2);
 		value = x2 - x1;
+	    } else if (c == 'y' && (length > 8)
+		    && !strncmp("-ypixelslist", option, length)) {
+		const TkTextIndex *fromPtr = indexFromPtr;
+		const TkTextIndex *toPtr = indexToPtr;
+		TkTextLine *linePtr;
+
+		/*
+		 * Return the cached pixel height of every logical line from
+		 * the line of the first index up to, but not including, the
+		 * line of the second index, read directly off the B-tree.
+		 * One walk here replaces a separate [count -ypixels] call
+		 * per line when a client builds a document overview.
+		 */
+
+		if (TkTextIndexCmp(fromPtr, toPtr) > 0) {
+		    fromPtr = indexToPtr;
+		    toPtr = indexFromPtr;
+		}
+		if (update) {
+		    TkTextUpdateLineMetrics(textPtr,
+			    TkBTreeLinesTo(textPtr, fromPtr->linePtr),
+			    TkBTreeLinesTo(textPtr, toPtr->linePtr), -1);
+		}
+		valueObj = Tcl_NewObj();
+		for (linePtr = fromPtr->linePtr; linePtr != toPtr->linePtr;
+			linePtr = TkBTreeNextLine(textPtr, linePtr)) {
+		    Tcl_ListObjAppendElement(NULL, valueObj,
+			    Tcl_NewWideIntObj(
+			    TkBTreeLinePixelCount(textPtr, linePtr)));
+		}
 	    } else if (c == 'y'
 		    && !strncmp("-ypixels", option, length)) {
 		if (update) {
@@ -1018,8 +1197,11 @@ TextWidgetObjCmd(
 
 	countDone:
 	    found++;
+	    if (valueObj == NULL) {
+		valueObj = Tcl_NewWideIntObj(value);
+	    }
 	    if (found == 1) {
-		Tcl_SetObjResult(interp, Tcl_NewWideIntObj(value));
+		Tcl_SetObjResult(interp, valueObj);
 	    } else {
 		if (found == 2) {
 		    /*
@@ -1031,7 +1213,7 @@ TextWidgetObjCmd(
 		    Tcl_ListObjAppendElement(NULL, objPtr,
 			    Tcl_GetObjResult(interp));
 		}
-		Tcl_ListObjAppendElement(NULL, objPtr, Tcl_NewWideIntObj(value));
+		Tcl_ListObjAppendElement(NULL, objPtr, valueObj);
 	    }
 	}
 
@@ -1053,7 +1235,7 @@ TextWidgetObjCmd(
 	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
 		"bad option \"%s\": must be -chars, -displaychars, "
 		"-displayindices, -displaylines, -indices, -lines, -update, "
-		"-xpixels, or -ypixels", Tcl_GetString(objv[i])));
+		"-xpixels, -ypixels, or -ypixelslist", Tcl_GetString(objv[i])));
 	Tcl_SetErrorCode(interp, "TK", "TEXT", "INDEX_OPTION", NULL);
 	result = TCL_ERROR;
 	goto done;
@@ -1349,6 +1531,19 @@ TextWidgetObjCmd(
 	}
 	break;
     }
+    case TEXT_HASH:
+	if (objc == 2) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf("%08x",
+		    TkBTreeContentHash(textPtr->sharedTextPtr->tree)));
+	} else if (objc == 3) {
+	    result = TkBTreeContentHashChildren(interp,
+		    textPtr->sharedTextPtr->tree, objv[2]);
+	} else {
+	    Tcl_WrongNumArgs(interp, 2, objv, "?path?");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	break;
     case TEXT_IMAGE:
 	result = TkTextImageCmd(textPtr, interp, objc, objv);
 	break;
@@ -1389,6 +1584,16 @@ TextWidgetObjCmd(
 	}
 	break;
     }
+    case TEXT_LOAD:
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "channel");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (textPtr->state == TK_TEXT_STATE_NORMAL) {
+	    result = TextLoadCmd(textPtr, interp, objv[2]);
+	}
+	break;
     case TEXT_MARK:
 	result = TkTextMarkCmd(textPtr, interp, objc, objv);
 	break;
@@ -1405,6 +1610,30 @@ TextWidgetObjCmd(
 		Tcl_NewBooleanObj(TkTextPendingsync(textPtr)));
 	break;
     }
+    case TEXT_RENDER: {
+	int x, y, width, height;
+	Window drawable;
+
+	if (objc != 7) {
+	    Tcl_WrongNumArgs(interp, 2, objv, "x y width height pixmap");
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if ((Tcl_GetIntFromObj(interp, objv[2], &x) != TCL_OK)
+		|| (Tcl_GetIntFromObj(interp, objv[3], &y) != TCL_OK)
+		|| (Tcl_GetIntFromObj(interp, objv[4], &width) != TCL_OK)
+		|| (Tcl_GetIntFromObj(interp, objv[5], &height) != TCL_OK)) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	if (TkpScanWindowId(interp, Tcl_GetString(objv[6]),
+		&drawable) != TCL_OK) {
+	    result = TCL_ERROR;
+	    goto done;
+	}
+	TkTextRenderRegion(textPtr, x, y, width, height, (Pixmap) drawable);
+	break;
+    }
     case TEXT_REPLACE: {
 	const TkTextIndex *indexFromPtr, *indexToPtr;
 
@@ -1838,6 +2067,98 @@ TextReplaceCmd(
     return result;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TextLoadCmd --
+ *
+ *	This function is invoked to process the "load" option of the widget
+ *	command for text widgets. It replaces the entire content of the widget
+ *	with the remaining data of a channel in one bulk operation, which is
+ *	far cheaper than feeding a large file through repeated "insert"
+ *	commands (one segment chain construction, one tree rebalance, one
+ *	display invalidation and at most one <<Modified>> event).
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	The previous content of the widget is deleted, the channel is read up
+ *	to its end, and the undo and redo stacks are cleared.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+TextLoadCmd(
+    TkText *textPtr,		/* Information about text widget. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    Tcl_Obj *chanObj)		/* Contains the name of the channel to read
+				 * from. */
+{
+    TkSharedText *sharedTextPtr = textPtr->sharedTextPtr;
+    Tcl_Channel chan;
+    Tcl_Obj *contentObj;
+    TkTextIndex index1, index2;
+    int mode, oldUndo, canUndo, canRedo;
+
+    chan = Tcl_GetChannel(interp, Tcl_GetString(chanObj), &mode);
+    if (chan == NULL) {
+	return TCL_ERROR;
+    }
+    if (!(mode & TCL_READABLE)) {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"channel \"%s\" wasn't opened for reading",
+		Tcl_GetString(chanObj)));
+	Tcl_SetErrorCode(interp, "TK", "TEXT", "LOAD", NULL);
+	return TCL_ERROR;
+    }
+
+    contentObj = Tcl_NewObj();
+    Tcl_IncrRefCount(contentObj);
+    if (Tcl_ReadChars(chan, contentObj, -1, 0) == -1) {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"error reading channel \"%s\": %s",
+		Tcl_GetString(chanObj), Tcl_PosixError(interp)));
+	Tcl_DecrRefCount(contentObj);
+	return TCL_ERROR;
+    }
+
+    /*
+     * Replace the whole content in one pass, bypassing the undo stack:
+     * recording the load would keep another copy of the whole file in
+     * memory, so the undo history is cleared instead, as for [$w edit
+     * reset].
+     */
+
+    oldUndo = sharedTextPtr->undo;
+    sharedTextPtr->undo = 0;
+
+    TkTextMakeByteIndex(sharedTextPtr->tree, textPtr, 0, 0, &index1);
+    TkTextMakeByteIndex(sharedTextPtr->tree, textPtr,
+	    TkBTreeNumLines(sharedTextPtr->tree, textPtr), 0, &index2);
+    DeleteIndexRange(NULL, textPtr, &index1, &index2, 1);
+
+    /*
+     * The deletion invalidated index1, so recompute it.
+     */
+
+    TkTextMakeByteIndex(sharedTextPtr->tree, textPtr, 0, 0, &index1);
+    InsertChars(NULL, textPtr, &index1, contentObj, 1);
+    Tcl_DecrRefCount(contentObj);
+
+    sharedTextPtr->undo = oldUndo;
+    sharedTextPtr->lastEditMode = TK_TEXT_EDIT_OTHER;
+    canUndo = TkUndoCanUndo(sharedTextPtr->undoStack);
+    canRedo = TkUndoCanRedo(sharedTextPtr->undoStack);
+    TkUndoClearStacks(sharedTextPtr->undoStack);
+    if (canUndo || canRedo) {
+	GenerateUndoStackEvent(textPtr);
+    }
+
+    return TCL_OK;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -1926,6 +2247,16 @@ DestroyText(
     TkTextFreeDInfo(textPtr);
     textPtr->dInfoPtr = NULL;
 
+    if (textPtr->yScrollbarObj != NULL) {
+	/*
+	 * The attached scrollbar's back pointer self-heals: its "dispatch"
+	 * command drops the linkage when this widget's command is gone.
+	 */
+
+	Tcl_DecrRefCount(textPtr->yScrollbarObj);
+	textPtr->yScrollbarObj = NULL;
+    }
+
     /*
      * Remove ourselves from the peer list.
      */
@@ -2032,6 +2363,10 @@ DestroyText(
 	if (sharedTextPtr->bindingTable != NULL) {
 	    Tk_DeleteBindingTable(sharedTextPtr->bindingTable);
 	}
+	if (sharedTextPtr->elideCacheCnts != NULL) {
+	    ckfree(sharedTextPtr->elideCacheCnts);
+	    ckfree(sharedTextPtr->elideCachePtrs);
+	}
 	ckfree(sharedTextPtr);
     }
 
@@ -2095,10 +2430,13 @@ ConfigureText(
 
     textPtr->sharedTextPtr->undo = textPtr->undo;
     textPtr->sharedTextPtr->maxUndo = textPtr->maxUndo;
+    textPtr->sharedTextPtr->maxUndoSize = textPtr->maxUndoSize;
     textPtr->sharedTextPtr->autoSeparators = textPtr->autoSeparators;
 
     TkUndoSetMaxDepth(textPtr->sharedTextPtr->undoStack,
 	    textPtr->sharedTextPtr->maxUndo);
+    TkUndoSetMaxSize(textPtr->sharedTextPtr->undoStack,
+	    textPtr->sharedTextPtr->maxUndoSize);
 
     /*
      * A few other options also need special processing, such as parsing the
@@ -2681,6 +3019,7 @@ InsertChars(
     }
 
     TkTextChanged(sharedTextPtr, NULL, indexPtr, indexPtr);
+    RecordEditDelta(sharedTextPtr, indexPtr, indexPtr);
 
     sharedTextPtr->stateEpoch++;
 
@@ -3318,6 +3657,7 @@ DeleteIndexRange(
 	}
 	sharedTextPtr->stateEpoch++;
 
+	RecordEditDelta(sharedTextPtr, &index1, &index2);
 	TkBTreeDeleteIndexRange(sharedTextPtr->tree, &index1, &index2);
 
     	UpdateDirtyFlag(sharedTextPtr);
@@ -3835,6 +4175,7 @@ TextSearchCmd(
     searchSpec.addLineProc = &TextSearchAddNextLine;
     searchSpec.foundMatchProc = &TextSearchFoundMatch;
     searchSpec.lineIndexProc = &TextSearchGetLineIndex;
+    searchSpec.fastProc = &TextSearchFastExact;
 
     /*
      * Parse switches and other arguments.
@@ -4479,6 +4820,281 @@ TextSearchFoundMatch(
     return 1;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TextSearchFastExact --
+ *
+ *	Dedicated engine for forward exact searches whose pattern fits on a
+ *	single line. It runs a Boyer-Moore-Horspool scan directly over the
+ *	bytes of the B-tree's character segments, so lines without a match
+ *	(the vast majority, in a large widget) are rejected without building
+ *	a Tcl object holding the line's text. The engine declines any search
+ *	needing features that only the generic SearchCore machinery provides:
+ *	backwards or case-insensitive searches, multi-line patterns, and
+ *	widgets in which text may be elided (unless -elide was given, in
+ *	which case elided text is searched like any other).
+ *
+ * Results:
+ *	A standard Tcl result code. '*handledPtr' is set to 1 if the search
+ *	was performed here, and 0 if the caller must fall back to SearchCore.
+ *
+ * Side effects:
+ *	Same as SearchCore: the 'foundMatchProc' of the search specification
+ *	is called for each match found.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+TextSearchFastExact(
+    TCL_UNUSED(Tcl_Interp *),	/* For error messages (none can occur). */
+    SearchSpec *searchSpecPtr,	/* Search parameters. */
+    Tcl_Obj *patObj,		/* Contains an exact string to search for. */
+    int *handledPtr)		/* For returning whether the search was
+				 * performed by this engine. */
+{
+    TkText *textPtr = (TkText *)searchSpecPtr->clientData;
+    TkText *peerPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+    Tcl_DString lineBuffer;
+    const char *pattern, *nl;
+    int patLen, skip[256];
+    int lineNum, passes, i;
+
+    *handledPtr = 0;
+
+    if (!searchSpecPtr->exact || searchSpecPtr->backwards
+	    || searchSpecPtr->noCase) {
+	return TCL_OK;
+    }
+
+    /*
+     * An empty pattern and patterns containing an inner newline (i.e.
+     * multi-line matches) have special treatment in SearchCore. A newline as
+     * the very last byte is harmless, since every line's text ends with its
+     * newline character.
+     */
+
+    pattern = Tcl_GetStringFromObj(patObj, &patLen);
+    if (patLen == 0) {
+	return TCL_OK;
+    }
+    nl = strchr(pattern, '\n');
+    if (nl != NULL && nl[1] != '\0') {
+	return TCL_OK;
+    }
+
+    /*
+     * If any tag may elide text, then the searchable text differs from the
+     * raw segment bytes and the elision-aware machinery must be used. The
+     * selection tags are per-peer and not listed in the shared tag table.
+     */
+
+    if (!searchSpecPtr->searchElide) {
+	for (hPtr = Tcl_FirstHashEntry(&textPtr->sharedTextPtr->tagTable,
+		&search); hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	    if (((TkTextTag *) Tcl_GetHashValue(hPtr))->elideString != NULL) {
+		return TCL_OK;
+	    }
+	}
+	for (peerPtr = textPtr->sharedTextPtr->peers; peerPtr != NULL;
+		peerPtr = peerPtr->next) {
+	    if (peerPtr->selTagPtr->elideString != NULL) {
+		return TCL_OK;
+	    }
+	}
+    }
+
+    *handledPtr = 1;
+
+    /*
+     * Build the Boyer-Moore-Horspool skip table: how far the scan may safely
+     * advance given the last byte of the current window.
+     */
+
+    for (i = 0; i < 256; i++) {
+	skip[i] = patLen;
+    }
+    for (i = 0; i < patLen - 1; i++) {
+	skip[UCHAR(pattern[i])] = patLen - 1 - i;
+    }
+
+    /*
+     * Keep a reference here, so that we can be sure the object doesn't
+     * disappear behind our backs and invalidate its contents which we are
+     * using.
+     */
+
+    Tcl_IncrRefCount(patObj);
+    Tcl_DStringInit(&lineBuffer);
+
+    /*
+     * Scan through the lines circularly, starting at the given index. This
+     * mirrors the line handling of SearchCore for forward searches: the
+     * start line is visited twice, first for the part after the starting
+     * offset and, after wrapping around, for the part before it.
+     */
+
+    lineNum = searchSpecPtr->startLine;
+    for (passes = 0; passes < 2; ) {
+	TkTextLine *linePtr;
+	TkTextSegment *segPtr, *charSegPtr;
+	Tcl_Obj *theLine = NULL;
+	const char *lineBytes;
+	int lineLen, numCharSegs, firstOffset, lastOffset;
+
+	if (lineNum >= searchSpecPtr->numLines) {
+	    /*
+	     * Don't search the dummy last line of the text.
+	     */
+
+	    goto nextLine;
+	}
+
+	linePtr = TkBTreeFindLine(textPtr->sharedTextPtr->tree, textPtr,
+		lineNum);
+	if (linePtr == NULL) {
+	    goto nextLine;
+	}
+
+	/*
+	 * Collect the line's character bytes. A line normally consists of a
+	 * single character segment, which can be scanned in place; only lines
+	 * which are split up by marks, windows or images need their segments
+	 * gathered into the scratch buffer.
+	 */
+
+	lineLen = 0;
+	numCharSegs = 0;
+	charSegPtr = NULL;
+	for (segPtr = linePtr->segPtr; segPtr != NULL;
+		segPtr = segPtr->nextPtr) {
+	    if (segPtr->typePtr == &tkTextCharType) {
+		charSegPtr = segPtr;
+		numCharSegs++;
+		lineLen += segPtr->size;
+	    }
+	}
+	if (numCharSegs == 1) {
+	    lineBytes = charSegPtr->body.chars;
+	} else {
+	    Tcl_DStringSetLength(&lineBuffer, 0);
+	    for (segPtr = linePtr->segPtr; segPtr != NULL;
+		    segPtr = segPtr->nextPtr) {
+		if (segPtr->typePtr == &tkTextCharType) {
+		    Tcl_DStringAppend(&lineBuffer, segPtr->body.chars,
+			    segPtr->size);
+		}
+	    }
+	    lineBytes = Tcl_DStringValue(&lineBuffer);
+	}
+
+	firstOffset = 0;
+	lastOffset = lineLen;
+
+	if (lineNum == searchSpecPtr->startLine) {
+	    passes++;
+	    if (passes == 1) {
+		/*
+		 * First pass: only use the last part of the line.
+		 */
+
+		if ((int)searchSpecPtr->startOffset > firstOffset) {
+		    firstOffset = searchSpecPtr->startOffset;
+		}
+		if (firstOffset >= lastOffset) {
+		    goto nextLine;
+		}
+	    } else {
+		/*
+		 * Second pass: use only the first part of the line.
+		 */
+
+		if ((int)searchSpecPtr->startOffset < lastOffset) {
+		    lastOffset = searchSpecPtr->startOffset;
+		}
+	    }
+	}
+
+	/*
+	 * The Boyer-Moore-Horspool scan itself. 'lastOffset' is one beyond
+	 * the last position at which a match is allowed to begin.
+	 */
+
+	i = firstOffset;
+	while (i + patLen <= lineLen) {
+	    int c = UCHAR(lineBytes[i + patLen - 1]);
+
+	    if ((c == UCHAR(pattern[patLen - 1]))
+		    && (memcmp(lineBytes + i, pattern, patLen) == 0)) {
+		if (i >= lastOffset) {
+		    break;
+		}
+		if (searchSpecPtr->strictLimits && (i + patLen > lastOffset)) {
+		    break;
+		}
+
+		/*
+		 * The 'foundMatchProc' needs the text of the line, which is
+		 * only built for the (rare) lines actually holding a match.
+		 */
+
+		if (theLine == NULL) {
+		    theLine = Tcl_NewStringObj(lineBytes, lineLen);
+		    Tcl_IncrRefCount(theLine);
+		}
+
+		if (!searchSpecPtr->all) {
+		    searchSpecPtr->foundMatchProc(lineNum, searchSpecPtr,
+			    linePtr, theLine, i, patLen);
+		    Tcl_DecrRefCount(theLine);
+		    goto searchDone;
+		}
+		if (!searchSpecPtr->foundMatchProc(lineNum, searchSpecPtr,
+			linePtr, theLine, i, patLen)) {
+		    /*
+		     * We reached the end of the search.
+		     */
+
+		    Tcl_DecrRefCount(theLine);
+		    goto searchDone;
+		}
+		if (searchSpecPtr->overlap) {
+		    int ch;
+
+		    i += TkUtfToUniChar(lineBytes + i, &ch);
+		} else {
+		    i += patLen;
+		}
+	    } else {
+		i += skip[c];
+	    }
+	}
+	if (theLine != NULL) {
+	    Tcl_DecrRefCount(theLine);
+	}
+
+	/*
+	 * Go to the next line.
+	 */
+
+    nextLine:
+	if (lineNum == searchSpecPtr->stopLine) {
+	    goto searchDone;
+	}
+	lineNum++;
+	if (lineNum >= searchSpecPtr->numLines) {
+	    lineNum = 0;
+	}
+    }
+  searchDone:
+    Tcl_DStringFree(&lineBuffer);
+    Tcl_DecrRefCount(patObj);
+    return TCL_OK;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -5228,6 +5844,285 @@ TextEditRedo(
     return status;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TextBlockSelCmd --
+ *
+ *	Handle the subcommands to "$text blockselect ...". See documentation
+ *	for details.
+ *
+ *	The block is a rectangle in line/character-column space. Setting and
+ *	clearing it only toggle widget state and schedule a redraw - the
+ *	highlight itself is painted by the display code - and the column
+ *	insert/delete forms modify every line of the block through one bulk
+ *	B-tree operation with a single display invalidation, rather than the
+ *	per-line widget commands (and per-line invalidations) that a
+ *	script-level column mode needs.
+ *
+ * Results:
+ *	A standard Tcl result.
+ *
+ * Side effects:
+ *	Depends on the sub-command; see documentation.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+TextBlockSelCmd(
+    TkText *textPtr,		/* Information about text widget. */
+    Tcl_Interp *interp,		/* Current interpreter. */
+    int objc,			/* Number of arguments. */
+    Tcl_Obj *const objv[])	/* Argument objects. */
+{
+    static const char *const blockOptionStrings[] = {
+	"clear", "delete", "insert", "ranges", "set", NULL
+    };
+    enum blockOptions {
+	BLOCK_CLEAR, BLOCK_DELETE, BLOCK_INSERT, BLOCK_RANGES, BLOCK_SET
+    };
+    TkSharedText *sharedTextPtr = textPtr->sharedTextPtr;
+    TkTextIndex index1, index2;
+    int idx, line1, line2, col1, col2, lineNo, numLines, tmp;
+
+    if (objc < 3) {
+	Tcl_WrongNumArgs(interp, 2, objv, "option ?arg ...?");
+	return TCL_ERROR;
+    }
+
+    if (Tcl_GetIndexFromObjStruct(interp, objv[2], blockOptionStrings,
+	    sizeof(char *), "blockselect option", 0, &idx) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    /*
+     * Normalized copies of the block corners, clamped to the lines the
+     * widget actually has; the stored values are only touched by "set" and
+     * by the editing forms below.
+     */
+
+    line1 = textPtr->blockSelLine1;
+    line2 = textPtr->blockSelLine2;
+    col1 = textPtr->blockSelCol1;
+    col2 = textPtr->blockSelCol2;
+    if (line2 < line1) {
+	tmp = line1; line1 = line2; line2 = tmp;
+    }
+    if (col2 < col1) {
+	tmp = col1; col1 = col2; col2 = tmp;
+    }
+    numLines = TkBTreeNumLines(sharedTextPtr->tree, textPtr);
+    if (line2 >= numLines) {
+	line2 = numLines - 1;
+    }
+
+    switch ((enum blockOptions) idx) {
+    case BLOCK_CLEAR:
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 3, objv, NULL);
+	    return TCL_ERROR;
+	}
+	if (textPtr->blockSelActive) {
+	    textPtr->blockSelActive = 0;
+	    TkTextRedrawRegion(textPtr, 0, 0, Tk_Width(textPtr->tkwin),
+		    Tk_Height(textPtr->tkwin));
+	}
+	break;
+    case BLOCK_DELETE:
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 3, objv, NULL);
+	    return TCL_ERROR;
+	}
+	if (!textPtr->blockSelActive) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "no block selection", -1));
+	    Tcl_SetErrorCode(interp, "TK", "TEXT", "NO_BLOCK", NULL);
+	    return TCL_ERROR;
+	}
+	if ((textPtr->state != TK_TEXT_STATE_NORMAL) || (col1 == col2)
+		|| (line1 >= numLines)) {
+	    break;
+	}
+
+	/*
+	 * Record the undo information while the doomed characters are still
+	 * in the tree. The per-line actions sit between two separators, so
+	 * one [edit undo] reverts the whole column edit.
+	 */
+
+	if (sharedTextPtr->undo) {
+	    if (sharedTextPtr->autoSeparators
+		    && (sharedTextPtr->lastEditMode != TK_TEXT_EDIT_DELETE)) {
+		TkUndoInsertUndoSeparator(sharedTextPtr->undoStack);
+	    }
+	    sharedTextPtr->lastEditMode = TK_TEXT_EDIT_DELETE;
+	    for (lineNo = line1; lineNo <= line2; lineNo++) {
+		TkTextMakeCharIndex(sharedTextPtr->tree, textPtr, lineNo,
+			col1, &index1);
+		TkTextMakeCharIndex(sharedTextPtr->tree, textPtr, lineNo,
+			col2, &index2);
+		if (TkTextIndexCmp(&index1, &index2) < 0) {
+		    TextPushUndoAction(textPtr,
+			    TextGetText(textPtr, &index1, &index2, 0), 0,
+			    &index1, &index2);
+		}
+	    }
+	}
+
+	TkTextMakeByteIndex(sharedTextPtr->tree, textPtr, line1, 0, &index1);
+	TkTextMakeByteIndex(sharedTextPtr->tree, textPtr, line2, 0, &index2);
+	TkTextChanged(sharedTextPtr, NULL, &index1, &index2);
+	RecordEditDelta(sharedTextPtr, &index1, &index2);
+	sharedTextPtr->stateEpoch++;
+
+	TkBTreeColumnDelete(sharedTextPtr->tree, textPtr, line1, line2,
+		col1, col2);
+
+	UpdateDirtyFlag(sharedTextPtr);
+
+	/*
+	 * The block collapses onto its left edge, ready for column typing.
+	 */
+
+	textPtr->blockSelLine1 = line1;
+	textPtr->blockSelLine2 = line2;
+	textPtr->blockSelCol1 = textPtr->blockSelCol2 = col1;
+	break;
+    case BLOCK_INSERT: {
+	const char *string;
+	TkSizeT length;
+	int *byteCols, numChars;
+	TkTextIndex toIndex;
+
+	if (objc != 4) {
+	    Tcl_WrongNumArgs(interp, 3, objv, "string");
+	    return TCL_ERROR;
+	}
+	if (!textPtr->blockSelActive) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "no block selection", -1));
+	    Tcl_SetErrorCode(interp, "TK", "TEXT", "NO_BLOCK", NULL);
+	    return TCL_ERROR;
+	}
+	string = Tcl_GetStringFromObj(objv[3], &length);
+	if (strchr(string, '\n') != NULL) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "string to insert must not contain newlines", -1));
+	    Tcl_SetErrorCode(interp, "TK", "TEXT", "BLOCK_NEWLINE", NULL);
+	    return TCL_ERROR;
+	}
+	if ((length == 0) || (textPtr->state != TK_TEXT_STATE_NORMAL)
+		|| (line1 >= numLines)) {
+	    break;
+	}
+
+	/*
+	 * Remember where the string lands on each line before the tree
+	 * changes; the clamp of the column to short lines depends on the
+	 * line's current content.
+	 */
+
+	byteCols = (int *)ckalloc((line2 - line1 + 1) * sizeof(int));
+	for (lineNo = line1; lineNo <= line2; lineNo++) {
+	    TkTextMakeCharIndex(sharedTextPtr->tree, textPtr, lineNo, col1,
+		    &index1);
+	    byteCols[lineNo - line1] = index1.byteIndex;
+	}
+
+	TkTextMakeByteIndex(sharedTextPtr->tree, textPtr, line1, 0, &index1);
+	TkTextMakeByteIndex(sharedTextPtr->tree, textPtr, line2, 0, &index2);
+	TkTextChanged(sharedTextPtr, NULL, &index1, &index2);
+	RecordEditDelta(sharedTextPtr, &index1, &index2);
+	sharedTextPtr->stateEpoch++;
+
+	TkBTreeColumnInsert(sharedTextPtr->tree, textPtr, line1, line2,
+		col1, string);
+
+	if (sharedTextPtr->undo) {
+	    if (sharedTextPtr->autoSeparators
+		    && (sharedTextPtr->lastEditMode != TK_TEXT_EDIT_INSERT)) {
+		TkUndoInsertUndoSeparator(sharedTextPtr->undoStack);
+	    }
+	    sharedTextPtr->lastEditMode = TK_TEXT_EDIT_INSERT;
+	    for (lineNo = line1; lineNo <= line2; lineNo++) {
+		TkTextMakeByteIndex(sharedTextPtr->tree, textPtr, lineNo,
+			byteCols[lineNo - line1], &index1);
+		TkTextIndexForwBytes(textPtr, &index1, (int)length, &toIndex);
+		TextPushUndoAction(textPtr, objv[3], 1, &index1, &toIndex);
+	    }
+	}
+	ckfree(byteCols);
+	UpdateDirtyFlag(sharedTextPtr);
+
+	/*
+	 * Move the block past the inserted characters so that repeated
+	 * inserts type a column, the way column mode in an editor does.
+	 */
+
+	numChars = Tcl_GetCharLength(objv[3]);
+	textPtr->blockSelLine1 = line1;
+	textPtr->blockSelLine2 = line2;
+	textPtr->blockSelCol1 = textPtr->blockSelCol2 = col1 + numChars;
+	break;
+    }
+    case BLOCK_RANGES: {
+	Tcl_Obj *resultObj;
+
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 3, objv, NULL);
+	    return TCL_ERROR;
+	}
+	if (!textPtr->blockSelActive || (line1 >= numLines)) {
+	    break;
+	}
+	resultObj = Tcl_NewObj();
+	for (lineNo = line1; lineNo <= line2; lineNo++) {
+	    TkTextMakeCharIndex(sharedTextPtr->tree, textPtr, lineNo, col1,
+		    &index1);
+	    TkTextMakeCharIndex(sharedTextPtr->tree, textPtr, lineNo, col2,
+		    &index2);
+	    if (TkTextIndexCmp(&index1, &index2) < 0) {
+		Tcl_ListObjAppendElement(NULL, resultObj,
+			TkTextNewIndexObj(textPtr, &index1));
+		Tcl_ListObjAppendElement(NULL, resultObj,
+			TkTextNewIndexObj(textPtr, &index2));
+	    }
+	}
+	Tcl_SetObjResult(interp, resultObj);
+	break;
+    }
+    case BLOCK_SET: {
+	TkTextIndex lineStart;
+
+	if (objc != 5) {
+	    Tcl_WrongNumArgs(interp, 3, objv, "index1 index2");
+	    return TCL_ERROR;
+	}
+	if ((TkTextGetObjIndex(interp, textPtr, objv[3], &index1) != TCL_OK)
+		|| (TkTextGetObjIndex(interp, textPtr, objv[4],
+		&index2) != TCL_OK)) {
+	    return TCL_ERROR;
+	}
+	textPtr->blockSelLine1 = TkBTreeLinesTo(textPtr, index1.linePtr);
+	TkTextMakeByteIndex(sharedTextPtr->tree, textPtr,
+		textPtr->blockSelLine1, 0, &lineStart);
+	textPtr->blockSelCol1 = TkTextIndexCount(textPtr, &lineStart,
+		&index1, COUNT_INDICES);
+	textPtr->blockSelLine2 = TkBTreeLinesTo(textPtr, index2.linePtr);
+	TkTextMakeByteIndex(sharedTextPtr->tree, textPtr,
+		textPtr->blockSelLine2, 0, &lineStart);
+	textPtr->blockSelCol2 = TkTextIndexCount(textPtr, &lineStart,
+		&index2, COUNT_INDICES);
+	textPtr->blockSelActive = 1;
+	TkTextRedrawRegion(textPtr, 0, 0, Tk_Width(textPtr->tkwin),
+		Tk_Height(textPtr->tkwin));
+	break;
+    }
+    }
+    return TCL_OK;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -5257,12 +6152,12 @@ TextEditCmd(
     int canUndo = 0;
 
     static const char *const editOptionStrings[] = {
-	"canundo", "canredo", "modified", "redo", "reset", "separator",
-	"undo", NULL
+	"canundo", "canredo", "delta", "modified", "redo", "reset",
+	"separator", "undo", NULL
     };
     enum editOptions {
-	EDIT_CANUNDO, EDIT_CANREDO, EDIT_MODIFIED, EDIT_REDO, EDIT_RESET,
-	EDIT_SEPARATOR, EDIT_UNDO
+	EDIT_CANUNDO, EDIT_CANREDO, EDIT_DELTA, EDIT_MODIFIED, EDIT_REDO,
+	EDIT_RESET, EDIT_SEPARATOR, EDIT_UNDO
     };
 
     if (objc < 3) {
@@ -5296,6 +6191,62 @@ TextEditCmd(
 	}
 	Tcl_SetObjResult(interp, Tcl_NewBooleanObj(canUndo));
 	break;
+    case EDIT_DELTA: {
+	TkSharedText *sharedTextPtr = textPtr->sharedTextPtr;
+	TkTextIndex first, last;
+	Tcl_Obj *resultObj;
+	int startLine, endLine, peerStart, peerLines;
+
+	if (objc != 3) {
+	    Tcl_WrongNumArgs(interp, 3, objv, NULL);
+	    return TCL_ERROR;
+	}
+	if (sharedTextPtr->deltaStartLine < 0) {
+	    break;
+	}
+	startLine = sharedTextPtr->deltaStartLine;
+	endLine = TkBTreeNumLines(sharedTextPtr->tree, NULL)
+		- sharedTextPtr->deltaEndDist;
+	sharedTextPtr->deltaStartLine = -1;
+	sharedTextPtr->deltaEndDist = 0;
+	if (endLine < startLine) {
+	    endLine = startLine;
+	}
+
+	/*
+	 * Convert from absolute line numbers to this peer's numbering, and
+	 * clip to the lines the peer can actually see. The delta may lie
+	 * entirely outside a restricted peer, in which case it has nothing
+	 * to re-examine.
+	 */
+
+	peerStart = (textPtr->start != NULL)
+		? TkBTreeLinesTo(NULL, textPtr->start) : 0;
+	peerLines = TkBTreeNumLines(sharedTextPtr->tree, textPtr);
+	startLine -= peerStart;
+	endLine -= peerStart;
+	if (endLine < 0 || startLine >= peerLines) {
+	    break;
+	}
+	if (startLine < 0) {
+	    startLine = 0;
+	}
+	if (endLine >= peerLines) {
+	    endLine = peerLines - 1;
+	}
+
+	TkTextMakeByteIndex(sharedTextPtr->tree, textPtr, startLine, 0,
+		&first);
+	TkTextMakeByteIndex(sharedTextPtr->tree, textPtr, endLine + 1, 0,
+		&last);
+	resultObj = Tcl_NewObj();
+	Tcl_ListObjAppendElement(NULL, resultObj,
+		TkTextNewIndexObj(textPtr, &first));
+	Tcl_ListObjAppendElement(NULL, resultObj,
+		TkTextNewIndexObj(textPtr, &last));
+	Tcl_SetObjResult(interp, resultObj);
+	break;
+    }
     case EDIT_MODIFIED:
 	if (objc == 3) {
 	    Tcl_SetObjResult(interp,
@@ -5578,6 +6529,58 @@ UpdateDirtyFlag(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * RecordEditDelta --
+ *
+ *	Fold the range about to be modified by an insertion or deletion into
+ *	the accumulated modification delta reported by the "edit delta"
+ *	widget command. Must be called before the B-tree is changed, while
+ *	both indices still refer to existing lines.
+ *
+ *	The start is stored as an absolute line number and the end as a
+ *	distance from the last line of the text, so both survive however
+ *	later edits shift the lines in between: an edit above the recorded
+ *	start simply replaces it (it is the new minimum), an edit below the
+ *	recorded end replaces the end distance, and edits between the two
+ *	change neither value.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The delta fields in the shared structure are widened to cover the
+ *	given range.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+RecordEditDelta(
+    TkSharedText *sharedTextPtr,/* Shared portion of peer widgets. */
+    const TkTextIndex *index1Ptr,
+				/* Start of the range being modified. */
+    const TkTextIndex *index2Ptr)
+				/* End of the range being modified. */
+{
+    int startLine = TkBTreeLinesTo(NULL, index1Ptr->linePtr);
+    int endDist = TkBTreeNumLines(sharedTextPtr->tree, NULL)
+	    - TkBTreeLinesTo(NULL, index2Ptr->linePtr);
+
+    if (sharedTextPtr->deltaStartLine < 0) {
+	sharedTextPtr->deltaStartLine = startLine;
+	sharedTextPtr->deltaEndDist = endDist;
+	return;
+    }
+    if (startLine < sharedTextPtr->deltaStartLine) {
+	sharedTextPtr->deltaStartLine = startLine;
+    }
+    if (endDist < sharedTextPtr->deltaEndDist) {
+	sharedTextPtr->deltaEndDist = endDist;
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -5707,6 +6710,21 @@ SearchPerform(
      * regexp pattern depending on the flags in searchSpecPtr.
      */
 
+    /*
+     * Give the dedicated fast engine a chance to run the search; it declines
+     * the searches it cannot handle.
+     */
+
+    if (searchSpecPtr->fastProc != NULL) {
+	int handled = 0;
+	int code = searchSpecPtr->fastProc(interp, searchSpecPtr, patObj,
+		&handled);
+
+	if (handled) {
+	    return code;
+	}
+    }
+
     return SearchCore(interp, searchSpecPtr, patObj);
 }
 
@@ -43,6 +43,13 @@ typedef struct TkTextLine {
 				 * asychronously. The second of these is the
 				 * last epoch at which the pixel height was
 				 * recalculated. */
+    unsigned int contentHash;	/* Hash of the character content of this
+				 * line. Only meaningful while hashValid is
+				 * set; recomputed lazily by the B-tree's
+				 * content hash queries. */
+    int hashValid;		/* Non-zero means contentHash is up to
+				 * date. Cleared whenever the line's
+				 * character content changes. */
 } TkTextLine;
 
 /*
@@ -78,6 +85,13 @@ typedef struct TkTextMark {
 				 * segment. */
     Tcl_HashEntry *hPtr;	/* Pointer to hash table entry for mark (in
 				 * sharedTextPtr->markTable). */
+    int cachedByteIndex;	/* Byte index of the mark within its line, as
+				 * last computed by TkTextMarkSegToIndex. */
+    TkSizeT cachedEpoch;	/* Value of the B-tree state epoch when
+				 * cachedByteIndex was computed. Every
+				 * operation that can shift byte offsets
+				 * within a line increments that epoch, so
+				 * the cache is valid while they match. */
 } TkTextMark;
 
 /*
@@ -148,6 +162,12 @@ typedef struct TkTextEmbImage {
 				 * definitions in tkTextImage.c. */
     int padX, padY;		/* Padding to leave around each side of image,
 				 * in pixels. */
+    int width, height;		/* Dimensions to reserve for the image, in
+				 * pixels, or 0 to use the image's own size.
+				 * When both are set the segment's geometry
+				 * never depends on the image, so images that
+				 * arrive or change asynchronously don't
+				 * require line metrics to be recomputed. */
     int chunkCount;		/* Number of display chunks that refer to this
 				 * image. */
     Tk_OptionTable optionTable;	/* Token representing the configuration
@@ -576,6 +596,27 @@ typedef struct TkSharedText {
 				 * cached TkTextIndex objects are no longer
 				 * valid. */
 
+    /*
+     * Cache of the accumulated elide tag toggle counts at the start of one
+     * text line, maintained by TkTextIsElided (tkTextBTree.c) so that
+     * repeated elide queries in and around the same line do not rescan the
+     * B-tree. The cache is valid only while the state epoch and the number
+     * of tags are unchanged; it is flushed explicitly when a tag is deleted.
+     */
+
+    TkTextLine *elideCacheLinePtr;
+				/* Line whose start-of-line toggle counts are
+				 * cached below, or NULL if the cache is
+				 * empty. */
+    TkSizeT elideCacheEpoch;	/* Value of stateEpoch when the cache was
+				 * filled. */
+    int elideCacheNumTags;	/* Number of entries allocated in the two
+				 * arrays below. */
+    int *elideCacheCnts;	/* Accumulated toggle count for each tag
+				 * priority, or NULL. Malloc-ed. */
+    TkTextTag **elideCachePtrs;	/* Tag pointers corresponding to the counts,
+				 * or NULL. Malloc-ed. */
+
     /*
      * Information related to the undo/redo functionality.
      */
@@ -586,6 +627,8 @@ typedef struct TkSharedText {
     int maxUndo;		/* The maximum depth of the undo stack
 				 * expressed as the maximum number of compound
 				 * statements. */
+    int maxUndoSize;		/* The maximum number of bytes the undo stack
+				 * may retain, or <= 0 for no limit. */
     int autoSeparators;		/* Non-zero means the separators will be
 				 * inserted automatically. */
     int undoMarkId;             /* Counts undo marks temporarily used during
@@ -599,6 +642,21 @@ typedef struct TkSharedText {
     TkTextEditMode lastEditMode;/* Keeps track of what the last edit mode
 				 * was. */
 
+    /*
+     * Accumulated modification delta, reported and reset by the "edit
+     * delta" widget command. The delta is kept with line granularity: the
+     * start as an absolute line number and the end as a distance from the
+     * last line of the B-tree, so that neither value is disturbed by
+     * subsequent edits on the other side of it.
+     */
+
+    int deltaStartLine;		/* First line modified since the last "edit
+				 * delta" retrieval (absolute numbering, with
+				 * no peer -startline applied), or -1 if
+				 * nothing has been modified. */
+    int deltaEndDist;		/* Distance in lines from the last line of
+				 * the B-tree to the last modified line. */
+
     /*
      * Keep track of all the peers
      */
@@ -708,6 +766,9 @@ typedef struct TkText {
 				 * characters. */
     int setGrid;		/* Non-zero means pass gridding information to
 				 * window manager. */
+    int gutter;			/* Non-zero means render a line-number gutter
+				 * along the left edge of the text area. See
+				 * tkTextDisp.c. */
     int prevWidth, prevHeight;	/* Last known dimensions of window; used to
 				 * detect changes in size. */
     TkTextIndex topIndex;	/* Identifies first character in top display
@@ -740,6 +801,25 @@ typedef struct TkText {
 				 * character to be returned from the
 				 * selection. */
 
+    /*
+     * Information related to the block (rectangular) selection. The
+     * rectangle is stored as two corners in line/character-column space
+     * rather than as indices, so that it needs no adjustment when the text
+     * is edited; lines and columns beyond the current extent of the text
+     * are simply clamped wherever the rectangle is used. The corners are
+     * kept in the order the user gave them; consumers normalize.
+     */
+
+    int blockSelActive;		/* Non-zero means a block selection is set and
+				 * should be overlaid at redisplay time. */
+    int blockSelLine1;		/* Line (0 means first line of this widget)
+				 * and character column of one corner of the
+				 * block. */
+    int blockSelCol1;
+    int blockSelLine2;		/* Line and character column of the opposite
+				 * corner. */
+    int blockSelCol2;
+
     /*
      * Information related to insertion cursor:
      */
@@ -787,6 +867,11 @@ typedef struct TkText {
 				 * horizontal scrollbar when view changes. */
     char *yScrollCmd;		/* Prefix of command to issue to update
 				 * vertical scrollbar when view changes. */
+    Tcl_Obj *yScrollbarObj;	/* Path name of a scrollbar linked directly
+				 * via the "attach" widget command, or NULL.
+				 * When set, vertical view changes are handed
+				 * to the scrollbar in C and yScrollCmd is
+				 * not evaluated. */
     int flags;			/* Miscellaneous flags; see below for
 				 * definitions. */
     Tk_OptionTable optionTable;	/* Token representing the configuration
@@ -806,6 +891,8 @@ typedef struct TkText {
     int maxUndo;		/* The maximum depth of the undo stack
 				 * expressed as the maximum number of compound
 				 * statements. */
+    int maxUndoSize;		/* The maximum number of bytes the undo stack
+				 * may retain, or <= 0 for no limit. */
     int autoSeparators;		/* Non-zero means the separators will be
 				 * inserted automatically. */
     Tcl_Obj *afterSyncCmd;	/* Command to be executed when lines are up to
@@ -993,6 +1080,13 @@ MODULE_SCOPE const Tk_SegType tkTextEmbImageType;
 
 #define TkBTreeLinePixelCount(text, line) \
 	(line)->pixels[2*(text)->pixelReference]
+
+/*
+ * The epoch macro may only be used for reading; writes must go through
+ * TkBTreeLinePixelEpochSet so that the per-node minimum epoch information
+ * in the B-tree stays up to date.
+ */
+
 #define TkBTreeLinePixelEpoch(text, line) \
 	(line)->pixels[1+2*(text)->pixelReference]
 
@@ -1012,9 +1106,18 @@ MODULE_SCOPE void	TkBTreeAddClient(TkTextBTree tree, TkText *textPtr,
 			    int defaultHeight);
 MODULE_SCOPE void	TkBTreeClientRangeChanged(TkText *textPtr,
 			    int defaultHeight);
+MODULE_SCOPE void	TkBTreeColumnDelete(TkTextBTree tree,
+			    TkText *textPtr, int line1, int line2,
+			    int col1, int col2);
+MODULE_SCOPE void	TkBTreeColumnInsert(TkTextBTree tree,
+			    TkText *textPtr, int line1, int line2,
+			    int col, const char *string);
 MODULE_SCOPE void	TkBTreeRemoveClient(TkTextBTree tree,
 			    TkText *textPtr);
 MODULE_SCOPE void	TkBTreeDestroy(TkTextBTree tree);
+MODULE_SCOPE unsigned int TkBTreeContentHash(TkTextBTree tree);
+MODULE_SCOPE int	TkBTreeContentHashChildren(Tcl_Interp *interp,
+			    TkTextBTree tree, Tcl_Obj *pathObj);
 MODULE_SCOPE void	TkBTreeDeleteIndexRange(TkTextBTree tree,
 			    TkTextIndex *index1Ptr, TkTextIndex *index2Ptr);
 MODULE_SCOPE TkSizeT	TkBTreeEpoch(TkTextBTree tree);
@@ -1029,6 +1132,11 @@ MODULE_SCOPE void	TkBTreeInsertChars(TkTextBTree tree,
 			    TkTextIndex *indexPtr, const char *string);
 MODULE_SCOPE int	TkBTreeLinesTo(const TkText *textPtr,
 			    TkTextLine *linePtr);
+MODULE_SCOPE void	TkBTreeLinePixelEpochSet(const TkText *textPtr,
+			    TkTextLine *linePtr, int epoch);
+MODULE_SCOPE TkTextLine *TkBTreeNextDirtyPixelLine(TkTextBTree tree,
+			    const TkText *textPtr, int lineNum, int epoch,
+			    int *lineNumPtr);
 MODULE_SCOPE int	TkBTreePixelsTo(const TkText *textPtr,
 			    TkTextLine *linePtr);
 MODULE_SCOPE void	TkBTreeLinkSegment(TkTextSegment *segPtr,
@@ -1072,6 +1180,7 @@ MODULE_SCOPE void	TkTextEmbWinDisplayProc(TkText *textPtr,
 			    Drawable dst, int screenY);
 MODULE_SCOPE TkTextTag *TkTextCreateTag(TkText *textPtr,
 			    const char *tagName, int *newTag);
+MODULE_SCOPE void	TkTextFlushStyleCache(TkText *textPtr);
 MODULE_SCOPE void	TkTextFreeDInfo(TkText *textPtr);
 MODULE_SCOPE void	TkTextDeleteTag(TkText *textPtr, TkTextTag *tagPtr);
 MODULE_SCOPE void	TkTextFreeTag(TkText *textPtr, TkTextTag *tagPtr);
@@ -1127,6 +1236,7 @@ MODULE_SCOPE int	TkTextUpdateLineMetrics(TkText *textPtr, int lineNum,
 MODULE_SCOPE int	TkTextUpdateOneLine(TkText *textPtr,
 			    TkTextLine *linePtr, int pixelHeight,
 			    TkTextIndex *indexPtr, int partialCalc);
+MODULE_SCOPE void	TkTextUpdateYScrollbar(TkText *textPtr);
 MODULE_SCOPE int	TkTextMarkCmd(TkText *textPtr, Tcl_Interp *interp,
 			    int objc, Tcl_Obj *const objv[]);
 MODULE_SCOPE int	TkTextMarkNameToIndex(TkText *textPtr,
@@ -1147,6 +1257,8 @@ MODULE_SCOPE void	TkTextRedrawTag(TkSharedText *sharedTextPtr,
 			    TkTextIndex *index2Ptr, TkTextTag *tagPtr,
 			    int withTag);
 MODULE_SCOPE void	TkTextRelayoutWindow(TkText *textPtr, int mask);
+MODULE_SCOPE void	TkTextRenderRegion(TkText *textPtr, int x, int y,
+			    int width, int height, Pixmap pixmap);
 MODULE_SCOPE int	TkTextScanCmd(TkText *textPtr, Tcl_Interp *interp,
 			    int objc, Tcl_Obj *const objv[]);
 MODULE_SCOPE int	TkTextSeeCmd(TkText *textPtr, Tcl_Interp *interp,
@@ -76,8 +76,34 @@ typedef struct Node {
     int *numPixels;		/* Array containing total number of vertical
 				 * display pixels in the subtree rooted here,
 				 * one entry for each peer widget. */
+    int *minPixelEpoch;		/* Array containing the minimum pixel
+				 * calculation epoch of any line in the
+				 * subtree rooted here, one entry for each
+				 * peer widget. May be lower than the true
+				 * minimum (which merely disables an
+				 * optimization), but never higher. Lets
+				 * metric update scans skip subtrees whose
+				 * lines are all up to date. */
+    unsigned int contentHash;	/* Hash over the content hashes of the
+				 * children of this node. Only meaningful
+				 * while hashValid is set; recomputed lazily
+				 * by the content hash queries. */
+    int hashValid;		/* Non-zero means contentHash is up to date.
+				 * Cleared whenever the character content or
+				 * the child structure of the subtree rooted
+				 * here changes. */
 } Node;
 
+/*
+ * Parameters of the FNV-1a hash used for the content hashes. Hashing one
+ * value into another mixes its four bytes individually, so a node's hash
+ * depends on the order as well as the values of its children's hashes.
+ */
+
+#define HASH_OFFSET_BASIS	2166136261u
+#define HASH_PRIME		16777619u
+#define HASH_MIX_BYTE(h, b)	(((h) ^ (unsigned char) (b)) * HASH_PRIME)
+
 /*
  * Used to avoid having to allocate and deallocate arrays on the fly for
  * commonly used functions. Must be > 0.
@@ -115,21 +141,6 @@ typedef struct BTree {
     TkText **startEndRef;
 } BTree;
 
-/*
- * The structure below is used to pass information between
- * TkBTreeGetTags and IncCount:
- */
-
-typedef struct TagInfo {
-    int numTags;		/* Number of tags for which there is currently
-				 * information in tags and counts. */
-    int arraySize;		/* Number of entries allocated for tags and
-				 * counts. */
-    TkTextTag **tagPtrs;	/* Array of tags seen so far. Malloc-ed. */
-    int *counts;		/* Toggle count (so far) for each entry in
-				 * tags. Malloc-ed. */
-} TagInfo;
-
 /*
  * Variable that indicates whether to enable consistency checks for debugging.
  */
@@ -145,6 +156,14 @@ int tkBTreeDebug = 0;
 #define TSEG_SIZE (offsetof(TkTextSegment, body) \
 	+ sizeof(TkTextToggle))
 
+/*
+ * Maximum number of lines that TkTextIsElided will scan forward to bring the
+ * elide state cache up to the queried line before it falls back to a full
+ * recomputation from the B-tree:
+ */
+
+#define ELIDE_CACHE_SCAN_LINES 64
+
 /*
  * Forward declarations for functions defined in this file:
  */
@@ -164,12 +183,18 @@ static TkTextSegment *	CharCleanupProc(TkTextSegment *segPtr,
 static TkTextSegment *	CharSplitProc(TkTextSegment *segPtr, TkSizeT index);
 static void		CheckNodeConsistency(Node *nodePtr, int references);
 static void		CleanupLine(TkTextLine *linePtr);
+static void		CountElideToggles(TkTextLine *linePtr, int *tagCnts,
+			    TkTextTag **tagPtrs);
 static void		DeleteSummaries(Summary *tagPtr);
 static void		DestroyNode(Node *nodePtr);
 static TkTextSegment *	FindTagEnd(TkTextBTree tree, TkTextTag *tagPtr,
 			    TkTextIndex *indexPtr);
-static void		IncCount(TkTextTag *tagPtr, int inc,
-			    TagInfo *tagInfoPtr);
+static TkTextLine *	FindDirtyPixelLine(Node *nodePtr,
+			    int pixelReference, int epoch, int skipLines,
+			    int *lineNumPtr);
+static void		InvalidateContentHash(TkTextLine *linePtr);
+static unsigned int	LineContentHash(TkTextLine *linePtr);
+static unsigned int	NodeContentHash(Node *nodePtr);
 static void		Rebalance(BTree *treePtr, Node *nodePtr);
 static void		RecomputeNodeCounts(BTree *treePtr, Node *nodePtr);
 static void		RemovePixelClient(BTree *treePtr, Node *nodePtr,
@@ -291,8 +316,15 @@ TkBTreeCreate(
      */
 
     rootPtr->numPixels = NULL;
+    rootPtr->minPixelEpoch = NULL;
     linePtr->pixels = NULL;
     linePtr2->pixels = NULL;
+    rootPtr->contentHash = 0;
+    rootPtr->hashValid = 0;
+    linePtr->contentHash = 0;
+    linePtr->hashValid = 0;
+    linePtr2->contentHash = 0;
+    linePtr2->hashValid = 0;
 
     linePtr->parentPtr = rootPtr;
     linePtr->nextPtr = linePtr2;
@@ -509,6 +541,254 @@ TkBTreeEpoch(
     return treePtr->stateEpoch;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * InvalidateContentHash --
+ *
+ *	Mark the cached content hash of a line, and of every node on its
+ *	ancestral chain, as out of date. Called by the B-tree operations that
+ *	change character content, while the parent pointers still describe
+ *	the structure being modified.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The next content hash query recomputes the hashes of the marked line
+ *	and nodes; everything else is served from cache.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+InvalidateContentHash(
+    TkTextLine *linePtr)	/* Line whose content is changing. */
+{
+    Node *nodePtr;
+
+    linePtr->hashValid = 0;
+    for (nodePtr = linePtr->parentPtr; nodePtr != NULL;
+	    nodePtr = nodePtr->parentPtr) {
+	nodePtr->hashValid = 0;
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * LineContentHash --
+ *
+ *	Return the hash of the character content of one line, recomputing it
+ *	if the cached value is stale. The hash covers the bytes of the line's
+ *	character segments in order, so splitting or merging segments does
+ *	not change it; marks, tag toggles and embedded windows or images do
+ *	not contribute.
+ *
+ * Results:
+ *	The 32-bit FNV-1a hash of the line's characters.
+ *
+ * Side effects:
+ *	The hash is cached on the line.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static unsigned int
+LineContentHash(
+    TkTextLine *linePtr)	/* Line to hash. */
+{
+    TkTextSegment *segPtr;
+    unsigned int h;
+    TkSizeT i;
+
+    if (linePtr->hashValid) {
+	return linePtr->contentHash;
+    }
+    h = HASH_OFFSET_BASIS;
+    for (segPtr = linePtr->segPtr; segPtr != NULL; segPtr = segPtr->nextPtr) {
+	if (segPtr->typePtr != &tkTextCharType) {
+	    continue;
+	}
+	for (i = 0; i < segPtr->size; i++) {
+	    h = HASH_MIX_BYTE(h, segPtr->body.chars[i]);
+	}
+    }
+    linePtr->contentHash = h;
+    linePtr->hashValid = 1;
+    return h;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * NodeContentHash --
+ *
+ *	Return the hash of the subtree rooted at a node, recomputing it if
+ *	the cached value is stale. A node's hash combines the hashes of its
+ *	children in order, so only the children on the invalidated chains are
+ *	descended into; clean subtrees are served from their caches.
+ *
+ * Results:
+ *	The 32-bit hash of the subtree's character content.
+ *
+ * Side effects:
+ *	Hashes are cached on the node and on any stale descendants.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static unsigned int
+NodeContentHash(
+    Node *nodePtr)		/* Root of the subtree to hash. */
+{
+    unsigned int h, childHash;
+
+    if (nodePtr->hashValid) {
+	return nodePtr->contentHash;
+    }
+    h = HASH_OFFSET_BASIS;
+    if (nodePtr->level == 0) {
+	TkTextLine *linePtr;
+
+	for (linePtr = nodePtr->children.linePtr; linePtr != NULL;
+		linePtr = linePtr->nextPtr) {
+	    childHash = LineContentHash(linePtr);
+	    h = HASH_MIX_BYTE(h, childHash);
+	    h = HASH_MIX_BYTE(h, childHash >> 8);
+	    h = HASH_MIX_BYTE(h, childHash >> 16);
+	    h = HASH_MIX_BYTE(h, childHash >> 24);
+	}
+    } else {
+	Node *childPtr;
+
+	for (childPtr = nodePtr->children.nodePtr; childPtr != NULL;
+		childPtr = childPtr->nextPtr) {
+	    childHash = NodeContentHash(childPtr);
+	    h = HASH_MIX_BYTE(h, childHash);
+	    h = HASH_MIX_BYTE(h, childHash >> 8);
+	    h = HASH_MIX_BYTE(h, childHash >> 16);
+	    h = HASH_MIX_BYTE(h, childHash >> 24);
+	}
+    }
+    nodePtr->contentHash = h;
+    nodePtr->hashValid = 1;
+    return h;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkBTreeContentHash --
+ *
+ *	Return the content hash of the whole tree. After an edit, only the
+ *	O(log n) nodes on the invalidated chains are recomputed.
+ *
+ * Results:
+ *	The 32-bit hash of the tree's character content.
+ *
+ * Side effects:
+ *	Stale cached hashes are refreshed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+unsigned int
+TkBTreeContentHash(
+    TkTextBTree tree)		/* Tree to hash. */
+{
+    BTree *treePtr = (BTree *) tree;
+
+    return NodeContentHash(treePtr->rootPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkBTreeContentHashChildren --
+ *
+ *	Report the content hashes of the children of one node of the tree,
+ *	identified by a path of child indexes descending from the root. This
+ *	is the descent step of a Merkle-style comparison: a consumer holding
+ *	a mirror of the buffer compares the reported hashes with its own and
+ *	recurses only into the children that differ, locating changed
+ *	regions in O(log n) instead of diffing a full dump.
+ *
+ * Results:
+ *	A standard Tcl result. On success the interpreter result is a list
+ *	with one element per child, each a pair of the child's hash (eight
+ *	hex digits) and the number of logical lines the child spans (always
+ *	1 when the addressed node's children are lines).
+ *
+ * Side effects:
+ *	Stale cached hashes in the addressed subtree are refreshed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkBTreeContentHashChildren(
+    Tcl_Interp *interp,		/* For reporting the hashes or errors. */
+    TkTextBTree tree,		/* Tree to query. */
+    Tcl_Obj *pathObj)		/* List of child indexes leading from the root
+				 * to the node to report on; an empty list
+				 * addresses the root itself. */
+{
+    BTree *treePtr = (BTree *) tree;
+    Node *nodePtr = treePtr->rootPtr;
+    Tcl_Obj *resultObj, **pathv, *pair[2];
+    int pathc, i, idx;
+
+    if (Tcl_ListObjGetElements(interp, pathObj, &pathc, &pathv) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    for (i = 0; i < pathc; i++) {
+	Node *childPtr;
+
+	if (Tcl_GetIntFromObj(interp, pathv[i], &idx) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if ((nodePtr->level == 0) || (idx < 0)
+		|| (idx >= nodePtr->numChildren)) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "bad hash path element \"%s\": no such child",
+		    Tcl_GetString(pathv[i])));
+	    Tcl_SetErrorCode(interp, "TK", "TEXT", "HASH_PATH", NULL);
+	    return TCL_ERROR;
+	}
+	for (childPtr = nodePtr->children.nodePtr; idx > 0;
+		childPtr = childPtr->nextPtr, idx--) {
+	    /* Empty loop body. */
+	}
+	nodePtr = childPtr;
+    }
+
+    resultObj = Tcl_NewObj();
+    if (nodePtr->level == 0) {
+	TkTextLine *linePtr;
+
+	for (linePtr = nodePtr->children.linePtr; linePtr != NULL;
+		linePtr = linePtr->nextPtr) {
+	    pair[0] = Tcl_ObjPrintf("%08x", LineContentHash(linePtr));
+	    pair[1] = Tcl_NewWideIntObj(1);
+	    Tcl_ListObjAppendElement(NULL, resultObj,
+		    Tcl_NewListObj(2, pair));
+	}
+    } else {
+	Node *childPtr;
+
+	for (childPtr = nodePtr->children.nodePtr; childPtr != NULL;
+		childPtr = childPtr->nextPtr) {
+	    pair[0] = Tcl_ObjPrintf("%08x", NodeContentHash(childPtr));
+	    pair[1] = Tcl_NewWideIntObj(childPtr->numLines);
+	    Tcl_ListObjAppendElement(NULL, resultObj,
+		    Tcl_NewListObj(2, pair));
+	}
+    }
+    Tcl_SetObjResult(interp, resultObj);
+    return TCL_OK;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -754,8 +1034,11 @@ AdjustPixelClient(
     if (newPixelReferences != treePtr->pixelReferences) {
 	nodePtr->numPixels = (int *)ckrealloc(nodePtr->numPixels,
 		sizeof(int) * newPixelReferences);
+	nodePtr->minPixelEpoch = (int *)ckrealloc(nodePtr->minPixelEpoch,
+		sizeof(int) * newPixelReferences);
     }
     nodePtr->numPixels[useReference] = pixelCount;
+    nodePtr->minPixelEpoch[useReference] = 0;
     return pixelCount;
 }
 
@@ -797,13 +1080,19 @@ RemovePixelClient(
     if (overwriteWithLast != -1) {
 	nodePtr->numPixels[overwriteWithLast] =
 		nodePtr->numPixels[treePtr->pixelReferences-1];
+	nodePtr->minPixelEpoch[overwriteWithLast] =
+		nodePtr->minPixelEpoch[treePtr->pixelReferences-1];
     }
     if (treePtr->pixelReferences == 1) {
 	ckfree(nodePtr->numPixels);
 	nodePtr->numPixels = NULL;
+	ckfree(nodePtr->minPixelEpoch);
+	nodePtr->minPixelEpoch = NULL;
     } else {
 	nodePtr->numPixels = (int *)ckrealloc(nodePtr->numPixels,
 		sizeof(int) * (treePtr->pixelReferences - 1));
+	nodePtr->minPixelEpoch = (int *)ckrealloc(nodePtr->minPixelEpoch,
+		sizeof(int) * (treePtr->pixelReferences - 1));
     }
     if (nodePtr->level != 0) {
 	nodePtr = nodePtr->children.nodePtr;
@@ -878,6 +1167,7 @@ DestroyNode(
     }
     DeleteSummaries(nodePtr->summaryPtr);
     ckfree(nodePtr->numPixels);
+    ckfree(nodePtr->minPixelEpoch);
     ckfree(nodePtr);
 }
 
@@ -979,6 +1269,198 @@ TkBTreeAdjustPixelHeight(
 
     return nodePtr->numPixels[pixelReference];
 }
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkBTreeLinePixelEpochSet --
+ *
+ *	Set the pixel calculation epoch of a given logical line for the given
+ *	client, keeping the per-node minimum epoch information up to date.
+ *	All epoch writes must go through this function (reads can use the
+ *	TkBTreeLinePixelEpoch macro directly), otherwise the node minima may
+ *	become too large and TkBTreeNextDirtyPixelLine could wrongly skip
+ *	lines that still need recalculation.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The minimum epoch stored in the line's ancestor nodes may be
+ *	adjusted.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkBTreeLinePixelEpochSet(
+    const TkText *textPtr,	/* Client of the B-tree. */
+    TkTextLine *linePtr,	/* The logical line to update. */
+    int epoch)			/* New pixel calculation epoch; zero means the
+				 * line's height is invalid. */
+{
+    int pixelReference = textPtr->pixelReference;
+    Node *nodePtr;
+
+    linePtr->pixels[2 * pixelReference + 1] = epoch;
+
+    /*
+     * Recompute the minimum epoch in each ancestor, stopping as soon as a
+     * node's stored minimum is unchanged (in which case all the remaining
+     * ancestors are unchanged too).
+     */
+
+    for (nodePtr = linePtr->parentPtr; nodePtr != NULL;
+	    nodePtr = nodePtr->parentPtr) {
+	int minEpoch = -1;
+
+	if (nodePtr->level == 0) {
+	    TkTextLine *linePtr2;
+
+	    for (linePtr2 = nodePtr->children.linePtr; linePtr2 != NULL;
+		    linePtr2 = linePtr2->nextPtr) {
+		if ((minEpoch == -1)
+			|| (linePtr2->pixels[2 * pixelReference + 1]
+			< minEpoch)) {
+		    minEpoch = linePtr2->pixels[2 * pixelReference + 1];
+		}
+	    }
+	} else {
+	    Node *childPtr;
+
+	    for (childPtr = nodePtr->children.nodePtr; childPtr != NULL;
+		    childPtr = childPtr->nextPtr) {
+		if ((minEpoch == -1)
+			|| (childPtr->minPixelEpoch[pixelReference]
+			< minEpoch)) {
+		    minEpoch = childPtr->minPixelEpoch[pixelReference];
+		}
+	    }
+	}
+	if (nodePtr->minPixelEpoch[pixelReference] == minEpoch) {
+	    break;
+	}
+	nodePtr->minPixelEpoch[pixelReference] = minEpoch;
+    }
+}
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkBTreeNextDirtyPixelLine --
+ *
+ *	Find the first line at or after the given (absolute) line number
+ *	whose pixel calculation epoch differs from 'epoch', skipping whole
+ *	subtrees whose minimum epoch shows that all of their lines are
+ *	already up to date. This allows a metric update scan of a widget
+ *	whose lines are largely up to date to complete in logarithmic rather
+ *	than linear time.
+ *
+ * Results:
+ *	A pointer to the first such line, or NULL if every line from lineNum
+ *	to the end of the tree is up to date. If lineNumPtr is non-NULL it is
+ *	set to the absolute line number of the returned line.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+TkTextLine *
+TkBTreeNextDirtyPixelLine(
+    TkTextBTree tree,		/* The B-tree. */
+    const TkText *textPtr,	/* Relative to this client of the B-tree. */
+    int lineNum,		/* Absolute line number at which to start the
+				 * search. */
+    int epoch,			/* The client's current line metric update
+				 * epoch; lines whose epoch differs from this
+				 * need recalculation. */
+    int *lineNumPtr)		/* If non-NULL, filled in with the absolute
+				 * line number of the returned line. */
+{
+    BTree *treePtr = (BTree *) tree;
+    TkTextLine *linePtr;
+    int foundLineNum = 0;
+
+    if (lineNum < 0) {
+	lineNum = 0;
+    }
+    linePtr = FindDirtyPixelLine(treePtr->rootPtr, textPtr->pixelReference,
+	    epoch, lineNum, &foundLineNum);
+    if ((linePtr != NULL) && (lineNumPtr != NULL)) {
+	*lineNumPtr = foundLineNum;
+    }
+    return linePtr;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * FindDirtyPixelLine --
+ *
+ *	Recursive guts of TkBTreeNextDirtyPixelLine: search the subtree
+ *	rooted at nodePtr for the first line, ignoring the leading
+ *	'skipLines' lines of the subtree, whose pixel epoch differs from
+ *	'epoch'.
+ *
+ * Results:
+ *	A pointer to the first such line, or NULL if there is none. On
+ *	success *lineNumPtr is set to the offset of the returned line within
+ *	the subtree.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static TkTextLine *
+FindDirtyPixelLine(
+    Node *nodePtr,		/* Subtree to search. */
+    int pixelReference,		/* Pixel reference of the client. */
+    int epoch,			/* The client's current line metric update
+				 * epoch. */
+    int skipLines,		/* Ignore this many leading lines of the
+				 * subtree; may be zero or negative. */
+    int *lineNumPtr)		/* Filled in with the offset of the returned
+				 * line within the subtree. */
+{
+    int offset = 0;
+
+    if (nodePtr->minPixelEpoch[pixelReference] == epoch) {
+	return NULL;
+    }
+    if (nodePtr->level == 0) {
+	TkTextLine *linePtr;
+
+	for (linePtr = nodePtr->children.linePtr; linePtr != NULL;
+		linePtr = linePtr->nextPtr, offset++) {
+	    if ((offset >= skipLines)
+		    && (linePtr->pixels[2 * pixelReference + 1] != epoch)) {
+		*lineNumPtr = offset;
+		return linePtr;
+	    }
+	}
+    } else {
+	Node *childPtr;
+
+	for (childPtr = nodePtr->children.nodePtr; childPtr != NULL;
+		childPtr = childPtr->nextPtr) {
+	    if (offset + childPtr->numLines > skipLines) {
+		TkTextLine *linePtr;
+		int childLineNum;
+
+		linePtr = FindDirtyPixelLine(childPtr, pixelReference,
+			epoch, skipLines - offset, &childLineNum);
+		if (linePtr != NULL) {
+		    *lineNumPtr = offset + childLineNum;
+		    return linePtr;
+		}
+	    }
+	    offset += childPtr->numLines;
+	}
+    }
+    return NULL;
+}
 
 /*
  *----------------------------------------------------------------------
@@ -1036,6 +1518,7 @@ TkBTreeInsertChars(
     prevPtr = SplitSeg(indexPtr);
     linePtr = indexPtr->linePtr;
     curPtr = prevPtr;
+    InvalidateContentHash(linePtr);
 
     /*
      * Chop the string up into lines and create a new segment for each line,
@@ -1085,6 +1568,8 @@ TkBTreeInsertChars(
 	newLinePtr = (TkTextLine *)ckalloc(sizeof(TkTextLine));
 	newLinePtr->pixels = (int *)
 		ckalloc(sizeof(int) * 2 * treePtr->pixelReferences);
+	newLinePtr->contentHash = 0;
+	newLinePtr->hashValid = 0;
 
 	newLinePtr->parentPtr = linePtr->parentPtr;
 	newLinePtr->nextPtr = linePtr->nextPtr;
@@ -1332,6 +1817,18 @@ TkBTreeDeleteIndexRange(
 
     treePtr->stateEpoch++;
 
+    /*
+     * Invalidate the content hashes up both boundary chains while the
+     * parent pointers still describe the pre-deletion structure. Any node
+     * that survives the deletion with fewer children than before contains
+     * one of the two boundary lines, so this covers every surviving node
+     * whose subtree content changes; nodes emptied entirely are freed, and
+     * nodes rearranged by the rebalance below are invalidated there.
+     */
+
+    InvalidateContentHash(index1Ptr->linePtr);
+    InvalidateContentHash(index2Ptr->linePtr);
+
     /*
      * Tricky point: split at index2Ptr first; otherwise the split at
      * index2Ptr may invalidate segPtr and/or prevPtr.
@@ -1442,6 +1939,7 @@ TkBTreeDeleteIndexRange(
 		parentPtr->numChildren--;
 		DeleteSummaries(curNodePtr->summaryPtr);
 		ckfree(curNodePtr->numPixels);
+		ckfree(curNodePtr->minPixelEpoch);
 		ckfree(curNodePtr);
 		curNodePtr = parentPtr;
 	    }
@@ -1572,6 +2070,168 @@ TkBTreeDeleteIndexRange(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * MakeColumnIndex --
+ *
+ *	Fill in an index for a given character column of a given line,
+ *	clamping columns beyond the end of the line to the newline so that
+ *	column-wise operations never spill into the next line. This is the
+ *	inner loop of TkTextMakeCharIndex, restarted from a line pointer
+ *	instead of descending the tree for a line number.
+ *
+ * Results:
+ *	The structure at *indexPtr is filled in.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+MakeColumnIndex(
+    TkTextBTree tree,		/* Tree containing linePtr. */
+    TkTextLine *linePtr,	/* Line the index should refer to. */
+    int charIndex,		/* Character column within the line. */
+    TkTextIndex *indexPtr)	/* Structure to fill in. */
+{
+    TkTextSegment *segPtr;
+    char *p, *start, *end;
+    int index, offset;
+    int ch;
+
+    indexPtr->tree = tree;
+    indexPtr->linePtr = linePtr;
+    index = 0;
+    for (segPtr = linePtr->segPtr; ; segPtr = segPtr->nextPtr) {
+	if (segPtr == NULL) {
+	    /*
+	     * The column lies beyond the line: clamp to the terminating
+	     * newline, which is guaranteed to be the last character.
+	     */
+
+	    indexPtr->byteIndex = index - sizeof(char);
+	    break;
+	}
+	if (segPtr->typePtr == &tkTextCharType) {
+	    start = segPtr->body.chars;
+	    end = start + segPtr->size;
+	    for (p = start; p < end; p += offset) {
+		if (charIndex == 0) {
+		    indexPtr->byteIndex = index;
+		    return;
+		}
+		charIndex--;
+		offset = TkUtfToUniChar(p, &ch);
+		index += offset;
+	    }
+	} else {
+	    if (charIndex < (int)segPtr->size) {
+		indexPtr->byteIndex = index;
+		break;
+	    }
+	    charIndex -= segPtr->size;
+	    index += segPtr->size;
+	}
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkBTreeColumnInsert --
+ *
+ *	Insert the same string at the same character column of every line in
+ *	a range, as one bulk operation. On lines shorter than the column the
+ *	string is appended before the newline. The string must not contain a
+ *	newline, so that the line structure of the tree - and hence the line
+ *	pointers being iterated - is left intact.
+ *
+ *	The caller is responsible for invalidating the display and recording
+ *	undo information; this function only modifies the B-tree, which is
+ *	what lets a column edit across thousands of lines cost a single
+ *	display invalidation instead of one per line.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Characters are added to the B-tree at every line of the range.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkBTreeColumnInsert(
+    TkTextBTree tree,		/* Tree to modify. */
+    TkText *textPtr,		/* Client whose line numbering to use, or NULL
+				 * for absolute numbering. */
+    int line1, int line2,	/* Range of lines to modify, inclusive. */
+    int col,			/* Character column to insert at. */
+    const char *string)		/* Newline-free characters to insert on every
+				 * line. */
+{
+    TkTextLine *linePtr;
+    TkTextIndex index;
+    int lineNo;
+
+    linePtr = TkBTreeFindLine(tree, textPtr, line1);
+    for (lineNo = line1; (lineNo <= line2) && (linePtr != NULL);
+	    lineNo++, linePtr = TkBTreeNextLine(textPtr, linePtr)) {
+	MakeColumnIndex(tree, linePtr, col, &index);
+	TkBTreeInsertChars(tree, &index, string);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkBTreeColumnDelete --
+ *
+ *	Delete the characters between two character columns on every line in
+ *	a range, as one bulk operation. Both columns are clamped to the end
+ *	of each line, so the terminating newlines - and hence the line
+ *	structure of the tree - are never touched.
+ *
+ *	As with TkBTreeColumnInsert, display invalidation and undo recording
+ *	are the caller's business.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Characters are removed from the B-tree on every line of the range.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkBTreeColumnDelete(
+    TkTextBTree tree,		/* Tree to modify. */
+    TkText *textPtr,		/* Client whose line numbering to use, or NULL
+				 * for absolute numbering. */
+    int line1, int line2,	/* Range of lines to modify, inclusive. */
+    int col1, int col2)		/* Delete characters from col1 up to but not
+				 * including col2 on each line. */
+{
+    TkTextLine *linePtr, *nextLinePtr;
+    TkTextIndex index1, index2;
+    int lineNo;
+
+    linePtr = TkBTreeFindLine(tree, textPtr, line1);
+    for (lineNo = line1; (lineNo <= line2) && (linePtr != NULL);
+	    lineNo++, linePtr = nextLinePtr) {
+	nextLinePtr = TkBTreeNextLine(textPtr, linePtr);
+	MakeColumnIndex(tree, linePtr, col1, &index1);
+	MakeColumnIndex(tree, linePtr, col2, &index2);
+	if (index1.byteIndex < index2.byteIndex) {
+	    TkBTreeDeleteIndexRange(tree, &index1, &index2);
+	}
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -2148,6 +2808,16 @@ TkBTreeTag(
     TkTextLine *cleanupLinePtr;
     int oldState, changed, anyChanges = 0;
 
+    /*
+     * Adding or removing an elide tag (even one with "-elide false", which
+     * overrides lower-priority elide tags) changes the accumulated toggle
+     * counts that the elide state cache holds.
+     */
+
+    if (tagPtr->elideString != NULL) {
+	((BTree *) index1Ptr->tree)->sharedTextPtr->elideCacheLinePtr = NULL;
+    }
+
     /*
      * See whether the tag is present at the start of the range. If the state
      * doesn't already match what we want then add a toggle there.
@@ -3322,11 +3992,11 @@ TkBTreeCharTagged(
  * Results:
  *	The return value is a malloc-ed array containing pointers to
  *	information for each of the tags that is associated with the character
- *	at the position given by linePtr and ch. The word at *numTagsPtr is
- *	filled in with the number of pointers in the array. It is up to the
- *	caller to free the array by passing it to free. If there are no tags
- *	at the given character then a NULL pointer is returned and *numTagsPtr
- *	will be set to 0.
+ *	at the position given by linePtr and ch, sorted in increasing order of
+ *	priority. The word at *numTagsPtr is filled in with the number of
+ *	pointers in the array. It is up to the caller to free the array by
+ *	passing it to free. If there are no tags at the given character then a
+ *	NULL pointer is returned and *numTagsPtr will be set to 0.
  *
  * Side effects:
  *	None.
@@ -3348,14 +4018,29 @@ TkBTreeGetTags(
     TkTextLine *siblingLinePtr;
     TkTextSegment *segPtr;
     TkTextLine *linePtr;
-    int src, dst, index;
-    TagInfo tagInfo;
-#define NUM_TAG_INFOS 10
+    TkTextTag *tagPtr;
+    int src, dst, index, numTags;
+    int deftagCnts[LOTSA_TAGS];
+    TkTextTag *deftagPtrs[LOTSA_TAGS];
+    int *tagCnts = deftagCnts;
+    TkTextTag **tagPtrs = deftagPtrs;
+    TkTextTag **resultPtrs;
 
-    tagInfo.numTags = 0;
-    tagInfo.arraySize = NUM_TAG_INFOS;
-    tagInfo.tagPtrs = (TkTextTag **)ckalloc(NUM_TAG_INFOS * sizeof(TkTextTag *));
-    tagInfo.counts = (int *)ckalloc(NUM_TAG_INFOS * sizeof(int));
+    /*
+     * Toggle counts are accumulated in arrays indexed by tag priority, so
+     * recording a toggle is a constant-time operation regardless of how many
+     * tags are in use (cf. TkTextIsElided below). Almost always avoid malloc,
+     * so stay out of system calls.
+     */
+
+    numTags = ((BTree *) indexPtr->tree)->sharedTextPtr->numTags;
+    if (LOTSA_TAGS < numTags) {
+	tagCnts = (int *)ckalloc(sizeof(int) * numTags);
+	tagPtrs = (TkTextTag **)ckalloc(sizeof(TkTextTag *) * numTags);
+    }
+    for (index = 0; index < numTags; index++) {
+	tagCnts[index] = 0;
+    }
 
     /*
      * Record tag toggles within the line of indexPtr but preceding indexPtr.
@@ -3367,7 +4052,9 @@ TkBTreeGetTags(
     while ((index + (int)segPtr->size) <= indexPtr->byteIndex) {
 	if ((segPtr->typePtr == &tkTextToggleOnType)
 		|| (segPtr->typePtr == &tkTextToggleOffType)) {
-	    IncCount(segPtr->body.toggle.tagPtr, 1, &tagInfo);
+	    tagPtr = segPtr->body.toggle.tagPtr;
+	    tagPtrs[tagPtr->priority] = tagPtr;
+	    tagCnts[tagPtr->priority]++;
 	}
 	index += segPtr->size;
 	segPtr = segPtr->nextPtr;
@@ -3395,7 +4082,9 @@ TkBTreeGetTags(
 		segPtr = segPtr->nextPtr) {
 	    if ((segPtr->typePtr == &tkTextToggleOnType)
 		    || (segPtr->typePtr == &tkTextToggleOffType)) {
-		IncCount(segPtr->body.toggle.tagPtr, 1, &tagInfo);
+		tagPtr = segPtr->body.toggle.tagPtr;
+		tagPtrs[tagPtr->priority] = tagPtr;
+		tagCnts[tagPtr->priority]++;
 	    }
 	}
     }
@@ -3415,8 +4104,9 @@ TkBTreeGetTags(
 	    for (summaryPtr = siblingPtr->summaryPtr; summaryPtr != NULL;
 		    summaryPtr = summaryPtr->nextPtr) {
 		if (summaryPtr->toggleCount & 1) {
-		    IncCount(summaryPtr->tagPtr, summaryPtr->toggleCount,
-			    &tagInfo);
+		    tagPtr = summaryPtr->tagPtr;
+		    tagPtrs[tagPtr->priority] = tagPtr;
+		    tagCnts[tagPtr->priority] += summaryPtr->toggleCount;
 		}
 	    }
 	}
@@ -3426,26 +4116,31 @@ TkBTreeGetTags(
      * Go through the tag information and squash out all of the tags that have
      * even toggle counts (these tags exist before the point of interest, but
      * not at the desired character itself). Also squash out all tags that
-     * don't belong to the requested widget.
+     * don't belong to the requested widget. Scanning the priority-indexed
+     * arrays in order leaves the result sorted by priority.
      */
 
-    for (src = 0, dst = 0; src < tagInfo.numTags; src++) {
-	if (tagInfo.counts[src] & 1) {
-	    const TkText *tagTextPtr = tagInfo.tagPtrs[src]->textPtr;
+    resultPtrs = NULL;
+    for (src = 0, dst = 0; src < numTags; src++) {
+	if (tagCnts[src] & 1) {
+	    const TkText *tagTextPtr = tagPtrs[src]->textPtr;
 
 	    if (tagTextPtr==NULL || textPtr==NULL || tagTextPtr==textPtr) {
-		tagInfo.tagPtrs[dst] = tagInfo.tagPtrs[src];
+		if (resultPtrs == NULL) {
+		    resultPtrs = (TkTextTag **)ckalloc(
+			    numTags * sizeof(TkTextTag *));
+		}
+		resultPtrs[dst] = tagPtrs[src];
 		dst++;
 	    }
 	}
     }
-    *numTagsPtr = dst;
-    ckfree(tagInfo.counts);
-    if (dst == 0) {
-	ckfree(tagInfo.tagPtrs);
-	return NULL;
+    if (LOTSA_TAGS < numTags) {
+	ckfree(tagCnts);
+	ckfree(tagPtrs);
     }
-    return tagInfo.tagPtrs;
+    *numTagsPtr = dst;
+    return resultPtrs;
 }
 
 /*
@@ -3492,6 +4187,7 @@ TkTextIsElided(
     TkTextLine *siblingLinePtr;
     TkTextSegment *segPtr;
     TkTextTag *tagPtr = NULL;
+    TkSharedText *sharedTextPtr = textPtr->sharedTextPtr;
     int i, index;
     TkTextElideInfo *infoPtr;
     TkTextLine *linePtr;
@@ -3506,7 +4202,7 @@ TkTextIsElided(
     infoPtr->elide = 0;		/* If nobody says otherwise, it's visible. */
     infoPtr->tagCnts = infoPtr->deftagCnts;
     infoPtr->tagPtrs = infoPtr->deftagPtrs;
-    infoPtr->numTags = textPtr->sharedTextPtr->numTags;
+    infoPtr->numTags = sharedTextPtr->numTags;
 
     /*
      * Almost always avoid malloc, so stay out of system calls.
@@ -3517,8 +4213,111 @@ TkTextIsElided(
 	infoPtr->tagPtrs = (TkTextTag **)ckalloc(sizeof(TkTextTag *) * infoPtr->numTags);
     }
 
-    for (i=0; i<infoPtr->numTags; i++) {
-	infoPtr->tagCnts[i] = 0;
+    /*
+     * Establish the accumulated toggle counts at the start of indexPtr's
+     * line. A cache of this state for one line is kept in the shared text
+     * structure, because successive elide queries overwhelmingly concern
+     * the same line or lines shortly after it (layout and index arithmetic
+     * both walk forwards). On a hit the counts are simply copied; when the
+     * cached line lies at most ELIDE_CACHE_SCAN_LINES before the queried
+     * line the cache is rolled forward by scanning just the intervening
+     * lines; otherwise the counts are recomputed from the B-tree as before
+     * and left in the cache for the next query.
+     */
+
+    if (sharedTextPtr->elideCacheLinePtr == NULL
+	    || sharedTextPtr->elideCacheEpoch != sharedTextPtr->stateEpoch
+	    || sharedTextPtr->elideCacheNumTags != infoPtr->numTags) {
+	sharedTextPtr->elideCacheLinePtr = NULL;
+    } else if (sharedTextPtr->elideCacheLinePtr != indexPtr->linePtr) {
+	TkTextLine *walkPtr = sharedTextPtr->elideCacheLinePtr;
+
+	for (i = 0; i < ELIDE_CACHE_SCAN_LINES && walkPtr != NULL
+		&& walkPtr != indexPtr->linePtr; i++) {
+	    walkPtr = TkBTreeNextLine(NULL, walkPtr);
+	}
+	if (walkPtr == indexPtr->linePtr) {
+	    for (walkPtr = sharedTextPtr->elideCacheLinePtr;
+		    walkPtr != indexPtr->linePtr;
+		    walkPtr = TkBTreeNextLine(NULL, walkPtr)) {
+		CountElideToggles(walkPtr, sharedTextPtr->elideCacheCnts,
+			sharedTextPtr->elideCachePtrs);
+	    }
+	    sharedTextPtr->elideCacheLinePtr = indexPtr->linePtr;
+	} else {
+	    sharedTextPtr->elideCacheLinePtr = NULL;
+	}
+    }
+
+    if (sharedTextPtr->elideCacheLinePtr != NULL) {
+	memcpy(infoPtr->tagCnts, sharedTextPtr->elideCacheCnts,
+		infoPtr->numTags * sizeof(int));
+	memcpy(infoPtr->tagPtrs, sharedTextPtr->elideCachePtrs,
+		infoPtr->numTags * sizeof(TkTextTag *));
+    } else {
+	for (i=0; i<infoPtr->numTags; i++) {
+	    infoPtr->tagCnts[i] = 0;
+	}
+
+	/*
+	 * Record toggles for tags in lines that are predecessors of
+	 * indexPtr->linePtr but under the same level-0 node.
+	 */
+
+	for (siblingLinePtr = indexPtr->linePtr->parentPtr->children.linePtr;
+		siblingLinePtr != indexPtr->linePtr;
+		siblingLinePtr = siblingLinePtr->nextPtr) {
+	    CountElideToggles(siblingLinePtr, infoPtr->tagCnts,
+		    infoPtr->tagPtrs);
+	}
+
+	/*
+	 * For each node in the ancestry of this line, record tag toggles for
+	 * all siblings that precede that node.
+	 */
+
+	for (nodePtr = indexPtr->linePtr->parentPtr; nodePtr->parentPtr != NULL;
+		nodePtr = nodePtr->parentPtr) {
+	    Node *siblingPtr;
+	    Summary *summaryPtr;
+
+	    for (siblingPtr = nodePtr->parentPtr->children.nodePtr;
+		    siblingPtr != nodePtr; siblingPtr = siblingPtr->nextPtr) {
+		for (summaryPtr = siblingPtr->summaryPtr; summaryPtr != NULL;
+			summaryPtr = summaryPtr->nextPtr) {
+		    if (summaryPtr->toggleCount & 1) {
+			tagPtr = summaryPtr->tagPtr;
+			if (tagPtr->elideString != NULL) {
+			    infoPtr->tagPtrs[tagPtr->priority] = tagPtr;
+			    infoPtr->tagCnts[tagPtr->priority] +=
+				    summaryPtr->toggleCount;
+			}
+		    }
+		}
+	    }
+	}
+
+	/*
+	 * Leave the start-of-line state in the cache for the next query.
+	 */
+
+	if (sharedTextPtr->elideCacheNumTags != infoPtr->numTags) {
+	    if (sharedTextPtr->elideCacheCnts != NULL) {
+		ckfree(sharedTextPtr->elideCacheCnts);
+		ckfree(sharedTextPtr->elideCachePtrs);
+	    }
+	    sharedTextPtr->elideCacheCnts = (int *)
+		    ckalloc(sizeof(int) * infoPtr->numTags);
+	    sharedTextPtr->elideCachePtrs = (TkTextTag **)
+		    ckalloc(sizeof(TkTextTag *) * infoPtr->numTags);
+	    sharedTextPtr->elideCacheNumTags = infoPtr->numTags;
+	}
+	memcpy(sharedTextPtr->elideCacheCnts, infoPtr->tagCnts,
+		infoPtr->numTags * sizeof(int));
+	memcpy(sharedTextPtr->elideCachePtrs, infoPtr->tagPtrs,
+		infoPtr->numTags * sizeof(TkTextTag *));
+	sharedTextPtr->elideCacheLinePtr = indexPtr->linePtr;
+	sharedTextPtr->elideCacheEpoch = sharedTextPtr->stateEpoch;
     }
 
     /*
@@ -3559,53 +4358,6 @@ TkTextIsElided(
     infoPtr->segPtr = segPtr;
     infoPtr->segOffset = index;
 
-    /*
-     * Record toggles for tags in lines that are predecessors of
-     * indexPtr->linePtr but under the same level-0 node.
-     */
-
-    for (siblingLinePtr = indexPtr->linePtr->parentPtr->children.linePtr;
-	    siblingLinePtr != indexPtr->linePtr;
-	    siblingLinePtr = siblingLinePtr->nextPtr) {
-	for (segPtr = siblingLinePtr->segPtr; segPtr != NULL;
-		segPtr = segPtr->nextPtr) {
-	    if ((segPtr->typePtr == &tkTextToggleOnType)
-		    || (segPtr->typePtr == &tkTextToggleOffType)) {
-		tagPtr = segPtr->body.toggle.tagPtr;
-		if (tagPtr->elideString != NULL) {
-		    infoPtr->tagPtrs[tagPtr->priority] = tagPtr;
-		    infoPtr->tagCnts[tagPtr->priority]++;
-		}
-	    }
-	}
-    }
-
-    /*
-     * For each node in the ancestry of this line, record tag toggles for all
-     * siblings that precede that node.
-     */
-
-    for (nodePtr = indexPtr->linePtr->parentPtr; nodePtr->parentPtr != NULL;
-	    nodePtr = nodePtr->parentPtr) {
-	Node *siblingPtr;
-	Summary *summaryPtr;
-
-	for (siblingPtr = nodePtr->parentPtr->children.nodePtr;
-		siblingPtr != nodePtr; siblingPtr = siblingPtr->nextPtr) {
-	    for (summaryPtr = siblingPtr->summaryPtr; summaryPtr != NULL;
-		    summaryPtr = summaryPtr->nextPtr) {
-		if (summaryPtr->toggleCount & 1) {
-		    tagPtr = summaryPtr->tagPtr;
-		    if (tagPtr->elideString != NULL) {
-			infoPtr->tagPtrs[tagPtr->priority] = tagPtr;
-			infoPtr->tagCnts[tagPtr->priority] +=
-				summaryPtr->toggleCount;
-		    }
-		}
-	    }
-	}
-    }
-
     /*
      * Now traverse from highest priority to lowest, take elided value from
      * first odd count (= on).
@@ -3642,94 +4394,68 @@ TkTextIsElided(
 /*
  *----------------------------------------------------------------------
  *
- * TkTextFreeElideInfo --
+ * CountElideToggles --
  *
- *	This is a utility function used to free up any memory allocated by the
- *	TkTextIsElided function above.
+ *	This is a utility function used by TkTextIsElided. It adds the toggles
+ *	of all elide tags in the given line to the priority-indexed count and
+ *	tag pointer arrays.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	Memory may be freed.
+ *	Entries in tagCnts and tagPtrs are updated.
  *
  *----------------------------------------------------------------------
  */
 
-void
-TkTextFreeElideInfo(
-    TkTextElideInfo *elideInfo)	/* Free any allocated memory in this
-				 * structure. */
+static void
+CountElideToggles(
+    TkTextLine *linePtr,	/* The line whose toggles are to be added. */
+    int *tagCnts,		/* Toggle count for each tag priority. */
+    TkTextTag **tagPtrs)	/* Tag pointers corresponding to the counts. */
 {
-    if (LOTSA_TAGS < elideInfo->numTags) {
-	ckfree(elideInfo->tagCnts);
-	ckfree(elideInfo->tagPtrs);
+    TkTextSegment *segPtr;
+    TkTextTag *tagPtr;
+
+    for (segPtr = linePtr->segPtr; segPtr != NULL; segPtr = segPtr->nextPtr) {
+	if ((segPtr->typePtr == &tkTextToggleOnType)
+		|| (segPtr->typePtr == &tkTextToggleOffType)) {
+	    tagPtr = segPtr->body.toggle.tagPtr;
+	    if (tagPtr->elideString != NULL) {
+		tagPtrs[tagPtr->priority] = tagPtr;
+		tagCnts[tagPtr->priority]++;
+	    }
+	}
     }
 }
 
 /*
  *----------------------------------------------------------------------
  *
- * IncCount --
+ * TkTextFreeElideInfo --
  *
- *	This is a utility function used by TkBTreeGetTags. It increments the
- *	count for a particular tag, adding a new entry for that tag if there
- *	wasn't one previously.
+ *	This is a utility function used to free up any memory allocated by the
+ *	TkTextIsElided function above.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	The information at *tagInfoPtr may be modified, and the arrays may be
- *	reallocated to make them larger.
+ *	Memory may be freed.
  *
  *----------------------------------------------------------------------
  */
 
-static void
-IncCount(
-    TkTextTag *tagPtr,		/* Handle for tag. */
-    int inc,			/* Amount by which to increment tag count. */
-    TagInfo *tagInfoPtr)	/* Holds cumulative information about tags;
-				 * increment count here. */
+void
+TkTextFreeElideInfo(
+    TkTextElideInfo *elideInfo)	/* Free any allocated memory in this
+				 * structure. */
 {
-    TkTextTag **tagPtrPtr;
-    int count;
-
-    for (tagPtrPtr = tagInfoPtr->tagPtrs, count = tagInfoPtr->numTags;
-	    count > 0; tagPtrPtr++, count--) {
-	if (*tagPtrPtr == tagPtr) {
-	    tagInfoPtr->counts[tagInfoPtr->numTags-count] += inc;
-	    return;
-	}
+    if (LOTSA_TAGS < elideInfo->numTags) {
+	ckfree(elideInfo->tagCnts);
+	ckfree(elideInfo->tagPtrs);
     }
-
-    /*
-     * There isn't currently an entry for this tag, so we have to make a new
-     * one. If the arrays are full, then enlarge the arrays first.
-     */
-
-    if (tagInfoPtr->numTags == tagInfoPtr->arraySize) {
-	TkTextTag **newTags;
-	int *newCounts, newSize;
-
-	newSize = 2 * tagInfoPtr->arraySize;
-	newTags = (TkTextTag **)ckalloc(newSize * sizeof(TkTextTag *));
-	memcpy(newTags, tagInfoPtr->tagPtrs,
-		tagInfoPtr->arraySize * sizeof(TkTextTag *));
-	ckfree(tagInfoPtr->tagPtrs);
-	tagInfoPtr->tagPtrs = newTags;
-	newCounts = (int *)ckalloc(newSize * sizeof(int));
-	memcpy(newCounts, tagInfoPtr->counts,
-		tagInfoPtr->arraySize * sizeof(int));
-	ckfree(tagInfoPtr->counts);
-	tagInfoPtr->counts = newCounts;
-	tagInfoPtr->arraySize = newSize;
-    }
-
-    tagInfoPtr->tagPtrs[tagInfoPtr->numTags] = tagPtr;
-    tagInfoPtr->counts[tagInfoPtr->numTags] = inc;
-    tagInfoPtr->numTags++;
 }
 
 /*
@@ -3903,8 +4629,9 @@ CheckNodeConsistency(
     TkTextLine *linePtr;
     TkTextSegment *segPtr;
     int numChildren, numLines, toggleCount, minChildren, i;
-    int *numPixels;
+    int *numPixels, *minEpochs;
     int pixels[PIXEL_CLIENTS];
+    int epochs[PIXEL_CLIENTS];
 
     if (nodePtr->parentPtr != NULL) {
 	minChildren = MIN_CHILDREN;
@@ -3923,11 +4650,14 @@ CheckNodeConsistency(
     numLines = 0;
     if (references > PIXEL_CLIENTS) {
 	numPixels = (int *)ckalloc(sizeof(int) * references);
+	minEpochs = (int *)ckalloc(sizeof(int) * references);
     } else {
 	numPixels = pixels;
+	minEpochs = epochs;
     }
     for (i = 0; i<references; i++) {
 	numPixels[i] = 0;
+	minEpochs[i] = -1;
     }
 
     if (nodePtr->level == 0) {
@@ -3959,6 +4689,10 @@ CheckNodeConsistency(
 	    numLines++;
 	    for (i = 0; i<references; i++) {
 		numPixels[i] += linePtr->pixels[2 * i];
+		if ((minEpochs[i] == -1)
+			|| (linePtr->pixels[2 * i + 1] < minEpochs[i])) {
+		    minEpochs[i] = linePtr->pixels[2 * i + 1];
+		}
 	    }
 	}
     } else {
@@ -3993,6 +4727,10 @@ CheckNodeConsistency(
 	    numLines += childNodePtr->numLines;
 	    for (i = 0; i<references; i++) {
 		numPixels[i] += childNodePtr->numPixels[i];
+		if ((minEpochs[i] == -1)
+			|| (childNodePtr->minPixelEpoch[i] < minEpochs[i])) {
+		    minEpochs[i] = childNodePtr->minPixelEpoch[i];
+		}
 	    }
 	}
     }
@@ -4009,9 +4747,21 @@ CheckNodeConsistency(
 	    Tcl_Panic("CheckNodeConsistency: mismatch in numPixels (%d %d) for widget (%d)",
 		    numPixels[i], nodePtr->numPixels[i], i);
 	}
+
+	/*
+	 * The stored minimum epoch may be lower than the true minimum (which
+	 * only costs some unnecessary scanning), but it must never be
+	 * higher, or up-to-date checks would wrongly skip stale lines.
+	 */
+
+	if (nodePtr->minPixelEpoch[i] > minEpochs[i]) {
+	    Tcl_Panic("CheckNodeConsistency: minPixelEpoch too large (%d %d) for widget (%d)",
+		    nodePtr->minPixelEpoch[i], minEpochs[i], i);
+	}
     }
     if (references > PIXEL_CLIENTS) {
 	ckfree(numPixels);
+	ckfree(minEpochs);
     }
 
     for (summaryPtr = nodePtr->summaryPtr; summaryPtr != NULL;
@@ -4120,8 +4870,11 @@ Rebalance(
 		    newPtr->numLines = nodePtr->numLines;
 		    newPtr->numPixels = (int *)
 			    ckalloc(sizeof(int) * treePtr->pixelReferences);
+		    newPtr->minPixelEpoch = (int *)
+			    ckalloc(sizeof(int) * treePtr->pixelReferences);
 		    for (i=0; i<treePtr->pixelReferences; i++) {
 			newPtr->numPixels[i] = nodePtr->numPixels[i];
+			newPtr->minPixelEpoch[i] = nodePtr->minPixelEpoch[i];
 		    }
 		    RecomputeNodeCounts(treePtr, newPtr);
 		    treePtr->rootPtr = newPtr;
@@ -4129,8 +4882,11 @@ Rebalance(
 		newPtr = (Node *)ckalloc(sizeof(Node));
 		newPtr->numPixels = (int *)
 			ckalloc(sizeof(int) * treePtr->pixelReferences);
+		newPtr->minPixelEpoch = (int *)
+			ckalloc(sizeof(int) * treePtr->pixelReferences);
 		for (i=0; i<treePtr->pixelReferences; i++) {
 		    newPtr->numPixels[i] = 0;
+		    newPtr->minPixelEpoch[i] = 0;
 		}
 		newPtr->parentPtr = nodePtr->parentPtr;
 		newPtr->nextPtr = nodePtr->nextPtr;
@@ -4185,6 +4941,7 @@ Rebalance(
 		    treePtr->rootPtr->parentPtr = NULL;
 		    DeleteSummaries(nodePtr->summaryPtr);
 		    ckfree(nodePtr->numPixels);
+		    ckfree(nodePtr->minPixelEpoch);
 		    ckfree(nodePtr);
 		}
 		return;
@@ -4271,6 +5028,7 @@ Rebalance(
 		nodePtr->parentPtr->numChildren--;
 		DeleteSummaries(otherPtr->summaryPtr);
 		ckfree(otherPtr->numPixels);
+		ckfree(otherPtr->minPixelEpoch);
 		ckfree(otherPtr);
 		continue;
 	    }
@@ -4340,8 +5098,10 @@ RecomputeNodeCounts(
     }
     nodePtr->numChildren = 0;
     nodePtr->numLines = 0;
+    nodePtr->hashValid = 0;
     for (ref = 0; ref<treePtr->pixelReferences; ref++) {
 	nodePtr->numPixels[ref] = 0;
+	nodePtr->minPixelEpoch[ref] = -1;
     }
 
     /*
@@ -4356,6 +5116,12 @@ RecomputeNodeCounts(
 	    nodePtr->numLines++;
 	    for (ref = 0; ref<treePtr->pixelReferences; ref++) {
 		nodePtr->numPixels[ref] += linePtr->pixels[2 * ref];
+		if ((nodePtr->minPixelEpoch[ref] == -1)
+			|| (linePtr->pixels[2 * ref + 1]
+			< nodePtr->minPixelEpoch[ref])) {
+		    nodePtr->minPixelEpoch[ref] =
+			    linePtr->pixels[2 * ref + 1];
+		}
 	    }
 	    linePtr->parentPtr = nodePtr;
 	    for (segPtr = linePtr->segPtr; segPtr != NULL;
@@ -4390,6 +5156,12 @@ RecomputeNodeCounts(
 	    nodePtr->numLines += childPtr->numLines;
 	    for (ref = 0; ref<treePtr->pixelReferences; ref++) {
 		nodePtr->numPixels[ref] += childPtr->numPixels[ref];
+		if ((nodePtr->minPixelEpoch[ref] == -1)
+			|| (childPtr->minPixelEpoch[ref]
+			< nodePtr->minPixelEpoch[ref])) {
+		    nodePtr->minPixelEpoch[ref] =
+			    childPtr->minPixelEpoch[ref];
+		}
 	    }
 	    childPtr->parentPtr = nodePtr;
 	    for (summaryPtr2 = childPtr->summaryPtr; summaryPtr2 != NULL;
@@ -4454,6 +5226,17 @@ RecomputeNodeCounts(
 	    summaryPtr = nodePtr->summaryPtr;
 	}
     }
+
+    /*
+     * If the node ended up with no children at all then the sentinel epoch
+     * is still in place; zero is the always-safe value.
+     */
+
+    for (ref = 0; ref<treePtr->pixelReferences; ref++) {
+	if (nodePtr->minPixelEpoch[ref] == -1) {
+	    nodePtr->minPixelEpoch[ref] = 0;
+	}
+    }
 }
 
 /*
@@ -184,6 +184,31 @@ typedef struct TextStyle {
 				 * delete entry. */
 } TextStyle;
 
+/*
+ * Computing a StyleValues structure requires merging the options of every
+ * tag present on a character, which is expensive to repeat for each chunk
+ * during relayout. The result of the merge depends only on the (priority
+ * ordered) set of tags, on whether the widget has the focus, and on widget
+ * defaults, so it is memoized per tag set: structures of the following type
+ * form the hash keys for dInfoPtr->styleCacheTable, whose values are the
+ * TextStyle pointers that GetStyle computed for those tag sets. Characters
+ * with more than STYLE_CACHE_TAGS tags are rare and bypass the cache. The
+ * cache must be flushed whenever a tag, a widget default or a tag priority
+ * changes; see TkTextFlushStyleCache.
+ */
+
+#define STYLE_CACHE_TAGS 8
+
+typedef struct StyleCacheKey {
+    int numTags;		/* Number of valid entries in tagPtrs. */
+    int focus;			/* Non-zero means the widget had the focus
+				 * when the style was computed (affects how
+				 * the selection tag is merged). */
+    TkTextTag *tagPtrs[STYLE_CACHE_TAGS];
+				/* The character's tags, in priority order.
+				 * Unused entries are NULL. */
+} StyleCacheKey;
+
 /*
  * The following macro determines whether two styles have the same background
  * so that, for example, no beveled border should be drawn between them.
@@ -313,6 +338,56 @@ typedef struct DLine {
 #define BOTTOM_LINE	8
 #define OLD_Y_INVALID  16
 
+/*
+ * Limits on the per-widget pools of recycled layout records (see the pool
+ * fields in TextDInfo below). Bounding the pools means that an atypically
+ * tall window cannot pin down arbitrary amounts of memory after it shrinks
+ * again. CHAR_INFO_POOL_CHARS is the number of bytes of character storage
+ * in a pooled CharInfo record; larger records bypass the pool.
+ */
+
+#define DLINE_POOL_MAX		64
+#define CHUNK_POOL_MAX		256
+#define CHAR_INFO_POOL_MAX	256
+#define CHAR_INFO_POOL_CHARS	128
+
+/*
+ * One cached set of per-logical-line pixel heights. TkTextRelayoutWindow
+ * keeps a few of these so that flipping a geometry-influencing option such
+ * as -wrap back to a recently used value can restore the heights it
+ * computed last time instead of re-measuring every line in the widget.
+ */
+
+typedef struct WrapMetricSnapshot {
+    int wrapMode;		/* Wrap mode the heights were computed
+				 * under. */
+    int maxX;			/* Layout width (dInfoPtr->maxX) the heights
+				 * were computed under. */
+    TkSizeT stateEpoch;		/* B-tree state epoch when the snapshot was
+				 * captured; it only applies while the
+				 * content is unchanged. */
+    int numLines;		/* Number of entries in heights, or 0 when
+				 * the slot is empty. */
+    int *heights;		/* Malloc'ed array of per-logical-line pixel
+				 * heights. */
+} WrapMetricSnapshot;
+
+#define WRAP_METRIC_SLOTS	2
+
+/*
+ * Layout constants for the optional line-number gutter (the -gutter widget
+ * option). GUTTER_MIN_DIGITS is the smallest number of digits the gutter is
+ * sized for, so that ordinary edits in files below that many lines never
+ * change the layout width. GUTTER_PAD is the horizontal padding placed
+ * before the marker column, between it and the numbers, and after the
+ * numbers. GUTTER_MARK_PREFIX names the marks that draw a marker beside
+ * their line.
+ */
+
+#define GUTTER_MIN_DIGITS	4
+#define GUTTER_PAD		3
+#define GUTTER_MARK_PREFIX	"gutter:"
+
 /*
  * Overall display information for a text widget:
  */
@@ -320,6 +395,12 @@ typedef struct DLine {
 typedef struct TextDInfo {
     Tcl_HashTable styleTable;	/* Hash table that maps from StyleValues to
 				 * TextStyles for this widget. */
+    Tcl_HashTable styleCacheTable;
+				/* Hash table that maps from StyleCacheKeys
+				 * (tag sets) to TextStyles, so that GetStyle
+				 * can skip the tag option merge for tag sets
+				 * it has seen before. Each entry holds a
+				 * reference to its TextStyle. */
     DLine *dLinePtr;		/* First in list of all display lines for this
 				 * widget, in order from top to bottom. */
     int topPixelOffset;		/* Identifies first pixel in top display line
@@ -348,6 +429,15 @@ typedef struct TextDInfo {
 				 * line of the text. This field is used to
 				 * figure out when to redraw part or all of
 				 * the eof field. */
+    int gutterWidth;		/* Width in pixels of the line-number gutter
+				 * to the left of the text area, already
+				 * included in x. Zero when -gutter is off. */
+    int gutterDigits;		/* Number of line-number digits the gutter is
+				 * currently sized for. */
+    GC gutterGC;		/* Graphics context for drawing gutter
+				 * numbers and markers, or NULL. Allocated
+				 * privately (not via Tk_GetGC) because its
+				 * clip rectangle changes per redisplay. */
 
     /*
      * Information used for scrolling:
@@ -433,6 +523,58 @@ typedef struct TextDInfo {
     Tcl_TimerToken scrollbarTimer;
 				/* A token pointing to the current scrollbar
 				 * update callback. */
+    Tcl_TimerToken preLayoutTimer;
+				/* A token pointing to the predictive
+				 * pre-layout callback scheduled after a
+				 * pixel scroll, or NULL if none is
+				 * pending. */
+    int preLayoutDirection;	/* Direction of the last pixel scroll: +1
+				 * when scrolling towards the end of the
+				 * text, -1 towards the beginning. */
+    int preLayoutPixels;	/* How many pixels beyond the view the
+				 * pre-layout callback should bring the line
+				 * metrics up to date, derived from the
+				 * measured scroll velocity. */
+    Tcl_Time lastScrollTime;	/* When the last pixel scroll happened; used
+				 * to measure the scroll velocity. */
+
+    /*
+     * Pools of layout records that are recycled across relayouts. Scrolling
+     * continuously frees and re-creates display lines, so DLine, chunk and
+     * CharInfo records are kept on per-widget free lists instead of being
+     * returned to the allocator each time.
+     */
+
+    DLine *dLineFreePtr;	/* Free list of DLine records, chained
+				 * through their nextPtr fields. */
+    int numDLineFree;		/* Number of records on dLineFreePtr. */
+    TkTextDispChunk *chunkFreePtr;
+				/* Free list of chunk records, chained
+				 * through their nextPtr fields. */
+    int numChunkFree;		/* Number of records on chunkFreePtr. */
+    struct CharInfo *charInfoPool[CHAR_INFO_POOL_MAX];
+				/* Stack of recycled CharInfo records. */
+    int numCharInfoFree;	/* Number of records on charInfoPool. */
+#ifdef TK_LAYOUT_WITH_BASE_CHUNKS
+    struct BaseCharInfo *baseCharInfoPool[CHAR_INFO_POOL_MAX];
+				/* Stack of recycled BaseCharInfo records. */
+    int numBaseCharInfoFree;	/* Number of records on baseCharInfoPool. */
+#endif /* TK_LAYOUT_WITH_BASE_CHUNKS */
+
+    /*
+     * Cached per-line pixel heights from earlier layouts (see
+     * WrapMetricSnapshot above), together with the key describing the
+     * layout the current line metrics were computed under.
+     */
+
+    WrapMetricSnapshot metricSnapshot[WRAP_METRIC_SLOTS];
+    int metricSnapshotNext;	/* Round-robin replacement index into
+				 * metricSnapshot. */
+    int metricsWrapMode;	/* Wrap mode the current line metrics were
+				 * computed under, or -1 before the first
+				 * full relayout. */
+    int metricsMaxX;		/* Layout width the current line metrics were
+				 * computed under. */
 } TextDInfo;
 
 /*
@@ -443,6 +585,9 @@ typedef struct TextDInfo {
 #if !defined(TK_LAYOUT_WITH_BASE_CHUNKS)
 
 typedef struct CharInfo {
+    int capacity;		/* Number of bytes of space in chars[]. Used
+				 * to decide whether the record can be
+				 * recycled through the per-widget pool. */
     int numBytes;		/* Number of bytes to display. */
     char chars[TKFLEXARRAY];		/* UTF characters to display.
 				 * Allocated as large as necessary. THIS MUST BE THE LAST
@@ -527,6 +672,35 @@ static int numRedisplays;	/* Number of calls to DisplayText. */
 static int linesRedrawn;	/* Number of calls to DisplayDLine. */
 static int numCopies;		/* Number of calls to XCopyArea to copy part
 				 * of the screen. */
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkTextDispStats --
+ *
+ *	Report the redisplay statistics counters above, so that the "tk
+ *	perf" command can include them in its report.
+ *
+ * Results:
+ *	The three counters are stored through the supplied pointers.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkTextDispStats(
+    int *numRedisplaysPtr,	/* Out: number of calls to DisplayText. */
+    int *linesRedrawnPtr,	/* Out: number of calls to DisplayDLine. */
+    int *numCopiesPtr)		/* Out: number of scrolling copies. */
+{
+    *numRedisplaysPtr = numRedisplays;
+    *linesRedrawnPtr = linesRedrawn;
+    *numCopiesPtr = numCopies;
+}
+
 static int lineHeightsRecalculated;
 				/* Number of line layouts purely for height
 				 * calculation purposes.*/
@@ -570,10 +744,31 @@ static void		ElideBboxProc(TkText *textPtr,
 			    int *yPtr, int *widthPtr, int *heightPtr);
 static int		ElideMeasureProc(TkTextDispChunk *chunkPtr, int x);
 static void		DisplayDLine(TkText *textPtr, DLine *dlPtr,
-			    DLine *prevPtr, Pixmap pixmap);
+			    DLine *prevPtr, Pixmap pixmap, int pixmapY);
+#ifndef TK_NO_DOUBLE_BUFFERING
+static void		CopyDLineBatch(TkText *textPtr, Pixmap pixmap,
+			    int windowY, int batchHeight);
+#endif /* TK_NO_DOUBLE_BUFFERING */
+static void		DisplayGutter(TkText *textPtr);
+static int		GutterLineHasMark(TkText *textPtr,
+			    TkTextLine *linePtr);
 static void		DisplayLineBackground(TkText *textPtr, DLine *dlPtr,
 			    DLine *prevPtr, Pixmap pixmap);
 static void		DisplayText(ClientData clientData);
+static DLine *		DLineAlloc(TextDInfo *dInfoPtr);
+static void		DLineFree(TextDInfo *dInfoPtr, DLine *dlPtr);
+static TkTextDispChunk *ChunkAlloc(TextDInfo *dInfoPtr);
+static void		ChunkFree(TextDInfo *dInfoPtr,
+			    TkTextDispChunk *chunkPtr);
+#if !defined(TK_LAYOUT_WITH_BASE_CHUNKS)
+static CharInfo *	CharInfoAlloc(TextDInfo *dInfoPtr, int numBytes);
+#else
+static CharInfo *	CharInfoAlloc(TextDInfo *dInfoPtr);
+static BaseCharInfo *	BaseCharInfoAlloc(TextDInfo *dInfoPtr);
+static void		BaseCharInfoFree(TextDInfo *dInfoPtr,
+			    BaseCharInfo *bciPtr);
+#endif /* TK_LAYOUT_WITH_BASE_CHUNKS */
+static void		CharInfoFree(TextDInfo *dInfoPtr, CharInfo *ciPtr);
 static DLine *		FindDLine(TkText *textPtr, DLine *dlPtr,
                             const TkTextIndex *indexPtr);
 static void		FreeDLines(TkText *textPtr, DLine *firstPtr,
@@ -621,6 +816,12 @@ static int		TextGetScrollInfoObj(Tcl_Interp *interp,
 			    Tcl_Obj *const objv[], double *dblPtr,
 			    int *intPtr);
 static void		AsyncUpdateLineMetrics(ClientData clientData);
+static void		AsyncPreLayout(ClientData clientData);
+static void		SchedulePreLayout(TkText *textPtr, int offset);
+static void		SaveMetricSnapshot(TkText *textPtr);
+static int		RestoreMetricSnapshot(TkText *textPtr);
+static int		BorrowPeerMetrics(TkText *textPtr);
+static void		DiscardMetricSnapshots(TextDInfo *dInfoPtr);
 static void		GenerateWidgetViewSyncEvent(TkText *textPtr, Bool InSync);
 static void		AsyncUpdateYScrollbar(ClientData clientData);
 static int              IsStartOfNotMergedLine(TkText *textPtr,
@@ -663,12 +864,17 @@ TkTextCreateDInfo(
 
     dInfoPtr = (TextDInfo *)ckalloc(sizeof(TextDInfo));
     Tcl_InitHashTable(&dInfoPtr->styleTable, sizeof(StyleValues)/sizeof(int));
+    Tcl_InitHashTable(&dInfoPtr->styleCacheTable,
+	    sizeof(StyleCacheKey)/sizeof(int));
     dInfoPtr->dLinePtr = NULL;
     dInfoPtr->copyGC = NULL;
     gcValues.graphics_exposures = True;
     dInfoPtr->scrollGC = Tk_GetGC(textPtr->tkwin, GCGraphicsExposures,
 	    &gcValues);
     dInfoPtr->topOfEof = 0;
+    dInfoPtr->gutterWidth = 0;
+    dInfoPtr->gutterDigits = 0;
+    dInfoPtr->gutterGC = NULL;
     dInfoPtr->newXPixelOffset = 0;
     dInfoPtr->curXPixelOffset = 0;
     dInfoPtr->maxLength = 0;
@@ -692,6 +898,23 @@ TkTextCreateDInfo(
     dInfoPtr->metricIndex.linePtr = NULL;
     dInfoPtr->lineUpdateTimer = NULL;
     dInfoPtr->scrollbarTimer = NULL;
+    dInfoPtr->preLayoutTimer = NULL;
+    dInfoPtr->preLayoutDirection = 0;
+    dInfoPtr->preLayoutPixels = 0;
+    dInfoPtr->lastScrollTime.sec = 0;
+    dInfoPtr->lastScrollTime.usec = 0;
+    dInfoPtr->dLineFreePtr = NULL;
+    dInfoPtr->numDLineFree = 0;
+    dInfoPtr->chunkFreePtr = NULL;
+    dInfoPtr->numChunkFree = 0;
+    dInfoPtr->numCharInfoFree = 0;
+#ifdef TK_LAYOUT_WITH_BASE_CHUNKS
+    dInfoPtr->numBaseCharInfoFree = 0;
+#endif /* TK_LAYOUT_WITH_BASE_CHUNKS */
+    memset(dInfoPtr->metricSnapshot, 0, sizeof(dInfoPtr->metricSnapshot));
+    dInfoPtr->metricSnapshotNext = 0;
+    dInfoPtr->metricsWrapMode = -1;
+    dInfoPtr->metricsMaxX = 0;
 
     textPtr->dInfoPtr = dInfoPtr;
 }
@@ -727,10 +950,15 @@ TkTextFreeDInfo(
      */
 
     FreeDLines(textPtr, dInfoPtr->dLinePtr, NULL, DLINE_UNLINK);
+    TkTextFlushStyleCache(textPtr);
+    Tcl_DeleteHashTable(&dInfoPtr->styleCacheTable);
     Tcl_DeleteHashTable(&dInfoPtr->styleTable);
     if (dInfoPtr->copyGC != NULL) {
 	Tk_FreeGC(textPtr->display, dInfoPtr->copyGC);
     }
+    if (dInfoPtr->gutterGC != NULL) {
+	XFreeGC(textPtr->display, dInfoPtr->gutterGC);
+    }
     Tk_FreeGC(textPtr->display, dInfoPtr->scrollGC);
     if (dInfoPtr->flags & REDRAW_PENDING) {
 	Tcl_CancelIdleCall(DisplayText, textPtr);
@@ -745,8 +973,211 @@ TkTextFreeDInfo(
 	textPtr->refCount--;
 	dInfoPtr->scrollbarTimer = NULL;
     }
+    if (dInfoPtr->preLayoutTimer != NULL) {
+	Tcl_DeleteTimerHandler(dInfoPtr->preLayoutTimer);
+	textPtr->refCount--;
+	dInfoPtr->preLayoutTimer = NULL;
+    }
+
+    /*
+     * Release the pools of recycled layout records. FreeDLines above has
+     * already returned the records of the displayed lines to the pools.
+     */
+
+    while (dInfoPtr->dLineFreePtr != NULL) {
+	DLine *dlPtr = dInfoPtr->dLineFreePtr;
+
+	dInfoPtr->dLineFreePtr = dlPtr->nextPtr;
+	ckfree(dlPtr);
+    }
+    while (dInfoPtr->chunkFreePtr != NULL) {
+	TkTextDispChunk *chunkPtr = dInfoPtr->chunkFreePtr;
+
+	dInfoPtr->chunkFreePtr = chunkPtr->nextPtr;
+	ckfree(chunkPtr);
+    }
+    while (dInfoPtr->numCharInfoFree > 0) {
+	ckfree(dInfoPtr->charInfoPool[--dInfoPtr->numCharInfoFree]);
+    }
+#ifdef TK_LAYOUT_WITH_BASE_CHUNKS
+    while (dInfoPtr->numBaseCharInfoFree > 0) {
+	ckfree(dInfoPtr->baseCharInfoPool[--dInfoPtr->numBaseCharInfoFree]);
+    }
+#endif /* TK_LAYOUT_WITH_BASE_CHUNKS */
+    DiscardMetricSnapshots(dInfoPtr);
     ckfree(dInfoPtr);
 }
+/*
+ *----------------------------------------------------------------------
+ *
+ * DLineAlloc, DLineFree, ChunkAlloc, ChunkFree, CharInfoAlloc,
+ * CharInfoFree --
+ *
+ *	These functions manage the per-widget pools of display line, chunk
+ *	and character-info records. Relayout (e.g. during scrolling) frees
+ *	and re-creates these records continuously, so recycling them through
+ *	small free lists avoids most of the allocator traffic of redisplay.
+ *
+ * Results:
+ *	The Alloc functions return a record that is either popped from the
+ *	widget's pool or freshly allocated. The contents of recycled records
+ *	are undefined except for the fields reset below.
+ *
+ * Side effects:
+ *	The Free functions return a record to the pool, or to the allocator
+ *	once the pool is full. The pools themselves are released by
+ *	TkTextFreeDInfo.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static DLine *
+DLineAlloc(
+    TextDInfo *dInfoPtr)	/* Display info for the text widget. */
+{
+    DLine *dlPtr = dInfoPtr->dLineFreePtr;
+
+    if (dlPtr != NULL) {
+	dInfoPtr->dLineFreePtr = dlPtr->nextPtr;
+	dInfoPtr->numDLineFree--;
+    } else {
+	dlPtr = (DLine *)ckalloc(sizeof(DLine));
+    }
+    return dlPtr;
+}
+
+static void
+DLineFree(
+    TextDInfo *dInfoPtr,	/* Display info for the text widget. */
+    DLine *dlPtr)		/* Display line whose chunks have already been
+				 * freed or recycled. */
+{
+    if (dInfoPtr->numDLineFree < DLINE_POOL_MAX) {
+	dlPtr->nextPtr = dInfoPtr->dLineFreePtr;
+	dInfoPtr->dLineFreePtr = dlPtr;
+	dInfoPtr->numDLineFree++;
+    } else {
+	ckfree(dlPtr);
+    }
+}
+
+static TkTextDispChunk *
+ChunkAlloc(
+    TextDInfo *dInfoPtr)	/* Display info for the text widget. */
+{
+    TkTextDispChunk *chunkPtr = dInfoPtr->chunkFreePtr;
+
+    if (chunkPtr != NULL) {
+	dInfoPtr->chunkFreePtr = chunkPtr->nextPtr;
+	dInfoPtr->numChunkFree--;
+    } else {
+	chunkPtr = (TkTextDispChunk *)ckalloc(sizeof(TkTextDispChunk));
+    }
+    chunkPtr->nextPtr = NULL;
+    chunkPtr->clientData = NULL;
+    return chunkPtr;
+}
+
+static void
+ChunkFree(
+    TextDInfo *dInfoPtr,	/* Display info for the text widget. */
+    TkTextDispChunk *chunkPtr)	/* Chunk whose style and client data have
+				 * already been released. */
+{
+    if (dInfoPtr->numChunkFree < CHUNK_POOL_MAX) {
+	chunkPtr->nextPtr = dInfoPtr->chunkFreePtr;
+	dInfoPtr->chunkFreePtr = chunkPtr;
+	dInfoPtr->numChunkFree++;
+    } else {
+	ckfree(chunkPtr);
+    }
+}
+
+#if !defined(TK_LAYOUT_WITH_BASE_CHUNKS)
+
+static CharInfo *
+CharInfoAlloc(
+    TextDInfo *dInfoPtr,	/* Display info for the text widget. */
+    int numBytes)		/* Number of bytes of character storage
+				 * needed. */
+{
+    CharInfo *ciPtr;
+
+    if ((numBytes <= CHAR_INFO_POOL_CHARS) && (dInfoPtr->numCharInfoFree > 0)) {
+	ciPtr = dInfoPtr->charInfoPool[--dInfoPtr->numCharInfoFree];
+    } else {
+	int capacity = numBytes;
+
+	if (capacity < CHAR_INFO_POOL_CHARS) {
+	    capacity = CHAR_INFO_POOL_CHARS;
+	}
+	ciPtr = (CharInfo *)ckalloc(offsetof(CharInfo, chars) + capacity);
+	ciPtr->capacity = capacity;
+    }
+    return ciPtr;
+}
+
+static void
+CharInfoFree(
+    TextDInfo *dInfoPtr,	/* Display info for the text widget. */
+    CharInfo *ciPtr)		/* Character info record to recycle. */
+{
+    if ((ciPtr->capacity == CHAR_INFO_POOL_CHARS)
+	    && (dInfoPtr->numCharInfoFree < CHAR_INFO_POOL_MAX)) {
+	dInfoPtr->charInfoPool[dInfoPtr->numCharInfoFree++] = ciPtr;
+    } else {
+	ckfree(ciPtr);
+    }
+}
+
+#else /* TK_LAYOUT_WITH_BASE_CHUNKS */
+
+static CharInfo *
+CharInfoAlloc(
+    TextDInfo *dInfoPtr)	/* Display info for the text widget. */
+{
+    if (dInfoPtr->numCharInfoFree > 0) {
+	return dInfoPtr->charInfoPool[--dInfoPtr->numCharInfoFree];
+    }
+    return (CharInfo *)ckalloc(sizeof(CharInfo));
+}
+
+static void
+CharInfoFree(
+    TextDInfo *dInfoPtr,	/* Display info for the text widget. */
+    CharInfo *ciPtr)		/* Character info record to recycle. */
+{
+    if (dInfoPtr->numCharInfoFree < CHAR_INFO_POOL_MAX) {
+	dInfoPtr->charInfoPool[dInfoPtr->numCharInfoFree++] = ciPtr;
+    } else {
+	ckfree(ciPtr);
+    }
+}
+
+static BaseCharInfo *
+BaseCharInfoAlloc(
+    TextDInfo *dInfoPtr)	/* Display info for the text widget. */
+{
+    if (dInfoPtr->numBaseCharInfoFree > 0) {
+	return dInfoPtr->baseCharInfoPool[--dInfoPtr->numBaseCharInfoFree];
+    }
+    return (BaseCharInfo *)ckalloc(sizeof(BaseCharInfo));
+}
+
+static void
+BaseCharInfoFree(
+    TextDInfo *dInfoPtr,	/* Display info for the text widget. */
+    BaseCharInfo *bciPtr)	/* Base chunk record whose baseChars DString
+				 * has already been freed. */
+{
+    if (dInfoPtr->numBaseCharInfoFree < CHAR_INFO_POOL_MAX) {
+	dInfoPtr->baseCharInfoPool[dInfoPtr->numBaseCharInfoFree++] = bciPtr;
+    } else {
+	ckfree(bciPtr);
+    }
+}
+
+#endif /* TK_LAYOUT_WITH_BASE_CHUNKS */
 
 /*
  *----------------------------------------------------------------------
@@ -775,8 +1206,9 @@ GetStyle(
     TkTextTag **tagPtrs;
     TkTextTag *tagPtr;
     StyleValues styleValues;
+    StyleCacheKey cacheKey;
     TextStyle *stylePtr;
-    Tcl_HashEntry *hPtr;
+    Tcl_HashEntry *hPtr, *cacheHPtr = NULL;
     int numTags, isNew, i;
     int isSelected;
     XGCValues gcValues;
@@ -800,6 +1232,33 @@ GetStyle(
      */
 
     tagPtrs = TkBTreeGetTags(indexPtr, textPtr, &numTags);
+
+    /*
+     * The tags are returned in priority order, and the merge below depends
+     * only on that order, on whether the widget has the focus, and on widget
+     * defaults. A TextStyle previously computed for the same tag set can
+     * therefore be reused directly, skipping the merge altogether.
+     */
+
+    if (numTags <= STYLE_CACHE_TAGS) {
+	memset(&cacheKey, 0, sizeof(StyleCacheKey));
+	cacheKey.numTags = numTags;
+	cacheKey.focus = (textPtr->flags & GOT_FOCUS) != 0;
+	for (i = 0; i < numTags; i++) {
+	    cacheKey.tagPtrs[i] = tagPtrs[i];
+	}
+	cacheHPtr = Tcl_CreateHashEntry(&textPtr->dInfoPtr->styleCacheTable,
+		(char *) &cacheKey, &isNew);
+	if (!isNew) {
+	    stylePtr = (TextStyle *)Tcl_GetHashValue(cacheHPtr);
+	    stylePtr->refCount++;
+	    if (tagPtrs != NULL) {
+		ckfree(tagPtrs);
+	    }
+	    return stylePtr;
+	}
+    }
+
     borderPrio = borderWidthPrio = reliefPrio = bgStipplePrio = -1;
     fgPrio = fontPrio = fgStipplePrio = -1;
     underlinePrio = elidePrio = justifyPrio = offsetPrio = -1;
@@ -1004,6 +1463,10 @@ GetStyle(
     if (!isNew) {
 	stylePtr = (TextStyle *)Tcl_GetHashValue(hPtr);
 	stylePtr->refCount++;
+	if (cacheHPtr != NULL) {
+	    stylePtr->refCount++;
+	    Tcl_SetHashValue(cacheHPtr, stylePtr);
+	}
 	return stylePtr;
     }
 
@@ -1044,6 +1507,10 @@ GetStyle(
 	    Tcl_GetHashKey(&textPtr->dInfoPtr->styleTable, hPtr);
     stylePtr->hPtr = hPtr;
     Tcl_SetHashValue(hPtr, stylePtr);
+    if (cacheHPtr != NULL) {
+	stylePtr->refCount++;
+	Tcl_SetHashValue(cacheHPtr, stylePtr);
+    }
     return stylePtr;
 }
 
@@ -1090,6 +1557,45 @@ FreeStyle(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkTextFlushStyleCache --
+ *
+ *	This function throws away all the memoized tag-set-to-TextStyle
+ *	mappings for a widget. It must be called whenever anything that feeds
+ *	into the style merge in GetStyle changes: a tag's options or priority,
+ *	the widget defaults, or when a tag is about to be freed (since the
+ *	cache keys contain tag pointers). It is a no-op for widgets whose
+ *	display information has already been freed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The cache's references to TextStyle structures are released, which may
+ *	free the styles.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkTextFlushStyleCache(
+    TkText *textPtr)		/* Overall information about text widget. */
+{
+    Tcl_HashSearch search;
+    Tcl_HashEntry *hPtr;
+
+    if (textPtr->dInfoPtr == NULL) {
+	return;
+    }
+    while ((hPtr = Tcl_FirstHashEntry(&textPtr->dInfoPtr->styleCacheTable,
+	    &search)) != NULL) {
+	FreeStyle(textPtr, (TextStyle *)Tcl_GetHashValue(hPtr));
+	Tcl_DeleteHashEntry(hPtr);
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -1186,7 +1692,7 @@ LayoutDLine(
      * Create and initialize a new DLine structure.
      */
 
-    dlPtr = (DLine *)ckalloc(sizeof(DLine));
+    dlPtr = DLineAlloc(textPtr->dInfoPtr);
     dlPtr->index = *indexPtr;
     dlPtr->byteCount = 0;
     dlPtr->y = 0;
@@ -1435,9 +1941,7 @@ LayoutDLine(
 	    continue;
 	}
 	if (chunkPtr == NULL) {
-	    chunkPtr = (TkTextDispChunk *)ckalloc(sizeof(TkTextDispChunk));
-	    chunkPtr->nextPtr = NULL;
-	    chunkPtr->clientData = NULL;
+	    chunkPtr = ChunkAlloc(textPtr->dInfoPtr);
 	}
 	chunkPtr->stylePtr = GetStyle(textPtr, &curIndex);
 	elide = chunkPtr->stylePtr->sValuePtr->elide;
@@ -1568,7 +2072,7 @@ LayoutDLine(
 	     */
 
 	    if (chunkPtr != NULL) {
-		ckfree(chunkPtr);
+		ChunkFree(textPtr->dInfoPtr, chunkPtr);
 	    }
 	    break;
 	}
@@ -1699,7 +2203,7 @@ LayoutDLine(
 	    if (chunkPtr->undisplayProc != NULL) {
 		chunkPtr->undisplayProc(textPtr, chunkPtr);
 	    }
-	    ckfree(chunkPtr);
+	    ChunkFree(textPtr->dInfoPtr, chunkPtr);
 	}
 	if (breakByteOffset != breakChunkPtr->numBytes) {
 	    if (breakChunkPtr->undisplayProc != NULL) {
@@ -2019,8 +2523,8 @@ UpdateDisplayInfo(
 		 * right for the first line in the re-display.
 		 */
 
-		TkBTreeLinePixelEpoch(textPtr, prevPtr->index.linePtr) =
-			dInfoPtr->lineMetricUpdateEpoch;
+		TkBTreeLinePixelEpochSet(textPtr, prevPtr->index.linePtr,
+			dInfoPtr->lineMetricUpdateEpoch);
 	    }
 	    lineHeight = 0;
 	}
@@ -2149,9 +2653,9 @@ UpdateDisplayInfo(
 			 * epoch.
 			 */
 
-			TkBTreeLinePixelEpoch(textPtr,
-				lowestPtr->index.linePtr) =
-				dInfoPtr->lineMetricUpdateEpoch;
+			TkBTreeLinePixelEpochSet(textPtr,
+				lowestPtr->index.linePtr,
+				dInfoPtr->lineMetricUpdateEpoch);
 		    }
 		}
 
@@ -2402,9 +2906,9 @@ FreeDLines(
 	    }
 	    FreeStyle(textPtr, chunkPtr->stylePtr);
 	    nextChunkPtr = chunkPtr->nextPtr;
-	    ckfree(chunkPtr);
+	    ChunkFree(textPtr->dInfoPtr, chunkPtr);
 	}
-	ckfree(firstPtr);
+	DLineFree(textPtr->dInfoPtr, firstPtr);
 	firstPtr = nextDLinePtr;
     }
     if (action != DLINE_FREE_TEMP) {
@@ -2412,19 +2916,162 @@ FreeDLines(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * DLineXOfByte --
+ *
+ *	Given a byte offset relative to the start of a display line, find the
+ *	x-coordinate of the left edge of that byte, measured from the left
+ *	edge of the logical line (i.e. before translation for horizontal
+ *	scrolling). Offsets beyond the end of the display line yield the
+ *	right edge of its last chunk.
+ *
+ * Results:
+ *	The x-coordinate, in pixels.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+DLineXOfByte(
+    TkText *textPtr,		/* Widget record for text widget. */
+    DLine *dlPtr,		/* Display line to measure in. */
+    int byteCount)		/* Byte offset, relative to the first byte of
+				 * the display line. */
+{
+    TkTextDispChunk *chunkPtr;
+    int x, yDummy, width, height;
+
+    for (chunkPtr = dlPtr->chunkPtr; chunkPtr != NULL;
+	    chunkPtr = chunkPtr->nextPtr) {
+	if (byteCount < chunkPtr->numBytes) {
+	    if (chunkPtr->bboxProc == NULL) {
+		return chunkPtr->x;
+	    }
+	    chunkPtr->bboxProc(textPtr, chunkPtr, byteCount,
+		    dlPtr->y + dlPtr->spaceAbove,
+		    dlPtr->height - dlPtr->spaceAbove - dlPtr->spaceBelow,
+		    dlPtr->baseline - dlPtr->spaceAbove, &x, &yDummy, &width,
+		    &height);
+	    return x;
+	}
+	byteCount -= chunkPtr->numBytes;
+	if (chunkPtr->nextPtr == NULL) {
+	    return chunkPtr->x + chunkPtr->width;
+	}
+    }
+    return 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * BlockSelOverlay --
+ *
+ *	If the widget's block selection crosses the given display line, fill
+ *	the covered columns with the selection background. Called by
+ *	DisplayDLine between the background and foreground passes, so the
+ *	highlight sits under the text like an ordinary selection, without any
+ *	per-line tag machinery.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	A rectangle may be drawn in the pixmap.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+BlockSelOverlay(
+    TkText *textPtr,		/* Widget record for text widget. */
+    DLine *dlPtr,		/* Display line being drawn. */
+    Pixmap pixmap,		/* Pixmap being drawn into. */
+    int y)			/* Y-coordinate of the line in the pixmap. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    TkTextIndex index;
+    int line1 = textPtr->blockSelLine1, line2 = textPtr->blockSelLine2;
+    int col1 = textPtr->blockSelCol1, col2 = textPtr->blockSelCol2;
+    int lineNo, byte1, byte2, dlStart, dlEnd, x1, x2, tmp;
+
+    if (line2 < line1) {
+	tmp = line1; line1 = line2; line2 = tmp;
+    }
+    if (col2 < col1) {
+	tmp = col1; col1 = col2; col2 = tmp;
+    }
+    if (col1 == col2) {
+	return;
+    }
+    lineNo = TkBTreeLinesTo(textPtr, dlPtr->index.linePtr);
+    if ((lineNo < line1) || (lineNo > line2)) {
+	return;
+    }
+
+    /*
+     * Convert the two columns to byte offsets within the logical line
+     * (columns beyond its end clamp to the newline, so short lines show a
+     * correspondingly short - possibly empty - highlight), then clip them
+     * against the bytes this particular display line covers: when the line
+     * wraps, the block may belong to another of its display lines.
+     */
+
+    TkTextMakeCharIndex(textPtr->sharedTextPtr->tree, textPtr, lineNo, col1,
+	    &index);
+    byte1 = index.byteIndex;
+    TkTextMakeCharIndex(textPtr->sharedTextPtr->tree, textPtr, lineNo, col2,
+	    &index);
+    byte2 = index.byteIndex;
+    dlStart = dlPtr->index.byteIndex;
+    dlEnd = dlStart + dlPtr->byteCount;
+    if ((byte2 <= dlStart) || (byte1 >= dlEnd)) {
+	return;
+    }
+    x1 = DLineXOfByte(textPtr, dlPtr,
+	    ((byte1 > dlStart) ? byte1 : dlStart) - dlStart);
+    x2 = DLineXOfByte(textPtr, dlPtr,
+	    ((byte2 < dlEnd) ? byte2 : dlEnd) - dlStart);
+    x1 += dInfoPtr->x - dInfoPtr->curXPixelOffset;
+    x2 += dInfoPtr->x - dInfoPtr->curXPixelOffset;
+    if (x1 < dInfoPtr->x) {
+	x1 = dInfoPtr->x;
+    }
+    if (x2 > dInfoPtr->maxX) {
+	x2 = dInfoPtr->maxX;
+    }
+    if (x2 <= x1) {
+	return;
+    }
+    Tk_Fill3DRectangle(textPtr->tkwin, pixmap, textPtr->selBorder, x1,
+	    y + dlPtr->spaceAbove, x2 - x1,
+	    dlPtr->height - dlPtr->spaceAbove - dlPtr->spaceBelow, 0,
+	    TK_RELIEF_FLAT);
+}
+
 /*
  *----------------------------------------------------------------------
  *
  * DisplayDLine --
  *
- *	This function is invoked to draw a single line on the screen.
+ *	This function is invoked to draw a single line into the
+ *	double-buffering pixmap.
  *
  * Results:
  *	None.
  *
  * Side effects:
- *	The line given by dlPtr is drawn at its correct position in textPtr's
- *	window. Note that this is one *display* line, not one *text* line.
+ *	The line given by dlPtr is drawn at pixmapY in the pixmap; the caller
+ *	copies it to its correct position in textPtr's window, possibly
+ *	together with a batch of neighbouring lines. Note that this is one
+ *	*display* line, not one *text* line. When double-buffering is
+ *	disabled the pixmap is the window itself and the line is drawn in
+ *	place.
  *
  *----------------------------------------------------------------------
  */
@@ -2435,17 +3082,20 @@ DisplayDLine(
     DLine *dlPtr,	/* Information about line to draw. */
     DLine *prevPtr,		/* Line just before one to draw, or NULL if
 				 * dlPtr is the top line. */
-    Pixmap pixmap)		/* Pixmap to use for double-buffering. Caller
+    Pixmap pixmap,		/* Pixmap to use for double-buffering. Caller
 				 * must make sure it's large enough to hold
 				 * line. */
+    int pixmapY)		/* Y-coordinate in pixmap at which to draw the
+				 * line; ignored when double-buffering is
+				 * disabled. */
 {
     TkTextDispChunk *chunkPtr;
     TextDInfo *dInfoPtr = textPtr->dInfoPtr;
     Display *display;
-    int height, y_off;
 #ifndef TK_NO_DOUBLE_BUFFERING
-    const int y = 0;
+    const int y = pixmapY;
 #else
+    int height, y_off;
     const int y = dlPtr->y;
 #endif /* TK_NO_DOUBLE_BUFFERING */
 
@@ -2453,6 +3103,8 @@ DisplayDLine(
 
     display = Tk_Display(textPtr->tkwin);
 
+#ifdef TK_NO_DOUBLE_BUFFERING
+    (void)pixmapY;
     height = dlPtr->height;
     if ((height + dlPtr->y) > dInfoPtr->maxY) {
 	height = dInfoPtr->maxY - dlPtr->y;
@@ -2463,8 +3115,6 @@ DisplayDLine(
     } else {
 	y_off = 0;
     }
-
-#ifdef TK_NO_DOUBLE_BUFFERING
     TkpClipDrawableToRect(display, pixmap, dInfoPtr->x, y + y_off,
 	    dInfoPtr->maxX - dInfoPtr->x, height);
 #endif /* TK_NO_DOUBLE_BUFFERING */
@@ -2497,6 +3147,15 @@ DisplayDLine(
                 y, dlPtr->rMarginWidth, dlPtr->height, 0, TK_RELIEF_FLAT);
     }
 
+    /*
+     * Overlay the block selection, if one crosses this line, before any
+     * foreground is drawn.
+     */
+
+    if (textPtr->blockSelActive) {
+	BlockSelOverlay(textPtr, dlPtr, pixmap, y);
+    }
+
     /*
      * Make another pass through all of the chunks to redraw the insertion
      * cursor, if it is visible on this line. Must do it here rather than in
@@ -2569,24 +3228,70 @@ DisplayDLine(
 	}
     }
 
-#ifndef TK_NO_DOUBLE_BUFFERING
-    /*
-     * Copy the pixmap onto the screen. If this is the first or last line on
-     * the screen then copy a piece of the line, so that it doesn't overflow
-     * into the border area. Another special trick: copy the padding area to
-     * the left of the line; this is because the insertion cursor sometimes
-     * overflows onto that area and we want to get as much of the cursor as
-     * possible.
-     */
-
-    XCopyArea(display, pixmap, Tk_WindowId(textPtr->tkwin), dInfoPtr->copyGC,
-	    dInfoPtr->x, y + y_off, (unsigned) (dInfoPtr->maxX - dInfoPtr->x),
-	    (unsigned) height, dInfoPtr->x, dlPtr->y + y_off);
-#else
+#ifdef TK_NO_DOUBLE_BUFFERING
     TkpClipDrawableToRect(display, pixmap, 0, 0, -1, -1);
 #endif /* TK_NO_DOUBLE_BUFFERING */
     linesRedrawn++;
 }
+
+#ifndef TK_NO_DOUBLE_BUFFERING
+/*
+ *----------------------------------------------------------------------
+ *
+ * CopyDLineBatch --
+ *
+ *	Copy a batch of display lines that DisplayDLine drew into the
+ *	double-buffering pixmap onto the screen, in a single request. If the
+ *	batch overlaps the first or last line on the screen then only a piece
+ *	of it is copied, so that it doesn't overflow into the border area.
+ *	Another special trick: copy the padding area to the left of the
+ *	lines; this is because the insertion cursor sometimes overflows onto
+ *	that area and we want to get as much of the cursor as possible.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The batched lines appear in textPtr's window.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+CopyDLineBatch(
+    TkText *textPtr,		/* Text widget being redisplayed. */
+    Pixmap pixmap,		/* Pixmap the lines were drawn into, starting
+				 * at y-coordinate 0. */
+    int windowY,		/* Y-coordinate in the window of the first
+				 * line in the batch. */
+    int batchHeight)		/* Total height of the batched lines. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    int yOff, height;
+    Tcl_Time perfStart;
+
+    if (batchHeight <= 0) {
+	return;
+    }
+    yOff = (windowY < dInfoPtr->y) ? dInfoPtr->y - windowY : 0;
+    height = batchHeight;
+    if (windowY + height > dInfoPtr->maxY) {
+	height = dInfoPtr->maxY - windowY;
+    }
+    height -= yOff;
+    if (height <= 0) {
+	return;
+    }
+    TK_PERF_TIMER_START(&perfStart);
+    XCopyArea(Tk_Display(textPtr->tkwin), pixmap,
+	    Tk_WindowId(textPtr->tkwin), dInfoPtr->copyGC, dInfoPtr->x, yOff,
+	    (unsigned) (dInfoPtr->maxX - dInfoPtr->x), (unsigned) height,
+	    dInfoPtr->x, windowY + yOff);
+    TK_PERF_XRECORD(textPtr->tkwin, "copyarea",
+	    (unsigned int) (dInfoPtr->maxX - dInfoPtr->x)
+	    * (unsigned int) height * 4, &perfStart);
+}
+#endif /* TK_NO_DOUBLE_BUFFERING */
 
 /*
  *--------------------------------------------------------------
@@ -2980,6 +3685,13 @@ DisplayLineBackground(
     }
 }
 
+/*
+ * The number of milliseconds of line metric calculation that one invocation
+ * of AsyncUpdateLineMetrics may use before it must return to the event loop.
+ */
+
+#define LINE_METRIC_TIME_SLICE	5
+
 /*
  *----------------------------------------------------------------------
  *
@@ -3009,7 +3721,8 @@ AsyncUpdateLineMetrics(
 {
     TkText *textPtr = (TkText *)clientData;
     TextDInfo *dInfoPtr = textPtr->dInfoPtr;
-    int lineNum;
+    int lineNum, elapsed;
+    Tcl_Time start, now;
 
     dInfoPtr->lineUpdateTimer = NULL;
 
@@ -3044,11 +3757,25 @@ AsyncUpdateLineMetrics(
 
     /*
      * Update the lines in blocks of about 24 recalculations, or 250+ lines
-     * examined, so we pass in 256 for 'doThisMuch'.
+     * examined (we pass in 256 for 'doThisMuch'), until a few milliseconds
+     * of this invocation have been used up. A fixed amount of work per timer
+     * tick either freezes the interface (a single block can take arbitrarily
+     * long when lines wrap many times) or wastes time in timer round trips
+     * (cheap lines would allow much bigger blocks). Bounding the invocation
+     * by wall-clock time instead adapts it to the actual cost of the lines.
      */
 
-    lineNum = TkTextUpdateLineMetrics(textPtr, lineNum,
-	    dInfoPtr->lastMetricUpdateLine, 256);
+    Tcl_GetTime(&start);
+    do {
+	lineNum = TkTextUpdateLineMetrics(textPtr, lineNum,
+		dInfoPtr->lastMetricUpdateLine, 256);
+	if (dInfoPtr->metricEpoch == TCL_INDEX_NONE
+		&& lineNum == dInfoPtr->lastMetricUpdateLine) {
+	    break;
+	}
+	Tcl_GetTime(&now);
+	elapsed = (now.sec - start.sec) * 1000 + (now.usec - start.usec) / 1000;
+    } while (elapsed < LINE_METRIC_TIME_SLICE);
 
     dInfoPtr->currentMetricUpdateLine = lineNum;
 
@@ -3111,6 +3838,181 @@ AsyncUpdateLineMetrics(
 	    AsyncUpdateLineMetrics, textPtr);
 }
 
+/*
+ * Milliseconds of scrolling at the measured velocity that the predictive
+ * pre-layout pass tries to keep laid out ahead of the view.
+ */
+
+#define PRE_LAYOUT_HORIZON	300
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * SchedulePreLayout --
+ *
+ *	Called whenever the view scrolls by pixels. Measures the scroll
+ *	velocity from the time elapsed since the previous scroll, converts
+ *	it into a pixel horizon (clamped between one and four window
+ *	heights) and schedules AsyncPreLayout to bring the line metrics in
+ *	the scroll direction up to date during idle time, so that following
+ *	scroll steps find their heights already computed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	A timer callback may be scheduled, and a reference to the widget is
+ *	held while it is pending.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+SchedulePreLayout(
+    TkText *textPtr,		/* Widget being scrolled. */
+    int offset)			/* Pixel scroll amount; the sign gives the
+				 * scroll direction. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    Tcl_Time now;
+    int elapsed, pixels, height;
+
+    height = dInfoPtr->maxY - dInfoPtr->y;
+    if (height <= 0) {
+	height = 1;
+    }
+    Tcl_GetTime(&now);
+    elapsed = (now.sec - dInfoPtr->lastScrollTime.sec) * 1000
+	    + (now.usec - dInfoPtr->lastScrollTime.usec) / 1000;
+    dInfoPtr->lastScrollTime = now;
+
+    /*
+     * Scroll events further apart than the horizon give no useful velocity
+     * estimate; fall back to a single window height of lookahead.
+     */
+
+    if ((elapsed <= 0) || (elapsed > PRE_LAYOUT_HORIZON)) {
+	pixels = height;
+    } else {
+	pixels = abs(offset) * PRE_LAYOUT_HORIZON / elapsed;
+	if (pixels < height) {
+	    pixels = height;
+	} else if (pixels > 4 * height) {
+	    pixels = 4 * height;
+	}
+    }
+    dInfoPtr->preLayoutDirection = (offset > 0) ? 1 : -1;
+    dInfoPtr->preLayoutPixels = pixels;
+    if (dInfoPtr->preLayoutTimer == NULL) {
+	textPtr->refCount++;
+	dInfoPtr->preLayoutTimer = Tcl_CreateTimerHandler(1,
+		AsyncPreLayout, textPtr);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * AsyncPreLayout --
+ *
+ *	Timer callback that updates the line metrics for the region the
+ *	view is scrolling towards, ahead of it actually getting there. It
+ *	works in the same time slices as AsyncUpdateLineMetrics and relies
+ *	on the dirty-line fast path in TkTextUpdateLineMetrics to make
+ *	restarting over an already-updated prefix cheap, so no separate
+ *	progress state is needed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Line heights may be recalculated; the callback may reschedule
+ *	itself.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+AsyncPreLayout(
+    ClientData clientData)	/* Information about widget. */
+{
+    TkText *textPtr = (TkText *)clientData;
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    int lineNum, endLine, topLine, spanLines, totalLines, elapsed;
+    int charHeight;
+    Tcl_Time start, now;
+
+    dInfoPtr->preLayoutTimer = NULL;
+
+    if ((textPtr->tkwin == NULL) || (textPtr->flags & DESTROYED)
+	    || !Tk_IsMapped(textPtr->tkwin)) {
+	if (textPtr->refCount-- <= 1) {
+	    ckfree(textPtr);
+	}
+	return;
+    }
+
+    if (dInfoPtr->flags & REDRAW_PENDING) {
+	/*
+	 * Let the pending redisplay (the scroll itself) happen first; the
+	 * pre-layout is strictly background work.
+	 */
+
+	dInfoPtr->preLayoutTimer = Tcl_CreateTimerHandler(1,
+		AsyncPreLayout, clientData);
+	return;
+    }
+
+    /*
+     * Convert the pixel horizon into a logical line range. The fixed line
+     * height is only an estimate when lines wrap, but the range is advisory:
+     * the full sweep in AsyncUpdateLineMetrics still guarantees that every
+     * line is eventually updated.
+     */
+
+    totalLines = TkBTreeNumLines(textPtr->sharedTextPtr->tree, textPtr);
+    topLine = TkBTreeLinesTo(textPtr, textPtr->topIndex.linePtr);
+    charHeight = (textPtr->charHeight > 0) ? textPtr->charHeight : 1;
+    spanLines = dInfoPtr->preLayoutPixels / charHeight + 1;
+    if (dInfoPtr->preLayoutDirection >= 0) {
+	lineNum = topLine;
+	endLine = topLine + (dInfoPtr->maxY - dInfoPtr->y) / charHeight
+		+ spanLines;
+    } else {
+	lineNum = topLine - spanLines;
+	endLine = topLine;
+    }
+    if (lineNum < 0) {
+	lineNum = 0;
+    }
+    if (endLine > totalLines) {
+	endLine = totalLines;
+    }
+    if (lineNum >= endLine) {
+	if (textPtr->refCount-- <= 1) {
+	    ckfree(textPtr);
+	}
+	return;
+    }
+
+    Tcl_GetTime(&start);
+    do {
+	lineNum = TkTextUpdateLineMetrics(textPtr, lineNum, endLine, 256);
+	if ((lineNum == -1) || ((lineNum >= endLine)
+		&& (dInfoPtr->metricEpoch == TCL_INDEX_NONE))) {
+	    if (textPtr->refCount-- <= 1) {
+		ckfree(textPtr);
+	    }
+	    return;
+	}
+	Tcl_GetTime(&now);
+	elapsed = (now.sec - start.sec) * 1000 + (now.usec - start.usec) / 1000;
+    } while (elapsed < LINE_METRIC_TIME_SLICE);
+
+    dInfoPtr->preLayoutTimer = Tcl_CreateTimerHandler(1,
+	    AsyncPreLayout, textPtr);
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -3274,12 +4176,44 @@ TkTextUpdateLineMetrics(
 
 	    if (TkBTreeLinePixelEpoch(textPtr, linePtr)
 		    == textPtr->dInfoPtr->lineMetricUpdateEpoch) {
+		TkTextLine *dirtyLinePtr;
+		int dirtyLineNum;
 
 		/*
-		 * This line is already up to date. That means there's nothing
-		 * to do here.
+		 * This line is already up to date. Jump straight to the next
+		 * line which actually needs a recalculation, so that a scan
+		 * of a widget whose lines are mostly up to date doesn't
+		 * visit every clean line individually. The B-tree search
+		 * works on absolute line numbers, so we convert back to a
+		 * number relative to this client afterwards.
 		 */
 
+		dirtyLinePtr = TkBTreeNextDirtyPixelLine(
+			textPtr->sharedTextPtr->tree, textPtr,
+			TkBTreeLinesTo(NULL, linePtr) + 1,
+			textPtr->dInfoPtr->lineMetricUpdateEpoch, NULL);
+		if (dirtyLinePtr == NULL) {
+		    dirtyLineNum = totalLines;
+		} else {
+		    dirtyLineNum = TkBTreeLinesTo(textPtr, dirtyLinePtr);
+		}
+		if ((lineNum < endLine) && (dirtyLineNum > endLine)) {
+		    dirtyLineNum = endLine;
+		}
+		if (dirtyLineNum > lineNum + 1) {
+		    /*
+		     * Arrange for the loop to continue from the jumped-to
+		     * line; it will be re-fetched by line number above.
+		     */
+
+		    lineNum = dirtyLineNum;
+		    linePtr = NULL;
+		    count++;
+		    if (doThisMuch != -1 && count >= doThisMuch) {
+			break;
+		    }
+		    continue;
+		}
 	    } else if (doThisMuch == -1) {
 		count += 8 * TkTextUpdateOneLine(textPtr, linePtr, 0,NULL,0);
 	    } else {
@@ -3450,6 +4384,14 @@ TextInvalidateLineMetrics(
     int fromLine;
     TextDInfo *dInfoPtr = textPtr->dInfoPtr;
 
+    /*
+     * A change that invalidates individual line heights (a content edit or
+     * a geometry-influencing tag change) makes the cached wrap-metric
+     * snapshots unreliable as well; throw them away.
+     */
+
+    DiscardMetricSnapshots(dInfoPtr);
+
     if (linePtr != NULL) {
 	int counter = lineCount;
 
@@ -3459,11 +4401,11 @@ TextInvalidateLineMetrics(
 	 * Invalidate the height calculations of each line in the given range.
 	 */
 
-	TkBTreeLinePixelEpoch(textPtr, linePtr) = 0;
+	TkBTreeLinePixelEpochSet(textPtr, linePtr, 0);
 	while (counter > 0 && linePtr != NULL) {
 	    linePtr = TkBTreeNextLine(textPtr, linePtr);
 	    if (linePtr != NULL) {
-		TkBTreeLinePixelEpoch(textPtr, linePtr) = 0;
+		TkBTreeLinePixelEpochSet(textPtr, linePtr, 0);
 	    }
 	    counter--;
 	}
@@ -4081,8 +5023,8 @@ TkTextUpdateOneLine(
 	 * to date, that will happen in TkBTreeAdjustPixelHeight just below).
 	 */
 
-	TkBTreeLinePixelEpoch(textPtr, linePtr)
-		= textPtr->dInfoPtr->lineMetricUpdateEpoch;
+	TkBTreeLinePixelEpochSet(textPtr, linePtr,
+		textPtr->dInfoPtr->lineMetricUpdateEpoch);
 	if (TkBTreeLinePixelCount(textPtr, linePtr) != pixelHeight) {
 	    changed = 1;
 	}
@@ -4100,8 +5042,8 @@ TkTextUpdateOneLine(
 	    mergedLinePtr = linePtr;
 	    while (i-- > 0) {
 		mergedLinePtr = TkBTreeNextLine(textPtr, mergedLinePtr);
-		TkBTreeLinePixelEpoch(textPtr, mergedLinePtr)
-			= textPtr->dInfoPtr->lineMetricUpdateEpoch;
+		TkBTreeLinePixelEpochSet(textPtr, mergedLinePtr,
+			textPtr->dInfoPtr->lineMetricUpdateEpoch);
 		if (TkBTreeLinePixelCount(textPtr, mergedLinePtr) != 0) {
 		    changed = 1;
 		}
@@ -4144,6 +5086,156 @@ TkTextUpdateOneLine(
     return displayLines;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * GutterLineHasMark --
+ *
+ *	Determine whether a logical line carries a mark whose name starts
+ *	with GUTTER_MARK_PREFIX, which makes the gutter draw a marker beside
+ *	the line (the typical use being breakpoint indicators).
+ *
+ * Results:
+ *	1 if such a mark is set on the line, 0 otherwise.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+GutterLineHasMark(
+    TkText *textPtr,		/* Widget record for text widget. */
+    TkTextLine *linePtr)	/* Logical line to inspect. */
+{
+    TkTextSegment *segPtr;
+
+    for (segPtr = linePtr->segPtr; segPtr != NULL; segPtr = segPtr->nextPtr) {
+	if (((segPtr->typePtr == &tkTextRightMarkType)
+		|| (segPtr->typePtr == &tkTextLeftMarkType))
+		&& (segPtr->body.mark.hPtr != NULL)
+		&& (strncmp((const char *) Tcl_GetHashKey(
+			&textPtr->sharedTextPtr->markTable,
+			segPtr->body.mark.hPtr), GUTTER_MARK_PREFIX,
+			sizeof(GUTTER_MARK_PREFIX) - 1) == 0)) {
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * DisplayGutter --
+ *
+ *	Redraw the line-number gutter to the left of the text area. This is
+ *	called at the end of every redisplay pass, after lines have been
+ *	scrolled and repainted, so the gutter rides along with scrolling for
+ *	free: the numbers are placed from the vertical metrics of the display
+ *	lines that are already laid out, with no text relayout of any kind.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The gutter strip is repainted. If the number of digits in the last
+ *	line number has changed since the gutter was last laid out, a full
+ *	relayout is requested instead and the strip is left to the redisplay
+ *	pass that follows it.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DisplayGutter(
+    TkText *textPtr)		/* Widget record for text widget. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    Display *display = Tk_Display(textPtr->tkwin);
+    Drawable window = Tk_WindowId(textPtr->tkwin);
+    Tk_FontMetrics fm;
+    DLine *dlPtr;
+    XRectangle clipRect;
+    char numBuf[TCL_INTEGER_SPACE];
+    int gutterX, digits, numWidth, len;
+
+    if (dInfoPtr->gutterWidth == 0) {
+	return;
+    }
+
+    /*
+     * If the line count has grown (or shrunk) past what the gutter was
+     * sized for, the whole layout must shift; schedule that and draw
+     * nothing now.
+     */
+
+    digits = snprintf(numBuf, sizeof(numBuf), "%d",
+	    TkBTreeNumLines(textPtr->sharedTextPtr->tree, textPtr));
+    if (digits < GUTTER_MIN_DIGITS) {
+	digits = GUTTER_MIN_DIGITS;
+    }
+    if (digits != dInfoPtr->gutterDigits) {
+	TkTextRelayoutWindow(textPtr, TK_TEXT_LINE_GEOMETRY);
+	return;
+    }
+
+    if (dInfoPtr->gutterGC == NULL) {
+	XGCValues gcValues;
+
+	gcValues.graphics_exposures = False;
+	gcValues.foreground = textPtr->fgColor->pixel;
+	gcValues.font = Tk_FontId(textPtr->tkfont);
+	dInfoPtr->gutterGC = XCreateGC(display, window,
+		GCForeground|GCFont|GCGraphicsExposures, &gcValues);
+    }
+
+    /*
+     * Paint the background of the whole strip, then clip the numbers and
+     * markers to it so that partially scrolled lines at the top and bottom
+     * cannot leak into the borders.
+     */
+
+    gutterX = dInfoPtr->x - dInfoPtr->gutterWidth;
+    Tk_Fill3DRectangle(textPtr->tkwin, window, textPtr->border, gutterX,
+	    dInfoPtr->y, dInfoPtr->gutterWidth, dInfoPtr->maxY - dInfoPtr->y,
+	    0, TK_RELIEF_FLAT);
+    clipRect.x = gutterX;
+    clipRect.y = dInfoPtr->y;
+    clipRect.width = dInfoPtr->gutterWidth;
+    clipRect.height = dInfoPtr->maxY - dInfoPtr->y;
+    XSetClipRectangles(display, dInfoPtr->gutterGC, 0, 0, &clipRect, 1,
+	    Unsorted);
+
+    Tk_GetFontMetrics(textPtr->tkfont, &fm);
+    for (dlPtr = dInfoPtr->dLinePtr;
+	    (dlPtr != NULL) && (dlPtr->y < dInfoPtr->maxY);
+	    dlPtr = dlPtr->nextPtr) {
+	/*
+	 * Only the first display line of each logical line is numbered;
+	 * continuation lines produced by wrapping show an empty gutter.
+	 */
+
+	if (dlPtr->index.byteIndex != 0) {
+	    continue;
+	}
+	len = snprintf(numBuf, sizeof(numBuf), "%d",
+		TkBTreeLinesTo(textPtr, dlPtr->index.linePtr) + 1);
+	numWidth = Tk_TextWidth(textPtr->tkfont, numBuf, len);
+	Tk_DrawChars(display, window, dInfoPtr->gutterGC, textPtr->tkfont,
+		numBuf, len,
+		gutterX + dInfoPtr->gutterWidth - GUTTER_PAD - numWidth,
+		dlPtr->y + dlPtr->baseline);
+	if (GutterLineHasMark(textPtr, dlPtr->index.linePtr)) {
+	    XFillArc(display, window, dInfoPtr->gutterGC,
+		    gutterX + GUTTER_PAD,
+		    dlPtr->y + dlPtr->baseline - fm.ascent, fm.ascent,
+		    fm.ascent, 0, 64*360);
+	}
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -4170,10 +5262,15 @@ DisplayText(
     DLine *dlPtr;
     DLine *prevPtr;
     Pixmap pixmap;
+    TkRegion damageRgn;
     int maxHeight, borders;
+#ifndef TK_NO_DOUBLE_BUFFERING
+    int pixmapHeight, batchY, batchHeight;
+#endif /* TK_NO_DOUBLE_BUFFERING */
     int bottomY = 0;		/* Initialization needed only to stop compiler
 				 * warnings. */
     Tcl_Interp *interp;
+    Tcl_Time perfStart;
 
 
     if ((textPtr->tkwin == NULL) || (textPtr->flags & DESTROYED)) {
@@ -4183,6 +5280,8 @@ DisplayText(
 
 	return;
     }
+    TK_PERF_TIMER_START(&perfStart);
+    TkFrameBudgetStart();
 
 #ifdef MAC_OSX_TK
     /*
@@ -4254,10 +5353,10 @@ DisplayText(
      * some scrolling purposes.
      */
 
+    damageRgn = TkCreateRegion();
     for (dlPtr = dInfoPtr->dLinePtr; dlPtr != NULL; dlPtr = dlPtr->nextPtr) {
 	DLine *dlPtr2;
 	int offset, height, y, oldY;
-	TkRegion damageRgn;
 
 	/*
 	 * These tests are, in order:
@@ -4357,20 +5456,33 @@ DisplayText(
 	}
 
 	/*
-	 * Now scroll the lines. This may generate damage which we handle by
+	 * Now scroll the lines. The copy is deferred where the platform
+	 * supports it, so that several bands can be scrolled before waiting
+	 * for the server; any damage reported right away is handled by
 	 * calling TextInvalidateRegion to mark the display blocks as stale.
 	 */
 
-	damageRgn = TkCreateRegion();
-	if (TkScrollWindow(textPtr->tkwin, dInfoPtr->scrollGC, dInfoPtr->x,
-		oldY, dInfoPtr->maxX-dInfoPtr->x, height, 0, y-oldY,
-		damageRgn)) {
+	if (TkScrollWindowDefer(textPtr->tkwin, dInfoPtr->scrollGC,
+		dInfoPtr->x, oldY, dInfoPtr->maxX-dInfoPtr->x, height, 0,
+		y-oldY, damageRgn)) {
 	    TextInvalidateRegion(textPtr, damageRgn);
 	}
 	numCopies++;
-	TkDestroyRegion(damageRgn);
     }
 
+    /*
+     * Collect the damage generated by any still-pending scroll copies. The
+     * deferred copies may have duplicated stale pixels that a synchronous
+     * scroll would have avoided copying, but the collected region covers
+     * the final position of every stale area, so the lines holding them are
+     * marked for redisplay either way.
+     */
+
+    if (TkScrollWindowFlush(textPtr->tkwin, damageRgn)) {
+	TextInvalidateRegion(textPtr, damageRgn);
+    }
+    TkDestroyRegion(damageRgn);
+
     /*
      * Clear the REDRAW_PENDING flag here. This is actually pretty tricky. We
      * want to wait until *after* doing the scrolling, since that could
@@ -4479,9 +5591,21 @@ DisplayText(
 
     if (maxHeight > 0) {
 #ifndef TK_NO_DOUBLE_BUFFERING
+	/*
+	 * Make the pixmap tall enough to hold a whole run of adjacent dirty
+	 * lines, so that each run can be copied onto the screen with a
+	 * single XCopyArea call instead of one call per line.
+	 */
+
+	pixmapHeight = dInfoPtr->maxY + dInfoPtr->topPixelOffset;
+	if (pixmapHeight < maxHeight) {
+	    pixmapHeight = maxHeight;
+	}
 	pixmap = Tk_GetPixmap(Tk_Display(textPtr->tkwin),
 		Tk_WindowId(textPtr->tkwin), Tk_Width(textPtr->tkwin),
-		maxHeight, Tk_Depth(textPtr->tkwin));
+		pixmapHeight, Tk_Depth(textPtr->tkwin));
+	batchY = 0;
+	batchHeight = 0;
 #else
 	pixmap = Tk_WindowId(textPtr->tkwin);
 #endif /* TK_NO_DOUBLE_BUFFERING */
@@ -4498,15 +5622,64 @@ DisplayText(
 		    TkTextPrintIndex(textPtr, &dlPtr->index, string);
 		    LOG("tk_textRedraw", string);
 		}
-		DisplayDLine(textPtr, dlPtr, prevPtr, pixmap);
+#ifndef TK_NO_DOUBLE_BUFFERING
+		/*
+		 * Flush the batch accumulated so far if this line is not
+		 * contiguous with it or would overflow the pixmap.
+		 */
+
+		if ((batchHeight > 0)
+			&& ((dlPtr->y != batchY + batchHeight)
+			|| (batchHeight + dlPtr->height > pixmapHeight))) {
+		    CopyDLineBatch(textPtr, pixmap, batchY, batchHeight);
+		    batchHeight = 0;
+		}
+		if (batchHeight == 0) {
+		    batchY = dlPtr->y;
+		}
+		DisplayDLine(textPtr, dlPtr, prevPtr, pixmap, batchHeight);
+#else
+		DisplayDLine(textPtr, dlPtr, prevPtr, pixmap, 0);
+#endif /* TK_NO_DOUBLE_BUFFERING */
 		if (dInfoPtr->dLinesInvalidated) {
 #ifndef TK_NO_DOUBLE_BUFFERING
+		    /*
+		     * The lines completed before the interruption must still
+		     * reach the screen. The interrupted line was never marked
+		     * as drawn, so it will be redrawn on the next pass.
+		     */
+
+		    CopyDLineBatch(textPtr, pixmap, batchY, batchHeight);
 		    Tk_FreePixmap(Tk_Display(textPtr->tkwin), pixmap);
 #endif /* TK_NO_DOUBLE_BUFFERING */
+		    TK_PERF_TIMER_STOP(TK_PERF_TIMER_TEXT, &perfStart);
 		    return;
 		}
+#ifndef TK_NO_DOUBLE_BUFFERING
+		batchHeight += dlPtr->height;
+#endif /* TK_NO_DOUBLE_BUFFERING */
 		dlPtr->oldY = dlPtr->y;
 		dlPtr->flags &= ~(NEW_LAYOUT | OLD_Y_INVALID);
+		if ((dlPtr->nextPtr != NULL) && TkFrameBudgetCheck()) {
+		    /*
+		     * Out of frame budget with more lines to go. Push what
+		     * has been drawn so far onto the screen and reschedule;
+		     * the next idle pass continues with the lines that are
+		     * still marked dirty, after pending input has been
+		     * serviced.
+		     */
+
+#ifndef TK_NO_DOUBLE_BUFFERING
+		    CopyDLineBatch(textPtr, pixmap, batchY, batchHeight);
+		    Tk_FreePixmap(Tk_Display(textPtr->tkwin), pixmap);
+#endif /* TK_NO_DOUBLE_BUFFERING */
+		    if (!(dInfoPtr->flags & REDRAW_PENDING)) {
+			dInfoPtr->flags |= REDRAW_PENDING;
+			Tcl_DoWhenIdle(DisplayText, textPtr);
+		    }
+		    TK_PERF_TIMER_STOP(TK_PERF_TIMER_TEXT, &perfStart);
+		    goto doScrollbars;
+		}
 #ifdef MAC_OSX_TK
 	    } else if (dlPtr->chunkPtr != NULL) {
 		/*
@@ -4591,10 +5764,19 @@ DisplayText(
 	    }
 	}
 #ifndef TK_NO_DOUBLE_BUFFERING
+	CopyDLineBatch(textPtr, pixmap, batchY, batchHeight);
 	Tk_FreePixmap(Tk_Display(textPtr->tkwin), pixmap);
 #endif /* TK_NO_DOUBLE_BUFFERING */
     }
 
+    /*
+     * Repaint the line-number gutter, if there is one. This must happen on
+     * every pass: scrolling moved the lines without touching the strip, and
+     * the numbers come from the display lines' final positions.
+     */
+
+    DisplayGutter(textPtr);
+
     /*
      * See if we need to refresh the part of the window below the last line of
      * text (if there is any such area). Refresh the padding area on the left
@@ -4657,6 +5839,7 @@ DisplayText(
 
   end:
     Tcl_Release(interp);
+    TK_PERF_TIMER_STOP(TK_PERF_TIMER_TEXT, &perfStart);
 }
 
 /*
@@ -4707,31 +5890,182 @@ TkTextEventuallyRepick(
  *----------------------------------------------------------------------
  */
 
-void
-TkTextRedrawRegion(
-    TkText *textPtr,		/* Widget record for text widget. */
-    int x, int y,		/* Coordinates of upper-left corner of area to
-				 * be redrawn, in pixels relative to textPtr's
-				 * window. */
-    int width, int height)	/* Width and height of area to be redrawn. */
-{
-    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
-    TkRegion damageRgn = TkCreateRegion();
-    XRectangle rect;
+void
+TkTextRedrawRegion(
+    TkText *textPtr,		/* Widget record for text widget. */
+    int x, int y,		/* Coordinates of upper-left corner of area to
+				 * be redrawn, in pixels relative to textPtr's
+				 * window. */
+    int width, int height)	/* Width and height of area to be redrawn. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    TkRegion damageRgn = TkCreateRegion();
+    XRectangle rect;
+
+    rect.x = x;
+    rect.y = y;
+    rect.width = width;
+    rect.height = height;
+    TkUnionRectWithRegion(&rect, damageRgn, damageRgn);
+
+    TextInvalidateRegion(textPtr, damageRgn);
+
+    if (!(dInfoPtr->flags & REDRAW_PENDING)) {
+	dInfoPtr->flags |= REDRAW_PENDING;
+	Tcl_DoWhenIdle(DisplayText, textPtr);
+    }
+    TkDestroyRegion(damageRgn);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkTextRenderRegion --
+ *
+ *	Lay out and draw an arbitrary region of the widget's contents into a
+ *	caller-supplied pixmap, without disturbing the display lines cached
+ *	for the live view and without scheduling a redisplay. This is
+ *	intended for embedders that composite text content offscreen (e.g.
+ *	tile-based renderers). The region is addressed in buffer
+ *	coordinates: y is a pixel offset from the top of the very first
+ *	display line and x is a horizontal scroll offset applied to every
+ *	display line, independent of the widget's own view.
+ *
+ *	Lines are laid out at the widget's current wrap width, so the useful
+ *	region width is bounded by the width of the widget's viewport; rows
+ *	below the last line are filled with the widget's background.
+ *	Embedded windows are not drawn: they are separate drawables which an
+ *	embedding compositor must composite itself.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The given region of the pixmap is overwritten with the rendered
+ *	contents. The line metrics of the whole widget are brought up to
+ *	date first (just as "pathName sync" does) so that the pixel offset
+ *	y identifies a unique display line.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkTextRenderRegion(
+    TkText *textPtr,		/* Widget record for text widget. */
+    int x,			/* Horizontal pixel offset applied to every
+				 * display line. */
+    int y,			/* Vertical pixel offset of the top of the
+				 * region, measured from the top of the first
+				 * display line of the widget's contents. */
+    int width, int height,	/* Size of the region to render. The pixmap
+				 * must be at least this large. */
+    Pixmap pixmap)		/* Where to draw. Must have the same depth as
+				 * the widget's window. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    DLine *firstPtr, *lastPtr, *dlPtr, *prevPtr;
+    TkTextDispChunk *chunkPtr;
+    TkTextIndex index;
+    int pixmapY, savedXPixelOffset;
+
+    if ((textPtr->tkwin == NULL) || (textPtr->flags & DESTROYED)
+	    || (width <= 0) || (height <= 0)) {
+	return;
+    }
+
+    /*
+     * Fill the whole region with the background color first, so that the
+     * space below the last line (and any gap above the first line, for a
+     * negative y) ends up looking like the widget's own empty space.
+     */
+
+    Tk_Fill3DRectangle(textPtr->tkwin, pixmap, textPtr->border, 0, 0,
+	    width, height, 0, TK_RELIEF_FLAT);
+
+    /*
+     * Bring every line's metrics up to date so that the pixel offset y
+     * identifies a unique display line.
+     */
+
+    TkTextUpdateLineMetrics(textPtr, 0,
+	    TkBTreeNumLines(textPtr->sharedTextPtr->tree, textPtr), -1);
+
+    pixmapY = 0;
+    if (y < 0) {
+	pixmapY = -y;
+	y = 0;
+    }
+    if ((pixmapY >= height) || (y >= TkBTreeNumPixels(
+	    textPtr->sharedTextPtr->tree, textPtr))) {
+	return;
+    }
+
+    /*
+     * Find the display line containing the top of the region; if the region
+     * starts part-way down that line, start drawing above the region so
+     * that the right band of the line shows.
+     */
+
+    pixmapY -= TkTextMakePixelIndex(textPtr, y, &index);
+
+    /*
+     * First lay out the whole chain of display lines covering the region,
+     * so that the background pass below can merge 3D borders between
+     * adjacent lines just as the normal redisplay does. The chain is kept
+     * private: it is never linked into dInfoPtr->dLinePtr.
+     */
+
+    firstPtr = lastPtr = NULL;
+    while (pixmapY < height) {
+	dlPtr = LayoutDLine(textPtr, &index);
+	if (lastPtr == NULL) {
+	    firstPtr = dlPtr;
+	} else {
+	    lastPtr->nextPtr = dlPtr;
+	}
+	lastPtr = dlPtr;
+	dlPtr->y = pixmapY;
+	pixmapY += dlPtr->height;
+
+	/*
+	 * Embedded windows are real windows positioned over the live view;
+	 * suppress their display procs so that rendering offscreen does not
+	 * reposition them on the screen.
+	 */
 
-    rect.x = x;
-    rect.y = y;
-    rect.width = width;
-    rect.height = height;
-    TkUnionRectWithRegion(&rect, damageRgn, damageRgn);
+	for (chunkPtr = dlPtr->chunkPtr; chunkPtr != NULL;
+		chunkPtr = chunkPtr->nextPtr) {
+	    if (chunkPtr->displayProc == TkTextEmbWinDisplayProc) {
+		chunkPtr->displayProc = NULL;
+	    }
+	}
+	if (dlPtr->byteCount == 0) {
+	    break;
+	}
+	if (TkTextIndexForwBytes(textPtr, &index, dlPtr->byteCount, &index)) {
+	    break;
+	}
+    }
 
-    TextInvalidateRegion(textPtr, damageRgn);
+    /*
+     * Now draw each line into the pixmap. The x offset of the region is
+     * applied through the same horizontal scroll offset the normal
+     * redisplay uses; it is restored before returning so that the live
+     * view is unaffected.
+     */
 
-    if (!(dInfoPtr->flags & REDRAW_PENDING)) {
-	dInfoPtr->flags |= REDRAW_PENDING;
-	Tcl_DoWhenIdle(DisplayText, textPtr);
+    savedXPixelOffset = dInfoPtr->curXPixelOffset;
+    dInfoPtr->curXPixelOffset = x;
+    prevPtr = NULL;
+    for (dlPtr = firstPtr; dlPtr != NULL; dlPtr = dlPtr->nextPtr) {
+	DisplayDLine(textPtr, dlPtr, prevPtr, pixmap, dlPtr->y);
+	prevPtr = dlPtr;
+    }
+    dInfoPtr->curXPixelOffset = savedXPixelOffset;
+
+    if (firstPtr != NULL) {
+	FreeDLines(textPtr, firstPtr, NULL, DLINE_FREE_TEMP);
     }
-    TkDestroyRegion(damageRgn);
 }
 
 /*
@@ -4847,6 +6181,7 @@ TextChanged(
 {
     TextDInfo *dInfoPtr = textPtr->dInfoPtr;
     DLine *firstPtr, *lastPtr;
+    DLine *dlPtr, *prevDlPtr;
     TkTextIndex rounded;
     TkTextLine *linePtr;
     int notBegin;
@@ -4949,6 +6284,33 @@ TextChanged(
         }
     }
 
+    /*
+     * The change cannot affect display lines of the edited text line that
+     * lie entirely before index1Ptr: an edit never modifies preceding bytes,
+     * and the layout of a display line depends only on its own contents.
+     * Keep such display lines and free only from the display line containing
+     * index1Ptr onwards, so that typing in a long wrapped line does not
+     * relayout the whole line. Back up by one extra display line, because an
+     * edit just after a wrap point can allow text to move back up to the
+     * previous display line. If in doubt (e.g. merged elided lines), fall
+     * back to freeing from the start of the text line.
+     */
+
+    prevDlPtr = NULL;
+    for (dlPtr = firstPtr; dlPtr != lastPtr && dlPtr != NULL;
+	    dlPtr = dlPtr->nextPtr) {
+	if (dlPtr->index.linePtr == index1Ptr->linePtr
+		&& dlPtr->index.byteIndex <= index1Ptr->byteIndex) {
+	    if (prevDlPtr != NULL
+		    && prevDlPtr->index.linePtr == index1Ptr->linePtr) {
+		firstPtr = prevDlPtr;
+	    } else {
+		firstPtr = dlPtr;
+	    }
+	}
+	prevDlPtr = dlPtr;
+    }
+
     /*
      * Delete all the DLines from firstPtr up to but not including lastPtr.
      */
@@ -5021,6 +6383,13 @@ TextRedrawTag(
     TkTextIndex *curIndexPtr;
     TkTextIndex endOfText, *endIndexPtr;
 
+    /*
+     * The tag's options or priority may just have changed, so any memoized
+     * styles computed from it are stale.
+     */
+
+    TkTextFlushStyleCache(textPtr);
+
     /*
      * Invalidate the pixel calculation of all lines in the given range. This
      * may be a bit over-aggressive, so we could consider more subtle
@@ -5216,6 +6585,13 @@ TkTextRelayoutWindow(
     dInfoPtr->flags |= REDRAW_PENDING|REDRAW_BORDERS|DINFO_OUT_OF_DATE
 	    |REPICK_NEEDED;
 
+    /*
+     * The widget defaults that feed into the style merge may have changed,
+     * so the memoized styles cannot be trusted any more.
+     */
+
+    TkTextFlushStyleCache(textPtr);
+
     /*
      * (Re-)create the graphics context for drawing the traversal highlight.
      */
@@ -5247,6 +6623,37 @@ TkTextRelayoutWindow(
 	    + textPtr->padX;
     dInfoPtr->y = textPtr->highlightWidth + textPtr->borderWidth
 	    + textPtr->padY;
+
+    /*
+     * Reserve space for the line-number gutter, sized for the digits of the
+     * last line number plus a marker column. The gutter's graphics context
+     * depends on the widget font and foreground, which may just have
+     * changed, so it is thrown away here and recreated lazily the next time
+     * the gutter is drawn.
+     */
+
+    if (dInfoPtr->gutterGC != NULL) {
+	XFreeGC(textPtr->display, dInfoPtr->gutterGC);
+	dInfoPtr->gutterGC = NULL;
+    }
+    dInfoPtr->gutterWidth = 0;
+    dInfoPtr->gutterDigits = 0;
+    if (textPtr->gutter) {
+	Tk_FontMetrics fm;
+	char numBuf[TCL_INTEGER_SPACE];
+	int digits;
+
+	Tk_GetFontMetrics(textPtr->tkfont, &fm);
+	digits = snprintf(numBuf, sizeof(numBuf), "%d",
+		TkBTreeNumLines(textPtr->sharedTextPtr->tree, textPtr));
+	if (digits < GUTTER_MIN_DIGITS) {
+	    digits = GUTTER_MIN_DIGITS;
+	}
+	dInfoPtr->gutterDigits = digits;
+	dInfoPtr->gutterWidth = 3*GUTTER_PAD + fm.ascent
+		+ digits * Tk_TextWidth(textPtr->tkfont, "0", 1);
+	dInfoPtr->x += dInfoPtr->gutterWidth;
+    }
     dInfoPtr->maxX = Tk_Width(textPtr->tkwin) - textPtr->highlightWidth
 	    - textPtr->borderWidth - textPtr->padX;
     if (dInfoPtr->maxX <= dInfoPtr->x) {
@@ -5285,33 +6692,324 @@ TkTextRelayoutWindow(
     if (mask & TK_TEXT_LINE_GEOMETRY) {
 
 	/*
-	 * Set up line metric recalculation.
-	 *
-	 * Avoid the special zero value, since that is used to mark individual
-	 * lines as being out of date.
+	 * Before throwing the old line metrics away, save them keyed by the
+	 * layout they were computed under, and check whether a snapshot
+	 * already exists for the new layout. Toggling an option such as
+	 * -wrap back to a recently used value then restores the cached
+	 * heights instead of re-measuring every line in the widget.
 	 */
 
-	if ((++dInfoPtr->lineMetricUpdateEpoch) == 0) {
-	    dInfoPtr->lineMetricUpdateEpoch++;
+	SaveMetricSnapshot(textPtr);
+
+	if (RestoreMetricSnapshot(textPtr)) {
+	    /*
+	     * The restored heights are complete and valid under the current
+	     * lineMetricUpdateEpoch, so no recalculation pass is needed;
+	     * just cancel any partial long-line calculation in progress.
+	     */
+
+	    dInfoPtr->currentMetricUpdateLine = -1;
+	    dInfoPtr->metricEpoch = -1;
+	} else {
+	    /*
+	     * Set up line metric recalculation.
+	     *
+	     * Avoid the special zero value, since that is used to mark
+	     * individual lines as being out of date.
+	     */
+
+	    if ((++dInfoPtr->lineMetricUpdateEpoch) == 0) {
+		dInfoPtr->lineMetricUpdateEpoch++;
+	    }
+
+	    dInfoPtr->currentMetricUpdateLine = -1;
+
+	    /*
+	     * Also cancel any partial line-height calculations (for
+	     * long-wrapped lines) in progress.
+	     */
+
+	    dInfoPtr->metricEpoch = -1;
+
+	    if (BorrowPeerMetrics(textPtr)) {
+		/*
+		 * Another peer on the same B-tree already holds up-to-date
+		 * heights for exactly this layout; they were copied into our
+		 * pixel reference, so no recalculation pass is needed. This
+		 * is what makes opening a second peer on a large buffer
+		 * cheap: once the new widget is mapped at the same width as
+		 * an existing view, its metrics are seeded wholesale instead
+		 * of being re-measured line by line.
+		 */
+	    } else if (dInfoPtr->lineUpdateTimer == NULL) {
+		textPtr->refCount++;
+		dInfoPtr->lineUpdateTimer = Tcl_CreateTimerHandler(1,
+			AsyncUpdateLineMetrics, textPtr);
+		inSync = 0;
+	    }
+	}
+
+	dInfoPtr->metricsWrapMode = textPtr->wrapMode;
+	dInfoPtr->metricsMaxX = dInfoPtr->maxX;
+
+        GenerateWidgetViewSyncEvent(textPtr, inSync);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * SaveMetricSnapshot --
+ *
+ *	Capture the current per-logical-line pixel heights into one of the
+ *	widget's snapshot slots, keyed by the layout they were computed
+ *	under. Does nothing if the heights are not fully up to date, since a
+ *	partially computed set would poison a later restore.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May allocate or replace a snapshot.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+SaveMetricSnapshot(
+    TkText *textPtr)		/* Widget record for text widget. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    WrapMetricSnapshot *snapPtr = NULL;
+    TkTextLine *linePtr;
+    int numLines, i;
+
+    if ((dInfoPtr->metricsWrapMode < 0) || (dInfoPtr->flags & OUT_OF_SYNC)
+	    || (dInfoPtr->lineUpdateTimer != NULL)) {
+	return;
+    }
+    numLines = TkBTreeNumLines(textPtr->sharedTextPtr->tree, textPtr);
+    if (numLines <= 0) {
+	return;
+    }
+
+    /*
+     * Reuse the slot already holding this layout key if there is one,
+     * otherwise recycle slots round-robin.
+     */
+
+    for (i = 0; i < WRAP_METRIC_SLOTS; i++) {
+	if ((dInfoPtr->metricSnapshot[i].numLines > 0)
+		&& (dInfoPtr->metricSnapshot[i].wrapMode
+			== dInfoPtr->metricsWrapMode)
+		&& (dInfoPtr->metricSnapshot[i].maxX
+			== dInfoPtr->metricsMaxX)) {
+	    snapPtr = &dInfoPtr->metricSnapshot[i];
+	    break;
+	}
+    }
+    if (snapPtr == NULL) {
+	snapPtr = &dInfoPtr->metricSnapshot[dInfoPtr->metricSnapshotNext];
+	dInfoPtr->metricSnapshotNext =
+		(dInfoPtr->metricSnapshotNext + 1) % WRAP_METRIC_SLOTS;
+    }
+    if (snapPtr->heights != NULL) {
+	ckfree(snapPtr->heights);
+    }
+    snapPtr->heights = (int *)ckalloc(numLines * sizeof(int));
+    snapPtr->wrapMode = dInfoPtr->metricsWrapMode;
+    snapPtr->maxX = dInfoPtr->metricsMaxX;
+    snapPtr->stateEpoch = textPtr->sharedTextPtr->stateEpoch;
+
+    linePtr = TkBTreeFindLine(textPtr->sharedTextPtr->tree, textPtr, 0);
+    for (i = 0; (i < numLines) && (linePtr != NULL); i++) {
+	snapPtr->heights[i] = TkBTreeLinePixelCount(textPtr, linePtr);
+	linePtr = TkBTreeNextLine(textPtr, linePtr);
+    }
+    snapPtr->numLines = i;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * RestoreMetricSnapshot --
+ *
+ *	Look for a snapshot matching the widget's new layout (wrap mode and
+ *	width) and, if the content has not changed since it was captured,
+ *	write the cached heights back into the B-tree and mark every line's
+ *	metric as valid.
+ *
+ * Results:
+ *	Returns 1 if the heights were restored, 0 if no usable snapshot
+ *	exists (in which case a full recalculation must be scheduled).
+ *
+ * Side effects:
+ *	Line pixel heights and calculation epochs in the B-tree may be
+ *	updated.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+RestoreMetricSnapshot(
+    TkText *textPtr)		/* Widget record for text widget. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    WrapMetricSnapshot *snapPtr = NULL;
+    TkTextLine *linePtr;
+    int numLines, i;
+
+    numLines = TkBTreeNumLines(textPtr->sharedTextPtr->tree, textPtr);
+    for (i = 0; i < WRAP_METRIC_SLOTS; i++) {
+	if ((dInfoPtr->metricSnapshot[i].numLines == numLines)
+		&& (dInfoPtr->metricSnapshot[i].wrapMode
+			== (int) textPtr->wrapMode)
+		&& (dInfoPtr->metricSnapshot[i].maxX == dInfoPtr->maxX)
+		&& (dInfoPtr->metricSnapshot[i].stateEpoch
+			== textPtr->sharedTextPtr->stateEpoch)) {
+	    snapPtr = &dInfoPtr->metricSnapshot[i];
+	    break;
+	}
+    }
+    if (snapPtr == NULL) {
+	return 0;
+    }
+
+    linePtr = TkBTreeFindLine(textPtr->sharedTextPtr->tree, textPtr, 0);
+    for (i = 0; (i < snapPtr->numLines) && (linePtr != NULL); i++) {
+	if (TkBTreeLinePixelCount(textPtr, linePtr) != snapPtr->heights[i]) {
+	    TkBTreeAdjustPixelHeight(textPtr, linePtr, snapPtr->heights[i],
+		    0);
 	}
+	TkBTreeLinePixelEpochSet(textPtr, linePtr,
+		dInfoPtr->lineMetricUpdateEpoch);
+	linePtr = TkBTreeNextLine(textPtr, linePtr);
+    }
+    return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * BorrowPeerMetrics --
+ *
+ *	Peer text widgets share the B-tree but each keeps its own set of
+ *	per-line pixel heights. When this widget needs a full metric
+ *	recalculation, look for another peer whose heights were computed
+ *	under an identical layout and copy them into this widget's pixel
+ *	reference instead. The copy is a seed, not an alias: subsequent
+ *	edits and invalidations touch each peer's reference independently,
+ *	so the peers diverge again the moment their layouts do.
+ *
+ * Results:
+ *	Returns 1 if a compatible in-sync peer was found and its heights
+ *	were copied, 0 otherwise (in which case the usual asynchronous
+ *	recalculation must be scheduled).
+ *
+ * Side effects:
+ *	Line pixel heights and calculation epochs in the B-tree may be
+ *	updated.
+ *
+ *----------------------------------------------------------------------
+ */
 
-	dInfoPtr->currentMetricUpdateLine = -1;
+static int
+BorrowPeerMetrics(
+    TkText *textPtr)		/* Widget record for text widget. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+    TkText *peerPtr;
+    TkTextLine *linePtr;
+    int numLines, height, i;
+
+    for (peerPtr = textPtr->sharedTextPtr->peers; peerPtr != NULL;
+	    peerPtr = peerPtr->next) {
+	if ((peerPtr == textPtr) || (peerPtr->flags & DESTROYED)
+		|| (peerPtr->dInfoPtr == NULL)
+		|| TkTextPendingsync(peerPtr)
+		|| (peerPtr->dInfoPtr->lineUpdateTimer != NULL)) {
+	    continue;
+	}
 
 	/*
-	 * Also cancel any partial line-height calculations (for long-wrapped
-	 * lines) in progress.
+	 * The peer's heights carry over only if every input to the line
+	 * layout matches: the same slice of the B-tree, the same wrap mode
+	 * and layout width, and the same font, spacing and tab settings.
+	 * Tag styling is shared between peers, with the exception of the
+	 * per-peer "sel" tag; a selection tag that changes geometry makes
+	 * the heights peer-specific, so such peers are skipped.
 	 */
 
-	dInfoPtr->metricEpoch = -1;
+	if ((peerPtr->start != textPtr->start)
+		|| (peerPtr->end != textPtr->end)
+		|| (peerPtr->wrapMode != textPtr->wrapMode)
+		|| (peerPtr->dInfoPtr->maxX != dInfoPtr->maxX)
+		|| (peerPtr->tkfont != textPtr->tkfont)
+		|| (peerPtr->spacing1 != textPtr->spacing1)
+		|| (peerPtr->spacing2 != textPtr->spacing2)
+		|| (peerPtr->spacing3 != textPtr->spacing3)
+		|| (peerPtr->selTagPtr->affectsDisplayGeometry)
+		|| (textPtr->selTagPtr->affectsDisplayGeometry)) {
+	    continue;
+	}
+	if ((peerPtr->tabArrayPtr != NULL)
+		|| (textPtr->tabArrayPtr != NULL)) {
+	    if ((peerPtr->tabOptionPtr == NULL)
+		    || (textPtr->tabOptionPtr == NULL)
+		    || (peerPtr->tabStyle != textPtr->tabStyle)
+		    || (strcmp(Tcl_GetString(peerPtr->tabOptionPtr),
+			    Tcl_GetString(textPtr->tabOptionPtr)) != 0)) {
+		continue;
+	    }
+	}
+	break;
+    }
+    if (peerPtr == NULL) {
+	return 0;
+    }
 
-	if (dInfoPtr->lineUpdateTimer == NULL) {
-	    textPtr->refCount++;
-	    dInfoPtr->lineUpdateTimer = Tcl_CreateTimerHandler(1,
-		    AsyncUpdateLineMetrics, textPtr);
-	    inSync = 0;
+    numLines = TkBTreeNumLines(textPtr->sharedTextPtr->tree, textPtr);
+    linePtr = TkBTreeFindLine(textPtr->sharedTextPtr->tree, textPtr, 0);
+    for (i = 0; (i < numLines) && (linePtr != NULL); i++) {
+	height = TkBTreeLinePixelCount(peerPtr, linePtr);
+	if (TkBTreeLinePixelCount(textPtr, linePtr) != height) {
+	    TkBTreeAdjustPixelHeight(textPtr, linePtr, height, 0);
 	}
+	TkBTreeLinePixelEpochSet(textPtr, linePtr,
+		dInfoPtr->lineMetricUpdateEpoch);
+	linePtr = TkBTreeNextLine(textPtr, linePtr);
+    }
+    return 1;
+}
 
-        GenerateWidgetViewSyncEvent(textPtr, inSync);
+/*
+ *----------------------------------------------------------------------
+ *
+ * DiscardMetricSnapshots --
+ *
+ *	Release all cached wrap-metric snapshots of a widget.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Frees memory.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+DiscardMetricSnapshots(
+    TextDInfo *dInfoPtr)	/* Display info of the widget. */
+{
+    int i;
+
+    for (i = 0; i < WRAP_METRIC_SLOTS; i++) {
+	if (dInfoPtr->metricSnapshot[i].heights != NULL) {
+	    ckfree(dInfoPtr->metricSnapshot[i].heights);
+	    dInfoPtr->metricSnapshot[i].heights = NULL;
+	}
+	dInfoPtr->metricSnapshot[i].numLines = 0;
     }
 }
 
@@ -5940,6 +7638,9 @@ YScrollByPixels(
 {
     TextDInfo *dInfoPtr = textPtr->dInfoPtr;
 
+    if (offset != 0) {
+	SchedulePreLayout(textPtr, offset);
+    }
     if (offset < 0) {
 	/*
 	 * Now we want to measure up this number of pixels from the top of the
@@ -6800,6 +8501,28 @@ GetYView(
 
     dInfoPtr->yScrollFirst = first;
     dInfoPtr->yScrollLast = last;
+    if (textPtr->yScrollbarObj != NULL) {
+	struct TkScrollbar *scrollPtr = TkScrollbarFromObj(NULL,
+		textPtr->tkwin, textPtr->yScrollbarObj);
+
+	if (scrollPtr != NULL) {
+	    /*
+	     * Hand the fractions straight to the attached scrollbar, which
+	     * skips the interpreter evaluation of -yscrollcommand entirely.
+	     */
+
+	    TkScrollbarSetRange(scrollPtr, first, last);
+	    return;
+	}
+
+	/*
+	 * The attached scrollbar has been destroyed; drop the linkage and
+	 * fall back to the -yscrollcommand route.
+	 */
+
+	Tcl_DecrRefCount(textPtr->yScrollbarObj);
+	textPtr->yScrollbarObj = NULL;
+    }
     if (textPtr->yScrollCmd != NULL) {
 	char buf1[TCL_DOUBLE_SPACE+1];
 	char buf2[TCL_DOUBLE_SPACE+1];
@@ -6823,6 +8546,43 @@ GetYView(
     }
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkTextUpdateYScrollbar --
+ *
+ *	Force the current vertical view to be recomputed and delivered to
+ *	whatever is listening for it (a directly attached scrollbar or the
+ *	-yscrollcommand script). Called when a scrollbar is first attached so
+ *	that it shows the right slider immediately.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	See 'GetYView'. In particular the scrollbar position and size may be
+ *	changed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkTextUpdateYScrollbar(
+    TkText *textPtr)		/* Information about widget. */
+{
+    TextDInfo *dInfoPtr = textPtr->dInfoPtr;
+
+    /*
+     * Invalidate the cached fractions so that GetYView actually reports
+     * instead of deciding that nothing has changed.
+     */
+
+    dInfoPtr->yScrollFirst = dInfoPtr->yScrollLast = -1;
+    if (textPtr->tkwin != NULL) {
+	GetYView(textPtr->interp, textPtr, 1);
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -7601,7 +9361,7 @@ ElideMeasureProc(
 
 int
 TkTextCharLayoutProc(
-    TCL_UNUSED(TkText *),	/* Text widget being layed out. */
+    TkText *textPtr,		/* Text widget being layed out. */
     TCL_UNUSED(TkTextIndex *),	/* Index of first character to lay out
 				 * (corresponds to segPtr and offset). */
     TkTextSegment *segPtr,	/* Segment being layed out. */
@@ -7656,7 +9416,7 @@ TkTextCharLayoutProc(
 #ifdef TK_LAYOUT_WITH_BASE_CHUNKS
     if (baseCharChunkPtr == NULL) {
 	baseCharChunkPtr = chunkPtr;
-	bciPtr = (BaseCharInfo *)ckalloc(sizeof(BaseCharInfo));
+	bciPtr = BaseCharInfoAlloc(textPtr->dInfoPtr);
 	baseString = &bciPtr->baseChars;
 	Tcl_DStringInit(baseString);
 	bciPtr->width = 0;
@@ -7664,7 +9424,7 @@ TkTextCharLayoutProc(
 	ciPtr = &bciPtr->ci;
     } else {
 	bciPtr = (BaseCharInfo *)baseCharChunkPtr->clientData;
-	ciPtr = (CharInfo *)ckalloc(sizeof(CharInfo));
+	ciPtr = CharInfoAlloc(textPtr->dInfoPtr);
 	baseString = &bciPtr->baseChars;
     }
 
@@ -7739,10 +9499,11 @@ TkTextCharLayoutProc(
 	    if (chunkPtr == baseCharChunkPtr) {
 		baseCharChunkPtr = NULL;
 		Tcl_DStringFree(baseString);
+		BaseCharInfoFree(textPtr->dInfoPtr, bciPtr);
 	    } else {
 		Tcl_DStringSetLength(baseString,lineOffset);
+		CharInfoFree(textPtr->dInfoPtr, ciPtr);
 	    }
-	    ckfree(ciPtr);
 #endif /* TK_LAYOUT_WITH_BASE_CHUNKS */
 	    return 0;
 	}
@@ -7768,7 +9529,7 @@ TkTextCharLayoutProc(
     chunkPtr->breakIndex = -1;
 
 #if !defined(TK_LAYOUT_WITH_BASE_CHUNKS)
-    ciPtr = (CharInfo *)ckalloc(offsetof(CharInfo, chars) + 1 + bytesThatFit);
+    ciPtr = CharInfoAlloc(textPtr->dInfoPtr, bytesThatFit + 1);
     chunkPtr->clientData = ciPtr;
     memcpy(ciPtr->chars, p, bytesThatFit);
 #endif /* TK_LAYOUT_WITH_BASE_CHUNKS */
@@ -8118,14 +9879,16 @@ CharDisplayProc(
 
 static void
 CharUndisplayProc(
-    TCL_UNUSED(TkText *),	/* Overall information about text widget. */
+    TkText *textPtr,		/* Overall information about text widget. */
     TkTextDispChunk *chunkPtr)	/* Chunk that is about to be freed. */
 {
     CharInfo *ciPtr = (CharInfo *)chunkPtr->clientData;
 
     if (ciPtr) {
 #ifdef TK_LAYOUT_WITH_BASE_CHUNKS
-	if (chunkPtr == ciPtr->baseChunkPtr) {
+	int isBaseChunk = (chunkPtr == ciPtr->baseChunkPtr);
+
+	if (isBaseChunk) {
 	    /*
 	     * Basechunks are undisplayed first, when DLines are freed or
 	     * partially freed, so this makes sure we don't access their data
@@ -8146,9 +9909,15 @@ CharUndisplayProc(
 	ciPtr->baseChunkPtr = NULL;
 	ciPtr->chars = NULL;
 	ciPtr->numBytes = 0;
-#endif /* TK_LAYOUT_WITH_BASE_CHUNKS */
 
-	ckfree(ciPtr);
+	if (isBaseChunk) {
+	    BaseCharInfoFree(textPtr->dInfoPtr, (BaseCharInfo *)ciPtr);
+	} else {
+	    CharInfoFree(textPtr->dInfoPtr, ciPtr);
+	}
+#else /* !TK_LAYOUT_WITH_BASE_CHUNKS */
+	CharInfoFree(textPtr->dInfoPtr, ciPtr);
+#endif /* TK_LAYOUT_WITH_BASE_CHUNKS */
 	chunkPtr->clientData = NULL;
     }
 }
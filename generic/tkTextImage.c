@@ -49,6 +49,8 @@ static int		EmbImageLayoutProc(TkText *textPtr,
 static void		EmbImageProc(ClientData clientData, int x, int y,
 			    int width, int height, int imageWidth,
 			    int imageHeight);
+static void		EmbImageSize(TkTextEmbImage *eiPtr, int *widthPtr,
+			    int *heightPtr);
 
 /*
  * The following structure declares the "embedded image" segment type.
@@ -85,6 +87,8 @@ static const Tk_OptionSpec optionSpecs[] = {
     {TK_OPTION_STRING_TABLE, "-align", NULL, NULL,
 	"center", TCL_INDEX_NONE, offsetof(TkTextEmbImage, align),
 	0, alignStrings, 0},
+    {TK_OPTION_PIXELS, "-height", NULL, NULL,
+	"0", TCL_INDEX_NONE, offsetof(TkTextEmbImage, height), 0, 0, 0},
     {TK_OPTION_PIXELS, "-padx", NULL, NULL,
 	"0", TCL_INDEX_NONE, offsetof(TkTextEmbImage, padX), 0, 0, 0},
     {TK_OPTION_PIXELS, "-pady", NULL, NULL,
@@ -95,6 +99,8 @@ static const Tk_OptionSpec optionSpecs[] = {
     {TK_OPTION_STRING, "-name", NULL, NULL,
 	NULL, TCL_INDEX_NONE, offsetof(TkTextEmbImage, imageName),
 	TK_OPTION_NULL_OK, 0, 0},
+    {TK_OPTION_PIXELS, "-width", NULL, NULL,
+	"0", TCL_INDEX_NONE, offsetof(TkTextEmbImage, width), 0, 0, 0},
     {TK_OPTION_END, NULL, NULL, NULL, NULL, 0, 0, 0, 0, 0}
 };
 
@@ -253,6 +259,7 @@ TkTextImageCmd(
 	eiPtr->body.ei.image = NULL;
 	eiPtr->body.ei.align = ALIGN_CENTER;
 	eiPtr->body.ei.padX = eiPtr->body.ei.padY = 0;
+	eiPtr->body.ei.width = eiPtr->body.ei.height = 0;
 	eiPtr->body.ei.chunkCount = 0;
 	eiPtr->body.ei.optionTable = Tk_CreateOptionTable(interp, optionSpecs);
 
@@ -558,14 +565,13 @@ EmbImageLayoutProc(
     }
 
     /*
-     * See if there's room for this image on this line.
+     * See if there's room for this image on this line. If a placeholder size
+     * has been configured, it is reserved whether or not the image is there
+     * yet, so that an image arriving later doesn't change the layout.
      */
 
-    if (eiPtr->body.ei.image == NULL) {
-	width = 0;
-	height = 0;
-    } else {
-	Tk_SizeOfImage(eiPtr->body.ei.image, &width, &height);
+    EmbImageSize(&eiPtr->body.ei, &width, &height);
+    if ((eiPtr->body.ei.image != NULL) || (width > 0) || (height > 0)) {
 	width += 2*eiPtr->body.ei.padX;
 	height += 2*eiPtr->body.ei.padY;
     }
@@ -600,6 +606,45 @@ EmbImageLayoutProc(
     return 1;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * EmbImageSize --
+ *
+ *	Compute the size of the area that an embedded image segment occupies,
+ *	not counting padding: the configured placeholder dimensions if they
+ *	are set, otherwise the image's own dimensions.
+ *
+ * Results:
+ *	*widthPtr and *heightPtr are filled in with the segment's dimensions
+ *	in pixels (0 if there is no image and no configured size).
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+EmbImageSize(
+    TkTextEmbImage *eiPtr,	/* Embedded image whose size is wanted. */
+    int *widthPtr,		/* Gets filled in with the width. */
+    int *heightPtr)		/* Gets filled in with the height. */
+{
+    if (eiPtr->image != NULL) {
+	Tk_SizeOfImage(eiPtr->image, widthPtr, heightPtr);
+    } else {
+	*widthPtr = 0;
+	*heightPtr = 0;
+    }
+    if (eiPtr->width > 0) {
+	*widthPtr = eiPtr->width;
+    }
+    if (eiPtr->height > 0) {
+	*heightPtr = eiPtr->height;
+    }
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -668,7 +713,7 @@ EmbImageDisplayProc(
 				 * corresponds to y. */
 {
     TkTextSegment *eiPtr = (TkTextSegment *)chunkPtr->clientData;
-    int lineX, imageX, imageY, width, height;
+    int lineX, imageX, imageY, width, height, imageWidth, imageHeight;
     Tk_Image image;
 
     image = eiPtr->body.ei.image;
@@ -688,7 +733,21 @@ EmbImageDisplayProc(
 	    &imageY, &width, &height);
     imageX = lineX - chunkPtr->x + x;
 
-    Tk_RedrawImage(image, 0, 0, width, height, dst, imageX, imageY);
+    /*
+     * If a placeholder size was configured, the image itself may be smaller
+     * or larger than the reserved area (e.g. while it is still being
+     * loaded); center it in the area and clip it to the area's bounds.
+     */
+
+    Tk_SizeOfImage(image, &imageWidth, &imageHeight);
+    if (imageWidth > width) {
+	imageWidth = width;
+    }
+    if (imageHeight > height) {
+	imageHeight = height;
+    }
+    Tk_RedrawImage(image, 0, 0, imageWidth, imageHeight, dst,
+	    imageX + (width - imageWidth)/2, imageY + (height - imageHeight)/2);
 }
 
 /*
@@ -732,15 +791,8 @@ EmbImageBboxProc(
 				 * pixels. */
 {
     TkTextSegment *eiPtr = (TkTextSegment *)chunkPtr->clientData;
-    Tk_Image image;
 
-    image = eiPtr->body.ei.image;
-    if (image != NULL) {
-	Tk_SizeOfImage(image, widthPtr, heightPtr);
-    } else {
-	*widthPtr = 0;
-	*heightPtr = 0;
-    }
+    EmbImageSize(&eiPtr->body.ei, widthPtr, heightPtr);
 
     *xPtr = chunkPtr->x + eiPtr->body.ei.padX;
 
@@ -841,6 +893,18 @@ EmbImageProc(
     index.byteIndex = TkTextSegToOffset(eiPtr, eiPtr->body.ei.linePtr);
     TkTextChanged(eiPtr->body.ei.sharedTextPtr, NULL, &index, &index);
 
+    /*
+     * If the segment's geometry is fully determined by configured
+     * placeholder dimensions, a change to the image can only alter pixels,
+     * not layout, so the (expensive) recomputation of line metrics can be
+     * skipped. This keeps scrolling smooth while images stream in
+     * asynchronously.
+     */
+
+    if ((eiPtr->body.ei.width > 0) && (eiPtr->body.ei.height > 0)) {
+	return;
+    }
+
     /*
      * It's probably not true that all image changes can change the line
      * height, so we could be more efficient here and only call this when
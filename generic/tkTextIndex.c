@@ -620,14 +620,18 @@ TkTextSegToOffset(
  *
  * TkTextGetObjIndex --
  *
- *	Simpler wrapper around the string based function, but could be
- *	enhanced with a new object type in the future.
+ *	Return the index described by the given object, using and maintaining
+ *	the "textindex" internal rep of the object so that repeated use of the
+ *	same index object skips string parsing and line lookup entirely. The
+ *	cached rep is validated against the widget's state epoch, which is
+ *	incremented on every insertion or deletion.
  *
  * Results:
  *	see TkTextGetIndex
  *
  * Side effects:
- *	None.
+ *	The object may be converted to the "textindex" type, losing any
+ *	previous internal rep.
  *
  *---------------------------------------------------------------------------
  */
@@ -640,8 +644,43 @@ TkTextGetObjIndex(
 				 * position. */
     TkTextIndex *indexPtr)	/* Index structure to fill in. */
 {
-    return GetIndex(interp, NULL, textPtr, Tcl_GetString(idxObj), indexPtr,
-	    NULL);
+    int cache;
+
+    if (idxObj->typePtr == &tkTextIndexType) {
+	TkTextIndex *cachePtr = GET_TEXTINDEX(idxObj);
+
+	if ((TkSizeT) GET_INDEXEPOCH(idxObj)
+		== textPtr->sharedTextPtr->stateEpoch
+		&& cachePtr->textPtr == textPtr) {
+	    *indexPtr = *cachePtr;
+	    return TCL_OK;
+	}
+    }
+
+    if (GetIndex(interp, NULL, textPtr, Tcl_GetString(idxObj), indexPtr,
+	    &cache) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    /*
+     * Cache the parsed index in the object if its meaning is stable to
+     * everything except insertions and deletions (which we track via the
+     * state epoch). Indices based on marks, tags or screen positions are
+     * not cacheable; for those, leave the object alone.
+     */
+
+    if (cache) {
+	if (idxObj->typePtr != NULL) {
+	    if (idxObj->bytes == NULL) {
+		idxObj->typePtr->updateStringProc(idxObj);
+	    }
+	    if (idxObj->typePtr->freeIntRepProc != NULL) {
+		idxObj->typePtr->freeIntRepProc(idxObj);
+	    }
+	}
+	MakeObjIndex(textPtr, idxObj, indexPtr);
+    }
+    return TCL_OK;
 }
 
 /*
@@ -145,13 +145,14 @@ TkTextTagCmd(
 				 * objv[1] is "tag". */
 {
     static const char *const tagOptionStrings[] = {
-	"add", "bind", "cget", "configure", "delete", "lower", "names",
-	"nextrange", "prevrange", "raise", "ranges", "remove", NULL
+	"add", "addlist", "bind", "cget", "configure", "delete", "lower",
+	"names", "nextrange", "prevrange", "raise", "ranges", "remove",
+	"removeall", "removelist", NULL
     };
     enum tagOptions {
-	TAG_ADD, TAG_BIND, TAG_CGET, TAG_CONFIGURE, TAG_DELETE, TAG_LOWER,
-	TAG_NAMES, TAG_NEXTRANGE, TAG_PREVRANGE, TAG_RAISE, TAG_RANGES,
-	TAG_REMOVE
+	TAG_ADD, TAG_ADDLIST, TAG_BIND, TAG_CGET, TAG_CONFIGURE, TAG_DELETE,
+	TAG_LOWER, TAG_NAMES, TAG_NEXTRANGE, TAG_PREVRANGE, TAG_RAISE,
+	TAG_RANGES, TAG_REMOVE, TAG_REMOVEALL, TAG_REMOVELIST
     };
     int optionIndex, i;
     TkTextTag *tagPtr;
@@ -255,6 +256,231 @@ TkTextTagCmd(
 	}
 	break;
     }
+    case TAG_ADDLIST:
+    case TAG_REMOVELIST: {
+	int addTag, rangeObjc, numRanges, anyChanges;
+	Tcl_Obj **rangeObjv;
+	TkTextIndex *ranges;
+	TkTextIndex hull1, hull2;
+
+	addTag = (((enum tagOptions) optionIndex) == TAG_ADDLIST);
+	if (objc != 5) {
+	    Tcl_WrongNumArgs(interp, 3, objv, "tagName rangeList");
+	    return TCL_ERROR;
+	}
+	if (Tcl_ListObjGetElements(interp, objv[4], &rangeObjc,
+		&rangeObjv) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (rangeObjc % 2 != 0) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "range list must have an even number of indices", -1));
+	    Tcl_SetErrorCode(interp, "TK", "TEXT", "RANGE_LIST", NULL);
+	    return TCL_ERROR;
+	}
+	tagPtr = TkTextCreateTag(textPtr, Tcl_GetString(objv[3]), NULL);
+	if (rangeObjc == 0) {
+	    return TCL_OK;
+	}
+	if (tagPtr->elide) {
+	    /*
+	     * See the comment for the "add"/"remove" forms above.
+	     */
+
+	    textPtr->sharedTextPtr->stateEpoch++;
+	}
+
+	/*
+	 * Parse every range up front, dropping empty and reversed ones, so
+	 * that a bad index leaves the widget untouched and the surviving
+	 * ranges can be merged into one display invalidation below.
+	 */
+
+	ranges = (TkTextIndex *)ckalloc(
+		rangeObjc * sizeof(TkTextIndex));
+	numRanges = 0;
+	for (i = 0; i < rangeObjc; i += 2) {
+	    if ((TkTextGetObjIndex(interp, textPtr, rangeObjv[i],
+		    &index1) != TCL_OK)
+		    || (TkTextGetObjIndex(interp, textPtr, rangeObjv[i+1],
+		    &index2) != TCL_OK)) {
+		ckfree(ranges);
+		return TCL_ERROR;
+	    }
+	    if (TkTextIndexCmp(&index1, &index2) >= 0) {
+		continue;
+	    }
+	    ranges[2*numRanges] = index1;
+	    ranges[2*numRanges + 1] = index2;
+	    numRanges++;
+	}
+	if (numRanges == 0) {
+	    ckfree(ranges);
+	    return TCL_OK;
+	}
+
+	/*
+	 * Invalidate the display once, over the hull of all the ranges,
+	 * instead of once per range: with many disjoint ranges the repeated
+	 * style-cache flushes and display-line scans dominate the cost of
+	 * tagging.
+	 */
+
+	if (tagPtr->affectsDisplay) {
+	    hull1 = ranges[0];
+	    hull2 = ranges[1];
+	    for (i = 1; i < numRanges; i++) {
+		if (TkTextIndexCmp(&ranges[2*i], &hull1) < 0) {
+		    hull1 = ranges[2*i];
+		}
+		if (TkTextIndexCmp(&ranges[2*i + 1], &hull2) > 0) {
+		    hull2 = ranges[2*i + 1];
+		}
+	    }
+	    TkTextRedrawTag(textPtr->sharedTextPtr, NULL, &hull1, &hull2,
+		    tagPtr, !addTag);
+	} else {
+	    TkTextEventuallyRepick(textPtr);
+	}
+
+	anyChanges = 0;
+	for (i = 0; i < numRanges; i++) {
+	    if (TkBTreeTag(&ranges[2*i], &ranges[2*i + 1], tagPtr, addTag)) {
+		anyChanges = 1;
+	    }
+	}
+	ckfree(ranges);
+
+	/*
+	 * The selection handling mirrors the "add"/"remove" forms, but runs
+	 * once per command rather than once per range.
+	 */
+
+	if (anyChanges && (tagPtr == textPtr->selTagPtr)) {
+	    TkTextSelectionEvent(textPtr);
+
+	    if (addTag && textPtr->exportSelection
+		    && (!Tcl_IsSafe(textPtr->interp))
+		    && !(textPtr->flags & GOT_SELECTION)) {
+		Tk_OwnSelection(textPtr->tkwin, XA_PRIMARY,
+			TkTextLostSelection, textPtr);
+		textPtr->flags |= GOT_SELECTION;
+	    }
+	    textPtr->abortSelections = 1;
+	}
+	break;
+    }
+    case TAG_REMOVEALL: {
+	TkTextTag **tags, **activeTags;
+	TkTextSearch tSearch;
+	TkText *tPtr;
+	int numTags, numActive, j, found;
+	int anyDisplay = 0, anyGeometry = 0, anyElide = 0;
+
+	if ((objc != 4) && (objc != 5)) {
+	    Tcl_WrongNumArgs(interp, 3, objv, "index1 ?index2?");
+	    return TCL_ERROR;
+	}
+	if (TkTextGetObjIndex(interp, textPtr, objv[3], &index1) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (objc == 5) {
+	    if (TkTextGetObjIndex(interp, textPtr, objv[4],
+		    &index2) != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	} else {
+	    index2 = index1;
+	    TkTextIndexForwChars(NULL, &index2, 1, &index2, COUNT_INDICES);
+	}
+	if (TkTextIndexCmp(&index1, &index2) >= 0) {
+	    return TCL_OK;
+	}
+
+	/*
+	 * Collect the distinct tags present anywhere in the range: those
+	 * already active at its start plus every tag with a toggle inside
+	 * it. Tags private to a peer widget - i.e. the "sel" tags - are
+	 * deliberately left alone: the selection is transient interface
+	 * state rather than document markup, and an explicit [tag remove
+	 * sel] remains available.
+	 */
+
+	numTags = 0;
+	tags = (TkTextTag **)ckalloc(
+		textPtr->sharedTextPtr->numTags * sizeof(TkTextTag *));
+	activeTags = TkBTreeGetTags(&index1, textPtr, &numActive);
+	for (j = 0; j < numActive; j++) {
+	    if (activeTags[j]->textPtr == NULL) {
+		tags[numTags++] = activeTags[j];
+	    }
+	}
+	if (activeTags != NULL) {
+	    ckfree(activeTags);
+	}
+	TkBTreeStartSearch(&index1, &index2, NULL, &tSearch);
+	while (TkBTreeNextTag(&tSearch)) {
+	    if (tSearch.tagPtr->textPtr != NULL) {
+		continue;
+	    }
+	    found = 0;
+	    for (j = 0; j < numTags; j++) {
+		if (tags[j] == tSearch.tagPtr) {
+		    found = 1;
+		    break;
+		}
+	    }
+	    if (!found) {
+		tags[numTags++] = tSearch.tagPtr;
+	    }
+	}
+	if (numTags == 0) {
+	    ckfree(tags);
+	    return TCL_OK;
+	}
+
+	for (j = 0; j < numTags; j++) {
+	    anyDisplay |= tags[j]->affectsDisplay;
+	    anyGeometry |= tags[j]->affectsDisplayGeometry;
+	    anyElide |= tags[j]->elide;
+	}
+	if (anyElide) {
+	    /*
+	     * See the comment for the "add"/"remove" forms above.
+	     */
+
+	    textPtr->sharedTextPtr->stateEpoch++;
+	}
+
+	/*
+	 * Invalidate the display once for the whole range instead of once
+	 * per tag (which is what repeated [tag remove] calls would cost):
+	 * TkTextChanged relayouts everything in the range unconditionally,
+	 * which is a superset of what any single tag requires.
+	 */
+
+	if (anyDisplay) {
+	    TkTextChanged(textPtr->sharedTextPtr, NULL, &index1, &index2);
+	    for (tPtr = textPtr->sharedTextPtr->peers; tPtr != NULL;
+		    tPtr = tPtr->next) {
+		TkTextFlushStyleCache(tPtr);
+	    }
+	    if (anyGeometry) {
+		TkTextInvalidateLineMetrics(textPtr->sharedTextPtr, NULL,
+			index1.linePtr,
+			TkBTreeLinesTo(NULL, index2.linePtr)
+			- TkBTreeLinesTo(NULL, index1.linePtr),
+			TK_TEXT_INVALIDATE_ONLY);
+	    }
+	}
+	TkTextEventuallyRepick(textPtr);
+
+	for (j = 0; j < numTags; j++) {
+	    TkBTreeTag(&index1, &index2, tags[j], 0);
+	}
+	ckfree(tags);
+	break;
+    }
     case TAG_BIND:
 	if ((objc < 4) || (objc > 6)) {
 	    Tcl_WrongNumArgs(interp, 3, objv, "tagName ?sequence? ?command?");
@@ -373,6 +599,7 @@ TkTextTagCmd(
 	    return TCL_OK;
 	} else {
 	    int result = TCL_OK;
+	    int wasElided = (tagPtr->elideString != NULL);
 
 	    if (Tk_SetOptions(interp, tagPtr, tagPtr->optionTable,
 		    objc-4, objv+4, textPtr->tkwin, NULL, NULL) != TCL_OK) {
@@ -488,6 +715,13 @@ TkTextTagCmd(
 		 */
 
 		textPtr->sharedTextPtr->stateEpoch++;
+	    } else if (wasElided) {
+		/*
+		 * The -elide option was unset.  The epoch is unchanged, but
+		 * the elide state cache still counts this tag's toggles.
+		 */
+
+		textPtr->sharedTextPtr->elideCacheLinePtr = NULL;
 	    }
 
 	    /*
@@ -1219,6 +1453,25 @@ TkTextFreeTag(
     TkTextTag *tagPtr)	/* Tag being deleted. */
 {
     int i;
+    TkText *peerPtr;
+
+    /*
+     * The style caches of all the peers may hold pointers to this tag, so
+     * flush them before the tag goes away. A widget in the middle of being
+     * destroyed has already been removed from the peer list (and has already
+     * freed its display information).
+     */
+
+    for (peerPtr = textPtr->sharedTextPtr->peers; peerPtr != NULL;
+	    peerPtr = peerPtr->next) {
+	TkTextFlushStyleCache(peerPtr);
+    }
+
+    /*
+     * The elide state cache may also hold a pointer to this tag.
+     */
+
+    textPtr->sharedTextPtr->elideCacheLinePtr = NULL;
 
     /*
      * Let Tk do most of the hard work for us.
@@ -1392,6 +1645,13 @@ ChangeTagPriority(
     if (prio == tagPtr->priority) {
 	return;
     }
+
+    /*
+     * The elide state cache is indexed by tag priority, so it is stale now.
+     */
+
+    textPtr->sharedTextPtr->elideCacheLinePtr = NULL;
+
     if (prio < tagPtr->priority) {
 	low = prio;
 	high = tagPtr->priority-1;
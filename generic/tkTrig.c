@@ -919,22 +919,41 @@ TkBezierScreenPoints(
     XPoint *xPointPtr)	/* Where to put new points. */
 {
     int i;
-    double u, u2, u3, t, t2, t3;
-
-    for (i = 1; i <= numSteps; i++, xPointPtr++) {
-	t = ((double) i)/((double) numSteps);
-	t2 = t*t;
-	t3 = t2*t;
-	u = 1.0 - t;
-	u2 = u*u;
-	u3 = u2*u;
-	Tk_CanvasDrawableCoords(canvas,
-		(control[0]*u3 + 3.0 * (control[2]*t*u2 + control[4]*t2*u)
-		    + control[6]*t3),
-		(control[1]*u3 + 3.0 * (control[3]*t*u2 + control[5]*t2*u)
-		    + control[7]*t3),
-		&xPointPtr->x, &xPointPtr->y);
+    double h, ax, ay, bx, by, cx, cy;
+    double x, y, dx1, dy1, dx2, dy2, dx3, dy3;
+
+    /*
+     * Convert the control points to polynomial coefficients and walk the
+     * curve by forward differencing: once the difference terms have been
+     * primed, each step costs three additions per coordinate instead of a
+     * full Bernstein evaluation. The final point is emitted directly from
+     * the last control point so that adjoining segments still share their
+     * endpoints exactly.
+     */
+
+    h = 1.0 / (double) numSteps;
+    ax = control[6] - control[0] + 3.0*(control[2] - control[4]);
+    ay = control[7] - control[1] + 3.0*(control[3] - control[5]);
+    bx = 3.0*(control[0] - 2.0*control[2] + control[4]);
+    by = 3.0*(control[1] - 2.0*control[3] + control[5]);
+    cx = 3.0*(control[2] - control[0]);
+    cy = 3.0*(control[3] - control[1]);
+    x = control[0];
+    y = control[1];
+    dx1 = ((ax*h + bx)*h + cx)*h;
+    dy1 = ((ay*h + by)*h + cy)*h;
+    dx3 = 6.0*ax*h*h*h;
+    dy3 = 6.0*ay*h*h*h;
+    dx2 = dx3 + 2.0*bx*h*h;
+    dy2 = dy3 + 2.0*by*h*h;
+
+    for (i = 1; i < numSteps; i++, xPointPtr++) {
+	x += dx1; dx1 += dx2; dx2 += dx3;
+	y += dy1; dy1 += dy2; dy2 += dy3;
+	Tk_CanvasDrawableCoords(canvas, x, y, &xPointPtr->x, &xPointPtr->y);
     }
+    Tk_CanvasDrawableCoords(canvas, control[6], control[7],
+	    &xPointPtr->x, &xPointPtr->y);
 }
 
 /*
@@ -965,20 +984,40 @@ TkBezierPoints(
     double *coordPtr)	/* Where to put new points. */
 {
     int i;
-    double u, u2, u3, t, t2, t3;
-
-    for (i = 1; i <= numSteps; i++, coordPtr += 2) {
-	t = ((double) i)/((double) numSteps);
-	t2 = t*t;
-	t3 = t2*t;
-	u = 1.0 - t;
-	u2 = u*u;
-	u3 = u2*u;
-	coordPtr[0] = control[0]*u3
-		+ 3.0 * (control[2]*t*u2 + control[4]*t2*u) + control[6]*t3;
-	coordPtr[1] = control[1]*u3
-		+ 3.0 * (control[3]*t*u2 + control[5]*t2*u) + control[7]*t3;
+    double h, ax, ay, bx, by, cx, cy;
+    double x, y, dx1, dy1, dx2, dy2, dx3, dy3;
+
+    /*
+     * Same forward-differencing scheme as TkBezierScreenPoints above: prime
+     * the difference terms once, then generate each curve point with three
+     * additions per coordinate. The last point is copied straight from the
+     * final control point so that segment endpoints match exactly.
+     */
+
+    h = 1.0 / (double) numSteps;
+    ax = control[6] - control[0] + 3.0*(control[2] - control[4]);
+    ay = control[7] - control[1] + 3.0*(control[3] - control[5]);
+    bx = 3.0*(control[0] - 2.0*control[2] + control[4]);
+    by = 3.0*(control[1] - 2.0*control[3] + control[5]);
+    cx = 3.0*(control[2] - control[0]);
+    cy = 3.0*(control[3] - control[1]);
+    x = control[0];
+    y = control[1];
+    dx1 = ((ax*h + bx)*h + cx)*h;
+    dy1 = ((ay*h + by)*h + cy)*h;
+    dx3 = 6.0*ax*h*h*h;
+    dy3 = 6.0*ay*h*h*h;
+    dx2 = dx3 + 2.0*bx*h*h;
+    dy2 = dy3 + 2.0*by*h*h;
+
+    for (i = 1; i < numSteps; i++, coordPtr += 2) {
+	x += dx1; dx1 += dx2; dx2 += dx3;
+	y += dy1; dy1 += dy2; dy2 += dy3;
+	coordPtr[0] = x;
+	coordPtr[1] = y;
     }
+    coordPtr[0] = control[6];
+    coordPtr[1] = control[7];
 }
 
 /*
@@ -1162,6 +1201,112 @@ TkMakeBezierCurve(
     return outputPoints;
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * TkMakeBezierCurveSegments --
+ *
+ *	Generate the curve points for a trailing range of the spline units of
+ *	an open curve, exactly as TkMakeBezierCurve would for the same input.
+ *	Spline unit i (2 <= i < numPoints) is the piece of the curve
+ *	generated from input points i-2, i-1 and i; the initial copy of the
+ *	first input point is not a unit and is not produced here. This lets
+ *	callers that cache the flattened curve recompute only the units
+ *	affected by appended input points instead of the whole curve.
+ *
+ * Results:
+ *	Fills in dblPoints with the points for units firstUnit through
+ *	numPoints-1 and returns the number of points generated. If
+ *	lastSizePtr isn't NULL, *lastSizePtr is set to the number of those
+ *	points that came from the final unit; that unit uses the special
+ *	end-of-curve control points and must be regenerated if more input
+ *	points are appended later.
+ *
+ * Side effects:
+ *	None.
+ *
+ *--------------------------------------------------------------
+ */
+
+int
+TkMakeBezierCurveSegments(
+    double *pointPtr,		/* Array of input coordinates: x0, y0, x1, y1,
+				 * etc. The first and last points must not
+				 * coincide (i.e. the curve must be open). */
+    int numPoints,		/* Number of points at pointPtr. */
+    int firstUnit,		/* Index of first spline unit to generate;
+				 * must lie in the range [2, numPoints-1]. */
+    int numSteps,		/* Number of steps to use for each spline
+				 * segment (determines smoothness of
+				 * curve). */
+    double dblPoints[],		/* Array of points to fill in as doubles, in
+				 * the form x0, y0, x1, y1, .... Caller must
+				 * make sure that this array has enough
+				 * space. */
+    int *lastSizePtr)		/* If non-NULL, filled in with the number of
+				 * output points generated by the final
+				 * spline unit. */
+{
+    int outputPoints, unitPoints, i;
+    double control[8];
+
+    outputPoints = 0;
+    unitPoints = 0;
+    for (i = firstUnit, pointPtr += 2*(firstUnit-2); i < numPoints;
+	    i++, pointPtr += 2) {
+	/*
+	 * Set up the control points, distinguishing the first and last
+	 * splines of the curve just as TkMakeBezierCurve does.
+	 */
+
+	if (i == 2) {
+	    control[0] = pointPtr[0];
+	    control[1] = pointPtr[1];
+	    control[2] = 0.333*pointPtr[0] + 0.667*pointPtr[2];
+	    control[3] = 0.333*pointPtr[1] + 0.667*pointPtr[3];
+	} else {
+	    control[0] = 0.5*pointPtr[0] + 0.5*pointPtr[2];
+	    control[1] = 0.5*pointPtr[1] + 0.5*pointPtr[3];
+	    control[2] = 0.167*pointPtr[0] + 0.833*pointPtr[2];
+	    control[3] = 0.167*pointPtr[1] + 0.833*pointPtr[3];
+	}
+	if (i == (numPoints-1)) {
+	    control[4] = .667*pointPtr[2] + .333*pointPtr[4];
+	    control[5] = .667*pointPtr[3] + .333*pointPtr[5];
+	    control[6] = pointPtr[4];
+	    control[7] = pointPtr[5];
+	} else {
+	    control[4] = .833*pointPtr[2] + .167*pointPtr[4];
+	    control[5] = .833*pointPtr[3] + .167*pointPtr[5];
+	    control[6] = 0.5*pointPtr[2] + 0.5*pointPtr[4];
+	    control[7] = 0.5*pointPtr[3] + 0.5*pointPtr[5];
+	}
+
+	/*
+	 * Degenerate units with coincident points produce a single
+	 * straight-line point, again matching TkMakeBezierCurve.
+	 */
+
+	if (((pointPtr[0] == pointPtr[2]) && (pointPtr[1] == pointPtr[3]))
+		|| ((pointPtr[2] == pointPtr[4])
+		&& (pointPtr[3] == pointPtr[5]))) {
+	    dblPoints[0] = control[6];
+	    dblPoints[1] = control[7];
+	    dblPoints += 2;
+	    unitPoints = 1;
+	} else {
+	    TkBezierPoints(control, numSteps, dblPoints);
+	    dblPoints += 2*numSteps;
+	    unitPoints = numSteps;
+	}
+	outputPoints += unitPoints;
+    }
+    if (lastSizePtr != NULL) {
+	*lastSizePtr = unitPoints;
+    }
+    return outputPoints;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -15,6 +15,9 @@
 
 static int		EvaluateActionList(Tcl_Interp *interp,
 			    TkUndoSubAtom *action);
+static TkSizeT		UndoFreeAtomChain(TkUndoAtom *elem, int *sepCountPtr);
+static TkSizeT		UndoObjSize(Tcl_Obj *objPtr);
+static void		UndoTrimToSize(TkUndoRedoStack *stack);
 
 /*
  *----------------------------------------------------------------------
@@ -96,6 +99,7 @@ TkUndoInsertSeparator(
     if (*stack!=NULL && (*stack)->type!=TK_UNDO_SEPARATOR) {
 	separator = (TkUndoAtom *)ckalloc(sizeof(TkUndoAtom));
 	separator->type = TK_UNDO_SEPARATOR;
+	separator->size = 0;
 	TkUndoPushStack(stack,separator);
 	return 1;
     }
@@ -122,36 +126,7 @@ void
 TkUndoClearStack(
     TkUndoAtom **stack)		/* An Undo or Redo stack */
 {
-    TkUndoAtom *elem;
-
-    while ((elem = TkUndoPopStack(stack)) != NULL) {
-	if (elem->type != TK_UNDO_SEPARATOR) {
-	    TkUndoSubAtom *sub;
-
-	    sub = elem->apply;
-	    while (sub != NULL) {
-		TkUndoSubAtom *next = sub->next;
-
-		if (sub->action != NULL) {
-		    Tcl_DecrRefCount(sub->action);
-		}
-		ckfree(sub);
-		sub = next;
-	    }
-
-	    sub = elem->revert;
-	    while (sub != NULL) {
-		TkUndoSubAtom *next = sub->next;
-
-		if (sub->action != NULL) {
-		    Tcl_DecrRefCount(sub->action);
-		}
-		ckfree(sub);
-		sub = next;
-	    }
-	}
-	ckfree(elem);
-    }
+    UndoFreeAtomChain(*stack, NULL);
     *stack = NULL;
 }
 
@@ -180,14 +155,33 @@ TkUndoPushAction(
     TkUndoSubAtom *revert)
 {
     TkUndoAtom *atom;
+    TkUndoSubAtom *sub;
 
     atom = (TkUndoAtom *)ckalloc(sizeof(TkUndoAtom));
     atom->type = TK_UNDO_ACTION;
     atom->apply = apply;
     atom->revert = revert;
 
+    /*
+     * Size the atom once, now, so that enforcing the stack's memory budget
+     * never has to walk the action scripts again.
+     */
+
+    atom->size = sizeof(TkUndoAtom);
+    for (sub = apply; sub != NULL; sub = sub->next) {
+	atom->size += sizeof(TkUndoSubAtom)
+		+ ((sub->action != NULL) ? UndoObjSize(sub->action) : 0);
+    }
+    for (sub = revert; sub != NULL; sub = sub->next) {
+	atom->size += sizeof(TkUndoSubAtom)
+		+ ((sub->action != NULL) ? UndoObjSize(sub->action) : 0);
+    }
+
     TkUndoPushStack(&stack->undoStack, atom);
-    TkUndoClearStack(&stack->redoStack);
+    stack->bytesUsed += atom->size;
+    stack->bytesUsed -= UndoFreeAtomChain(stack->redoStack, NULL);
+    stack->redoStack = NULL;
+    UndoTrimToSize(stack);
 }
 
 /*
@@ -347,6 +341,8 @@ TkUndoInitStack(
     stack->interp = interp;
     stack->maxdepth = maxdepth;
     stack->depth = 0;
+    stack->maxSize = 0;
+    stack->bytesUsed = 0;
     return stack;
 }
 
@@ -394,36 +390,38 @@ TkUndoSetMaxDepth(
 	}
 	CLANG_ASSERT(prevelem);
 	prevelem->next = NULL;
-	while (elem != NULL) {
-	    prevelem = elem;
-	    if (elem->type != TK_UNDO_SEPARATOR) {
-		TkUndoSubAtom *sub = elem->apply;
-		while (sub != NULL) {
-		    TkUndoSubAtom *next = sub->next;
-
-		    if (sub->action != NULL) {
-			Tcl_DecrRefCount(sub->action);
-		    }
-		    ckfree(sub);
-		    sub = next;
-		}
-		sub = elem->revert;
-		while (sub != NULL) {
-		    TkUndoSubAtom *next = sub->next;
-
-		    if (sub->action != NULL) {
-			Tcl_DecrRefCount(sub->action);
-		    }
-		    ckfree(sub);
-		    sub = next;
-		}
-	    }
-	    elem = elem->next;
-	    ckfree(prevelem);
-	}
+	stack->bytesUsed -= UndoFreeAtomChain(elem, NULL);
 	stack->depth = stack->maxdepth;
     }
 }
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkUndoSetMaxSize --
+ *
+ *	Set the maximum number of bytes the stack may retain, as estimated
+ *	by the sizes recorded when each atom was pushed. A value <= 0 means
+ *	no limit.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May delete the oldest compound elements from the undo stack if the
+ *	new budget is smaller than the bytes currently retained.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkUndoSetMaxSize(
+    TkUndoRedoStack *stack,	/* An Undo/Redo stack */
+    int maxSize)		/* The maximum size in bytes */
+{
+    stack->maxSize = maxSize;
+    UndoTrimToSize(stack);
+}
 
 /*
  *----------------------------------------------------------------------
@@ -448,6 +446,7 @@ TkUndoClearStacks(
     TkUndoClearStack(&stack->undoStack);
     TkUndoClearStack(&stack->redoStack);
     stack->depth = 0;
+    stack->bytesUsed = 0;
 }
 
 /*
@@ -545,6 +544,7 @@ TkUndoInsertUndoSeparator(
     if (TkUndoInsertSeparator(&stack->undoStack)) {
 	stack->depth++;
 	TkUndoSetMaxDepth(stack, stack->maxdepth);
+	UndoTrimToSize(stack);
     }
 }
 
@@ -727,6 +727,177 @@ EvaluateActionList(
     return result;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * UndoObjSize --
+ *
+ *	Estimate the number of bytes of heap memory retained by an action
+ *	script. The scripts built by the text widget are pure lists whose
+ *	elements (including the inserted or deleted characters) already have
+ *	string representations, so their elements are summed rather than
+ *	forcing a string representation of the whole list into existence
+ *	just to measure it.
+ *
+ * Results:
+ *	An approximate byte count.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static TkSizeT
+UndoObjSize(
+    Tcl_Obj *objPtr)		/* Action script whose storage to estimate. */
+{
+    TkSizeT size = 0;
+    int objc, i;
+    Tcl_Obj **objv;
+
+    if (objPtr->bytes != NULL) {
+	return objPtr->length;
+    }
+    if (Tcl_ListObjGetElements(NULL, objPtr, &objc, &objv) == TCL_OK) {
+	for (i = 0; i < objc; i++) {
+	    size += sizeof(Tcl_Obj) + UndoObjSize(objv[i]);
+	}
+	return size;
+    }
+    return sizeof(Tcl_Obj);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * UndoFreeAtomChain --
+ *
+ *	Destroy a chain of atoms and all sub-atoms hanging off them,
+ *	totalling the bytes recorded for them on the way.
+ *
+ * Results:
+ *	The number of bytes that were accounted to the chain. If sepCountPtr
+ *	is non-NULL it is filled with the number of separators the chain
+ *	contained.
+ *
+ * Side effects:
+ *	Frees memory.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static TkSizeT
+UndoFreeAtomChain(
+    TkUndoAtom *elem,		/* First atom of the chain to free. */
+    int *sepCountPtr)		/* If non-NULL, filled with the number of
+				 * separators found in the chain. */
+{
+    TkSizeT bytes = 0;
+    int seps = 0;
+
+    while (elem != NULL) {
+	TkUndoAtom *next = elem->next;
+
+	if (elem->type == TK_UNDO_SEPARATOR) {
+	    seps++;
+	} else {
+	    TkUndoSubAtom *sub;
+
+	    sub = elem->apply;
+	    while (sub != NULL) {
+		TkUndoSubAtom *nextSub = sub->next;
+
+		if (sub->action != NULL) {
+		    Tcl_DecrRefCount(sub->action);
+		}
+		ckfree(sub);
+		sub = nextSub;
+	    }
+
+	    sub = elem->revert;
+	    while (sub != NULL) {
+		TkUndoSubAtom *nextSub = sub->next;
+
+		if (sub->action != NULL) {
+		    Tcl_DecrRefCount(sub->action);
+		}
+		ckfree(sub);
+		sub = nextSub;
+	    }
+	    bytes += elem->size;
+	}
+	ckfree(elem);
+	elem = next;
+    }
+    if (sepCountPtr != NULL) {
+	*sepCountPtr = seps;
+    }
+    return bytes;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * UndoTrimToSize --
+ *
+ *	Enforce the stack's memory budget by discarding the oldest compound
+ *	elements until the retained bytes fit again. The most recent compound
+ *	element is always retained in full, even when it exceeds the budget
+ *	by itself, so that at least one undo remains available after a single
+ *	oversized edit.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	May delete elements from the undo stack.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+UndoTrimToSize(
+    TkUndoRedoStack *stack)	/* An Undo/Redo stack */
+{
+    TkUndoAtom *elem, *prevelem;
+    TkSizeT bytes = 0;
+    int seps = 0;
+
+    if (stack->maxSize <= 0 || stack->bytesUsed <= (TkSizeT) stack->maxSize) {
+	return;
+    }
+
+    /*
+     * Walk down from the most recent element and cut the stack at the first
+     * compound boundary at which the bytes retained above it already exceed
+     * the budget.
+     */
+
+    elem = stack->undoStack;
+    prevelem = NULL;
+    while (elem != NULL) {
+	if ((elem->type == TK_UNDO_SEPARATOR)
+		&& (bytes > (TkSizeT) stack->maxSize)) {
+	    break;
+	}
+	if (elem->type != TK_UNDO_SEPARATOR) {
+	    bytes += elem->size;
+	}
+	prevelem = elem;
+	elem = elem->next;
+    }
+    if (elem == NULL || prevelem == NULL) {
+	return;
+    }
+    prevelem->next = NULL;
+    stack->bytesUsed -= UndoFreeAtomChain(elem, &seps);
+    stack->depth -= seps;
+    if (stack->depth < 0) {
+	stack->depth = 0;
+    }
+}
+
 /*
  * Local Variables:
  * mode: c
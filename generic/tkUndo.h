@@ -65,6 +65,11 @@ typedef struct TkUndoAtom {
 				 * for this operation. */
     TkUndoSubAtom *revert;	/* Linked list of 'revert' actions to perform
 				 * for this operation. */
+    TkSizeT size;		/* Approximate number of bytes of heap memory
+				 * retained by this atom and its sub-atoms,
+				 * computed once when the atom is pushed so
+				 * that the stack's memory accounting stays
+				 * O(1) per operation. */
     struct TkUndoAtom *next;	/* Pointer to the next element in the
 				 * stack. */
 } TkUndoAtom;
@@ -80,6 +85,10 @@ typedef struct TkUndoRedoStack {
 				 * revert and apply scripts. */
     int maxdepth;
     int depth;
+    int maxSize;		/* Maximum number of bytes the stacks may
+				 * retain, or <= 0 for no limit. */
+    TkSizeT bytesUsed;		/* Approximate number of bytes currently
+				 * retained by the atoms on both stacks. */
 } TkUndoRedoStack;
 
 /*
@@ -97,6 +106,7 @@ MODULE_SCOPE void	TkUndoClearStack(TkUndoAtom **stack);
 
 MODULE_SCOPE TkUndoRedoStack *TkUndoInitStack(Tcl_Interp *interp, int maxdepth);
 MODULE_SCOPE void	TkUndoSetMaxDepth(TkUndoRedoStack *stack, int maxdepth);
+MODULE_SCOPE void	TkUndoSetMaxSize(TkUndoRedoStack *stack, int maxSize);
 MODULE_SCOPE void	TkUndoClearStacks(TkUndoRedoStack *stack);
 MODULE_SCOPE void	TkUndoFreeStack(TkUndoRedoStack *stack);
 MODULE_SCOPE int	TkUndoCanRedo(TkUndoRedoStack *stack);
@@ -188,6 +188,13 @@ static const TkCmd commands[] = {
     {"tk_messageBox",	Tk_MessageBoxObjCmd,	PASSMAINWINDOW},
 #endif
 
+    /*
+     * Focus traversal support, used by the script library.
+     */
+
+    {"::tk::FocusTraversalOrder",
+			TkFocusOrderObjCmd,	PASSMAINWINDOW|ISSAFE},
+
     /*
      * Misc.
      */
@@ -737,6 +744,12 @@ NameWindow(
 	return TCL_OK;
     }
 
+    /*
+     * A new named window changes the focus traversal order of its top-level.
+     */
+
+    TkFocusOrderInvalidate(winPtr->mainPtr);
+
     /*
      * Don't permit names that start with an upper-case letter: this will just
      * cause confusion with class names in the option database.
@@ -790,6 +803,9 @@ NameWindow(
     }
     Tcl_SetHashValue(hPtr, winPtr);
     winPtr->pathName = (char *)Tcl_GetHashKey(&parentPtr->mainPtr->nameTable, hPtr);
+    hPtr = Tcl_CreateHashEntry(&parentPtr->mainPtr->liveWindowTable,
+	    (char *) winPtr, &isNew);
+    Tcl_SetHashValue(hPtr, winPtr);
     return TCL_OK;
 }
 
@@ -865,6 +881,7 @@ TkCreateMainWindow(
     mainPtr->refCount = 1;
     mainPtr->interp = interp;
     Tcl_InitHashTable(&mainPtr->nameTable, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&mainPtr->liveWindowTable, TCL_ONE_WORD_KEYS);
     mainPtr->deletionEpoch = 0l;
     TkEventInit();
     TkBindInit(mainPtr);
@@ -872,6 +889,7 @@ TkCreateMainWindow(
     TkStylePkgInit(mainPtr);
     mainPtr->tlFocusPtr = NULL;
     mainPtr->displayFocusPtr = NULL;
+    mainPtr->focusOrderPtr = NULL;
     mainPtr->optionRootPtr = NULL;
     Tcl_InitHashTable(&mainPtr->imageTable, TCL_STRING_KEYS);
     mainPtr->strictMotif = 0;
@@ -894,6 +912,9 @@ TkCreateMainWindow(
     hPtr = Tcl_CreateHashEntry(&mainPtr->nameTable, ".", &dummy);
     Tcl_SetHashValue(hPtr, winPtr);
     winPtr->pathName = (char *)Tcl_GetHashKey(&mainPtr->nameTable, hPtr);
+    hPtr = Tcl_CreateHashEntry(&mainPtr->liveWindowTable, (char *) winPtr,
+	    &dummy);
+    Tcl_SetHashValue(hPtr, winPtr);
     Tcl_InitHashTable(&mainPtr->busyTable, TCL_ONE_WORD_KEYS);
 
     /*
@@ -1455,6 +1476,7 @@ Tk_DestroyWindow(
     TkOptionDeadWindow(winPtr);
     TkSelDeadWindow(winPtr);
     TkGrabDeadWindow(winPtr);
+    TkGeometryBatchDeadWindow(winPtr);
     if (winPtr->geomMgrName != NULL) {
 	ckfree(winPtr->geomMgrName);
 	winPtr->geomMgrName = NULL;
@@ -1465,6 +1487,14 @@ Tk_DestroyWindow(
 		    winPtr->pathName);
 	    Tcl_DeleteHashEntry(Tcl_FindHashEntry(&winPtr->mainPtr->nameTable,
 		    winPtr->pathName));
+	    {
+		Tcl_HashEntry *liveHPtr = Tcl_FindHashEntry(
+			&winPtr->mainPtr->liveWindowTable, (char *) winPtr);
+
+		if (liveHPtr != NULL) {
+		    Tcl_DeleteHashEntry(liveHPtr);
+		}
+	    }
 
 	    /*
 	     * The memory pointed to by pathName has been deallocated. Keep
@@ -1510,6 +1540,7 @@ Tk_DestroyWindow(
 
 	    Tcl_DeleteHashTable(&winPtr->mainPtr->busyTable);
 	    Tcl_DeleteHashTable(&winPtr->mainPtr->nameTable);
+	    Tcl_DeleteHashTable(&winPtr->mainPtr->liveWindowTable);
 	    TkBindFree(winPtr->mainPtr);
 	    TkDeleteAllImages(winPtr->mainPtr);
 	    TkFontPkgFree(winPtr->mainPtr);
@@ -1625,6 +1656,18 @@ Tk_MapWindow(
 	return;
     }
     if (winPtr->flags & TK_WIN_MANAGED) {
+	/*
+	 * Before the top-level goes up, create the X windows for everything
+	 * below it in one burst, so the hundreds of CreateWindow requests
+	 * for a complex dialog reach the server ahead of the first map
+	 * instead of trickling out one at a time as each child is mapped.
+	 */
+
+	TkMakeWindowTreeExist(winPtr);
+	if (winPtr->flags & TK_ALREADY_DEAD) {
+	    return;
+	}
+
 	/*
 	 * Lots of special processing has to be done for top-level windows.
 	 * Let tkWm.c handle everything itself.
@@ -1753,6 +1796,67 @@ Tk_MakeWindowExist(
 	TkDoConfigureNotify(winPtr);
     }
 }
+
+/*
+ *--------------------------------------------------------------
+ *
+ * TkMakeWindowTreeExist --
+ *
+ *	Ensure that the X windows for a window and all of its descendants
+ *	exist. Creating the whole hierarchy at once, before the first map,
+ *	batches all of the CreateWindow and ConfigureWindow requests into a
+ *	single protocol burst instead of interleaving them with the mapping
+ *	traffic of each child; over a high-latency connection this makes a
+ *	complex dialog appear much faster. Creating the children in
+ *	stacking order also avoids the restack request that
+ *	Tk_MakeWindowExist must otherwise issue for each window created
+ *	after a higher sibling.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	X windows are created for every window in the hierarchy below winPtr
+ *	that does not already have one.
+ *
+ *--------------------------------------------------------------
+ */
+
+void
+TkMakeWindowTreeExist(
+    TkWindow *winPtr)		/* Top of the hierarchy to create. */
+{
+    TkWindow *childPtr;
+
+    if (winPtr->flags & TK_ALREADY_DEAD) {
+	return;
+    }
+    if (winPtr->window == None) {
+	Tk_MakeWindowExist((Tk_Window) winPtr);
+
+	/*
+	 * Creating the window delivers synthesized ConfigureNotify events,
+	 * whose handlers may destroy the window out from under us.
+	 */
+
+	if (winPtr->flags & TK_ALREADY_DEAD) {
+	    return;
+	}
+    }
+    for (childPtr = winPtr->childList; childPtr != NULL;
+	    childPtr = childPtr->nextPtr) {
+	/*
+	 * Top-level children (menus, embedded toplevels) are parented
+	 * elsewhere and managed separately; leave their creation to their
+	 * own map.
+	 */
+
+	if (childPtr->flags & TK_TOP_HIERARCHY) {
+	    continue;
+	}
+	TkMakeWindowTreeExist(childPtr);
+    }
+}
 
 /*
  *--------------------------------------------------------------
@@ -2452,6 +2556,15 @@ UnlinkWindow(
 	    winPtr->parentPtr->lastChildPtr = prevPtr;
 	}
     }
+
+    /*
+     * Unlinking happens both when a window dies and when it is restacked;
+     * either way any cached focus traversal order is now stale.
+     */
+
+    if (winPtr->mainPtr != NULL) {
+	TkFocusOrderInvalidate(winPtr->mainPtr);
+    }
 }
 
 /*
@@ -38,10 +38,25 @@ struct Ttk_ResourceCache_ {
     Tcl_HashTable colorTable;	/* Entries: Tcl_Obj* holding ColorObjs */
     Tcl_HashTable borderTable;	/* Entries: Tcl_Obj* holding BorderObjs */
     Tcl_HashTable imageTable;	/* Entries: Tk_Images */
+    Tcl_HashTable pixmapTable;	/* Entries: CachedPixmaps of pre-rendered
+				 * elements, keyed by rendering inputs */
+    int nPixmaps;		/* Number of entries in pixmapTable */
+    unsigned pixmapSerial;	/* Use counter for LRU eviction */
 
     Tcl_HashTable namedColors;	/* Entries: RGB values as Tcl_StringObjs */
 };
 
+/*
+ * Cached pre-rendered pixmap. The cache owns the pixmap.
+ */
+#define PIXMAP_CACHE_SIZE 32
+
+typedef struct CachedPixmap {
+    Pixmap pixmap;		/* The rendered tile */
+    Display *display;		/* Display it was allocated on */
+    unsigned lastUsed;		/* cache->pixmapSerial at last use */
+} CachedPixmap;
+
 /*
  * Ttk_CreateResourceCache --
  * 	Initialize a new resource cache.
@@ -56,6 +71,9 @@ Ttk_ResourceCache Ttk_CreateResourceCache(Tcl_Interp *interp)
     Tcl_InitHashTable(&cache->colorTable, TCL_STRING_KEYS);
     Tcl_InitHashTable(&cache->borderTable, TCL_STRING_KEYS);
     Tcl_InitHashTable(&cache->imageTable, TCL_STRING_KEYS);
+    Tcl_InitHashTable(&cache->pixmapTable, TCL_STRING_KEYS);
+    cache->nPixmaps = 0;
+    cache->pixmapSerial = 0;
     Tcl_InitHashTable(&cache->namedColors, TCL_STRING_KEYS);
 
     return cache;
@@ -129,6 +147,20 @@ static void Ttk_ClearCache(Ttk_ResourceCache cache)
     Tcl_DeleteHashTable(&cache->imageTable);
     Tcl_InitHashTable(&cache->imageTable, TCL_STRING_KEYS);
 
+    /*
+     * Free pre-rendered pixmaps:
+     */
+    entryPtr = Tcl_FirstHashEntry(&cache->pixmapTable, &search);
+    while (entryPtr != NULL) {
+	CachedPixmap *cp = (CachedPixmap *)Tcl_GetHashValue(entryPtr);
+	Tk_FreePixmap(cp->display, cp->pixmap);
+	ckfree(cp);
+	entryPtr = Tcl_NextHashEntry(&search);
+    }
+    Tcl_DeleteHashTable(&cache->pixmapTable);
+    Tcl_InitHashTable(&cache->pixmapTable, TCL_STRING_KEYS);
+    cache->nPixmaps = 0;
+
     return;
 }
 
@@ -147,6 +179,7 @@ void Ttk_FreeResourceCache(Ttk_ResourceCache cache)
     Tcl_DeleteHashTable(&cache->colorTable);
     Tcl_DeleteHashTable(&cache->fontTable);
     Tcl_DeleteHashTable(&cache->imageTable);
+    Tcl_DeleteHashTable(&cache->pixmapTable);
 
     /*
      * Free named colors:
@@ -355,3 +388,68 @@ Tk_Image Ttk_UseImage(Ttk_ResourceCache cache, Tk_Window tkwin, Tcl_Obj *objPtr)
 }
 
 /*EOF*/
+
+/*
+ * Ttk_GetCachedPixmap --
+ *	Return a cached offscreen pixmap of the specified size for the key,
+ *	creating it if necessary. The key must encode everything the caller's
+ *	rendering depends on (including screen and depth). *isNewPtr is set
+ *	to 1 if the pixmap was just created, in which case the caller must
+ *	render every pixel of it before use. The cache owns the pixmap; the
+ *	least recently used one is discarded when the cache is full.
+ *
+ *	Returns None if the pixmap cannot be created.
+ */
+Pixmap Ttk_GetCachedPixmap(
+    Ttk_ResourceCache cache, Tk_Window tkwin,
+    const char *key, int width, int height, int *isNewPtr)
+{
+    Tcl_HashEntry *entryPtr;
+    CachedPixmap *cp;
+    int isNew;
+
+    if (Tk_WindowId(tkwin) == None) {
+	return None;
+    }
+    InitCacheWindow(cache, tkwin);
+
+    entryPtr = Tcl_CreateHashEntry(&cache->pixmapTable, key, &isNew);
+    if (!isNew) {
+	cp = (CachedPixmap *)Tcl_GetHashValue(entryPtr);
+	cp->lastUsed = ++cache->pixmapSerial;
+	*isNewPtr = 0;
+	return cp->pixmap;
+    }
+
+    if (cache->nPixmaps >= PIXMAP_CACHE_SIZE) {
+	Tcl_HashSearch search;
+	Tcl_HashEntry *scanPtr, *oldestPtr = NULL;
+	unsigned oldest = 0;
+
+	for (scanPtr = Tcl_FirstHashEntry(&cache->pixmapTable, &search);
+		scanPtr != NULL; scanPtr = Tcl_NextHashEntry(&search)) {
+	    cp = (CachedPixmap *)Tcl_GetHashValue(scanPtr);
+	    if (oldestPtr == NULL || cp->lastUsed < oldest) {
+		oldest = cp->lastUsed;
+		oldestPtr = scanPtr;
+	    }
+	}
+	if (oldestPtr != NULL && oldestPtr != entryPtr) {
+	    cp = (CachedPixmap *)Tcl_GetHashValue(oldestPtr);
+	    Tk_FreePixmap(cp->display, cp->pixmap);
+	    ckfree(cp);
+	    Tcl_DeleteHashEntry(oldestPtr);
+	    --cache->nPixmaps;
+	}
+    }
+
+    cp = (CachedPixmap *)ckalloc(sizeof(*cp));
+    cp->display = Tk_Display(tkwin);
+    cp->pixmap = Tk_GetPixmap(cp->display, Tk_WindowId(tkwin),
+	    width, height, Tk_Depth(tkwin));
+    cp->lastUsed = ++cache->pixmapSerial;
+    Tcl_SetHashValue(entryPtr, cp);
+    ++cache->nPixmaps;
+    *isNewPtr = 1;
+    return cp->pixmap;
+}
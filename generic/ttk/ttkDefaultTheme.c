@@ -6,6 +6,7 @@
 
 #include "tkInt.h"
 #include "ttkTheme.h"
+#include "ttkThemeInt.h"
 
 #if defined(_WIN32)
 static const int WIN32_XDRAWLINE_HACK = 1;
@@ -1193,8 +1194,16 @@ MODULE_SCOPE int TtkAltTheme_Init(Tcl_Interp *interp)
     Ttk_RegisterElement(interp, theme, "field", &FieldElementSpec, NULL);
 
     Ttk_RegisterElement(interp, theme, "trough", &TroughElementSpec, NULL);
-    Ttk_RegisterElement(interp, theme, "thumb", &ThumbElementSpec, NULL);
-    Ttk_RegisterElement(interp, theme, "slider", &SliderElementSpec, NULL);
+
+    /* The thumb and slider elements fill their entire parcel and depend
+     * only on their resolved options, so their rendering may be cached.
+     * The trough does not qualify: it leaves part of the parcel unpainted
+     * when drawn with a reduced -groovewidth.
+     */
+    Ttk_SetElementCacheable(
+	Ttk_RegisterElement(interp, theme, "thumb", &ThumbElementSpec, NULL));
+    Ttk_SetElementCacheable(
+	Ttk_RegisterElement(interp, theme, "slider", &SliderElementSpec, NULL));
 
     Ttk_RegisterElement(interp, theme, "uparrow",
 	    &ArrowElementSpec, INT2PTR(ARROW_UP));
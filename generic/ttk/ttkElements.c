@@ -7,6 +7,7 @@
 
 #include "tkInt.h"
 #include "ttkTheme.h"
+#include "ttkThemeInt.h"
 #include "ttkWidget.h"
 
 #define DEFAULT_BORDERWIDTH "2"
@@ -1372,6 +1373,34 @@ void TtkElements_Init(Tcl_Interp *interp)
     Ttk_RegisterElement(interp, theme, "tab", &TabElementSpec, NULL);
     Ttk_RegisterElement(interp, theme, "client", &ClientElementSpec, NULL);
 
+    /*
+     * Declare state sensitivity.  Most of the elements above depend on
+     * the widget state only through their resolved options, so a state
+     * change affects them only if a style map distinguishes it; the
+     * focus ring and notebook tab also inspect specific bits directly.
+     */
+    {
+	static const char *const pureElements[] = {
+	    "background", "fill", "border", "field", "padding",
+	    "Checkbutton.indicator", "Radiobutton.indicator",
+	    "Menubutton.indicator",
+	    "uparrow", "downarrow", "leftarrow", "rightarrow", "arrow",
+	    "trough", "thumb", "slider", "pbar",
+	    "separator", "hseparator", "vseparator",
+	    "sizegrip", "client", NULL
+	};
+	int i;
+
+	for (i = 0; pureElements[i]; ++i) {
+	    Ttk_SetElementStateSensitivity(
+		Ttk_GetElement(theme, pureElements[i]), 0);
+	}
+	Ttk_SetElementStateSensitivity(
+	    Ttk_GetElement(theme, "focus"), TTK_STATE_FOCUS);
+	Ttk_SetElementStateSensitivity(
+	    Ttk_GetElement(theme, "tab"), TTK_STATE_SELECTED);
+    }
+
     /*
      * Register "default" as a user-loadable theme (for now):
      */
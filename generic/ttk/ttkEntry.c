@@ -311,16 +311,20 @@ static char *EntryDisplayString(const char *showChar, int numChars)
 
 /* EntryUpdateTextLayout --
  * 	Recompute textLayout, layoutWidth, and layoutHeight
- * 	from displayString and fontObj.
+ * 	from displayString and fontObj.  Editing re-measures only the
+ * 	changed span of the previous layout (see TkTextLayoutEdit),
+ * 	which keeps per-keystroke cost proportional to the edit rather
+ * 	than the string length.
  */
 static void EntryUpdateTextLayout(Entry *entryPtr)
 {
     TkSizeT length;
     char *text;
-    Tk_FreeTextLayout(entryPtr->entry.textLayout);
+    Tk_TextLayout oldLayout = entryPtr->entry.textLayout;
     if ((entryPtr->entry.numChars != 0) || (entryPtr->entry.placeholderObj == NULL)) {
-        entryPtr->entry.textLayout = Tk_ComputeTextLayout(
+        entryPtr->entry.textLayout = TkTextLayoutEdit(
 	    Tk_GetFontFromObj(entryPtr->core.tkwin, entryPtr->entry.fontObj),
+	    oldLayout,
 	    entryPtr->entry.displayString, entryPtr->entry.numChars,
 	    0/*wraplength*/, entryPtr->entry.justify, TK_IGNORE_NEWLINES,
 	    &entryPtr->entry.layoutWidth, &entryPtr->entry.layoutHeight);
@@ -332,6 +336,7 @@ static void EntryUpdateTextLayout(Entry *entryPtr)
 	    0/*wraplength*/, entryPtr->entry.justify, TK_IGNORE_NEWLINES,
 	    &entryPtr->entry.layoutWidth, &entryPtr->entry.layoutHeight);
     }
+    Tk_FreeTextLayout(oldLayout);
 }
 
 /* EntryEditable --
@@ -8,6 +8,7 @@
 
 #include "tkInt.h"
 #include "ttkTheme.h"
+#include "ttkThemeInt.h"
 
 /*----------------------------------------------------------------------
  * +++ Text element.
@@ -706,7 +707,13 @@ void TtkLabel_Init(Tcl_Interp *interp)
 {
     Ttk_Theme theme =  Ttk_GetDefaultTheme(interp);
 
-    Ttk_RegisterElement(interp, theme, "text", &TextElementSpec, NULL);
+    /* The text element depends on the state only through its resolved
+     * options; image and label can select state-specific images, so they
+     * keep the default full sensitivity.
+     */
+    Ttk_SetElementStateSensitivity(
+	Ttk_RegisterElement(interp, theme, "text", &TextElementSpec, NULL),
+	0);
     Ttk_RegisterElement(interp, theme, "image", &ImageElementSpec, NULL);
     Ttk_RegisterElement(interp, theme, "label", &LabelElementSpec, NULL);
 }
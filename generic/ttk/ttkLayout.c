@@ -518,6 +518,13 @@ struct Ttk_LayoutNode_
     Ttk_ElementClass 	*eclass;	/* Class record */
     Ttk_State 	 	state;		/* Current state */
     Ttk_Box 		parcel;		/* allocated parcel */
+    Ttk_State 	 	cacheState;	/* State the cached size was computed
+					 * for */
+    unsigned		cacheSerial;	/* Size-computation pass the cached
+					 * size belongs to; see Ttk_NodeSize */
+    int 		cacheWidth;	/* Cached element+subtree size ... */
+    int 		cacheHeight;	/* ... */
+    Ttk_Padding 	cachePadding;	/* ... and padding */
     Ttk_LayoutNode	*next, *child;
 };
 
@@ -529,6 +536,8 @@ static Ttk_LayoutNode *Ttk_NewLayoutNode(
     node->flags = flags;
     node->eclass = elementClass;
     node->state = 0u;
+    node->cacheState = 0u;
+    node->cacheSerial = 0u;
     node->next = node->child = 0;
     node->parcel = Ttk_MakeBox(0,0,0,0);
 
@@ -836,6 +845,14 @@ struct Ttk_Layout_
     Tk_OptionTable	optionTable;
     Tk_Window		tkwin;
     Ttk_LayoutNode	*root;
+    unsigned		sizeSerial;	/* Current size-computation pass;
+					 * bumped at every public entry point
+					 * so node sizes are computed at most
+					 * once per pass */
+    Ttk_State		stateSensitivity;
+					/* Cached result of
+					 * Ttk_LayoutStateSensitivity */
+    int			sensitivityValid;
 };
 
 static Ttk_Layout TTKNewLayout(
@@ -849,9 +866,48 @@ static Ttk_Layout TTKNewLayout(
     layout->optionTable = optionTable;
     layout->tkwin = tkwin;
     layout->root = root;
+    layout->sizeSerial = 0u;
+    layout->stateSensitivity = 0;
+    layout->sensitivityValid = 0;
     return layout;
 }
 
+/* NodeStateSensitivity --
+ *	Union of the intrinsic state sensitivity of every element
+ *	in the specified node list.
+ */
+static Ttk_State NodeStateSensitivity(Ttk_LayoutNode *node)
+{
+    Ttk_State mask = 0;
+
+    for (; node; node = node->next) {
+	mask |= Ttk_ElementStateSensitivity(node->eclass);
+	if (node->child) {
+	    mask |= NodeStateSensitivity(node->child);
+	}
+    }
+    return mask;
+}
+
+/* Ttk_LayoutStateSensitivity --
+ *	Return the set of widget state bits that can affect the layout's
+ *	appearance: bits distinguished by any state map in the style,
+ *	plus bits any of the layout's elements inspects directly.
+ *	State changes outside this set need not trigger a redisplay.
+ *	Computed once per layout; layouts are recreated whenever the
+ *	style or theme changes.
+ */
+Ttk_State Ttk_LayoutStateSensitivity(Ttk_Layout layout)
+{
+    if (!layout->sensitivityValid) {
+	layout->stateSensitivity =
+	    Ttk_StyleStateSensitivity(layout->style)
+	    | NodeStateSensitivity(layout->root);
+	layout->sensitivityValid = 1;
+    }
+    return layout->stateSensitivity;
+}
+
 void Ttk_FreeLayout(Ttk_Layout layout)
 {
     Ttk_FreeLayoutNode(layout->root);
@@ -910,6 +966,7 @@ Ttk_CreateSublayout(
     const char *styleName;
     Ttk_Style style;
     Ttk_LayoutTemplate layoutTemplate;
+    Ttk_Layout subLayout;
 
     Tcl_DStringInit(&buf);
     Tcl_DStringAppend(&buf, Ttk_StyleName(parentLayout->style), -1);
@@ -928,9 +985,19 @@ Ttk_CreateSublayout(
 
     Tcl_DStringFree(&buf);
 
-    return TTKNewLayout(
+    subLayout = TTKNewLayout(
 	    style, 0, optionTable, parentLayout->tkwin,
 	    Ttk_InstantiateLayout(themePtr, layoutTemplate));
+
+    /* Sublayouts are typically drawn with a state derived from the
+     * parent widget's state, so fold the sublayout's state sensitivity
+     * into the parent's:
+     */
+    parentLayout->stateSensitivity =
+	Ttk_LayoutStateSensitivity(parentLayout)
+	| Ttk_LayoutStateSensitivity(subLayout);
+
+    return subLayout;
 }
 
 /* Ttk_RebindSublayout --
@@ -975,6 +1042,20 @@ static void Ttk_NodeSize(
     int elementWidth, elementHeight, subWidth, subHeight;
     Ttk_Padding elementPadding;
 
+    /* A node's size is needed several times during a single size or
+     * placement pass (once for each ancestor's subtree size and once for
+     * its own placement).  Element size queries go through the style
+     * engine and can be expensive, so reuse the size computed earlier in
+     * the same pass.
+     */
+    if (node->cacheSerial == layout->sizeSerial
+	    && node->cacheState == state) {
+	*widthPtr = node->cacheWidth;
+	*heightPtr = node->cacheHeight;
+	*paddingPtr = node->cachePadding;
+	return;
+    }
+
     Ttk_ElementSize(node->eclass,
 	layout->style, layout->recordPtr,layout->optionTable, layout->tkwin,
 	state|node->state,
@@ -987,6 +1068,12 @@ static void Ttk_NodeSize(
     *widthPtr = MAX(elementWidth, subWidth);
     *heightPtr = MAX(elementHeight, subHeight);
     *paddingPtr = elementPadding;
+
+    node->cacheState = state;
+    node->cacheWidth = *widthPtr;
+    node->cacheHeight = *heightPtr;
+    node->cachePadding = *paddingPtr;
+    node->cacheSerial = layout->sizeSerial;
 }
 
 static void Ttk_NodeListSize(
@@ -1048,6 +1135,7 @@ Ttk_Box Ttk_LayoutNodeInternalParcel(Ttk_Layout layout, Ttk_LayoutNode *node)
 void Ttk_LayoutSize(
     Ttk_Layout layout, Ttk_State state, int *widthPtr, int *heightPtr)
 {
+    ++layout->sizeSerial;
     Ttk_NodeListSize(layout, layout->root, state, widthPtr, heightPtr);
 }
 
@@ -1055,6 +1143,8 @@ void Ttk_LayoutNodeReqSize(	/* @@@ Rename this */
     Ttk_Layout layout, Ttk_LayoutNode *node, int *widthPtr, int *heightPtr)
 {
     Ttk_Padding unused;
+
+    ++layout->sizeSerial;
     Ttk_NodeSize(layout, node, 0/*state*/, widthPtr, heightPtr, &unused);
 }
 
@@ -1093,6 +1183,7 @@ static void Ttk_PlaceNodeList(
 
 void Ttk_PlaceLayout(Ttk_Layout layout, Ttk_State state, Ttk_Box b)
 {
+    ++layout->sizeSerial;
     Ttk_PlaceNodeList(layout, layout->root, state,  b);
 }
 
@@ -46,6 +46,11 @@ typedef struct
     Tcl_Obj *compoundObj;
     Tcl_Obj *underlineObj;
 
+    /* Deferred pane construction:
+     */
+    Tcl_Obj *createCmdObj;	/* Script that builds the pane contents */
+    int paneCreated;		/* Non-zero after createCmdObj has run */
+
 } Tab;
 
 /* Two different option tables are used for tabs:
@@ -74,6 +79,9 @@ static const Tk_OptionSpec TabOptionSpecs[] =
 
 static const Tk_OptionSpec PaneOptionSpecs[] =
 {
+    {TK_OPTION_STRING, "-createcommand", "createCommand", "CreateCommand",
+	NULL, offsetof(Tab,createCmdObj), TCL_INDEX_NONE,
+	TK_OPTION_NULL_OK, 0, 0 },
     {TK_OPTION_STRING, "-padding", "padding", "Padding", "0",
 	offsetof(Tab,paddingObj), TCL_INDEX_NONE, 0, 0, GEOMETRY_CHANGED },
     {TK_OPTION_STRING, "-sticky", "sticky", "Sticky", "nsew",
@@ -99,6 +107,8 @@ typedef struct
     Ttk_Layout tabLayout;	/* Sublayout for tabs */
 
     Ttk_Box clientArea;		/* Where to pack content windows */
+    int prewarmScheduled;	/* Non-zero means an idle call to
+				 * PrewarmIdleProc is pending */
 } NotebookPart;
 
 typedef struct
@@ -214,6 +224,7 @@ static int ConfigureTab(
 {
     Ttk_Sticky sticky = tab->sticky;
     Ttk_Padding padding = tab->padding;
+    Tcl_Obj *oldCreateCmdObj = tab->createCmdObj;
     Tk_SavedOptions savedOptions;
     int mask = 0;
 
@@ -239,6 +250,12 @@ static int ConfigureTab(
     tab->sticky = sticky;
     tab->padding = padding;
 
+    /* Re-arm deferred construction when a new -createcommand is supplied:
+     */
+    if (tab->createCmdObj != oldCreateCmdObj) {
+	tab->paneCreated = 0;
+    }
+
     Tk_FreeSavedOptions(&savedOptions);
     Ttk_ManagerSizeChanged(nb->notebook.mgr);
     TtkRedisplayWidget(&nb->core);
@@ -596,6 +613,36 @@ static void NotebookPlaceContents(void *recordPtr)
     }
 }
 
+/* InstantiatePane --
+ * 	Run the tab's -createcommand the first time the tab is needed,
+ * 	so that pane contents can be built on demand instead of at
+ * 	startup.  Errors are reported as background exceptions.
+ *
+ * 	Returns 0 if the notebook was destroyed by the script,
+ * 	1 otherwise.  The tab pointer must not be used after a call
+ * 	that ran a script, since the script may have removed the tab.
+ */
+static int InstantiatePane(Notebook *nb, Tab *tab)
+{
+    Tcl_Interp *interp = nb->core.interp;
+    int code, alive;
+
+    if (tab->paneCreated || (tab->createCmdObj == NULL)) {
+	return 1;
+    }
+    tab->paneCreated = 1;
+
+    Tcl_Preserve(nb);
+    code = Tcl_EvalObjEx(interp, tab->createCmdObj, TCL_EVAL_GLOBAL);
+    if (code != TCL_OK) {
+	Tcl_BackgroundException(interp, code);
+    }
+    alive = !WidgetDestroyed(&nb->core);
+    Tcl_Release(nb);
+
+    return alive;
+}
+
 /*
  * SelectTab(nb, index) --
  * 	Change the currently-selected tab.
@@ -628,6 +675,18 @@ static void SelectTab(Notebook *nb, TkSizeT index)
      * geometry request, will swap to old index. */
     nb->notebook.currentIndex = index;
 
+    /* Build the pane contents on first selection.  The script may have
+     * destroyed the notebook or reorganized its tabs; in the former case
+     * stop here, in the latter continue with the adjusted current index.
+     */
+    if (!InstantiatePane(nb, tab)) {
+	return;
+    }
+    index = nb->notebook.currentIndex;
+    if (index == TCL_INDEX_NONE) {
+	return;
+    }
+
     NotebookPlaceContent(nb, index);
     TtkRedisplayWidget(&nb->core);
 
@@ -1167,6 +1226,50 @@ static int NotebookSelectCommand(
     return TCL_ERROR;
 }
 
+/* PrewarmIdleProc --
+ * 	Idle handler that builds one deferred pane per pass, rescheduling
+ * 	itself until none remain.  Doing one pane at a time keeps the
+ * 	event loop responsive while the remaining tabs warm up in the
+ * 	background.
+ */
+static void PrewarmIdleProc(ClientData clientData)
+{
+    Notebook *nb = (Notebook *)clientData;
+    TkSizeT i;
+
+    nb->notebook.prewarmScheduled = 0;
+    for (i = 0; i < Ttk_NumberContent(nb->notebook.mgr); ++i) {
+	Tab *tab = (Tab *)Ttk_ContentData(nb->notebook.mgr, i);
+
+	if (!tab->paneCreated && (tab->createCmdObj != NULL)) {
+	    if (InstantiatePane(nb, tab) && !nb->notebook.prewarmScheduled) {
+		nb->notebook.prewarmScheduled = 1;
+		Tcl_DoWhenIdle(PrewarmIdleProc, clientData);
+	    }
+	    return;
+	}
+    }
+}
+
+/* $nb prewarm --
+ * 	Build the remaining deferred panes during idle time.
+ */
+static int NotebookPrewarmCommand(
+    void *recordPtr, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Notebook *nb = (Notebook *)recordPtr;
+
+    if (objc != 2) {
+	Tcl_WrongNumArgs(interp, 2, objv, "");
+	return TCL_ERROR;
+    }
+    if (!nb->notebook.prewarmScheduled) {
+	nb->notebook.prewarmScheduled = 1;
+	Tcl_DoWhenIdle(PrewarmIdleProc, recordPtr);
+    }
+    return TCL_OK;
+}
+
 /* $nb tabs --
  * 	Return list of tabs.
  */
@@ -1250,6 +1353,7 @@ static const Ttk_Ensemble NotebookCommands[] = {
     { "index",		NotebookIndexCommand,0 },
     { "insert",  	NotebookInsertCommand,0 },
     { "instate",	TtkWidgetInstateCommand,0 },
+    { "prewarm",	NotebookPrewarmCommand,0 },
     { "select",		NotebookSelectCommand,0 },
     { "state",  	TtkWidgetStateCommand,0 },
     { "style",		TtkWidgetStyleCommand,0 },
@@ -1277,6 +1381,7 @@ static void NotebookInitialize(Tcl_Interp *interp, void *recordPtr)
     nb->notebook.tabLayout = 0;
 
     nb->notebook.clientArea = Ttk_MakeBox(0,0,1,1);
+    nb->notebook.prewarmScheduled = 0;
 
     Tk_CreateEventHandler(
 	nb->core.tkwin, NotebookEventMask, NotebookEventHandler, recordPtr);
@@ -1286,6 +1391,9 @@ static void NotebookCleanup(void *recordPtr)
 {
     Notebook *nb = (Notebook *)recordPtr;
 
+    if (nb->notebook.prewarmScheduled) {
+	Tcl_CancelIdleCall(PrewarmIdleProc, recordPtr);
+    }
     Ttk_DeleteManager(nb->notebook.mgr);
     if (nb->notebook.tabLayout)
 	Ttk_FreeLayout(nb->notebook.tabLayout);
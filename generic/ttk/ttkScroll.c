@@ -48,6 +48,15 @@ struct ScrollHandleRec
     unsigned 	flags;
     WidgetCore	*corePtr;
     Scrollable	*scrollPtr;
+
+    /* Scroll-blit snapshot (see TtkScrollBlitBegin):
+     */
+    Pixmap	blitPixmap;	/* Copy of the scrolled area as last drawn,
+				 * None if no snapshot is available */
+    Display	*blitDisplay;	/* Display blitPixmap was allocated on */
+    Ttk_Box	blitArea;	/* Area the snapshot covers */
+    int 	blitOrigin;	/* Scroll origin (in pixels) of snapshot */
+    int 	blitStamp;	/* Client stamp of snapshot */
 };
 
 /* TtkCreateScrollHandle --
@@ -60,6 +69,11 @@ ScrollHandle TtkCreateScrollHandle(WidgetCore *corePtr, Scrollable *scrollPtr)
     h->flags = 0;
     h->corePtr = corePtr;
     h->scrollPtr = scrollPtr;
+    h->blitPixmap = None;
+    h->blitDisplay = NULL;
+    h->blitArea = Ttk_MakeBox(0,0,0,0);
+    h->blitOrigin = 0;
+    h->blitStamp = 0;
 
     scrollPtr->first = 0;
     scrollPtr->last = 1;
@@ -266,16 +280,140 @@ void TtkScrollTo(ScrollHandle h, int newFirst, int updateScrollInfo)
 	newFirst = 0;
 
     if (newFirst != s->first) {
+	int contentChanged = h->corePtr->flags & CONTENT_CHANGED;
+
 	s->first = newFirst;
 	TtkRedisplayWidget(h->corePtr);
+
+	/* Scrolling by itself doesn't alter the widget contents,
+	 * so don't let the redisplay request spoil the scroll-blit
+	 * snapshot unless something else already did:
+	 */
+	if (!contentChanged) {
+	    h->corePtr->flags &= ~CONTENT_CHANGED;
+	}
     }
 }
 
+/* FreeBlitPixmap, BlitGC --
+ * 	Scroll-blit utilities.
+ */
+static void FreeBlitPixmap(ScrollHandle h)
+{
+    if (h->blitPixmap != None) {
+	Tk_FreePixmap(h->blitDisplay, h->blitPixmap);
+	h->blitPixmap = None;
+    }
+}
+
+static GC BlitGC(Tk_Window tkwin)
+{
+    XGCValues gcValues;
+
+    gcValues.graphics_exposures = False;
+    return Tk_GetGC(tkwin, GCGraphicsExposures, &gcValues);
+}
+
+/* TtkScrollBlitBegin --
+ * 	Called by the scrollee's displayProc before drawing the scrolled
+ * 	area 'area' into 'd'.  'origin' is the current scroll origin in
+ * 	pixels; 'stamp' may carry any other value the drawn content
+ * 	depends on (e.g. the origin of a second scroll axis).
+ *
+ * 	If the widget contents are unchanged since the last snapshot
+ * 	(only TtkScrollTo ran in between) and the scroll distance is
+ * 	less than the area height, copies the still-valid part of the
+ * 	snapshot into 'd' and returns 1, with *validFirstPtr (inclusive)
+ * 	and *validLastPtr (exclusive) set to the vertical pixel range of
+ * 	'd' that is already up to date; the caller need only draw the
+ * 	exposed remainder.  Returns 0 if the caller must draw everything.
+ */
+int TtkScrollBlitBegin(
+    ScrollHandle h, Drawable d, Ttk_Box area, int origin, int stamp,
+    int *validFirstPtr, int *validLastPtr)
+{
+    Tk_Window tkwin = h->corePtr->tkwin;
+    int delta;
+    GC gc;
+
+    *validFirstPtr = *validLastPtr = 0;
+
+    if (h->blitPixmap == None
+	    || (h->corePtr->flags & CONTENT_CHANGED)
+	    || stamp != h->blitStamp
+	    || area.x != h->blitArea.x || area.y != h->blitArea.y
+	    || area.width != h->blitArea.width
+	    || area.height != h->blitArea.height) {
+	return 0;
+    }
+
+    delta = origin - h->blitOrigin;
+    if (delta <= -area.height || delta >= area.height) {
+	return 0;
+    }
+
+    gc = BlitGC(tkwin);
+    if (delta >= 0) {
+	XCopyArea(Tk_Display(tkwin), h->blitPixmap, d, gc,
+		0, delta, (unsigned)area.width,
+		(unsigned)(area.height - delta), area.x, area.y);
+	*validFirstPtr = area.y;
+	*validLastPtr = area.y + area.height - delta;
+    } else {
+	XCopyArea(Tk_Display(tkwin), h->blitPixmap, d, gc,
+		0, 0, (unsigned)area.width,
+		(unsigned)(area.height + delta), area.x, area.y - delta);
+	*validFirstPtr = area.y - delta;
+	*validLastPtr = area.y + area.height;
+    }
+    Tk_FreeGC(Tk_Display(tkwin), gc);
+    return 1;
+}
+
+/* TtkScrollBlitEnd --
+ * 	Called by the scrollee's displayProc after drawing.
+ * 	Snapshots the scrolled area from 'd' for the next
+ * 	TtkScrollBlitBegin, and marks the contents as captured.
+ */
+void TtkScrollBlitEnd(
+    ScrollHandle h, Drawable d, Ttk_Box area, int origin, int stamp)
+{
+    Tk_Window tkwin = h->corePtr->tkwin;
+    GC gc;
+
+    if (area.width <= 0 || area.height <= 0 || Tk_WindowId(tkwin) == None) {
+	FreeBlitPixmap(h);
+	return;
+    }
+
+    if (h->blitPixmap != None
+	    && (area.width != h->blitArea.width
+		|| area.height != h->blitArea.height)) {
+	FreeBlitPixmap(h);
+    }
+    if (h->blitPixmap == None) {
+	h->blitDisplay = Tk_Display(tkwin);
+	h->blitPixmap = Tk_GetPixmap(h->blitDisplay, Tk_WindowId(tkwin),
+		area.width, area.height, Tk_Depth(tkwin));
+    }
+
+    gc = BlitGC(tkwin);
+    XCopyArea(Tk_Display(tkwin), d, h->blitPixmap, gc,
+	    area.x, area.y, (unsigned)area.width, (unsigned)area.height, 0, 0);
+    Tk_FreeGC(Tk_Display(tkwin), gc);
+
+    h->blitArea = area;
+    h->blitOrigin = origin;
+    h->blitStamp = stamp;
+    h->corePtr->flags &= ~CONTENT_CHANGED;
+}
+
 void TtkFreeScrollHandle(ScrollHandle h)
 {
     if (h->flags & SCROLL_UPDATE_PENDING) {
 	Tcl_CancelIdleCall(UpdateScrollbarBG, h);
     }
+    FreeBlitPixmap(h);
     ckfree(h);
 }
 
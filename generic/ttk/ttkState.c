@@ -187,6 +187,128 @@ int Ttk_GetStateSpecFromObj(
 }
 
 
+/*------------------------------------------------------------------------
+ * +++ StateMap object type:
+ *
+ * A state map is a paired list of StateSpec / value pairs.
+ * The internal representation compiles the list into an array of
+ * parsed state specifications, so that per-draw lookups need neither
+ * the list machinery nor per-spec conversions.  The value objects
+ * are held with an extra reference, since converting the internal
+ * representation releases the list's references.
+ */
+
+typedef struct {
+    Ttk_StateSpec spec;		/* Parsed state specification */
+    Tcl_Obj *value;		/* Associated value (held) */
+} StateMapEntry;
+
+typedef struct {
+    int nEntries;		/* Number of spec / value pairs */
+    Ttk_State sensitivity;	/* Union of all bits any spec examines */
+    StateMapEntry entries[1];	/* Really [nEntries] */
+} StateMapRep;
+
+#define StateMapRepSize(nEntries)     (offsetof(StateMapRep, entries) + (nEntries) * sizeof(StateMapEntry))
+
+static int  StateMapSetFromAny(Tcl_Interp *interp, Tcl_Obj *obj);
+static void StateMapFreeIntRep(Tcl_Obj *);
+static void StateMapDupIntRep(Tcl_Obj *, Tcl_Obj *);
+
+static
+struct Tcl_ObjType StateMapObjType =
+{
+    "StateMap",
+    StateMapFreeIntRep,
+    StateMapDupIntRep,
+    0,		/* updateStringProc not needed: the string rep is
+		 * generated before conversion and never invalidated */
+    StateMapSetFromAny
+};
+
+static void StateMapFreeIntRep(Tcl_Obj *objPtr)
+{
+    StateMapRep *rep = (StateMapRep *)objPtr->internalRep.twoPtrValue.ptr1;
+    int i;
+
+    for (i = 0; i < rep->nEntries; ++i) {
+	Tcl_DecrRefCount(rep->entries[i].value);
+    }
+    ckfree(rep);
+}
+
+static void StateMapDupIntRep(Tcl_Obj *srcPtr, Tcl_Obj *copyPtr)
+{
+    StateMapRep *srcRep = (StateMapRep *)srcPtr->internalRep.twoPtrValue.ptr1;
+    StateMapRep *rep = (StateMapRep *)ckalloc(StateMapRepSize(srcRep->nEntries));
+    int i;
+
+    memcpy(rep, srcRep, StateMapRepSize(srcRep->nEntries));
+    for (i = 0; i < rep->nEntries; ++i) {
+	Tcl_IncrRefCount(rep->entries[i].value);
+    }
+    copyPtr->internalRep.twoPtrValue.ptr1 = rep;
+    copyPtr->typePtr = &StateMapObjType;
+}
+
+static int StateMapSetFromAny(Tcl_Interp *interp, Tcl_Obj *objPtr)
+{
+    Tcl_Obj **objv;
+    int objc;
+    int i;
+    StateMapRep *rep;
+
+    if (Tcl_ListObjGetElements(interp, objPtr, &objc, &objv) != TCL_OK)
+	return TCL_ERROR;
+
+    if (objc % 2 != 0) {
+	if (interp) {
+	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		    "State map must have an even number of elements", -1));
+	    Tcl_SetErrorCode(interp, "TTK", "VALUE", "STATEMAP", NULL);
+	}
+	return TCL_ERROR;
+    }
+
+    rep = (StateMapRep *)ckalloc(StateMapRepSize(objc / 2));
+    rep->nEntries = objc / 2;
+    rep->sensitivity = 0;
+    for (i = 0; i < rep->nEntries; ++i) {
+	if (Ttk_GetStateSpecFromObj(
+		interp, objv[2*i], &rep->entries[i].spec) != TCL_OK) {
+	    while (i-- > 0) {
+		Tcl_DecrRefCount(rep->entries[i].value);
+	    }
+	    ckfree(rep);
+	    return TCL_ERROR;
+	}
+	rep->entries[i].value = objv[2*i + 1];
+	Tcl_IncrRefCount(rep->entries[i].value);
+	rep->sensitivity |=
+	    rep->entries[i].spec.onbits | rep->entries[i].spec.offbits;
+    }
+
+    /* Make sure a string rep exists, then replace the old intrep:
+     */
+    (void)Tcl_GetString(objPtr);
+    if (objPtr->typePtr && objPtr->typePtr->freeIntRepProc) {
+	objPtr->typePtr->freeIntRepProc(objPtr);
+    }
+    objPtr->typePtr = &StateMapObjType;
+    objPtr->internalRep.twoPtrValue.ptr1 = rep;
+
+    return TCL_OK;
+}
+
+static const StateMapRep *GetStateMapRep(Tcl_Interp *interp, Tcl_Obj *objPtr)
+{
+    if (objPtr->typePtr != &StateMapObjType) {
+	if (StateMapSetFromAny(interp, objPtr) != TCL_OK)
+	    return NULL;
+    }
+    return (const StateMapRep *)objPtr->internalRep.twoPtrValue.ptr1;
+}
+
 /*
  * Tk_StateMapLookup --
  *
@@ -199,21 +321,15 @@ Tcl_Obj *Ttk_StateMapLookup(
     Ttk_StateMap map,		/* State map */
     Ttk_State state)    	/* State to look up */
 {
-    Tcl_Obj **specs;
-    int nSpecs;
-    int j, status;
+    const StateMapRep *rep = GetStateMapRep(interp, map);
+    int i;
 
-    status = Tcl_ListObjGetElements(interp, map, &nSpecs, &specs);
-    if (status != TCL_OK)
+    if (!rep)
 	return NULL;
 
-    for (j = 0; j < nSpecs; j += 2) {
-	Ttk_StateSpec spec;
-	status = Ttk_GetStateSpecFromObj(interp, specs[j], &spec);
-	if (status != TCL_OK)
-	    return NULL;
-	if (Ttk_StateMatches(state, &spec))
-	    return specs[j+1];
+    for (i = 0; i < rep->nEntries; ++i) {
+	if (Ttk_StateMatches(state, &rep->entries[i].spec))
+	    return rep->entries[i].value;
     }
     if (interp) {
 	Tcl_SetObjResult(interp, Tcl_NewStringObj("No match in state map", -1));
@@ -225,36 +341,25 @@ Tcl_Obj *Ttk_StateMapLookup(
 /* Ttk_GetStateMapFromObj --
  * 	Returns a Ttk_StateMap from a Tcl_Obj*.
  * 	Since a Ttk_StateMap is just a specially-formatted Tcl_Obj,
- * 	this basically just checks for errors.
+ * 	this basically just checks for errors (and, as a side effect,
+ * 	compiles the map for fast lookups).
  */
 Ttk_StateMap Ttk_GetStateMapFromObj(
     Tcl_Interp *interp,		/* Where to leave error messages; may be NULL */
     Tcl_Obj *mapObj)		/* State map */
 {
-    Tcl_Obj **specs;
-    int nSpecs;
-    int j, status;
-
-    status = Tcl_ListObjGetElements(interp, mapObj, &nSpecs, &specs);
-    if (status != TCL_OK)
-	return NULL;
-
-    if (nSpecs % 2 != 0) {
-	if (interp) {
-	    Tcl_SetObjResult(interp, Tcl_NewStringObj(
-		    "State map must have an even number of elements", -1));
-	    Tcl_SetErrorCode(interp, "TTK", "VALUE", "STATEMAP", NULL);
-	}
-	return 0;
-    }
+    return GetStateMapRep(interp, mapObj) ? mapObj : NULL;
+}
 
-    for (j = 0; j < nSpecs; j += 2) {
-	Ttk_StateSpec spec;
-	if (Ttk_GetStateSpecFromObj(interp, specs[j], &spec) != TCL_OK)
-	    return NULL;
-    }
+/* TtkStateMapSensitivity --
+ * 	Return the union of all state bits examined by any specification
+ * 	in the map, or 0 if the map is malformed.
+ */
+Ttk_State TtkStateMapSensitivity(Tcl_Obj *mapObj)
+{
+    const StateMapRep *rep = GetStateMapRep(NULL, mapObj);
 
-    return mapObj;
+    return rep ? rep->sensitivity : 0;
 }
 
 /*
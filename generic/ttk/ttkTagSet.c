@@ -23,6 +23,10 @@ struct TtkTagTable {
     Tk_OptionTable	optionTable;	/* ... */
     int         	recordSize;	/* size of tag record */
     int 		nTags;		/* #tags defined so far */
+    int 		epoch;		/* bumped when any tag is configured
+					 * or deleted, so that tag sets can
+					 * tell their memoized merged values
+					 * are stale */
     Tcl_HashTable	tags;		/* defined tags */
 };
 
@@ -61,6 +65,7 @@ Ttk_TagTable Ttk_CreateTagTable(
     tagTable->optionTable = Tk_CreateOptionTable(interp, optionSpecs);
     tagTable->recordSize = recordSize;
     tagTable->nTags = 0;
+    tagTable->epoch = 1;
     Tcl_InitHashTable(&tagTable->tags, TCL_STRING_KEYS);
     return tagTable;
 }
@@ -88,6 +93,7 @@ void Ttk_DeleteTagFromTable(Ttk_TagTable tagTable, Ttk_Tag tag)
     if (entryPtr != NULL) {
         DeleteTag(tagTable, tag);
         Tcl_DeleteHashEntry(entryPtr);
+        ++tagTable->epoch;
     }
 }
 
@@ -128,6 +134,8 @@ Ttk_TagSet Ttk_GetTagSetFromObj(
     Tcl_Obj **objv;
     int i, objc;
 
+    tagset->cachedRecord = NULL;
+    tagset->cacheEpoch = 0;
     if (objPtr == NULL) {
 	tagset->tags = NULL;
 	tagset->nTags = 0;
@@ -166,10 +174,25 @@ Tcl_Obj *Ttk_NewTagSetObj(Ttk_TagSet tagset)
 
 void Ttk_FreeTagSet(Ttk_TagSet tagset)
 {
+    if (tagset->cachedRecord != NULL) {
+	ckfree(tagset->cachedRecord);
+    }
     ckfree(tagset->tags);
     ckfree(tagset);
 }
 
+/* TagSetInvalidate -- discard a tag set's memoized merged values.
+ * 	Called when the set itself changes; changes to the tags' options
+ * 	are caught by the table epoch instead.
+ */
+static void TagSetInvalidate(Ttk_TagSet tagset)
+{
+    if (tagset->cachedRecord != NULL) {
+	ckfree(tagset->cachedRecord);
+	tagset->cachedRecord = NULL;
+    }
+}
+
 /* Ttk_TagSetContains -- test if tag set contains a tag.
  */
 int Ttk_TagSetContains(Ttk_TagSet tagset, Ttk_Tag tag)
@@ -199,6 +222,7 @@ int Ttk_TagSetAdd(Ttk_TagSet tagset, Ttk_Tag tag)
     tagset->tags = (Ttk_Tag *)ckrealloc(tagset->tags,
 	    (tagset->nTags+1)*sizeof(tagset->tags[0]));
     tagset->tags[tagset->nTags++] = tag;
+    TagSetInvalidate(tagset);
     return 1;
 }
 
@@ -217,6 +241,9 @@ int Ttk_TagSetRemove(Ttk_TagSet tagset, Ttk_Tag tag)
 	++i;
     }
     tagset->nTags = j;
+    if (j != i) {
+	TagSetInvalidate(tagset);
+    }
     return j != i;
 }
 
@@ -261,6 +288,7 @@ int Ttk_ConfigureTag(
     Ttk_Tag tag,
     int objc, Tcl_Obj *const objv[])
 {
+    ++tagTable->epoch;
     return Tk_SetOptions(
 	interp, tag->tagRecord, tagTable->optionTable,
 	objc, objv, tagTable->tkwin, NULL/*savedOptions*/, NULL/*mask*/);
@@ -277,6 +305,15 @@ void Ttk_TagSetValues(Ttk_TagTable tagTable, Ttk_TagSet tagSet, void *record)
     const int LOWEST_PRIORITY = 0x7FFFFFFF;
     int i, j;
 
+    /* The merged values only change when the set or one of the table's
+     * tags does, so redraws can reuse the values memoized in the tag set.
+     */
+    if (tagSet->cachedRecord != NULL
+	    && tagSet->cacheEpoch == tagTable->epoch) {
+	memcpy(record, tagSet->cachedRecord, tagTable->recordSize);
+	return;
+    }
+
     memset(record, 0, tagTable->recordSize);
 
     for (i = 0; tagTable->optionSpecs[i].type != TK_OPTION_END; ++i) {
@@ -292,6 +329,12 @@ void Ttk_TagSetValues(Ttk_TagTable tagTable, Ttk_TagSet tagSet, void *record)
 	    }
 	}
     }
+
+    if (tagSet->cachedRecord == NULL) {
+	tagSet->cachedRecord = ckalloc(tagTable->recordSize);
+    }
+    memcpy(tagSet->cachedRecord, record, tagTable->recordSize);
+    tagSet->cacheEpoch = tagTable->epoch;
 }
 
 void Ttk_TagSetApplyStyle(
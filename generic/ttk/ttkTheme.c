@@ -109,6 +109,32 @@ Tcl_Obj *Ttk_StyleDefault(Ttk_Style style, const char *optionName)
     return 0;
 }
 
+/*
+ * Ttk_StyleStateSensitivity --
+ *	Return the union of all state bits distinguished by any state map
+ *	in the specified style or its ancestors.  State changes outside
+ *	this set cannot alter any dynamically mapped option value.
+ */
+Ttk_State Ttk_StyleStateSensitivity(Ttk_Style style)
+{
+    Ttk_State mask = 0;
+
+    while (style) {
+	Tcl_HashSearch search;
+	Tcl_HashEntry *entryPtr =
+	    Tcl_FirstHashEntry(&style->settingsTable, &search);
+
+	while (entryPtr != NULL) {
+	    Ttk_StateMap stateMap = (Ttk_StateMap)Tcl_GetHashValue(entryPtr);
+
+	    mask |= TtkStateMapSensitivity(stateMap);
+	    entryPtr = Tcl_NextHashEntry(&search);
+	}
+	style = style->parentStyle;
+    }
+    return mask;
+}
+
 /*------------------------------------------------------------------------
  * +++ Elements.
  */
@@ -123,6 +149,18 @@ struct Ttk_ElementClass_ {
     int nResources;		/* #Element options */
     Tcl_Obj **defaultValues;	/* Array of option default values */
     Tcl_HashTable optMapCache;	/* Map: Tk_OptionTable * -> OptionMap */
+    int cacheable;		/* If set, the element's rendering is a pure
+				 * function of its resolved options, state and
+				 * parcel size, and it paints every pixel of
+				 * the parcel, so draws may be served from the
+				 * pre-rendered pixmap cache. */
+    Ttk_State stateSensitivity;	/* State bits the draw and size procedures
+				 * inspect directly, in addition to any bits
+				 * used in style maps for the element's
+				 * options.  Defaults to all bits; cleared
+				 * only for elements known to depend on
+				 * state solely through their resolved
+				 * options. */
 };
 
 /* TTKGetOptionSpec --
@@ -225,6 +263,8 @@ NewElementClass(const char *name, const Ttk_ElementSpec *specPtr, void *clientDa
     elementClass->specPtr = specPtr;
     elementClass->clientData = clientData;
     elementClass->elementRecord = ckalloc(specPtr->elementSize);
+    elementClass->cacheable = 0;
+    elementClass->stateSensitivity = (Ttk_State)~0u;
 
     /* Count #element resources:
      */
@@ -797,6 +837,36 @@ const char *Ttk_ElementClassName(Ttk_ElementClass *elementClass)
     return elementClass->name;
 }
 
+/*
+ * Ttk_SetElementCacheable --
+ *	Mark an element class as eligible for the pre-rendered pixmap cache.
+ *	Only appropriate for elements that paint every pixel of their parcel
+ *	and whose appearance is fully determined by the resolved element
+ *	options, the state, and the parcel size.
+ */
+void Ttk_SetElementCacheable(Ttk_ElementClass *eclass)
+{
+    eclass->cacheable = 1;
+}
+
+/*
+ * Ttk_SetElementStateSensitivity, Ttk_ElementStateSensitivity --
+ *	Set / query the set of state bits the element class inspects
+ *	directly in its size and draw procedures.  Elements whose
+ *	appearance depends on the state only through their resolved
+ *	options (via style maps) may declare a sensitivity of 0;
+ *	unmarked elements are treated as sensitive to every bit.
+ */
+void Ttk_SetElementStateSensitivity(Ttk_ElementClass *eclass, Ttk_State mask)
+{
+    eclass->stateSensitivity = mask;
+}
+
+Ttk_State Ttk_ElementStateSensitivity(Ttk_ElementClass *eclass)
+{
+    return eclass->stateSensitivity;
+}
+
 /*
  * Ttk_RegisterElementFactory --
  *	Register a new element factory.
@@ -1092,6 +1162,76 @@ Ttk_ElementSize(
 	tkwin, widthPtr, heightPtr, paddingPtr);
 }
 
+/* Parcels larger than this are drawn directly rather than cached,
+ * to keep server-side pixmap memory bounded.
+ */
+#define MAX_CACHEABLE_AREA (256*256)
+
+/*
+ * DrawCachedElement --
+ *	Draw a cacheable element by blitting a pre-rendered pixmap,
+ *	rendering the element into a fresh pixmap on a cache miss.
+ *	The cache key captures everything the element's draw procedure
+ *	can depend on: the element class, screen and depth, the display's
+ *	scaling epoch (pixel conversions inside the draw procedure depend
+ *	on the current [tk scaling] ratio), state, parcel size, and the
+ *	resolved option values in the element record.
+ *
+ * Returns:
+ *	1 if the element was drawn, 0 if the caller should draw directly
+ *	(e.g., no pixmap could be allocated).
+ */
+static int DrawCachedElement(
+    Ttk_ElementClass *eclass,		/* Element instance */
+    Ttk_ResourceCache cache,		/* Where pixmaps are cached */
+    Tk_Window tkwin,			/* The widget window. */
+    Drawable d,				/* Where to draw element. */
+    Ttk_Box b,				/* Element area */
+    Ttk_State state)			/* Widget or element state flags. */
+{
+    const Ttk_ElementOptionSpec *elementOption = eclass->specPtr->options;
+    Tcl_DString key;
+    char buf[3 * sizeof(void *) + 32];
+    Pixmap pixmap;
+    XGCValues gcValues;
+    GC gc;
+    int isNew, i;
+
+    Tcl_DStringInit(&key);
+    sprintf(buf, "%p %p %d %d %dx%d",
+	    (void *)eclass, (void *)Tk_Screen(tkwin), Tk_Depth(tkwin),
+	    ((TkWindow *) tkwin)->dispPtr->scalingEpoch,
+	    b.width, b.height);
+    Tcl_DStringAppend(&key, buf, -1);
+    sprintf(buf, " %x", (unsigned)state);
+    Tcl_DStringAppend(&key, buf, -1);
+    for (i = 0; i < eclass->nResources; ++i, ++elementOption) {
+	Tcl_Obj *value = *(Tcl_Obj **)
+	    ((char *)eclass->elementRecord + elementOption->offset);
+	sprintf(buf, " %p", (void *)value);
+	Tcl_DStringAppend(&key, buf, -1);
+    }
+
+    pixmap = Ttk_GetCachedPixmap(cache, tkwin,
+	    Tcl_DStringValue(&key), b.width, b.height, &isNew);
+    Tcl_DStringFree(&key);
+    if (pixmap == None) {
+	return 0;
+    }
+
+    if (isNew) {
+	eclass->specPtr->draw(
+	    eclass->clientData, eclass->elementRecord,
+	    tkwin, pixmap, Ttk_MakeBox(0, 0, b.width, b.height), state);
+    }
+
+    gc = Tk_GetGC(tkwin, 0, &gcValues);
+    XCopyArea(Tk_Display(tkwin), pixmap, d, gc,
+	    0, 0, (unsigned)b.width, (unsigned)b.height, b.x, b.y);
+    Tk_FreeGC(Tk_Display(tkwin), gc);
+    return 1;
+}
+
 /*
  * Ttk_DrawElement --
  *	Draw the given widget element in a given drawable area.
@@ -1115,6 +1255,12 @@ Ttk_DrawElement(
     {
 	return;
     }
+    if (eclass->cacheable
+	    && b.width * b.height <= MAX_CACHEABLE_AREA
+	    && DrawCachedElement(eclass, style->cache, tkwin, d, b, state))
+    {
+	return;
+    }
     eclass->specPtr->draw(
 	eclass->clientData, eclass->elementRecord,
 	tkwin, d, b, state);
@@ -1436,6 +1582,130 @@ static int StyleThemeCreateCmd(
     }
 }
 
+/* + style theme load $themeName $bundle --
+ *	Apply a whole bundle of style settings to a theme in a single call.
+ *	The bundle is a dictionary mapping style names to per-style
+ *	dictionaries with "configure", "map" and "layout" sections holding
+ *	the same data the corresponding [ttk::style] subcommands take.
+ *	Because the bundle is one literal value, activating a theme this way
+ *	is pure data loading: the Tcl parser sees it once and no commands
+ *	are evaluated per setting, unlike a conventional -settings script.
+ */
+static int StyleThemeLoadCmd(
+    ClientData clientData, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    StylePackageData *pkgPtr = (StylePackageData *)clientData;
+    static const char *const sectionStrings[] =
+	{ "configure", "layout", "map", NULL };
+    enum { SECTION_CONFIGURE, SECTION_LAYOUT, SECTION_MAP };
+    Ttk_Theme theme;
+    Tcl_Obj **styles, **sections, **settings;
+    int nStyles, nSections, nSettings, i, j, k;
+
+    if (objc != 5) {
+	Tcl_WrongNumArgs(interp, 3, objv, "theme bundle");
+	return TCL_ERROR;
+    }
+
+    theme = LookupTheme(interp, pkgPtr, Tcl_GetString(objv[3]));
+    if (!theme) {
+	return TCL_ERROR;
+    }
+
+    if (Tcl_ListObjGetElements(interp, objv[4], &nStyles, &styles)
+	    != TCL_OK) {
+	return TCL_ERROR;
+    }
+    if (nStyles % 2) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		"bundle must be a dictionary mapping styles to settings",
+		-1));
+	Tcl_SetErrorCode(interp, "TTK", "THEME", "BUNDLE", NULL);
+	return TCL_ERROR;
+    }
+
+    for (i = 0; i < nStyles; i += 2) {
+	Style *stylePtr = Ttk_GetStyle(theme, Tcl_GetString(styles[i]));
+
+	if (Tcl_ListObjGetElements(interp, styles[i+1],
+		&nSections, &sections) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (nSections % 2) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "settings for style %s must be a dictionary",
+		    Tcl_GetString(styles[i])));
+	    Tcl_SetErrorCode(interp, "TTK", "THEME", "BUNDLE", NULL);
+	    return TCL_ERROR;
+	}
+
+	for (j = 0; j < nSections; j += 2) {
+	    int section;
+
+	    if (Tcl_GetIndexFromObjStruct(interp, sections[j],
+		    sectionStrings, sizeof(char *), "section", 0, &section)
+		    != TCL_OK) {
+		return TCL_ERROR;
+	    }
+
+	    switch (section) {
+	    case SECTION_CONFIGURE:
+	    case SECTION_MAP: {
+		Tcl_HashTable *tablePtr = (section == SECTION_CONFIGURE)
+			? &stylePtr->defaultsTable
+			: &stylePtr->settingsTable;
+
+		if (Tcl_ListObjGetElements(interp, sections[j+1],
+			&nSettings, &settings) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		if (nSettings % 2) {
+		    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+			    "%s section for style %s must be a dictionary",
+			    sectionStrings[section],
+			    Tcl_GetString(styles[i])));
+		    Tcl_SetErrorCode(interp, "TTK", "THEME", "BUNDLE", NULL);
+		    return TCL_ERROR;
+		}
+		for (k = 0; k < nSettings; k += 2) {
+		    Tcl_Obj *value = settings[k+1];
+		    Tcl_HashEntry *entryPtr;
+		    int newEntry;
+
+		    if (section == SECTION_MAP
+			    && !Ttk_GetStateMapFromObj(interp, value)) {
+			return TCL_ERROR;
+		    }
+		    entryPtr = Tcl_CreateHashEntry(tablePtr,
+			    Tcl_GetString(settings[k]), &newEntry);
+		    Tcl_IncrRefCount(value);
+		    if (!newEntry) {
+			Tcl_DecrRefCount(
+				(Tcl_Obj *)Tcl_GetHashValue(entryPtr));
+		    }
+		    Tcl_SetHashValue(entryPtr, value);
+		}
+		break;
+	    }
+	    case SECTION_LAYOUT: {
+		Ttk_LayoutTemplate layoutTemplate =
+			Ttk_ParseLayoutTemplate(interp, sections[j+1]);
+
+		if (!layoutTemplate) {
+		    return TCL_ERROR;
+		}
+		Ttk_RegisterLayoutTemplate(theme,
+			Tcl_GetString(styles[i]), layoutTemplate);
+		break;
+	    }
+	    }
+	}
+    }
+
+    ThemeChanged(pkgPtr);
+    return TCL_OK;
+}
+
 /* + style theme names --
  * 	Return list of registered themes.
  */
@@ -1672,6 +1942,7 @@ StyleThemeUseCmd(
 
 static const Ttk_Ensemble StyleThemeEnsemble[] = {
     { "create", StyleThemeCreateCmd, 0 },
+    { "load", StyleThemeLoadCmd, 0 },
     { "names", StyleThemeNamesCmd, 0 },
     { "settings", StyleThemeSettingsCmd, 0 },
     { "styles", StyleThemeStylesCmd, 0 },
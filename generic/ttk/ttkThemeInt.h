@@ -13,6 +13,12 @@ typedef struct Ttk_TemplateNode_ Ttk_TemplateNode, *Ttk_LayoutTemplate;
 
 MODULE_SCOPE Ttk_ElementClass *Ttk_GetElement(Ttk_Theme, const char *name);
 MODULE_SCOPE const char *Ttk_ElementClassName(Ttk_ElementClass *);
+MODULE_SCOPE void Ttk_SetElementCacheable(Ttk_ElementClass *);
+MODULE_SCOPE void Ttk_SetElementStateSensitivity(Ttk_ElementClass *, Ttk_State);
+MODULE_SCOPE Ttk_State Ttk_ElementStateSensitivity(Ttk_ElementClass *);
+MODULE_SCOPE Ttk_State Ttk_StyleStateSensitivity(Ttk_Style);
+MODULE_SCOPE Ttk_State TtkStateMapSensitivity(Tcl_Obj *);
+MODULE_SCOPE Ttk_State Ttk_LayoutStateSensitivity(Ttk_Layout);
 
 MODULE_SCOPE void Ttk_ElementSize(
 	Ttk_ElementClass *, Ttk_Style, void *recordPtr, Tk_OptionTable,
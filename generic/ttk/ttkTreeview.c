@@ -54,6 +54,9 @@ struct TreeItemRec {
      */
     Ttk_TagSet	tagset;
     Ttk_ImageSpec *imagespec;
+    int 	rowCount;	/* Cached number of viewable rows in the
+				 * subtree rooted at this item, or -1 if
+				 * stale.  See CountRows. */
 };
 
 #define ITEM_OPTION_TAGS_CHANGED	0x100
@@ -101,6 +104,7 @@ static TreeItem *NewItem(void)
 
     item->tagset = NULL;
     item->imagespec = NULL;
+    item->rowCount = -1;
 
     return item;
 }
@@ -124,11 +128,27 @@ static void FreeItem(TreeItem *item)
 
 static void FreeItemCB(void *clientData) { FreeItem((TreeItem *)clientData); }
 
+/* + InvalidateRowCounts --
+ * 	Mark the cached row counts of an item and its ancestors stale.
+ * 	Must be called whenever the set of viewable rows below an item may
+ * 	have changed (insertion, deletion, open/close).  Stops as soon as
+ * 	it reaches an item that is already stale, so bursts of changes
+ * 	stay cheap.
+ */
+static void InvalidateRowCounts(TreeItem *item)
+{
+    while (item && item->rowCount >= 0) {
+	item->rowCount = -1;
+	item = item->parent;
+    }
+}
+
 /* + DetachItem --
  * 	Unlink an item from the tree.
  */
 static void DetachItem(TreeItem *item)
 {
+    InvalidateRowCounts(item->parent);
     if (item->parent && item->parent->children == item)
 	item->parent->children = item->next;
     if (item->prev)
@@ -159,6 +179,7 @@ static void InsertItem(TreeItem *parent, TreeItem *prev, TreeItem *item)
     if (item->next) {
 	item->next->prev = item;
     }
+    InvalidateRowCounts(parent);
 }
 
 /* + NextPreorder --
@@ -421,6 +442,10 @@ typedef struct {
     int nDisplayColumns;	/* #display columns */
     Ttk_Box headingArea;	/* Display area for column headings */
     Ttk_Box treeArea;   	/* Display area for tree */
+    int blitRowFirst;		/* Rows [blitRowFirst, blitRowLast) were
+				 * restored by scroll-blitting and need
+				 * not be redrawn; see TreeviewDisplay */
+    int blitRowLast;
     int slack;			/* Slack space (see Resizing section) */
 
 } TreePart;
@@ -1046,6 +1071,7 @@ static void TreeviewInitialize(Tcl_Interp *interp, void *recordPtr)
     /* Size parameters:
      */
     tv->tree.treeArea = tv->tree.headingArea = Ttk_MakeBox(0,0,0,0);
+    tv->tree.blitRowFirst = tv->tree.blitRowLast = 0;
     tv->tree.slack = 0;
 }
 
@@ -1173,6 +1199,9 @@ static int ConfigureItem(
 	int isOpen;
 	if (Tcl_GetBooleanFromObj(interp, item->openObj, &isOpen) != TCL_OK)
 	    goto error;
+	if (isOpen != ((item->state & TTK_STATE_OPEN) != 0)) {
+	    InvalidateRowCounts(item);
+	}
 	if (isOpen)
 	    item->state |= TTK_STATE_OPEN;
 	else
@@ -1291,12 +1320,17 @@ error:
  */
 
 /* + CountRows --
- * 	Returns the number of viewable rows rooted at item
+ * 	Returns the number of viewable rows rooted at item.
+ * 	The count is cached in item->rowCount; stale caches are recomputed
+ * 	here, so repeated queries over an unchanged tree are O(1).
  */
 static int CountRows(TreeItem *item)
 {
     int rows = 1;
 
+    if (item->rowCount >= 0) {
+	return item->rowCount;
+    }
     if (item->state & TTK_STATE_OPEN) {
 	TreeItem *child = item->children;
 	while (child) {
@@ -1304,6 +1338,7 @@ static int CountRows(TreeItem *item)
 	    child = child->next;
 	}
     }
+    item->rowCount = rows;
     return rows;
 }
 
@@ -1367,37 +1402,6 @@ static int IdentifyDisplayColumn(Treeview *tv, int x, int *x1)
     return -1;
 }
 
-/* + RowNumber --
- * 	Calculate which row the specified item appears on;
- * 	returns -1 if the item is not viewable.
- * 	Xref: DrawForest, IdentifyItem.
- */
-static int RowNumber(Treeview *tv, TreeItem *item)
-{
-    TreeItem *p = tv->tree.root->children;
-    int n = 0;
-
-    while (p) {
-	if (p == item)
-	    return n;
-
-	++n;
-
-	/* Find next viewable item in preorder traversal order
-	 */
-	if (p->children && (p->state & TTK_STATE_OPEN)) {
-	    p = p->children;
-	} else {
-	    while (!p->next && p && p->parent)
-		p = p->parent;
-	    if (p)
-		p = p->next;
-	}
-    }
-
-    return -1;
-}
-
 /* + ItemDepth -- return the depth of a tree item.
  * 	The depth of an item is equal to the number of proper ancestors,
  * 	not counting the root node.
@@ -1415,6 +1419,10 @@ static int ItemDepth(TreeItem *item)
 /* + ItemRow --
  * 	Returns row number of specified item relative to root,
  * 	-1 if item is not viewable.
+ * 	Uses the cached row counts of preceding siblings, so it runs in
+ * 	time proportional to the item's position in its sibling lists
+ * 	rather than to the number of rows above it.
+ * 	Xref: DrawForest, IdentifyItem.
  */
 static int ItemRow(Treeview *tv, TreeItem *p)
 {
@@ -1632,7 +1640,10 @@ static void TreeviewDoLayout(void *clientData)
     }
 
     visibleRows = tv->tree.treeArea.height / tv->tree.rowHeight;
-    tv->tree.root->state |= TTK_STATE_OPEN;
+    if (!(tv->tree.root->state & TTK_STATE_OPEN)) {
+	InvalidateRowCounts(tv->tree.root);
+	tv->tree.root->state |= TTK_STATE_OPEN;
+    }
     TtkScrolled(tv->tree.yscrollHandle,
 	    tv->tree.yscroll.first,
 	    tv->tree.yscroll.first + visibleRows,
@@ -1801,7 +1812,16 @@ static int DrawForest(	/* forward */
 static int DrawSubtree(
     Treeview *tv, TreeItem *item, Drawable d, int depth, int row)
 {
-    if (row >= tv->tree.yscroll.first) {
+    int rows = CountRows(item);
+
+    /* If the whole subtree lies above the viewport, skip it without
+     * visiting the descendants.
+     */
+    if (row + rows <= tv->tree.yscroll.first) {
+	return row + rows;
+    }
+    if (row >= tv->tree.yscroll.first
+	    && !(row >= tv->tree.blitRowFirst && row < tv->tree.blitRowLast)) {
 	DrawItem(tv, item, d, depth, row);
     }
 
@@ -1834,12 +1854,34 @@ static int DrawForest(
 static void TreeviewDisplay(void *clientData, Drawable d)
 {
     Treeview *tv = (Treeview *)clientData;
+    int rowHeight = tv->tree.rowHeight;
+    int origin = tv->tree.yscroll.first * rowHeight;
+    int validFirst, validLast;
 
     Ttk_DrawLayout(tv->core.layout, tv->core.state, d);
     if (tv->tree.showFlags & SHOW_HEADINGS) {
 	DrawHeadings(tv, d);
     }
+
+    /* When only the y view has moved since the last display,
+     * restore the still-visible rows by blitting and draw just the
+     * exposed ones.  The x scroll origin is passed as the stamp, so
+     * horizontal scrolls fall back to a full redraw.
+     */
+    tv->tree.blitRowFirst = tv->tree.blitRowLast = 0;
+    if (rowHeight > 0 && TtkScrollBlitBegin(
+	    tv->tree.yscrollHandle, d, tv->tree.treeArea,
+	    origin, tv->tree.xscroll.first, &validFirst, &validLast)) {
+	tv->tree.blitRowFirst = tv->tree.yscroll.first
+	    + (validFirst - tv->tree.treeArea.y + rowHeight - 1) / rowHeight;
+	tv->tree.blitRowLast = tv->tree.yscroll.first
+	    + (validLast - tv->tree.treeArea.y) / rowHeight;
+    }
+
     DrawForest(tv, tv->tree.root->children, d, 0,0);
+
+    TtkScrollBlitEnd(tv->tree.yscrollHandle, d, tv->tree.treeArea,
+	    origin, tv->tree.xscroll.first);
 }
 
 /*------------------------------------------------------------------------
@@ -2420,6 +2462,136 @@ static int TreeviewColumnCommand(
     }
 }
 
+/* + $tv autofit ?column column...? --
+ * 	Set the width of the specified columns (by default, all displayed
+ * 	columns) to fit their current contents, measuring cells in a single
+ * 	C pass.  Beyond AUTOFIT_SAMPLE_THRESHOLD rows only every Nth row is
+ * 	measured, which bounds the cost on very large trees while keeping
+ * 	the estimate accurate for typical data.
+ */
+#define AUTOFIT_SAMPLE_THRESHOLD 10000
+
+static int TreeviewAutofitCommand(
+    void *recordPtr, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Treeview *tv = (Treeview *)recordPtr;
+    Ttk_Padding cellPadding = {4, 0, 4, 0};
+    TreeColumn **targets;
+    int *widths;
+    TreeItem *item;
+    Tcl_Obj *fontObj;
+    Tk_Font font;
+    int nTargets, i, nRows, stride, rowno;
+
+    if (objc > 2) {
+	nTargets = objc - 2;
+	targets = (TreeColumn **)ckalloc(nTargets * sizeof(TreeColumn *));
+	for (i = 0; i < nTargets; ++i) {
+	    targets[i] = FindColumn(interp, tv, objv[2+i]);
+	    if (!targets[i]) {
+		ckfree(targets);
+		return TCL_ERROR;
+	    }
+	}
+    } else {
+	nTargets = tv->tree.nDisplayColumns - FirstColumn(tv);
+	if (nTargets <= 0) {
+	    return TCL_OK;
+	}
+	targets = (TreeColumn **)ckalloc(nTargets * sizeof(TreeColumn *));
+	for (i = 0; i < nTargets; ++i) {
+	    targets[i] = tv->tree.displayColumns[FirstColumn(tv) + i];
+	}
+    }
+
+    fontObj = Ttk_QueryOption(tv->core.layout, "-font", 0);
+    if (fontObj == NULL) {
+	fontObj = Tcl_NewStringObj("TkDefaultFont", -1);
+    }
+    Tcl_IncrRefCount(fontObj);
+    font = Tk_AllocFontFromObj(interp, tv->core.tkwin, fontObj);
+    Tcl_DecrRefCount(fontObj);
+    if (font == NULL) {
+	ckfree(targets);
+	return TCL_ERROR;
+    }
+
+    /* Start from the heading label so the title always stays readable:
+     */
+    widths = (int *)ckalloc(nTargets * sizeof(int));
+    for (i = 0; i < nTargets; ++i) {
+	widths[i] = 0;
+	if (targets[i]->headingObj) {
+	    int length;
+	    const char *text =
+		Tcl_GetStringFromObj(targets[i]->headingObj, &length);
+	    widths[i] = Tk_TextWidth(font, text, length);
+	}
+    }
+
+    nRows = 0;
+    for (item = tv->tree.root->children; item; item = NextPreorder(item)) {
+	++nRows;
+    }
+    stride = 1;
+    if (nRows > AUTOFIT_SAMPLE_THRESHOLD) {
+	stride = (nRows + AUTOFIT_SAMPLE_THRESHOLD - 1) / AUTOFIT_SAMPLE_THRESHOLD;
+    }
+
+    rowno = 0;
+    for (item = tv->tree.root->children; item;
+	    item = NextPreorder(item), ++rowno) {
+	if (rowno % stride) {
+	    continue;
+	}
+	for (i = 0; i < nTargets; ++i) {
+	    TreeColumn *column = targets[i];
+	    Tcl_Obj *textObj = NULL;
+	    int cellWidth = 0;
+
+	    if (column == &tv->tree.column0) {
+		textObj = item->textObj;
+		cellWidth = tv->tree.indent * (ItemDepth(item) + 1);
+	    } else if (item->valuesObj) {
+		Tcl_ListObjIndex(NULL, item->valuesObj,
+			column - tv->tree.columns, &textObj);
+	    }
+	    if (textObj) {
+		int length;
+		const char *text = Tcl_GetStringFromObj(textObj, &length);
+		cellWidth += Tk_TextWidth(font, text, length);
+	    }
+	    if (cellWidth > widths[i]) {
+		widths[i] = cellWidth;
+	    }
+	}
+    }
+
+    for (i = 0; i < nTargets; ++i) {
+	int width = widths[i] + Ttk_PaddingWidth(cellPadding);
+	if (width < targets[i]->minWidth) {
+	    width = targets[i]->minWidth;
+	}
+	targets[i]->width = width;
+    }
+
+    Tk_FreeFont(font);
+    ckfree(widths);
+    ckfree(targets);
+
+    /* Propagate the new widths the same way "column -width" does:
+     */
+    if (!Tk_IsMapped(tv->core.tkwin)) {
+	TtkResizeWidget(&tv->core);
+    } else {
+	RecomputeSlack(tv);
+	ResizeColumns(tv, TreeWidth(tv));
+    }
+    TtkRedisplayWidget(&tv->core);
+
+    return TCL_OK;
+}
+
 /* + $tv heading column ?options ....?
  * 	Heading data accessor
  */
@@ -2625,6 +2797,121 @@ static int TreeviewInsertCommand(
     return TCL_OK;
 }
 
+/* + $tv insertlist $parent $index {rowspec rowspec ...} --
+ * 	Insert a batch of new items in one call. Each rowspec is a list of
+ * 	the form ?-id id? ?-option value...?, as accepted by [$tv insert].
+ * 	The rows are inserted, in order, starting at $index; on error no
+ * 	items are inserted. Returns the list of new item IDs.
+ */
+static int TreeviewInsertlistCommand(
+    void *recordPtr, Tcl_Interp *interp, int objc, Tcl_Obj *const objv[])
+{
+    Treeview *tv = (Treeview *)recordPtr;
+    TreeItem *parent, *sibling, *newItem, *firstItem = NULL;
+    Tcl_Obj **rows, **specv, *result;
+    int nRows, specc, i;
+
+    if (objc != 5) {
+	Tcl_WrongNumArgs(interp, 2, objv, "parent index {rowspec ...}");
+	return TCL_ERROR;
+    }
+
+    /* Get parent node and previous sibling, as for [$tv insert]:
+     */
+    if ((parent = FindItem(interp, tv, objv[2])) == NULL) {
+	return TCL_ERROR;
+    }
+    if (!strcmp(Tcl_GetString(objv[3]), "end")) {
+	sibling = EndPosition(tv, parent);
+    } else {
+	int index;
+	if (Tcl_GetIntFromObj(interp, objv[3], &index) != TCL_OK)
+	    return TCL_ERROR;
+	sibling = InsertPosition(parent, index);
+    }
+    if (Tcl_ListObjGetElements(interp, objv[4], &nRows, &rows) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    result = Tcl_NewListObj(0, NULL);
+    Tcl_IncrRefCount(result);
+    for (i = 0; i < nRows; i++) {
+	Tcl_HashEntry *entryPtr;
+	int isNew;
+
+	if (Tcl_ListObjGetElements(interp, rows[i], &specc, &specv)
+		!= TCL_OK) {
+	    goto error;
+	}
+
+	/* Get node name, as for [$tv insert]:
+	 */
+	if (specc >= 2 && !strcmp("-id", Tcl_GetString(specv[0]))) {
+	    const char *itemName = Tcl_GetString(specv[1]);
+
+	    entryPtr = Tcl_CreateHashEntry(&tv->tree.items, itemName, &isNew);
+	    if (!isNew) {
+		Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "Item %s already exists", itemName));
+		Tcl_SetErrorCode(interp, "TTK", "TREE", "ITEM_EXISTS", NULL);
+		goto error;
+	    }
+	    specc -= 2; specv += 2;
+	} else {
+	    char idbuf[16];
+	    do {
+		++tv->tree.serial;
+		sprintf(idbuf, "I%03X", tv->tree.serial);
+		entryPtr = Tcl_CreateHashEntry(&tv->tree.items, idbuf, &isNew);
+	    } while (!isNew);
+	}
+
+	/* Create and configure new item:
+	 */
+	newItem = NewItem();
+	Tk_InitOptions(interp, (ClientData)newItem,
+		tv->tree.itemOptionTable, tv->core.tkwin);
+	newItem->tagset = Ttk_GetTagSetFromObj(NULL, tv->tree.tagTable, NULL);
+	if (ConfigureItem(interp, tv, newItem, specc, specv) != TCL_OK) {
+	    Tcl_DeleteHashEntry(entryPtr);
+	    FreeItem(newItem);
+	    goto error;
+	}
+
+	/* Store in hash table, link into tree after the previous row:
+	 */
+	Tcl_SetHashValue(entryPtr, newItem);
+	newItem->entryPtr = entryPtr;
+	InsertItem(parent, sibling, newItem);
+	sibling = newItem;
+	if (firstItem == NULL) {
+	    firstItem = newItem;
+	}
+	Tcl_ListObjAppendElement(NULL, result, ItemID(tv, newItem));
+    }
+
+    TtkRedisplayWidget(&tv->core);
+    Tcl_SetObjResult(interp, result);
+    Tcl_DecrRefCount(result);
+    return TCL_OK;
+
+error:
+    /* Unwind the items inserted before the failure, so that either the
+     * whole batch is inserted or none of it. sibling is the last item
+     * that was inserted.
+     */
+    while (firstItem != NULL) {
+	TreeItem *next = (firstItem == sibling) ? NULL : firstItem->next;
+
+	Tcl_DeleteHashEntry(firstItem->entryPtr);
+	DetachItem(firstItem);
+	FreeItem(firstItem);
+	firstItem = next;
+    }
+    Tcl_DecrRefCount(result);
+    return TCL_ERROR;
+}
+
 /* + $tv detach $item --
  * 	Unlink $item from the tree.
  */
@@ -2837,13 +3124,14 @@ static int TreeviewSeeCommand(
 	    parent->openObj = unshareObj(parent->openObj);
 	    Tcl_SetBooleanObj(parent->openObj, 1);
 	    parent->state |= TTK_STATE_OPEN;
+	    InvalidateRowCounts(parent);
 	    TtkRedisplayWidget(&tv->core);
 	}
     }
 
     /* Make sure item is visible:
      */
-    rowNumber = RowNumber(tv, item);
+    rowNumber = ItemRow(tv, item);
     if (rowNumber < tv->tree.yscroll.first) {
 	TtkScrollTo(tv->tree.yscrollHandle, rowNumber, 1);
     } else if (rowNumber >= tv->tree.yscroll.last) {
@@ -3281,6 +3569,7 @@ static const Ttk_Ensemble TreeviewTagCommands[] = {
  * +++ Widget commands record.
  */
 static const Ttk_Ensemble TreeviewCommands[] = {
+    { "autofit",	TreeviewAutofitCommand,0 },
     { "bbox",  		TreeviewBBoxCommand,0 },
     { "children",	TreeviewChildrenCommand,0 },
     { "cget",		TtkWidgetCgetCommand,0 },
@@ -3296,6 +3585,7 @@ static const Ttk_Ensemble TreeviewCommands[] = {
     { "identify",  	TreeviewIdentifyCommand,0 },
     { "index",  	TreeviewIndexCommand,0 },
     { "insert", 	TreeviewInsertCommand,0 },
+    { "insertlist",	TreeviewInsertlistCommand,0 },
     { "instate",	TtkWidgetInstateCommand,0 },
     { "item", 		TreeviewItemCommand,0 },
     { "move", 		TreeviewMoveCommand,0 },
@@ -89,33 +89,135 @@ static void EndDrawing(Tk_Window tkwin, Drawable d) { (void)tkwin; (void)d;}
 #endif
 
 /* DrawWidget --
- *	Redraw a widget.  Called as an idle handler.
+ *	Redraw a widget immediately.
  */
-static void DrawWidget(ClientData recordPtr)
+static void DrawWidget(WidgetCore *corePtr)
 {
-    WidgetCore *corePtr = (WidgetCore *)recordPtr;
-
     corePtr->flags &= ~REDISPLAY_PENDING;
     if (Tk_IsMapped(corePtr->tkwin)) {
 	Drawable d = BeginDrawing(corePtr->tkwin);
-	corePtr->widgetSpec->layoutProc(recordPtr);
-	corePtr->widgetSpec->displayProc(recordPtr, d);
+	corePtr->widgetSpec->layoutProc(corePtr);
+	corePtr->widgetSpec->displayProc(corePtr, d);
 	EndDrawing(corePtr->tkwin, d);
     }
 }
 
+/*------------------------------------------------------------------------
+ * +++ Cross-widget draw scheduling.
+ *
+ * Widgets awaiting redisplay are queued per thread and drawn together in
+ * a single idle callback, grouped by appearance (style, state, and size).
+ * The first widget of a group rendered populates the element pixmap cache
+ * (see ttkCache.c) and the rest of the group is stamped from it; drawing
+ * each group back to back keeps its pixmaps hot even when a theme change
+ * invalidates more distinct appearances than the cache can hold at once.
+ */
+
+typedef struct {
+    WidgetCore *headPtr;	/* First widget awaiting redisplay */
+    WidgetCore *tailPtr;	/* Last widget awaiting redisplay */
+    int idlePending;		/* DrawPendingWidgets() scheduled? */
+} DrawQueue;
+
+static Tcl_ThreadDataKey drawQueueKey;
+
+static DrawQueue *GetDrawQueue(void)
+{
+    return (DrawQueue *)Tcl_GetThreadData(&drawQueueKey, sizeof(DrawQueue));
+}
+
+/* RemoveFromDrawQueue --
+ *	Unlink a widget from the pending-redisplay queue, if present.
+ */
+static void RemoveFromDrawQueue(WidgetCore *corePtr)
+{
+    DrawQueue *queuePtr = GetDrawQueue();
+    WidgetCore *prevPtr = NULL;
+    WidgetCore **nextPtrPtr = &queuePtr->headPtr;
+
+    while (*nextPtrPtr != NULL) {
+	if (*nextPtrPtr == corePtr) {
+	    *nextPtrPtr = corePtr->nextRedisplayPtr;
+	    if (queuePtr->tailPtr == corePtr) {
+		queuePtr->tailPtr = prevPtr;
+	    }
+	    corePtr->nextRedisplayPtr = NULL;
+	    return;
+	}
+	prevPtr = *nextPtrPtr;
+	nextPtrPtr = &prevPtr->nextRedisplayPtr;
+    }
+}
+
+/* SameAppearance --
+ *	Whether two pending widgets render identically-shaped output:
+ *	same style, same state, same size.  Their unique content (text,
+ *	images) is keyed separately by the element pixmap cache.
+ */
+static int SameAppearance(WidgetCore *corePtr, WidgetCore *otherPtr)
+{
+    return corePtr->layout != NULL && otherPtr->layout != NULL
+	    && Ttk_LayoutStyle(corePtr->layout)
+		== Ttk_LayoutStyle(otherPtr->layout)
+	    && corePtr->state == otherPtr->state
+	    && Tk_Width(corePtr->tkwin) == Tk_Width(otherPtr->tkwin)
+	    && Tk_Height(corePtr->tkwin) == Tk_Height(otherPtr->tkwin);
+}
+
+/* DrawPendingWidgets --
+ *	Idle handler: drain the redisplay queue.  Each pass draws the
+ *	widget at the head of the queue and then the rest of its
+ *	appearance group, so every unique appearance is rendered once
+ *	and stamped into all matching widgets before moving on.
+ */
+static void DrawPendingWidgets(ClientData clientData)
+{
+    DrawQueue *queuePtr = (DrawQueue *)clientData;
+    WidgetCore *leadPtr, *scanPtr, *nextPtr;
+
+    queuePtr->idlePending = 0;
+    while (queuePtr->headPtr != NULL) {
+	leadPtr = queuePtr->headPtr;
+	RemoveFromDrawQueue(leadPtr);
+	DrawWidget(leadPtr);
+
+	for (scanPtr = queuePtr->headPtr; scanPtr != NULL;
+		scanPtr = nextPtr) {
+	    nextPtr = scanPtr->nextRedisplayPtr;
+	    if (SameAppearance(leadPtr, scanPtr)) {
+		RemoveFromDrawQueue(scanPtr);
+		DrawWidget(scanPtr);
+	    }
+	}
+    }
+}
+
 /* TtkRedisplayWidget --
- * 	Schedule redisplay as an idle handler.
+ * 	Schedule redisplay via the shared draw queue.
  */
 void TtkRedisplayWidget(WidgetCore *corePtr)
 {
+    DrawQueue *queuePtr;
+
     if (corePtr->flags & WIDGET_DESTROYED) {
 	return;
     }
 
+    corePtr->flags |= CONTENT_CHANGED;
     if (!(corePtr->flags & REDISPLAY_PENDING)) {
-	Tcl_DoWhenIdle(DrawWidget, corePtr);
+	queuePtr = GetDrawQueue();
+	corePtr->nextRedisplayPtr = NULL;
+	if (queuePtr->tailPtr != NULL) {
+	    queuePtr->tailPtr->nextRedisplayPtr = corePtr;
+	} else {
+	    queuePtr->headPtr = corePtr;
+	}
+	queuePtr->tailPtr = corePtr;
 	corePtr->flags |= REDISPLAY_PENDING;
+	if (!queuePtr->idlePending) {
+	    queuePtr->idlePending = 1;
+	    Tcl_DoWhenIdle(DrawPendingWidgets, queuePtr);
+	}
     }
 }
 
@@ -139,9 +241,16 @@ void TtkWidgetChangeState(WidgetCore *corePtr,
     unsigned int setBits, unsigned int clearBits)
 {
     Ttk_State oldState = corePtr->state;
+    Ttk_State changed;
+
     corePtr->state = (oldState & ~clearBits) | setBits;
-    if (corePtr->state ^ oldState) {
-	TtkRedisplayWidget(corePtr);
+    changed = corePtr->state ^ oldState;
+    if (changed) {
+	if (corePtr->layout == NULL
+		|| (changed & Ttk_LayoutStateSensitivity(corePtr->layout)))
+	{
+	    TtkRedisplayWidget(corePtr);
+	}
     }
 }
 
@@ -220,7 +329,8 @@ DestroyWidget(WidgetCore *corePtr)
     }
 
     if (corePtr->flags & REDISPLAY_PENDING) {
-	Tcl_CancelIdleCall(DrawWidget, corePtr);
+	corePtr->flags &= ~REDISPLAY_PENDING;
+	RemoveFromDrawQueue(corePtr);
     }
 
     corePtr->tkwin = NULL;
@@ -12,6 +12,9 @@
 #define WIDGET_DESTROYED	0x0001
 #define REDISPLAY_PENDING 	0x0002	/* scheduled call to RedisplayWidget */
 #define CURSOR_ON 		0x0020	/* See TtkBlinkCursor() */
+#define CONTENT_CHANGED 	0x0040	/* Redisplay was requested for
+					 * something other than scrolling;
+					 * see TtkScrollBlitBegin() */
 #define WIDGET_USER_FLAG        0x0100  /* 0x0100 - 0x8000 for user flags */
 
 /*
@@ -26,7 +29,7 @@
  */
 typedef struct WidgetSpec_ WidgetSpec;	/* Forward */
 
-typedef struct
+typedef struct WidgetCore_
 {
     Tk_Window tkwin;		/* Window associated with widget */
     Tcl_Interp *interp;		/* Interpreter associated with widget. */
@@ -45,6 +48,9 @@ typedef struct
 
     Ttk_State state;		/* Current widget state */
     unsigned int flags;		/* internal flags, see above */
+    struct WidgetCore_ *nextRedisplayPtr;
+				/* Next widget in the pending-redisplay
+				 * queue (see ttkWidget.c) */
 
 } WidgetCore;
 
@@ -197,6 +203,12 @@ MODULE_SCOPE void TtkScrollTo(ScrollHandle, int newFirst, int updateScrollInfo);
 MODULE_SCOPE void TtkScrolled(ScrollHandle, int first, int last, int total);
 MODULE_SCOPE void TtkScrollbarUpdateRequired(ScrollHandle);
 
+MODULE_SCOPE int TtkScrollBlitBegin(ScrollHandle, Drawable,
+    Ttk_Box area, int origin, int stamp,
+    int *validFirstPtr, int *validLastPtr);
+MODULE_SCOPE void TtkScrollBlitEnd(ScrollHandle, Drawable,
+    Ttk_Box area, int origin, int stamp);
+
 /*
  * Tag sets (work in progress, half-baked)
  */
@@ -206,6 +218,10 @@ typedef struct TtkTagTable *Ttk_TagTable;
 typedef struct TtkTagSet {	/* TODO: make opaque */
     Ttk_Tag	*tags;
     int 	nTags;
+    void	*cachedRecord;	/* Memoized Ttk_TagSetValues() result,
+				 * or NULL.  See ttkTagSet.c. */
+    int 	cacheEpoch;	/* Tag table epoch the memo was computed in;
+				 * the memo is stale if it differs. */
 } *Ttk_TagSet;
 
 MODULE_SCOPE Ttk_TagTable Ttk_CreateTagTable(
@@ -16,49 +16,27 @@
 # of a top-level and its non-top-level descendants, with the stacking
 # order determining the order of siblings.  The "-takefocus" options
 # on windows determine whether or not they should be skipped.
+# The traversal order itself is computed natively (and cached per
+# top-level) by ::tk::FocusTraversalOrder, so a keystroke doesn't
+# re-walk the widget hierarchy.
 #
 # Arguments:
 # w -		Name of a window.
 
 proc ::tk_focusNext w {
-    set cur $w
-    while {1} {
-
-	# Descend to just before the first child of the current widget.
-
-	set parent $cur
-	set children [winfo children $cur]
-	set i -1
-
-	# Look for the next sibling that isn't a top-level.
-
-	while {1} {
-	    incr i
-	    if {$i < [llength $children]} {
-		set cur [lindex $children $i]
-		if {[winfo toplevel $cur] eq $cur} {
-		    continue
-		} else {
-		    break
-		}
-	    }
-
-	    # No more siblings, so go to the current widget's parent.
-	    # If it's a top-level, break out of the loop, otherwise
-	    # look for its next sibling.
-
-	    set cur $parent
-	    if {[winfo toplevel $cur] eq $cur} {
-		break
-	    }
-	    set parent [winfo parent $parent]
-	    set children [winfo children $parent]
-	    set i [lsearch -exact $children $cur]
-	}
+    set order [tk::FocusTraversalOrder $w]
+    set n [llength $order]
+    if {$n == 0} {
+	return $w
+    }
+    set i [lsearch -exact $order $w]
+    for {set j 1} {$j <= $n} {incr j} {
+	set cur [lindex $order [expr {($i + $j) % $n}]]
 	if {$w eq $cur || [tk::FocusOK $cur]} {
 	    return $cur
 	}
     }
+    return $w
 }
 
 # ::tk_focusPrev --
@@ -68,48 +46,30 @@ proc ::tk_focusNext w {
 # of a top-level and its non-top-level descendants, with the stacking
 # order determining the order of siblings.  The "-takefocus" options
 # on windows determine whether or not they should be skipped.
+# The traversal order itself is computed natively (and cached per
+# top-level) by ::tk::FocusTraversalOrder, so a keystroke doesn't
+# re-walk the widget hierarchy.
 #
 # Arguments:
 # w -		Name of a window.
 
 proc ::tk_focusPrev w {
-    set cur $w
-    while {1} {
-
-	# Collect information about the current window's position
-	# among its siblings.  Also, if the window is a top-level,
-	# then reposition to just after the last child of the window.
-
-	if {[winfo toplevel $cur] eq $cur}  {
-	    set parent $cur
-	    set children [winfo children $cur]
-	    set i [llength $children]
-	} else {
-	    set parent [winfo parent $cur]
-	    set children [winfo children $parent]
-	    set i [lsearch -exact $children $cur]
-	}
-
-	# Go to the previous sibling, then descend to its last descendant
-	# (highest in stacking order.  While doing this, ignore top-levels
-	# and their descendants.  When we run out of descendants, go up
-	# one level to the parent.
-
-	while {$i > 0} {
-	    incr i -1
-	    set cur [lindex $children $i]
-	    if {[winfo toplevel $cur] eq $cur} {
-		continue
-	    }
-	    set parent $cur
-	    set children [winfo children $parent]
-	    set i [llength $children]
-	}
-	set cur $parent
+    set order [tk::FocusTraversalOrder $w]
+    set n [llength $order]
+    if {$n == 0} {
+	return $w
+    }
+    set i [lsearch -exact $order $w]
+    if {$i < 0} {
+	set i 0
+    }
+    for {set j 1} {$j <= $n} {incr j} {
+	set cur [lindex $order [expr {($i - $j) % $n}]]
 	if {$w eq $cur || [tk::FocusOK $cur]} {
 	    return $cur
 	}
     }
+    return $w
 }
 
 # ::tk::FocusOK --
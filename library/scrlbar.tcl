@@ -307,9 +307,14 @@ proc ::tk::ScrollEndDrag {w x y} {
 # amount -	How many units to scroll:  typically 1 or -1.
 
 proc ::tk::ScrollByUnits {w orient amount {factor 1.0}} {
+    if {[string first [string index [$w cget -orient] 0] $orient] < 0} {
+	return
+    }
+    if {[$w dispatch scroll [expr {$amount/$factor}] units]} {
+	return
+    }
     set cmd [$w cget -command]
-    if {$cmd eq "" || ([string first \
-	    [string index [$w cget -orient] 0] $orient] < 0)} {
+    if {$cmd eq ""} {
 	return
     }
     set info [$w get]
@@ -332,9 +337,14 @@ proc ::tk::ScrollByUnits {w orient amount {factor 1.0}} {
 # amount -	How many screens to scroll:  typically 1 or -1.
 
 proc ::tk::ScrollByPages {w orient amount} {
+    if {[string first [string index [$w cget -orient] 0] $orient] < 0} {
+	return
+    }
+    if {[$w dispatch scroll $amount pages]} {
+	return
+    }
     set cmd [$w cget -command]
-    if {$cmd eq "" || ([string first \
-	    [string index [$w cget -orient] 0] $orient] < 0)} {
+    if {$cmd eq ""} {
 	return
     }
     set info [$w get]
@@ -356,6 +366,9 @@ proc ::tk::ScrollByPages {w orient amount} {
 #		in the document.
 
 proc ::tk::ScrollToPos {w pos} {
+    if {[$w dispatch moveto $pos]} {
+	return
+    }
     set cmd [$w cget -command]
     if {$cmd eq ""} {
 	return
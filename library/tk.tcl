@@ -497,16 +497,104 @@ if {$::tk_library ne ""} {
     }
     namespace eval ::tk {
 	SourceLibFile icons
-	SourceLibFile button
-	SourceLibFile entry
-	SourceLibFile listbox
-	SourceLibFile menu
-	SourceLibFile panedwindow
-	SourceLibFile scale
-	SourceLibFile scrlbar
-	SourceLibFile spinbox
 	SourceLibFile systray
-	SourceLibFile text
+
+	# The remaining library files only define the class bindings for one
+	# widget class each (and the procedures behind them), so applications
+	# and sub-interpreters that never create a given widget need not pay
+	# for parsing its bindings at startup.  Each file is sourced the
+	# first time one of its widget creation commands actually runs, or
+	# the first time [bind] or [bindtags] names one of its classes;
+	# triggering on [bind] makes startup-time customizations layer on
+	# top of the class defaults instead of being overwritten when the
+	# file finally loads, and keeps introspection accurate.
+	variable LazyFiles;	# Maps each deferred library file to the
+				# creation commands that are traced for it.
+	variable LazyClass;	# Maps each widget class bind tag to the
+				# deferred library file that defines it.
+	array set LazyClass {
+	    Button	button		Checkbutton	button
+	    Radiobutton	button		Entry		entry
+	    Listbox	listbox		Menu		menu
+	    Menubutton	menu		Panedwindow	panedwindow
+	    Scale	scale		Scrollbar	scrlbar
+	    Spinbox	spinbox		Text		text
+	}
+	proc LazyLoad {file} {
+	    variable LazyFiles
+	    variable LazyClass
+	    if {![info exists LazyFiles($file)]} {
+		return
+	    }
+	    foreach name $LazyFiles($file) {
+		catch {
+		    trace remove execution $name enter \
+			    [list ::tk::LazyFileTrace $file]
+		}
+	    }
+	    unset LazyFiles($file)
+	    foreach class [array names LazyClass] {
+		if {$LazyClass($class) eq $file} {
+		    unset LazyClass($class)
+		}
+	    }
+	    if {![array size LazyFiles]} {
+		foreach cmd {::bind ::bindtags} {
+		    catch {
+			trace remove execution $cmd enter ::tk::LazyClassTouch
+		    }
+		}
+	    }
+	    SourceLibFile $file
+	}
+	proc LazyFileTrace {file args} {
+	    LazyLoad $file
+	}
+	proc LazyClassTouch {cmdString args} {
+	    variable LazyClass
+	    if {[namespace tail [lindex $cmdString 0]] eq "bindtags"} {
+		set tags [lindex $cmdString 2]
+	    } else {
+		set tags [list [lindex $cmdString 1]]
+	    }
+	    foreach tag $tags {
+		if {[info exists LazyClass($tag)]} {
+		    LazyLoad $LazyClass($tag)
+		}
+	    }
+	}
+	foreach {file classCmds} {
+	    button	{button checkbutton radiobutton}
+	    entry	{entry}
+	    listbox	{listbox}
+	    menu	{menu menubutton}
+	    panedwindow	{panedwindow}
+	    scale	{scale}
+	    scrlbar	{scrollbar}
+	    spinbox	{spinbox}
+	    text	{text}
+	} {
+	    # Cover the classic ::tk::* aliases of each creation command
+	    # too; either spelling must pull in the bindings.  In safe
+	    # interpreters some of the commands are hidden, hence the
+	    # existence checks.
+	    set names {}
+	    foreach cmd $classCmds {
+		foreach name [list ::$cmd ::tk::$cmd] {
+		    if {[llength [info commands $name]]} {
+			lappend names $name
+		    }
+		}
+	    }
+	    set LazyFiles($file) $names
+	    foreach name $names {
+		trace add execution $name enter [list ::tk::LazyFileTrace $file]
+	    }
+	}
+	foreach cmd {::bind ::bindtags} {
+	    trace add execution $cmd enter ::tk::LazyClassTouch
+	}
+	unset -nocomplain file classCmds names cmd name
     }
 }
 
@@ -710,6 +798,11 @@ set ::tk::Priv(IMETextMark) [dict create]
 if {$::ttk::library ne ""} {
     uplevel \#0 [list source -encoding utf-8 $::ttk::library/ttk.tcl]
 }
+
+# Resolve the predefined bitmaps and standard cursors during idle time, so
+# that the first widget to use one of them does not block on it.
+
+catch {tk resourcecache warm}
 
 # Local Variables:
 # mode: tcl
@@ -131,6 +131,8 @@
 #define DEF_CANVAS_INSERT_OFF_TIME	"300"
 #define DEF_CANVAS_INSERT_ON_TIME	"600"
 #define DEF_CANVAS_INSERT_WIDTH		"2"
+#define DEF_CANVAS_LOD_COLOR		BLACK
+#define DEF_CANVAS_LOD_THRESHOLD	"0"
 #define DEF_CANVAS_RELIEF		"flat"
 #define DEF_CANVAS_SCROLL_REGION	""
 #define DEF_CANVAS_SELECT_COLOR		SELECT_BG
@@ -245,6 +247,8 @@
 #define DEF_LISTBOX_BG_MONO		WHITE
 #define DEF_LISTBOX_BORDER_WIDTH	"1"
 #define DEF_LISTBOX_CURSOR		""
+#define DEF_LISTBOX_DATA_COMMAND	""
+#define DEF_LISTBOX_DATA_SIZE		"0"
 #define DEF_LISTBOX_DISABLED_FG		DISABLED
 #define DEF_LISTBOX_EXPORT_SELECTION	"1"
 #define DEF_LISTBOX_FONT		"TkTextFont"
@@ -501,6 +505,7 @@
 #define DEF_TEXT_FG			NORMAL_FG
 #define DEF_TEXT_EXPORT_SELECTION	"1"
 #define DEF_TEXT_FONT			"TkFixedFont"
+#define DEF_TEXT_GUTTER		"0"
 #define DEF_TEXT_HEIGHT			"24"
 #define DEF_TEXT_HIGHLIGHT_BG		NORMAL_BG
 #define DEF_TEXT_HIGHLIGHT		BLACK
@@ -513,6 +518,7 @@
 #define DEF_TEXT_INSERT_UNFOCUSSED	"none"
 #define DEF_TEXT_INSERT_WIDTH		"1"
 #define DEF_TEXT_MAX_UNDO		"0"
+#define DEF_TEXT_MAX_UNDO_SIZE		"0"
 #define DEF_TEXT_PADX			"1"
 #define DEF_TEXT_PADY			"1"
 #define DEF_TEXT_RELIEF			"flat"
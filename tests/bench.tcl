@@ -0,0 +1,237 @@
+# bench.tcl --
+#
+# Microbenchmark suite for core hot paths: canvas item churn and tag
+# searching, text relayout, font measurement, photo blits and binding
+# dispatch. The correctness tests in this directory say nothing about
+# performance, so regressions in these paths used to ship silently; this
+# script gives CI a number to trend.
+#
+# Run it via "make bench" in the unix build directory, or directly:
+#
+#	tktest bench.tcl ?-match pattern? ?-iters count?
+#
+# Each benchmark prints exactly one machine-readable line:
+#
+#	BENCH <name> ns_per_op <n> bytes_per_op <b> iters <k>
+#
+# bytes_per_op is "na" unless the interpreter was compiled with
+# TCL_MEM_DEBUG (which provides the [memory] command).
+#
+# Copyright © 2026 Tk Core Team.
+#
+# See the file "license.terms" for information on usage and redistribution of
+# this file, and for a DISCLAIMER OF ALL WARRANTIES.
+
+package require Tk
+
+set benchMatch *
+set benchIters 0
+foreach {opt val} $argv {
+    switch -- $opt {
+	-match { set benchMatch $val }
+	-iters { set benchIters $val }
+	-geometry { }
+	default {
+	    puts stderr "unknown option \"$opt\": must be -match or -iters"
+	    exit 1
+	}
+    }
+}
+
+# benchBytes --
+#	Returns the number of bytes currently allocated, or -1 when the
+#	interpreter was not built with memory debugging.
+
+proc benchBytes {} {
+    if {[llength [info commands memory]] == 0} {
+	return -1
+    }
+    foreach line [split [memory info] \n] {
+	if {[string match "current bytes allocated*" $line]} {
+	    return [lindex $line end]
+	}
+    }
+    return -1
+}
+
+# bench --
+#	Runs one benchmark: evaluates setup, calibrates the iteration count
+#	so a measurement lasts roughly 0.2 s (unless -iters was given),
+#	measures, reports and evaluates cleanup. All scripts run at global
+#	level so benchmarks can share state through global variables.
+
+proc bench {name setup script cleanup} {
+    global benchMatch benchIters
+    if {![string match $benchMatch $name]} {
+	return
+    }
+    uplevel #0 $setup
+    uplevel #0 $script
+    set iters $benchIters
+    if {$iters == 0} {
+	set iters 1
+	while {1} {
+	    set us [lindex [time {uplevel #0 $script} $iters] 0]
+	    if {$us * $iters >= 200000 || $iters >= 100000} {
+		break
+	    }
+	    set iters [expr {$iters * 10}]
+	}
+    }
+    set before [benchBytes]
+    set us [lindex [time {uplevel #0 $script} $iters] 0]
+    set after [benchBytes]
+    if {$before < 0} {
+	set bytes na
+    } else {
+	set bytes [expr {max(0, ($after - $before) / $iters)}]
+    }
+    puts "BENCH $name ns_per_op [expr {round($us * 1000)}]\
+	    bytes_per_op $bytes iters $iters"
+    uplevel #0 $cleanup
+}
+
+wm geometry . 400x300+0+0
+update
+
+# Canvas: item creation, modification and deletion.
+
+bench canvas.item-churn {
+    canvas .c -width 400 -height 300
+    pack .c
+    update
+} {
+    set id [.c create rectangle 10 10 50 50 -fill red -tags churn]
+    .c move $id 3 4
+    .c delete $id
+} {
+    destroy .c
+}
+
+# Canvas: tag searching over a large display list (TagSearchNext).
+
+bench canvas.find-withtag {
+    canvas .c -width 400 -height 300
+    for {set i 0} {$i < 1000} {incr i} {
+	.c create rectangle $i 0 [expr {$i + 5}] 5 \
+		-tags [expr {$i % 2 ? "odd" : "even"}]
+    }
+} {
+    .c find withtag odd
+} {
+    destroy .c
+}
+
+# Canvas: incremental redraw after moving every item.
+
+bench canvas.redraw {
+    canvas .c -width 400 -height 300
+    pack .c
+    for {set i 0} {$i < 200} {incr i} {
+	.c create oval [expr {$i % 20 * 20}] [expr {$i / 20 * 20}] \
+		[expr {$i % 20 * 20 + 15}] [expr {$i / 20 * 20 + 15}] \
+		-fill blue
+    }
+    update
+} {
+    .c move all 1 0
+    .c move all -1 0
+    update idletasks
+} {
+    destroy .c
+}
+
+# Text: relayout of wrapped lines (LayoutDLine).
+
+bench text.relayout {
+    text .t -width 40 -height 15 -wrap word
+    pack .t
+    for {set i 0} {$i < 200} {incr i} {
+	.t insert end [string repeat "lorem ipsum dolor sit amet " 4]\n
+    }
+    update
+} {
+    .t insert 1.0 "x"
+    .t delete 1.0 1.1
+    .t count -update -ypixels 1.0 end
+} {
+    destroy .t
+}
+
+# Text: redisplay after tagging and untagging visible lines.
+
+bench text.redraw {
+    text .t -width 40 -height 15
+    pack .t
+    .t tag configure hl -background yellow
+    for {set i 0} {$i < 50} {incr i} {
+	.t insert end "line $i with some sample text on it\n"
+    }
+    update
+} {
+    .t tag add hl 1.0 10.end
+    update idletasks
+    .t tag remove hl 1.0 end
+    update idletasks
+} {
+    destroy .t
+}
+
+# Font: string measurement (Tk_MeasureChars).
+
+bench font.measure {
+    set ::benchString [string repeat "The quick brown fox " 20]
+} {
+    font measure TkDefaultFont $::benchString
+} {
+    unset ::benchString
+}
+
+# Photo: block copy between images.
+
+bench photo.copy {
+    image create photo benchSrc -width 200 -height 200
+    benchSrc put [string repeat "{[string repeat "#3366cc " 200]} " 200]
+    image create photo benchDst -width 200 -height 200
+} {
+    benchDst copy benchSrc -from 0 0 200 200
+} {
+    image delete benchSrc benchDst
+}
+
+# Photo: redisplay after modifying a displayed image
+# (TkImgPhotoDisplay and the dithering underneath it).
+
+bench photo.display {
+    image create photo benchImg -width 200 -height 200
+    benchImg put [string repeat "{[string repeat "#cc6633 " 200]} " 200]
+    label .l -image benchImg
+    pack .l
+    update
+    set ::benchFlip 0
+} {
+    benchImg put [expr {[incr ::benchFlip] % 2 ? "#ff0000" : "#00ff00"}] \
+	    -to 0 0 16 16
+    update idletasks
+} {
+    destroy .l
+    image delete benchImg
+    unset ::benchFlip
+}
+
+# Bindings: virtual event dispatch through Tk_HandleEvent and TkBindEventProc.
+
+bench bind.dispatch {
+    frame .f
+    pack .f
+    bind .f <<Bench>> {incr ::benchCount}
+    set ::benchCount 0
+    update
+} {
+    event generate .f <<Bench>>
+} {
+    destroy .f
+    unset ::benchCount
+}
+
+exit 0
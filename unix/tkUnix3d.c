@@ -216,6 +216,9 @@ Tk_3DHorizontalBevel(
     Display *display = Tk_Display(tkwin);
     int bottom, halfway, x1, x2, x1Delta, x2Delta;
     UnixBorder *unixBorderPtr = (UnixBorder *) borderPtr;
+    XRectangle rects[64];
+    int numRects = 0;
+    GC currentGC;
     GC topGC = NULL, bottomGC = NULL;
 				/* Initializations needed only to prevent
 				 * compiler warnings. */
@@ -281,10 +284,15 @@ Tk_3DHorizontalBevel(
     bottom = y + height;
 
     /*
-     * Draw one line for each y-coordinate covered by the bevel.
+     * Compute one scan line for each y-coordinate covered by the bevel, and
+     * hand them to the server in batches (one XFillRectangles per run of
+     * lines sharing a GC) rather than as one request per line.
      */
 
+    currentGC = topGC;
     for ( ; y < bottom; y++) {
+	GC lineGC = (y < halfway) ? topGC : bottomGC;
+
 	/*
 	 * X Dimensions are 16-bit, so avoid wraparound or display errors by
 	 * limiting these here.
@@ -303,13 +311,27 @@ Tk_3DHorizontalBevel(
 	 */
 
 	if (x1 < x2) {
-	    XFillRectangle(display, drawable,
-		    (y < halfway) ? topGC : bottomGC, x1, y,
-		    (unsigned) (x2-x1), (unsigned) 1);
+	    if ((lineGC != currentGC)
+		    || (numRects >= (int) (sizeof(rects)/sizeof(rects[0])))) {
+		if (numRects > 0) {
+		    XFillRectangles(display, drawable, currentGC, rects,
+			    numRects);
+		    numRects = 0;
+		}
+		currentGC = lineGC;
+	    }
+	    rects[numRects].x = (short) x1;
+	    rects[numRects].y = (short) y;
+	    rects[numRects].width = (unsigned short) (x2-x1);
+	    rects[numRects].height = 1;
+	    numRects++;
 	}
 	x1 += x1Delta;
 	x2 += x2Delta;
     }
+    if (numRects > 0) {
+	XFillRectangles(display, drawable, currentGC, rects, numRects);
+    }
 }
 
 /*
@@ -31,6 +31,15 @@ typedef struct UnixButton {
     TkButton info;		/* Generic button info. */
 } UnixButton;
 
+/*
+ * Forward declarations for functions defined later in this file:
+ */
+
+static void		ComputeButtonContentPlacement(TkButton *butPtr,
+			    int relief);
+static void		ShiftByOffset(TkButton *butPtr, int relief,
+			    int *x, int *y, int width, int height);
+
 /*
  * The class function table for the button widgets.
  */
@@ -331,6 +340,172 @@ TkpCreateButton(
     return (TkButton *)ckalloc(sizeof(UnixButton));
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * ComputeButtonContentPlacement --
+ *
+ *	Compute where the button's text and image/bitmap go for the current
+ *	window size and effective relief, and store the result on the button
+ *	record. The display procedure reuses the stored placement until the
+ *	window size, the relief or the button's geometry inputs change.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The place* fields of butPtr are updated and marked valid.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ComputeButtonContentPlacement(
+    TkButton *butPtr,		/* Button whose placement to compute. */
+    int relief)			/* Effective relief; it shifts the content on
+				 * plain buttons. */
+{
+    Tk_Window tkwin = butPtr->tkwin;
+    int x = 0, y = 0;
+    int width = 0, height = 0, fullWidth, fullHeight;
+    int textXOffset, textYOffset;
+    int imageXOffset = 0, imageYOffset = 0;
+    int haveImage = 0, haveText;
+
+    if (butPtr->image != NULL) {
+	Tk_SizeOfImage(butPtr->image, &width, &height);
+	haveImage = 1;
+    } else if (butPtr->bitmap != None) {
+	Tk_SizeOfBitmap(butPtr->display, butPtr->bitmap, &width, &height);
+	haveImage = 1;
+    }
+    haveText = (butPtr->textWidth != 0 && butPtr->textHeight != 0);
+
+    if (butPtr->compound != COMPOUND_NONE && haveImage && haveText) {
+	textXOffset = 0;
+	textYOffset = 0;
+	fullWidth = 0;
+	fullHeight = 0;
+
+	switch ((enum compound) butPtr->compound) {
+	case COMPOUND_TOP:
+	case COMPOUND_BOTTOM:
+	    /*
+	     * Image is above or below text.
+	     */
+
+	    if (butPtr->compound == COMPOUND_TOP) {
+		textYOffset = height + butPtr->padY;
+	    } else {
+		imageYOffset = butPtr->textHeight + butPtr->padY;
+	    }
+	    fullHeight = height + butPtr->textHeight + butPtr->padY;
+	    fullWidth = (width > butPtr->textWidth ? width :
+		    butPtr->textWidth);
+	    textXOffset = (fullWidth - butPtr->textWidth)/2;
+	    imageXOffset = (fullWidth - width)/2;
+	    break;
+	case COMPOUND_LEFT:
+	case COMPOUND_RIGHT:
+	    /*
+	     * Image is left or right of text.
+	     */
+
+	    if (butPtr->compound == COMPOUND_LEFT) {
+		textXOffset = width + butPtr->padX;
+	    } else {
+		imageXOffset = butPtr->textWidth + butPtr->padX;
+	    }
+	    fullWidth = butPtr->textWidth + butPtr->padX + width;
+	    fullHeight = (height > butPtr->textHeight ? height :
+		    butPtr->textHeight);
+	    textYOffset = (fullHeight - butPtr->textHeight)/2;
+	    imageYOffset = (fullHeight - height)/2;
+	    break;
+	case COMPOUND_CENTER:
+	    /*
+	     * Image and text are superimposed.
+	     */
+
+	    fullWidth = (width > butPtr->textWidth ? width :
+		    butPtr->textWidth);
+	    fullHeight = (height > butPtr->textHeight ? height :
+		    butPtr->textHeight);
+	    textXOffset = (fullWidth - butPtr->textWidth)/2;
+	    imageXOffset = (fullWidth - width)/2;
+	    textYOffset = (fullHeight - butPtr->textHeight)/2;
+	    imageYOffset = (fullHeight - height)/2;
+	    break;
+	case COMPOUND_NONE:
+	    break;
+	}
+
+	TkComputeAnchor(butPtr->anchor, tkwin, butPtr->padX, butPtr->padY,
+		butPtr->indicatorSpace + fullWidth, fullHeight, &x, &y);
+
+	x += butPtr->indicatorSpace;
+	ShiftByOffset(butPtr, relief, &x, &y, width, height);
+	imageXOffset += x;
+	imageYOffset += y;
+	butPtr->placeTextX = x + textXOffset;
+	butPtr->placeTextY = y + textYOffset;
+    } else if (haveImage) {
+	TkComputeAnchor(butPtr->anchor, tkwin, 0, 0,
+		butPtr->indicatorSpace + width, height, &x, &y);
+	x += butPtr->indicatorSpace;
+	ShiftByOffset(butPtr, relief, &x, &y, width, height);
+	imageXOffset += x;
+	imageYOffset += y;
+	butPtr->placeTextX = x;
+	butPtr->placeTextY = y;
+    } else {
+	TkComputeAnchor(butPtr->anchor, tkwin, butPtr->padX, butPtr->padY,
+		butPtr->indicatorSpace + butPtr->textWidth,
+		butPtr->textHeight, &x, &y);
+	x += butPtr->indicatorSpace;
+	ShiftByOffset(butPtr, relief, &x, &y, width, height);
+	butPtr->placeTextX = x;
+	butPtr->placeTextY = y;
+    }
+
+    if (butPtr->image != NULL) {
+	/*
+	 * Do boundary clipping, so that Tk_RedrawImage is passed valid
+	 * coordinates. [Bug 979239]
+	 */
+
+	if (imageXOffset < 0) {
+	    imageXOffset = 0;
+	}
+	if (imageYOffset < 0) {
+	    imageYOffset = 0;
+	}
+	if (width > Tk_Width(tkwin)) {
+	    width = Tk_Width(tkwin);
+	}
+	if (height > Tk_Height(tkwin)) {
+	    height = Tk_Height(tkwin);
+	}
+	if ((width + imageXOffset) > Tk_Width(tkwin)) {
+	    imageXOffset = Tk_Width(tkwin) - width;
+	}
+	if ((height + imageYOffset) > Tk_Height(tkwin)) {
+	    imageYOffset = Tk_Height(tkwin) - height;
+	}
+    }
+
+    butPtr->placeX = x;
+    butPtr->placeY = y;
+    butPtr->placeImageX = imageXOffset;
+    butPtr->placeImageY = imageYOffset;
+    butPtr->placeImageDrawW = width;
+    butPtr->placeImageDrawH = height;
+    butPtr->placeWidth = Tk_Width(tkwin);
+    butPtr->placeHeight = Tk_Height(tkwin);
+    butPtr->placeRelief = relief;
+    butPtr->placeValid = 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -398,15 +573,10 @@ TkpDisplayButton(
     GC gc;
     Tk_3DBorder border;
     Pixmap pixmap;
-    int x = 0;			/* Initialization only needed to stop compiler
-				 * warning. */
-    int y, relief;
+    int x, y, relief;
     Tk_Window tkwin = butPtr->tkwin;
-    int width = 0, height = 0, fullWidth, fullHeight;
-    int textXOffset, textYOffset;
     int haveImage = 0, haveText = 0;
-    int imageWidth, imageHeight;
-    int imageXOffset = 0, imageYOffset = 0;
+    int imageWidth = 0, imageHeight = 0;
 				/* image information that will be used to
 				 * restrict disabled pixmap as well */
 
@@ -480,203 +650,62 @@ TkpDisplayButton(
 	    Tk_Height(tkwin), 0, TK_RELIEF_FLAT);
 
     /*
-     * Display image or bitmap or text for button.
+     * Display image or bitmap or text for button. The placement of the
+     * content only depends on the window size and the effective relief, so
+     * it is computed once and cached on the button record; state-only
+     * redraws (e.g. mouse-over highlighting) reuse the cached placement.
      */
 
     if (butPtr->image != NULL) {
-	Tk_SizeOfImage(butPtr->image, &width, &height);
+	Tk_SizeOfImage(butPtr->image, &imageWidth, &imageHeight);
 	haveImage = 1;
     } else if (butPtr->bitmap != None) {
-	Tk_SizeOfBitmap(butPtr->display, butPtr->bitmap, &width, &height);
+	Tk_SizeOfBitmap(butPtr->display, butPtr->bitmap, &imageWidth,
+		&imageHeight);
 	haveImage = 1;
     }
-    imageWidth = width;
-    imageHeight = height;
-
     haveText = (butPtr->textWidth != 0 && butPtr->textHeight != 0);
 
-    if (butPtr->compound != COMPOUND_NONE && haveImage && haveText) {
-	textXOffset = 0;
-	textYOffset = 0;
-	fullWidth = 0;
-	fullHeight = 0;
-
-	switch ((enum compound) butPtr->compound) {
-	case COMPOUND_TOP:
-	case COMPOUND_BOTTOM:
-	    /*
-	     * Image is above or below text.
-	     */
-
-	    if (butPtr->compound == COMPOUND_TOP) {
-		textYOffset = height + butPtr->padY;
-	    } else {
-		imageYOffset = butPtr->textHeight + butPtr->padY;
-	    }
-	    fullHeight = height + butPtr->textHeight + butPtr->padY;
-	    fullWidth = (width > butPtr->textWidth ? width :
-		    butPtr->textWidth);
-	    textXOffset = (fullWidth - butPtr->textWidth)/2;
-	    imageXOffset = (fullWidth - width)/2;
-	    break;
-	case COMPOUND_LEFT:
-	case COMPOUND_RIGHT:
-	    /*
-	     * Image is left or right of text.
-	     */
-
-	    if (butPtr->compound == COMPOUND_LEFT) {
-		textXOffset = width + butPtr->padX;
-	    } else {
-		imageXOffset = butPtr->textWidth + butPtr->padX;
-	    }
-	    fullWidth = butPtr->textWidth + butPtr->padX + width;
-	    fullHeight = (height > butPtr->textHeight ? height :
-		    butPtr->textHeight);
-	    textYOffset = (fullHeight - butPtr->textHeight)/2;
-	    imageYOffset = (fullHeight - height)/2;
-	    break;
-	case COMPOUND_CENTER:
-	    /*
-	     * Image and text are superimposed.
-	     */
-
-	    fullWidth = (width > butPtr->textWidth ? width :
-		    butPtr->textWidth);
-	    fullHeight = (height > butPtr->textHeight ? height :
-		    butPtr->textHeight);
-	    textXOffset = (fullWidth - butPtr->textWidth)/2;
-	    imageXOffset = (fullWidth - width)/2;
-	    textYOffset = (fullHeight - butPtr->textHeight)/2;
-	    imageYOffset = (fullHeight - height)/2;
-	    break;
-	case COMPOUND_NONE:
-	    break;
-	}
-
-	TkComputeAnchor(butPtr->anchor, tkwin, butPtr->padX, butPtr->padY,
-		butPtr->indicatorSpace + fullWidth, fullHeight, &x, &y);
-
-	x += butPtr->indicatorSpace;
-	ShiftByOffset(butPtr, relief, &x, &y, width, height);
-	imageXOffset += x;
-	imageYOffset += y;
+    if (!butPtr->placeValid || (butPtr->placeWidth != Tk_Width(tkwin))
+	    || (butPtr->placeHeight != Tk_Height(tkwin))
+	    || (butPtr->placeRelief != relief)) {
+	ComputeButtonContentPlacement(butPtr, relief);
+    }
 
+    if (haveImage) {
 	if (butPtr->image != NULL) {
-	    /*
-	     * Do boundary clipping, so that Tk_RedrawImage is passed valid
-	     * coordinates. [Bug 979239]
-	     */
-
-	    if (imageXOffset < 0) {
-		imageXOffset = 0;
-	    }
-	    if (imageYOffset < 0) {
-		imageYOffset = 0;
-	    }
-	    if (width > Tk_Width(tkwin)) {
-		width = Tk_Width(tkwin);
-	    }
-	    if (height > Tk_Height(tkwin)) {
-		height = Tk_Height(tkwin);
-	    }
-	    if ((width + imageXOffset) > Tk_Width(tkwin)) {
-		imageXOffset = Tk_Width(tkwin) - width;
-	    }
-	    if ((height + imageYOffset) > Tk_Height(tkwin)) {
-		imageYOffset = Tk_Height(tkwin) - height;
-	    }
-
 	    if ((butPtr->selectImage != NULL) && (butPtr->flags & SELECTED)) {
 		Tk_RedrawImage(butPtr->selectImage, 0, 0,
-			width, height, pixmap, imageXOffset, imageYOffset);
-	    } else if ((butPtr->tristateImage != NULL) && (butPtr->flags & TRISTATED)) {
+			butPtr->placeImageDrawW, butPtr->placeImageDrawH,
+			pixmap, butPtr->placeImageX, butPtr->placeImageY);
+	    } else if ((butPtr->tristateImage != NULL)
+		    && (butPtr->flags & TRISTATED)) {
 		Tk_RedrawImage(butPtr->tristateImage, 0, 0,
-			width, height, pixmap, imageXOffset, imageYOffset);
+			butPtr->placeImageDrawW, butPtr->placeImageDrawH,
+			pixmap, butPtr->placeImageX, butPtr->placeImageY);
 	    } else {
-		Tk_RedrawImage(butPtr->image, 0, 0, width,
-			height, pixmap, imageXOffset, imageYOffset);
+		Tk_RedrawImage(butPtr->image, 0, 0,
+			butPtr->placeImageDrawW, butPtr->placeImageDrawH,
+			pixmap, butPtr->placeImageX, butPtr->placeImageY);
 	    }
 	} else {
-	    XSetClipOrigin(butPtr->display, gc, imageXOffset, imageYOffset);
-	    XCopyPlane(butPtr->display, butPtr->bitmap, pixmap, gc,
-		    0, 0, (unsigned int) width, (unsigned int) height,
-		    imageXOffset, imageYOffset, 1);
+	    XSetClipOrigin(butPtr->display, gc, butPtr->placeImageX,
+		    butPtr->placeImageY);
+	    XCopyPlane(butPtr->display, butPtr->bitmap, pixmap, gc, 0, 0,
+		    (unsigned int) butPtr->placeImageDrawW,
+		    (unsigned int) butPtr->placeImageDrawH,
+		    butPtr->placeImageX, butPtr->placeImageY, 1);
 	    XSetClipOrigin(butPtr->display, gc, 0, 0);
 	}
-
-	Tk_DrawTextLayout(butPtr->display, pixmap, gc,
-		butPtr->textLayout, x + textXOffset, y + textYOffset, 0, -1);
+    }
+    if (haveText && (!haveImage || (butPtr->compound != COMPOUND_NONE))) {
+	Tk_DrawTextLayout(butPtr->display, pixmap, gc, butPtr->textLayout,
+		butPtr->placeTextX, butPtr->placeTextY, 0, -1);
 	Tk_UnderlineTextLayout(butPtr->display, pixmap, gc,
-		butPtr->textLayout, x + textXOffset, y + textYOffset,
+		butPtr->textLayout, butPtr->placeTextX, butPtr->placeTextY,
 		butPtr->underline);
-	y += fullHeight/2;
-    } else {
-	if (haveImage) {
-	    TkComputeAnchor(butPtr->anchor, tkwin, 0, 0,
-		    butPtr->indicatorSpace + width, height, &x, &y);
-	    x += butPtr->indicatorSpace;
-	    ShiftByOffset(butPtr, relief, &x, &y, width, height);
-	    imageXOffset += x;
-	    imageYOffset += y;
-	    if (butPtr->image != NULL) {
-		/*
-		 * Do boundary clipping, so that Tk_RedrawImage is passed
-		 * valid coordinates. [Bug 979239]
-		 */
-
-		if (imageXOffset < 0) {
-		    imageXOffset = 0;
-		}
-		if (imageYOffset < 0) {
-		    imageYOffset = 0;
-		}
-		if (width > Tk_Width(tkwin)) {
-		    width = Tk_Width(tkwin);
-		}
-		if (height > Tk_Height(tkwin)) {
-		    height = Tk_Height(tkwin);
-		}
-		if ((width + imageXOffset) > Tk_Width(tkwin)) {
-		    imageXOffset = Tk_Width(tkwin) - width;
-		}
-		if ((height + imageYOffset) > Tk_Height(tkwin)) {
-		    imageYOffset = Tk_Height(tkwin) - height;
-		}
-
-		if ((butPtr->selectImage != NULL) &&
-			(butPtr->flags & SELECTED)) {
-		    Tk_RedrawImage(butPtr->selectImage, 0, 0, width,
-			    height, pixmap, imageXOffset, imageYOffset);
-		} else if ((butPtr->tristateImage != NULL) &&
-			(butPtr->flags & TRISTATED)) {
-		    Tk_RedrawImage(butPtr->tristateImage, 0, 0, width,
-			    height, pixmap, imageXOffset, imageYOffset);
-		} else {
-		    Tk_RedrawImage(butPtr->image, 0, 0, width, height, pixmap,
-			    imageXOffset, imageYOffset);
-		}
-	    } else {
-		XSetClipOrigin(butPtr->display, gc, x, y);
-		XCopyPlane(butPtr->display, butPtr->bitmap, pixmap, gc, 0, 0,
-			(unsigned int) width, (unsigned int) height, x, y, 1);
-		XSetClipOrigin(butPtr->display, gc, 0, 0);
-	    }
-	    y += height/2;
-	} else {
- 	    TkComputeAnchor(butPtr->anchor, tkwin, butPtr->padX, butPtr->padY,
-		    butPtr->indicatorSpace + butPtr->textWidth,
-		    butPtr->textHeight, &x, &y);
-
-	    x += butPtr->indicatorSpace;
-	    ShiftByOffset(butPtr, relief, &x, &y, width, height);
-	    Tk_DrawTextLayout(butPtr->display, pixmap, gc, butPtr->textLayout,
-		    x, y, 0, -1);
-	    Tk_UnderlineTextLayout(butPtr->display, pixmap, gc,
-		    butPtr->textLayout, x, y, butPtr->underline);
-	    y += butPtr->textHeight/2;
-	}
     }
+    x = butPtr->placeX;
 
     /*
      * Draw the indicator for check buttons and radio buttons. At this point,
@@ -742,7 +771,7 @@ TkpDisplayButton(
 		    (unsigned) Tk_Width(tkwin), (unsigned) Tk_Height(tkwin));
 	} else {
 	    XFillRectangle(butPtr->display, pixmap, butPtr->stippleGC,
-		    imageXOffset, imageYOffset,
+		    butPtr->placeImageX, butPtr->placeImageY,
 		    (unsigned) imageWidth, (unsigned) imageHeight);
 	}
 	if ((butPtr->flags & SELECTED) && !butPtr->indicatorOn
@@ -863,6 +892,7 @@ TkpComputeButtonGeometry(
     Tk_FontMetrics fm;
 
     butPtr->inset = butPtr->highlightWidth + butPtr->borderWidth;
+    butPtr->placeValid = 0;
 
     /*
      * Leave room for the default ring if needed.
@@ -43,6 +43,10 @@ struct TkStressedCmap {
  * Forward declarations for functions defined in this file:
  */
 
+static unsigned long	ComputeChannel(unsigned long mask,
+			    unsigned short *intensityPtr);
+static int		AllocTrueColorPixel(Tk_Window tkwin,
+			    XColor *colorPtr);
 static void		DeleteStressedCmap(Display *display,
 			    Colormap colormap);
 static void		FindClosestColor(Tk_Window tkwin,
@@ -84,8 +88,15 @@ TkpFreeColor(
      * operation.
      */
 
+    /*
+     * TrueColor colormaps are read-only and shared, so freeing a cell is a
+     * server-side no-op; skip the request (as is already done for the other
+     * static visual classes).
+     */
+
     visual = tkColPtr->visual;
     if ((visual->c_class != StaticGray) && (visual->c_class != StaticColor)
+	    && (visual->c_class != TrueColor)
 	    && (tkColPtr->color.pixel != BlackPixelOfScreen(screen))
 	    && (tkColPtr->color.pixel != WhitePixelOfScreen(screen))) {
 	Tk_ErrorHandler handler;
@@ -99,6 +110,92 @@ TkpFreeColor(
     DeleteStressedCmap(DisplayOfScreen(screen), tkColPtr->colormap);
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * ComputeChannel --
+ *
+ *	Helper for AllocTrueColorPixel.  Scale a 16-bit intensity into the
+ *	channel described by a TrueColor visual mask.
+ *
+ * Results:
+ *	Returns the channel's contribution to the pixel value, and overwrites
+ *	*intensityPtr with the intensity actually displayed, the same way
+ *	XAllocColor reports the closest supported color.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static unsigned long
+ComputeChannel(
+    unsigned long mask,		/* Contiguous channel mask from the visual. */
+    unsigned short *intensityPtr)
+				/* Desired intensity; overwritten with the
+				 * displayed intensity. */
+{
+    int shift = 0, width = 0;
+    unsigned long m = mask, component;
+
+    while (!(m & 1)) {
+	m >>= 1;
+	shift++;
+    }
+    while (m & 1) {
+	m >>= 1;
+	width++;
+    }
+    component = *intensityPtr >> (16 - width);
+    *intensityPtr = (unsigned short)
+	    ((component * 65535UL) / ((1UL << width) - 1));
+    return component << shift;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * AllocTrueColorPixel --
+ *
+ *	For TrueColor visuals the mapping from red-green-blue intensities to
+ *	a pixel value is fixed by the visual's channel masks, so the pixel
+ *	can be computed client-side; an XAllocColor round trip per color
+ *	(which theme loading issues by the hundreds) gains nothing.
+ *
+ * Results:
+ *	If tkwin's visual is TrueColor, fills in colorPtr's pixel and rounds
+ *	its intensities to the displayed values, then returns 1.  Returns 0
+ *	otherwise, in which case the caller must allocate the color from the
+ *	server.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+AllocTrueColorPixel(
+    Tk_Window tkwin,		/* Window in which color will be used. */
+    XColor *colorPtr)		/* Red, green, and blue fields hold the
+				 * desired color; pixel and the intensities
+				 * are filled in on success. */
+{
+    Visual *visual = Tk_Visual(tkwin);
+
+    if ((visual == NULL) || (visual->c_class != TrueColor)
+	    || (visual->red_mask == 0) || (visual->green_mask == 0)
+	    || (visual->blue_mask == 0)) {
+	return 0;
+    }
+    colorPtr->pixel = ComputeChannel(visual->red_mask, &colorPtr->red)
+	    | ComputeChannel(visual->green_mask, &colorPtr->green)
+	    | ComputeChannel(visual->blue_mask, &colorPtr->blue);
+    colorPtr->flags = DoRed|DoGreen|DoBlue;
+    return 1;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -178,7 +275,9 @@ TkpGetColor(
 	if (TkParseColor(display, colormap, name, &color) == 0) {
 	    return NULL;
 	}
-	if (XAllocColor(display, colormap, &color) != 0) {
+	if (AllocTrueColorPixel(tkwin, &color)) {
+	    /* Pixel computed client-side; no server traffic needed. */
+	} else if (XAllocColor(display, colormap, &color) != 0) {
 	    DeleteStressedCmap(display, colormap);
 	} else {
 	    FindClosestColor(tkwin, &color, &color);
@@ -225,7 +324,9 @@ TkpGetColorByValue(
     tkColPtr->color.red = colorPtr->red;
     tkColPtr->color.green = colorPtr->green;
     tkColPtr->color.blue = colorPtr->blue;
-    if (XAllocColor(display, colormap, &tkColPtr->color) != 0) {
+    if (AllocTrueColorPixel(tkwin, &tkColPtr->color)) {
+	/* Pixel computed client-side; no server traffic needed. */
+    } else if (XAllocColor(display, colormap, &tkColPtr->color) != 0) {
 	DeleteStressedCmap(display, colormap);
     } else {
 	FindClosestColor(tkwin, &tkColPtr->color, &tkColPtr->color);
@@ -15,24 +15,117 @@
 #include "tkUnixInt.h"
 #endif
 
+#ifdef HAVE_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <X11/extensions/XShm.h>
+#endif
+
+/*
+ * The following structure describes one XCopyArea that was issued to scroll
+ * part of a window. A batch of them is kept while collecting the resulting
+ * GraphicsExpose events, since damage reported for one copy may have been
+ * duplicated elsewhere by a copy issued after it.
+ */
+
+typedef struct ScrollCopy {
+    int x, y;			/* Upper-left corner of the scrolled area. */
+    int width, height;		/* Size of the scrolled area. */
+    int dx, dy;			/* Amount by which the area was shifted. */
+} ScrollCopy;
+
+/*
+ * At most this many scroll copies are pipelined by TkUnixScrollWindowDefer
+ * before their damage is collected.
+ */
+
+#define SCROLL_BATCH_SIZE 32
+
 /*
  * The following structure is used to pass information to ScrollRestrictProc
- * from TkScrollWindow.
+ * while collecting scroll damage.
  */
 
 typedef struct ScrollInfo {
-    int done;			/* Flag is 0 until filtering is done. */
+    int copyIndex;		/* Number of copies whose damage has been
+				 * completely collected; filtering is done
+				 * when this reaches numCopies. */
+    int numCopies;		/* Number of entries in copies. */
+    const ScrollCopy *copies;	/* The copies, in the order issued. */
     Display *display;		/* Display to filter. */
     Window window;		/* Window to filter. */
     Region region;		/* Region into which damage is accumulated. */
-    int dx, dy;			/* Amount by which window was shifted. */
 } ScrollInfo;
 
+#ifdef HAVE_XSHM
+/*
+ * The following structure describes the shared memory segment that is used
+ * to transport image data to the X server on displays supporting the MIT-SHM
+ * extension. One segment is kept per display and reused from transfer to
+ * transfer; it is grown when a larger image comes along and released when
+ * the display is closed.
+ */
+
+typedef struct ShmSegment {
+    Display *display;		/* Display the segment belongs to. */
+    int supported;		/* 0 means the extension is absent or a
+				 * previous attach failed (e.g. because the
+				 * server runs on another machine); the
+				 * display always uses plain XPutImage. */
+    XShmSegmentInfo info;	/* Shared memory segment descriptor. */
+    size_t size;		/* Size of the attached segment in bytes, or
+				 * 0 if no segment is attached yet. */
+    XImage *imagePtr;		/* Image header whose data points into the
+				 * segment, or NULL. Recreated whenever the
+				 * requested geometry changes. */
+    struct ShmSegment *nextPtr;	/* Next in list of all segments owned by
+				 * this thread. */
+} ShmSegment;
+
+/*
+ * Transfers smaller than this many pixels always use plain XPutImage; the
+ * round trip that synchronizes reuse of the segment would cost more than
+ * just writing the pixels down the connection.
+ */
+
+#define SHM_MIN_PIXELS	4096
+#endif /* HAVE_XSHM */
+
+typedef struct ThreadSpecificData {
+#ifdef HAVE_XSHM
+    ShmSegment *segListPtr;	/* First in list of shared memory segments,
+				 * one per display. */
+#endif /* HAVE_XSHM */
+    Display *scrollDisplay;	/* Display the deferred scroll copies below
+				 * were issued on. */
+    Window scrollWindow;	/* Window they were issued against. */
+    int numDeferred;		/* Number of entries in deferred. */
+    ScrollCopy deferred[SCROLL_BATCH_SIZE];
+				/* Scroll copies whose damage has not been
+				 * collected yet. */
+} ThreadSpecificData;
+static Tcl_ThreadDataKey dataKey;
+
 /*
  * Forward declarations for functions declared later in this file:
  */
 
 static Tk_RestrictProc ScrollRestrictProc;
+static int		CollectScrollDamage(Display *display, Window window,
+			    const ScrollCopy *copies, int numCopies,
+			    Region damageRgn);
+static void		ScrollDamage(ScrollInfo *info, XRectangle *rect,
+			    int copyIndex);
+#ifdef HAVE_XSHM
+static ShmSegment *	GetShmSegment(Display *display);
+static XImage *		GetShmImage(ShmSegment *segPtr, XImage *imagePtr,
+			    unsigned int width, unsigned int height);
+static int		ShmAttachSegment(Display *display,
+			    XShmSegmentInfo *infoPtr, size_t size);
+static void		ShmDestroyImage(ShmSegment *segPtr);
+static int		ShmErrorProc(ClientData clientData,
+			    XErrorEvent *errEventPtr);
+#endif /* HAVE_XSHM */
 
 /*
  *----------------------------------------------------------------------
@@ -63,19 +156,161 @@ TkScrollWindow(
     int dx, int dy,		/* Distance rectangle should be moved. */
     Region damageRgn)		/* Region to accumulate damage in. */
 {
-    Tk_RestrictProc *prevProc;
-    ClientData prevArg;
-    ScrollInfo info;
+    ScrollCopy copy;
 
+    copy.x = x;
+    copy.y = y;
+    copy.width = width;
+    copy.height = height;
+    copy.dx = dx;
+    copy.dy = dy;
     XCopyArea(Tk_Display(tkwin), Tk_WindowId(tkwin), Tk_WindowId(tkwin), gc,
 	    x, y, (unsigned) width, (unsigned) height, x+dx, y+dy);
+    return CollectScrollDamage(Tk_Display(tkwin), Tk_WindowId(tkwin),
+	    &copy, 1, damageRgn);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkUnixScrollWindowDefer --
+ *
+ *	Issue a scroll copy like TkScrollWindow, but without waiting for the
+ *	server to report the damage it caused. TkScrollWindowDefer is a macro
+ *	for this function on Unix. Deferred copies are pipelined down the
+ *	connection and their damage is collected in one pass by the next
+ *	TkUnixScrollWindowFlush call, so a redisplay that scrolls several
+ *	bands of a window pays for a single server round trip instead of one
+ *	per band.
+ *
+ * Results:
+ *	Returns 0 when the damage report was deferred. When the batch was
+ *	full, or the deferred copies were against another window, their
+ *	damage is collected into damageRgn first and the result is 1 if any
+ *	was found.
+ *
+ * Side effects:
+ *	Copies an area of the window; the copy is remembered in the
+ *	per-thread batch until it is flushed.
+ *
+ *----------------------------------------------------------------------
+ */
 
-    info.done = 0;
-    info.window = Tk_WindowId(tkwin);
-    info.display = Tk_Display(tkwin);
+int
+TkUnixScrollWindowDefer(
+    Tk_Window tkwin,		/* The window to be scrolled. */
+    GC gc,			/* GC for window to be scrolled. */
+    int x, int y, int width, int height,
+				/* Position rectangle to be scrolled. */
+    int dx, int dy,		/* Distance rectangle should be moved. */
+    Region damageRgn)		/* Region to accumulate damage in. */
+{
+    Display *display = Tk_Display(tkwin);
+    Window window = Tk_WindowId(tkwin);
+    ScrollCopy *copyPtr;
+    int result = 0;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if ((tsdPtr->numDeferred > 0)
+	    && ((tsdPtr->scrollDisplay != display)
+		|| (tsdPtr->scrollWindow != window)
+		|| (tsdPtr->numDeferred >= SCROLL_BATCH_SIZE))) {
+	result = CollectScrollDamage(tsdPtr->scrollDisplay,
+		tsdPtr->scrollWindow, tsdPtr->deferred, tsdPtr->numDeferred,
+		damageRgn);
+	tsdPtr->numDeferred = 0;
+    }
+
+    XCopyArea(display, window, window, gc, x, y, (unsigned) width,
+	    (unsigned) height, x+dx, y+dy);
+    tsdPtr->scrollDisplay = display;
+    tsdPtr->scrollWindow = window;
+    copyPtr = &tsdPtr->deferred[tsdPtr->numDeferred++];
+    copyPtr->x = x;
+    copyPtr->y = y;
+    copyPtr->width = width;
+    copyPtr->height = height;
+    copyPtr->dx = dx;
+    copyPtr->dy = dy;
+    return result;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkUnixScrollWindowFlush --
+ *
+ *	Collect the damage caused by all scroll copies deferred by
+ *	TkUnixScrollWindowDefer. TkScrollWindowFlush is a macro for this
+ *	function on Unix.
+ *
+ * Results:
+ *	Returns 1 if damage was added to damageRgn, 0 if there was none or
+ *	no copies were pending.
+ *
+ * Side effects:
+ *	Enters the event loop looking for damage events; the batch of
+ *	deferred copies is emptied.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkUnixScrollWindowFlush(
+    Tk_Window tkwin,		/* The window that was scrolled. */
+    Region damageRgn)		/* Region to accumulate damage in. */
+{
+    int numCopies;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+    (void)tkwin;
+
+    if (tsdPtr->numDeferred == 0) {
+	return 0;
+    }
+    numCopies = tsdPtr->numDeferred;
+    tsdPtr->numDeferred = 0;
+    return CollectScrollDamage(tsdPtr->scrollDisplay, tsdPtr->scrollWindow,
+	    tsdPtr->deferred, numCopies, damageRgn);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * CollectScrollDamage --
+ *
+ *	Gather the GraphicsExpose damage generated by a batch of scroll
+ *	copies into a region, filtering the event queue until every copy has
+ *	reported either damage or a NoExpose.
+ *
+ * Results:
+ *	Returns 1 if damageRgn is non-empty afterwards, 0 otherwise.
+ *
+ * Side effects:
+ *	Enters the event loop looking for damage events.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+CollectScrollDamage(
+    Display *display,		/* Display the copies were issued on. */
+    Window window,		/* Window whose contents were copied. */
+    const ScrollCopy *copies,	/* The copies, in the order issued. */
+    int numCopies,		/* Number of entries in copies. */
+    Region damageRgn)		/* Region to accumulate damage in. */
+{
+    Tk_RestrictProc *prevProc;
+    ClientData prevArg;
+    ScrollInfo info;
+
+    info.copyIndex = 0;
+    info.numCopies = numCopies;
+    info.copies = copies;
+    info.display = display;
+    info.window = window;
     info.region = damageRgn;
-    info.dx = dx;
-    info.dy = dy;
 
     /*
      * Sync the event stream so all of the expose events will be on the Tk
@@ -83,9 +318,9 @@ TkScrollWindow(
      * we filter events.
      */
 
-    TkpSync(info.display);
+    TkpSync(display);
     prevProc = Tk_RestrictEvents(ScrollRestrictProc, &info, &prevArg);
-    while (!info.done) {
+    while (info.copyIndex < info.numCopies) {
 	Tcl_ServiceEvent(TCL_WINDOW_EVENTS);
     }
     Tk_RestrictEvents(prevProc, prevArg, &prevArg);
@@ -96,16 +331,62 @@ TkScrollWindow(
 	return 1;
     }
 }
-
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ScrollDamage --
+ *
+ *	Add a damaged rectangle to the region being accumulated. A copy
+ *	issued after the damage arose may have duplicated the stale pixels
+ *	somewhere else, so the rectangle is also propagated, suitably
+ *	shifted, through every later copy whose source area it overlaps.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Updates the damage region.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ScrollDamage(
+    ScrollInfo *info,		/* Describes the batch being collected. */
+    XRectangle *rect,		/* Damaged rectangle, in window coords. */
+    int copyIndex)		/* Index of the copy that caused the damage,
+				 * or -1 for damage that predates the whole
+				 * batch. */
+{
+    int j;
+
+    XUnionRectWithRegion(rect, info->region, info->region);
+    for (j = copyIndex + 1; j < info->numCopies; j++) {
+	const ScrollCopy *copyPtr = &info->copies[j];
+
+	if ((rect->x < copyPtr->x + copyPtr->width)
+		&& (rect->x + (int) rect->width > copyPtr->x)
+		&& (rect->y < copyPtr->y + copyPtr->height)
+		&& (rect->y + (int) rect->height > copyPtr->y)) {
+	    XRectangle shifted = *rect;
+
+	    shifted.x += copyPtr->dx;
+	    shifted.y += copyPtr->dy;
+	    ScrollDamage(info, &shifted, j);
+	}
+    }
+}
+
 /*
  *----------------------------------------------------------------------
  *
  * ScrollRestrictProc --
  *
- *	A Tk_RestrictProc used by TkScrollWindow to gather up Expose
+ *	A Tk_RestrictProc used by CollectScrollDamage to gather up Expose
  *	information into a single damage region. It accumulates damage events
  *	on the specified window until a NoExpose or the last GraphicsExpose
- *	event is detected.
+ *	event has been seen for every copy in the batch.
  *
  * Results:
  *	None.
@@ -129,43 +410,39 @@ ScrollRestrictProc(
      * Defer events which aren't for the specified window.
      */
 
-    if (info->done || (eventPtr->xany.display != info->display)
+    if ((info->copyIndex >= info->numCopies)
+	    || (eventPtr->xany.display != info->display)
 	    || (eventPtr->xany.window != info->window)) {
 	return TK_DEFER_EVENT;
     }
 
     if (eventPtr->type == NoExpose) {
-	info->done = 1;
+	info->copyIndex++;
     } else if (eventPtr->type == GraphicsExpose) {
 	rect.x = eventPtr->xgraphicsexpose.x;
 	rect.y = eventPtr->xgraphicsexpose.y;
 	rect.width = eventPtr->xgraphicsexpose.width;
 	rect.height = eventPtr->xgraphicsexpose.height;
-	XUnionRectWithRegion(&rect, info->region,
-		info->region);
+	ScrollDamage(info, &rect, info->copyIndex);
 
 	if (eventPtr->xgraphicsexpose.count == 0) {
-	    info->done = 1;
+	    info->copyIndex++;
 	}
     } else if (eventPtr->type == Expose) {
 	/*
 	 * This case is tricky. This event was already queued before the
-	 * XCopyArea was issued. If this area overlaps the area being copied,
+	 * copies were issued. If this area overlaps an area being copied,
 	 * then some of the copied area may be invalid. The easiest way to
-	 * handle this case is to mark both the original area and the shifted
-	 * area as damaged.
+	 * handle this case is to mark the original area as damaged and let
+	 * ScrollDamage propagate it through every copy that may have
+	 * duplicated the stale pixels.
 	 */
 
 	rect.x = eventPtr->xexpose.x;
 	rect.y = eventPtr->xexpose.y;
 	rect.width = eventPtr->xexpose.width;
 	rect.height = eventPtr->xexpose.height;
-	XUnionRectWithRegion(&rect, info->region,
-		info->region);
-	rect.x += info->dx;
-	rect.y += info->dy;
-	XUnionRectWithRegion(&rect, info->region,
-		info->region);
+	ScrollDamage(info, &rect, -1);
     } else {
 	return TK_DEFER_EVENT;
     }
@@ -236,7 +513,375 @@ TkpDrawFrameEx(
 	    highlightWidth, Tk_Width(tkwin) - 2*highlightWidth,
 	    Tk_Height(tkwin) - 2*highlightWidth, borderWidth, relief);
 }
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkUnixPutImage --
+ *
+ *	Copy a rectangular area of an image into a drawable. This is the
+ *	function behind the TkPutImage macro on Unix. When the display
+ *	supports the MIT-SHM extension, large ZPixmap images travel through
+ *	a shared memory segment instead of being written down the X
+ *	connection; otherwise, or for small or odd transfers, it falls
+ *	through to plain XPutImage.
+ *
+ * Results:
+ *	Returns Success.
+ *
+ * Side effects:
+ *	Pixels are drawn; a shared memory segment may be created, grown or
+ *	attached to the display.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkUnixPutImage(
+    Display *display,		/* Display to use. */
+    Drawable d,			/* Drawable in which to place the image. */
+    GC gc,			/* Graphics context to use. */
+    XImage *image,		/* Image whose contents are to be copied. */
+    int src_x, int src_y,	/* Top-left corner of source area. */
+    int dest_x, int dest_y,	/* Top-left corner of destination area. */
+    unsigned int width, unsigned int height)
+				/* Dimensions of the area to be copied. */
+{
+#ifdef HAVE_XSHM
+    ShmSegment *segPtr;
+
+    if ((image->format == ZPixmap)
+	    && (width * height >= SHM_MIN_PIXELS)
+	    && ((src_x * image->bits_per_pixel) % NBBY == 0)
+	    && ((segPtr = GetShmSegment(display)) != NULL)) {
+	XImage *shmImagePtr = GetShmImage(segPtr, image, width, height);
+
+	if (shmImagePtr != NULL) {
+	    int y, rowBytes;
+	    char *srcPtr, *destPtr;
+
+	    rowBytes = (width * image->bits_per_pixel + NBBY - 1) / NBBY;
+	    srcPtr = image->data + src_y * image->bytes_per_line
+		    + (src_x * image->bits_per_pixel) / NBBY;
+	    destPtr = shmImagePtr->data;
+	    for (y = 0; y < (int) height; ++y) {
+		memcpy(destPtr, srcPtr, (size_t) rowBytes);
+		srcPtr += image->bytes_per_line;
+		destPtr += shmImagePtr->bytes_per_line;
+	    }
+	    XShmPutImage(display, d, gc, shmImagePtr, 0, 0, dest_x, dest_y,
+		    width, height, False);
+
+	    /*
+	     * Wait until the server has read the segment, so that the next
+	     * transfer may safely overwrite it.
+	     */
+
+	    XSync(display, False);
+	    return Success;
+	}
+    }
+#endif /* HAVE_XSHM */
+    return XPutImage(display, d, gc, image, src_x, src_y, dest_x, dest_y,
+	    width, height);
+}
+
+#ifdef HAVE_XSHM
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * GetShmSegment --
+ *
+ *	Find the shared memory segment record for the given display,
+ *	creating it on first use.
+ *
+ * Results:
+ *	Returns the record, or NULL if the display does not support the
+ *	MIT-SHM extension.
+ *
+ * Side effects:
+ *	May query the server for the extension and extend the per-thread
+ *	segment list.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static ShmSegment *
+GetShmSegment(
+    Display *display)		/* Display the image is headed for. */
+{
+    ShmSegment *segPtr;
+    int major, minor;
+    Bool pixmaps;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    for (segPtr = tsdPtr->segListPtr; segPtr != NULL;
+	    segPtr = segPtr->nextPtr) {
+	if (segPtr->display == display) {
+	    return segPtr->supported ? segPtr : NULL;
+	}
+    }
+
+    segPtr = (ShmSegment *) ckalloc(sizeof(ShmSegment));
+    segPtr->display = display;
+    segPtr->supported = XShmQueryVersion(display, &major, &minor, &pixmaps);
+    segPtr->size = 0;
+    segPtr->imagePtr = NULL;
+    segPtr->nextPtr = tsdPtr->segListPtr;
+    tsdPtr->segListPtr = segPtr;
+    return segPtr->supported ? segPtr : NULL;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * GetShmImage --
+ *
+ *	Return an image header of the given geometry whose pixel storage
+ *	lies in the display's shared memory segment, reusing the cached one
+ *	when it already matches.
+ *
+ * Results:
+ *	Returns the image, or NULL if shared memory cannot be used for this
+ *	transfer (the caller then falls back to XPutImage).
+ *
+ * Side effects:
+ *	May recreate the cached image header and grow the shared segment.
+ *	If attaching a segment fails, the display is marked as unsupported
+ *	so that it is not tried again.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static XImage *
+GetShmImage(
+    ShmSegment *segPtr,		/* Segment record for the display. */
+    XImage *imagePtr,		/* Image whose contents will be copied into
+				 * the shared image. */
+    unsigned int width, unsigned int height)
+				/* Dimensions of the area to be copied. */
+{
+    XImage *shmImagePtr = segPtr->imagePtr;
+    size_t needed;
+
+    if ((shmImagePtr != NULL)
+	    && (shmImagePtr->width == (int) width)
+	    && (shmImagePtr->height == (int) height)
+	    && (shmImagePtr->depth == imagePtr->depth)) {
+	return shmImagePtr;
+    }
+    ShmDestroyImage(segPtr);
+
+    shmImagePtr = XShmCreateImage(segPtr->display,
+	    DefaultVisual(segPtr->display, DefaultScreen(segPtr->display)),
+	    imagePtr->depth, ZPixmap, NULL, &segPtr->info,
+	    width, height);
+    if (shmImagePtr == NULL) {
+	return NULL;
+    }
+    if ((shmImagePtr->bits_per_pixel != imagePtr->bits_per_pixel)
+	    || (shmImagePtr->byte_order != imagePtr->byte_order)) {
+	/*
+	 * The raw bytes of the source image cannot be copied over
+	 * unchanged, so this image has to take the XPutImage path.
+	 */
+
+	XDestroyImage(shmImagePtr);
+	return NULL;
+    }
+
+    needed = (size_t) shmImagePtr->bytes_per_line * height;
+    if (needed > segPtr->size) {
+	/*
+	 * Round the size up so that slowly growing images do not cause the
+	 * segment to be recreated over and over.
+	 */
+
+	needed = (needed + 0xffff) & ~(size_t) 0xffff;
+	if (segPtr->size > 0) {
+	    XShmDetach(segPtr->display, &segPtr->info);
+	    XSync(segPtr->display, False);
+	    shmdt(segPtr->info.shmaddr);
+	    segPtr->size = 0;
+	}
+	if (!ShmAttachSegment(segPtr->display, &segPtr->info, needed)) {
+	    XDestroyImage(shmImagePtr);
+	    segPtr->supported = 0;
+	    return NULL;
+	}
+	segPtr->size = needed;
+    }
+    shmImagePtr->data = segPtr->info.shmaddr;
+    segPtr->imagePtr = shmImagePtr;
+    return shmImagePtr;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ShmAttachSegment --
+ *
+ *	Create a shared memory segment of the given size and attach it to
+ *	both this process and the X server.
+ *
+ * Results:
+ *	Returns 1 on success and fills *infoPtr, 0 on failure. The attach
+ *	fails in particular when the server runs on another machine, which
+ *	is detected through the X error that the server sends back.
+ *
+ * Side effects:
+ *	The segment is marked for deletion right away, so the kernel
+ *	reclaims it as soon as both sides have detached, even if this
+ *	process exits without cleaning up.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ShmAttachSegment(
+    Display *display,		/* Display to attach the segment to. */
+    XShmSegmentInfo *infoPtr,	/* Filled with the segment descriptor. */
+    size_t size)		/* Size of the segment in bytes. */
+{
+    Tk_ErrorHandler handler;
+    int gotError = 0;
+
+    infoPtr->shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+    if (infoPtr->shmid < 0) {
+	return 0;
+    }
+    infoPtr->shmaddr = (char *) shmat(infoPtr->shmid, NULL, 0);
+    if (infoPtr->shmaddr == (char *) -1) {
+	shmctl(infoPtr->shmid, IPC_RMID, NULL);
+	return 0;
+    }
+    infoPtr->readOnly = True;
+
+    handler = Tk_CreateErrorHandler(display, -1, -1, -1, ShmErrorProc,
+	    (ClientData) &gotError);
+    if (!XShmAttach(display, infoPtr)) {
+	gotError = 1;
+    }
+    XSync(display, False);
+    Tk_DeleteErrorHandler(handler);
+    shmctl(infoPtr->shmid, IPC_RMID, NULL);
+
+    if (gotError) {
+	shmdt(infoPtr->shmaddr);
+	return 0;
+    }
+    return 1;
+}
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * ShmDestroyImage --
+ *
+ *	Free the cached shared memory image header, if any. The pixel
+ *	storage belongs to the segment and is not touched.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The image header is freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+ShmDestroyImage(
+    ShmSegment *segPtr)		/* Segment whose image is to be freed. */
+{
+    if (segPtr->imagePtr != NULL) {
+	XDestroyImage(segPtr->imagePtr);
+	segPtr->imagePtr = NULL;
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * ShmErrorProc --
+ *
+ *	Error handler invoked when attaching a shared memory segment to the
+ *	X server fails.
+ *
+ * Results:
+ *	Always returns 0 so that no error message is printed.
+ *
+ * Side effects:
+ *	Sets the flag that the client data points to.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+ShmErrorProc(
+    ClientData clientData,	/* Pointer to the failure flag. */
+    XErrorEvent *errEventPtr)	/* Describes the error (unused). */
+{
+    (void) errEventPtr;
+
+    *((int *) clientData) = 1;
+    return 0;
+}
+#endif /* HAVE_XSHM */
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkUnixShmCleanup --
+ *
+ *	Release the shared memory segment associated with a display. Called
+ *	when the display is closed.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The segment is detached from the server and this process, and its
+ *	record is removed from the per-thread list.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkUnixShmCleanup(
+    Display *display)		/* Display being closed. */
+{
+#ifdef HAVE_XSHM
+    ShmSegment *segPtr, *prevPtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    for (prevPtr = NULL, segPtr = tsdPtr->segListPtr; segPtr != NULL;
+	    prevPtr = segPtr, segPtr = segPtr->nextPtr) {
+	if (segPtr->display != display) {
+	    continue;
+	}
+	ShmDestroyImage(segPtr);
+	if (segPtr->size > 0) {
+	    XShmDetach(display, &segPtr->info);
+	    XSync(display, False);
+	    shmdt(segPtr->info.shmaddr);
+	}
+	if (prevPtr == NULL) {
+	    tsdPtr->segListPtr = segPtr->nextPtr;
+	} else {
+	    prevPtr->nextPtr = segPtr->nextPtr;
+	}
+	ckfree(segPtr);
+	break;
+    }
+#else
+    (void) display;
+#endif /* HAVE_XSHM */
+}
+
 /*
  * Local Variables:
  * mode: c
@@ -166,6 +166,16 @@ TkpOpenDisplay(
     dispPtr = (TkDisplay *)ckalloc(sizeof(TkDisplay));
     memset(dispPtr, 0, sizeof(TkDisplay));
     dispPtr->display = display;
+
+    /*
+     * Scrolling arrives as bursts of emulated wheel button presses, often
+     * hundreds per second during a trackpad fling.  Accumulate their
+     * deltas on the event queue by default; the summed %D preserves the
+     * total scroll distance.  Embedding applications can restore one
+     * event per detent with Tk_CollapseWheelEvents.
+     */
+
+    dispPtr->flags |= TK_DISPLAY_COLLAPSE_WHEEL_EVENTS;
 #ifdef TK_USE_INPUT_METHODS
     OpenIM(dispPtr);
     XRegisterIMInstantiateCallback(dispPtr->display, NULL, NULL, NULL,
@@ -234,7 +244,15 @@ TkpCloseDisplay(
     }
 #endif
 
+    if (dispPtr->keySymCache != NULL) {
+	ckfree(dispPtr->keySymCache);
+	dispPtr->keySymCache = NULL;
+	Tcl_DeleteHashTable(&dispPtr->keySymToCode);
+    }
+
     if (dispPtr->display != 0) {
+	TkUnixShmCleanup(dispPtr->display);
+	TkUnixPixmapPoolCleanup(dispPtr->display);
 	Tcl_DeleteFileHandler(ConnectionNumber(dispPtr->display));
 	(void) XSync(dispPtr->display, False);
 	(void) XCloseDisplay(dispPtr->display);
@@ -324,6 +342,49 @@ DisplaySetupProc(
     }
 }
 
+/*
+ * Maximum number of windows for which Expose events are accumulated within
+ * one TransferXEventsToTcl pass; windows beyond this limit have their
+ * Expose events queued without compression.
+ */
+
+#define EXPOSE_ACCUM_SIZE 8
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * QueueExposeEvent --
+ *
+ *	Helper for TransferXEventsToTcl: queue an accumulated Expose event
+ *	and remove it from the accumulation array.
+ *
+ * Results:
+ *	The new number of accumulated events.
+ *
+ * Side effects:
+ *	Adds an event to the Tk event queue.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+QueueExposeEvent(
+    XExposeEvent *accumPtr,	/* Array of accumulated Expose events. */
+    int numAccum,		/* Number of events in accumPtr. */
+    int index)			/* Index of the event to queue. */
+{
+    XEvent flush;
+
+    flush.xexpose = accumPtr[index];
+    Tk_QueueWindowEvent(&flush, TCL_QUEUE_TAIL);
+    numAccum--;
+    while (index < numAccum) {
+	accumPtr[index] = accumPtr[index + 1];
+	index++;
+    }
+    return numAccum;
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -335,7 +396,11 @@ DisplaySetupProc(
  *	None.
  *
  * Side effects:
- *	Moves queued X events onto the Tcl event queue.
+ *	Moves queued X events onto the Tcl event queue. Expose events for the
+ *	same window are compressed into a single event covering the bounding
+ *	box of their rectangles, so that an expose storm (e.g. from an opaque
+ *	window drag) schedules one redraw per window instead of one per
+ *	rectangle.
  *
  *----------------------------------------------------------------------
  */
@@ -351,6 +416,9 @@ TransferXEventsToTcl(
     } event;
     Window w;
     TkDisplay *dispPtr = NULL;
+    XExposeEvent exposeAccum[EXPOSE_ACCUM_SIZE];
+    int numExpose = 0;
+    int i;
 
     /*
      * Transfer events from the X event queue to the Tk event queue after XIM
@@ -409,8 +477,93 @@ TransferXEventsToTcl(
 	    }
 #endif
 	}
+
+	/*
+	 * X11 has no wheel events of its own: the server reports scrolling
+	 * as presses of buttons 4-7, and trackpads or high-resolution
+	 * wheels emit long bursts of them.  Tk_HandleEvent performs the
+	 * same translation at dispatch time; doing it here, while the
+	 * burst is still being drained from the X queue, lets
+	 * Tk_QueueWindowEvent accumulate the deltas into a single
+	 * MouseWheel event per event-loop pass.  The matching releases
+	 * carry no information and are dropped without queueing.
+	 */
+
+	if ((event.x.xbutton.button >= Button4)
+		&& (event.x.xbutton.button < Button8)) {
+	    if (event.type == ButtonRelease) {
+		continue;
+	    } else if (event.type == ButtonPress) {
+		int but = event.x.xbutton.button;
+
+		event.x.type = MouseWheelEvent;
+		event.x.xany.send_event = -1;
+		event.x.xkey.keycode = (but & 1) ? -120 : 120;
+		if (but > Button5) {
+		    event.x.xkey.state ^= ShiftMask;
+		}
+	    }
+	}
+
+	/*
+	 * Compress Expose events: merge each one into the accumulated
+	 * bounding box for its window and queue the result later, either
+	 * when another kind of event shows up for the same window (so the
+	 * redraw is not reordered after it) or at the end of this pass.
+	 */
+
+	if (event.type == Expose) {
+	    XExposeEvent *exposePtr = &event.x.xexpose;
+
+	    for (i = 0; i < numExpose; i++) {
+		if (exposeAccum[i].window == exposePtr->window) {
+		    int x2 = exposeAccum[i].x + exposeAccum[i].width;
+		    int y2 = exposeAccum[i].y + exposeAccum[i].height;
+
+		    if (exposePtr->x + exposePtr->width > x2) {
+			x2 = exposePtr->x + exposePtr->width;
+		    }
+		    if (exposePtr->y + exposePtr->height > y2) {
+			y2 = exposePtr->y + exposePtr->height;
+		    }
+		    if (exposePtr->x < exposeAccum[i].x) {
+			exposeAccum[i].x = exposePtr->x;
+		    }
+		    if (exposePtr->y < exposeAccum[i].y) {
+			exposeAccum[i].y = exposePtr->y;
+		    }
+		    exposeAccum[i].width = x2 - exposeAccum[i].x;
+		    exposeAccum[i].height = y2 - exposeAccum[i].y;
+		    exposeAccum[i].count = exposePtr->count;
+		    break;
+		}
+	    }
+	    if (i == numExpose) {
+		if (numExpose < EXPOSE_ACCUM_SIZE) {
+		    exposeAccum[numExpose] = *exposePtr;
+		    numExpose++;
+		} else {
+		    Tk_QueueWindowEvent(&event.x, TCL_QUEUE_TAIL);
+		}
+	    }
+	    continue;
+	}
+	for (i = 0; i < numExpose; i++) {
+	    if (exposeAccum[i].window == event.x.xany.window) {
+		numExpose = QueueExposeEvent(exposeAccum, numExpose, i);
+		break;
+	    }
+	}
 	Tk_QueueWindowEvent(&event.x, TCL_QUEUE_TAIL);
     }
+
+    /*
+     * Queue any Expose events still being accumulated.
+     */
+
+    while (numExpose > 0) {
+	numExpose = QueueExposeEvent(exposeAccum, numExpose, 0);
+    }
 }
 
 /*
@@ -26,6 +26,8 @@
 
 MODULE_SCOPE  int       Tktray_Init (Tcl_Interp* interp);
 MODULE_SCOPE  int       SysNotify_Init (Tcl_Interp* interp);
+MODULE_SCOPE  void      TkUnixShmCleanup(Display *display);
+MODULE_SCOPE  void      TkUnixPixmapPoolCleanup(Display *display);
 
 #endif /* _TKUNIXINT */
 
@@ -17,9 +17,20 @@
 #include <X11/XKBlib.h>
 #undef XkbOpenDisplay
 
+/*
+ * Tk only ever consults the first four columns of the keymap vector for a
+ * keycode (the shifted and unshifted entries for the primary and mode-switch
+ * groups), so that is all the per-display cache below retains.
+ */
+
+#define KEYSYM_CACHE_WIDTH	4
+
 /*
  * Prototypes for local functions defined in this file:
  */
+
+static KeySym		KeyCodeToKeySym(TkDisplay *dispPtr,
+			    unsigned int keycode, int index);
 
 /*
  *----------------------------------------------------------------------
@@ -239,15 +250,25 @@ TkpSetKeycodeAndState(
     int state, mincode, maxcode;
     KeyCode keycode;
 
+    if (dispPtr->bindInfoStale) {
+	TkpInitKeymapInfo(dispPtr);
+    }
+
     if (keySym == NoSymbol) {
 	keycode = 0;
+    } else if (dispPtr->keySymCache != NULL) {
+	Tcl_HashEntry *hPtr =
+		Tcl_FindHashEntry(&dispPtr->keySymToCode, INT2PTR(keySym));
+
+	keycode = (hPtr != NULL) ? (KeyCode) PTR2INT(Tcl_GetHashValue(hPtr))
+		: 0;
     } else {
 	keycode = XKeysymToKeycode(dispPtr->display, keySym);
     }
     eventPtr->xkey.keycode = keycode;
     if (keycode != 0) {
 	for (state = 0; state < 4; state++) {
-	    if (XLookupKeysym(&eventPtr->xkey, state) == keySym) {
+	    if (KeyCodeToKeySym(dispPtr, keycode, state) == keySym) {
 		if (state & 1) {
 		    eventPtr->xkey.state |= ShiftMask;
 		}
@@ -276,6 +297,38 @@ TkpSetKeycodeAndState(
     eventPtr->xkey.keycode = keycode;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * KeyCodeToKeySym --
+ *
+ *	Map a keycode and keymap-vector index to a KeySym, consulting the
+ *	per-display table prefetched by TkpInitKeymapInfo instead of
+ *	re-entering Xlib for every keystroke.
+ *
+ * Results:
+ *	The KeySym in the given slot of the keymap vector, or NoSymbol if
+ *	the slot is empty.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static KeySym
+KeyCodeToKeySym(
+    TkDisplay *dispPtr,		/* Display in which to map keycode. */
+    unsigned int keycode,	/* X keycode; must lie in [0,255]. */
+    int index)			/* Keymap vector index, in the range
+				 * [0,KEYSYM_CACHE_WIDTH). */
+{
+    if ((dispPtr->keySymCache == NULL) || (keycode > 0xff)) {
+	return XkbKeycodeToKeysym(dispPtr->display, keycode, 0, index);
+    }
+    return dispPtr->keySymCache[keycode*KEYSYM_CACHE_WIDTH + index];
+}
+
 /*
  *----------------------------------------------------------------------
  *
@@ -359,8 +412,7 @@ TkpGetKeySym(
 	    && (eventPtr->xkey.state & LockMask))) {
 	index += 1;
     }
-    sym = XkbKeycodeToKeysym(dispPtr->display, eventPtr->xkey.keycode, 0,
-	    index);
+    sym = KeyCodeToKeySym(dispPtr, eventPtr->xkey.keycode, index);
 
     /*
      * Special handling: if the key was shifted because of Lock, but lock is
@@ -378,8 +430,7 @@ TkpGetKeySym(
 		|| ((sym >= XK_Agrave) && (sym <= XK_Odiaeresis))
 		|| ((sym >= XK_Oslash) && (sym <= XK_Thorn)))) {
 	    index &= ~1;
-	    sym = XkbKeycodeToKeysym(dispPtr->display, eventPtr->xkey.keycode,
-		    0, index);
+	    sym = KeyCodeToKeySym(dispPtr, eventPtr->xkey.keycode, index);
 	}
     }
 
@@ -389,8 +440,7 @@ TkpGetKeySym(
      */
 
     if ((index & 1) && (sym == NoSymbol)) {
-	sym = XkbKeycodeToKeysym(dispPtr->display, eventPtr->xkey.keycode,
-		0, index & ~1);
+	sym = KeyCodeToKeySym(dispPtr, eventPtr->xkey.keycode, index & ~1);
     }
     return sym;
 }
@@ -421,7 +471,7 @@ TkpInitKeymapInfo(
     XModifierKeymap *modMapPtr;
     KeyCode *codePtr;
     KeySym keysym;
-    int count, i, j, max, arraySize;
+    int count, i, j, max, arraySize, mincode, maxcode;
 #define KEYCODE_ARRAY_SIZE 20
 
     dispPtr->bindInfoStale = 0;
@@ -526,6 +576,55 @@ TkpInitKeymapInfo(
 	continue;
     }
     XFreeModifiermap(modMapPtr);
+
+    /*
+     * Prefetch the keycode-to-keysym table for the whole keycode range, so
+     * that TkpGetKeySym never has to go back to Xlib while dispatching key
+     * events, and build the reverse keysym-to-keycode index used by "event
+     * generate". The reverse index replicates the column-major search order
+     * of XKeysymToKeycode (unshifted bindings on any keycode are preferred
+     * over shifted ones). Both caches are rebuilt here whenever a
+     * MappingNotify marks the binding information stale.
+     */
+
+    if (dispPtr->keySymCache == NULL) {
+	dispPtr->keySymCache = (KeySym *)
+		ckalloc(0x100 * KEYSYM_CACHE_WIDTH * sizeof(KeySym));
+    } else {
+	Tcl_DeleteHashTable(&dispPtr->keySymToCode);
+    }
+    Tcl_InitHashTable(&dispPtr->keySymToCode, TCL_ONE_WORD_KEYS);
+
+    mincode = 0;
+    maxcode = -1;
+    XDisplayKeycodes(dispPtr->display, &mincode, &maxcode);
+    if (maxcode > 0xff) {
+	maxcode = 0xff;
+    }
+    for (i = 0; i < 0x100; i++) {
+	for (j = 0; j < KEYSYM_CACHE_WIDTH; j++) {
+	    dispPtr->keySymCache[i*KEYSYM_CACHE_WIDTH + j] =
+		    ((i >= mincode) && (i <= maxcode))
+		    ? XkbKeycodeToKeysym(dispPtr->display, i, 0, j)
+		    : NoSymbol;
+	}
+    }
+    for (j = 0; j < KEYSYM_CACHE_WIDTH; j++) {
+	for (i = mincode; i <= maxcode; i++) {
+	    Tcl_HashEntry *hPtr;
+	    int isNew;
+
+	    keysym = dispPtr->keySymCache[i*KEYSYM_CACHE_WIDTH + j];
+	    if (keysym == NoSymbol) {
+		continue;
+	    }
+	    hPtr = Tcl_CreateHashEntry(&dispPtr->keySymToCode,
+		    INT2PTR(keysym), &isNew);
+	    if (isNew) {
+		Tcl_SetHashValue(hPtr, INT2PTR(i));
+	    }
+	}
+    }
 }
 
 /*
@@ -1755,8 +1755,24 @@ TkpComputeStandardMenuGeometry(
 	     * on the type of the entry.
 	     */
 
-	    GetMenuLabelGeometry(mePtr, tkfont, fmPtr, &width, &height);
-	    mePtr->height = height;
+	    /*
+	     * Measuring is by far the most expensive part of laying out a
+	     * big menu, so the raw measurements are cached on the entry and
+	     * reused until the entry (or a font) changes.
+	     */
+
+	    if (!(mePtr->entryFlags & ENTRY_GEOM_CACHED)) {
+		GetMenuLabelGeometry(mePtr, tkfont, fmPtr,
+			&mePtr->labelReqWidth, &mePtr->labelReqHeight);
+		GetMenuAccelGeometry(menuPtr, mePtr, tkfont, fmPtr,
+			&mePtr->accelReqWidth, &mePtr->accelReqHeight);
+		GetMenuIndicatorGeometry(menuPtr, mePtr, tkfont, fmPtr,
+			&mePtr->indicReqWidth, &mePtr->indicReqHeight);
+		mePtr->entryFlags |= ENTRY_GEOM_CACHED;
+	    }
+
+	    width = mePtr->labelReqWidth;
+	    mePtr->height = mePtr->labelReqHeight;
 	    if (!mePtr->hideMargin) {
 		width += MENU_MARGIN_WIDTH;
 	    }
@@ -1764,10 +1780,9 @@ TkpComputeStandardMenuGeometry(
 	    	labelWidth = width;
 	    }
 
-	    GetMenuAccelGeometry(menuPtr, mePtr, tkfont,
-		    fmPtr, &width, &height);
-	    if (height > mePtr->height) {
-	    	mePtr->height = height;
+	    width = mePtr->accelReqWidth;
+	    if (mePtr->accelReqHeight > mePtr->height) {
+	    	mePtr->height = mePtr->accelReqHeight;
 	    }
 	    if (!mePtr->hideMargin) {
 		width += MENU_MARGIN_WIDTH;
@@ -1776,10 +1791,9 @@ TkpComputeStandardMenuGeometry(
 	    	accelWidth = width;
 	    }
 
-	    GetMenuIndicatorGeometry(menuPtr, mePtr, tkfont, fmPtr,
-		    &width, &height);
-	    if (height > mePtr->height) {
-	    	mePtr->height = height;
+	    width = mePtr->indicReqWidth;
+	    if (mePtr->indicReqHeight > mePtr->height) {
+	    	mePtr->height = mePtr->indicReqHeight;
 	    }
 	    if (!mePtr->hideMargin) {
 		width += MENU_MARGIN_WIDTH;
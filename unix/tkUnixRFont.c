@@ -14,6 +14,19 @@
 #include <X11/Xft/Xft.h>
 
 #define MAX_CACHED_COLORS 16
+#define GLYPH_CACHE_SIZE 256
+
+/*
+ * Cached per-codepoint glyph information, so that measuring and drawing do
+ * not have to go back to Xft for codepoints that have been seen before.
+ */
+
+typedef struct {
+    FT_UInt glyph;		/* Glyph index of the codepoint. */
+    XGlyphInfo info;		/* Extents of the glyph. */
+    int cached;			/* Non-zero means this entry has been filled
+				 * in (only needed in the flat table). */
+} GlyphMetrics;
 
 typedef struct {
     XftFont *ftFont;
@@ -42,6 +55,17 @@ typedef struct {
     int ncolors;
     int firstColor;
     UnixFtColorList colors[MAX_CACHED_COLORS];
+    GlyphMetrics glyphMetrics[GLYPH_CACHE_SIZE];
+				/* Cached glyph indices and extents for
+				 * codepoints below GLYPH_CACHE_SIZE. */
+    Tcl_HashTable glyphTable;	/* Maps higher codepoints to ckalloc'ed
+				 * GlyphMetrics structures. */
+    short faceIdx[GLYPH_CACHE_SIZE];
+				/* Cached face resolutions, biased by one,
+				 * for codepoints below GLYPH_CACHE_SIZE; 0
+				 * means not yet resolved. */
+    Tcl_HashTable faceTable;	/* Maps higher codepoints to their resolved
+				 * face index, biased by one. */
 } UnixFtFont;
 
 /*
@@ -95,18 +119,45 @@ GetFont(
     FcChar32 ucs4,
     double angle)
 {
-    int i;
+    Tcl_HashEntry *hPtr;
+    int i, isNew;
 
     if (ucs4) {
-	for (i = 0; i < fontPtr->nfaces; i++) {
-	    FcCharSet *charset = fontPtr->faces[i].charset;
+	/*
+	 * Face resolution for a codepoint is expensive (a FcCharSetHasChar
+	 * probe per face) and deterministic for the lifetime of the font,
+	 * so consult the per-font cache first.
+	 */
 
-	    if (charset && FcCharSetHasChar(charset, ucs4)) {
-		break;
+	i = 0;
+	if (ucs4 < GLYPH_CACHE_SIZE) {
+	    i = fontPtr->faceIdx[ucs4];
+	} else {
+	    hPtr = Tcl_FindHashEntry(&fontPtr->faceTable, INT2PTR(ucs4));
+	    if (hPtr != NULL) {
+		i = PTR2INT(Tcl_GetHashValue(hPtr));
 	    }
 	}
-	if (i == fontPtr->nfaces) {
-	    i = 0;
+	if (i > 0) {
+	    i--;
+	} else {
+	    for (i = 0; i < fontPtr->nfaces; i++) {
+		FcCharSet *charset = fontPtr->faces[i].charset;
+
+		if (charset && FcCharSetHasChar(charset, ucs4)) {
+		    break;
+		}
+	    }
+	    if (i == fontPtr->nfaces) {
+		i = 0;
+	    }
+	    if (ucs4 < GLYPH_CACHE_SIZE) {
+		fontPtr->faceIdx[ucs4] = (short) (i + 1);
+	    } else {
+		hPtr = Tcl_CreateHashEntry(&fontPtr->faceTable, INT2PTR(ucs4),
+			&isNew);
+		Tcl_SetHashValue(hPtr, INT2PTR(i + 1));
+	    }
 	}
     } else {
 	i = 0;
@@ -333,6 +384,10 @@ InitFont(
     fontPtr->ftDraw = 0;
     fontPtr->ncolors = 0;
     fontPtr->firstColor = -1;
+    memset(fontPtr->glyphMetrics, 0, sizeof(fontPtr->glyphMetrics));
+    Tcl_InitHashTable(&fontPtr->glyphTable, TCL_ONE_WORD_KEYS);
+    memset(fontPtr->faceIdx, 0, sizeof(fontPtr->faceIdx));
+    Tcl_InitHashTable(&fontPtr->faceTable, TCL_ONE_WORD_KEYS);
 
     /*
      * Fill in platform-specific fields of TkFont.
@@ -442,6 +497,17 @@ FinishedWithFont(
     if (fontPtr->fontset) {
 	FcFontSetDestroy(fontPtr->fontset);
     }
+    {
+	Tcl_HashEntry *hPtr;
+	Tcl_HashSearch search;
+
+	for (hPtr = Tcl_FirstHashEntry(&fontPtr->glyphTable, &search);
+		hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	    ckfree(Tcl_GetHashValue(hPtr));
+	}
+	Tcl_DeleteHashTable(&fontPtr->glyphTable);
+    }
+    Tcl_DeleteHashTable(&fontPtr->faceTable);
     Tk_DeleteErrorHandler(handler);
 }
 
@@ -687,6 +753,86 @@ TkpGetFontAttrsForChar(
     faPtr->overstrike = fontPtr->font.fa.overstrike;
 }
 
+/*
+ *---------------------------------------------------------------------------
+ *
+ * GetGlyphMetrics --
+ *
+ *	Fill in the glyph index and extents of a character in a font,
+ *	consulting Xft only the first time each codepoint is seen. ASCII and
+ *	Latin-1 hits are a simple table load; higher codepoints go through a
+ *	per-font hash table.
+ *
+ * Results:
+ *	*resultPtr is filled with the glyph information. If errorFlagPtr is
+ *	non-NULL and an X error is pending, *resultPtr is zeroed and the
+ *	flag is cleared, matching the old recovery behavior of
+ *	Tk_MeasureChars.
+ *
+ * Side effects:
+ *	May record the glyph information in the font's cache.
+ *
+ *---------------------------------------------------------------------------
+ */
+
+static void
+GetGlyphMetrics(
+    UnixFtFont *fontPtr,	/* Font the character belongs to. */
+    XftFont *ftFont,		/* Face that actually renders the character. */
+    FcChar32 c,			/* Character to look up. */
+    int *errorFlagPtr,		/* If non-NULL, set by InitFontErrorProc when
+				 * an X error has occurred; checked and
+				 * cleared here. NULL means the caller does
+				 * no error tracking. */
+    GlyphMetrics *resultPtr)	/* Filled with the glyph information. */
+{
+    GlyphMetrics *gmPtr;
+    Tcl_HashEntry *hPtr;
+    int isNew;
+
+    if (c < GLYPH_CACHE_SIZE) {
+	gmPtr = &fontPtr->glyphMetrics[c];
+	if (gmPtr->cached) {
+	    *resultPtr = *gmPtr;
+	    return;
+	}
+    } else {
+	hPtr = Tcl_FindHashEntry(&fontPtr->glyphTable, INT2PTR(c));
+	if (hPtr != NULL) {
+	    *resultPtr = *(GlyphMetrics *)Tcl_GetHashValue(hPtr);
+	    return;
+	}
+    }
+
+    memset(resultPtr, 0, sizeof(GlyphMetrics));
+    if ((errorFlagPtr != NULL) && *errorFlagPtr) {
+	*errorFlagPtr = 0;
+	return;
+    }
+    resultPtr->glyph = XftCharIndex(fontPtr->display, ftFont, c);
+    XftGlyphExtents(fontPtr->display, ftFont, &resultPtr->glyph, 1,
+	    &resultPtr->info);
+    resultPtr->cached = 1;
+
+    /*
+     * Don't cache information that may have been corrupted by an X error.
+     */
+
+    if ((errorFlagPtr != NULL) && *errorFlagPtr) {
+	return;
+    }
+    if (c < GLYPH_CACHE_SIZE) {
+	fontPtr->glyphMetrics[c] = *resultPtr;
+    } else {
+	hPtr = Tcl_CreateHashEntry(&fontPtr->glyphTable, INT2PTR(c), &isNew);
+	if (isNew) {
+	    gmPtr = (GlyphMetrics *)ckalloc(sizeof(GlyphMetrics));
+	    *gmPtr = *resultPtr;
+	    Tcl_SetHashValue(hPtr, gmPtr);
+	}
+    }
+}
+
 int
 Tk_MeasureChars(
     Tk_Font tkfont,		/* Font in which characters will be drawn. */
@@ -713,7 +859,7 @@ Tk_MeasureChars(
     UnixFtFont *fontPtr = (UnixFtFont *) tkfont;
     XftFont *ftFont;
     FcChar32 c;
-    XGlyphInfo extents;
+    GlyphMetrics gm;
     int clen, curX, newX, curByte, newByte, sawNonSpace;
     int termByte = 0, termX = 0, errorFlag = 0;
     Tk_ErrorHandler handler;
@@ -759,14 +905,8 @@ Tk_MeasureChars(
 #endif /* DEBUG_FONTSEL */
 	ftFont = GetFont(fontPtr, c, 0.0);
 
-	if (!errorFlag) {
-	    XftTextExtents32(fontPtr->display, ftFont, &c, 1, &extents);
-	} else {
-	    extents.xOff = 0;
-	    errorFlag = 0;
-	}
-
-	newX = curX + extents.xOff;
+	GetGlyphMetrics(fontPtr, ftFont, c, &errorFlag, &gm);
+	newX = curX + gm.info.xOff;
 	newByte = curByte + clen;
 	if (maxLength >= 0 && newX > maxLength) {
 	    if (flags & TK_PARTIAL_OK ||
@@ -929,7 +1069,7 @@ Tk_DrawChars(
     XftColor *xftcolor;
     int clen, nspec, xStart = x;
     XftGlyphFontSpec specs[NUM_SPEC];
-    XGlyphInfo metrics;
+    GlyphMetrics gm;
     ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
             Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
@@ -970,17 +1110,16 @@ Tk_DrawChars(
 
 	ftFont = GetFont(fontPtr, c, 0.0);
 	if (ftFont) {
-	    specs[nspec].glyph = XftCharIndex(fontPtr->display, ftFont, c);
-	    XftGlyphExtents(fontPtr->display, ftFont, &specs[nspec].glyph, 1,
-		    &metrics);
+	    GetGlyphMetrics(fontPtr, ftFont, c, NULL, &gm);
+	    specs[nspec].glyph = gm.glyph;
 
 	    /*
 	     * Draw glyph only when it fits entirely into 16 bit coords.
 	     */
 
 	    if (x >= minCoord && y >= minCoord &&
-		x <= maxCoord - metrics.width &&
-		y <= maxCoord - metrics.height) {
+		x <= maxCoord - gm.info.width &&
+		y <= maxCoord - gm.info.height) {
 		specs[nspec].font = ftFont;
 		specs[nspec].x = x;
 		specs[nspec].y = y;
@@ -990,8 +1129,8 @@ Tk_DrawChars(
 		    nspec = 0;
 		}
 	    }
-	    x += metrics.xOff;
-	    y += metrics.yOff;
+	    x += gm.info.xOff;
+	    y += gm.info.yOff;
 	}
     }
     if (nspec) {
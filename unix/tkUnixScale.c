@@ -17,17 +17,39 @@
 #define snprintf _snprintf
 #endif
 
+/*
+ * Declaration of Unix specific scale structure. The static parts of the
+ * widget (background, tick marks, trough, label, border and highlight) are
+ * rendered once into backgroundPixmap and blitted from there on each
+ * redisplay, so that dragging the slider only has to redraw the slider and
+ * the value readout on top of the cached background.
+ */
+
+typedef struct UnixScale {
+    TkScale info;		/* Generic scale info. */
+    Pixmap backgroundPixmap;	/* Cached rendering of everything except the
+				 * slider and the value readout. None means
+				 * the cache has not been built yet. */
+    int backgroundWidth;	/* Dimensions of backgroundPixmap; a redraw
+				 * at any other size rebuilds the cache. */
+    int backgroundHeight;
+} UnixScale;
+
 /*
  * Forward declarations for functions defined later in this file:
  */
 
 static void		DisplayHorizontalScale(TkScale *scalePtr,
-			    Drawable drawable, XRectangle *drawnAreaPtr);
+			    Drawable drawable);
+static void		DisplayHorizontalSlider(TkScale *scalePtr,
+			    Drawable drawable);
 static void		DisplayHorizontalValue(TkScale *scalePtr,
 			    Drawable drawable, double value, int top,
 			    const char *format);
 static void		DisplayVerticalScale(TkScale *scalePtr,
-			    Drawable drawable, XRectangle *drawnAreaPtr);
+			    Drawable drawable);
+static void		DisplayVerticalSlider(TkScale *scalePtr,
+			    Drawable drawable);
 static void		DisplayVerticalValue(TkScale *scalePtr,
 			    Drawable drawable, double value, int rightEdge,
 			    const char *format);
@@ -52,7 +74,12 @@ TkScale *
 TkpCreateScale(
     TCL_UNUSED(Tk_Window))
 {
-    return (TkScale *)ckalloc(sizeof(TkScale));
+    UnixScale *unixScalePtr = (UnixScale *)ckalloc(sizeof(UnixScale));
+
+    unixScalePtr->backgroundPixmap = None;
+    unixScalePtr->backgroundWidth = 0;
+    unixScalePtr->backgroundHeight = 0;
+    return (TkScale *) unixScalePtr;
 }
 
 /*
@@ -77,6 +104,12 @@ void
 TkpDestroyScale(
     TkScale *scalePtr)
 {
+    UnixScale *unixScalePtr = (UnixScale *) scalePtr;
+
+    if (unixScalePtr->backgroundPixmap != None) {
+	Tk_FreePixmap(scalePtr->display, unixScalePtr->backgroundPixmap);
+	unixScalePtr->backgroundPixmap = None;
+    }
     Tcl_EventuallyFree(scalePtr, TCL_DYNAMIC);
 }
 
@@ -85,17 +118,15 @@ TkpDestroyScale(
  *
  * DisplayVerticalScale --
  *
- *	This function redraws the contents of a vertical scale window. It is
- *	invoked as a do-when-idle handler, so it only runs when there's
- *	nothing else for the application to do.
+ *	This function redraws the static parts of a vertical scale window:
+ *	background, tick marks, trough and label. The slider and the value
+ *	readout are drawn separately by DisplayVerticalSlider.
  *
  * Results:
- *	There is no return value. If only a part of the scale needs to be
- *	redrawn, then drawnAreaPtr is modified to reflect the area that was
- *	actually modified.
+ *	None.
  *
  * Side effects:
- *	Information appears on the screen.
+ *	Information is drawn into drawable.
  *
  *--------------------------------------------------------------
  */
@@ -103,86 +134,62 @@ TkpDestroyScale(
 static void
 DisplayVerticalScale(
     TkScale *scalePtr,		/* Widget record for scale. */
-    Drawable drawable,		/* Where to display scale (window or
+    Drawable drawable)		/* Where to display scale (window or
 				 * pixmap). */
-    XRectangle *drawnAreaPtr)	/* Initally contains area of window; if only a
-				 * part of the scale is redrawn, gets modified
-				 * to reflect the part of the window that was
-				 * redrawn. */
 {
     Tk_Window tkwin = scalePtr->tkwin;
-    int x, y, width, height, shadowWidth;
     double tickValue, tickInterval = scalePtr->tickInterval;
-    Tk_3DBorder sliderBorder;
 
     /*
      * Display the information from left to right across the window.
      */
 
-    if (!(scalePtr->flags & REDRAW_OTHER)) {
-	drawnAreaPtr->x = scalePtr->vertTickRightX;
-	drawnAreaPtr->y = scalePtr->inset;
-	drawnAreaPtr->width = scalePtr->vertTroughX + scalePtr->width
-		+ 2*scalePtr->borderWidth - scalePtr->vertTickRightX;
-	drawnAreaPtr->height -= 2*scalePtr->inset;
-    }
     Tk_Fill3DRectangle(tkwin, drawable, scalePtr->bgBorder,
-	    drawnAreaPtr->x, drawnAreaPtr->y, drawnAreaPtr->width,
-	    drawnAreaPtr->height, 0, TK_RELIEF_FLAT);
-    if (scalePtr->flags & REDRAW_OTHER) {
+	    0, 0, Tk_Width(tkwin), Tk_Height(tkwin), 0, TK_RELIEF_FLAT);
+
+    /*
+     * Display the tick marks.
+     */
+
+    if (tickInterval != 0) {
+	double ticks, maxTicks;
+
 	/*
-	 * Display the tick marks.
+	 * Ensure that we will only draw enough of the tick values such
+	 * that they don't overlap
 	 */
 
-	if (tickInterval != 0) {
-	    double ticks, maxTicks;
-
+	ticks = fabs((scalePtr->toValue - scalePtr->fromValue)
+		/ tickInterval);
+	maxTicks = (double) Tk_Height(tkwin)
+		/ (double) scalePtr->fontHeight;
+	if (ticks > maxTicks) {
+	    tickInterval *= (ticks / maxTicks);
+	}
+	for (tickValue = scalePtr->fromValue; ;
+		tickValue += tickInterval) {
 	    /*
-	     * Ensure that we will only draw enough of the tick values such
-	     * that they don't overlap
+	     * The TkRoundValueToResolution call gets rid of accumulated
+	     * round-off errors, if any.
 	     */
 
-	    ticks = fabs((scalePtr->toValue - scalePtr->fromValue)
-		    / tickInterval);
-	    maxTicks = (double) Tk_Height(tkwin)
-		    / (double) scalePtr->fontHeight;
-	    if (ticks > maxTicks) {
-		tickInterval *= (ticks / maxTicks);
-	    }
-	    for (tickValue = scalePtr->fromValue; ;
-		    tickValue += tickInterval) {
-		/*
-		 * The TkRoundValueToResolution call gets rid of accumulated
-		 * round-off errors, if any.
-		 */
-
-		tickValue = TkRoundValueToResolution(scalePtr, tickValue);
-		if (scalePtr->toValue >= scalePtr->fromValue) {
-		    if (tickValue > scalePtr->toValue) {
-			break;
-		    }
-		} else {
-		    if (tickValue < scalePtr->toValue) {
-			break;
-		    }
+	    tickValue = TkRoundValueToResolution(scalePtr, tickValue);
+	    if (scalePtr->toValue >= scalePtr->fromValue) {
+		if (tickValue > scalePtr->toValue) {
+		    break;
+		}
+	    } else {
+		if (tickValue < scalePtr->toValue) {
+		    break;
 		}
-		DisplayVerticalValue(scalePtr, drawable, tickValue,
-			scalePtr->vertTickRightX, scalePtr->tickFormat);
 	    }
+	    DisplayVerticalValue(scalePtr, drawable, tickValue,
+		    scalePtr->vertTickRightX, scalePtr->tickFormat);
 	}
     }
 
     /*
-     * Display the value, if it is desired.
-     */
-
-    if (scalePtr->showValue) {
-	DisplayVerticalValue(scalePtr, drawable, scalePtr->value,
-		scalePtr->vertValueRightX, scalePtr->valueFormat);
-    }
-
-    /*
-     * Display the trough and the slider.
+     * Display the trough.
      */
 
     Tk_Draw3DRectangle(tkwin, drawable,
@@ -196,6 +203,63 @@ DisplayVerticalScale(
 	    (unsigned) scalePtr->width,
 	    (unsigned) (Tk_Height(tkwin) - 2*scalePtr->inset
 		- 2*scalePtr->borderWidth));
+
+    /*
+     * Draw the label to the right of the scale.
+     */
+
+    if (scalePtr->labelLength != 0) {
+	Tk_FontMetrics fm;
+
+	Tk_GetFontMetrics(scalePtr->tkfont, &fm);
+	Tk_DrawChars(scalePtr->display, drawable, scalePtr->textGC,
+		scalePtr->tkfont, scalePtr->label,
+		scalePtr->labelLength, scalePtr->vertLabelX,
+		scalePtr->inset + (3 * fm.ascent) / 2);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * DisplayVerticalSlider --
+ *
+ *	This function redraws the moving parts of a vertical scale window:
+ *	the slider and, if desired, the value readout. It assumes that the
+ *	static parts of the widget are already present in the drawable.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Information is drawn into drawable.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+DisplayVerticalSlider(
+    TkScale *scalePtr,		/* Widget record for scale. */
+    Drawable drawable)		/* Where to display scale (window or
+				 * pixmap). */
+{
+    Tk_Window tkwin = scalePtr->tkwin;
+    int x, y, width, height, shadowWidth;
+    Tk_3DBorder sliderBorder;
+
+    /*
+     * Display the value, if it is desired.
+     */
+
+    if (scalePtr->showValue) {
+	DisplayVerticalValue(scalePtr, drawable, scalePtr->value,
+		scalePtr->vertValueRightX, scalePtr->valueFormat);
+    }
+
+    /*
+     * Display the slider.
+     */
+
     if (scalePtr->state == STATE_ACTIVE) {
 	sliderBorder = scalePtr->activeBorder;
     } else {
@@ -219,20 +283,6 @@ DisplayVerticalScale(
 	    height, shadowWidth, scalePtr->sliderRelief);
     Tk_Fill3DRectangle(tkwin, drawable, sliderBorder, x, y+height,
 	    width, height, shadowWidth, scalePtr->sliderRelief);
-
-    /*
-     * Draw the label to the right of the scale.
-     */
-
-    if ((scalePtr->flags & REDRAW_OTHER) && (scalePtr->labelLength != 0)) {
-	Tk_FontMetrics fm;
-
-	Tk_GetFontMetrics(scalePtr->tkfont, &fm);
-	Tk_DrawChars(scalePtr->display, drawable, scalePtr->textGC,
-		scalePtr->tkfont, scalePtr->label,
-		scalePtr->labelLength, scalePtr->vertLabelX,
-		scalePtr->inset + (3 * fm.ascent) / 2);
-    }
 }
 
 /*
@@ -300,17 +350,15 @@ DisplayVerticalValue(
  *
  * DisplayHorizontalScale --
  *
- *	This function redraws the contents of a horizontal scale window. It is
- *	invoked as a do-when-idle handler, so it only runs when there's
- *	nothing else for the application to do.
+ *	This function redraws the static parts of a horizontal scale window:
+ *	background, tick marks, trough and label. The slider and the value
+ *	readout are drawn separately by DisplayHorizontalSlider.
  *
  * Results:
- *	There is no return value. If only a part of the scale needs to be
- *	redrawn, then drawnAreaPtr is modified to reflect the area that was
- *	actually modified.
+ *	None.
  *
  * Side effects:
- *	Information appears on the screen.
+ *	Information is drawn into drawable.
  *
  *--------------------------------------------------------------
  */
@@ -318,93 +366,70 @@ DisplayVerticalValue(
 static void
 DisplayHorizontalScale(
     TkScale *scalePtr,		/* Widget record for scale. */
-    Drawable drawable,		/* Where to display scale (window or
+    Drawable drawable)		/* Where to display scale (window or
 				 * pixmap). */
-    XRectangle *drawnAreaPtr)	/* Initally contains area of window; if only a
-				 * part of the scale is redrawn, gets modified
-				 * to reflect the part of the window that was
-				 * redrawn. */
 {
     Tk_Window tkwin = scalePtr->tkwin;
-    int x, y, width, height, shadowWidth;
+    int y;
     double tickInterval = scalePtr->tickInterval;
-    Tk_3DBorder sliderBorder;
 
     /*
      * Display the information from bottom to top across the window.
      */
 
-    if (!(scalePtr->flags & REDRAW_OTHER)) {
-	drawnAreaPtr->x = scalePtr->inset;
-	drawnAreaPtr->y = scalePtr->horizValueY;
-	drawnAreaPtr->width -= 2*scalePtr->inset;
-	drawnAreaPtr->height = scalePtr->horizTroughY + scalePtr->width
-		+ 2*scalePtr->borderWidth - scalePtr->horizValueY;
-    }
     Tk_Fill3DRectangle(tkwin, drawable, scalePtr->bgBorder,
-	    drawnAreaPtr->x, drawnAreaPtr->y, drawnAreaPtr->width,
-	    drawnAreaPtr->height, 0, TK_RELIEF_FLAT);
-    if (scalePtr->flags & REDRAW_OTHER) {
+	    0, 0, Tk_Width(tkwin), Tk_Height(tkwin), 0, TK_RELIEF_FLAT);
+
+    /*
+     * Display the tick marks.
+     */
+
+    if (tickInterval != 0) {
+	char valueString[TCL_DOUBLE_SPACE];
+	double ticks, maxTicks, tickValue;
+
 	/*
-	 * Display the tick marks.
+	 * Ensure that we will only draw enough of the tick values such
+	 * that they don't overlap. We base this off the width that
+	 * fromValue would take. Not exact, but better than no constraint.
 	 */
 
-	if (tickInterval != 0) {
-	    char valueString[TCL_DOUBLE_SPACE];
-	    double ticks, maxTicks, tickValue;
-
+	ticks = fabs((scalePtr->toValue - scalePtr->fromValue)
+		/ tickInterval);
+	if (snprintf(valueString, TCL_DOUBLE_SPACE, scalePtr->tickFormat,
+		scalePtr->fromValue) < 0) {
+	    valueString[TCL_DOUBLE_SPACE - 1] = '\0';
+	}
+	maxTicks = (double) Tk_Width(tkwin)
+		/ (double) Tk_TextWidth(scalePtr->tkfont, valueString, -1);
+	if (ticks > maxTicks) {
+	    tickInterval *= ticks / maxTicks;
+	}
+	tickValue = scalePtr->fromValue;
+	while (1) {
 	    /*
-	     * Ensure that we will only draw enough of the tick values such
-	     * that they don't overlap. We base this off the width that
-	     * fromValue would take. Not exact, but better than no constraint.
+	     * The TkRoundValueToResolution call gets rid of accumulated
+	     * round-off errors, if any.
 	     */
 
-	    ticks = fabs((scalePtr->toValue - scalePtr->fromValue)
-		    / tickInterval);
-	    if (snprintf(valueString, TCL_DOUBLE_SPACE, scalePtr->tickFormat,
-		    scalePtr->fromValue) < 0) {
-		valueString[TCL_DOUBLE_SPACE - 1] = '\0';
-	    }
-	    maxTicks = (double) Tk_Width(tkwin)
-		    / (double) Tk_TextWidth(scalePtr->tkfont, valueString, -1);
-	    if (ticks > maxTicks) {
-		tickInterval *= ticks / maxTicks;
-	    }
-	    tickValue = scalePtr->fromValue;
-	    while (1) {
-		/*
-		 * The TkRoundValueToResolution call gets rid of accumulated
-		 * round-off errors, if any.
-		 */
-
-		tickValue = TkRoundValueToResolution(scalePtr, tickValue);
-		if (scalePtr->toValue >= scalePtr->fromValue) {
-		    if (tickValue > scalePtr->toValue) {
-			break;
-		    }
-		} else {
-		    if (tickValue < scalePtr->toValue) {
-			break;
-		    }
+	    tickValue = TkRoundValueToResolution(scalePtr, tickValue);
+	    if (scalePtr->toValue >= scalePtr->fromValue) {
+		if (tickValue > scalePtr->toValue) {
+		    break;
+		}
+	    } else {
+		if (tickValue < scalePtr->toValue) {
+		    break;
 		}
-		DisplayHorizontalValue(scalePtr, drawable, tickValue,
-			scalePtr->horizTickY, scalePtr->tickFormat);
-		tickValue += tickInterval;
 	    }
+	    DisplayHorizontalValue(scalePtr, drawable, tickValue,
+		    scalePtr->horizTickY, scalePtr->tickFormat);
+	    tickValue += tickInterval;
 	}
     }
 
     /*
-     * Display the value, if it is desired.
-     */
-
-    if (scalePtr->showValue) {
-	DisplayHorizontalValue(scalePtr, drawable, scalePtr->value,
-		scalePtr->horizValueY, scalePtr->valueFormat);
-    }
-
-    /*
-     * Display the trough and the slider.
+     * Display the trough.
      */
 
     y = scalePtr->horizTroughY;
@@ -419,6 +444,63 @@ DisplayHorizontalScale(
 	    (unsigned) (Tk_Width(tkwin) - 2*scalePtr->inset
 		- 2*scalePtr->borderWidth),
 	    (unsigned) scalePtr->width);
+
+    /*
+     * Draw the label at the top of the scale.
+     */
+
+    if (scalePtr->labelLength != 0) {
+	Tk_FontMetrics fm;
+
+	Tk_GetFontMetrics(scalePtr->tkfont, &fm);
+	Tk_DrawChars(scalePtr->display, drawable, scalePtr->textGC,
+		scalePtr->tkfont, scalePtr->label,
+		scalePtr->labelLength, scalePtr->inset + fm.ascent/2,
+		scalePtr->horizLabelY + fm.ascent);
+    }
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * DisplayHorizontalSlider --
+ *
+ *	This function redraws the moving parts of a horizontal scale window:
+ *	the slider and, if desired, the value readout. It assumes that the
+ *	static parts of the widget are already present in the drawable.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Information is drawn into drawable.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+DisplayHorizontalSlider(
+    TkScale *scalePtr,		/* Widget record for scale. */
+    Drawable drawable)		/* Where to display scale (window or
+				 * pixmap). */
+{
+    Tk_Window tkwin = scalePtr->tkwin;
+    int x, y, width, height, shadowWidth;
+    Tk_3DBorder sliderBorder;
+
+    /*
+     * Display the value, if it is desired.
+     */
+
+    if (scalePtr->showValue) {
+	DisplayHorizontalValue(scalePtr, drawable, scalePtr->value,
+		scalePtr->horizValueY, scalePtr->valueFormat);
+    }
+
+    /*
+     * Display the slider.
+     */
+
     if (scalePtr->state == STATE_ACTIVE) {
 	sliderBorder = scalePtr->activeBorder;
     } else {
@@ -427,7 +509,7 @@ DisplayHorizontalScale(
     width = scalePtr->sliderLength/2;
     height = scalePtr->width;
     x = TkScaleValueToPixel(scalePtr, scalePtr->value) - width;
-    y += scalePtr->borderWidth;
+    y = scalePtr->horizTroughY + scalePtr->borderWidth;
     shadowWidth = scalePtr->borderWidth/2;
     if (shadowWidth == 0) {
 	shadowWidth = 1;
@@ -442,20 +524,6 @@ DisplayHorizontalScale(
 	    shadowWidth, scalePtr->sliderRelief);
     Tk_Fill3DRectangle(tkwin, drawable, sliderBorder, x+width, y,
 	    width, height, shadowWidth, scalePtr->sliderRelief);
-
-    /*
-     * Draw the label at the top of the scale.
-     */
-
-    if ((scalePtr->flags & REDRAW_OTHER) && (scalePtr->labelLength != 0)) {
-	Tk_FontMetrics fm;
-
-	Tk_GetFontMetrics(scalePtr->tkfont, &fm);
-	Tk_DrawChars(scalePtr->display, drawable, scalePtr->textGC,
-		scalePtr->tkfont, scalePtr->label,
-		scalePtr->labelLength, scalePtr->inset + fm.ascent/2,
-		scalePtr->horizLabelY + fm.ascent);
-    }
 }
 
 /*
@@ -547,6 +615,7 @@ TkpDisplayScale(
     ClientData clientData)	/* Widget record for scale. */
 {
     TkScale *scalePtr = (TkScale *)clientData;
+    UnixScale *unixScalePtr = (UnixScale *)clientData;
     Tk_Window tkwin = scalePtr->tkwin;
     Tcl_Interp *interp = scalePtr->interp;
     Pixmap pixmap;
@@ -590,43 +659,46 @@ TkpDisplayScale(
     }
     Tcl_Release(scalePtr);
 
-#ifndef TK_NO_DOUBLE_BUFFERING
     /*
-     * In order to avoid screen flashes, this function redraws the scale in a
-     * pixmap, then copies the pixmap to the screen in a single operation.
-     * This means that there's no point in time where the on-sreen image has
-     * been cleared.
+     * The static parts of the scale (background, ticks, trough, label,
+     * border and highlight) are kept in a cached pixmap and only re-rendered
+     * when the window size changes or when something other than the slider
+     * needs to be redrawn. During a slider drag only the slider and the
+     * value readout get redrawn, on top of a copy of the cached background.
      */
 
-    pixmap = Tk_GetPixmap(scalePtr->display, Tk_WindowId(tkwin),
-	    Tk_Width(tkwin), Tk_Height(tkwin), Tk_Depth(tkwin));
-#else
-    pixmap = Tk_WindowId(tkwin);
-#endif /* TK_NO_DOUBLE_BUFFERING */
-    drawnArea.x = 0;
-    drawnArea.y = 0;
-    drawnArea.width = Tk_Width(tkwin);
-    drawnArea.height = Tk_Height(tkwin);
+    if ((unixScalePtr->backgroundPixmap == None)
+	    || (unixScalePtr->backgroundWidth != Tk_Width(tkwin))
+	    || (unixScalePtr->backgroundHeight != Tk_Height(tkwin))
+	    || (scalePtr->flags & REDRAW_OTHER)) {
+	if (unixScalePtr->backgroundPixmap != None) {
+	    Tk_FreePixmap(scalePtr->display, unixScalePtr->backgroundPixmap);
+	}
+	unixScalePtr->backgroundPixmap = Tk_GetPixmap(scalePtr->display,
+		Tk_WindowId(tkwin), Tk_Width(tkwin), Tk_Height(tkwin),
+		Tk_Depth(tkwin));
+	unixScalePtr->backgroundWidth = Tk_Width(tkwin);
+	unixScalePtr->backgroundHeight = Tk_Height(tkwin);
 
-    /*
-     * Much of the redisplay is done totally differently for horizontal and
-     * vertical scales. Handle the part that's different.
-     */
+	/*
+	 * Much of the redisplay is done totally differently for horizontal
+	 * and vertical scales. Handle the part that's different.
+	 */
 
-    if (scalePtr->orient == ORIENT_VERTICAL) {
-	DisplayVerticalScale(scalePtr, pixmap, &drawnArea);
-    } else {
-	DisplayHorizontalScale(scalePtr, pixmap, &drawnArea);
-    }
+	if (scalePtr->orient == ORIENT_VERTICAL) {
+	    DisplayVerticalScale(scalePtr, unixScalePtr->backgroundPixmap);
+	} else {
+	    DisplayHorizontalScale(scalePtr, unixScalePtr->backgroundPixmap);
+	}
 
-    /*
-     * Now handle the part of redisplay that is the same for horizontal and
-     * vertical scales: border and traversal highlight.
-     */
+	/*
+	 * Now handle the part of redisplay that is the same for horizontal
+	 * and vertical scales: border and traversal highlight.
+	 */
 
-    if (scalePtr->flags & REDRAW_OTHER) {
 	if (scalePtr->relief != TK_RELIEF_FLAT) {
-	    Tk_Draw3DRectangle(tkwin, pixmap, scalePtr->bgBorder,
+	    Tk_Draw3DRectangle(tkwin, unixScalePtr->backgroundPixmap,
+		    scalePtr->bgBorder,
 		    scalePtr->highlightWidth, scalePtr->highlightWidth,
 		    Tk_Width(tkwin) - 2*scalePtr->highlightWidth,
 		    Tk_Height(tkwin) - 2*scalePtr->highlightWidth,
@@ -636,13 +708,60 @@ TkpDisplayScale(
 	    GC gc;
 
 	    if (scalePtr->flags & GOT_FOCUS) {
-		gc = Tk_GCForColor(scalePtr->highlightColorPtr, pixmap);
+		gc = Tk_GCForColor(scalePtr->highlightColorPtr,
+			unixScalePtr->backgroundPixmap);
 	    } else {
 		gc = Tk_GCForColor(
-			Tk_3DBorderColor(scalePtr->highlightBorder), pixmap);
+			Tk_3DBorderColor(scalePtr->highlightBorder),
+			unixScalePtr->backgroundPixmap);
 	    }
-	    Tk_DrawFocusHighlight(tkwin, gc, scalePtr->highlightWidth, pixmap);
+	    Tk_DrawFocusHighlight(tkwin, gc, scalePtr->highlightWidth,
+		    unixScalePtr->backgroundPixmap);
 	}
+	drawnArea.x = 0;
+	drawnArea.y = 0;
+	drawnArea.width = Tk_Width(tkwin);
+	drawnArea.height = Tk_Height(tkwin);
+    } else if (scalePtr->orient == ORIENT_VERTICAL) {
+	drawnArea.x = scalePtr->vertTickRightX;
+	drawnArea.y = scalePtr->inset;
+	drawnArea.width = scalePtr->vertTroughX + scalePtr->width
+		+ 2*scalePtr->borderWidth - scalePtr->vertTickRightX;
+	drawnArea.height = Tk_Height(tkwin) - 2*scalePtr->inset;
+    } else {
+	drawnArea.x = scalePtr->inset;
+	drawnArea.y = scalePtr->horizValueY;
+	drawnArea.width = Tk_Width(tkwin) - 2*scalePtr->inset;
+	drawnArea.height = scalePtr->horizTroughY + scalePtr->width
+		+ 2*scalePtr->borderWidth - scalePtr->horizValueY;
+    }
+
+#ifndef TK_NO_DOUBLE_BUFFERING
+    /*
+     * In order to avoid screen flashes, this function redraws the scale in a
+     * pixmap, then copies the pixmap to the screen in a single operation.
+     * This means that there's no point in time where the on-sreen image has
+     * been cleared.
+     */
+
+    pixmap = Tk_GetPixmap(scalePtr->display, Tk_WindowId(tkwin),
+	    Tk_Width(tkwin), Tk_Height(tkwin), Tk_Depth(tkwin));
+#else
+    pixmap = Tk_WindowId(tkwin);
+#endif /* TK_NO_DOUBLE_BUFFERING */
+
+    /*
+     * Copy the cached background into the redrawn area, then draw the
+     * slider and value readout on top of it.
+     */
+
+    XCopyArea(scalePtr->display, unixScalePtr->backgroundPixmap, pixmap,
+	    scalePtr->copyGC, drawnArea.x, drawnArea.y, drawnArea.width,
+	    drawnArea.height, drawnArea.x, drawnArea.y);
+    if (scalePtr->orient == ORIENT_VERTICAL) {
+	DisplayVerticalSlider(scalePtr, pixmap);
+    } else {
+	DisplayHorizontalSlider(scalePtr, pixmap);
     }
 
 #ifndef TK_NO_DOUBLE_BUFFERING
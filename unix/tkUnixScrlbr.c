@@ -28,6 +28,16 @@ typedef struct UnixScrollbar {
     TkScrollbar info;		/* Generic scrollbar info. */
     GC troughGC;		/* For drawing trough. */
     GC copyGC;			/* Used for copying from pixmap onto screen. */
+    Pixmap cachePixmap;		/* Cached rendering of everything except the
+				 * slider, or None. See TkpDisplayScrollbar. */
+    int cacheWidth;		/* Dimensions of cachePixmap. */
+    int cacheHeight;
+    int cacheActiveField;	/* Value of activeField when the cache was
+				 * rendered; the arrows depend on it. */
+    int cacheFocus;		/* GOT_FOCUS flag value when the cache was
+				 * rendered. */
+    int cacheValid;		/* Non-zero means cachePixmap is up to date
+				 * with the widget's configuration. */
 } UnixScrollbar;
 
 /*
@@ -67,6 +77,8 @@ TkpCreateScrollbar(
 
     scrollPtr->troughGC = NULL;
     scrollPtr->copyGC = NULL;
+    scrollPtr->cachePixmap = None;
+    scrollPtr->cacheValid = 0;
 
     Tk_CreateEventHandler(tkwin,
 	    ExposureMask|StructureNotifyMask|FocusChangeMask,
@@ -98,6 +110,7 @@ TkpDisplayScrollbar(
     ClientData clientData)	/* Information about window. */
 {
     TkScrollbar *scrollPtr = (TkScrollbar *)clientData;
+    UnixScrollbar *unixScrollPtr = (UnixScrollbar *)clientData;
     Tk_Window tkwin = scrollPtr->tkwin;
     XPoint points[7];
     Tk_3DBorder border;
@@ -119,105 +132,143 @@ TkpDisplayScrollbar(
     }
 
     /*
-     * In order to avoid screen flashes, this procedure redraws the scrollbar
-     * in a pixmap, then copies the pixmap to the screen in a single
-     * operation. This means that there's no point in time where the on-sreen
-     * image has been cleared.
+     * Everything except the slider (focus highlight, border, trough and the
+     * two arrows) only changes when the widget is reconfigured or resized or
+     * when the active element or the focus state changes. It is therefore
+     * rendered into a cached pixmap and blitted from there on each
+     * redisplay, so that scrolling only has to redraw the slider.
      */
 
-    pixmap = Tk_GetPixmap(scrollPtr->display, Tk_WindowId(tkwin),
-	    Tk_Width(tkwin), Tk_Height(tkwin), Tk_Depth(tkwin));
+    if (!unixScrollPtr->cacheValid
+	    || (unixScrollPtr->cacheWidth != Tk_Width(tkwin))
+	    || (unixScrollPtr->cacheHeight != Tk_Height(tkwin))
+	    || (unixScrollPtr->cacheActiveField != scrollPtr->activeField)
+	    || (unixScrollPtr->cacheFocus
+		    != (scrollPtr->flags & GOT_FOCUS))) {
+	if ((unixScrollPtr->cachePixmap != None)
+		&& ((unixScrollPtr->cacheWidth != Tk_Width(tkwin))
+		    || (unixScrollPtr->cacheHeight != Tk_Height(tkwin)))) {
+	    Tk_FreePixmap(scrollPtr->display, unixScrollPtr->cachePixmap);
+	    unixScrollPtr->cachePixmap = None;
+	}
+	if (unixScrollPtr->cachePixmap == None) {
+	    unixScrollPtr->cachePixmap = Tk_GetPixmap(scrollPtr->display,
+		    Tk_WindowId(tkwin), Tk_Width(tkwin), Tk_Height(tkwin),
+		    Tk_Depth(tkwin));
+	}
+	pixmap = unixScrollPtr->cachePixmap;
 
-    if (scrollPtr->highlightWidth != 0) {
-	GC gc;
+	if (scrollPtr->highlightWidth != 0) {
+	    GC gc;
 
-	if (scrollPtr->flags & GOT_FOCUS) {
-	    gc = Tk_GCForColor(scrollPtr->highlightColorPtr, pixmap);
+	    if (scrollPtr->flags & GOT_FOCUS) {
+		gc = Tk_GCForColor(scrollPtr->highlightColorPtr, pixmap);
+	    } else {
+		gc = Tk_GCForColor(scrollPtr->highlightBgColorPtr, pixmap);
+	    }
+	    Tk_DrawFocusHighlight(tkwin, gc, scrollPtr->highlightWidth, pixmap);
+	}
+	Tk_Draw3DRectangle(tkwin, pixmap, scrollPtr->bgBorder,
+		scrollPtr->highlightWidth, scrollPtr->highlightWidth,
+		Tk_Width(tkwin) - 2*scrollPtr->highlightWidth,
+		Tk_Height(tkwin) - 2*scrollPtr->highlightWidth,
+		scrollPtr->borderWidth, scrollPtr->relief);
+	XFillRectangle(scrollPtr->display, pixmap,
+		unixScrollPtr->troughGC,
+		scrollPtr->inset, scrollPtr->inset,
+		(unsigned) (Tk_Width(tkwin) - 2*scrollPtr->inset),
+		(unsigned) (Tk_Height(tkwin) - 2*scrollPtr->inset));
+
+	/*
+	 * Draw the top or left arrow. The coordinates of the polygon points
+	 * probably seem odd, but they were carefully chosen with respect to
+	 * X's rules for filling polygons. These point choices cause the
+	 * arrows to just fill the narrow dimension of the scrollbar and be
+	 * properly centered.
+	 */
+
+	if (scrollPtr->activeField == TOP_ARROW) {
+	    border = scrollPtr->activeBorder;
+	    relief = scrollPtr->activeField == TOP_ARROW
+		    ? scrollPtr->activeRelief : TK_RELIEF_RAISED;
 	} else {
-	    gc = Tk_GCForColor(scrollPtr->highlightBgColorPtr, pixmap);
+	    border = scrollPtr->bgBorder;
+	    relief = TK_RELIEF_RAISED;
+	}
+	if (scrollPtr->vertical) {
+	    points[0].x = scrollPtr->inset - 1;
+	    points[0].y = scrollPtr->arrowLength + scrollPtr->inset - 1;
+	    points[1].x = width + scrollPtr->inset;
+	    points[1].y = points[0].y;
+	    points[2].x = width/2 + scrollPtr->inset;
+	    points[2].y = scrollPtr->inset - 1;
+	    Tk_Fill3DPolygon(tkwin, pixmap, border, points, 3,
+		    elementBorderWidth, relief);
+	} else {
+	    points[0].x = scrollPtr->arrowLength + scrollPtr->inset - 1;
+	    points[0].y = scrollPtr->inset - 1;
+	    points[1].x = scrollPtr->inset;
+	    points[1].y = width/2 + scrollPtr->inset;
+	    points[2].x = points[0].x;
+	    points[2].y = width + scrollPtr->inset;
+	    Tk_Fill3DPolygon(tkwin, pixmap, border, points, 3,
+		    elementBorderWidth, relief);
 	}
-	Tk_DrawFocusHighlight(tkwin, gc, scrollPtr->highlightWidth, pixmap);
-    }
-    Tk_Draw3DRectangle(tkwin, pixmap, scrollPtr->bgBorder,
-	    scrollPtr->highlightWidth, scrollPtr->highlightWidth,
-	    Tk_Width(tkwin) - 2*scrollPtr->highlightWidth,
-	    Tk_Height(tkwin) - 2*scrollPtr->highlightWidth,
-	    scrollPtr->borderWidth, scrollPtr->relief);
-    XFillRectangle(scrollPtr->display, pixmap,
-	    ((UnixScrollbar*)scrollPtr)->troughGC,
-	    scrollPtr->inset, scrollPtr->inset,
-	    (unsigned) (Tk_Width(tkwin) - 2*scrollPtr->inset),
-	    (unsigned) (Tk_Height(tkwin) - 2*scrollPtr->inset));
 
-    /*
-     * Draw the top or left arrow. The coordinates of the polygon points
-     * probably seem odd, but they were carefully chosen with respect to X's
-     * rules for filling polygons. These point choices cause the arrows to
-     * just fill the narrow dimension of the scrollbar and be properly
-     * centered.
-     */
+	/*
+	 * Display the bottom or right arrow.
+	 */
 
-    if (scrollPtr->activeField == TOP_ARROW) {
-	border = scrollPtr->activeBorder;
-	relief = scrollPtr->activeField == TOP_ARROW ? scrollPtr->activeRelief
-		: TK_RELIEF_RAISED;
-    } else {
-	border = scrollPtr->bgBorder;
-	relief = TK_RELIEF_RAISED;
-    }
-    if (scrollPtr->vertical) {
-	points[0].x = scrollPtr->inset - 1;
-	points[0].y = scrollPtr->arrowLength + scrollPtr->inset - 1;
-	points[1].x = width + scrollPtr->inset;
-	points[1].y = points[0].y;
-	points[2].x = width/2 + scrollPtr->inset;
-	points[2].y = scrollPtr->inset - 1;
-	Tk_Fill3DPolygon(tkwin, pixmap, border, points, 3,
-		elementBorderWidth, relief);
-    } else {
-	points[0].x = scrollPtr->arrowLength + scrollPtr->inset - 1;
-	points[0].y = scrollPtr->inset - 1;
-	points[1].x = scrollPtr->inset;
-	points[1].y = width/2 + scrollPtr->inset;
-	points[2].x = points[0].x;
-	points[2].y = width + scrollPtr->inset;
-	Tk_Fill3DPolygon(tkwin, pixmap, border, points, 3,
-		elementBorderWidth, relief);
+	if (scrollPtr->activeField == BOTTOM_ARROW) {
+	    border = scrollPtr->activeBorder;
+	    relief = scrollPtr->activeField == BOTTOM_ARROW
+		    ? scrollPtr->activeRelief : TK_RELIEF_RAISED;
+	} else {
+	    border = scrollPtr->bgBorder;
+	    relief = TK_RELIEF_RAISED;
+	}
+	if (scrollPtr->vertical) {
+	    points[0].x = scrollPtr->inset;
+	    points[0].y = Tk_Height(tkwin) - scrollPtr->arrowLength
+		    - scrollPtr->inset + 1;
+	    points[1].x = width/2 + scrollPtr->inset;
+	    points[1].y = Tk_Height(tkwin) - scrollPtr->inset;
+	    points[2].x = width + scrollPtr->inset;
+	    points[2].y = points[0].y;
+	    Tk_Fill3DPolygon(tkwin, pixmap, border,
+		    points, 3, elementBorderWidth, relief);
+	} else {
+	    points[0].x = Tk_Width(tkwin) - scrollPtr->arrowLength
+		    - scrollPtr->inset + 1;
+	    points[0].y = scrollPtr->inset - 1;
+	    points[1].x = points[0].x;
+	    points[1].y = width + scrollPtr->inset;
+	    points[2].x = Tk_Width(tkwin) - scrollPtr->inset;
+	    points[2].y = width/2 + scrollPtr->inset;
+	    Tk_Fill3DPolygon(tkwin, pixmap, border,
+		    points, 3, elementBorderWidth, relief);
+	}
+
+	unixScrollPtr->cacheWidth = Tk_Width(tkwin);
+	unixScrollPtr->cacheHeight = Tk_Height(tkwin);
+	unixScrollPtr->cacheActiveField = scrollPtr->activeField;
+	unixScrollPtr->cacheFocus = scrollPtr->flags & GOT_FOCUS;
+	unixScrollPtr->cacheValid = 1;
     }
 
     /*
-     * Display the bottom or right arrow.
+     * In order to avoid screen flashes, this procedure redraws the scrollbar
+     * in a pixmap, then copies the pixmap to the screen in a single
+     * operation. This means that there's no point in time where the on-sreen
+     * image has been cleared. The pixmap starts out as a copy of the cached
+     * background, so only the slider remains to be drawn.
      */
 
-    if (scrollPtr->activeField == BOTTOM_ARROW) {
-	border = scrollPtr->activeBorder;
-	relief = scrollPtr->activeField == BOTTOM_ARROW
-		? scrollPtr->activeRelief : TK_RELIEF_RAISED;
-    } else {
-	border = scrollPtr->bgBorder;
-	relief = TK_RELIEF_RAISED;
-    }
-    if (scrollPtr->vertical) {
-	points[0].x = scrollPtr->inset;
-	points[0].y = Tk_Height(tkwin) - scrollPtr->arrowLength
-		- scrollPtr->inset + 1;
-	points[1].x = width/2 + scrollPtr->inset;
-	points[1].y = Tk_Height(tkwin) - scrollPtr->inset;
-	points[2].x = width + scrollPtr->inset;
-	points[2].y = points[0].y;
-	Tk_Fill3DPolygon(tkwin, pixmap, border,
-		points, 3, elementBorderWidth, relief);
-    } else {
-	points[0].x = Tk_Width(tkwin) - scrollPtr->arrowLength
-		- scrollPtr->inset + 1;
-	points[0].y = scrollPtr->inset - 1;
-	points[1].x = points[0].x;
-	points[1].y = width + scrollPtr->inset;
-	points[2].x = Tk_Width(tkwin) - scrollPtr->inset;
-	points[2].y = width/2 + scrollPtr->inset;
-	Tk_Fill3DPolygon(tkwin, pixmap, border,
-		points, 3, elementBorderWidth, relief);
-    }
+    pixmap = Tk_GetPixmap(scrollPtr->display, Tk_WindowId(tkwin),
+	    Tk_Width(tkwin), Tk_Height(tkwin), Tk_Depth(tkwin));
+    XCopyArea(scrollPtr->display, unixScrollPtr->cachePixmap, pixmap,
+	    unixScrollPtr->copyGC, 0, 0,
+	    (unsigned) Tk_Width(tkwin), (unsigned) Tk_Height(tkwin), 0, 0);
 
     /*
      * Display the slider.
@@ -249,7 +300,7 @@ TkpDisplayScrollbar(
      */
 
     XCopyArea(scrollPtr->display, pixmap, Tk_WindowId(tkwin),
-	    ((UnixScrollbar*)scrollPtr)->copyGC, 0, 0,
+	    unixScrollPtr->copyGC, 0, 0,
 	    (unsigned) Tk_Width(tkwin), (unsigned) Tk_Height(tkwin), 0, 0);
     Tk_FreePixmap(scrollPtr->display, pixmap);
 
@@ -372,6 +423,9 @@ TkpDestroyScrollbar(
     if (unixScrollPtr->copyGC != NULL) {
 	Tk_FreeGC(scrollPtr->display, unixScrollPtr->copyGC);
     }
+    if (unixScrollPtr->cachePixmap != None) {
+	Tk_FreePixmap(scrollPtr->display, unixScrollPtr->cachePixmap);
+    }
 }
 
 /*
@@ -415,6 +469,7 @@ TkpConfigureScrollbar(
 	unixScrollPtr->copyGC = Tk_GetGC(scrollPtr->tkwin,
 		GCGraphicsExposures, &gcValues);
     }
+    unixScrollPtr->cacheValid = 0;
 }
 
 /*
@@ -100,6 +100,7 @@ static long *		SelCvtToX(char *string, Atom type, Tk_Window tkwin,
 static int		SelectionSize(TkSelHandler *selPtr);
 static void		SelRcvIncrProc(ClientData clientData,
 			    XEvent *eventPtr);
+static void		SelRcvProperty(TkSelRetrievalInfo *retrPtr);
 static void		SelTimeoutProc(ClientData clientData);
 
 /*
@@ -161,6 +162,7 @@ TkSelGetSelection(
     retr.result = -1;
     retr.idleTime = 0;
     retr.encFlags = TCL_ENCODING_START;
+    retr.multiple = 0;
     retr.nextPtr = pendingRetrievals;
     Tcl_DStringInit(&retr.buf);
     pendingRetrievals = &retr;
@@ -216,6 +218,154 @@ TkSelGetSelection(
     Tcl_DStringFree(&retr.buf);
     return retr.result;
 }
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkSelGetSelectionMultiple --
+ *
+ *	Retrieve the specified selection from another process in several
+ *	target forms at once, using the ICCCM MULTIPLE protocol. The owner
+ *	converts all of the targets in response to a single request, so the
+ *	whole batch costs one round trip to the server instead of one per
+ *	target; this matters when probing many targets over a high-latency
+ *	connection.
+ *
+ * Results:
+ *	The return value is TCL_OK if every target was converted
+ *	successfully, TCL_ERROR otherwise. results is filled in with a
+ *	standard Tcl return value for each target; for each target that
+ *	converted, proc has been called with the corresponding entry of
+ *	clientDatas and the converted data. When any target fails, the
+ *	interp's result holds an error message for one of the failures.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+int
+TkSelGetSelectionMultiple(
+    Tcl_Interp *interp,		/* Interpreter to use for reporting errors. */
+    Tk_Window tkwin,		/* Window on whose behalf to retrieve the
+				 * selection (determines display from which to
+				 * retrieve). */
+    Atom selection,		/* Selection to retrieve. */
+    int numTargets,		/* Number of entries in targets. */
+    Atom *targets,		/* Desired forms in which selection is to be
+				 * returned. */
+    Tk_GetSelProc *proc,	/* Function to call to process each converted
+				 * target, once it has been retrieved. */
+    ClientData *clientDatas,	/* One value per target to pass to proc. */
+    int *results)		/* Filled in with a standard Tcl return value
+				 * for each target. */
+{
+    TkSelRetrievalInfo *retrs;
+    TkWindow *winPtr = (TkWindow *) tkwin;
+    TkDisplay *dispPtr = winPtr->dispPtr;
+    Atom *pairs;
+    Window reqWindow;
+    int i, result;
+
+    if (numTargets <= 0) {
+	return TCL_OK;
+    }
+
+    if (dispPtr->clipWindow == NULL) {
+	result = TkClipInit(interp, dispPtr);
+	if (result != TCL_OK) {
+	    for (i = 0; i < numTargets; i++) {
+		results[i] = result;
+	    }
+	    return result;
+	}
+    }
+    reqWindow = ((TkWindow *) dispPtr->clipWindow)->window;
+
+    /*
+     * Record one retrieval in progress per target. Each conversion arrives
+     * in its own property on the requestor; use the target atom as the
+     * property name, which keeps the properties distinct.
+     */
+
+    retrs = (TkSelRetrievalInfo *)
+	    ckalloc(numTargets * sizeof(TkSelRetrievalInfo));
+    pairs = (Atom *) ckalloc(2 * numTargets * sizeof(Atom));
+    for (i = 0; i < numTargets; i++) {
+	retrs[i].interp = interp;
+	retrs[i].winPtr = (TkWindow *) dispPtr->clipWindow;
+	retrs[i].selection = selection;
+	retrs[i].property = targets[i];
+	retrs[i].target = targets[i];
+	retrs[i].proc = proc;
+	retrs[i].clientData = clientDatas[i];
+	retrs[i].result = -1;
+	retrs[i].idleTime = 0;
+	retrs[i].encFlags = TCL_ENCODING_START;
+	retrs[i].multiple = 1;
+	Tcl_DStringInit(&retrs[i].buf);
+	retrs[i].nextPtr = pendingRetrievals;
+	pendingRetrievals = &retrs[i];
+
+	XDeleteProperty(winPtr->display, reqWindow, retrs[i].property);
+	pairs[2*i] = targets[i];
+	pairs[2*i + 1] = targets[i];
+    }
+
+    /*
+     * Store the (target, property) pairs that parameterize the conversion,
+     * then issue the single MULTIPLE request. As in TkSelGetSelection,
+     * CurrentTime must be used rather than TkCurrentTime.
+     */
+
+    XChangeProperty(winPtr->display, reqWindow, dispPtr->multipleAtom,
+	    dispPtr->atomPairAtom, 32, PropModeReplace,
+	    (unsigned char *) pairs, 2 * numTargets);
+    XConvertSelection(winPtr->display, selection, dispPtr->multipleAtom,
+	    dispPtr->multipleAtom, reqWindow, CurrentTime);
+    ckfree(pairs);
+
+    /*
+     * Enter a loop processing X events until every conversion has been
+     * retrieved and processed or has timed out.
+     */
+
+    for (i = 0; i < numTargets; i++) {
+	retrs[i].timeout = Tcl_CreateTimerHandler(1000, SelTimeoutProc,
+		&retrs[i]);
+    }
+    for (i = 0; i < numTargets; i++) {
+	while (retrs[i].result == -1) {
+	    Tcl_DoOneEvent(0);
+	}
+    }
+
+    /*
+     * Unregister the retrievals and collect the per-target results.
+     */
+
+    result = TCL_OK;
+    for (i = 0; i < numTargets; i++) {
+	TkSelRetrievalInfo **nextPtrPtr = &pendingRetrievals;
+
+	Tcl_DeleteTimerHandler(retrs[i].timeout);
+	while (*nextPtrPtr != NULL) {
+	    if (*nextPtrPtr == &retrs[i]) {
+		*nextPtrPtr = retrs[i].nextPtr;
+		break;
+	    }
+	    nextPtrPtr = &(*nextPtrPtr)->nextPtr;
+	}
+	Tcl_DStringFree(&retrs[i].buf);
+	results[i] = retrs[i].result;
+	if (retrs[i].result != TCL_OK) {
+	    result = TCL_ERROR;
+	}
+    }
+    ckfree(retrs);
+    return result;
+}
 
 /*
  *----------------------------------------------------------------------
@@ -244,7 +394,8 @@ TkSelPropProc(
 {
     IncrInfo *incrPtr;
     TkSelHandler *selPtr;
-    int length, numItems;
+    int length, numItems, sentLength, maxChunkSize;
+    long maxRequestWords;
     unsigned long i;
     Atom target, formatType;
     long buffer[TK_SEL_WORDS_AT_ONCE];
@@ -262,6 +413,35 @@ TkSelPropProc(
     if (eventPtr->xproperty.state != PropertyDelete) {
 	return;
     }
+
+    /*
+     * Compute how much data to ship in one property.  String chunks produced
+     * by the selection handler are batched up to this size before being
+     * stored, so that each server round trip moves as much of the selection
+     * as the server will accept in a single request (and our own receiving
+     * code will read back, which is what MAX_PROP_WORDS limits).
+     */
+
+    maxRequestWords = XExtendedMaxRequestSize(eventPtr->xproperty.display);
+    if (maxRequestWords == 0) {
+	maxRequestWords = XMaxRequestSize(eventPtr->xproperty.display);
+    }
+    maxChunkSize = MAX_PROP_WORDS * 4;
+    if ((long) maxChunkSize > (maxRequestWords - 8) * 4) {
+	maxChunkSize = (int) ((maxRequestWords - 8) * 4);
+    }
+
+    /*
+     * The size check in the batching loop below is only made between chunks,
+     * so the encoded data may overshoot the target by one chunk; leave room
+     * for that (with space to spare for encoding expansion) so the stored
+     * property never exceeds the limits computed above.
+     */
+
+    maxChunkSize -= 8 * TK_SEL_BYTES_AT_ONCE;
+    if (maxChunkSize < TK_SEL_BYTES_AT_ONCE) {
+	maxChunkSize = TK_SEL_BYTES_AT_ONCE;
+    }
     for (incrPtr = tsdPtr->pendingIncrs; incrPtr != NULL;
 	    incrPtr = incrPtr->nextPtr) {
 	if (incrPtr->reqWindow != eventPtr->xproperty.window) {
@@ -370,19 +550,8 @@ TkSelPropProc(
 		int srcLen, dstLen, result, srcRead, dstWrote, soFar;
 		char *src, *dst;
 		Tcl_Encoding encoding;
+		TkSelInProgress ip;
 
-		/*
-		 * Set up the encoding state based on the format and whether
-		 * this is the first and/or last chunk.
-		 */
-
-		encodingCvtFlags = 0;
-		if (incrPtr->converts[i].offset == 0) {
-		    encodingCvtFlags |= TCL_ENCODING_START;
-		}
-		if (numItems < TK_SEL_BYTES_AT_ONCE) {
-		    encodingCvtFlags |= TCL_ENCODING_END;
-		}
 		if (formatType == XA_STRING) {
 		    encoding = Tcl_GetEncoding(NULL, "iso8859-1");
 		} else if (dispPtr && formatType==dispPtr->utf8Atom) {
@@ -392,41 +561,119 @@ TkSelPropProc(
 		}
 
 		/*
-		 * Now convert the data.
+		 * Convert handler chunks and append them to the property
+		 * value until either the handler runs out of data or the
+		 * property reaches the negotiated chunk size.  Batching the
+		 * chunks this way costs one server round trip per property
+		 * instead of one per TK_SEL_BYTES_AT_ONCE bytes.
 		 */
 
-		src = (char *)buffer;
-		srcLen = numItems;
 		Tcl_DStringInit(&ds);
-		dst = Tcl_DStringValue(&ds);
-		dstLen = ds.spaceAvl - 1;
+		while (1) {
+		    /*
+		     * Set up the encoding state based on the format and
+		     * whether this is the first and/or last chunk.
+		     */
 
+		    encodingCvtFlags = 0;
+		    if (incrPtr->converts[i].offset == 0) {
+			encodingCvtFlags |= TCL_ENCODING_START;
+		    }
+		    if (numItems < TK_SEL_BYTES_AT_ONCE) {
+			encodingCvtFlags |= TCL_ENCODING_END;
+		    }
 
-		/*
-		 * Now convert the data, growing the destination buffer as
-		 * needed.
-		 */
+		    /*
+		     * Now convert the data, growing the destination buffer
+		     * as needed.
+		     */
 
-		while (1) {
-		    result = Tcl_UtfToExternal(NULL, encoding, src, srcLen,
-			    encodingCvtFlags, &incrPtr->converts[i].state,
-			    dst, dstLen, &srcRead, &dstWrote, NULL);
-		    soFar = dst + dstWrote - Tcl_DStringValue(&ds);
-		    encodingCvtFlags &= ~TCL_ENCODING_START;
-		    src += srcRead;
-		    srcLen -= srcRead;
-		    if (result != TCL_CONVERT_NOSPACE) {
-			Tcl_DStringSetLength(&ds, soFar);
+		    src = (char *)buffer;
+		    srcLen = numItems;
+		    soFar = Tcl_DStringLength(&ds);
+		    dst = Tcl_DStringValue(&ds) + soFar;
+		    dstLen = ds.spaceAvl - soFar - 1;
+		    if (dstLen < 0) {
+			dstLen = 0;
+		    }
+
+		    while (1) {
+			result = Tcl_UtfToExternal(NULL, encoding, src,
+				srcLen, encodingCvtFlags,
+				&incrPtr->converts[i].state,
+				dst, dstLen, &srcRead, &dstWrote, NULL);
+			soFar = dst + dstWrote - Tcl_DStringValue(&ds);
+			encodingCvtFlags &= ~TCL_ENCODING_START;
+			src += srcRead;
+			srcLen -= srcRead;
+			if (result != TCL_CONVERT_NOSPACE) {
+			    break;
+			}
+			if (Tcl_DStringLength(&ds) < soFar) {
+			    Tcl_DStringSetLength(&ds, soFar);
+			}
+			if (Tcl_DStringLength(&ds) == 0) {
+			    Tcl_DStringSetLength(&ds, dstLen);
+			}
+			Tcl_DStringSetLength(&ds,
+				2 * Tcl_DStringLength(&ds) + 1);
+			dst = Tcl_DStringValue(&ds) + soFar;
+			dstLen = Tcl_DStringLength(&ds) - soFar - 1;
+		    }
+		    Tcl_DStringSetLength(&ds, soFar);
+
+		    /*
+		     * Preserve any left-over bytes.
+		     */
+
+		    if (srcLen > 3) {
+			Tcl_Panic("selection conversion left too many bytes unconverted");
+		    }
+		    memcpy(incrPtr->converts[i].buffer, src, srcLen + 1);
+
+		    if ((numItems < TK_SEL_BYTES_AT_ONCE)
+			    || (Tcl_DStringLength(&ds) >= maxChunkSize)) {
 			break;
 		    }
-		    if (Tcl_DStringLength(&ds) == 0) {
-			Tcl_DStringSetLength(&ds, dstLen);
+
+		    /*
+		     * There is more selection data and the property still
+		     * has room, so get the next chunk from the handler.
+		     */
+
+		    incrPtr->converts[i].offset += numItems - length;
+		    length = strlen(incrPtr->converts[i].buffer);
+		    strcpy((char *)buffer, incrPtr->converts[i].buffer);
+
+		    ip.selPtr = selPtr;
+		    ip.nextPtr = TkSelGetInProgress();
+		    TkSelSetInProgress(&ip);
+		    numItems = selPtr->proc(selPtr->clientData,
+			    incrPtr->converts[i].offset,
+			    ((char *) buffer) + length,
+			    TK_SEL_BYTES_AT_ONCE - length);
+		    TkSelSetInProgress(ip.nextPtr);
+		    if (ip.selPtr == NULL) {
+			/*
+			 * The selection handler deleted itself.
+			 */
+
+			Tcl_DStringFree(&ds);
+			if (encoding) {
+			    Tcl_FreeEncoding(encoding);
+			}
+			Tk_DeleteErrorHandler(errorHandler);
+			return;
+		    }
+		    if (numItems < 0) {
+			numItems = 0;
 		    }
-		    Tcl_DStringSetLength(&ds, 2 * Tcl_DStringLength(&ds) + 1);
-		    dst = Tcl_DStringValue(&ds) + soFar;
-		    dstLen = Tcl_DStringLength(&ds) - soFar - 1;
+		    numItems += length;
+		    if (numItems > TK_SEL_BYTES_AT_ONCE) {
+			Tcl_Panic("selection handler returned too many bytes");
+		    }
+		    ((char *) buffer)[numItems] = 0;
 		}
-		Tcl_DStringSetLength(&ds, soFar);
 
 		if (encoding) {
 		    Tcl_FreeEncoding(encoding);
@@ -436,20 +683,12 @@ TkSelPropProc(
 		 * Set the property to the encoded string value.
 		 */
 
+		sentLength = Tcl_DStringLength(&ds);
 		XChangeProperty(eventPtr->xproperty.display,
 			eventPtr->xproperty.window, eventPtr->xproperty.atom,
 			formatType, 8, PropModeReplace,
 			(unsigned char *) Tcl_DStringValue(&ds),
 			Tcl_DStringLength(&ds));
-
-		/*
-		 * Preserve any left-over bytes.
-		 */
-
-		if (srcLen > 3) {
-		    Tcl_Panic("selection conversion left too many bytes unconverted");
-		}
-		memcpy(incrPtr->converts[i].buffer, src, srcLen + 1);
 		Tcl_DStringFree(&ds);
 	    } else {
 		/*
@@ -462,6 +701,7 @@ TkSelPropProc(
 		if (propPtr == NULL) {
 		    numItems = 0;
 		}
+		sentLength = numItems;
 		XChangeProperty(eventPtr->xproperty.display,
 			eventPtr->xproperty.window, eventPtr->xproperty.atom,
 			formatType, 32, PropModeReplace,
@@ -474,12 +714,12 @@ TkSelPropProc(
 
 	    /*
 	     * Compute the next offset value. If this was the last chunk, then
-	     * set the offset to -2. If this was an empty chunk, then set the
-	     * offset to -1 to indicate we are done.
+	     * set the offset to -2. If the property just stored was empty,
+	     * then set the offset to -1 to indicate we are done.
 	     */
 
 	    if (numItems < TK_SEL_BYTES_AT_ONCE) {
-		if (numItems <= 0) {
+		if ((numItems <= 0) && (sentLength == 0)) {
 		    incrPtr->converts[i].offset = -1;
 		    incrPtr->numIncrs--;
 		} else {
@@ -524,7 +764,6 @@ TkSelEventProc(
 {
     TkWindow *winPtr = (TkWindow *) tkwin;
     TkDisplay *dispPtr = winPtr->dispPtr;
-    Tcl_Interp *interp;
 
     /*
      * Case #1: SelectionClear events.
@@ -541,10 +780,37 @@ TkSelEventProc(
 
     if (eventPtr->type == SelectionNotify) {
 	TkSelRetrievalInfo *retrPtr;
-	char *propInfo, **propInfoPtr = &propInfo;
-	Atom type;
-	int format, result;
-	unsigned long numItems, bytesAfter;
+
+	/*
+	 * A MULTIPLE reply carries a single notify for the whole request:
+	 * the owner has stored each conversion in its own property on the
+	 * requestor. Demultiplex the reply over every member of the
+	 * pending group.
+	 */
+
+	if (eventPtr->xselection.target == dispPtr->multipleAtom) {
+	    for (retrPtr = pendingRetrievals; retrPtr != NULL;
+		    retrPtr = retrPtr->nextPtr) {
+		if ((retrPtr->winPtr != winPtr)
+			|| (retrPtr->selection
+			    != eventPtr->xselection.selection)
+			|| !retrPtr->multiple || (retrPtr->result != -1)) {
+		    continue;
+		}
+		if (eventPtr->xselection.property == None) {
+		    Tcl_SetObjResult(retrPtr->interp, Tcl_ObjPrintf(
+			    "%s selection doesn't exist or form \"%s\" not defined",
+			    Tk_GetAtomName(tkwin, retrPtr->selection),
+			    Tk_GetAtomName(tkwin, retrPtr->target)));
+		    Tcl_SetErrorCode(retrPtr->interp, "TK", "SELECTION",
+			    "NONE", NULL);
+		    retrPtr->result = TCL_ERROR;
+		} else {
+		    SelRcvProperty(retrPtr);
+		}
+	    }
+	    return;
+	}
 
 	for (retrPtr = pendingRetrievals; ; retrPtr = retrPtr->nextPtr) {
 	    if (retrPtr == NULL) {
@@ -570,153 +836,206 @@ TkSelEventProc(
 	    }
 	}
 
-	propInfo = NULL;
-	result = XGetWindowProperty(eventPtr->xselection.display,
-		eventPtr->xselection.requestor, retrPtr->property,
-		0, MAX_PROP_WORDS, False, (Atom) AnyPropertyType,
-		&type, &format, &numItems, &bytesAfter,
-		(unsigned char **) propInfoPtr);
-	if ((result != Success) || (type == None)) {
-	    return;
-	}
-	if (bytesAfter != 0) {
-	    Tcl_SetObjResult(retrPtr->interp, Tcl_NewStringObj(
-		    "selection property too large", -1));
-	    Tcl_SetErrorCode(retrPtr->interp, "TK", "SELECTION", "SIZE",NULL);
-	    retrPtr->result = TCL_ERROR;
-	    XFree(propInfo);
-	    return;
-	}
-	if ((type == XA_STRING) || (type == dispPtr->textAtom)
-		|| (type == dispPtr->compoundTextAtom)) {
-	    Tcl_Encoding encoding;
-		Tcl_DString ds;
+	SelRcvProperty(retrPtr);
+	return;
+    }
 
-	    if (format != 8) {
-		Tcl_SetObjResult(retrPtr->interp, Tcl_ObjPrintf(
-			"bad format for string selection: wanted \"8\", got \"%d\"",
-			format));
-		Tcl_SetErrorCode(retrPtr->interp, "TK", "SELECTION", "FORMAT",
-			NULL);
-		retrPtr->result = TCL_ERROR;
-		return;
-	    }
-	    interp = retrPtr->interp;
-	    Tcl_Preserve(interp);
+    /*
+     * Case #3: SelectionRequest events. Call ConvertSelection to do the dirty
+     * work.
+     */
 
-	    /*
-	     * Convert the X selection data into UTF before passing it to the
-	     * selection callback. Note that the COMPOUND_TEXT uses a modified
-	     * iso2022 encoding, not the current system encoding. For now
-	     * we'll just blindly apply the iso2022 encoding. This is probably
-	     * wrong, but it's a placeholder until we figure out what we're
-	     * really supposed to do. For STRING, we need to use Latin-1
-	     * instead. Again, it's not really the full iso8859-1 space, but
-	     * this is close enough.
-	     */
+    if (eventPtr->type == SelectionRequest) {
+	ConvertSelection(winPtr, &eventPtr->xselectionrequest);
+	return;
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * SelRcvProperty --
+ *
+ *	Process the property holding the converted selection for one
+ *	pending retrieval, after the owner has announced that the
+ *	conversion is complete. This covers plain transfers as well as
+ *	INCR-mode receptions, which loop here until all of the pieces
+ *	have arrived.
+ *
+ * Results:
+ *	None. retrPtr->result is set once the data has been handed to
+ *	retrPtr->proc or an error has been detected.
+ *
+ * Side effects:
+ *	Whatever retrPtr->proc does with the selection contents.
+ *
+ *----------------------------------------------------------------------
+ */
 
-	    if (type == dispPtr->compoundTextAtom) {
-		encoding = Tcl_GetEncoding(NULL, "iso2022");
-	    } else {
-		encoding = Tcl_GetEncoding(NULL, "iso8859-1");
-	    }
-	    Tcl_ExternalToUtfDString(encoding, propInfo, (int)numItems, &ds);
-	    if (encoding) {
-		Tcl_FreeEncoding(encoding);
-	    }
+static void
+SelRcvProperty(
+    TkSelRetrievalInfo *retrPtr)	/* Retrieval whose property is ready. */
+{
+    TkWindow *winPtr = retrPtr->winPtr;
+    Tk_Window tkwin = (Tk_Window) winPtr;
+    TkDisplay *dispPtr = winPtr->dispPtr;
+    Tcl_Interp *interp;
+    char *propInfo, **propInfoPtr = &propInfo;
+    Atom type;
+    int format, result;
+    unsigned long numItems, bytesAfter;
 
-	    retrPtr->result = retrPtr->proc(retrPtr->clientData, interp,
-		    Tcl_DStringValue(&ds));
-	    Tcl_DStringFree(&ds);
-	    Tcl_Release(interp);
-	} else if (type == dispPtr->utf8Atom) {
+    propInfo = NULL;
+    result = XGetWindowProperty(winPtr->display,
+	    winPtr->window, retrPtr->property,
+	    0, MAX_PROP_WORDS, False, (Atom) AnyPropertyType,
+	    &type, &format, &numItems, &bytesAfter,
+	    (unsigned char **) propInfoPtr);
+    if ((result != Success) || (type == None)) {
+	if (retrPtr->multiple) {
 	    /*
-	     * The X selection data is in UTF-8 format already. We can't
-	     * guarantee that propInfo is NULL-terminated, so we might have to
-	     * copy the string.
+	     * In a MULTIPLE reply a failed conversion simply leaves the
+	     * target's property unset; there is no per-target notify to
+	     * report it, so record the failure here.
 	     */
 
-	    char *propData = propInfo;
-
-	    if (format != 8) {
-		Tcl_SetObjResult(retrPtr->interp, Tcl_ObjPrintf(
-			"bad format for string selection: wanted \"8\", got \"%d\"",
-			format));
-		Tcl_SetErrorCode(retrPtr->interp, "TK", "SELECTION", "FORMAT",
-			NULL);
-		retrPtr->result = TCL_ERROR;
-		return;
-	    }
+	    Tcl_SetObjResult(retrPtr->interp, Tcl_ObjPrintf(
+		    "%s selection doesn't exist or form \"%s\" not defined",
+		    Tk_GetAtomName(tkwin, retrPtr->selection),
+		    Tk_GetAtomName(tkwin, retrPtr->target)));
+	    Tcl_SetErrorCode(retrPtr->interp, "TK", "SELECTION", "NONE",
+		    NULL);
+	    retrPtr->result = TCL_ERROR;
+	}
+	return;
+    }
+    if (bytesAfter != 0) {
+	Tcl_SetObjResult(retrPtr->interp, Tcl_NewStringObj(
+		"selection property too large", -1));
+	Tcl_SetErrorCode(retrPtr->interp, "TK", "SELECTION", "SIZE",NULL);
+	retrPtr->result = TCL_ERROR;
+	XFree(propInfo);
+	return;
+    }
+    if ((type == XA_STRING) || (type == dispPtr->textAtom)
+	    || (type == dispPtr->compoundTextAtom)) {
+	Tcl_Encoding encoding;
+	    Tcl_DString ds;
 
-	    if (propInfo[numItems] != '\0') {
-		propData = (char *)ckalloc(numItems + 1);
-		strcpy(propData, propInfo);
-		propData[numItems] = '\0';
-	    }
-	    retrPtr->result = retrPtr->proc(retrPtr->clientData,
-		    retrPtr->interp, propData);
-	    if (propData != propInfo) {
-		ckfree(propData);
-	    }
+	if (format != 8) {
+	    Tcl_SetObjResult(retrPtr->interp, Tcl_ObjPrintf(
+		    "bad format for string selection: wanted \"8\", got \"%d\"",
+		    format));
+	    Tcl_SetErrorCode(retrPtr->interp, "TK", "SELECTION", "FORMAT",
+		    NULL);
+	    retrPtr->result = TCL_ERROR;
+	    return;
+	}
+	interp = retrPtr->interp;
+	Tcl_Preserve(interp);
 
-	} else if (type == dispPtr->incrAtom) {
-	    /*
-	     * It's a !?#@!?!! INCR-style reception. Arrange to receive the
-	     * selection in pieces, using the ICCCM protocol, then hang around
-	     * until either the selection is all here or a timeout occurs.
-	     */
+	/*
+	 * Convert the X selection data into UTF before passing it to the
+	 * selection callback. Note that the COMPOUND_TEXT uses a modified
+	 * iso2022 encoding, not the current system encoding. For now
+	 * we'll just blindly apply the iso2022 encoding. This is probably
+	 * wrong, but it's a placeholder until we figure out what we're
+	 * really supposed to do. For STRING, we need to use Latin-1
+	 * instead. Again, it's not really the full iso8859-1 space, but
+	 * this is close enough.
+	 */
 
-	    retrPtr->idleTime = 0;
-	    Tk_CreateEventHandler(tkwin, PropertyChangeMask, SelRcvIncrProc,
-		    retrPtr);
-	    XDeleteProperty(Tk_Display(tkwin), Tk_WindowId(tkwin),
-		    retrPtr->property);
-	    while (retrPtr->result == -1) {
-		Tcl_DoOneEvent(0);
-	    }
-	    Tk_DeleteEventHandler(tkwin, PropertyChangeMask, SelRcvIncrProc,
-		    retrPtr);
+	if (type == dispPtr->compoundTextAtom) {
+	    encoding = Tcl_GetEncoding(NULL, "iso2022");
 	} else {
-	    Tcl_DString ds;
+	    encoding = Tcl_GetEncoding(NULL, "iso8859-1");
+	}
+	Tcl_ExternalToUtfDString(encoding, propInfo, (int)numItems, &ds);
+	if (encoding) {
+	    Tcl_FreeEncoding(encoding);
+	}
 
-	    if (format != 32 && format != 8) {
-		Tcl_SetObjResult(retrPtr->interp, Tcl_ObjPrintf(
-			"bad format for selection: wanted \"32\" or "
-			"\"8\", got \"%d\"", format));
-		Tcl_SetErrorCode(retrPtr->interp, "TK", "SELECTION", "FORMAT",
-			NULL);
-		retrPtr->result = TCL_ERROR;
-		return;
-	    }
-	    Tcl_DStringInit(&ds);
-	    if (format == 32) {
-		SelCvtFromX32((long *) propInfo, (int) numItems, type,
-			(Tk_Window) winPtr, &ds);
-	    } else {
-		SelCvtFromX8((char *) propInfo, (int) numItems, type,
-			(Tk_Window) winPtr, &ds);
-	    }
-	    interp = retrPtr->interp;
-	    Tcl_Preserve(interp);
-	    retrPtr->result = retrPtr->proc(retrPtr->clientData,
-		    interp, Tcl_DStringValue(&ds));
-	    Tcl_Release(interp);
-	    Tcl_DStringFree(&ds);
+	retrPtr->result = retrPtr->proc(retrPtr->clientData, interp,
+		Tcl_DStringValue(&ds));
+	Tcl_DStringFree(&ds);
+	Tcl_Release(interp);
+    } else if (type == dispPtr->utf8Atom) {
+	/*
+	 * The X selection data is in UTF-8 format already. We can't
+	 * guarantee that propInfo is NULL-terminated, so we might have to
+	 * copy the string.
+	 */
+
+	char *propData = propInfo;
+
+	if (format != 8) {
+	    Tcl_SetObjResult(retrPtr->interp, Tcl_ObjPrintf(
+		    "bad format for string selection: wanted \"8\", got \"%d\"",
+		    format));
+	    Tcl_SetErrorCode(retrPtr->interp, "TK", "SELECTION", "FORMAT",
+		    NULL);
+	    retrPtr->result = TCL_ERROR;
+	    return;
 	}
-	XFree(propInfo);
-	return;
-    }
 
-    /*
-     * Case #3: SelectionRequest events. Call ConvertSelection to do the dirty
-     * work.
-     */
+	if (propInfo[numItems] != '\0') {
+	    propData = (char *)ckalloc(numItems + 1);
+	    strcpy(propData, propInfo);
+	    propData[numItems] = '\0';
+	}
+	retrPtr->result = retrPtr->proc(retrPtr->clientData,
+		retrPtr->interp, propData);
+	if (propData != propInfo) {
+	    ckfree(propData);
+	}
 
-    if (eventPtr->type == SelectionRequest) {
-	ConvertSelection(winPtr, &eventPtr->xselectionrequest);
-	return;
+    } else if (type == dispPtr->incrAtom) {
+	/*
+	 * It's a !?#@!?!! INCR-style reception. Arrange to receive the
+	 * selection in pieces, using the ICCCM protocol, then hang around
+	 * until either the selection is all here or a timeout occurs.
+	 */
+
+	retrPtr->idleTime = 0;
+	Tk_CreateEventHandler(tkwin, PropertyChangeMask, SelRcvIncrProc,
+		retrPtr);
+	XDeleteProperty(Tk_Display(tkwin), Tk_WindowId(tkwin),
+		retrPtr->property);
+	while (retrPtr->result == -1) {
+	    Tcl_DoOneEvent(0);
+	}
+	Tk_DeleteEventHandler(tkwin, PropertyChangeMask, SelRcvIncrProc,
+		retrPtr);
+    } else {
+	Tcl_DString ds;
+
+	if (format != 32 && format != 8) {
+	    Tcl_SetObjResult(retrPtr->interp, Tcl_ObjPrintf(
+		    "bad format for selection: wanted \"32\" or "
+		    "\"8\", got \"%d\"", format));
+	    Tcl_SetErrorCode(retrPtr->interp, "TK", "SELECTION", "FORMAT",
+		    NULL);
+	    retrPtr->result = TCL_ERROR;
+	    return;
+	}
+	Tcl_DStringInit(&ds);
+	if (format == 32) {
+	    SelCvtFromX32((long *) propInfo, (int) numItems, type,
+		    (Tk_Window) winPtr, &ds);
+	} else {
+	    SelCvtFromX8((char *) propInfo, (int) numItems, type,
+		    (Tk_Window) winPtr, &ds);
+	}
+	interp = retrPtr->interp;
+	Tcl_Preserve(interp);
+	retrPtr->result = retrPtr->proc(retrPtr->clientData,
+		interp, Tcl_DStringValue(&ds));
+	Tcl_Release(interp);
+	Tcl_DStringFree(&ds);
     }
+    XFree(propInfo);
 }
+
 
 /*
  *----------------------------------------------------------------------
@@ -13,6 +13,9 @@
  */
 
 #include "tkUnixInt.h"
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 /*
  * The following structure is used to keep track of the interpreters
@@ -180,6 +183,24 @@ static Tcl_ThreadDataKey dataKey;
  * Options may appear in any order, and only the -s option must be present. As
  * with commands, there may be additional options besides these; unknown
  * options are ignored.
+ *
+ * Appending to the comm property costs several round trips to the X server
+ * per message, which dominates "send" latency for applications that exchange
+ * messages at a high rate. To avoid this, each process that can do so also
+ * listens on a Unix domain socket whose name is derived from the display
+ * string and the hex id of the comm window; since the comm window id is
+ * exactly what the name registry publishes, a sender can compute the target's
+ * socket name without any change to the registry format. The sockets live in
+ * a directory under /tmp that is owned by the user and has mode 0700, so
+ * only processes running as the same user can connect; this is at least as
+ * strong as the xauth-style check made for the X path. Messages on the
+ * socket are frames consisting of a native-endian 32-bit byte count followed
+ * by exactly the bytes that would otherwise have been appended to the comm
+ * property. A command and its result travel on the same connection, one
+ * frame each way. If the socket cannot be created, connected to, or written
+ * (e.g. the target is an older Tk application, or lives on another host),
+ * the sender falls back to the X property transport above, which remains
+ * fully supported in both directions.
  */
 
 /*
@@ -199,6 +220,15 @@ static struct {
 
 #define MAX_PROP_WORDS 100000
 
+/*
+ * Number of seconds to wait for a wedged peer when reading from or writing
+ * to a fast-transport socket, and the largest frame we are willing to accept
+ * on one (the same limit as for the comm property, in bytes).
+ */
+
+#define SEND_SOCKET_TIMEOUT 5
+#define SEND_SOCKET_MAX_FRAME (4*MAX_PROP_WORDS)
+
 /*
  * Forward declarations for functions defined later in this file:
  */
@@ -209,6 +239,9 @@ static void		AppendPropCarefully(Display *display,
 			    Window window, Atom property, char *value,
 			    int length, PendingCommand *pendingPtr);
 static void		DeleteProc(ClientData clientData);
+static void		ProcessCommMessages(TkDisplay *dispPtr,
+			    const char *propInfo, unsigned long numItems,
+			    int replyFd);
 static void		RegAddName(NameRegistry *regPtr,
 			    const char *name, Window commWindow);
 static void		RegClose(NameRegistry *regPtr);
@@ -219,10 +252,24 @@ static NameRegistry *	RegOpen(Tcl_Interp *interp,
 static void		SendEventProc(ClientData clientData, XEvent *eventPtr);
 static int		SendInit(Tcl_Interp *interp, TkDisplay *dispPtr);
 static Tk_RestrictProc SendRestrictProc;
+static void		SendSocketAccept(ClientData clientData, int mask);
+static void		SendSocketInit(TkDisplay *dispPtr);
+static int		SendSocketPath(TkDisplay *dispPtr, Window commWindow,
+			    char *path, size_t pathLength);
+static int		SendViaSocket(TkDisplay *dispPtr, Window commWindow,
+			    char *value, int length);
 static int		ServerSecure(TkDisplay *dispPtr);
+static int		SocketReadAll(int fd, void *buffer, size_t numBytes);
+static char *		SocketReadFrame(int fd, unsigned long *numItemsPtr);
+static int		SocketWriteAll(int fd, const char *buffer,
+			    size_t numBytes);
+static int		SocketWriteFrame(int fd, const char *value,
+			    unsigned int length);
 static void		UpdateCommWindow(TkDisplay *dispPtr);
 static int		ValidateName(TkDisplay *dispPtr, const char *name,
 			    Window commWindow, int oldOK);
+static int		WaitForSocketReply(TkDisplay *dispPtr, int fd,
+			    PendingCommand *pendingPtr, Tcl_Time *timePtr);
 
 /*
  *----------------------------------------------------------------------
@@ -960,7 +1007,7 @@ Tk_SendObjCmd(
     PendingCommand pending;
     RegisteredInterp *riPtr;
     const char *destName;
-    int result, index, async, i, firstArg;
+    int result, index, async, i, firstArg, replyFd;
     Tk_RestrictProc *prevProc;
     ClientData prevArg;
     TkDisplay *dispPtr;
@@ -1133,9 +1180,21 @@ Tk_SendObjCmd(
 	pending.nextPtr = tsdPtr->pendingCommands;
 	tsdPtr->pendingCommands = &pending;
     }
-    (void) AppendPropCarefully(dispPtr->display, commWindow,
-	    dispPtr->commProperty, Tcl_DStringValue(&request),
-	    Tcl_DStringLength(&request) + 1, (async ? NULL : &pending));
+
+    /*
+     * Try the same-host socket transport first; if the target doesn't have a
+     * socket (or the connection fails for any other reason), fall back to
+     * appending to the comm property. On success the connection is kept open
+     * so that the result can be read back from it.
+     */
+
+    replyFd = SendViaSocket(dispPtr, commWindow, Tcl_DStringValue(&request),
+	    Tcl_DStringLength(&request) + 1);
+    if (replyFd < 0) {
+	(void) AppendPropCarefully(dispPtr->display, commWindow,
+		dispPtr->commProperty, Tcl_DStringValue(&request),
+		Tcl_DStringLength(&request) + 1, (async ? NULL : &pending));
+    }
     Tcl_DStringFree(&request);
     if (async) {
 	/*
@@ -1143,6 +1202,9 @@ Tk_SendObjCmd(
 	 * for a response.
 	 */
 
+	if (replyFd >= 0) {
+	    close(replyFd);
+	}
 	return TCL_OK;
     }
 
@@ -1157,7 +1219,15 @@ Tk_SendObjCmd(
     Tcl_GetTime(&timeout);
     timeout.sec += 2;
     while (!pending.gotResponse) {
-	if (!TkUnixDoOneXEvent(&timeout)) {
+	int progress;
+
+	if (replyFd >= 0) {
+	    progress = WaitForSocketReply(dispPtr, replyFd, &pending,
+		    &timeout);
+	} else {
+	    progress = TkUnixDoOneXEvent(&timeout);
+	}
+	if (!progress) {
 	    /*
 	     * An unusually long amount of time has elapsed during the
 	     * processing of a sent command. Check to make sure that the
@@ -1185,6 +1255,9 @@ Tk_SendObjCmd(
 	}
     }
     Tk_RestrictEvents(prevProc, prevArg, &prevArg);
+    if (replyFd >= 0) {
+	close(replyFd);
+    }
 
     /*
      * Unregister the information about the pending command and return the
@@ -1334,6 +1407,16 @@ TkSendCleanup(
 	Tk_DestroyWindow(dispPtr->commTkwin);
 	Tcl_Release(dispPtr->commTkwin);
 	dispPtr->commTkwin = NULL;
+	if (dispPtr->commSocket >= 0) {
+	    Tcl_DeleteFileHandler(dispPtr->commSocket);
+	    close(dispPtr->commSocket);
+	    dispPtr->commSocket = -1;
+	}
+	if (dispPtr->commSocketPath != NULL) {
+	    unlink(dispPtr->commSocketPath);
+	    ckfree(dispPtr->commSocketPath);
+	    dispPtr->commSocketPath = NULL;
+	}
     }
 }
 
@@ -1391,6 +1474,14 @@ SendInit(
     dispPtr->appNameProperty = Tk_InternAtom(dispPtr->commTkwin,
 	    "TK_APPLICATION");
 
+    /*
+     * Create the listening socket for the same-host fast transport. This may
+     * fail (e.g. no usable directory for the socket); in that case "send"
+     * simply keeps using the X property transport.
+     */
+
+    SendSocketInit(dispPtr);
+
     return TCL_OK;
 }
 
@@ -1421,13 +1512,9 @@ SendEventProc(
 {
     TkDisplay *dispPtr = (TkDisplay *)clientData;
     char *propInfo, **propInfoPtr = &propInfo;
-    const char *p;
     int result, actualFormat;
     unsigned long numItems, bytesAfter;
     Atom actualType;
-    Tcl_Interp *remoteInterp;	/* Interp in which to execute the command. */
-    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
-	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
 
     if ((eventPtr->xproperty.atom != dispPtr->commProperty)
 	    || (eventPtr->xproperty.state != PropertyNewValue)) {
@@ -1456,10 +1543,50 @@ SendEventProc(
 	return;
     }
 
+    ProcessCommMessages(dispPtr, propInfo, numItems, -1);
+    XFree(propInfo);
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * ProcessCommMessages --
+ *
+ *	Parse a batch of commands and results that arrived for this process,
+ *	either via the comm property or as a frame on a fast-transport
+ *	socket, and act on each of them. The format is described at the top
+ *	of this file.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Command requests are executed and their results are returned to the
+ *	sender: on replyFd if the command arrived on a socket, otherwise via
+ *	the sender's comm property. Responses are saved for the (ostensibly
+ *	waiting) "send" commands.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+ProcessCommMessages(
+    TkDisplay *dispPtr,		/* Display information. */
+    const char *propInfo,	/* Contents of the comm property or socket
+				 * frame. */
+    unsigned long numItems,	/* Number of bytes in propInfo. */
+    int replyFd)		/* Socket on which to send back results, or
+				 * -1 to use the sender's comm property. */
+{
+    const char *p;
+    int result;
+    Tcl_Interp *remoteInterp;	/* Interp in which to execute the command. */
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
     /*
-     * Several commands and results could arrive in the property at one time;
-     * each iteration through the outer loop handles a single command or
-     * result.
+     * Several commands and results could arrive at one time; each iteration
+     * through the outer loop handles a single command or result.
      */
 
     for (p = propInfo; (p-propInfo) < (int) numItems; ) {
@@ -1624,10 +1751,15 @@ SendEventProc(
 		    Tcl_DStringAppend(&reply, "\0-c ", 4);
 		    Tcl_DStringAppend(&reply, buffer, -1);
 		}
-		(void) AppendPropCarefully(dispPtr->display, commWindow,
-			dispPtr->commProperty, Tcl_DStringValue(&reply),
-			Tcl_DStringLength(&reply) + 1, NULL);
-		XFlush(dispPtr->display);
+		if (replyFd >= 0) {
+		    (void) SocketWriteFrame(replyFd, Tcl_DStringValue(&reply),
+			    Tcl_DStringLength(&reply) + 1);
+		} else {
+		    (void) AppendPropCarefully(dispPtr->display, commWindow,
+			    dispPtr->commProperty, Tcl_DStringValue(&reply),
+			    Tcl_DStringLength(&reply) + 1, NULL);
+		    XFlush(dispPtr->display);
+		}
 		Tcl_DStringFree(&reply);
 	    }
 	} else if ((*p == 'r') && (p[1] == 0)) {
@@ -1726,7 +1858,6 @@ SendEventProc(
 	    p++;
 	}
     }
-    XFree(propInfo);
 }
 
 /*
@@ -1806,6 +1937,517 @@ AppendErrorProc(
     return 0;
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * SendSocketPath --
+ *
+ *	Compute the name of the fast-transport socket associated with a
+ *	given comm window.
+ *
+ * Results:
+ *	The return value is 1 if the name fit in the caller's buffer, 0
+ *	otherwise.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+SendSocketPath(
+    TkDisplay *dispPtr,		/* Display that the comm window belongs
+				 * to. */
+    Window commWindow,		/* X identifier for the comm window whose
+				 * socket name is wanted. */
+    char *path,			/* Where to store the name. */
+    size_t pathLength)		/* Number of bytes available at path. */
+{
+    const char *display;
+    char name[64];
+    size_t i;
+
+    /*
+     * Both ends must be able to compute the name independently: the sender
+     * knows the target's comm window from the name registry, and each
+     * process knows its own display string. Strip host names that denote
+     * the local host so that ":0", "unix:0" and "localhost:0" all map to
+     * the same socket, and sanitize what remains since it becomes part of
+     * a file name.
+     */
+
+    display = DisplayString(dispPtr->display);
+    if ((strncmp(display, "unix:", 5) == 0)
+	    || (strncmp(display, "localhost:", 10) == 0)) {
+	display = strchr(display, ':');
+    }
+    for (i = 0; (display[i] != 0) && (i < sizeof(name)-1); i++) {
+	name[i] = (display[i] == '/') ? '_' : display[i];
+    }
+    name[i] = 0;
+    if ((size_t) snprintf(path, pathLength, "/tmp/.tksend-%lu/%s-%x",
+	    (unsigned long) geteuid(), name, (unsigned) commWindow)
+	    >= pathLength) {
+	return 0;
+    }
+    return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * SendSocketInit --
+ *
+ *	Create the listening socket on which other applications on the same
+ *	host can deliver "send" messages without going through the X server.
+ *
+ * Results:
+ *	None. If the socket cannot be created safely, dispPtr->commSocket is
+ *	left as -1 and "send" keeps using the X property transport.
+ *
+ * Side effects:
+ *	A socket is created and bound under a per-user directory in /tmp,
+ *	and a file handler is set up to service connections to it.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+SendSocketInit(
+    TkDisplay *dispPtr)		/* Display to initialize. */
+{
+    struct sockaddr_un addr;
+    struct stat statBuf;
+    char *slash;
+    int fd;
+
+    dispPtr->commSocket = -1;
+    dispPtr->commSocketPath = NULL;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (!SendSocketPath(dispPtr, Tk_WindowId(dispPtr->commTkwin),
+	    addr.sun_path, sizeof(addr.sun_path))) {
+	return;
+    }
+
+    /*
+     * The sockets live in a per-user directory so that ordinary file
+     * permissions keep other users from connecting, or from planting a
+     * socket of their own. Refuse to use the directory unless it really is
+     * a directory, owned by this user, and accessible to no-one else.
+     */
+
+    slash = strrchr(addr.sun_path, '/');
+    *slash = 0;
+    if ((mkdir(addr.sun_path, 0700) != 0) && (errno != EEXIST)) {
+	return;
+    }
+    if ((lstat(addr.sun_path, &statBuf) != 0) || !S_ISDIR(statBuf.st_mode)
+	    || (statBuf.st_uid != geteuid())
+	    || (statBuf.st_mode & (S_IRWXG|S_IRWXO))) {
+	return;
+    }
+    *slash = '/';
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+	return;
+    }
+    unlink(addr.sun_path);	/* In case a previous process with the same
+				 * comm window id died without cleaning up. */
+    if ((bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0)
+	    || (listen(fd, 8) != 0)) {
+	close(fd);
+	return;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    dispPtr->commSocket = fd;
+    dispPtr->commSocketPath = (char *)ckalloc(strlen(addr.sun_path) + 1);
+    strcpy(dispPtr->commSocketPath, addr.sun_path);
+    Tcl_CreateFileHandler(fd, TCL_READABLE, SendSocketAccept, dispPtr);
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * SendSocketAccept --
+ *
+ *	This function is invoked when our listening socket becomes readable.
+ *	It accepts pending connections and handles the message delivered on
+ *	each of them.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Whatever the arriving commands do; results are written back on the
+ *	connection that each command arrived on.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static void
+SendSocketAccept(
+    ClientData clientData,	/* Display information. */
+    TCL_UNUSED(int))		/* Ready mask; the socket is readable. */
+{
+    TkDisplay *dispPtr = (TkDisplay *)clientData;
+    struct timeval tv;
+    char *buffer;
+    unsigned long numItems;
+    int connFd;
+
+    while (1) {
+	connFd = accept(dispPtr->commSocket, NULL, NULL);
+	if (connFd < 0) {
+	    return;
+	}
+	fcntl(connFd, F_SETFD, FD_CLOEXEC);
+	fcntl(connFd, F_SETFL, 0);
+	tv.tv_sec = SEND_SOCKET_TIMEOUT;
+	tv.tv_usec = 0;
+	setsockopt(connFd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	setsockopt(connFd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+	buffer = SocketReadFrame(connFd, &numItems);
+	if (buffer != NULL) {
+	    ProcessCommMessages(dispPtr, buffer, numItems, connFd);
+	    ckfree(buffer);
+	}
+	close(connFd);
+    }
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * SendViaSocket --
+ *
+ *	Attempt to deliver a "send" message over the same-host fast
+ *	transport instead of the target's comm property.
+ *
+ * Results:
+ *	On success the return value is a connected socket from which the
+ *	result can be read; the caller must close it. On failure -1 is
+ *	returned and nothing has been delivered, so the caller should fall
+ *	back to the X property transport.
+ *
+ * Side effects:
+ *	The message is written to the target's socket.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+SendViaSocket(
+    TkDisplay *dispPtr,		/* Display containing the target. */
+    Window commWindow,		/* Communication window of the target
+				 * application. */
+    char *value,		/* Bytes that would otherwise be appended to
+				 * the target's comm property. */
+    int length)			/* Number of bytes in value. */
+{
+    struct sockaddr_un addr;
+    struct timeval tv;
+    int fd;
+
+    /*
+     * Only try the fast path if our own socket came up: if it did not, the
+     * socket directory is missing or not trustworthy, and we must not
+     * connect through it either.
+     */
+
+    if (dispPtr->commSocket < 0) {
+	return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (!SendSocketPath(dispPtr, commWindow, addr.sun_path,
+	    sizeof(addr.sun_path))) {
+	return -1;
+    }
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+	return -1;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+	close(fd);
+	return -1;
+    }
+    tv.tv_sec = SEND_SOCKET_TIMEOUT;
+    tv.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    if (!SocketWriteFrame(fd, value, (unsigned int) length)) {
+	close(fd);
+	return -1;
+    }
+    return fd;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * WaitForSocketReply --
+ *
+ *	Wait for the result of a command sent over the fast transport,
+ *	while continuing to service send-related traffic arriving over
+ *	either transport (so that recursive sends cannot deadlock).
+ *
+ * Results:
+ *	Returns 0 if the timeout has expired, otherwise returns 1.
+ *
+ * Side effects:
+ *	Can invoke arbitrary Tcl scripts via incoming commands.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+WaitForSocketReply(
+    TkDisplay *dispPtr,		/* Display being used for communication. */
+    int fd,			/* Connection on which the result will
+				 * arrive. */
+    PendingCommand *pendingPtr,	/* Record for the command awaiting its
+				 * result. */
+    Tcl_Time *timePtr)		/* Specifies the absolute time when the call
+				 * should time out. */
+{
+    struct timeval tv;
+    fd_set readMask;
+    Tcl_Time now;
+    int numFound, xFd, maxFd;
+
+    /*
+     * Service X activity that is already queued first: a property-based
+     * send could arrive from an older application while we wait. The
+     * restrict proc installed by our caller makes sure that only
+     * send-related events are processed.
+     */
+
+    if (XEventsQueued(dispPtr->display, QueuedAfterReading) > 0) {
+	Tcl_GetTime(&now);
+	TkUnixDoOneXEvent(&now);
+	return 1;
+    }
+
+    Tcl_GetTime(&now);
+    if ((now.sec > timePtr->sec) || ((now.sec == timePtr->sec)
+	    && (now.usec > timePtr->usec))) {
+	return 0;
+    }
+    tv.tv_sec = timePtr->sec - now.sec;
+    tv.tv_usec = timePtr->usec - now.usec;
+    if (tv.tv_usec < 0) {
+	tv.tv_sec--;
+	tv.tv_usec += 1000000;
+    }
+
+    FD_ZERO(&readMask);
+    FD_SET(fd, &readMask);
+    maxFd = fd;
+    xFd = ConnectionNumber(dispPtr->display);
+    FD_SET(xFd, &readMask);
+    if (xFd > maxFd) {
+	maxFd = xFd;
+    }
+    if (dispPtr->commSocket >= 0) {
+	FD_SET(dispPtr->commSocket, &readMask);
+	if (dispPtr->commSocket > maxFd) {
+	    maxFd = dispPtr->commSocket;
+	}
+    }
+    numFound = select(maxFd + 1, &readMask, NULL, NULL, &tv);
+    if (numFound < 0) {
+	return (errno == EINTR);
+    }
+    if (numFound == 0) {
+	return 0;
+    }
+    if (FD_ISSET(fd, &readMask)) {
+	char *buffer;
+	unsigned long numItems;
+
+	buffer = SocketReadFrame(fd, &numItems);
+	if (buffer == NULL) {
+	    /*
+	     * The connection was dropped without a result; report the
+	     * target as dead, just as the property transport does.
+	     */
+
+	    const char *msg = "target application died";
+
+	    pendingPtr->code = TCL_ERROR;
+	    pendingPtr->result = (char *)ckalloc(strlen(msg) + 1);
+	    strcpy(pendingPtr->result, msg);
+	    pendingPtr->gotResponse = 1;
+	} else {
+	    ProcessCommMessages(dispPtr, buffer, numItems, -1);
+	    ckfree(buffer);
+	}
+	return 1;
+    }
+    if ((dispPtr->commSocket >= 0)
+	    && FD_ISSET(dispPtr->commSocket, &readMask)) {
+	/*
+	 * An incoming command, e.g. the target calling us back while it
+	 * computes our result.
+	 */
+
+	SendSocketAccept(dispPtr, TCL_READABLE);
+	return 1;
+    }
+    Tcl_GetTime(&now);
+    TkUnixDoOneXEvent(&now);
+    return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * SocketReadAll, SocketWriteAll --
+ *
+ *	Read or write an exact number of bytes on a blocking socket,
+ *	restarting after interrupted system calls.
+ *
+ * Results:
+ *	The return value is 1 on success. 0 means the transfer failed or,
+ *	when reading, that the peer closed the connection early; the socket
+ *	timeout set by our callers bounds how long a wedged peer can stall
+ *	the transfer.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+SocketReadAll(
+    int fd,			/* Socket to read from. */
+    void *buffer,		/* Where to store the bytes. */
+    size_t numBytes)		/* Number of bytes to read. */
+{
+    char *p = (char *)buffer;
+    ssize_t count;
+
+    while (numBytes > 0) {
+	count = read(fd, p, numBytes);
+	if (count < 0) {
+	    if (errno == EINTR) {
+		continue;
+	    }
+	    return 0;
+	}
+	if (count == 0) {
+	    return 0;
+	}
+	p += count;
+	numBytes -= (size_t) count;
+    }
+    return 1;
+}
+
+static int
+SocketWriteAll(
+    int fd,			/* Socket to write to. */
+    const char *buffer,		/* Bytes to write. */
+    size_t numBytes)		/* Number of bytes to write. */
+{
+    ssize_t count;
+
+    while (numBytes > 0) {
+	count = write(fd, buffer, numBytes);
+	if (count < 0) {
+	    if (errno == EINTR) {
+		continue;
+	    }
+	    return 0;
+	}
+	buffer += count;
+	numBytes -= (size_t) count;
+    }
+    return 1;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * SocketReadFrame --
+ *
+ *	Read one length-prefixed message from a fast-transport connection.
+ *
+ * Results:
+ *	The return value is a NULL-terminated buffer holding the payload
+ *	(the caller must pass it to ckfree), with the payload size stored at
+ *	*numItemsPtr, or NULL if the frame could not be read or exceeds the
+ *	size limit.
+ *
+ * Side effects:
+ *	None.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static char *
+SocketReadFrame(
+    int fd,			/* Socket to read from. */
+    unsigned long *numItemsPtr)	/* Store the number of payload bytes here. */
+{
+    unsigned int length;
+    char *buffer;
+
+    if (!SocketReadAll(fd, &length, sizeof(length)) || (length == 0)
+	    || (length > SEND_SOCKET_MAX_FRAME)) {
+	return NULL;
+    }
+    buffer = (char *)ckalloc(length + 1);
+    if (!SocketReadAll(fd, buffer, length)) {
+	ckfree(buffer);
+	return NULL;
+    }
+    buffer[length] = 0;
+    *numItemsPtr = length;
+    return buffer;
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * SocketWriteFrame --
+ *
+ *	Write one length-prefixed message to a fast-transport connection.
+ *
+ * Results:
+ *	The return value is 1 if the whole frame was written, 0 otherwise.
+ *
+ * Side effects:
+ *	SIGPIPE is ignored for the duration of the writes so that a peer
+ *	that died surfaces as an error return instead of killing this
+ *	process.
+ *
+ *----------------------------------------------------------------------
+ */
+
+static int
+SocketWriteFrame(
+    int fd,			/* Socket to write to. */
+    const char *value,		/* Payload bytes. */
+    unsigned int length)	/* Number of payload bytes. */
+{
+    void (*oldHandler)(int);
+    int success;
+
+    oldHandler = (void (*)(int)) signal(SIGPIPE, SIG_IGN);
+    success = SocketWriteAll(fd, (char *) &length, sizeof(length))
+	    && SocketWriteAll(fd, value, length);
+    (void) signal(SIGPIPE, oldHandler);
+    return success;
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -133,6 +133,14 @@ typedef struct TkWmInfo {
 	int x;			/* numerator */
 	int y;			/* denominator */
     } minAspect, maxAspect;	/* Min/max aspect ratios for window. */
+    XSizeHints sentSizeHints;	/* Hints as last passed to XSetWMNormalHints,
+				 * valid only when sentSizeHintsValid is
+				 * non-zero. Used to skip rewrites that would
+				 * leave the WM_NORMAL_HINTS property
+				 * unchanged. */
+    int sentSizeHintsValid;	/* Non-zero means sentSizeHints reflects what
+				 * the current wrapper window's property
+				 * holds. */
     int reqGridWidth, reqGridHeight;
 				/* The dimensions of the window (in grid
 				 * units) requested through the geometry
@@ -260,6 +268,11 @@ typedef struct TkWmInfo {
  * WM_WITHDRAWN -		non-zero means that this window has explicitly
  *				been withdrawn. If it's a transient, it should
  *				not mirror state changes in the container.
+ * WM_UPDATE_HINTS_PENDING -	non-zero means the window manager hints have
+ *				changed; a call to UpdateWmAttributes has been
+ *				scheduled to rewrite them.
+ * WM_UPDATE_PROTOCOLS_PENDING - same for the WM_PROTOCOLS property.
+ * WM_UPDATE_TITLE_PENDING -	same for the title and icon name properties.
  */
 
 #define WM_NEVER_MAPPED			1
@@ -276,6 +289,12 @@ typedef struct TkWmInfo {
 #define WM_WIDTH_NOT_RESIZABLE		0x1000
 #define WM_HEIGHT_NOT_RESIZABLE		0x2000
 #define WM_WITHDRAWN			0x4000
+#define WM_UPDATE_HINTS_PENDING		0x8000
+#define WM_UPDATE_PROTOCOLS_PENDING	0x10000
+#define WM_UPDATE_TITLE_PENDING		0x20000
+#define WM_UPDATE_ATTR_PENDING \
+	(WM_UPDATE_HINTS_PENDING|WM_UPDATE_PROTOCOLS_PENDING| \
+	WM_UPDATE_TITLE_PENDING)
 
 /*
  * Wrapper for XGetWindowProperty and XChangeProperty to make them a *bit*
@@ -354,6 +373,7 @@ static void		TkWmStackorderToplevelWrapperMap(TkWindow *winPtr,
 			    Display *display, Tcl_HashTable *reparentTable);
 static void		TopLevelReqProc(ClientData dummy, Tk_Window tkwin);
 static void		RemapWindows(TkWindow *winPtr, TkWindow *parentPtr);
+static void		ScheduleWmAttrUpdate(TkWindow *winPtr, int flag);
 static void		UpdateCommand(TkWindow *winPtr);
 static void		UpdateGeometryInfo(ClientData clientData);
 static void		UpdateHints(TkWindow *winPtr);
@@ -362,6 +382,7 @@ static void		UpdateSizeHints(TkWindow *winPtr,
 static void		UpdateTitle(TkWindow *winPtr);
 static void		UpdatePhotoIcon(TkWindow *winPtr);
 static void		UpdateVRootGeometry(WmInfo *wmPtr);
+static void		UpdateWmAttributes(ClientData clientData);
 static void		UpdateWmProtocols(WmInfo *wmPtr);
 static int		SetNetWmType(TkWindow *winPtr, Tcl_Obj *typePtr);
 static Tcl_Obj *	GetNetWmType(TkWindow *winPtr);
@@ -874,7 +895,8 @@ TkWmDeadWindow(
 	wmPtr2 = ((TkWindow *) wmPtr->iconFor)->wmInfoPtr;
 	wmPtr2->icon = NULL;
 	wmPtr2->hints.flags &= ~IconWindowHint;
-	UpdateHints((TkWindow *) wmPtr->iconFor);
+	ScheduleWmAttrUpdate((TkWindow *) wmPtr->iconFor,
+		WM_UPDATE_HINTS_PENDING);
     }
     if (wmPtr->menubar != NULL) {
 	Tk_DestroyWindow(wmPtr->menubar);
@@ -907,6 +929,9 @@ TkWmDeadWindow(
     if (wmPtr->flags & WM_UPDATE_PENDING) {
 	Tcl_CancelIdleCall(UpdateGeometryInfo, winPtr);
     }
+    if (wmPtr->flags & WM_UPDATE_ATTR_PENDING) {
+	Tcl_CancelIdleCall(UpdateWmAttributes, winPtr);
+    }
 
     /*
      * Reset all transient windows whose container is the dead window.
@@ -1784,7 +1809,7 @@ WmFocusmodelCmd(
     } else { /* OPT_PASSIVE */
 	wmPtr->hints.input = True;
     }
-    UpdateHints(winPtr);
+    ScheduleWmAttrUpdate(winPtr, WM_UPDATE_HINTS_PENDING);
     return TCL_OK;
 }
 
@@ -2113,7 +2138,7 @@ WmGroupCmd(
 	wmPtr->leaderName = (char *)ckalloc(objv[3]->length + 1);
 	strcpy(wmPtr->leaderName, argv3);
     }
-    UpdateHints(winPtr);
+    ScheduleWmAttrUpdate(winPtr, WM_UPDATE_HINTS_PENDING);
     return TCL_OK;
 }
 
@@ -2173,7 +2198,7 @@ WmIconbitmapCmd(
 	wmPtr->hints.icon_pixmap = pixmap;
 	wmPtr->hints.flags |= IconPixmapHint;
     }
-    UpdateHints(winPtr);
+    ScheduleWmAttrUpdate(winPtr, WM_UPDATE_HINTS_PENDING);
     return TCL_OK;
 }
 
@@ -2301,7 +2326,7 @@ WmIconmaskCmd(
 	wmPtr->hints.icon_mask = pixmap;
 	wmPtr->hints.flags |= IconMaskHint;
     }
-    UpdateHints(winPtr);
+    ScheduleWmAttrUpdate(winPtr, WM_UPDATE_HINTS_PENDING);
     return TCL_OK;
 }
 
@@ -2350,7 +2375,7 @@ WmIconnameCmd(
 	wmPtr->iconName = (char *)ckalloc(objv[3]->length + 1);
 	strcpy(wmPtr->iconName, argv3);
 	if (!(wmPtr->flags & WM_NEVER_MAPPED)) {
-	    UpdateTitle(winPtr);
+	    ScheduleWmAttrUpdate(winPtr, WM_UPDATE_TITLE_PENDING);
 	}
     }
     return TCL_OK;
@@ -2559,7 +2584,7 @@ WmIconpositionCmd(
 	wmPtr->hints.icon_y = y;
 	wmPtr->hints.flags |= IconPositionHint;
     }
-    UpdateHints(winPtr);
+    ScheduleWmAttrUpdate(winPtr, WM_UPDATE_HINTS_PENDING);
     return TCL_OK;
 }
 
@@ -2679,7 +2704,7 @@ WmIconwindowCmd(
 	    WaitForMapNotify((TkWindow *) tkwin2, 0);
 	}
     }
-    UpdateHints(winPtr);
+    ScheduleWmAttrUpdate(winPtr, WM_UPDATE_HINTS_PENDING);
     return TCL_OK;
 }
 
@@ -3085,7 +3110,7 @@ WmProtocolCmd(
 	memcpy(protPtr->command, cmd, cmdLength + 1);
     }
     if (!(wmPtr->flags & WM_NEVER_MAPPED)) {
-	UpdateWmProtocols(wmPtr);
+	ScheduleWmAttrUpdate(winPtr, WM_UPDATE_PROTOCOLS_PENDING);
     }
     return TCL_OK;
 }
@@ -3494,7 +3519,7 @@ WmTitleCmd(
 	strcpy(wmPtr->title, argv3);
 
 	if (!(wmPtr->flags & WM_NEVER_MAPPED)) {
-	    UpdateTitle(winPtr);
+	    ScheduleWmAttrUpdate(winPtr, WM_UPDATE_TITLE_PENDING);
 	}
     }
     return TCL_OK;
@@ -4891,6 +4916,22 @@ UpdateSizeHints(
 	hintsPtr->flags |= PMaxSize;
     }
 
+    /*
+     * Overlay-style windows push geometry updates every frame, and several
+     * wm subcommands request a hints update without checking whether the
+     * values actually changed. When the hints come out identical to what
+     * the wrapper's property already holds, skip the rewrite so the window
+     * manager is not prodded into reconsidering the window for nothing.
+     */
+
+    if (wmPtr->sentSizeHintsValid && (memcmp(hintsPtr, &wmPtr->sentSizeHints,
+	    sizeof(XSizeHints)) == 0)) {
+	XFree((char *) hintsPtr);
+	return;
+    }
+    wmPtr->sentSizeHints = *hintsPtr;
+    wmPtr->sentSizeHintsValid = 1;
+
     XSetWMNormalHints(winPtr->display, wmPtr->wrapperPtr->window, hintsPtr);
 
     XFree((char *) hintsPtr);
@@ -5391,6 +5432,85 @@ WaitForMapNotify(
     }
 }
 
+/*
+ *--------------------------------------------------------------
+ *
+ * ScheduleWmAttrUpdate --
+ *
+ *	Arrange for a stale window manager property of a toplevel to be
+ *	rewritten at idle time. Several property changes made in one burst
+ *	(as when restoring a session's worth of toplevels) are thereby
+ *	coalesced into a single rewrite per property.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	An idle handler running UpdateWmAttributes may be scheduled.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+ScheduleWmAttrUpdate(
+    TkWindow *winPtr,		/* Toplevel whose properties are stale. */
+    int flag)			/* One of WM_UPDATE_HINTS_PENDING,
+				 * WM_UPDATE_PROTOCOLS_PENDING or
+				 * WM_UPDATE_TITLE_PENDING. */
+{
+    WmInfo *wmPtr = winPtr->wmInfoPtr;
+
+    if (wmPtr->flags & WM_NEVER_MAPPED) {
+	/*
+	 * TkWmMapWindow writes every property when the window is first
+	 * mapped, so nothing needs to be remembered here.
+	 */
+
+	return;
+    }
+    if (!(wmPtr->flags & WM_UPDATE_ATTR_PENDING)) {
+	Tcl_DoWhenIdle(UpdateWmAttributes, winPtr);
+    }
+    wmPtr->flags |= flag;
+}
+
+/*
+ *--------------------------------------------------------------
+ *
+ * UpdateWmAttributes --
+ *
+ *	Idle handler that rewrites whichever window manager properties of a
+ *	toplevel were marked stale by ScheduleWmAttrUpdate.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Properties get changed for winPtr.
+ *
+ *--------------------------------------------------------------
+ */
+
+static void
+UpdateWmAttributes(
+    ClientData clientData)	/* Pointer to the window's record. */
+{
+    TkWindow *winPtr = (TkWindow *) clientData;
+    WmInfo *wmPtr = winPtr->wmInfoPtr;
+    int flags = wmPtr->flags;
+
+    wmPtr->flags &= ~WM_UPDATE_ATTR_PENDING;
+    if (flags & WM_UPDATE_TITLE_PENDING) {
+	UpdateTitle(winPtr);
+    }
+    if (flags & WM_UPDATE_HINTS_PENDING) {
+	UpdateHints(winPtr);
+    }
+    if (flags & WM_UPDATE_PROTOCOLS_PENDING) {
+	UpdateWmProtocols(wmPtr);
+    }
+}
+
 /*
  *--------------------------------------------------------------
  *
@@ -6997,6 +7117,13 @@ CreateWrapper(
 	Tk_MakeWindowExist((Tk_Window) winPtr);
     }
 
+    /*
+     * The new wrapper window starts without a WM_NORMAL_HINTS property, so
+     * any hints remembered from a previous wrapper no longer apply.
+     */
+
+    wmPtr->sentSizeHintsValid = 0;
+
     /*
      * The code below is copied from CreateTopLevelWindow, Tk_MakeWindowExist,
      * and TkpMakeWindow. The idea is to create an "official" Tk window (so
@@ -10,20 +10,75 @@
 
 #include "tkUnixInt.h"
 
-
+/*
+ * Recently freed pixmaps are parked in a small per-thread pool instead of
+ * being destroyed, so that redraw code which repeatedly allocates and frees
+ * a double-buffer pixmap of the same size (a fresh one per expose) can reuse
+ * the server-side resource instead of destroying and recreating it each
+ * time.  A record is kept for every pixmap handed out by Tk_GetPixmap whose
+ * target drawable is a Tk window, since the screen, size, and depth must be
+ * known again when the pixmap is freed.  X makes no promises about the
+ * contents of a new pixmap, so handing back one with stale contents is
+ * legitimate.
+ *
+ * Pixmaps are allocated in size classes: the requested dimensions are
+ * rounded up to the next multiple of PIXMAP_POOL_GRAIN pixels, and pool
+ * lookups match on the rounded size.  Without this, buffers whose size
+ * tracks the damage of the moment (a text widget's line batch, a canvas
+ * dirty rectangle) would almost never repeat exactly and the pool would be
+ * useless to them; with it, steady-state redraw stops creating and
+ * destroying server-side surfaces altogether.  Callers never learn the
+ * rounded size - they draw and copy only within the dimensions they asked
+ * for, and the contents of a pixmap are undefined on creation anyway.  The
+ * pool list is kept in most-recently-freed-first order and trimmed from the
+ * tail, so the entries that survive are the ones being reused.
+ */
+
+typedef struct PixmapRecord {
+    Pixmap pixmap;		/* X identifier for the pixmap. */
+    Display *display;		/* Display the pixmap belongs to. */
+    Screen *screen;		/* Screen the pixmap was created on. */
+    int width, height;		/* Dimensions of the pixmap, rounded up to
+				 * the size-class grain. */
+    int depth;			/* Bits per pixel for the pixmap. */
+    struct PixmapRecord *nextPtr;
+				/* Next in pool of free pixmaps. */
+} PixmapRecord;
+
+#define PIXMAP_POOL_MAX_SIZE 8
+#define PIXMAP_POOL_GRAIN 64
+#define REGION_POOL_MAX_SIZE 8
+
+typedef struct {
+    int initialized;		/* 0 means table below needs initializing. */
+    Tcl_HashTable liveTable;	/* Maps a Pixmap to the PixmapRecord for it,
+				 * for pixmaps currently handed out. */
+    PixmapRecord *poolPtr;	/* Pool of freed pixmaps available for
+				 * reuse, most recently freed first. */
+    int poolSize;		/* Number of entries in poolPtr list. */
+    Region regionPool[REGION_POOL_MAX_SIZE];
+				/* Pool of freed, emptied X Regions available
+				 * for reuse, most recently freed first. */
+    int regionPoolSize;		/* Number of entries in regionPool. */
+} ThreadSpecificData;
+static Tcl_ThreadDataKey dataKey;
+
 /*
  *----------------------------------------------------------------------
  *
  * Tk_GetPixmap --
  *
  *	Same as the XCreatePixmap function except that it manages resource
- *	identifiers better.
+ *	identifiers better: a pixmap of the right size class, depth, and
+ *	screen that was recently passed to Tk_FreePixmap may be recycled
+ *	without contacting the server. The pixmap returned is at least as
+ *	large as requested, possibly larger.
  *
  * Results:
  *	Returns a new pixmap.
  *
  * Side effects:
- *	None.
+ *	A pixmap may be removed from the pool of freed pixmaps.
  *
  *----------------------------------------------------------------------
  */
@@ -35,10 +90,69 @@ Tk_GetPixmap(
     int width, int height,	/* Dimensions of pixmap. */
     int depth)			/* Bits per pixel for pixmap. */
 {
-    return XCreatePixmap(display, d, (unsigned) width, (unsigned) height,
-	    (unsigned) depth);
+    Tk_Window tkwin = Tk_IdToWindow(display, d);
+    PixmapRecord *recPtr, **recPtrPtr;
+    Tcl_HashEntry *hPtr;
+    Screen *screen;
+    int isNew, allocWidth, allocHeight;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (tkwin == NULL) {
+	/*
+	 * The target drawable is not one of our windows, so its screen is
+	 * unknown; bypass the pool entirely.
+	 */
+
+	return XCreatePixmap(display, d, (unsigned) width, (unsigned) height,
+		(unsigned) depth);
+    }
+    screen = Tk_Screen(tkwin);
+    allocWidth = ((width + PIXMAP_POOL_GRAIN - 1) / PIXMAP_POOL_GRAIN)
+	    * PIXMAP_POOL_GRAIN;
+    allocHeight = ((height + PIXMAP_POOL_GRAIN - 1) / PIXMAP_POOL_GRAIN)
+	    * PIXMAP_POOL_GRAIN;
+
+    if (!tsdPtr->initialized) {
+	tsdPtr->initialized = 1;
+	Tcl_InitHashTable(&tsdPtr->liveTable, TCL_ONE_WORD_KEYS);
+    }
+
+    /*
+     * See if the pool contains a pixmap of the same size class.
+     */
+
+    for (recPtrPtr = &tsdPtr->poolPtr; (recPtr = *recPtrPtr) != NULL;
+	    recPtrPtr = &recPtr->nextPtr) {
+	if ((recPtr->display == display) && (recPtr->screen == screen)
+		&& (recPtr->width == allocWidth)
+		&& (recPtr->height == allocHeight)
+		&& (recPtr->depth == depth)) {
+	    *recPtrPtr = recPtr->nextPtr;
+	    tsdPtr->poolSize--;
+	    recPtr->nextPtr = NULL;
+	    hPtr = Tcl_CreateHashEntry(&tsdPtr->liveTable,
+		    INT2PTR(recPtr->pixmap), &isNew);
+	    Tcl_SetHashValue(hPtr, recPtr);
+	    return recPtr->pixmap;
+	}
+    }
+
+    recPtr = (PixmapRecord *)ckalloc(sizeof(PixmapRecord));
+    recPtr->pixmap = XCreatePixmap(display, d, (unsigned) allocWidth,
+	    (unsigned) allocHeight, (unsigned) depth);
+    recPtr->display = display;
+    recPtr->screen = screen;
+    recPtr->width = allocWidth;
+    recPtr->height = allocHeight;
+    recPtr->depth = depth;
+    recPtr->nextPtr = NULL;
+    hPtr = Tcl_CreateHashEntry(&tsdPtr->liveTable, INT2PTR(recPtr->pixmap),
+	    &isNew);
+    Tcl_SetHashValue(hPtr, recPtr);
+    return recPtr->pixmap;
 }
-
+
 /*
  *----------------------------------------------------------------------
  *
@@ -51,8 +165,11 @@ Tk_GetPixmap(
  *	None.
  *
  * Side effects:
- *	The pixmap is freed in the X server and its resource identifier is
- *	saved for re-use.
+ *	The pixmap is parked in the pool of freed pixmaps for reuse by a
+ *	later Tk_GetPixmap call, or freed in the X server if it was not
+ *	eligible for pooling. When the pool is full the oldest pooled pixmap
+ *	is evicted, since the newcomer's size is likelier to be asked for
+ *	again.
  *
  *----------------------------------------------------------------------
  */
@@ -62,10 +179,165 @@ Tk_FreePixmap(
     Display *display,		/* Display for which pixmap was allocated. */
     Pixmap pixmap)		/* Identifier for pixmap. */
 {
+    PixmapRecord *recPtr, **recPtrPtr;
+    Tcl_HashEntry *hPtr;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (!tsdPtr->initialized) {
+	XFreePixmap(display, pixmap);
+	return;
+    }
+    hPtr = Tcl_FindHashEntry(&tsdPtr->liveTable, INT2PTR(pixmap));
+    if (hPtr != NULL) {
+	recPtr = (PixmapRecord *)Tcl_GetHashValue(hPtr);
+	if (recPtr->display == display) {
+	    Tcl_DeleteHashEntry(hPtr);
+	    if (tsdPtr->poolSize >= PIXMAP_POOL_MAX_SIZE) {
+		/*
+		 * Evict the oldest pooled pixmap to make room.
+		 */
+
+		for (recPtrPtr = &tsdPtr->poolPtr;
+			(*recPtrPtr)->nextPtr != NULL;
+			recPtrPtr = &(*recPtrPtr)->nextPtr) {
+		    /* Empty loop body. */
+		}
+		XFreePixmap((*recPtrPtr)->display, (*recPtrPtr)->pixmap);
+		ckfree(*recPtrPtr);
+		*recPtrPtr = NULL;
+		tsdPtr->poolSize--;
+	    }
+	    recPtr->nextPtr = tsdPtr->poolPtr;
+	    tsdPtr->poolPtr = recPtr;
+	    tsdPtr->poolSize++;
+	    return;
+	}
+    }
     XFreePixmap(display, pixmap);
 }
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkUnixPixmapPoolCleanup --
+ *
+ *	Called when a display is being closed to discard any state that the
+ *	pixmap pool holds for it. The server-side pixmaps go away with the
+ *	connection, so only the client-side records are released here.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	Pool entries and live-pixmap records for the display are freed.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkUnixPixmapPoolCleanup(
+    Display *display)		/* Display being closed. */
+{
+    PixmapRecord *recPtr, **recPtrPtr;
+    Tcl_HashEntry *hPtr;
+    Tcl_HashSearch search;
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (!tsdPtr->initialized) {
+	return;
+    }
+    recPtrPtr = &tsdPtr->poolPtr;
+    while ((recPtr = *recPtrPtr) != NULL) {
+	if (recPtr->display == display) {
+	    *recPtrPtr = recPtr->nextPtr;
+	    tsdPtr->poolSize--;
+	    ckfree(recPtr);
+	} else {
+	    recPtrPtr = &recPtr->nextPtr;
+	}
+    }
+    for (hPtr = Tcl_FirstHashEntry(&tsdPtr->liveTable, &search);
+	    hPtr != NULL; hPtr = Tcl_NextHashEntry(&search)) {
+	recPtr = (PixmapRecord *)Tcl_GetHashValue(hPtr);
+	if (recPtr->display == display) {
+	    ckfree(recPtr);
+	    Tcl_DeleteHashEntry(hPtr);
+	}
+    }
+}
+
 
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkUnixCreateRegion --
+ *
+ *	Same as XCreateRegion except that a region recently passed to
+ *	TkUnixDestroyRegion may be recycled instead of being allocated
+ *	afresh. TkCreateRegion is a macro for this function on Unix. The
+ *	usual pattern behind that macro - create a region, accumulate some
+ *	damage rectangles, look at them, destroy the region - otherwise
+ *	costs a heap allocation and free per use, which adds up when an
+ *	expose storm or a scrolling text widget goes through the cycle for
+ *	every damage event.
+ *
+ * Results:
+ *	Returns an empty region.
+ *
+ * Side effects:
+ *	A region may be removed from the pool of freed regions.
+ *
+ *----------------------------------------------------------------------
+ */
+
+Region
+TkUnixCreateRegion(void)
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (tsdPtr->regionPoolSize > 0) {
+	return tsdPtr->regionPool[--tsdPtr->regionPoolSize];
+    }
+    return XCreateRegion();
+}
+
+/*
+ *----------------------------------------------------------------------
+ *
+ * TkUnixDestroyRegion --
+ *
+ *	Same as XDestroyRegion except that the region is parked in the pool
+ *	of freed regions for reuse by a later TkUnixCreateRegion call, or
+ *	destroyed if the pool is already full.
+ *
+ * Results:
+ *	None.
+ *
+ * Side effects:
+ *	The region is emptied, so that the pool only hands out regions that
+ *	are indistinguishable from freshly created ones.
+ *
+ *----------------------------------------------------------------------
+ */
+
+void
+TkUnixDestroyRegion(
+    Region rgn)			/* Region to free. */
+{
+    ThreadSpecificData *tsdPtr = (ThreadSpecificData *)
+	    Tcl_GetThreadData(&dataKey, sizeof(ThreadSpecificData));
+
+    if (tsdPtr->regionPoolSize >= REGION_POOL_MAX_SIZE) {
+	XDestroyRegion(rgn);
+	return;
+    }
+    XSubtractRegion(rgn, rgn, rgn);
+    tsdPtr->regionPool[tsdPtr->regionPoolSize++] = rgn;
+}
+
 /*
  *----------------------------------------------------------------------
  *
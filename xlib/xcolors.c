@@ -25,8 +25,9 @@ static const unsigned char az[] = {
 
 /*
  * Define an array that defines the mapping from color names to RGB values.
- * Note that this array must be kept sorted alphabetically so that the
- * binary search used in XParseColor will succeed.
+ * Note that this array must be kept sorted alphabetically so that the az
+ * index above stays valid, and that the generated hash tables following the
+ * array must be rebuilt whenever an entry is added, removed or renamed.
  *
  * Each color definition consists of exactly 32 characters, and starts with
  * the color name, but without its first character (that character can be
@@ -229,6 +230,54 @@ static const elem xColors[] = {
     "ellow\0          \213\213\000\315\315\000\356\356\000\377\377\000\377\377\000\4",
     "ellowGreen\0                 \232\315\062\0"
 };
+
+/*
+ * Generated hash tables for the color names above. The hash of a name is the
+ * 32-bit FNV-1a hash (seeded with 0x2265b1f5) of its characters after folding
+ * to lower case, skipping spaces and stopping at a numeric variant suffix.
+ * The low 6 bits select a displacement, which is added to the next 8 bits to
+ * produce a slot; each slot holds the index of the matching xColors entry
+ * plus one, or 0 when no color name hashes there. The displacements were
+ * chosen so that all 153 names land in distinct slots, making the lookup a
+ * single hash plus a single verifying comparison. Both tables must be
+ * regenerated whenever the xColors table changes.
+ */
+
+#define COLOR_HASH_SEED 0x2265b1f5u
+
+static const unsigned char xColorDisp[64] = {
+    8, 14, 0, 4, 0, 0, 2, 4, 1, 3, 0, 1,
+    1, 6, 1, 0, 1, 1, 0, 2, 0, 1, 6, 4,
+    2, 3, 0, 3, 0, 3, 0, 0, 0, 2, 7, 2,
+    0, 1, 2, 1, 0, 0, 1, 0, 0, 0, 1, 1,
+    6, 2, 0, 1, 3, 0, 1, 31, 1, 2, 0, 5,
+    24, 4, 15, 0
+};
+
+static const unsigned char xColorSlot[256] = {
+    109, 135, 158, 134, 0, 0, 0, 0, 87, 131, 83, 0,
+    97, 0, 147, 67, 0, 0, 0, 7, 155, 27, 110, 54,
+    36, 50, 0, 0, 149, 59, 76, 0, 154, 0, 0, 0,
+    60, 157, 152, 0, 126, 94, 116, 136, 122, 140, 153, 0,
+    0, 0, 96, 42, 145, 90, 0, 28, 12, 49, 112, 81,
+    143, 0, 0, 0, 0, 113, 65, 0, 129, 118, 0, 40,
+    0, 0, 0, 120, 0, 0, 91, 57, 119, 0, 98, 0,
+    0, 18, 10, 0, 151, 5, 19, 56, 100, 107, 23, 101,
+    21, 0, 71, 0, 139, 33, 1, 148, 37, 41, 14, 8,
+    93, 16, 38, 0, 102, 45, 64, 146, 73, 85, 0, 95,
+    142, 68, 99, 84, 108, 25, 0, 55, 30, 0, 0, 0,
+    0, 0, 34, 0, 0, 11, 0, 0, 0, 15, 0, 128,
+    48, 0, 0, 0, 0, 43, 0, 115, 13, 51, 123, 0,
+    0, 0, 0, 61, 0, 0, 0, 0, 29, 32, 0, 130,
+    26, 75, 80, 114, 138, 103, 0, 39, 22, 70, 0, 0,
+    35, 79, 104, 20, 124, 9, 111, 0, 0, 0, 0, 0,
+    0, 53, 0, 72, 125, 0, 47, 6, 0, 88, 52, 82,
+    24, 0, 78, 0, 77, 0, 0, 0, 0, 0, 0, 2,
+    0, 4, 69, 62, 0, 132, 0, 106, 0, 0, 0, 141,
+    0, 0, 17, 0, 144, 133, 92, 0, 74, 3, 0, 0,
+    105, 31, 58, 86, 63, 121, 137, 0, 0, 0, 89, 0,
+    0, 44, 0, 117
+};
 
 /*
  *----------------------------------------------------------------------
@@ -384,12 +433,12 @@ XParseColor(
 	}
     } else {
 	/*
-	 * Perform a binary search on the sorted array of colors.
-	 * size = current size of search range
-	 * p    = pointer to current element being considered.
+	 * Look the name up through the generated perfect hash tables, then
+	 * verify the single candidate entry with colorcmp.
 	 */
 
-	int size, num;
+	int c, idx, num;
+	unsigned int h = COLOR_HASH_SEED;
 	const elem *p;
 	const char *q;
 	int r = (spec[0] - 'A') & 0xdf;
@@ -397,23 +446,49 @@ XParseColor(
 	if (r >= (int) sizeof(az) - 1) {
 	    return 0;
 	}
-	size = az[r + 1] - az[r];
-	p = &xColors[(az[r + 1] + az[r]) >> 1];
-	r = colorcmp(spec + 1, *p, &num);
 
-	while (r != 0) {
-	    if (r < 0) {
-		size = (size >> 1);
-		p -= ((size + 1) >> 1);
-	    } else {
-		--size;
-		size = (size >> 1);
-		p += ((size + 2) >> 1);
+	/*
+	 * Hash the normalized name: fold to lower case, skip spaces and stop
+	 * at a numeric variant suffix, so that "azure3" hashes like "azure"
+	 * (they share a table entry) while "gray0" keeps its trailing zero
+	 * (it has an entry of its own). colorcmp checks the candidate
+	 * exactly, so over-eager normalization here can only cause a miss,
+	 * never a false hit.
+	 */
+
+	q = spec;
+	while ((c = UCHAR(*q++)) != '\0') {
+	    if (c == ' ') {
+		continue;
+	    }
+	    if ((unsigned)(c - 'A') <= (unsigned)('Z' - 'A')) {
+		c += 'a' - 'A';
+	    } else if ((unsigned)(c - '1') <= (unsigned)('9' - '1')) {
+		break;
 	    }
-	    if (!size) {
-		return 0;
+	    h = (h ^ (unsigned int) c) * 16777619u;
+	    if (c == '0') {
+		break;
 	    }
-	    r = colorcmp(spec + 1, *p, &num);
+	}
+
+	idx = xColorSlot[((h >> 6) + xColorDisp[h & 63]) & 255];
+	if (idx-- == 0) {
+	    return 0;
+	}
+
+	/*
+	 * The stored names lack their first character (it is implied by the
+	 * az index), so make sure the entry lies in the bucket for the
+	 * spec's first character before comparing the rest.
+	 */
+
+	if ((idx < az[r]) || (idx >= az[r + 1])) {
+	    return 0;
+	}
+	p = &xColors[idx];
+	if (colorcmp(spec + 1, *p, &num) != 0) {
+	    return 0;
 	}
 	if (num > (*p)[31]) {
 	    if (((*p)[31] != 8) || num > 100) {
@@ -471,8 +471,19 @@ XSetClipMask(
     if (pixmap == None) {
 	FreeClipMask(gc);
     } else {
-	TkpClipMask *clip_mask = AllocClipMask(gc);
-
+	TkpClipMask *clip_mask = (TkpClipMask *) gc->clip_mask;
+
+	/*
+	 * Setting the clip mask that is already in effect is a no-op; skip
+	 * it so that display procedures which re-assert their clip on every
+	 * redraw don't pay for an allocation cycle.
+	 */
+
+	if ((clip_mask != NULL) && (clip_mask->type == TKP_CLIP_PIXMAP)
+		&& (clip_mask->value.pixmap == pixmap)) {
+	    return Success;
+	}
+	clip_mask = AllocClipMask(gc);
 	clip_mask->type = TKP_CLIP_PIXMAP;
 	clip_mask->value.pixmap = pixmap;
     }